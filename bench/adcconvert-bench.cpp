@@ -0,0 +1,169 @@
+/*****************************************************************************
+*   Copyright 2012 Vincent HERVIEUX
+*
+*   This file is part of QPicoscope.
+*
+*   QPicoscope is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU Lesser General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   any later version.
+*
+*   QPicoscope is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU Lesser General Public License for more details.
+*
+*   You should have received a copy of the GNU Lesser General Public License
+*   along with QPicoscope in files COPYING.LESSER and COPYING.
+*   If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+/**
+ * @file adcconvert-bench.cpp
+ * @brief Samples/s of the ADC conversion, the former per sample
+ * 0.001 * adc_to_mv() loop against every AdcConvert kernel this CPU runs.
+ * Every kernel is checked against adc_to_mv() first, exits 1 on mismatch.
+ * @version 0.1
+ * @date 2026, october 16
+ * @author Vincent HERVIEUX    -   10.16.2026   -   initial creation
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+#include "adcconvert.h"
+#include "benchclock.h"
+
+/* 512 KiB of volts, stays in cache as the acquisition blocks do */
+#define BENCH_SAMPLES       (64 * 1024)
+#define BENCH_ROUNDS        400
+#define BENCH_FULL_SCALE    32767
+
+static const short input_ranges [] = {10, 20, 50, 100, 200, 500, 1000, 2000, 5000, 10000, 20000};
+#define BENCH_NB_RANGES     (sizeof(input_ranges) / sizeof(input_ranges[0]))
+
+/**
+ * @brief stand-in for the backends, adc_to_mv() was a virtual call
+ */
+class Reference
+{
+public:
+    Reference() : scale_to_mv(1) {}
+    virtual ~Reference() {}
+    virtual int adc_to_mv (long raw, int ch)
+    {
+        return ( scale_to_mv ) ? ( raw * input_ranges[ch] ) / BENCH_FULL_SCALE : raw;
+    }
+    int scale_to_mv;
+};
+
+/****************************************************************************
+ * convert_reference
+ ****************************************************************************/
+static void convert_reference(Reference *reference, const int16_t *raw, double *volts, uint32_t count, short range)
+{
+    uint32_t i = 0;
+
+    for (i = 0; i < count; i++)
+    {
+        volts[i] = 0.001 * reference->adc_to_mv(raw[i], range);
+    }
+}
+
+/****************************************************************************
+ * check
+ *
+ * Against the exact value in double the error is the float rounding, below
+ * 1E-6 of the full scale. adc_to_mv() also truncates to a whole mV, so it
+ * may differ by up to 1 mV plus that rounding.
+ ****************************************************************************/
+static bool check(AdcConvert *convert, Reference *reference)
+{
+    static int16_t raw[65536];
+    static double volts[65536];
+    uint32_t i = 0;
+    short range = 0;
+    double exact = 0.;
+    double error_mv = 0.;
+    double error_exact = 0.;
+    bool ok = true;
+
+    /* every count, unaligned tail included */
+    for (i = 0; i < 65536; i++)
+        raw[i] = (int16_t)(i - 32768);
+    for (range = 0; range < (short)BENCH_NB_RANGES; range++)
+    {
+        convert->to_volts(raw + 1, volts + 1, 65535, range);
+        error_mv = 0.;
+        error_exact = 0.;
+        for (i = 1; i < 65536; i++)
+        {
+            exact = (double)raw[i] * input_ranges[range] / (1000. * BENCH_FULL_SCALE);
+            error_mv = fmax(error_mv, fabs(volts[i] * 1000. - reference->adc_to_mv(raw[i], range)));
+            error_exact = fmax(error_exact, fabs(volts[i] - exact) / (input_ranges[range] / 1000.));
+        }
+        if ((error_mv > 1. + 1E-6 * input_ranges[range]) || (error_exact > 1E-6))
+        {
+            ERROR("%s: range %d mV, %lf mV from adc_to_mv, %lg of full scale from exact\n",
+                  AdcConvert::kernel_name(convert->get_kernel()), input_ranges[range], error_mv, error_exact);
+            ok = false;
+        }
+    }
+    return ok;
+}
+
+/****************************************************************************
+ * main
+ ****************************************************************************/
+int main(void)
+{
+    int16_t *raw = (int16_t*)malloc(BENCH_SAMPLES * sizeof(int16_t));
+    double *volts = (double*)malloc(BENCH_SAMPLES * sizeof(double));
+    Reference reference;
+    AdcConvert convert;
+    uint32_t i = 0;
+    int round = 0;
+    int kernel = 0;
+    double start = 0.;
+    double reference_rate = 0.;
+    double rate = 0.;
+    bool ok = true;
+
+    if ((NULL == raw) || (NULL == volts))
+    {
+        ERROR("cannot allocate %d samples\n", BENCH_SAMPLES);
+        return 1;
+    }
+    srand(1);
+    for (i = 0; i < BENCH_SAMPLES; i++)
+        raw[i] = (int16_t)((rand() % 65536) - 32768);
+    convert.set_ranges(input_ranges, BENCH_NB_RANGES, BENCH_FULL_SCALE);
+
+    start = now();
+    for (round = 0; round < BENCH_ROUNDS; round++)
+        convert_reference(&reference, raw, volts, BENCH_SAMPLES, round % BENCH_NB_RANGES);
+    reference_rate = (double)BENCH_SAMPLES * BENCH_ROUNDS / (now() - start);
+    printf("%-8s %10.1lf Msamples/s\n", "adc_to_mv", reference_rate * 1E-6);
+
+    for (kernel = 0; kernel < AdcConvert::E_KERNEL_MAX; kernel++)
+    {
+        if (!AdcConvert::is_supported((AdcConvert::kernel_e)kernel))
+            continue;
+        convert.set_kernel((AdcConvert::kernel_e)kernel);
+        if (!check(&convert, &reference))
+        {
+            ok = false;
+            continue;
+        }
+        start = now();
+        for (round = 0; round < BENCH_ROUNDS; round++)
+            convert.to_volts(raw, volts, BENCH_SAMPLES, round % BENCH_NB_RANGES);
+        rate = (double)BENCH_SAMPLES * BENCH_ROUNDS / (now() - start);
+        printf("%-8s %10.1lf Msamples/s  x%.1lf\n", AdcConvert::kernel_name((AdcConvert::kernel_e)kernel), rate * 1E-6, rate / reference_rate);
+    }
+
+    free(raw);
+    free(volts);
+    return ok ? 0 : 1;
+}
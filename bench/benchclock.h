@@ -0,0 +1,62 @@
+/*****************************************************************************
+*   Copyright 2012 Vincent HERVIEUX
+*
+*   This file is part of QPicoscope.
+*
+*   QPicoscope is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU Lesser General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   any later version.
+*
+*   QPicoscope is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU Lesser General Public License for more details.
+*
+*   You should have received a copy of the GNU Lesser General Public License
+*   along with QPicoscope in files COPYING.LESSER and COPYING.
+*   If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+/**
+ * @file benchclock.h
+ * @brief Monotonic clock and sleeps shared by the benchmarks, in seconds.
+ * @version 0.1
+ * @date 2026, october 16
+ * @author Vincent HERVIEUX    -   10.16.2026   -   initial creation
+ */
+
+#ifndef BENCHCLOCK_H
+#define BENCHCLOCK_H
+
+#include <time.h>
+
+/** @brief seconds on the monotonic clock */
+static inline double now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1E-9;
+}
+
+/** @brief sleep until a now() time, a pacing that does not drift */
+static inline void sleep_until(double deadline)
+{
+    struct timespec ts;
+
+    ts.tv_sec = (time_t)deadline;
+    ts.tv_nsec = (long)((deadline - ts.tv_sec) * 1E9);
+    clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL);
+}
+
+/** @brief sleep for a duration */
+static inline void sleep_for(double seconds)
+{
+    struct timespec ts;
+
+    ts.tv_sec = (time_t)seconds;
+    ts.tv_nsec = (long)((seconds - ts.tv_sec) * 1E9);
+    nanosleep(&ts, NULL);
+}
+
+#endif // BENCHCLOCK_H
@@ -0,0 +1,179 @@
+/*****************************************************************************
+*   Copyright 2012 Vincent HERVIEUX
+*
+*   This file is part of QPicoscope.
+*
+*   QPicoscope is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU Lesser General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   any later version.
+*
+*   QPicoscope is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU Lesser General Public License for more details.
+*
+*   You should have received a copy of the GNU Lesser General Public License
+*   along with QPicoscope in files COPYING.LESSER and COPYING.
+*   If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+/**
+ * @file decimator-bench.cpp
+ * @brief Time to reduce 1M, 10M and 100M counts to min/max pairs for a
+ * full HD canvas, with every kernel this CPU runs. Then the same records
+ * are indexed by a MinMaxPyramid, block after block, and a full and a
+ * 1/1000 zoomed view are decimated from it and from the samples.
+ * Every output is checked against the scalar scan, exits 1 on mismatch.
+ * @version 0.1
+ * @date 2026, october 16
+ * @author Vincent HERVIEUX    -   10.16.2026   -   initial creation
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "decimator.h"
+#include "minmaxpyramid.h"
+#include "benchclock.h"
+
+#define BENCH_COLUMNS       1920
+#define BENCH_MAX_POINTS    (100 * 1000 * 1000)
+/* 2 mV per count on the 2 V range */
+#define BENCH_SCALE         (2.f / 32767.f)
+#define BENCH_INTERVAL      1E-9
+/* pyramid is fed like by the acquisition, 1M samples blocks */
+#define BENCH_BLOCK         (1000 * 1000)
+#define BENCH_ZOOM          1000
+
+static const uint32_t record_lengths[] = { 1000 * 1000, 10 * 1000 * 1000, BENCH_MAX_POINTS };
+
+/****************************************************************************
+ * bench_view
+ *
+ * Decimates [x_min, x_max[ from the samples then from the pyramid, the
+ * two outputs must be the same.
+ ****************************************************************************/
+static bool bench_view(Decimator &decimator, double *reference, const int16_t *raw, const MinMaxPyramid &pyramid,
+                       const char *name, double x_min, double x_max)
+{
+    uint32_t reference_count = 0;
+    uint32_t count = 0;
+    double start = 0.;
+    double flat = 0.;
+    double indexed = 0.;
+
+    start = now();
+    reference_count = decimator.decimate(raw, pyramid.size(), BENCH_SCALE, 0.f, 0., BENCH_INTERVAL,
+                                         x_min, x_max, BENCH_COLUMNS);
+    flat = now() - start;
+    memcpy(reference, decimator.y(), reference_count * sizeof(double));
+    start = now();
+    count = decimator.decimate(pyramid, BENCH_SCALE, 0.f, 0., BENCH_INTERVAL, x_min, x_max, BENCH_COLUMNS);
+    indexed = now() - start;
+    if ((count != reference_count) || (0 != memcmp(reference, decimator.y(), count * sizeof(double))))
+    {
+        ERROR("pyramid differs from samples on %s view of %u points\n", name, pyramid.size());
+        return false;
+    }
+    printf("%-10u %-8s %12.3lf %12.3lf\n", pyramid.size(), name, flat * 1E3, indexed * 1E3);
+    return true;
+}
+
+/****************************************************************************
+ * main
+ ****************************************************************************/
+int main(void)
+{
+    int16_t *raw = (int16_t*)malloc(BENCH_MAX_POINTS * sizeof(int16_t));
+    double *reference = (double*)malloc(2 * BENCH_COLUMNS * sizeof(double));
+    Decimator decimator;
+    MinMaxPyramid pyramid;
+    uint32_t reference_count = 0;
+    uint32_t count = 0;
+    uint32_t length = 0;
+    uint32_t i = 0;
+    int kernel = 0;
+    int rounds = 0;
+    int round = 0;
+    double start = 0.;
+    double elapsed = 0.;
+    double span = 0.;
+    bool ok = true;
+
+    if ((NULL == raw) || (NULL == reference))
+    {
+        ERROR("cannot allocate %d samples\n", BENCH_MAX_POINTS);
+        return 1;
+    }
+    /* noisy sawtooth with a single sample glitch every 1M samples */
+    srand(1);
+    for (i = 0; i < BENCH_MAX_POINTS; i++)
+        raw[i] = (int16_t)(((i / 64) % 512) * 32 - 8192 + (rand() % 256));
+    for (i = 500000; i < BENCH_MAX_POINTS; i += 1000000)
+        raw[i] = 32767;
+
+    printf("%-10s %-8s %12s %14s\n", "points", "kernel", "ms", "Msamples/s");
+    for (length = 0; length < sizeof(record_lengths) / sizeof(record_lengths[0]); length++)
+    {
+        decimator.setKernel(AdcConvert::E_KERNEL_SCALAR);
+        reference_count = decimator.decimate(raw, record_lengths[length], BENCH_SCALE, 0.f, 0., BENCH_INTERVAL,
+                                             0., record_lengths[length] * BENCH_INTERVAL, BENCH_COLUMNS);
+        memcpy(reference, decimator.y(), reference_count * sizeof(double));
+        rounds = (int)(BENCH_MAX_POINTS / record_lengths[length]);
+
+        for (kernel = 0; kernel < AdcConvert::E_KERNEL_MAX; kernel++)
+        {
+            if (!AdcConvert::is_supported((AdcConvert::kernel_e)kernel))
+                continue;
+            decimator.setKernel((AdcConvert::kernel_e)kernel);
+            start = now();
+            for (round = 0; round < rounds; round++)
+            {
+                count = decimator.decimate(raw, record_lengths[length], BENCH_SCALE, 0.f, 0., BENCH_INTERVAL,
+                                           0., record_lengths[length] * BENCH_INTERVAL, BENCH_COLUMNS);
+            }
+            elapsed = (now() - start) / rounds;
+            if ((count != reference_count) || (0 != memcmp(reference, decimator.y(), count * sizeof(double))))
+            {
+                ERROR("%s kernel differs from scalar on %u points\n",
+                      AdcConvert::kernel_name((AdcConvert::kernel_e)kernel), record_lengths[length]);
+                ok = false;
+                continue;
+            }
+            printf("%-10u %-8s %12.3lf %14.1lf\n", record_lengths[length], AdcConvert::kernel_name((AdcConvert::kernel_e)kernel),
+                   elapsed * 1E3, record_lengths[length] / elapsed * 1E-6);
+        }
+    }
+
+    printf("\n%-10s %-8s %12s %12s\n", "points", "view", "samples ms", "pyramid ms");
+    decimator.setKernel(AdcConvert::best_kernel());
+    for (length = 0; length < sizeof(record_lengths) / sizeof(record_lengths[0]); length++)
+    {
+        pyramid.clear();
+        start = now();
+        for (i = 0; i < record_lengths[length]; i += BENCH_BLOCK)
+        {
+            if (!pyramid.append(raw + i, BENCH_BLOCK))
+            {
+                ERROR("cannot index %u points\n", record_lengths[length]);
+                ok = false;
+                break;
+            }
+        }
+        if (pyramid.size() != record_lengths[length])
+            continue;
+        elapsed = now() - start;
+        printf("%-10u %-8s %12.3lf %12s (%u levels, %.1lf Msamples/s)\n", record_lengths[length], "index", elapsed * 1E3, "",
+               pyramid.levels(), record_lengths[length] / elapsed * 1E-6);
+
+        span = record_lengths[length] * BENCH_INTERVAL;
+        ok = bench_view(decimator, reference, raw, pyramid, "full", 0., span) && ok;
+        /* odd bounds, columns do not start on a bucket */
+        ok = bench_view(decimator, reference, raw, pyramid, "zoom", span / 3., span / 3. + span / BENCH_ZOOM) && ok;
+    }
+
+    free(raw);
+    free(reference);
+    return ok ? 0 : 1;
+}
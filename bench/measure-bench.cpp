@@ -0,0 +1,349 @@
+/*****************************************************************************
+*   Copyright 2012 Vincent HERVIEUX
+*
+*   This file is part of QPicoscope.
+*
+*   QPicoscope is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU Lesser General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   any later version.
+*
+*   QPicoscope is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU Lesser General Public License for more details.
+*
+*   You should have received a copy of the GNU Lesser General Public License
+*   along with QPicoscope in files COPYING.LESSER and COPYING.
+*   If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+/**
+ * @file measure-bench.cpp
+ * @brief Cost per sample of the automatic measurements on 16M samples in
+ * blocks, for every measurement set and every kernel this CPU runs, the
+ * fastest of a few passes.
+ * The results of every kernel are checked against the scalar one, the
+ * measurements of a noisy trapezoid against its known values, and the
+ * statistics of the MeasurementWorker against a two pass computation over
+ * blocks of changing amplitude, exits 1 on failure.
+ * @version 0.1
+ * @date 2026, october 16
+ * @author Vincent HERVIEUX    -   10.16.2026   -   initial creation
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+#include "measurementscan.h"
+#include "measurementworker.h"
+#include "benchclock.h"
+
+#define BENCH_POINTS        (16 * 1024 * 1024)
+/* passes per kernel, the fastest is reported */
+#define BENCH_RUNS          5
+/* whole periods per block, so the block means are the signal ones */
+#define BENCH_BLOCK         64000
+/* 0.1 mV per count, 1 MS/s */
+#define BENCH_SCALE         1E-4f
+#define BENCH_OFFSET        0.f
+#define BENCH_INTERVAL      1E-6
+/* trapezoid of +-1 V: samples of the rise, high part, fall and low part */
+#define BENCH_AMPLITUDE     10000.
+#define BENCH_RISE          100
+#define BENCH_HIGH          300
+#define BENCH_FALL          50
+#define BENCH_LOW           550
+#define BENCH_PERIOD        (BENCH_RISE + BENCH_HIGH + BENCH_FALL + BENCH_LOW)
+#define BENCH_NOISE         20
+/* relative error allowed on the trapezoid and on the statistics */
+#define BENCH_ERROR         5E-3
+#define BENCH_STATISTICS_ERROR  1E-9
+/* blocks given to the worker */
+#define BENCH_WORKER_BLOCKS 256
+
+#define BENCH_ALL           (MEASUREMENT_BIT(MeasurementScan::E_MEASURE_MAX) - 1)
+
+typedef struct
+{
+    const char *name;
+    uint32_t measures;
+} bench_set_t;
+
+static const bench_set_t sets[] =
+{
+    { "vpp",       MEASUREMENT_BIT(MeasurementScan::E_MEASURE_VPP) },
+    { "amplitude", MEASUREMENT_BIT(MeasurementScan::E_MEASURE_VPP) | MEASUREMENT_BIT(MeasurementScan::E_MEASURE_MEAN) |
+                   MEASUREMENT_BIT(MeasurementScan::E_MEASURE_RMS) },
+    { "timing",    MEASUREMENT_BIT(MeasurementScan::E_MEASURE_FREQUENCY) | MEASUREMENT_BIT(MeasurementScan::E_MEASURE_PERIOD) |
+                   MEASUREMENT_BIT(MeasurementScan::E_MEASURE_DUTY) },
+    { "all",       BENCH_ALL }
+};
+
+/****************************************************************************
+ * trapezoid
+ *
+ * Counts of a trapezoid between -amplitude and +amplitude at sample i.
+ ****************************************************************************/
+static double trapezoid(uint32_t i, double amplitude)
+{
+    uint32_t phase = i % BENCH_PERIOD;
+
+    if (phase < BENCH_RISE)
+        return amplitude * (2. * phase / BENCH_RISE - 1.);
+    phase -= BENCH_RISE;
+    if (phase < BENCH_HIGH)
+        return amplitude;
+    phase -= BENCH_HIGH;
+    if (phase < BENCH_FALL)
+        return amplitude * (1. - 2. * phase / BENCH_FALL);
+    return -amplitude;
+}
+
+/****************************************************************************
+ * measure_all
+ *
+ * Every block through one scan, the results of the last one are kept.
+ ****************************************************************************/
+static void measure_all(MeasurementScan &scan, const int16_t *samples, uint32_t measures,
+                        MeasurementScan::result_t *result, bool *same, const MeasurementScan::result_t *reference)
+{
+    uint32_t base = 0;
+    uint32_t count = 0;
+    uint32_t block = 0;
+
+    scan.reset();
+    for (base = 0; base < BENCH_POINTS; base += count, block++)
+    {
+        count = (BENCH_POINTS - base < BENCH_BLOCK) ? BENCH_POINTS - base : BENCH_BLOCK;
+        scan.measure(samples + base, count, BENCH_SCALE, BENCH_OFFSET, BENCH_INTERVAL, measures, &result[block]);
+        if ((NULL != reference) &&
+            ((result[block].valid_mask != reference[block].valid_mask) ||
+             (0 != memcmp(result[block].values, reference[block].values, sizeof(result[block].values)))))
+            *same = false;
+    }
+}
+
+/****************************************************************************
+ * check_trapezoid
+ ****************************************************************************/
+static bool check_trapezoid(const MeasurementScan::result_t *result)
+{
+    const double expected[MeasurementScan::E_MEASURE_MAX] =
+    {
+        2. * BENCH_AMPLITUDE * BENCH_SCALE,
+        BENCH_AMPLITUDE * BENCH_SCALE * (BENCH_HIGH - BENCH_LOW) / BENCH_PERIOD,
+        BENCH_AMPLITUDE * BENCH_SCALE * sqrt((BENCH_HIGH + BENCH_LOW + (BENCH_RISE + BENCH_FALL) / 3.) / BENCH_PERIOD),
+        1. / (BENCH_PERIOD * BENCH_INTERVAL),
+        BENCH_PERIOD * BENCH_INTERVAL,
+        100. * (BENCH_RISE / 2. + BENCH_HIGH + BENCH_FALL / 2.) / BENCH_PERIOD,
+        0.8 * BENCH_RISE * BENCH_INTERVAL,
+        0.8 * BENCH_FALL * BENCH_INTERVAL
+    };
+    uint8_t m = 0;
+    bool ok = true;
+
+    for (m = 0; m < MeasurementScan::E_MEASURE_MAX; m++)
+    {
+        if (0 == (result->valid_mask & MEASUREMENT_BIT(m)))
+        {
+            ERROR("%s not measured\n", MeasurementScan::measure_name((MeasurementScan::measure_e)m));
+            ok = false;
+        }
+        else if (fabs(result->values[m] - expected[m]) > BENCH_ERROR * fabs(expected[m]))
+        {
+            ERROR("%s is %lg %s instead of %lg\n", MeasurementScan::measure_name((MeasurementScan::measure_e)m),
+                  result->values[m], MeasurementScan::measure_unit((MeasurementScan::measure_e)m), expected[m]);
+            ok = false;
+        }
+    }
+    return ok;
+}
+
+/****************************************************************************
+ * check_worker
+ *
+ * Blocks are published as long as the queue has room, the one measured
+ * holds a slot too. Nothing should be dropped.
+ ****************************************************************************/
+static bool check_worker(const int16_t *samples)
+{
+    MeasurementWorker worker;
+    MeasurementWorker::stats_t stats;
+    MeasurementWorker::results_t *results = (MeasurementWorker::results_t*)malloc(sizeof(MeasurementWorker::results_t));
+    MeasurementScan::result_t *expected = (MeasurementScan::result_t*)malloc(BENCH_WORKER_BLOCKS * sizeof(MeasurementScan::result_t));
+    const MeasurementWorker::statistics_t *statistics = NULL;
+    MeasurementScan scan;
+    uint32_t block = 0;
+    uint32_t count = 0;
+    uint32_t m = 0;
+    double last = 0.;
+    double mean = 0.;
+    double m2 = 0.;
+    double minimum = 0.;
+    double maximum = 0.;
+    double deviation = 0.;
+    bool ok = true;
+
+    if ((NULL == results) || (NULL == expected))
+    {
+        ERROR("cannot allocate the results\n");
+        free(results);
+        free(expected);
+        return false;
+    }
+    for (block = 0; block < BENCH_WORKER_BLOCKS; block++)
+        scan.measure(samples + (uint64_t)block * BENCH_BLOCK, BENCH_BLOCK, BENCH_SCALE, BENCH_OFFSET, BENCH_INTERVAL,
+                     BENCH_ALL, &expected[block]);
+
+    worker.setMeasures(BENCH_ALL);
+    if (!worker.start())
+    {
+        free(results);
+        free(expected);
+        return false;
+    }
+    for (block = 0; block < BENCH_WORKER_BLOCKS; block++)
+    {
+        do
+        {
+            worker.getStats(&stats);
+            if (block - stats.blocks - stats.dropped < MEASUREMENT_QUEUE_DEPTH - 2)
+                break;
+            sleep_for(0.0002);
+        } while (true);
+        worker.setRawChannel(1, samples + (uint64_t)block * BENCH_BLOCK, BENCH_BLOCK, BENCH_SCALE, BENCH_OFFSET, 0., BENCH_INTERVAL);
+        worker.publish();
+    }
+    do
+    {
+        sleep_for(0.0002);
+        worker.getStats(&stats);
+    } while (BENCH_WORKER_BLOCKS > stats.blocks + stats.dropped);
+    worker.stop();
+    worker.getResults(results);
+    if (0 != stats.dropped)
+    {
+        ERROR("worker dropped %llu blocks\n", (unsigned long long)stats.dropped);
+        ok = false;
+    }
+
+    for (m = 0; ok && (m < MeasurementScan::E_MEASURE_MAX); m++)
+    {
+        statistics = &results->values[0][m];
+        count = 0;
+        mean = 0.;
+        for (block = 0; block < BENCH_WORKER_BLOCKS; block++)
+        {
+            if (0 == (expected[block].valid_mask & MEASUREMENT_BIT(m)))
+                continue;
+            if ((0 == count) || (expected[block].values[m] < minimum))
+                minimum = expected[block].values[m];
+            if ((0 == count) || (expected[block].values[m] > maximum))
+                maximum = expected[block].values[m];
+            mean += expected[block].values[m];
+            last = expected[block].values[m];
+            count++;
+        }
+        mean /= (count > 0) ? count : 1;
+        m2 = 0.;
+        for (block = 0; block < BENCH_WORKER_BLOCKS; block++)
+        {
+            if (0 != (expected[block].valid_mask & MEASUREMENT_BIT(m)))
+                m2 += (expected[block].values[m] - mean) * (expected[block].values[m] - mean);
+        }
+        deviation = (count > 1) ? sqrt(m2 / (count - 1)) : 0.;
+        if ((count < BENCH_WORKER_BLOCKS / 2) || (statistics->count != count) ||
+            (statistics->minimum != minimum) || (statistics->maximum != maximum) || (statistics->last != last) ||
+            (fabs(statistics->mean - mean) > BENCH_STATISTICS_ERROR * fabs(mean)) ||
+            (fabs(MeasurementWorker::deviation(statistics) - deviation) > BENCH_STATISTICS_ERROR * fabs(mean)))
+        {
+            ERROR("%s statistics: %llu blocks, mean %lg deviation %lg instead of %u, %lg and %lg\n",
+                  MeasurementScan::measure_name((MeasurementScan::measure_e)m), (unsigned long long)statistics->count,
+                  statistics->mean, MeasurementWorker::deviation(statistics), count, mean, deviation);
+            ok = false;
+        }
+    }
+    printf("worker: %u blocks, %.1lf us per block\n", BENCH_WORKER_BLOCKS, stats.busy_ns * 1E-3 / BENCH_WORKER_BLOCKS);
+    free(results);
+    free(expected);
+    return ok;
+}
+
+/****************************************************************************
+ * main
+ ****************************************************************************/
+int main(void)
+{
+    const uint32_t blocks = (BENCH_POINTS + BENCH_BLOCK - 1) / BENCH_BLOCK;
+    int16_t *samples = (int16_t*)malloc(BENCH_POINTS * sizeof(int16_t));
+    int16_t *varying = (int16_t*)malloc((uint64_t)BENCH_WORKER_BLOCKS * BENCH_BLOCK * sizeof(int16_t));
+    MeasurementScan::result_t *reference = (MeasurementScan::result_t*)malloc(blocks * sizeof(MeasurementScan::result_t));
+    MeasurementScan::result_t *results = (MeasurementScan::result_t*)malloc(blocks * sizeof(MeasurementScan::result_t));
+    MeasurementScan scan;
+    uint32_t s = 0;
+    uint32_t i = 0;
+    uint32_t run = 0;
+    int kernel = 0;
+    double start = 0.;
+    double elapsed = 0.;
+    double best = 0.;
+    bool same = true;
+    bool ok = true;
+
+    if ((NULL == samples) || (NULL == varying) || (NULL == reference) || (NULL == results))
+    {
+        ERROR("cannot allocate %d samples\n", BENCH_POINTS);
+        return 1;
+    }
+    srand(1);
+    for (i = 0; i < BENCH_POINTS; i++)
+        samples[i] = (int16_t)floor(trapezoid(i, BENCH_AMPLITUDE) + (rand() % (2 * BENCH_NOISE + 1)) - BENCH_NOISE + 0.5);
+    /* amplitude and offset change from block to block */
+    for (i = 0; i < (uint32_t)BENCH_WORKER_BLOCKS * BENCH_BLOCK; i++)
+        varying[i] = (int16_t)floor(trapezoid(i, BENCH_AMPLITUDE * (1. + 0.5 * sin(i / BENCH_BLOCK * 0.3))) +
+                                    1000. * cos(i / BENCH_BLOCK * 0.7) + (rand() % (2 * BENCH_NOISE + 1)) - BENCH_NOISE + 0.5);
+
+    printf("%-10s %-8s %10s\n", "measures", "kernel", "ns/sample");
+    for (s = 0; s < sizeof(sets) / sizeof(sets[0]); s++)
+    {
+        scan.set_kernel(AdcConvert::E_KERNEL_SCALAR);
+        measure_all(scan, samples, sets[s].measures, reference, &same, NULL);
+        for (kernel = 0; kernel < AdcConvert::E_KERNEL_MAX; kernel++)
+        {
+            if (!AdcConvert::is_supported((AdcConvert::kernel_e)kernel))
+                continue;
+            scan.set_kernel((AdcConvert::kernel_e)kernel);
+            same = true;
+            for (run = 0; run < BENCH_RUNS; run++)
+            {
+                start = now();
+                measure_all(scan, samples, sets[s].measures, results, &same, reference);
+                elapsed = now() - start;
+                if ((0 == run) || (elapsed < best))
+                    best = elapsed;
+            }
+            if (!same)
+            {
+                ERROR("%s kernel differs from scalar on %s measures\n",
+                      AdcConvert::kernel_name((AdcConvert::kernel_e)kernel), sets[s].name);
+                ok = false;
+                continue;
+            }
+            printf("%-10s %-8s %10.3lf\n", sets[s].name, AdcConvert::kernel_name((AdcConvert::kernel_e)kernel),
+                   best * 1E9 / BENCH_POINTS);
+        }
+    }
+    /* a whole block with all measures, the last one may be short */
+    if (!check_trapezoid(&reference[blocks - 2]))
+        ok = false;
+    if (!check_worker(varying))
+        ok = false;
+
+    free(samples);
+    free(varying);
+    free(reference);
+    free(results);
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,253 @@
+/*****************************************************************************
+*   Copyright 2012 Vincent HERVIEUX
+*
+*   This file is part of QPicoscope.
+*
+*   QPicoscope is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU Lesser General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   any later version.
+*
+*   QPicoscope is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU Lesser General Public License for more details.
+*
+*   You should have received a copy of the GNU Lesser General Public License
+*   along with QPicoscope in files COPYING.LESSER and COPYING.
+*   If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+/**
+ * @file multiunit-bench.cpp
+ * @brief Several units driven at once through AcquisitionManager, without
+ * hardware. QPICOSCOPE_SIM_UNITS simulated units, 4 unless a count is
+ * given, are opened by open_all(), started together and run as fast as
+ * possible into a stand-in DrawData each.
+ * Every unit must publish frames of its own, from a thread of its own,
+ * pinned to the core the manager gave it: with enough cores, no two units
+ * share one. The units are then closed and opened again, as a rescan
+ * does. Exits 1 when a check fails.
+ * @version 0.1
+ * @date 2026, october 16
+ * @author Vincent HERVIEUX    -   10.16.2026   -   initial creation
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sched.h>
+
+#include "drawdata.h"
+#include "atomic-ops.h"
+#include "acquisitionmanager.h"
+#include "acquisitionsim.h"
+#include "acquisitionplayback.h"
+
+#define BENCH_UNITS         4
+#define BENCH_DURATION      1.0
+#define BENCH_RECORD        10000
+#define BENCH_TIMEBASE      1E-5
+/* cores a unit thread is followed on, more are counted in the last bit */
+#define BENCH_MAX_CPUS      64
+
+/****************************************************************************
+ * UnitDraw
+ *
+ * Counts the frames of one unit and notes which thread, on which core,
+ * publishes them.
+ ****************************************************************************/
+class UnitDraw : public DrawData
+{
+public:
+    UnitDraw() : frames_m(0), samples_m(0), cpus_m(0), thread_m(0), threads_m(0) {}
+
+    int8_t setData(uint8_t channel_id, double *x_data, double *y_data, uint32_t nb_points)
+    {
+        (void)channel_id;
+        (void)x_data;
+        (void)y_data;
+        samples_m += nb_points;
+        return 0;
+    }
+    int8_t setRawData(uint8_t channel_id, const int16_t *raw, uint32_t nb_points,
+                      float scale, float offset, double x_origin, double x_interval, bool append)
+    {
+        (void)channel_id;
+        (void)raw;
+        (void)scale;
+        (void)offset;
+        (void)x_origin;
+        (void)x_interval;
+        (void)append;
+        samples_m += nb_points;
+        return 0;
+    }
+    int8_t publishData(void)
+    {
+        pthread_t self = pthread_self();
+        int cpu = sched_getcpu();
+
+        if ((0 == threads_m) || !pthread_equal(self, thread_m))
+        {
+            thread_m = self;
+            threads_m++;
+        }
+        if (cpu >= 0)
+            cpus_m |= 1ULL << ((cpu < BENCH_MAX_CPUS) ? cpu : BENCH_MAX_CPUS - 1);
+        ATOMIC_STORE_RELAXED(&frames_m, frames_m + 1);
+        return 0;
+    }
+
+    void reset(void)
+    {
+        frames_m = 0;
+        samples_m = 0;
+        cpus_m = 0;
+        threads_m = 0;
+    }
+
+    uint64_t frames_m;
+    uint64_t samples_m;
+    /** @brief bit i set once a frame was published from core i */
+    uint64_t cpus_m;
+    /** @brief last thread that published */
+    pthread_t thread_m;
+    /** @brief times the publishing thread changed */
+    uint32_t threads_m;
+};
+
+/****************************************************************************
+ * nb_bits
+ ****************************************************************************/
+static int nb_bits(uint64_t mask)
+{
+    int count = 0;
+
+    for (; 0 != mask; mask &= mask - 1)
+        count++;
+    return count;
+}
+
+/****************************************************************************
+ * first_bit
+ ****************************************************************************/
+static int first_bit(uint64_t mask)
+{
+    int bit = 0;
+
+    if (0 == mask)
+        return -1;
+    while (0 == (mask & (1ULL << bit)))
+        bit++;
+    return bit;
+}
+
+/****************************************************************************
+ * bench_units
+ ****************************************************************************/
+static bool bench_units(AcquisitionManager *manager, UnitDraw *draws, uint8_t nb_units, long nb_cpus)
+{
+    uint64_t cpus = 0;
+    uint8_t count = manager->open_all();
+    uint8_t i = 0;
+    uint8_t j = 0;
+    bool ok = true;
+
+    if (count != nb_units)
+    {
+        ERROR("%d units opened, %d asked\n", count, nb_units);
+        manager->close_all();
+        return false;
+    }
+    for (i = 0; i < nb_units; i++)
+    {
+        draws[i].reset();
+        manager->get_device(i)->setDrawData(&draws[i]);
+        manager->get_device(i)->set_record_length(BENCH_RECORD);
+        manager->get_device(i)->set_timebase(BENCH_TIMEBASE);
+    }
+    manager->start_all();
+    usleep((useconds_t)(BENCH_DURATION * 1E6));
+    manager->stop_all();
+
+    printf("%4s %10s %10s %8s %6s\n", "unit", "frames/s", "MS/s", "threads", "cpu");
+    for (i = 0; i < nb_units; i++)
+    {
+        printf("%4d %10.1f %10.1f %8u %6d%s\n", i, draws[i].frames_m / BENCH_DURATION,
+               draws[i].samples_m / BENCH_DURATION * 1E-6, draws[i].threads_m, first_bit(draws[i].cpus_m),
+               (nb_bits(draws[i].cpus_m) > 1) ? "+" : "");
+        if (0 == draws[i].frames_m)
+        {
+            ERROR("unit %d published no frame\n", i);
+            ok = false;
+        }
+        if (draws[i].threads_m > 1)
+        {
+            ERROR("unit %d published from %u threads\n", i, draws[i].threads_m);
+            ok = false;
+        }
+        for (j = 0; j < i; j++)
+        {
+            if ((0 != draws[i].threads_m) && (0 != draws[j].threads_m) &&
+                pthread_equal(draws[i].thread_m, draws[j].thread_m))
+            {
+                ERROR("units %d and %d share a thread\n", j, i);
+                ok = false;
+            }
+        }
+        /* core 0 is left to the GUI, the units are pinned to the others */
+        if (nb_cpus > 1)
+        {
+            if (nb_bits(draws[i].cpus_m) != 1)
+            {
+                ERROR("unit %d ran on %d cores\n", i, nb_bits(draws[i].cpus_m));
+                ok = false;
+            }
+            if ((nb_units < nb_cpus) && (0 != (cpus & draws[i].cpus_m)))
+            {
+                ERROR("unit %d shares core %d\n", i, first_bit(draws[i].cpus_m));
+                ok = false;
+            }
+            cpus |= draws[i].cpus_m;
+        }
+    }
+    if (nb_cpus <= 1)
+        printf("single core, the units are not pinned\n");
+    manager->close_all();
+    return ok;
+}
+
+/****************************************************************************
+ * main
+ ****************************************************************************/
+int main(int argc, char **argv)
+{
+    int nb_units = (argc > 1) ? atoi(argv[1]) : BENCH_UNITS;
+    long nb_cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    char units[16];
+    UnitDraw draws[SIM_MAX_UNITS];
+    AcquisitionManager *manager = NULL;
+    bool ok = true;
+
+    if ((nb_units < 1) || (nb_units > SIM_MAX_UNITS) || (nb_units > ACQUISITION_MAX_DEVICES))
+    {
+        ERROR("1 to %d units\n", SIM_MAX_UNITS);
+        return 1;
+    }
+    /* the simulated units only, as fast as they go */
+    unsetenv(PLAYBACK_ENV_FILE);
+    setenv(SIM_ENV_SIGNALS, "1", 1);
+    setenv(SIM_ENV_SPEED, "0", 1);
+    snprintf(units, sizeof(units), "%d", nb_units);
+    setenv(SIM_ENV_UNITS, units, 1);
+
+    printf("%d units on %ld cores\n", nb_units, nb_cpus);
+    manager = AcquisitionManager::get_instance();
+    ok = bench_units(manager, draws, (uint8_t)nb_units, nb_cpus);
+    /* closed units are found again by the next scan */
+    ok = bench_units(manager, draws, (uint8_t)nb_units, nb_cpus) && ok;
+    delete manager;
+    return ok ? 0 : 1;
+}
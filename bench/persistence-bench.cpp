@@ -0,0 +1,177 @@
+/*****************************************************************************
+*   Copyright 2012 Vincent HERVIEUX
+*
+*   This file is part of QPicoscope.
+*
+*   QPicoscope is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU Lesser General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   any later version.
+*
+*   QPicoscope is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU Lesser General Public License for more details.
+*
+*   You should have received a copy of the GNU Lesser General Public License
+*   along with QPicoscope in files COPYING.LESSER and COPYING.
+*   If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+/**
+ * @file persistence-bench.cpp
+ * @brief Cost of accumulating one waveform of 1k to 1M counts into the
+ * persistence counts of a 1920x1080 canvas, with every kernel this CPU runs,
+ * then the cost of a decay and of a render of 4 channels.
+ * Counts are checked against the scalar kernel after each record length,
+ * exits 1 on mismatch.
+ * @version 0.1
+ * @date 2026, october 16
+ * @author Vincent HERVIEUX    -   10.16.2026   -   initial creation
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+#include "persistencebuffer.h"
+#include "benchclock.h"
+
+#define BENCH_WIDTH         1920
+#define BENCH_HEIGHT        1080
+#define BENCH_MAX_POINTS    (1024 * 1024)
+/* 2 mV per count on the 2 V range */
+#define BENCH_SCALE         (2.f / 32767.f)
+#define BENCH_INTERVAL      1E-9
+/* +-1 V on the full height */
+#define BENCH_VOLTS         1.
+/* waveforms of each record length, with a different phase each */
+#define BENCH_WAVEFORMS     64
+#define BENCH_ROUNDS        50
+
+static const uint32_t lengths[] = { 1024, 16 * 1024, 128 * 1024, 1024 * 1024 };
+static const uint32_t colors[PERSISTENCE_MAX_CHANNELS] = { 0xFF00FF00, 0xFFFF0000, 0xFFFF00FF, 0xFFFFFF00 };
+
+/****************************************************************************
+ * accumulate
+ ****************************************************************************/
+static double accumulate(PersistenceBuffer &buffer, int16_t * const *raw, uint32_t nb_points)
+{
+    double start = 0.;
+    uint32_t w = 0;
+
+    buffer.clear();
+    start = now();
+    for (w = 0; w < BENCH_WAVEFORMS; w++)
+        buffer.addRaw(0, raw[w], nb_points, BENCH_SCALE, 0.f, 0., BENCH_INTERVAL * BENCH_MAX_POINTS / nb_points);
+    return (now() - start) / BENCH_WAVEFORMS;
+}
+
+/****************************************************************************
+ * main
+ ****************************************************************************/
+int main(void)
+{
+    int16_t *raw[BENCH_WAVEFORMS];
+    uint16_t *reference = NULL;
+    uint32_t *pixels = NULL;
+    PersistenceBuffer buffer;
+    size_t counters = 0;
+    uint32_t length = 0;
+    uint32_t i = 0;
+    uint32_t w = 0;
+    uint8_t ch = 0;
+    int kernel = 0;
+    int round = 0;
+    double start = 0.;
+    double elapsed = 0.;
+    bool ok = true;
+
+    if (!buffer.resize(BENCH_WIDTH, BENCH_HEIGHT))
+    {
+        ERROR("cannot allocate a %ux%u canvas\n", BENCH_WIDTH, BENCH_HEIGHT);
+        return 1;
+    }
+    buffer.setView(0., BENCH_MAX_POINTS * BENCH_INTERVAL, -BENCH_VOLTS, BENCH_VOLTS);
+    for (ch = 0; ch < PERSISTENCE_MAX_CHANNELS; ch++)
+        buffer.setColor(ch, colors[ch]);
+    counters = (size_t)buffer.stride() * buffer.height();
+    reference = (uint16_t*)malloc(counters * sizeof(uint16_t));
+    pixels = (uint32_t*)malloc((size_t)BENCH_WIDTH * BENCH_HEIGHT * sizeof(uint32_t));
+    if ((NULL == reference) || (NULL == pixels))
+    {
+        ERROR("cannot allocate a %ux%u image\n", BENCH_WIDTH, BENCH_HEIGHT);
+        return 1;
+    }
+    /* noisy sines drifting in phase, with a glitch now and then */
+    srand(1);
+    for (w = 0; w < BENCH_WAVEFORMS; w++)
+    {
+        raw[w] = (int16_t*)malloc(BENCH_MAX_POINTS * sizeof(int16_t));
+        if (NULL == raw[w])
+        {
+            ERROR("cannot allocate %d samples\n", BENCH_MAX_POINTS);
+            return 1;
+        }
+        for (i = 0; i < BENCH_MAX_POINTS; i++)
+        {
+            raw[w][i] = (int16_t)(sin(i * 2E-5 + w * 0.1) * 12000. + (rand() % 1024) - 512);
+            if (0 == ((i + w * 1000) % 333333))
+                raw[w][i] = 32767;
+        }
+    }
+
+    printf("%-8s %-8s %12s %12s\n", "points", "kernel", "us/wfm", "wfm/s");
+    for (length = 0; length < sizeof(lengths) / sizeof(lengths[0]); length++)
+    {
+        buffer.setKernel(AdcConvert::E_KERNEL_SCALAR);
+        accumulate(buffer, raw, lengths[length]);
+        memcpy(reference, buffer.hits(0), counters * sizeof(uint16_t));
+
+        for (kernel = 0; kernel < AdcConvert::E_KERNEL_MAX; kernel++)
+        {
+            if (!AdcConvert::is_supported((AdcConvert::kernel_e)kernel))
+                continue;
+            buffer.setKernel((AdcConvert::kernel_e)kernel);
+            elapsed = accumulate(buffer, raw, lengths[length]);
+            if (0 != memcmp(reference, buffer.hits(0), counters * sizeof(uint16_t)))
+            {
+                ERROR("%s kernel differs from scalar with %u points\n",
+                      AdcConvert::kernel_name((AdcConvert::kernel_e)kernel), lengths[length]);
+                ok = false;
+                continue;
+            }
+            printf("%-8u %-8s %12.2lf %12.0lf\n", lengths[length],
+                   AdcConvert::kernel_name((AdcConvert::kernel_e)kernel), elapsed * 1E6, 1. / elapsed);
+        }
+    }
+
+    /* every channel holds waveforms for decay and render */
+    printf("\n%-8s %-8s %12s\n", "step", "kernel", "ms");
+    for (kernel = 0; kernel < AdcConvert::E_KERNEL_MAX; kernel++)
+    {
+        if (!AdcConvert::is_supported((AdcConvert::kernel_e)kernel))
+            continue;
+        buffer.setKernel((AdcConvert::kernel_e)kernel);
+        buffer.clear();
+        for (ch = 0; ch < PERSISTENCE_MAX_CHANNELS; ch++)
+            for (w = ch; w < BENCH_WAVEFORMS; w += PERSISTENCE_MAX_CHANNELS)
+                buffer.addRaw(ch, raw[w], 16 * 1024, BENCH_SCALE, 0.f, 0., BENCH_INTERVAL * 64);
+        start = now();
+        for (round = 0; round < BENCH_ROUNDS; round++)
+            buffer.decay(0.99);
+        elapsed = (now() - start) / BENCH_ROUNDS;
+        printf("%-8s %-8s %12.3lf\n", "decay", AdcConvert::kernel_name((AdcConvert::kernel_e)kernel), elapsed * 1E3);
+        start = now();
+        for (round = 0; round < BENCH_ROUNDS; round++)
+            buffer.render(pixels, BENCH_WIDTH);
+        elapsed = (now() - start) / BENCH_ROUNDS;
+        printf("%-8s %-8s %12.3lf\n", "render", AdcConvert::kernel_name((AdcConvert::kernel_e)kernel), elapsed * 1E3);
+    }
+
+    for (w = 0; w < BENCH_WAVEFORMS; w++)
+        free(raw[w]);
+    free(pixels);
+    free(reference);
+    return ok ? 0 : 1;
+}
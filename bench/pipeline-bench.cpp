@@ -0,0 +1,520 @@
+/*****************************************************************************
+*   Copyright 2012 Vincent HERVIEUX
+*
+*   This file is part of QPicoscope.
+*
+*   QPicoscope is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU Lesser General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   any later version.
+*
+*   QPicoscope is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU Lesser General Public License for more details.
+*
+*   You should have received a copy of the GNU Lesser General Public License
+*   along with QPicoscope in files COPYING.LESSER and COPYING.
+*   If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+/**
+ * @file pipeline-bench.cpp
+ * @brief End to end throughput and latency of the block pipeline, from
+ * the acquisition thread to decimated columns, without hardware and
+ * without a display. A simulated unit, or a recording when
+ * QPICOSCOPE_PLAYBACK is set, runs as fast as possible into a screen
+ * stand-in that does what Screen does per frame, off the GUI thread:
+ * take the newest frame, index each channel in a MinMaxPyramid and
+ * decimate it to a full HD canvas.
+ * Every record length, channel count and timebase of the matrix reports
+ * samples/s, waveforms/s, percentiles of each stage and peak RSS, and is
+ * written to a JSON file, pipeline-bench.json unless a path is given, so
+ * that two builds are compared with a diff. Exits 1 if a frame is wrong
+ * or none is drawn.
+ * Tables of new captures, of the same length and ending on the same
+ * sample as the previous one, and tables appended to, are first taken
+ * through the frame queue and the pyramid as Screen takes them: each
+ * must be indexed as its capture, not as the previous one.
+ * @version 0.1
+ * @date 2026, october 16
+ * @author Vincent HERVIEUX    -   10.16.2026   -   initial creation
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/utsname.h>
+#include <algorithm>
+#include <vector>
+
+#include "drawdata.h"
+#include "framequeue.h"
+#include "minmaxpyramid.h"
+#include "decimator.h"
+#include "acquisitionsim.h"
+#include "acquisitionplayback.h"
+#include "benchclock.h"
+
+#define BENCH_COLUMNS       1920
+#define BENCH_DURATION      0.5
+#define BENCH_MAX_RATE      1E9
+/* publish times are kept for the frames the screen may still take */
+#define BENCH_PUBLISHED     64
+#define BENCH_IDLE          0.0001
+
+static const uint32_t record_lengths[] = { 16384, 262144, 4194304 };
+static const uint8_t nb_channels[] = { 1, 2, 4 };
+static const double timebases[] = { 1E-5, 1E-3 };
+
+typedef enum
+{
+    E_STAGE_ACQUIRE = 0,
+    E_STAGE_PUBLISH,
+    E_STAGE_LATENCY,
+    E_STAGE_INDEX,
+    E_STAGE_DECIMATE,
+    E_STAGE_MAX
+} stage_e;
+
+static const char *stage_names[E_STAGE_MAX] = { "acquire", "publish", "latency", "index", "decimate" };
+
+typedef struct
+{
+    double p50;
+    double p90;
+    double p99;
+    double max;
+} percentiles_t;
+
+/****************************************************************************
+ * peak_rss_reset
+ *  Linux only, the peak stays the process one elsewhere.
+ ****************************************************************************/
+static void peak_rss_reset(void)
+{
+    FILE *file = fopen("/proc/self/clear_refs", "w");
+
+    if (NULL != file)
+    {
+        fputs("5", file);
+        fclose(file);
+    }
+}
+
+/****************************************************************************
+ * peak_rss
+ *  In kB, 0 when unknown.
+ ****************************************************************************/
+static unsigned long peak_rss(void)
+{
+    FILE *file = fopen("/proc/self/status", "r");
+    char line[128];
+    unsigned long rss = 0;
+
+    if (NULL == file)
+        return 0;
+    while (NULL != fgets(line, sizeof(line), file))
+    {
+        if (1 == sscanf(line, "VmHWM: %lu kB", &rss))
+            break;
+    }
+    fclose(file);
+    return rss;
+}
+
+/****************************************************************************
+ * percentiles
+ ****************************************************************************/
+static percentiles_t percentiles(std::vector<double> &values)
+{
+    percentiles_t result;
+
+    memset(&result, 0, sizeof(result));
+    if (values.empty())
+        return result;
+    std::sort(values.begin(), values.end());
+    result.p50 = values[(values.size() - 1) * 50 / 100];
+    result.p90 = values[(values.size() - 1) * 90 / 100];
+    result.p99 = values[(values.size() - 1) * 99 / 100];
+    result.max = values.back();
+    return result;
+}
+
+/****************************************************************************
+ * BenchScreen
+ *
+ * The producer side is the one of Screen, the consumer runs in its own
+ * thread instead of the GUI event loop and draws nothing.
+ ****************************************************************************/
+class BenchScreen : public DrawData
+{
+public:
+    BenchScreen() : running_m(false), thread_id_m(0), last_publish_m(0.) {}
+
+    int8_t setData(uint8_t channel_id, double *x_data, double *y_data, uint32_t nb_points)
+    {
+        return frames_m.setChannel(channel_id, x_data, y_data, nb_points);
+    }
+    int8_t setRawData(uint8_t channel_id, const int16_t *raw, uint32_t nb_points,
+                      float scale, float offset, double x_origin, double x_interval, bool append)
+    {
+        if (0. == publish_start_m)
+            publish_start_m = now();
+        samples_m += nb_points;
+        return frames_m.setRawChannel(channel_id, raw, nb_points, scale, offset, x_origin, x_interval, append);
+    }
+    int8_t publishData(void)
+    {
+        double current = now();
+
+        ATOMIC_STORE_RELAXED(&published_at_m[next_sequence() % BENCH_PUBLISHED], (uint64_t)(current * 1E9));
+        if (frames_m.publish())
+            waveforms_m++;
+        if (0. != last_publish_m)
+            stages_m[E_STAGE_ACQUIRE].push_back(publish_start_m - last_publish_m);
+        last_publish_m = now();
+        stages_m[E_STAGE_PUBLISH].push_back(last_publish_m - publish_start_m);
+        publish_start_m = 0.;
+        return 0;
+    }
+
+    void start(void)
+    {
+        uint8_t stage = 0;
+
+        for (stage = 0; stage < E_STAGE_MAX; stage++)
+            stages_m[stage].clear();
+        samples_m = 0;
+        waveforms_m = 0;
+        drawn_m = 0;
+        errors_m = 0;
+        last_publish_m = 0.;
+        publish_start_m = 0.;
+        running_m = true;
+        pthread_create(&thread_id_m, NULL, thread_draw, this);
+    }
+    void stop(void)
+    {
+        ATOMIC_STORE_RELEASE(&running_m, false);
+        pthread_join(thread_id_m, NULL);
+    }
+
+    std::vector<double> stages_m[E_STAGE_MAX];
+    uint64_t samples_m;
+    uint64_t waveforms_m;
+    uint64_t drawn_m;
+    uint64_t errors_m;
+
+private:
+    /** @brief sequence the next published frame gets, frames are numbered from 0 */
+    uint64_t next_sequence(void)
+    {
+        FrameQueue::stats_t stats;
+
+        frames_m.getStats(&stats);
+        return stats.published;
+    }
+
+    static void* thread_draw(void *arg)
+    {
+        BenchScreen *screen = (BenchScreen*)arg;
+
+        while (ATOMIC_LOAD_ACQUIRE(&screen->running_m))
+        {
+            if (!screen->draw())
+            {
+                struct timespec idle = { 0, (long)(BENCH_IDLE * 1E9) };
+                nanosleep(&idle, NULL);
+            }
+        }
+        /* the last frame too, as the GUI would */
+        while (screen->draw())
+            ;
+        return NULL;
+    }
+
+    /** @brief Screen::consumeFrame() and updateRawCurve() without the curves */
+    bool draw(void)
+    {
+        const FrameQueue::frame_t *frame = frames_m.takeLatest();
+        const FrameQueue::channel_frame_t *channel = NULL;
+        double start = 0.;
+        double indexed = 0.;
+        double index_time = 0.;
+        double decimate_time = 0.;
+        uint32_t nb_points = 0;
+        uint8_t ch = 0;
+
+        if (NULL == frame)
+            return false;
+        start = now();
+        stages_m[E_STAGE_LATENCY].push_back(start - ATOMIC_LOAD_RELAXED(&published_at_m[frame->sequence % BENCH_PUBLISHED]) * 1E-9);
+        for (ch = 0; ch < FRAME_QUEUE_MAX_CHANNELS; ch++)
+        {
+            if (0 == (frame->channel_mask & (1 << ch)))
+                continue;
+            channel = &frame->channels[ch];
+            if (!channel->is_raw)
+            {
+                errors_m++;
+                continue;
+            }
+            start = now();
+            if (!pyramids_m[ch].assign(channel->capture, channel->raw, channel->nb_points))
+            {
+                errors_m++;
+                continue;
+            }
+            indexed = now();
+            nb_points = decimator_m.decimate(pyramids_m[ch], channel->scale, channel->offset,
+                                             channel->x_origin, channel->x_interval, channel->x_origin,
+                                             channel->x_origin + channel->nb_points * channel->x_interval,
+                                             BENCH_COLUMNS);
+            index_time += indexed - start;
+            decimate_time += now() - indexed;
+            /* a min and a max per column at most */
+            if ((0 == nb_points) || (nb_points > 2 * BENCH_COLUMNS + 2))
+                errors_m++;
+        }
+        stages_m[E_STAGE_INDEX].push_back(index_time);
+        stages_m[E_STAGE_DECIMATE].push_back(decimate_time);
+        frames_m.release();
+        drawn_m++;
+        return true;
+    }
+
+    FrameQueue frames_m;
+    MinMaxPyramid pyramids_m[FRAME_QUEUE_MAX_CHANNELS];
+    Decimator decimator_m;
+    bool running_m;
+    pthread_t thread_id_m;
+    /** @brief in ns, written by the acquisition thread */
+    uint64_t published_at_m[BENCH_PUBLISHED];
+    double last_publish_m;
+    double publish_start_m;
+};
+
+/****************************************************************************
+ * check_table
+ *
+ * Publish a table of channel 1 and take the newest frame as Screen does,
+ * the pyramid must then hold exactly that table.
+ ****************************************************************************/
+static bool check_table(FrameQueue &frames, MinMaxPyramid &pyramid, const char *name,
+                        const int16_t *raw, uint32_t nb_points, bool append, bool publish_only)
+{
+    const FrameQueue::frame_t *frame = NULL;
+    int16_t minimum = INT16_MAX;
+    int16_t maximum = INT16_MIN;
+    int16_t lo = 0;
+    int16_t hi = 0;
+    uint32_t i = 0;
+
+    frames.setRawChannel(1, raw, nb_points, 1E-3f, 0.f, 0., 1E-6, append);
+    frames.publish();
+    if (publish_only)
+        return true;
+    frame = frames.takeLatest();
+    if ((NULL == frame) || !frame->channels[0].is_raw)
+    {
+        ERROR("%s: no frame taken\n", name);
+        return false;
+    }
+    if (!pyramid.assign(frame->channels[0].capture, frame->channels[0].raw, frame->channels[0].nb_points))
+    {
+        frames.release();
+        ERROR("%s: cannot index %u samples\n", name, nb_points);
+        return false;
+    }
+    frames.release();
+
+    for (i = 0; i < nb_points; i++)
+    {
+        if (raw[i] < minimum)
+            minimum = raw[i];
+        if (raw[i] > maximum)
+            maximum = raw[i];
+    }
+    pyramid.minMax(0, pyramid.size(), &lo, &hi);
+    if ((pyramid.size() != nb_points) || (0 != memcmp(pyramid.data(), raw, nb_points * sizeof(int16_t))) ||
+        (lo != minimum) || (hi != maximum))
+    {
+        ERROR("%s: %u samples indexed, [%d, %d] instead of %u, [%d, %d]\n", name, pyramid.size(), lo, hi,
+              nb_points, minimum, maximum);
+        return false;
+    }
+    return true;
+}
+
+/****************************************************************************
+ * check_captures
+ *
+ * Like blocks of the AUTO mode: same scale, origin and length every time,
+ * the last sample the same as in the previous block.
+ ****************************************************************************/
+static bool check_captures(void)
+{
+    const uint32_t nb_points = 65536;
+    std::vector<int16_t> first(nb_points + nb_points / 2);
+    std::vector<int16_t> second(nb_points + nb_points / 2);
+    FrameQueue frames;
+    MinMaxPyramid pyramid;
+    uint32_t i = 0;
+    bool ok = true;
+
+    for (i = 0; i < first.size(); i++)
+    {
+        first[i] = (int16_t)((i % 1000 < 500) ? 100 : -100);
+        second[i] = (int16_t)((i % 777) * 3 - 1000);
+    }
+    first[nb_points - 1] = second[nb_points - 1] = 127;
+
+    ok = check_table(frames, pyramid, "first capture", &first[0], nb_points, false, false) && ok;
+    ok = check_table(frames, pyramid, "same length capture", &second[0], nb_points, false, false) && ok;
+    ok = check_table(frames, pyramid, "longer capture", &first[0], (uint32_t)first.size(), false, false) && ok;
+    ok = check_table(frames, pyramid, "shorter capture", &second[0], nb_points / 2, false, false) && ok;
+    ok = check_table(frames, pyramid, "appended blocks", &second[0], nb_points, true, false) && ok;
+    ok = check_table(frames, pyramid, "appended blocks", &second[0], (uint32_t)second.size(), true, false) && ok;
+    /* the new capture is skipped by takeLatest(), its blocks are not appended to the old one */
+    ok = check_table(frames, pyramid, "skipped capture", &first[0], nb_points, false, true) && ok;
+    ok = check_table(frames, pyramid, "after a skipped capture", &first[0], (uint32_t)first.size(), true, false) && ok;
+    return ok;
+}
+
+/****************************************************************************
+ * bench_case
+ ****************************************************************************/
+static bool bench_case(Acquisition *unit, BenchScreen &screen, FILE *json, bool *first,
+                       uint32_t record_length, uint8_t channels, double timebase)
+{
+    percentiles_t stage[E_STAGE_MAX];
+    unsigned long rss = 0;
+    double elapsed = 0.;
+    uint8_t i = 0;
+    bool ok = true;
+
+    unit->set_record_length(record_length);
+    unit->set_timebase(timebase);
+    peak_rss_reset();
+
+    elapsed = now();
+    screen.start();
+    unit->start();
+    usleep((useconds_t)(BENCH_DURATION * 1E6));
+    unit->stop();
+    screen.stop();
+    elapsed = now() - elapsed;
+    rss = peak_rss();
+
+    for (i = 0; i < E_STAGE_MAX; i++)
+        stage[i] = percentiles(screen.stages_m[i]);
+    if ((0 == screen.drawn_m) || (0 != screen.errors_m))
+    {
+        ERROR("%u samples %d channels %g s/div: %llu frames drawn, %llu errors\n", record_length, channels, timebase,
+              (unsigned long long)screen.drawn_m, (unsigned long long)screen.errors_m);
+        ok = false;
+    }
+
+    printf("%9u %3d %8.0e %10.1f %10.1f %10.1f", record_length, channels, timebase,
+           screen.samples_m / elapsed * 1E-6, screen.waveforms_m / elapsed, screen.drawn_m / elapsed);
+    for (i = 0; i < E_STAGE_MAX; i++)
+        printf(" %9.1f", stage[i].p99 * 1E6);
+    printf(" %9lu\n", rss / 1024);
+
+    fprintf(json, "%s\n    {\"record_length\": %u, \"channels\": %d, \"timebase\": %g, \"ok\": %s,\n"
+            "     \"samples_per_s\": %.0f, \"waveforms_per_s\": %.1f, \"drawn_per_s\": %.1f, \"peak_rss_kb\": %lu,\n"
+            "     \"stages_us\": {",
+            *first ? "" : ",", record_length, channels, timebase, ok ? "true" : "false",
+            screen.samples_m / elapsed, screen.waveforms_m / elapsed, screen.drawn_m / elapsed, rss);
+    for (i = 0; i < E_STAGE_MAX; i++)
+    {
+        fprintf(json, "%s\n       \"%s\": {\"p50\": %.2f, \"p90\": %.2f, \"p99\": %.2f, \"max\": %.2f}",
+                (0 == i) ? "" : ",", stage_names[i],
+                stage[i].p50 * 1E6, stage[i].p90 * 1E6, stage[i].p99 * 1E6, stage[i].max * 1E6);
+    }
+    fprintf(json, "}}");
+    *first = false;
+    return ok;
+}
+
+/****************************************************************************
+ * main
+ ****************************************************************************/
+int main(int argc, char **argv)
+{
+    const char *path = (argc > 1) ? argv[1] : "pipeline-bench.json";
+    const char *playback = getenv(PLAYBACK_ENV_FILE);
+    Acquisition *unit = NULL;
+    AcquisitionSim *sim = NULL;
+    BenchScreen screen;
+    struct utsname host;
+    FILE *json = NULL;
+    bool first = true;
+    bool ok = check_captures();
+    uint8_t i = 0;
+    uint8_t j = 0;
+    uint8_t k = 0;
+
+    /* as fast as the pipeline goes, whatever the source */
+    setenv(PLAYBACK_ENV_SPEED, "0", 1);
+    setenv(SIM_ENV_SPEED, "0", 1);
+    if ((NULL != playback) && ('\0' != playback[0]))
+    {
+        unit = AcquisitionPlayback::open_unit();
+    }
+    else
+    {
+        setenv(SIM_ENV_SIGNALS, "wave=sine,freq=1e5,noise=0.01;wave=square,freq=1e4;"
+                                "wave=noise,amp=0.5,glitch=1e3,glitch_amp=2;wave=triangle,freq=1e3,burst=1e-3,duty=0.5", 1);
+        unit = sim = (AcquisitionSim*)AcquisitionSim::open_unit();
+        if (NULL != sim)
+            sim->set_max_rate(BENCH_MAX_RATE);
+    }
+    if (NULL == unit)
+    {
+        ERROR("cannot open the %s source\n", (NULL != sim) || (NULL == playback) ? "simulated" : "playback");
+        return 1;
+    }
+    json = fopen(path, "w");
+    if (NULL == json)
+    {
+        ERROR("cannot create %s\n", path);
+        delete unit;
+        return 1;
+    }
+    unit->setDrawData(&screen);
+
+    memset(&host, 0, sizeof(host));
+    uname(&host);
+    fprintf(json, "{\"bench\": \"pipeline\", \"source\": \"%s\", \"host\": \"%s\", \"machine\": \"%s\", \"cpus\": %ld,\n"
+            "  \"columns\": %d, \"duration_s\": %g,\n  \"cases\": [",
+            (NULL != sim) ? "sim" : "playback", host.nodename, host.machine, sysconf(_SC_NPROCESSORS_ONLN),
+            BENCH_COLUMNS, BENCH_DURATION);
+    printf("%9s %3s %8s %10s %10s %10s", "record", "ch", "s/div", "MS/s", "wfm/s", "drawn/s");
+    for (i = 0; i < E_STAGE_MAX; i++)
+        printf(" %9s", stage_names[i]);
+    printf(" %9s\n%45s p99 in us, peak RSS in MB\n", "RSS", "");
+
+    for (i = 0; i < sizeof(record_lengths) / sizeof(record_lengths[0]); i++)
+    {
+        for (j = 0; j < sizeof(nb_channels) / sizeof(nb_channels[0]); j++)
+        {
+            /* a recording has the channels it has */
+            if ((NULL == sim) && (j > 0))
+                break;
+            if (NULL != sim)
+                sim->set_nb_channels(nb_channels[j]);
+            for (k = 0; k < sizeof(timebases) / sizeof(timebases[0]); k++)
+                ok = bench_case(unit, screen, json, &first, record_lengths[i],
+                                (NULL != sim) ? nb_channels[j] : 0, timebases[k]) && ok;
+        }
+    }
+    fprintf(json, "\n  ]}\n");
+    fclose(json);
+    printf("results written to %s\n", path);
+    delete unit;
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,184 @@
+/*****************************************************************************
+*   Copyright 2012 Vincent HERVIEUX
+*
+*   This file is part of QPicoscope.
+*
+*   QPicoscope is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU Lesser General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   any later version.
+*
+*   QPicoscope is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU Lesser General Public License for more details.
+*
+*   You should have received a copy of the GNU Lesser General Public License
+*   along with QPicoscope in files COPYING.LESSER and COPYING.
+*   If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+/**
+ * @file raster-bench.cpp
+ * @brief Time to draw 1 to 4 decimated channels of 10M counts into
+ * canvases from 640x480 to 3840x2160, with every kernel this CPU runs and
+ * 1, 2 and 4 threads. Decimation is done once, only setting the spans and
+ * rendering are timed, as by TraceRasterItem on a replot.
+ * Every image is checked against the scalar kernel in one thread, exits 1
+ * on mismatch.
+ * @version 0.1
+ * @date 2026, october 16
+ * @author Vincent HERVIEUX    -   10.16.2026   -   initial creation
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+#include "decimator.h"
+#include "minmaxpyramid.h"
+#include "traceraster.h"
+#include "benchclock.h"
+
+#define BENCH_POINTS        (10 * 1000 * 1000)
+/* 2 mV per count on the 2 V range */
+#define BENCH_SCALE         (2.f / 32767.f)
+#define BENCH_INTERVAL      1E-9
+/* +-1 V on the full height */
+#define BENCH_VOLTS         1.
+#define BENCH_ROUNDS        50
+
+static const uint32_t widths[] = { 640, 1280, 1920, 3840 };
+static const uint32_t heights[] = { 480, 720, 1080, 2160 };
+static const uint8_t threads[] = { 1, 2, 4 };
+static const uint32_t colors[TRACE_RASTER_MAX_CHANNELS] = { 0xFF00FF00, 0xFFFF0000, 0xFFFF00FF, 0xFFFFFF00 };
+
+/****************************************************************************
+ * draw
+ ****************************************************************************/
+static void draw(TraceRaster &raster, double * const *x, double * const *y, const uint32_t *count, uint8_t channels)
+{
+    double x_scale = raster.width() / (BENCH_POINTS * BENCH_INTERVAL);
+    double y_scale = -(raster.height() / (2. * BENCH_VOLTS));
+    uint8_t ch = 0;
+
+    for (ch = 0; ch < channels; ch++)
+        raster.setColumns(ch, x[ch], y[ch], count[ch], x_scale, 0., y_scale, raster.height() / 2., colors[ch]);
+    for (; ch < TRACE_RASTER_MAX_CHANNELS; ch++)
+        raster.clearChannel(ch);
+    raster.render();
+}
+
+/****************************************************************************
+ * main
+ ****************************************************************************/
+int main(void)
+{
+    int16_t *raw = (int16_t*)malloc(BENCH_POINTS * sizeof(int16_t));
+    uint32_t *reference = NULL;
+    double *x[TRACE_RASTER_MAX_CHANNELS];
+    double *y[TRACE_RASTER_MAX_CHANNELS];
+    uint32_t count[TRACE_RASTER_MAX_CHANNELS];
+    Decimator decimator;
+    MinMaxPyramid pyramid;
+    TraceRaster raster;
+    uint32_t size = 0;
+    uint32_t i = 0;
+    uint8_t channels = 0;
+    uint8_t ch = 0;
+    uint8_t t = 0;
+    int kernel = 0;
+    int round = 0;
+    double start = 0.;
+    double elapsed = 0.;
+    bool ok = true;
+
+    if (NULL == raw)
+    {
+        ERROR("cannot allocate %d samples\n", BENCH_POINTS);
+        return 1;
+    }
+    memset(x, 0, sizeof(x));
+    memset(y, 0, sizeof(y));
+
+    printf("%-10s %-3s %-8s %-7s %10s %12s\n", "size", "ch", "kernel", "threads", "ms", "Mpixels/s");
+    for (size = 0; size < sizeof(widths) / sizeof(widths[0]); size++)
+    {
+        reference = (uint32_t*)realloc(reference, (size_t)(widths[size] + TRACE_RASTER_ALIGN) * heights[size] * sizeof(uint32_t));
+        if ((NULL == reference) || !raster.resize(widths[size], heights[size]))
+        {
+            ERROR("cannot allocate a %ux%u image\n", widths[size], heights[size]);
+            return 1;
+        }
+        /* channels are noisy sines of a few periods with glitches, in four amplitudes */
+        for (ch = 0; ch < TRACE_RASTER_MAX_CHANNELS; ch++)
+        {
+            srand(ch + 1);
+            for (i = 0; i < BENCH_POINTS; i++)
+            {
+                raw[i] = (int16_t)(sin(i * (ch + 1) * 2E-6) * 8000. * (ch + 1) + (rand() % 1024) - 512);
+                if (0 == (i % 777777))
+                    raw[i] = 32767;
+            }
+            pyramid.clear();
+            if (!pyramid.append(raw, BENCH_POINTS))
+            {
+                ERROR("cannot index %d samples\n", BENCH_POINTS);
+                return 1;
+            }
+            count[ch] = decimator.decimate(pyramid, BENCH_SCALE, 0.f, 0., BENCH_INTERVAL,
+                                           0., BENCH_POINTS * BENCH_INTERVAL, widths[size]);
+            x[ch] = (double*)realloc(x[ch], count[ch] * sizeof(double));
+            y[ch] = (double*)realloc(y[ch], count[ch] * sizeof(double));
+            memcpy(x[ch], decimator.x(), count[ch] * sizeof(double));
+            memcpy(y[ch], decimator.y(), count[ch] * sizeof(double));
+        }
+
+        for (channels = 1; channels <= TRACE_RASTER_MAX_CHANNELS; channels++)
+        {
+            raster.setThreads(1);
+            raster.setKernel(AdcConvert::E_KERNEL_SCALAR);
+            draw(raster, x, y, count, channels);
+            memcpy(reference, raster.pixels(), (size_t)raster.stride() * raster.height() * sizeof(uint32_t));
+
+            for (kernel = 0; kernel < AdcConvert::E_KERNEL_MAX; kernel++)
+            {
+                if (!AdcConvert::is_supported((AdcConvert::kernel_e)kernel))
+                    continue;
+                raster.setKernel((AdcConvert::kernel_e)kernel);
+                for (t = 0; t < sizeof(threads) / sizeof(threads[0]); t++)
+                {
+                    if (!raster.setThreads(threads[t]))
+                    {
+                        ok = false;
+                        continue;
+                    }
+                    start = now();
+                    for (round = 0; round < BENCH_ROUNDS; round++)
+                        draw(raster, x, y, count, channels);
+                    elapsed = (now() - start) / BENCH_ROUNDS;
+                    if (0 != memcmp(reference, raster.pixels(), (size_t)raster.stride() * raster.height() * sizeof(uint32_t)))
+                    {
+                        ERROR("%s kernel with %u threads differs from scalar on %ux%u, %u channels\n",
+                              AdcConvert::kernel_name((AdcConvert::kernel_e)kernel), threads[t],
+                              widths[size], heights[size], channels);
+                        ok = false;
+                        continue;
+                    }
+                    printf("%4ux%-5u %-3u %-8s %-7u %10.3lf %12.1lf\n", widths[size], heights[size], channels,
+                           AdcConvert::kernel_name((AdcConvert::kernel_e)kernel), threads[t],
+                           elapsed * 1E3, (double)widths[size] * heights[size] / elapsed * 1E-6);
+                }
+            }
+        }
+    }
+
+    for (ch = 0; ch < TRACE_RASTER_MAX_CHANNELS; ch++)
+    {
+        free(x[ch]);
+        free(y[ch]);
+    }
+    free(reference);
+    free(raw);
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,260 @@
+/*****************************************************************************
+*   Copyright 2012 Vincent HERVIEUX
+*
+*   This file is part of QPicoscope.
+*
+*   QPicoscope is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU Lesser General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   any later version.
+*
+*   QPicoscope is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU Lesser General Public License for more details.
+*
+*   You should have received a copy of the GNU Lesser General Public License
+*   along with QPicoscope in files COPYING.LESSER and COPYING.
+*   If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+/**
+ * @file recorder-bench.cpp
+ * @brief Sustained recording throughput. A synthetic two channel stream
+ * goes through a StreamPipeline into a CaptureRecorder writing in
+ * $TMPDIR, at paced rates then as fast as the disk goes. Every file is
+ * read back: index, chunk headers and samples must match what was
+ * streamed, lost chunks included. The streams the hardware can produce
+ * must be recorded without any dropped chunk. Exits 1 when a check fails.
+ * @version 0.1
+ * @date 2026, october 16
+ * @author Vincent HERVIEUX    -   10.16.2026   -   initial creation
+ */
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <vector>
+
+#include "streampipeline.h"
+#include "capturerecorder.h"
+#include "benchclock.h"
+
+#define BENCH_CHANNELS      2
+#define BENCH_PATTERN       65536
+#define BENCH_BLOCK         (64 * 1024)
+#define BENCH_DURATION      1.0
+#define BENCH_CHANNEL_XOR   0x5555
+/* the fastest stream a unit produces, with margin */
+#define BENCH_REQUIRED_RATE 4E6
+
+/* 0 is as fast as the disk goes */
+static const double rates[] = { 1E6, 4E6, 16E6, 64E6, 0. };
+
+static int16_t pattern[BENCH_CHANNELS][BENCH_PATTERN + BENCH_BLOCK];
+
+/****************************************************************************
+ * stream
+ *
+ * Feeds the pipeline for BENCH_DURATION, waiting for room in the ring so
+ * that only the recorder may lose samples.
+ ****************************************************************************/
+static uint64_t stream(StreamPipeline &pipeline, double rate, double *elapsed)
+{
+    const int16_t *channels[BENCH_CHANNELS];
+    double start = now();
+    uint64_t produced = 0;
+    uint32_t offset = 0;
+    uint8_t ch = 0;
+
+    while (now() - start < BENCH_DURATION)
+    {
+        if (pipeline.get_room() < BENCH_BLOCK)
+        {
+            sleep_until(now() + 0.0005);
+            continue;
+        }
+        offset = (uint32_t)(produced % BENCH_PATTERN);
+        for (ch = 0; ch < BENCH_CHANNELS; ch++)
+            channels[ch] = pattern[ch] + offset;
+        pipeline.write(channels, BENCH_BLOCK);
+        produced += BENCH_BLOCK;
+        if (rate > 0.)
+            sleep_until(start + produced / rate);
+    }
+    *elapsed = now() - start;
+    return produced;
+}
+
+/****************************************************************************
+ * check_file
+ *
+ * Walks the index, every chunk must be where the index says, start where
+ * the previous one ended plus the lost chunks, and hold the pattern.
+ ****************************************************************************/
+static bool check_file(const char *path, const CaptureRecorder::stats_t &stats, uint64_t produced)
+{
+    std::vector<capture_index_t> index;
+    std::vector<uint8_t> chunk_data;
+    capture_header_t header;
+    capture_trailer_t trailer;
+    const capture_chunk_t *chunk = NULL;
+    const int16_t *table = NULL;
+    uint64_t expected = 0;
+    uint64_t errors = 0;
+    uint64_t gaps = 0;
+    uint64_t size = 0;
+    uint32_t c = 0;
+    uint32_t i = 0;
+    uint8_t ch = 0;
+    uint8_t k = 0;
+    int fd = open(path, O_RDONLY);
+    bool ok = false;
+
+    if (fd < 0)
+        return false;
+    size = lseek(fd, 0, SEEK_END);
+    if ((sizeof(header) != pread(fd, &header, sizeof(header), 0)) ||
+        (sizeof(trailer) != pread(fd, &trailer, sizeof(trailer), size - sizeof(trailer))) ||
+        (CAPTURE_HEADER_MAGIC != header.magic) || (CAPTURE_TRAILER_MAGIC != trailer.magic) ||
+        (0 != size % CAPTURE_ALIGNMENT))
+    {
+        ERROR("%s: no header or no trailer\n", path);
+        goto out;
+    }
+    if ((trailer.nb_chunks != stats.chunks_written) || (trailer.nb_samples + trailer.samples_lost != produced))
+    {
+        ERROR("%s: %llu chunks of %llu samples, %llu lost, %llu streamed\n", path,
+              (unsigned long long)trailer.nb_chunks, (unsigned long long)trailer.nb_samples,
+              (unsigned long long)trailer.samples_lost, (unsigned long long)produced);
+        goto out;
+    }
+    index.resize(trailer.nb_chunks);
+    if ((trailer.nb_chunks > 0) &&
+        ((ssize_t)(index.size() * sizeof(capture_index_t)) !=
+         pread(fd, &index[0], index.size() * sizeof(capture_index_t), trailer.index_offset)))
+    {
+        ERROR("%s: no index\n", path);
+        goto out;
+    }
+
+    for (c = 0; c < index.size(); c++)
+    {
+        chunk_data.resize(sizeof(capture_chunk_t));
+        pread(fd, &chunk_data[0], sizeof(capture_chunk_t), index[c].offset);
+        chunk = (const capture_chunk_t*)&chunk_data[0];
+        if ((CAPTURE_CHUNK_MAGIC != chunk->magic) || (chunk->start_sample != index[c].start_sample) ||
+            (chunk->nb_samples != index[c].nb_samples) || (0 != index[c].offset % CAPTURE_ALIGNMENT))
+        {
+            ERROR("%s: chunk %u does not match the index\n", path, c);
+            goto out;
+        }
+        /* the recorder drops whole chunks, nothing else may be missing */
+        if (chunk->start_sample != expected)
+            gaps++;
+        size = capture_chunk_size(chunk);
+        chunk_data.resize(size);
+        pread(fd, &chunk_data[0], size, index[c].offset);
+        chunk = (const capture_chunk_t*)&chunk_data[0];
+        for (ch = 0, k = 0; ch < BENCH_CHANNELS; ch++)
+        {
+            table = (const int16_t*)(&chunk_data[0] + chunk->header_size + k * capture_table_size(chunk->nb_samples));
+            k++;
+            for (i = 0; i < chunk->nb_samples; i++)
+            {
+                if (table[i] != pattern[ch][(chunk->start_sample + i) % BENCH_PATTERN])
+                    errors++;
+            }
+        }
+        expected = chunk->start_sample + chunk->nb_samples;
+    }
+    if ((0 != errors) || ((0 == stats.chunks_dropped) && (0 != gaps)))
+    {
+        ERROR("%s: %llu wrong samples, %llu gaps\n", path, (unsigned long long)errors, (unsigned long long)gaps);
+        goto out;
+    }
+    ok = true;
+out:
+    close(fd);
+    return ok;
+}
+
+/****************************************************************************
+ * main
+ ****************************************************************************/
+int main(void)
+{
+    StreamSink::stream_format_t format;
+    CaptureRecorder::stats_t stats;
+    StreamPipeline pipeline;
+    CaptureRecorder recorder;
+    const char *directory = getenv("TMPDIR");
+    char path[256];
+    uint64_t produced = 0;
+    double elapsed = 0.;
+    double closed = 0.;
+    uint32_t i = 0;
+    uint32_t run = 0;
+    bool ok = true;
+
+    for (i = 0; i < BENCH_PATTERN + BENCH_BLOCK; i++)
+    {
+        pattern[0][i] = (int16_t)i;
+        pattern[1][i] = (int16_t)(i ^ BENCH_CHANNEL_XOR);
+    }
+    if (NULL == directory)
+        directory = "/tmp";
+    snprintf(path, sizeof(path), "%s/recorder-bench-%d.qpcap", directory, (int)getpid());
+
+    memset(&format, 0, sizeof(format));
+    format.nb_channels = BENCH_CHANNELS;
+    format.channel_mask = (1 << BENCH_CHANNELS) - 1;
+    format.scale[0] = format.scale[1] = 1.f;
+
+    printf("%-10s %10s %10s %10s %10s %8s %8s %8s\n", "MS/s asked", "MS/s got", "MB/s", "disk MB/s",
+           "MB", "chunks", "dropped", "queue");
+    for (run = 0; run < sizeof(rates) / sizeof(rates[0]); run++)
+    {
+        if (!recorder.open(path))
+        {
+            ERROR("cannot record in %s\n", path);
+            return 1;
+        }
+        format.sample_interval = (rates[run] > 0.) ? 1. / rates[run] : 1E-8;
+        pipeline.add_sink(&recorder);
+        pipeline.start(format);
+        produced = stream(pipeline, rates[run], &elapsed);
+        pipeline.stop();
+        pipeline.remove_sink(&recorder);
+        closed = now();
+        recorder.close();
+        elapsed += now() - closed;
+        recorder.get_stats(&stats);
+
+        printf("%-10.1lf %10.1lf %10.1lf %10.1lf %10.1lf %8llu %8llu %8u\n", rates[run] * 1E-6,
+               produced / elapsed * 1E-6, stats.bytes_written / elapsed * 1E-6,
+               (stats.write_time > 0.) ? stats.bytes_written / stats.write_time * 1E-6 : 0.,
+               stats.bytes_written * 1E-6, (unsigned long long)stats.chunks_written,
+               (unsigned long long)stats.chunks_dropped, stats.queue_high_water);
+        fflush(stdout);
+
+        if (!check_file(path, stats, produced))
+            ok = false;
+        if ((0 != stats.write_errors) || (0 != stats.samples_dropped))
+        {
+            ERROR("%u write errors, %llu samples dropped by the stream\n", stats.write_errors,
+                  (unsigned long long)stats.samples_dropped);
+            ok = false;
+        }
+        if ((rates[run] > 0.) && (rates[run] <= BENCH_REQUIRED_RATE) && (0 != stats.chunks_dropped))
+        {
+            ERROR("chunks dropped at %.0lf samples/s\n", rates[run]);
+            ok = false;
+        }
+        unlink(path);
+    }
+    return ok ? 0 : 1;
+}
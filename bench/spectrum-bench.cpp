@@ -0,0 +1,328 @@
+/*****************************************************************************
+*   Copyright 2012 Vincent HERVIEUX
+*
+*   This file is part of QPicoscope.
+*
+*   QPicoscope is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU Lesser General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   any later version.
+*
+*   QPicoscope is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU Lesser General Public License for more details.
+*
+*   You should have received a copy of the GNU Lesser General Public License
+*   along with QPicoscope in files COPYING.LESSER and COPYING.
+*   If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+/**
+ * @file spectrum-bench.cpp
+ * @brief Transforms per second of the power spectrum of 1k to 1M samples,
+ * by one FFT plan alone then end to end through the SpectrumWorker pool
+ * with 2 channels per waveform, for one thread and for the default count.
+ * Plans are checked against a direct DFT, and the level of a 1 V sine
+ * against -3.01 dBV for every window, exits 1 on failure.
+ * @version 0.1
+ * @date 2026, october 16
+ * @author Vincent HERVIEUX    -   10.16.2026   -   initial creation
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+#include "fftplan.h"
+#include "spectrumworker.h"
+#include "benchclock.h"
+
+#define BENCH_MAX_POINTS    (1024 * 1024)
+/* 2 mV per count on the 2 V range */
+#define BENCH_SCALE         (2.f / 32767.f)
+#define BENCH_INTERVAL      1E-9
+/* seconds spent on each record length */
+#define BENCH_DURATION      1.
+/* relative error to the DFT, and dB of a sine to its rms level */
+#define BENCH_DFT_ERROR     1E-5
+#define BENCH_LEVEL_ERROR   0.05
+#define BENCH_FLAT_ERROR    0.02
+#define BENCH_CHECK_POINTS  4096
+
+static const uint32_t lengths[] = { 1024, 16 * 1024, 128 * 1024, 1024 * 1024 };
+
+/****************************************************************************
+ * check_plans
+ ****************************************************************************/
+static bool check_plans(void)
+{
+    float input[BENCH_CHECK_POINTS];
+    float work[BENCH_CHECK_POINTS];
+    float power[BENCH_CHECK_POINTS / 2 + 1];
+    FftPlan plan;
+    uint32_t size = 0;
+    uint32_t i = 0;
+    uint32_t k = 0;
+    double re = 0.;
+    double im = 0.;
+    double error = 0.;
+    double total = 0.;
+
+    srand(1);
+    for (size = FFT_PLAN_MIN_SIZE; size <= BENCH_CHECK_POINTS; size *= 2)
+    {
+        if (!plan.init(size))
+            return false;
+        for (i = 0; i < size; i++)
+            input[i] = (float)(rand() % 2001 - 1000) * 1E-3f;
+        plan.power(input, work, power);
+        error = 0.;
+        total = 0.;
+        for (k = 0; k <= size / 2; k++)
+        {
+            re = 0.;
+            im = 0.;
+            for (i = 0; i < size; i++)
+            {
+                re += input[i] * cos(2. * M_PI * ((uint64_t)i * k % size) / size);
+                im -= input[i] * sin(2. * M_PI * ((uint64_t)i * k % size) / size);
+            }
+            error += fabs(power[k] - (re * re + im * im));
+            total += re * re + im * im;
+        }
+        if (error > total * BENCH_DFT_ERROR)
+        {
+            ERROR("%u points FFT differs from the DFT by %g\n", size, error / total);
+            return false;
+        }
+    }
+    return true;
+}
+
+/****************************************************************************
+ * wait_view
+ *
+ * One waveform through a single thread, then its view once rendered.
+ ****************************************************************************/
+static bool wait_view(SpectrumWorker &worker, const int16_t *raw, uint32_t nb_points, double *peak)
+{
+    SpectrumWorker::view_t view;
+    SpectrumWorker::stats_t stats;
+    uint64_t transforms = 0;
+    uint64_t views = 0;
+    uint32_t i = 0;
+    int tries = 0;
+
+    worker.getStats(&stats);
+    transforms = stats.transforms;
+    views = worker.viewCount();
+    worker.setRawChannel(1, raw, nb_points, BENCH_SCALE, 0.f, 0., BENCH_INTERVAL);
+    worker.publish();
+    for (tries = 0; tries < 100; tries++)
+    {
+        worker.getStats(&stats);
+        if ((stats.transforms > transforms) && (worker.viewCount() != views))
+            break;
+        sleep_for(0.01);
+    }
+    if (!worker.lockView(&view))
+        return false;
+    *peak = -1000.;
+    for (i = 0; i < view.nb_points[0]; i++)
+    {
+        if (view.db[0][i] > *peak)
+            *peak = view.db[0][i];
+    }
+    worker.unlockView();
+    return true;
+}
+
+/****************************************************************************
+ * check_levels
+ *
+ * A sine of full scale amplitude on a bin and between two bins: every
+ * window gives its rms level on a bin, the flat-top one between bins too.
+ ****************************************************************************/
+static bool check_levels(void)
+{
+    int16_t raw[BENCH_CHECK_POINTS];
+    SpectrumWorker worker;
+    uint8_t window = 0;
+    uint32_t i = 0;
+    int offset = 0;
+    double amplitude = 1.;
+    double cycles = 0.;
+    double expected = 10. * log10(amplitude * amplitude / 2.);
+    double peak = 0.;
+    bool ok = true;
+
+    if (!worker.start(1))
+        return false;
+    printf("%-16s %10s %10s\n", "window", "on bin", "between");
+    for (window = 0; window < SpectrumWorker::E_WINDOW_MAX; window++)
+    {
+        worker.setWindow((SpectrumWorker::window_e)window);
+        printf("%-16s", SpectrumWorker::windowName((SpectrumWorker::window_e)window));
+        for (offset = 0; offset < 2; offset++)
+        {
+            /* amplitude in counts is rounded, the expected level stays 1 V */
+            cycles = 100.5 * BENCH_CHECK_POINTS / 1024. + 0.5 * offset;
+            for (i = 0; i < BENCH_CHECK_POINTS; i++)
+                raw[i] = (int16_t)floor(amplitude / BENCH_SCALE * sin(2. * M_PI * cycles * i / BENCH_CHECK_POINTS) + 0.5);
+            if (!wait_view(worker, raw, BENCH_CHECK_POINTS, &peak))
+            {
+                ERROR("no spectrum for the %s window\n", SpectrumWorker::windowName((SpectrumWorker::window_e)window));
+                return false;
+            }
+            printf(" %+10.3lf", peak - expected);
+            if ((fabs(peak - expected) > BENCH_LEVEL_ERROR) && (0 == offset))
+                ok = false;
+            if ((fabs(peak - expected) > BENCH_FLAT_ERROR) && (SpectrumWorker::E_WINDOW_FLAT_TOP == window))
+                ok = false;
+        }
+        printf(" dB\n");
+    }
+    worker.stop();
+    if (!ok)
+        ERROR("sine level off by more than %g dB\n", BENCH_LEVEL_ERROR);
+    return ok;
+}
+
+/****************************************************************************
+ * bench_plan
+ ****************************************************************************/
+static double bench_plan(const int16_t *raw, uint32_t size)
+{
+    FftPlan plan;
+    float *input = (float*)malloc(size * sizeof(float));
+    float *work = (float*)malloc(size * sizeof(float));
+    float *power = (float*)malloc((size / 2 + 1) * sizeof(float));
+    uint64_t transforms = 0;
+    uint32_t i = 0;
+    double start = 0.;
+    double elapsed = 0.;
+
+    if ((NULL == input) || (NULL == work) || (NULL == power) || !plan.init(size))
+    {
+        ERROR("cannot allocate a %u points FFT\n", size);
+        exit(1);
+    }
+    for (i = 0; i < size; i++)
+        input[i] = raw[i] * BENCH_SCALE;
+    start = now();
+    do
+    {
+        plan.power(input, work, power);
+        transforms++;
+        elapsed = now() - start;
+    } while (elapsed < BENCH_DURATION);
+    free(input);
+    free(work);
+    free(power);
+    return transforms / elapsed;
+}
+
+/****************************************************************************
+ * bench_pool
+ *
+ * Waveforms are published as long as each thread has room in its queue,
+ * the frame a thread works on holds a slot too. Nothing should be dropped.
+ ****************************************************************************/
+static double bench_pool(SpectrumWorker &worker, int16_t * const *raw, uint32_t nb_points, uint64_t *dropped)
+{
+    SpectrumWorker::stats_t stats;
+    uint64_t published = 0;
+    uint64_t transforms = 0;
+    uint64_t pending = (uint64_t)worker.getThreads() * (SPECTRUM_QUEUE_DEPTH - 2);
+    double start = 0.;
+    double elapsed = 0.;
+
+    worker.getStats(&stats);
+    published = stats.transforms / 2 + stats.dropped;
+    transforms = stats.transforms;
+    start = now();
+    do
+    {
+        worker.getStats(&stats);
+        if (published - stats.transforms / 2 - stats.dropped >= pending)
+        {
+            sleep_for(0.0002);
+            continue;
+        }
+        worker.setRawChannel(1, raw[0], nb_points, BENCH_SCALE, 0.f, 0., BENCH_INTERVAL);
+        worker.setRawChannel(2, raw[1], nb_points, BENCH_SCALE, 0.f, 0., BENCH_INTERVAL);
+        worker.publish();
+        published++;
+    } while (now() - start < BENCH_DURATION);
+    /* the last waveforms are counted */
+    do
+    {
+        sleep_for(0.0002);
+        worker.getStats(&stats);
+    } while (published > stats.transforms / 2 + stats.dropped);
+    elapsed = now() - start;
+    *dropped = stats.dropped;
+    return (stats.transforms - transforms) / elapsed;
+}
+
+/****************************************************************************
+ * main
+ ****************************************************************************/
+int main(void)
+{
+    int16_t *raw[2];
+    SpectrumWorker one;
+    SpectrumWorker pool;
+    SpectrumWorker::stats_t stats;
+    uint64_t dropped = 0;
+    uint64_t base = 0;
+    uint32_t length = 0;
+    uint32_t i = 0;
+    uint8_t ch = 0;
+    double rate = 0.;
+
+    if (!check_plans() || !check_levels())
+        return 1;
+
+    /* noisy sines on both channels */
+    srand(1);
+    for (ch = 0; ch < 2; ch++)
+    {
+        raw[ch] = (int16_t*)malloc(BENCH_MAX_POINTS * sizeof(int16_t));
+        if (NULL == raw[ch])
+        {
+            ERROR("cannot allocate %d samples\n", BENCH_MAX_POINTS);
+            return 1;
+        }
+        for (i = 0; i < BENCH_MAX_POINTS; i++)
+            raw[ch][i] = (int16_t)(sin(i * 2E-3 * (ch + 1)) * 12000. + (rand() % 1024) - 512);
+    }
+
+    if (!one.start(1) || !pool.start())
+        return 1;
+    one.setMode(SpectrumWorker::E_MODE_AVERAGE, 16);
+    pool.setMode(SpectrumWorker::E_MODE_AVERAGE, 16);
+    printf("\n%-8s %-12s %8s %12s %10s\n", "points", "stage", "threads", "transform/s", "dropped");
+    for (length = 0; length < sizeof(lengths) / sizeof(lengths[0]); length++)
+    {
+        rate = bench_plan(raw[0], lengths[length]);
+        printf("%-8u %-12s %8u %12.1lf %10s\n", lengths[length], "fft", 1, rate, "-");
+        one.getStats(&stats);
+        base = stats.dropped;
+        rate = bench_pool(one, raw, lengths[length], &dropped);
+        printf("%-8u %-12s %8u %12.1lf %10llu\n", lengths[length], "end to end", one.getThreads(), rate,
+               (unsigned long long)(dropped - base));
+        pool.getStats(&stats);
+        base = stats.dropped;
+        rate = bench_pool(pool, raw, lengths[length], &dropped);
+        printf("%-8u %-12s %8u %12.1lf %10llu\n", lengths[length], "end to end", pool.getThreads(), rate,
+               (unsigned long long)(dropped - base));
+    }
+    one.stop();
+    pool.stop();
+
+    free(raw[0]);
+    free(raw[1]);
+    return 0;
+}
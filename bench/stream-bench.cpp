@@ -0,0 +1,263 @@
+/*****************************************************************************
+*   Copyright 2012 Vincent HERVIEUX
+*
+*   This file is part of QPicoscope.
+*
+*   QPicoscope is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU Lesser General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   any later version.
+*
+*   QPicoscope is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU Lesser General Public License for more details.
+*
+*   You should have received a copy of the GNU Lesser General Public License
+*   along with QPicoscope in files COPYING.LESSER and COPYING.
+*   If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+/**
+ * @file stream-bench.cpp
+ * @brief Sustained throughput of the streaming pipeline fed by a synthetic
+ * source. A producer thread writes two channels of sequence numbered
+ * counts in blocks, like the driver callback does, and a checking sink
+ * verifies what the dispatcher hands over.
+ * At paced rates every sample must arrive, in order and without gap. At
+ * full speed the producer waits for room, which gives the most the ring
+ * and the dispatcher sustain. Overloaded, paced at twice that rate,
+ * samples are dropped but every one must be accounted for where it was
+ * lost. Exits 1 when a check fails.
+ * @version 0.1
+ * @date 2026, october 16
+ * @author Vincent HERVIEUX    -   10.16.2026   -   initial creation
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include <sched.h>
+
+#include "streampipeline.h"
+#include "benchclock.h"
+
+#define BENCH_CHANNELS      2
+/* sequence numbers wrap at 16 bits, the pattern table covers a block more */
+#define BENCH_PATTERN       65536
+#define BENCH_MAX_BLOCK     (1024 * 1024)
+/* the driver is polled about every millisecond */
+#define BENCH_POLL_PERIOD   0.001
+#define BENCH_DURATION      1.0
+/* channel B is channel A with these bits flipped */
+#define BENCH_CHANNEL_XOR   0x5555
+/* overload rate, times the full speed one */
+#define BENCH_OVERLOAD      2.
+
+static const double paced_rates[] = { 1E6, 10E6, 50E6 };
+
+static int16_t pattern[BENCH_CHANNELS][BENCH_PATTERN + BENCH_MAX_BLOCK];
+
+/****************************************************************************
+ * CheckSink
+ *
+ * Checks the channels stay aligned with each other and that the sequence
+ * goes on, a gap skipping exactly the samples dropped where they were.
+ ****************************************************************************/
+class CheckSink : public StreamSink
+{
+public:
+    CheckSink() : received_m(0), dropped_m(0), errors_m(0), expected_m(0), started_m(0), stopped_m(0) {}
+
+    void stream_start(const stream_format_t &format)
+    {
+        (void)format;
+        received_m = 0;
+        dropped_m = 0;
+        errors_m = 0;
+        expected_m = 0;
+        started_m++;
+    }
+    void stream_data(const int16_t *const *channels, uint32_t count, uint64_t dropped)
+    {
+        uint32_t i = 0;
+
+        dropped_m += dropped;
+        expected_m = (uint16_t)(expected_m + dropped);
+        for (i = 0; i < count; i++)
+        {
+            if ((int16_t)(channels[0][i] ^ BENCH_CHANNEL_XOR) != channels[1][i])
+                errors_m++;
+            if (channels[0][i] != (int16_t)(expected_m + i))
+                errors_m++;
+        }
+        expected_m = (uint16_t)(expected_m + count);
+        received_m += count;
+    }
+    void stream_stop(void)
+    {
+        stopped_m++;
+    }
+
+    uint64_t received_m;
+    uint64_t dropped_m;
+    uint64_t errors_m;
+    uint16_t expected_m;
+    int started_m;
+    int stopped_m;
+};
+
+typedef enum
+{
+    E_PRODUCER_PACED = 0,
+    /** @brief back to back blocks, waits for room in the ring */
+    E_PRODUCER_FULL_SPEED,
+    /** @brief paced above what the ring sustains, never waits for room */
+    E_PRODUCER_OVERLOAD
+} producer_e;
+
+typedef struct
+{
+    StreamPipeline *pipeline;
+    producer_e mode;
+    /** @brief samples per second when paced */
+    double rate;
+    uint32_t block;
+    uint64_t produced;
+    double elapsed;
+} producer_t;
+
+/****************************************************************************
+ * producer
+ *
+ * Writes blocks at the rate asked for like the driver callback, or back
+ * to back as soon as there is room.
+ ****************************************************************************/
+static void* producer(void *arg)
+{
+    producer_t *context = (producer_t*)arg;
+    const int16_t *channels[BENCH_CHANNELS];
+    double start = now();
+    uint32_t offset = 0;
+    uint8_t ch = 0;
+
+    context->produced = 0;
+    while (now() - start < BENCH_DURATION)
+    {
+        if ((E_PRODUCER_FULL_SPEED == context->mode) && (context->pipeline->get_room() < context->block))
+        {
+            sched_yield();
+            continue;
+        }
+        offset = (uint32_t)(context->produced % BENCH_PATTERN);
+        for (ch = 0; ch < BENCH_CHANNELS; ch++)
+            channels[ch] = pattern[ch] + offset;
+        context->pipeline->write(channels, context->block);
+        context->produced += context->block;
+        if (E_PRODUCER_FULL_SPEED != context->mode)
+            sleep_until(start + context->produced / context->rate);
+    }
+    context->elapsed = now() - start;
+    return NULL;
+}
+
+/****************************************************************************
+ * bench_stream
+ ****************************************************************************/
+static bool bench_stream(StreamPipeline &pipeline, CheckSink &sink, producer_e mode, double rate, double *received)
+{
+    static const char *names[] = { "paced", "full speed", "overload" };
+    StreamSink::stream_format_t format;
+    StreamRing::stats_t stats;
+    producer_t context;
+    pthread_t thread;
+    uint8_t ch = 0;
+    bool ok = true;
+
+    memset(&format, 0, sizeof(format));
+    format.nb_channels = BENCH_CHANNELS;
+    format.channel_mask = (1 << BENCH_CHANNELS) - 1;
+    /* full speed and overload get the ring of a 10 MS/s stream */
+    format.sample_interval = (E_PRODUCER_PACED == mode) ? 1. / rate : 1E-7;
+    for (ch = 0; ch < BENCH_CHANNELS; ch++)
+        format.scale[ch] = 1.f;
+
+    memset(&context, 0, sizeof(context));
+    context.pipeline = &pipeline;
+    context.mode = mode;
+    context.rate = rate;
+    /* not a multiple of the pattern, a gap reported at the wrong place shifts the sequence */
+    context.block = (E_PRODUCER_PACED == mode) ? (uint32_t)(rate * BENCH_POLL_PERIOD) : 60000;
+    if (context.block > BENCH_MAX_BLOCK)
+        context.block = BENCH_MAX_BLOCK;
+
+    if (!pipeline.start(format))
+    {
+        ERROR("cannot start the pipeline\n");
+        return false;
+    }
+    pthread_create(&thread, NULL, producer, &context);
+    pthread_join(thread, NULL);
+    pipeline.stop();
+    pipeline.get_stats(&stats);
+
+    if (sink.errors_m != 0)
+    {
+        ERROR("%llu samples out of sequence\n", (unsigned long long)sink.errors_m);
+        ok = false;
+    }
+    if ((stats.written + stats.dropped != context.produced) || (sink.received_m != stats.written) ||
+        (sink.dropped_m != stats.dropped))
+    {
+        ERROR("produced %llu, written %llu, dropped %llu, received %llu, reported dropped %llu\n",
+              (unsigned long long)context.produced, (unsigned long long)stats.written,
+              (unsigned long long)stats.dropped, (unsigned long long)sink.received_m,
+              (unsigned long long)sink.dropped_m);
+        ok = false;
+    }
+    if ((E_PRODUCER_OVERLOAD != mode) && (0 != stats.dropped))
+    {
+        ERROR("gaps in %s stream\n", names[mode]);
+        ok = false;
+    }
+    printf("%-12s %10.1lf %10u %12.1lf %12llu %12llu %10llu\n", names[mode], rate * 1E-6, context.block,
+           sink.received_m / context.elapsed * 1E-6, (unsigned long long)sink.received_m,
+           (unsigned long long)stats.dropped, (unsigned long long)stats.overruns);
+    if (NULL != received)
+        *received = sink.received_m / context.elapsed;
+    return ok;
+}
+
+/****************************************************************************
+ * main
+ ****************************************************************************/
+int main(void)
+{
+    StreamPipeline pipeline;
+    CheckSink sink;
+    double full_speed = 0.;
+    uint32_t i = 0;
+    int runs = 0;
+    bool ok = true;
+
+    for (i = 0; i < BENCH_PATTERN + BENCH_MAX_BLOCK; i++)
+    {
+        pattern[0][i] = (int16_t)i;
+        pattern[1][i] = (int16_t)(i ^ BENCH_CHANNEL_XOR);
+    }
+    pipeline.add_sink(&sink);
+
+    printf("%-12s %10s %10s %12s %12s %12s %10s\n", "producer", "MS/s asked", "block", "MS/s got", "received", "dropped", "overruns");
+    for (i = 0; i < sizeof(paced_rates) / sizeof(paced_rates[0]); i++, runs++)
+        ok = bench_stream(pipeline, sink, E_PRODUCER_PACED, paced_rates[i], NULL) && ok;
+    ok = bench_stream(pipeline, sink, E_PRODUCER_FULL_SPEED, 0., &full_speed) && ok;
+    ok = bench_stream(pipeline, sink, E_PRODUCER_OVERLOAD, BENCH_OVERLOAD * full_speed, NULL) && ok;
+    runs += 2;
+
+    if ((sink.started_m != runs) || (sink.stopped_m != runs))
+    {
+        ERROR("sink started %d times, stopped %d times\n", sink.started_m, sink.stopped_m);
+        ok = false;
+    }
+    return ok ? 0 : 1;
+}
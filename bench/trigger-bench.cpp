@@ -0,0 +1,211 @@
+/*****************************************************************************
+*   Copyright 2012 Vincent HERVIEUX
+*
+*   This file is part of QPicoscope.
+*
+*   QPicoscope is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU Lesser General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   any later version.
+*
+*   QPicoscope is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU Lesser General Public License for more details.
+*
+*   You should have received a copy of the GNU Lesser General Public License
+*   along with QPicoscope in files COPYING.LESSER and COPYING.
+*   If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+/**
+ * @file trigger-bench.cpp
+ * @brief Throughput of the software trigger on 16M samples of a stream,
+ * searched in blocks as the stream dispatcher gives them, for every
+ * trigger type and every kernel this CPU runs.
+ * The signal holds full periods, runts, flat parts and pulses, the trigger
+ * positions of every kernel are checked against the scalar one, exits 1
+ * on mismatch. The trigger point of every edge is then interpolated
+ * between two samples with each TriggerInterpolator method.
+ * @version 0.1
+ * @date 2026, october 16
+ * @author Vincent HERVIEUX    -   10.16.2026   -   initial creation
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <vector>
+
+#include "streamtrigger.h"
+#include "triggerinterpolator.h"
+#include "benchclock.h"
+
+#define BENCH_POINTS        (16 * 1024 * 1024)
+/* a drain period of a fast stream */
+#define BENCH_BLOCK         (64 * 1024)
+/* 0.1 mV per count, 1 MS/s */
+#define BENCH_SCALE         1E-4f
+#define BENCH_INTERVAL      1E-6
+/* samples per period of the signal */
+#define BENCH_PERIOD        10000.
+/* interpolations of every edge timed */
+#define BENCH_INTERPOLATIONS    200
+
+typedef struct
+{
+    const char *name;
+    StreamTrigger::type_e type;
+    StreamTrigger::direction_e direction;
+    double level;
+    double upper;
+    double min_width;
+    double max_width;
+    double timeout;
+} bench_trigger_t;
+
+static const char *methods[] = { "none", "linear", "sinc" };
+
+static const bench_trigger_t triggers[] =
+{
+    { "edge",    StreamTrigger::E_TYPE_EDGE,        StreamTrigger::E_DIRECTION_RISING,  0.1,  0.,  0.,     0.,     0.    },
+    { "either",  StreamTrigger::E_TYPE_EDGE,        StreamTrigger::E_DIRECTION_EITHER,  0.1,  0.,  0.,     0.,     0.    },
+    { "window",  StreamTrigger::E_TYPE_WINDOW,      StreamTrigger::E_DIRECTION_EITHER, -0.5,  0.5, 0.,     0.,     0.    },
+    { "pulse",   StreamTrigger::E_TYPE_PULSE_WIDTH, StreamTrigger::E_DIRECTION_RISING,  0.5,  0.,  3E-3,   4E-3,   0.    },
+    { "runt",    StreamTrigger::E_TYPE_RUNT,        StreamTrigger::E_DIRECTION_EITHER, -0.5,  0.5, 0.,     0.,     0.    },
+    { "timeout", StreamTrigger::E_TYPE_TIMEOUT,     StreamTrigger::E_DIRECTION_RISING,  0.1,  0.,  0.,     0.,     15E-3 }
+};
+
+/****************************************************************************
+ * search
+ ****************************************************************************/
+static void search(StreamTrigger &trigger, const int16_t *samples, std::vector<uint64_t> &positions)
+{
+    uint32_t base = 0;
+    uint32_t count = 0;
+    uint32_t done = 0;
+    uint32_t found = 0;
+
+    positions.clear();
+    for (base = 0; base < BENCH_POINTS; base += count)
+    {
+        count = (BENCH_POINTS - base < BENCH_BLOCK) ? BENCH_POINTS - base : BENCH_BLOCK;
+        for (done = 0; (done < count) && trigger.search(samples + base + done, count - done, &found); done += found + 1)
+            positions.push_back((uint64_t)base + done + found);
+    }
+}
+
+/****************************************************************************
+ * main
+ ****************************************************************************/
+int main(void)
+{
+    int16_t *samples = (int16_t*)malloc(BENCH_POINTS * sizeof(int16_t));
+    std::vector<uint64_t> reference;
+    std::vector<uint64_t> positions;
+    std::vector<uint64_t> edges;
+    TriggerInterpolator interpolator;
+    StreamTrigger::config_t config;
+    StreamTrigger trigger;
+    uint32_t t = 0;
+    uint32_t i = 0;
+    uint32_t period = 0;
+    uint32_t pass = 0;
+    int kernel = 0;
+    int method = 0;
+    double volts = 0.;
+    double start = 0.;
+    double elapsed = 0.;
+    double position = 0.;
+    bool ok = true;
+
+    if (NULL == samples)
+    {
+        ERROR("cannot allocate %d samples\n", BENCH_POINTS);
+        return 1;
+    }
+    /* 1 V sines, some periods shifted down into runts, some flat */
+    srand(1);
+    for (i = 0; i < BENCH_POINTS; i++)
+    {
+        period = (uint32_t)(i / BENCH_PERIOD);
+        volts = sin(i * 2. * M_PI / BENCH_PERIOD);
+        if (3 == (period % 7))
+            volts = volts * 0.5 - 0.4;
+        if (5 == (period % 11))
+            volts = 0.;
+        samples[i] = (int16_t)(volts / BENCH_SCALE + (rand() % 200) - 100);
+    }
+
+    printf("%-8s %-8s %10s %12s\n", "trigger", "kernel", "triggers", "Msamples/s");
+    for (t = 0; t < sizeof(triggers) / sizeof(triggers[0]); t++)
+    {
+        memset(&config, 0, sizeof(config));
+        config.type = triggers[t].type;
+        config.direction = triggers[t].direction;
+        config.level = triggers[t].level;
+        config.upper = triggers[t].upper;
+        config.min_width = triggers[t].min_width;
+        config.max_width = triggers[t].max_width;
+        config.timeout = triggers[t].timeout;
+        trigger.set_config(config);
+
+        trigger.set_kernel(AdcConvert::E_KERNEL_SCALAR);
+        trigger.start(BENCH_SCALE, 0.f, BENCH_INTERVAL);
+        search(trigger, samples, reference);
+        for (kernel = 0; kernel < AdcConvert::E_KERNEL_MAX; kernel++)
+        {
+            if (!AdcConvert::is_supported((AdcConvert::kernel_e)kernel))
+                continue;
+            trigger.set_kernel((AdcConvert::kernel_e)kernel);
+            trigger.start(BENCH_SCALE, 0.f, BENCH_INTERVAL);
+            start = now();
+            search(trigger, samples, positions);
+            elapsed = now() - start;
+            if (positions != reference)
+            {
+                ERROR("%s kernel differs from scalar on %s trigger\n",
+                      AdcConvert::kernel_name((AdcConvert::kernel_e)kernel), triggers[t].name);
+                ok = false;
+                continue;
+            }
+            printf("%-8s %-8s %10u %12.1lf\n", triggers[t].name, AdcConvert::kernel_name((AdcConvert::kernel_e)kernel),
+                   (uint32_t)positions.size(), BENCH_POINTS / elapsed * 1E-6);
+        }
+        if (reference.empty())
+        {
+            ERROR("%s trigger never fired\n", triggers[t].name);
+            ok = false;
+        }
+        if (StreamTrigger::E_TYPE_EDGE == triggers[t].type && StreamTrigger::E_DIRECTION_RISING == triggers[t].direction)
+            edges = reference;
+    }
+
+    printf("\n%-8s %10s %12s\n", "interp", "waveforms", "ns/waveform");
+    for (method = TriggerInterpolator::E_METHOD_NONE; method <= TriggerInterpolator::E_METHOD_SINC; method++)
+    {
+        interpolator.set_method((TriggerInterpolator::method_e)method);
+        start = now();
+        for (pass = 0; ok && (pass < BENCH_INTERPOLATIONS); pass++)
+        {
+            for (i = 0; i < edges.size(); i++)
+            {
+                /* the edge fired on the first sample at or past the level in counts */
+                if (!interpolator.crossing(samples, BENCH_POINTS, (uint32_t)edges[i], floor(triggers[0].level / BENCH_SCALE + 0.5),
+                                           true, &position) ||
+                    (position <= edges[i] - 1.) || (position > edges[i]))
+                {
+                    ERROR("%s interpolation of edge at %u gives %lf\n", methods[method], (uint32_t)edges[i], position);
+                    ok = false;
+                    break;
+                }
+            }
+        }
+        elapsed = now() - start;
+        printf("%-8s %10u %12.1lf\n", methods[method], (uint32_t)edges.size(),
+               elapsed * 1E9 / (BENCH_INTERPOLATIONS * (edges.size() ? edges.size() : 1)));
+    }
+
+    free(samples);
+    return ok ? 0 : 1;
+}
@@ -26,9 +26,10 @@
  * @author Vincent HERVIEUX    -   11.27.2012   -   initial creation
  */
 
+#include <string.h>
+
 #include "acquisition.h"
-#include "acquisition2000.h"
-#include "acquisition3000.h"
+#include "acquisitionmanager.h"
 
 #ifndef WIN32
 #define Sleep(x) usleep(1000*(x))
@@ -36,7 +37,6 @@ enum BOOL {FALSE,TRUE};
 #endif
 
 /* static members initialization */
-Acquisition *Acquisition::singleton_m = NULL;
 const char * Acquisition::known_adc_units[] = { "ADC", "fs", "ps", "ns", "us", "ms"};
 const char * Acquisition::unknown_adc_units = "Not Known";
 
@@ -49,8 +49,16 @@ Acquisition::Acquisition()
 {
     DEBUG( "Acquisition model construction...\n");
     thread_id = 0;
+    cpu_m = -1;
+    draw = NULL;
     trigger_slope_m = E_TRIGGER_AUTO;
     trigger_level_m = 0.;
+    time_per_division_m = 0.;
+    record_length_m = RECORD_LENGTH_DEFAULT;
+    streaming_m = false;
+    memset(&stream_trigger_m, 0, sizeof(stream_trigger_m));
+    stream_trigger_m.type = StreamTrigger::E_TYPE_NONE;
+    stream_m.add_sink(&stream_display_m);
 
 }
 
@@ -61,61 +69,14 @@ Acquisition::Acquisition()
  ****************************************************************************/
 Acquisition* Acquisition::get_instance()
 {
-    device_info_t info;
-    if(NULL == Acquisition::singleton_m)
+    AcquisitionManager *manager = AcquisitionManager::get_instance();
+
+    if(0 == manager->get_device_count())
     {
-        // TODO Need to choose in a dynamic way between 2000 and 3000 series here..
-        do
-        {
-#ifdef HAVE_LIBPS2000
-            Acquisition::singleton_m = Acquisition2000::get_instance();
-            memset(&info, 0, sizeof(device_info_t));
-            Acquisition::singleton_m->get_device_info(&info);
-            if(0 == strncmp( info.device_name, "No device or device not supported", DEVICE_NAME_MAX))
-            {
-                DEBUG("No Picoscope 2000 series found.\n");
-                delete((Acquisition2000*)Acquisition::singleton_m);
-                Acquisition::singleton_m = NULL;
-            }
-            else
-            {
-                break;
-            }
-#endif
-#ifdef HAVE_LIBPS2000A
-            Acquisition::singleton_m = Acquisition2000a::get_instance();
-            memset(&info, 0, sizeof(device_info_t));
-            Acquisition::singleton_m->get_device_info(&info);
-            if(0 == strncmp( info.device_name, "No device or device not supported", DEVICE_NAME_MAX))
-            {
-                DEBUG("No Picoscope 2000a series found.\n");
-                delete((Acquisition2000a*)Acquisition::singleton_m);
-                Acquisition::singleton_m = NULL;
-            }
-            else
-            {
-                break;
-            }
-#endif
-#ifdef HAVE_LIBPS3000
-            Acquisition::singleton_m = Acquisition3000::get_instance();
-            memset(&info, 0, sizeof(device_info_t));
-            Acquisition::singleton_m->get_device_info(&info);
-            if(0 == strncmp( info.device_name, "No device or device not supported", DEVICE_NAME_MAX))
-            {
-                DEBUG("No Picoscope 3000 series found.\n");
-                delete((Acquisition3000*)Acquisition::singleton_m);
-                Acquisition::singleton_m = NULL;
-            }
-            else
-            {
-                break;
-            }
-#endif
-        }while(0);
+        manager->probe(ACQUISITION_PROBE_TIMEOUT);
     }
 
-    return Acquisition::singleton_m;
+    return manager->get_device(0);
 }
 
 /****************************************************************************
@@ -127,6 +88,7 @@ Acquisition::~Acquisition()
 {
     if( thread_id )
         stop();
+    stop_recording();
 }
 
 /****************************************************************************
@@ -181,10 +143,32 @@ double Acquisition::adc_multipliers (short time_units)
 void Acquisition::start(void)
 {
     int ret = 0;
+    pthread_attr_t attr;
+#ifdef __linux__
+    cpu_set_t cpus;
+#endif
+    if(NULL == draw)
+    {
+        ERROR("no DrawData set, not starting\n");
+        return;
+    }
     if(0 == thread_id)
     {
         sem_init(&thread_stop, 0, 0);
-        ret = pthread_create(&thread_id, NULL, Acquisition::threadAcquisition, NULL);
+        ready_waiter_m.reset();
+        pthread_attr_init(&attr);
+#ifdef __linux__
+        if(cpu_m >= 0)
+        {
+            CPU_ZERO(&cpus);
+            CPU_SET(cpu_m, &cpus);
+            ret = pthread_attr_setaffinity_np(&attr, sizeof(cpu_set_t), &cpus);
+            if( 0 != ret )
+                WARNING("cannot pin acquisition thread to cpu %d (%d)\n", cpu_m, ret);
+        }
+#endif
+        ret = pthread_create(&thread_id, &attr, Acquisition::threadAcquisition, this);
+        pthread_attr_destroy(&attr);
         if( 0 != ret )
         {
             ERROR("pthread_create failed and returned %d\n", ret);
@@ -205,6 +189,8 @@ void Acquisition::stop(void)
     {
         DEBUG("thread id is %lu\n", thread_id);
         sem_post(&thread_stop);
+        /* do not wait for the end of the current block */
+        ready_waiter_m.cancel();
         pthread_join(thread_id, NULL);
         thread_id = 0;
     }
@@ -215,10 +201,13 @@ void Acquisition::stop(void)
  ****************************************************************************/
 void* Acquisition::threadAcquisition(void* arg)
 {
-    Acquisition *acquisition = Acquisition::get_instance();
-    (void)arg;
+    Acquisition *acquisition = (Acquisition*)arg;
     if ( NULL != acquisition )
     {
+         /* full channel programming once per thread, later changes
+          * only reprogram what request_*() touched
+          */
+         acquisition->set_defaults();
          /* 
           * May not be supported by all devices... 
           * acquisition->collect_streaming();
@@ -226,14 +215,24 @@ void* Acquisition::threadAcquisition(void* arg)
 
          /*
           * Acquisition might be triggered or not...
+          * collect functions return when a queued setting needs the
+          * capture to be set up again, then it is re-armed here.
           */
-         if(acquisition->trigger_slope_m == E_TRIGGER_AUTO)
-         {
-             acquisition->collect_block_immediate();
-         }
-         else
+         while ( !acquisition->stop_requested() )
          {
-             acquisition->collect_block_triggered(acquisition->trigger_slope_m, acquisition->trigger_level_m);
+             acquisition->apply_pending_settings();
+             if(acquisition->streaming_m)
+             {
+                 acquisition->collect_fast_streaming();
+             }
+             else if(acquisition->trigger_slope_m == E_TRIGGER_AUTO)
+             {
+                 acquisition->collect_block_immediate();
+             }
+             else
+             {
+                 acquisition->collect_block_triggered(acquisition->trigger_slope_m, acquisition->trigger_level_m);
+             }
          }
     }
     else
@@ -251,4 +250,229 @@ void Acquisition::set_trigger (trigger_e trigger_slope, double trigger_level)
 {
    trigger_slope_m = trigger_slope;
    trigger_level_m = trigger_level;
+   /* same edge on the stream, with the default hysteresis */
+   memset(&stream_trigger_m, 0, sizeof(stream_trigger_m));
+   stream_trigger_m.type = (E_TRIGGER_AUTO == trigger_slope) ? StreamTrigger::E_TYPE_NONE : StreamTrigger::E_TYPE_EDGE;
+   stream_trigger_m.direction = (E_TRIGGER_FALLING == trigger_slope) ? StreamTrigger::E_DIRECTION_FALLING : StreamTrigger::E_DIRECTION_RISING;
+   stream_trigger_m.level = trigger_level;
+}
+
+/****************************************************************************
+ * set record length
+ ****************************************************************************/
+void Acquisition::set_record_length (uint32_t record_length)
+{
+   record_length_m = (record_length < RECORD_LENGTH_MIN) ? RECORD_LENGTH_MIN : record_length;
+}
+
+/****************************************************************************
+ * start_stream
+ ****************************************************************************/
+bool Acquisition::start_stream (const StreamSink::stream_format_t &format)
+{
+    stream_display_m.set_draw_data(draw);
+    stream_display_m.set_stream(&stream_m);
+    stream_display_m.set_window(5 * time_per_division_m);
+    stream_display_m.set_trigger(stream_trigger_m, CHANNEL_A, STREAM_DISPLAY_PRE_TRIGGER);
+    stream_display_m.set_interpolation(trigger_interpolator_m.get_method());
+    return stream_m.start(format);
+}
+
+/****************************************************************************
+ * trigger_origin
+ ****************************************************************************/
+double Acquisition::trigger_origin (const int16_t *counts, uint32_t count, uint32_t index, const AdcConvert::range_t &range,
+                                    double sample_interval, double fallback) const
+{
+    double position = 0.;
+
+    if ( (E_TRIGGER_AUTO == trigger_slope_m) || (0.f == range.scale) )
+        return fallback;
+    if ( !trigger_interpolator_m.crossing(counts, count, index, (trigger_level_m - range.offset) / range.scale,
+                                          E_TRIGGER_FALLING != trigger_slope_m, &position) )
+        return fallback;
+    return -position * sample_interval;
+}
+
+/****************************************************************************
+ * start_recording
+ ****************************************************************************/
+bool Acquisition::start_recording (const char *path)
+{
+    stop_recording();
+    if ( !recorder_m.open(path) )
+        return false;
+    stream_m.add_sink(&recorder_m);
+    return true;
+}
+
+/****************************************************************************
+ * stop_recording
+ ****************************************************************************/
+void Acquisition::stop_recording (void)
+{
+    if ( !recorder_m.is_open() )
+        return;
+    /* flushes the chunk being filled when streaming */
+    stream_m.remove_sink(&recorder_m);
+    recorder_m.close();
+}
+
+/****************************************************************************
+ * stop_requested
+ ****************************************************************************/
+bool Acquisition::stop_requested (void)
+{
+    if ( 0 == sem_trywait(&thread_stop) )
+    {
+        /* re-post semaphore so that every loop level sees it */
+        sem_post(&thread_stop);
+        return true;
+    }
+    return false;
+}
+
+/****************************************************************************
+ * request voltages
+ ****************************************************************************/
+void Acquisition::request_voltages (channel_e channel_index, double volts_per_division)
+{
+    if ( 0 == thread_id )
+        set_voltages(channel_index, volts_per_division);
+    else
+        settings_m.post_voltages((uint8_t)channel_index, volts_per_division);
+}
+
+/****************************************************************************
+ * request timebase
+ ****************************************************************************/
+void Acquisition::request_timebase (double time_per_division)
+{
+    if ( 0 == thread_id )
+        set_timebase(time_per_division);
+    else
+        settings_m.post_timebase(time_per_division);
+}
+
+/****************************************************************************
+ * request trigger
+ ****************************************************************************/
+void Acquisition::request_trigger (trigger_e trigger_slope, double trigger_level)
+{
+    if ( 0 == thread_id )
+        set_trigger(trigger_slope, trigger_level);
+    else
+        settings_m.post_trigger(trigger_slope, trigger_level);
+}
+
+/****************************************************************************
+ * request DC coupled
+ ****************************************************************************/
+void Acquisition::request_DC_coupled (current_e coupling)
+{
+    if ( 0 == thread_id )
+        set_DC_coupled(coupling);
+    else
+        settings_m.post_coupling(coupling);
+}
+
+/****************************************************************************
+ * request record length
+ ****************************************************************************/
+void Acquisition::request_record_length (uint32_t record_length)
+{
+    if ( 0 == thread_id )
+        set_record_length(record_length);
+    else
+        settings_m.post_record_length(record_length);
+}
+
+/****************************************************************************
+ * request streaming
+ ****************************************************************************/
+void Acquisition::request_streaming (bool streaming)
+{
+    if ( 0 == thread_id )
+        set_streaming(streaming);
+    else
+        settings_m.post_streaming(streaming);
+}
+
+/****************************************************************************
+ * request trigger interpolation
+ ****************************************************************************/
+void Acquisition::request_trigger_interpolation (TriggerInterpolator::method_e interpolation)
+{
+    if ( 0 == thread_id )
+        set_trigger_interpolation(interpolation);
+    else
+        settings_m.post_interpolation(interpolation);
+}
+
+/****************************************************************************
+ * apply pending settings
+ *  Runs in the acquisition thread between two blocks: every setting posted
+ *  since the last call is applied in one go and only the channels whose
+ *  range or coupling changed are reprogrammed.
+ ****************************************************************************/
+uint32_t Acquisition::apply_pending_settings (void)
+{
+    SettingsQueue::settings_batch_t batch;
+    uint8_t channels = 0;
+    uint8_t ch = 0;
+
+    if ( !settings_m.take(&batch) )
+        return 0;
+
+    DEBUG("applying settings 0x%x\n", batch.dirty);
+    if ( batch.dirty & SETTINGS_COUPLING )
+    {
+        set_DC_coupled(batch.coupling);
+        channels = (uint8_t)((1 << CHANNEL_MAX) - 1);
+    }
+    if ( batch.dirty & SETTINGS_VOLTAGES )
+    {
+        for (ch = 0; ch < CHANNEL_MAX; ch++)
+        {
+            if ( batch.channels & (1 << ch) )
+                set_voltages((channel_e)ch, batch.volts_per_division[ch]);
+        }
+        channels |= batch.channels;
+    }
+    for (ch = 0; ch < CHANNEL_MAX; ch++)
+    {
+        if ( channels & (1 << ch) )
+            apply_channel((channel_e)ch);
+    }
+    if ( batch.dirty & SETTINGS_RECORD_LENGTH )
+    {
+        set_record_length(batch.record_length);
+    }
+    if ( batch.dirty & SETTINGS_TIMEBASE )
+    {
+        set_timebase(batch.time_per_division);
+    }
+    else if ( (batch.dirty & SETTINGS_RECORD_LENGTH) && (time_per_division_m > 0.) )
+    {
+        /* the timebase is chosen so that a record fills the screen */
+        set_timebase(time_per_division_m);
+    }
+    if ( batch.dirty & SETTINGS_TRIGGER )
+    {
+        set_trigger(batch.trigger_slope, batch.trigger_level);
+    }
+    if ( batch.dirty & SETTINGS_STREAMING )
+    {
+        set_streaming(batch.streaming);
+    }
+    if ( batch.dirty & SETTINGS_INTERPOLATION )
+    {
+        set_trigger_interpolation(batch.interpolation);
+    }
+    /* trigger threshold is given in ADC counts of the channel A range */
+    if ( (channels & (1 << CHANNEL_A)) && (E_TRIGGER_AUTO != trigger_slope_m) )
+    {
+        batch.dirty |= SETTINGS_TRIGGER;
+    }
+    return batch.dirty;
 }
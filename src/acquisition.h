@@ -33,6 +33,15 @@
 
 #include "oscilloscope.h"
 #include "drawdata.h"
+#include "readywaiter.h"
+#include "adcconvert.h"
+#include "settingsqueue.h"
+#include "samplearena.h"
+#include "streampipeline.h"
+#include "streamdisplay.h"
+#include "capturerecorder.h"
+#include "pipelinestats.h"
+#include "triggerinterpolator.h"
 
 #ifdef WIN32
 /* Headers for Windows */
@@ -61,6 +70,15 @@
 
 #define BUFFER_SIZE           1024
 #define BUFFER_SIZE_STREAMING 100000
+/* fastest continuous streaming, the USB link cannot sustain more */
+#define STREAMING_MIN_INTERVAL_NS 1000
+/* driver buffer the streaming callback is given samples from */
+#define STREAMING_OVERVIEW_SIZE   30000
+/* longest time between two polls of a stream, in seconds */
+#define STREAMING_MAX_POLL_PERIOD 0.020
+/* samples per channel of a block capture, the unit memory caps it */
+#define RECORD_LENGTH_MIN     BUFFER_SIZE
+#define RECORD_LENGTH_DEFAULT 16384
 #define MAX_CHANNELS          4
 
 #define DEVICE_NAME_MAX       80
@@ -102,7 +120,7 @@ public:
         CHANNEL_MAX
     }channel_e;
 
-    /** @brief get singleton instance */
+    /** @brief get the first opened unit, units are owned by AcquisitionManager */
     static Acquisition* get_instance();
     /** @brief destructor */
     virtual ~Acquisition();
@@ -143,6 +161,69 @@ public:
      * @brief get device informations 
      */
     virtual void get_device_info(device_info_t* info) = 0;
+    /**
+     * @brief change settings from the GUI
+     * Applied at once when the acquisition thread is stopped, otherwise
+     * queued and applied by the acquisition thread between two blocks.
+     */
+    void request_voltages (channel_e channel_index, double volts_per_division);
+    void request_timebase (double time_per_division);
+    void request_trigger (trigger_e trigger_slope, double trigger_level);
+    void request_DC_coupled (current_e coupling);
+    void request_record_length (uint32_t record_length);
+    /**
+     * @brief set the block capture length, applied on next capture set up
+     * @param[in] : samples per channel, at least RECORD_LENGTH_MIN,
+     * captures are shortened to what the unit memory holds
+     */
+    void set_record_length (uint32_t record_length);
+    uint32_t get_record_length (void) const { return record_length_m; }
+    /** @brief switch between block captures and continuous streaming */
+    void request_streaming (bool streaming);
+    /** @brief change how the trigger point is found between two samples */
+    void request_trigger_interpolation (TriggerInterpolator::method_e interpolation);
+    /**
+     * @brief continuous streaming instead of block captures, applied on next capture set up
+     * Samples are spaced so that a record length of them spans the screen,
+     * units without fast streaming stay in block mode.
+     */
+    void set_streaming (bool streaming) { streaming_m = streaming; }
+    bool is_streaming (void) const { return streaming_m; }
+    /**
+     * @brief software trigger of the stream on channel A, applied on next capture set up
+     * Units cannot trigger while streaming, the stream is searched instead.
+     * set_trigger() replaces it with an edge trigger.
+     */
+    void set_stream_trigger (const StreamTrigger::config_t &config) { stream_trigger_m = config; }
+    const StreamTrigger::config_t& get_stream_trigger (void) const { return stream_trigger_m; }
+    /**
+     * @brief how the trigger point is found between two samples, applied on next capture set up
+     * Triggered waveforms are shifted so that the crossing is at the same
+     * time in each of them, linear by default.
+     */
+    void set_trigger_interpolation (TriggerInterpolator::method_e interpolation) { trigger_interpolator_m.set_method(interpolation); }
+    TriggerInterpolator::method_e get_trigger_interpolation (void) const { return trigger_interpolator_m.get_method(); }
+    /**
+     * @brief register a consumer of the continuous stream, the screen is always one
+     * Can be called any time, the sink must stay valid until removed.
+     */
+    void add_stream_sink (StreamSink *sink) { stream_m.add_sink(sink); }
+    void remove_stream_sink (StreamSink *sink) { stream_m.remove_sink(sink); }
+    /** @brief stream counters, dropped and overflows included, any thread */
+    void get_stream_stats (StreamRing::stats_t *stats) const { stream_m.get_stats(stats); }
+    /**
+     * @brief record the continuous stream in a capture file, see captureformat.h
+     * @param[in] path: file to create, a recording in progress is closed first
+     * @return false if the file cannot be created
+     */
+    bool start_recording (const char *path);
+    /** @brief write the index and close the capture file */
+    void stop_recording (void);
+    bool is_recording (void) const { return recorder_m.is_open(); }
+    /** @brief recorder counters, written and dropped chunks included, any thread */
+    void get_recorder_stats (CaptureRecorder::stats_t *stats) const { recorder_m.get_stats(stats); }
+    /** @brief stage latencies and block throughput, any thread */
+    PipelineStats* get_pipeline_stats (void) { return &pipeline_stats_m; }
     /**
      * @brief start acquisition thread
      */
@@ -155,6 +236,11 @@ public:
      * @brief set DrawData Class
      */
     void setDrawData(DrawData *drawdata) { draw = drawdata; }
+    /**
+     * @brief core the acquisition thread is pinned to, applied on next start()
+     * @param[in] : cpu index, -1 to let the scheduler choose
+     */
+    void set_cpu(int cpu) { cpu_m = cpu; }
 protected:
     /**
      * @brief protected methods declarations
@@ -168,6 +254,34 @@ protected:
     virtual short mv_to_adc (short mv, short ch) = 0;
     virtual void get_info (void) = 0;
     virtual void set_defaults (void) = 0;
+    /** @brief program a single channel from its current settings */
+    virtual void apply_channel (channel_e channel_index) = 0;
+    /**
+     * @brief apply settings queued by request_*(), acquisition thread only
+     * @return SETTINGS_* bits of what changed, SETTINGS_REARM bits mean the
+     * caller has to leave its collect loop so that the capture is set up again
+     */
+    uint32_t apply_pending_settings (void);
+    /** @brief true once stop() has been called, does not consume the request */
+    bool stop_requested (void);
+    /**
+     * @brief start the stream dispatcher before the driver streams
+     * The screen sweep spans the current time per division.
+     */
+    bool start_stream (const StreamSink::stream_format_t &format);
+    /**
+     * @brief time of the first sample of a triggered block, the trigger crossing at 0
+     * @param[in] counts, count: channel A block
+     * @param[in] index: sample the unit triggered on
+     * @param[in] range: of channel A
+     * @param[in] sample_interval: seconds between two samples
+     * @param[in] fallback: time of the first sample from the unit, kept when
+     * there is no crossing of the trigger level near index
+     */
+    double trigger_origin (const int16_t *counts, uint32_t count, uint32_t index, const AdcConvert::range_t &range,
+                           double sample_interval, double fallback) const;
+    /** @brief stop the stream dispatcher once the driver stopped streaming */
+    void stop_stream (void) { stream_m.stop(); }
     virtual void set_trigger_advanced(void) = 0;
     virtual void collect_block_immediate (void) = 0;
     virtual void collect_block_triggered (trigger_e trigger_slope, double trigger_level) = 0;
@@ -181,9 +295,35 @@ protected:
      */
 
     sem_t thread_stop;
+    /** @brief end of block wait, cancelled by stop() */
+    ReadyWaiter ready_waiter_m;
+    /** @brief settings posted while the acquisition thread runs */
+    SettingsQueue settings_m;
+    /** @brief counts to volts, filled by each backend from its input ranges */
+    AdcConvert adc_convert_m;
+    /** @brief capture buffers of the backend, carved once per configuration */
+    SampleArena sample_arena_m;
+    /** @brief requested samples per channel of a block capture */
+    uint32_t record_length_m;
     DrawData *draw;
     trigger_e trigger_slope_m;
     double trigger_level_m;
+    /** @brief last set_timebase() value */
+    double time_per_division_m;
+    /** @brief continuous streaming requested instead of block captures */
+    bool streaming_m;
+    /** @brief trigger point between two samples, of blocks and of the stream display */
+    TriggerInterpolator trigger_interpolator_m;
+    /** @brief trigger of the stream display */
+    StreamTrigger::config_t stream_trigger_m;
+    /** @brief sink feeding draw while streaming, outlives stream_m */
+    StreamDisplay stream_display_m;
+    /** @brief sink writing the capture file, outlives stream_m */
+    CaptureRecorder recorder_m;
+    /** @brief driver callback to the stream sinks */
+    StreamPipeline stream_m;
+    /** @brief timings of the block loop, filled by the subclasses */
+    PipelineStats pipeline_stats_m;
 private:
     /**
      * @brief private typedef declarations
@@ -194,11 +334,8 @@ private:
      * @brief private methods declarations
      */
     static void* threadAcquisition(void *arg);
-    /**
-     * Store singleton output from the factory
-     */
-    static Acquisition *singleton_m;
     pthread_t thread_id;
+    int cpu_m;
 };
 
 #endif // ACQUISITION_H
@@ -38,7 +38,7 @@ enum BOOL {FALSE,TRUE};
 #define PS2000A_MAX_SIGGEN_FREQ 10000000
 
 /* static members initialization */
-Acquisition2000a *Acquisition2000a::singleton_m = NULL;
+__thread Acquisition2000a *Acquisition2000a::streaming_instance_m = NULL;
 const short Acquisition2000a::input_ranges [] = {10, 20, 50, 100, 200, 500, 1000, 2000, 5000, 10000, 20000, 50000};
 
 /****************************************************************************
@@ -53,7 +53,12 @@ Acquisition2000a::Acquisition2000a() :
 	int i;
 	PWQ pulseWidth;
 	TRIGGER_DIRECTIONS directions;
-	PICO_STATUS status = ps2000aOpenUnit(&unitOpened_m.handle, NULL);
+	PICO_STATUS status;
+
+	memset(&callback_m, 0, sizeof(CALLBACK_STATE));
+	callback_m.waiter = &ready_waiter_m;
+
+	status = ps2000aOpenUnit(&unitOpened_m.handle, NULL);
 	DEBUG ( "Handle: %d\n", unitOpened_m.handle );
 	if (status != PICO_OK) 
 	{
@@ -71,6 +76,7 @@ Acquisition2000a::Acquisition2000a() :
 
 	ps2000aMaximumValue(unitOpened_m.handle, &value);
 	unitOpened_m.maxValue = value;
+	adc_convert_m.set_ranges(input_ranges, sizeof(input_ranges) / sizeof(input_ranges[0]), unitOpened_m.maxValue);
 
 	for ( i = 0; i < unitOpened_m.noOfChannels; i++) 
 	{
@@ -92,17 +98,23 @@ Acquisition2000a::Acquisition2000a() :
 
 /****************************************************************************
  *
- * get_instance
+ * open_unit
  *
  ****************************************************************************/
-Acquisition2000a* Acquisition2000a::get_instance()
+Acquisition* Acquisition2000a::open_unit()
 {
-    if(NULL == Acquisition2000a::singleton_m)
+    device_info_t info;
+    Acquisition2000a *unit = new Acquisition2000a();
+
+    memset(&info, 0, sizeof(device_info_t));
+    unit->get_device_info(&info);
+    if(0 == strncmp( info.device_name, "No device or device not supported", DEVICE_NAME_MAX))
     {
-        Acquisition2000a::singleton_m = new Acquisition2000a();
+        DEBUG("No Picoscope 2000a series found.\n");
+        delete unit;
+        return NULL;
     }
-
-    return Acquisition2000a::singleton_m;
+    return unit;
 }
 
 /****************************************************************************
@@ -114,7 +126,6 @@ Acquisition2000a::~Acquisition2000a()
 {
     DEBUG ( "Device destroyed\n" );
     ps2000aCloseUnit( unitOpened_m.handle );
-    Acquisition2000a::singleton_m = NULL;
 }
 
 /****************************************************************************
@@ -125,7 +136,7 @@ Acquisition2000a::~Acquisition2000a()
 /****************************************************************************
 * Callback
 * used by PS2000A data streaimng collection calls, on receipt of data.
-* used to set global flags etc checked by user routines
+* pParameter is the CALLBACK_STATE given to ps2000aGetStreamingLatestValues
 ****************************************************************************/
 void __stdcall CallBackStreaming(	short handle,
 								long noOfSamples,
@@ -136,30 +147,42 @@ void __stdcall CallBackStreaming(	short handle,
 								short autoStop,
 								void	*pParameter)
 {
-	// used for streaming
-	g_sampleCount = noOfSamples;
-	g_startIndex	= startIndex;
-	g_autoStopped		= autoStop;
+	CALLBACK_STATE * state = (CALLBACK_STATE *)pParameter;
 
-	// flag to say done reading data
-	g_ready = TRUE;
+	if (state == NULL)
+		return;
+
+	// used for streaming
+	state->sampleCount = noOfSamples;
+	state->startIndex	= startIndex;
+	state->autoStopped		= autoStop;
+	state->overflow = overflow;
 
 	// flags to show if & where a trigger has occurred
-	g_trig = triggered;
-	g_trigAt = triggerAt;
+	state->trig = triggered;
+	state->trigAt = triggerAt;
+
+	// flag to say done reading data
+	state->ready = TRUE;
 }
 
 /****************************************************************************
 * Callback
 * used by PS2000A data block collection calls, on receipt of data.
-* used to set global flags etc checked by user routines
+* pParameter is the CALLBACK_STATE given to ps2000aRunBlock
 ****************************************************************************/
 void __stdcall CallBackBlock(	short handle,
 							PICO_STATUS status,
 							void * pParameter)
 {
-	if (status != PICO_CANCELLED)
-		g_ready = TRUE;
+	CALLBACK_STATE * state = (CALLBACK_STATE *)pParameter;
+
+	if (status != PICO_CANCELLED && state != NULL)
+	{
+		state->ready = TRUE;
+		if (state->waiter != NULL)
+			state->waiter->notify();
+	}
 }
 
 /****************************************************************************
@@ -281,9 +304,18 @@ PICO_STATUS ClearDataBuffers(UNIT * unit)
 * - unit : the unit to use.
 * - text : the text to display before the display of data slice
 * - offset : the offset into the data buffer to start the display's slice.
+* - state : callback state of the unit, its waiter is cancelled on stop. May be NULL.
+* - arena : capture buffers of the unit, reused block after block. When NULL
+*   BUFFER_SIZE samples are captured into buffers allocated for this block.
+* - recordLength : samples per channel asked for, capped by the unit memory.
+* - stats : arm, wait and GetValues timings are counted there when not NULL.
 ****************************************************************************/
-void BlockDataHandler(UNIT * unit, char * text, int offset, MODE mode)
+void BlockDataHandler(UNIT * unit, char * text, int offset, MODE mode, CALLBACK_STATE * state,
+                      SampleArena * arena = NULL, unsigned long recordLength = BUFFER_SIZE,
+                      PipelineStats * stats = NULL)
 {
+	ReadyWaiter local_waiter;
+	CALLBACK_STATE local_state;
 	int i, j;
 	long timeInterval;
 	long sampleCount= BUFFER_SIZE;
@@ -294,14 +326,34 @@ void BlockDataHandler(UNIT * unit, char * text, int offset, MODE mode)
 	long timeIndisposed;
 	unsigned short digiValue;
 	PICO_STATUS status;
+	size_t bufferSize = 0;
+	uint64_t stageStart = 0;
+
+	/*  find the maximum number of samples, the time interval (in timeUnits),
+	*		 the most suitable time units, and the maximum oversample at the current timebase*/
+	while (ps2000aGetTimebase(unit->handle, timebase, BUFFER_SIZE, &timeInterval, oversample, &maxSamples, 0))
+	{
+		timebase++;
+	}
 
+	if (arena != NULL)
+	{
+		/* the record length asked for, as long as the unit memory holds it */
+		sampleCount = (recordLength < (unsigned long)maxSamples) ? (long)recordLength : maxSamples;
+		bufferSize = SampleArena::aligned_size(sampleCount * sizeof(short));
+		if (!arena->reserve((unit->channelCount * 2 + unit->noOfDigitalPorts) * bufferSize))
+		{
+			arena = NULL;
+			sampleCount = BUFFER_SIZE;
+		}
+	}
 	
 	if (mode == ANALOGUE || mode == MIXED)		// Analogue or  (MSO Only) MIXED 
 	{
 		for (i = 0; i < unit->channelCount; i++) 
 		{
-			buffers[i * 2] = (short*)malloc(sampleCount * sizeof(short));
-			buffers[i * 2 + 1] = (short*)malloc(sampleCount * sizeof(short));
+			buffers[i * 2] = (arena != NULL) ? (short*)arena->allocate(bufferSize) : (short*)malloc(sampleCount * sizeof(short));
+			buffers[i * 2 + 1] = (arena != NULL) ? (short*)arena->allocate(bufferSize) : (short*)malloc(sampleCount * sizeof(short));
 			status = ps2000aSetDataBuffers(unit->handle, (short)i, buffers[i * 2], buffers[i * 2 + 1], sampleCount, 0, PS2000A_RATIO_MODE_NONE);
 			DEBUG("BlockDataHandler:ps2000aSetDataBuffers(channel %d) ------ 0x%08lx \n", i, status);
 		}
@@ -312,40 +364,53 @@ void BlockDataHandler(UNIT * unit, char * text, int offset, MODE mode)
 	{
 		for (i= 0; i < unit->noOfDigitalPorts; i++) 
 		{
-			digiBuffer[i] = (short*)malloc(sampleCount* sizeof(short));
+			digiBuffer[i] = (arena != NULL) ? (short*)arena->allocate(bufferSize) : (short*)malloc(sampleCount* sizeof(short));
 			status = ps2000aSetDataBuffer(unit->handle, (PS2000A_CHANNEL) (i + PS2000A_DIGITAL_PORT0), digiBuffer[i], sampleCount, 0, PS2000A_RATIO_MODE_NONE);
 			DEBUG("BlockDataHandler:ps2000aSetDataBuffer(port 0x%X) ------ 0x%08lx \n", i + PS2000A_DIGITAL_PORT0, status);
 		}
 	}
 
-	
+	DEBUG("\nTimebase: %lu  SampleInterval: %ldnS  oversample: %hd\n", timebase, timeInterval, oversample);
 
-	/*  find the maximum number of samples, the time interval (in timeUnits),
-	*		 the most suitable time units, and the maximum oversample at the current timebase*/
-	while (ps2000aGetTimebase(unit->handle, timebase, sampleCount, &timeInterval, oversample, &maxSamples, 0))
+	/* Start it collecting, then sleep until CallBackBlock fires */
+	if (state == NULL)
 	{
-		timebase++;
+		memset(&local_state, 0, sizeof(CALLBACK_STATE));
+		state = &local_state;
 	}
-
-	DEBUG("\nTimebase: %lu  SampleInterval: %ldnS  oversample: %hd\n", timebase, timeInterval, oversample);
-
-	/* Start it collecting, then wait for completion*/
-	g_ready = FALSE;
-	if ((status = ps2000aRunBlock(unit->handle, 0, sampleCount, timebase, oversample,	&timeIndisposed, 0, CallBackBlock, NULL)) != PICO_OK)
+	if (state->waiter == NULL)
+		state->waiter = &local_waiter;
+	state->ready = FALSE;
+	state->waiter->arm(sampleCount * timeInterval * 1E-9);
+	stageStart = PipelineStats::now_ns();
+	if ((status = ps2000aRunBlock(unit->handle, 0, sampleCount, timebase, oversample,	&timeIndisposed, 0, CallBackBlock, state)) != PICO_OK)
 		DEBUG("BlockDataHandler:ps2000aRunBlock ------ 0x%08lx \n", status);
+	if (stats != NULL)
+		stats->record(PipelineStats::E_STAGE_ARM, stageStart);
 	
-	DEBUG("Waiting for trigger...Press a key to abort\n");
+	DEBUG("Waiting for trigger...\n");
 
-	while (!g_ready && !_kbhit())
+	stageStart = PipelineStats::now_ns();
+	if (state->waiter->wait_event() != ReadyWaiter::E_WAIT_READY)
 	{
-		Sleep(0);
+		state->ready = FALSE;
+	}
+	else if (stats != NULL)
+	{
+		stats->record(PipelineStats::E_STAGE_WAIT, stageStart);
 	}
 
 
-	if(g_ready) 
+	if(state->ready) 
 	{
+		stageStart = PipelineStats::now_ns();
 		if((status = ps2000aGetValues(unit->handle, 0, (unsigned long*) &sampleCount, 1, PS2000A_RATIO_MODE_NONE, 0, NULL)) != PICO_OK)
 			DEBUG("BlockDataHandler:ps2000aGetValues ------ 0x%08lx \n", status);
+		if (stats != NULL)
+		{
+			stats->record(PipelineStats::E_STAGE_GET_VALUES, stageStart);
+			stats->count_block(sampleCount, sampleCount * oversample * timeInterval * 1E-9);
+		}
 
 		/* Print out the first 10 readings, converting the readings to mV if required */
 		DEBUG("%s\n",text);
@@ -432,7 +497,6 @@ void BlockDataHandler(UNIT * unit, char * text, int offset, MODE mode)
 	else 
 	{
 		DEBUG("data collection aborted\n");
-		_getch();
 	}
 
 	if((status = ps2000aStop(unit->handle)) != PICO_OK)
@@ -441,7 +505,7 @@ void BlockDataHandler(UNIT * unit, char * text, int offset, MODE mode)
 	if (fp != NULL)
 		fclose(fp);
 
-	if (mode == ANALOGUE || mode == MIXED)		// Only if we allocated these buffers
+	if ((arena == NULL) && (mode == ANALOGUE || mode == MIXED))		// Only if we allocated these buffers
 	{
 		for (i = 0; i < unit->channelCount * 2; i++) 
 		{
@@ -449,7 +513,7 @@ void BlockDataHandler(UNIT * unit, char * text, int offset, MODE mode)
 		}
 	}
 
-	if (mode == DIGITAL || mode == MIXED)		// Only if we allocated these buffers
+	if ((arena == NULL) && (mode == DIGITAL || mode == MIXED))		// Only if we allocated these buffers
 	{
 		for (i = 0; i < unit->noOfDigitalPorts; i++) 
 		{
@@ -467,8 +531,9 @@ void BlockDataHandler(UNIT * unit, char * text, int offset, MODE mode)
 * - preTrigger - the number of samples in the pre-trigger phase 
 *					(0 if no trigger has been set)
 ***************************************************************************/
-void StreamDataHandler(UNIT * unit, unsigned long preTrigger, MODE mode)
+void StreamDataHandler(UNIT * unit, unsigned long preTrigger, MODE mode, CALLBACK_STATE * state)
 {
+	CALLBACK_STATE local_state;
 	long i, j;
 	unsigned long sampleCount= BUFFER_SIZE * 10; /*  *10 is to make sure buffer large enough */
 	FILE * fp = NULL;
@@ -559,7 +624,9 @@ void StreamDataHandler(UNIT * unit, unsigned long preTrigger, MODE mode)
 	else
 		DEBUG("\nStreaming Data continually\n\n");
 
-	g_autoStopped = FALSE;
+	if (state == NULL)
+		state = &local_state;
+	memset(state, 0, sizeof(CALLBACK_STATE));
 
 	status = ps2000aRunStreaming(unit->handle, 
 		&sampleInterval, 
@@ -590,28 +657,28 @@ void StreamDataHandler(UNIT * unit, unsigned long preTrigger, MODE mode)
 	}
 
 	totalSamples = 0;
-	while (!_kbhit() && !g_autoStopped && !g_overflow)
+	while (!_kbhit() && !state->autoStopped && !state->overflow)
 	{
 		/* Poll until data is received. Until then, GetStreamingLatestValues wont call the callback */
 		Sleep(100);
-		g_ready = FALSE;
+		state->ready = FALSE;
 
-		status = ps2000aGetStreamingLatestValues(unit->handle, CallBackStreaming, NULL);
+		status = ps2000aGetStreamingLatestValues(unit->handle, CallBackStreaming, state);
 		index ++;
 
-		if (g_ready && g_sampleCount > 0) /* can be ready and have no data, if autoStop has fired */
+		if (state->ready && state->sampleCount > 0) /* can be ready and have no data, if autoStop has fired */
 		{
-			if (g_trig)
-				triggeredAt = totalSamples += g_trigAt;		// calculate where the trigger occurred in the total samples collected
+			if (state->trig)
+				triggeredAt = totalSamples += state->trigAt;		// calculate where the trigger occurred in the total samples collected
 
-			totalSamples += g_sampleCount;
-			DEBUG("\nCollected %3li samples, index = %5lu, Total: %6d samples ", g_sampleCount, g_startIndex, totalSamples);
+			totalSamples += state->sampleCount;
+			DEBUG("\nCollected %3li samples, index = %5lu, Total: %6d samples ", state->sampleCount, state->startIndex, totalSamples);
 			
-			if (g_trig)
+			if (state->trig)
 				DEBUG("Trig. at index %lu", triggeredAt);	// show where trigger occurred
 			
 			
-			for (i = g_startIndex; i < (long)(g_startIndex + g_sampleCount); i++) 
+			for (i = state->startIndex; i < (long)(state->startIndex + state->sampleCount); i++) 
 			{
 				if (mode == ANALOGUE)
 				{
@@ -670,13 +737,13 @@ void StreamDataHandler(UNIT * unit, unsigned long preTrigger, MODE mode)
 
 	ps2000aStop(unit->handle);
 
-	if (!g_autoStopped) 
+	if (!state->autoStopped) 
 	{
 		DEBUG("\ndata collection aborted\n");
 		_getch();
 	}
 
-	if (g_overflow)
+	if (state->overflow)
 	{
 		DEBUG("\nStreaming overflow. Not able to keep up with streaming data rate\n");
 	}
@@ -823,6 +890,7 @@ void CollectRapidBlock(UNIT * unit)
 	PICO_STATUS status;
 	short i;
 	unsigned long nCompletedCaptures;
+	CALLBACK_STATE state;
 
 	short	triggerVoltage = mv_to_adc(100, unit->channelSettings[PS2000A_CHANNEL_A].range, unit);
 
@@ -876,16 +944,16 @@ void CollectRapidBlock(UNIT * unit)
 
 	//Run
 	timebase = 160;		//1 MS/s
-	status = ps2000aRunBlock(unit->handle, 0, nSamples, timebase, 1, &timeIndisposed, 0, CallBackBlock, NULL);
+	memset(&state, 0, sizeof(CALLBACK_STATE));
+	status = ps2000aRunBlock(unit->handle, 0, nSamples, timebase, 1, &timeIndisposed, 0, CallBackBlock, &state);
 
 	//Wait until data ready
-	g_ready = 0;
-	while(!g_ready && !_kbhit())
+	while(!state.ready && !_kbhit())
 	{
 		Sleep(0);
 	}
 
-	if(!g_ready)
+	if(!state.ready)
 	{
 		_getch();
 		status = ps2000aStop(unit->handle);
@@ -1146,7 +1214,7 @@ void CollectStreamingImmediate(UNIT * unit)
 	/* Trigger disabled	*/
 	SetTrigger(unit, NULL, 0, NULL, 0, &directions, &pulseWidth, 0, 0, 0, 0, 0);
 
-	StreamDataHandler(unit, 0, ANALOGUE);
+	StreamDataHandler(unit, 0, ANALOGUE, NULL);
 }
 
 /****************************************************************************
@@ -1199,7 +1267,7 @@ void CollectStreamingTriggered(UNIT * unit)
 	* Threshold = 1000mV */
 	SetTrigger(unit, &sourceDetails, 1, &conditions, 1, &directions, &pulseWidth, 0, 0, 0, 0, 0);
 
-	StreamDataHandler(unit, 100000, ANALOGUE);
+	StreamDataHandler(unit, 100000, ANALOGUE, NULL);
 }
 
 /****************************************************************************
@@ -1306,7 +1374,7 @@ void ANDAnalogueDigitalTriggered(UNIT * unit)
 
 	if (SetTrigger(unit, &sourceDetails, 1, &conditions, 1, &directions, &pulseWidth, 0, 0, 0, digDirections, 2) == PICO_OK)
 	{
-		BlockDataHandler(unit, "First 10 readings\n", 0, MIXED);
+		BlockDataHandler(unit, "First 10 readings\n", 0, MIXED, NULL);
 	}
 
 	DisableAnalogue(unit);			// Disable Analogue ports when finished;
@@ -1404,7 +1472,7 @@ void ORAnalogueDigitalTriggered(UNIT * unit)
 	if (SetTrigger(unit, &sourceDetails, 1, conditions, 2, &directions, &pulseWidth, 0, 0, 0, digDirections, 2) == PICO_OK)
 	{
 		
-		BlockDataHandler(unit, "First 10 readings\n", 0, MIXED);
+		BlockDataHandler(unit, "First 10 readings\n", 0, MIXED, NULL);
 	}
 	
 	DisableAnalogue(unit);					// Disable Analogue ports when finished;
@@ -1456,7 +1524,7 @@ void DigitalBlockTriggered(UNIT * unit)
 	{
 		DEBUG("Press a key to start...\n");
 		_getch();
-		BlockDataHandler(unit, "First 10 readings\n", 0, DIGITAL);
+		BlockDataHandler(unit, "First 10 readings\n", 0, DIGITAL, NULL);
 	}
 }
 
@@ -1484,7 +1552,7 @@ void DigitalBlockImmediate(UNIT *unit)
 	DEBUG("Press a key to start...\n");
 	_getch();
 	
-	BlockDataHandler(unit, "First 10 readings\n", 0, DIGITAL);
+	BlockDataHandler(unit, "First 10 readings\n", 0, DIGITAL, NULL);
 }
 
 
@@ -1509,7 +1577,7 @@ void DigitalStreamingAggregated(UNIT * unit)
 	/* Trigger disabled	*/
 	set_trigger( NULL, 0, NULL, 0, &directions, &pulseWidth, 0, 0, 0, 0, 0);
 
-	StreamDataHandler(unit, 0, AGGREGATED);
+	StreamDataHandler(unit, 0, AGGREGATED, NULL);
 }
 
 
@@ -1533,7 +1601,7 @@ void DigitalStreamingImmediate(UNIT * unit)
 	/* Trigger disabled	*/
 	set_trigger( NULL, 0, NULL, 0, &directions, &pulseWidth, 0, 0, 0, 0, 0);
 
-	StreamDataHandler(unit, 0, DIGITAL);
+	StreamDataHandler(unit, 0, DIGITAL, NULL);
 }
 
 
@@ -1619,7 +1687,7 @@ void  __stdcall Acquisition2000a::ps2000FastStreamingReady( short **overviewBuff
     (void)overflow;
     (void)triggeredAt;
     (void)triggered;
-    Acquisition2000a* instance = Acquisition2000a::get_instance();
+    Acquisition2000a* instance = streaming_instance_m;
     if(NULL != instance)
     {
         instance->unitOpened_m.trigger.advanced.totalSamples += nValues;
@@ -1684,7 +1752,21 @@ void Acquisition2000a::set_defaults (void)
                                    (PS2000A_COUPLING) unitOpened_m.channelSettings[PS2000A_CHANNEL_A + i].DCcoupled,
                                    (PS2000A_RANGE) unitOpened_m.channelSettings[PS2000A_CHANNEL_A + i].range, 0);
     }
+}
 
+/****************************************************************************
+ * apply_channel - program a single channel from its current settings
+ ****************************************************************************/
+void Acquisition2000a::apply_channel (channel_e channel_index)
+{
+    if (channel_index >= unitOpened_m.noOfChannels)
+        return;
+    ps2000aSetChannel(unitOpened_m.handle,
+                      (PS2000A_CHANNEL) (PS2000A_CHANNEL_A + channel_index),
+                      unitOpened_m.channelSettings[PS2000A_CHANNEL_A + channel_index].enabled,
+                      (PS2000A_COUPLING) unitOpened_m.channelSettings[PS2000A_CHANNEL_A + channel_index].DCcoupled,
+                      (PS2000A_RANGE) unitOpened_m.channelSettings[PS2000A_CHANNEL_A + channel_index].range, 0);
+}
 
 /****************************************************************************
  * set_trigger_advanced - set advance trigger parameters
@@ -1800,14 +1882,12 @@ void Acquisition2000a::collect_block_immediate (void)
 
     DEBUG( "Collect block immediate...\n" );
 
-    set_defaults();
-
     /* Trigger disabled
      */
     set_trigger ( NULL, 0, NULL, 0, &directions, &pulseWidth, 0, 0, 0, 0, 0 );
 
     /* TODO */
-    BlockDataHandler(&unitOpened_m, "First 10 readings\n", 0, ANALOGUE);
+    BlockDataHandler(&unitOpened_m, "First 10 readings\n", 0, ANALOGUE, &callback_m, &sample_arena_m, record_length_m, &pipeline_stats_m);
 }
 
 /****************************************************************************
@@ -1855,14 +1935,12 @@ void Acquisition2000a::collect_block_triggered (trigger_e trigger_slope, double
 		: sourceDetails.thresholdUpper);																// else print ADC Count
 	DEBUG(scaleVoltages?"mV\n" : "ADC Counts\n");
 
-	set_defaults();
-
 	/* Trigger enabled
 	* Rising edge
 	* Threshold = 1000mV */
 	set_trigger( &sourceDetails, 1, &conditions, 1, &directions, &pulseWidth, 0, 0, 0, 0, 0);
 
-	BlockDataHandler(&unitOpened_m, "Ten readings after trigger\n", 0, ANALOGUE);
+	BlockDataHandler(&unitOpened_m, "Ten readings after trigger\n", 0, ANALOGUE, &callback_m, &sample_arena_m, record_length_m, &pipeline_stats_m);
 }
 
 void Acquisition2000a::collect_block_advanced_triggered ()
@@ -1926,7 +2004,7 @@ void Acquisition2000a::collect_block_ets (void)
 	
 	DEBUG("ETS Sample Time is: %ld\n", ets_sampletime);
 
-	BlockDataHandler(unit, "Ten readings after trigger\n", BUFFER_SIZE / 10 - 5, ANALOGUE); // 10% of data is pre-trigger
+	BlockDataHandler(unit, "Ten readings after trigger\n", BUFFER_SIZE / 10 - 5, ANALOGUE, &callback_m); // 10% of data is pre-trigger
 }
 
 /****************************************************************************
@@ -1956,6 +2034,7 @@ void Acquisition2000a::collect_streaming (void)
     int    ok;
     short  ch;
     double values_V[BUFFER_SIZE] = {0};
+    double volts[BUFFER_SIZE];
     double time[BUFFER_SIZE] = {0};
     DEBUG ( "Collect streaming...\n" );
 
@@ -1992,13 +2071,13 @@ void Acquisition2000a::collect_streaming (void)
             if (unitOpened_m.channelSettings[ch].enabled)
             {
 
+                adc_convert_m.to_volts(unitOpened_m.channelSettings[ch].values, volts, no_of_values, unitOpened_m.channelSettings[ch].range);
                 for (  i = 0; i < no_of_values; i++, count++ )
                 {
-                    values_V[count] = 0.001 * adc_to_mv(unitOpened_m.channelSettings[ch].values[i], unitOpened_m.channelSettings[ch].range);
+                    values_V[count] = volts[i];
                     // TODO time will be probably wrong here, need to guess how to convert time range to time step...
                     //time[i] = ( i ? time[i-1] : 0) + unitOpened_m.channelSettings[ch].range
                     time[count] = count * 0.01 * time_per_division_m;
-                    DEBUG("V: %lf (range %d) T: %lf\n", values_V[count], unitOpened_m.channelSettings[ch].range, time[count]);
                     // 500 points are making a screen:
                     if(count == 500)
                     {
@@ -2013,6 +2092,7 @@ void Acquisition2000a::collect_streaming (void)
             }
 
         }
+        draw->publishData();
         Sleep(100);
     }
 
@@ -2040,6 +2120,11 @@ void Acquisition2000a::collect_fast_streaming (void)
 
     DEBUG ( "Collect fast streaming...\n" );
 
+    /* the continuous stream ring is not wired to the ps2000a driver yet */
+    WARNING ( "no continuous streaming on 2000a units yet, back to block captures\n" );
+    streaming_m = false;
+    return;
+
     set_defaults ();
 
     /* You cannot use triggering for the start of the data...
@@ -2055,6 +2140,8 @@ void Acquisition2000a::collect_fast_streaming (void)
     *    Auto stop after the 100000 samples
     *  Start it collecting,
     */
+    /* callback has no user parameter, it finds this unit through the thread */
+    streaming_instance_m = this;
     ok = ps2000_run_streaming_ns ( unitOpened_m.handle, 10, PS2000A_US, BUFFER_SIZE_STREAMING, 1, 100, 30000 );
     DEBUG ( "OK: %d\n", ok );
 
@@ -2131,6 +2218,7 @@ void Acquisition2000a::collect_fast_streaming (void)
         }
                
     }
+    draw->publishData();
 
 
 /*    DEBUG ( "Data is written to disk file (data.txt)\n" );
@@ -2192,6 +2280,8 @@ void Acquisition2000a::collect_fast_streaming_triggered (void)
     *    Auto stop after the 100000 samples
     *  Start it collecting,
     */
+    /* callback has no user parameter, it finds this unit through the thread */
+    streaming_instance_m = this;
     ok = ps2000_run_streaming_ns ( unitOpened_m.handle, 10, PS2000A_US, BUFFER_SIZE_STREAMING, 1, 100, 30000 );
     DEBUG ( "OK: %d\n", ok );
 
@@ -2467,6 +2557,7 @@ void Acquisition2000a::set_timebase(double time_per_division)
   long   time_interval = 0;
   short  oversample = 1;
   long   max_samples = 0;
+  double screen_points = 0.;
 
   DEBUG ( "Specify timebase\n" );
   time_per_division_m = time_per_division;
@@ -2518,14 +2609,16 @@ void Acquisition2000a::set_timebase(double time_per_division)
       {
           DEBUG ( "%d -> %ld ns\n", i, time_interval );
           /**
-           * we want 100 points per division.
+           * we want a whole record per screen.
            * Screen has 5 time divisions.
-           * So we want 500 points
+           * So we want record_length_m points over 5 divisions,
+           * or what the unit memory holds at this timebase
            */
-          if(((double)time_interval * 1E-9) <= (time_per_division * 0.010)){
+          screen_points = ( record_length_m < (uint32_t)max_samples ? record_length_m : max_samples );
+          if(((double)time_interval * 1E-9) <= (5 * time_per_division / screen_points)){
               timebase = i;
           }
-          else if(((double)time_interval * 1E-9)) > (time_per_division * 0.010)){
+          else if(((double)time_interval * 1E-9)) > (5 * time_per_division / screen_points)){
               break;
           }
       }
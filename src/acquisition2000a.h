@@ -65,6 +65,23 @@
 /* End of Linux-specific definitions */
 #endif
 
+/**
+ * @brief driver callback state, one per unit.
+ * Given to the driver as pParameter so that several units can stream at the
+ * same time (the SDK example kept this in globals).
+ */
+typedef struct
+{
+    volatile short ready;
+    long           sampleCount;
+    unsigned long  startIndex;
+    short          autoStopped;
+    short          overflow;
+    short          trig;
+    unsigned long  trigAt;
+    /** @brief woken by CallBackBlock, may be NULL */
+    ReadyWaiter   *waiter;
+} CALLBACK_STATE;
 
 class Acquisition2000a : public Acquisition{
 public:
@@ -78,8 +95,11 @@ public:
         std::string name;
     }volt_item_t;
 
-    /** @brief get singleton instance */
-    static Acquisition2000a* get_instance();
+    /**
+     * @brief open the next 2000a series unit not opened yet
+     * @return NULL when no more unit is found
+     */
+    static Acquisition* open_unit();
     /** @brief destructor */
     virtual ~Acquisition2000a();
     /**
@@ -206,6 +226,7 @@ private:
     short mv_to_adc (short mv, short ch); // OK
     void get_info (void);
     void set_defaults (void); // OK
+    void apply_channel (channel_e channel_index);
     PICO_STATUS set_trigger(PS2000A_TRIGGER_CHANNEL_PROPERTIES * channelProperties,
                             short nChannelProperties,
                             PS2000A_TRIGGER_CONDITIONS * triggerConditions,
@@ -235,9 +256,10 @@ private:
      * @brief private instances declarations
      */
     UNIT_MODEL unitOpened_m;
-    static Acquisition2000a *singleton_m;
+    CALLBACK_STATE callback_m;
+    /** @brief unit running ps2000FastStreamingReady() on the calling thread */
+    static __thread Acquisition2000a *streaming_instance_m;
     short timebase;
-    double time_per_division_m;
     long times[BUFFER_SIZE];
     static const short input_ranges [PS2000A_MAX_RANGES] /*= {10, 20, 50, 100, 200, 500, 1000, 2000, 5000, 10000, 20000, 50000}*/;
 };
@@ -39,7 +39,7 @@ enum BOOL {FALSE,TRUE};
 #define DUAL_SCOPE 2
 
 /* static members initialization */
-Acquisition3000 *Acquisition3000::singleton_m = NULL;
+__thread Acquisition3000 *Acquisition3000::streaming_instance_m = NULL;
 const short Acquisition3000::input_ranges [] = {10, 20, 50, 100, 200, 500, 1000, 3000, 5000, 10000, 30000, 50000};
 
 /****************************************************************************
@@ -49,9 +49,19 @@ const short Acquisition3000::input_ranges [] = {10, 20, 50, 100, 200, 500, 1000,
  ****************************************************************************/
 Acquisition3000::Acquisition3000() :
     scale_to_mv(1),
-    timebase(8)
+    timebase(8),
+    times(NULL),
+    capture_length_m(0),
+    screen_length_m(0)
 {
+    short ch = 0;
+
     DEBUG( "Opening the device...\n");
+    for (ch = 0; ch < MAX_CHANNELS; ch++)
+    {
+        unitOpened_m.channelSettings[ch].values = NULL;
+        unitOpened_m.channelSettings[ch].screen = NULL;
+    }
 
     //open unit and show splash screen
     unitOpened_m.handle = ps3000_open_unit ();
@@ -68,6 +78,10 @@ Acquisition3000::Acquisition3000() :
     {
         DEBUG ( "Device opened successfully\n\n" );
         get_info ();
+        /* same scale as adc_to_mv() */
+        adc_convert_m.set_ranges(input_ranges, sizeof(input_ranges) / sizeof(input_ranges[0]), 32767, scale_to_mv);
+        /* the fixed size captures use BUFFER_SIZE samples */
+        reserve_capture(BUFFER_SIZE);
 
     }
 
@@ -75,17 +89,23 @@ Acquisition3000::Acquisition3000() :
 
 /****************************************************************************
  *
- * get_instance
+ * open_unit
  *
  ****************************************************************************/
-Acquisition3000* Acquisition3000::get_instance()
+Acquisition* Acquisition3000::open_unit()
 {
-    if(NULL == Acquisition3000::singleton_m)
+    device_info_t info;
+    Acquisition3000 *unit = new Acquisition3000();
+
+    memset(&info, 0, sizeof(device_info_t));
+    unit->get_device_info(&info);
+    if(0 == strncmp( info.device_name, "No device or device not supported", DEVICE_NAME_MAX))
     {
-        Acquisition3000::singleton_m = new Acquisition3000();
+        DEBUG("No Picoscope 3000 series found.\n");
+        delete unit;
+        return NULL;
     }
-
-    return Acquisition3000::singleton_m;
+    return unit;
 }
 
 /****************************************************************************
@@ -97,7 +117,6 @@ Acquisition3000::~Acquisition3000()
 {
     DEBUG ( "Device destroyed\n" );
     ps3000_close_unit ( unitOpened_m.handle ); 
-    Acquisition3000::singleton_m = NULL;
 }
 
 /****************************************************************************
@@ -112,18 +131,38 @@ void  __stdcall Acquisition3000::ps3000FastStreamingReady( short **overviewBuffe
                                                                 short auto_stop,
                                                               unsigned long nValues)
 {
-    (void)overviewBuffers;
-    (void)overflow;
+    const int16_t *channels[STREAM_MAX_CHANNELS] = {NULL};
+    short ch;
     (void)triggeredAt;
     (void)triggered;
-    Acquisition3000* instance = Acquisition3000::get_instance();
+    Acquisition3000* instance = streaming_instance_m;
     if(NULL != instance)
     {
+        /* without aggregation, the max buffer of a channel holds its samples */
+        for (ch = 0; (ch < instance->unitOpened_m.noOfChannels) && (ch < STREAM_MAX_CHANNELS); ch++)
+        {
+            if (instance->unitOpened_m.channelSettings[ch].enabled)
+                channels[ch] = overviewBuffers[ch * 2];
+        }
+        instance->stream_m.write(channels, (uint32_t)nValues);
+        if (overflow)
+            instance->stream_m.count_overflow();
         instance->unitOpened_m.trigger.advanced.totalSamples += nValues;
         instance->unitOpened_m.trigger.advanced.autoStop = auto_stop;
     }
 }
 
+/****************************************************************************
+ *
+ * is_block_ready
+ *  poll function given to ReadyWaiter
+ *
+ ****************************************************************************/
+int Acquisition3000::is_block_ready(void *context)
+{
+    return ps3000_ready ( ((Acquisition3000*)context)->unitOpened_m.handle );
+}
+
 /****************************************************************************
  *
  * get_device_info
@@ -197,6 +236,20 @@ void Acquisition3000::set_defaults (void)
     }
 }
 
+/****************************************************************************
+ * apply_channel - program a single channel from its current settings
+ ****************************************************************************/
+void Acquisition3000::apply_channel (channel_e channel_index)
+{
+    if (channel_index >= unitOpened_m.noOfChannels)
+        return;
+    ps3000_set_channel ( unitOpened_m.handle,
+                         (short)channel_index,
+                         unitOpened_m.channelSettings[channel_index].enabled,
+                         unitOpened_m.channelSettings[channel_index].DCcoupled,
+                         unitOpened_m.channelSettings[channel_index].range);
+}
+
 /****************************************************************************
  * set_trigger_advanced - set advance trigger parameters
  ****************************************************************************/
@@ -285,6 +338,50 @@ void Acquisition3000::set_trigger_advanced(void)
     ok = ps3000SetAdvTriggerDelay (unitOpened_m.handle, 0, -10);
 }
 
+/****************************************************************************
+ * reserve_capture
+ *  point the channel values and the times to nb_samples long buffers of
+ *  the sample arena, and the screen tables to nb_screen long ones when a
+ *  record is shorter than the screen. Buffers only move when a longer
+ *  capture or screen is asked for, the collect loops reuse them from block
+ *  to block.
+ ****************************************************************************/
+bool Acquisition3000::reserve_capture (long nb_samples, long nb_screen)
+{
+    size_t values_size = 0;
+    size_t times_size = 0;
+    size_t screen_size = 0;
+    short ch = 0;
+
+    /* a record that fills the screen is given as it is */
+    if ( nb_screen <= nb_samples )
+        nb_screen = 0;
+    if ( (nb_samples <= capture_length_m) && (nb_screen <= screen_length_m) )
+        return true;
+
+    /* every buffer is carved again, none of them shrinks */
+    if ( nb_samples < capture_length_m )
+        nb_samples = capture_length_m;
+    if ( nb_screen < screen_length_m )
+        nb_screen = screen_length_m;
+    values_size = SampleArena::aligned_size(nb_samples * sizeof(short));
+    times_size = SampleArena::aligned_size(nb_samples * sizeof(long));
+    screen_size = SampleArena::aligned_size(nb_screen * sizeof(short));
+    /* every channel, a queued setting may enable one while collecting */
+    if ( !sample_arena_m.reserve(MAX_CHANNELS * (values_size + screen_size) + times_size) )
+        return false;
+    for (ch = 0; ch < MAX_CHANNELS; ch++)
+    {
+        unitOpened_m.channelSettings[ch].values = (short*)sample_arena_m.allocate(values_size);
+        unitOpened_m.channelSettings[ch].screen = (0 != nb_screen) ? (short*)sample_arena_m.allocate(screen_size) : NULL;
+    }
+    times = (long*)sample_arena_m.allocate(times_size);
+    capture_length_m = nb_samples;
+    screen_length_m = nb_screen;
+    DEBUG ( "capture buffers hold %ld samples, screen tables %ld\n", capture_length_m, screen_length_m );
+    return true;
+}
+
 /****************************************************************************
  * Collect_block_immediate
  *  this function demonstrates how to collect a single block of data
@@ -292,7 +389,6 @@ void Acquisition3000::set_trigger_advanced(void)
  ****************************************************************************/
 void Acquisition3000::collect_block_immediate (void)
 {
-    int   i = 0;
     long  time_interval;
     short time_units;
     short oversample;
@@ -303,16 +399,20 @@ void Acquisition3000::collect_block_immediate (void)
     short overflow;
     long  max_samples;
     short ch = 0;
-    double* values_V[CHANNEL_MAX] = {NULL};
-    double* time[CHANNEL_MAX] = {NULL};
+    short *table = NULL;
     double time_multiplier = 0.;
-    double time_offset[CHANNEL_MAX] = {0.};
+    double sample_interval = 0.;
+    double time_origin[CHANNEL_MAX] = {0.};
+    double block_duration = 0.;
     int index[CHANNEL_MAX] = {0};
+    int nb_copied = 0;
+    AdcConvert::range_t range;
+    uint64_t stage_start = 0;
+    uint64_t convert_ns = 0;
+    uint64_t handoff_ns = 0;
 
     DEBUG ( "Collect block immediate...\n" );
 
-    set_defaults ();
-
     /* Trigger disabled
     */
     ps3000_set_trigger ( unitOpened_m.handle, PS3000_NONE, 0, PS3000_RISING, 0, auto_trigger_ms );
@@ -323,44 +423,52 @@ void Acquisition3000::collect_block_immediate (void)
     oversample = 1;
     while (!ps3000_get_timebase ( unitOpened_m.handle,
                                 timebase,
-                                no_of_samples,
+                                BUFFER_SIZE,
                                 &time_interval,
                                 &time_units,
                                 oversample,
                                 &max_samples))
     timebase++;                                        ;
 
+    /* the record length asked for, as long as the unit memory holds it */
+    no_of_samples = ( record_length_m < (uint32_t)max_samples ? (int)record_length_m : (int)max_samples );
     time_multiplier = adc_multipliers(time_units);
     nb_of_samples_in_screen = (int)(5 * time_per_division_m / (time_interval * time_multiplier)) + 1;
-    nb_of_samples_in_screen = ( nb_of_samples_in_screen < BUFFER_SIZE ? BUFFER_SIZE : nb_of_samples_in_screen);
-    for (ch = 0; ch < unitOpened_m.noOfChannels; ch++)
-    {
-        if (unitOpened_m.channelSettings[ch].enabled)
-        {
-            values_V[ch] = (double*)malloc(nb_of_samples_in_screen * sizeof(double));
-            time[ch] = (double*)malloc(nb_of_samples_in_screen * sizeof(double));
-        }
-    }
+    if ( !reserve_capture(no_of_samples, nb_of_samples_in_screen) )
+        no_of_samples = (int)capture_length_m;
+    /* a whole record is kept even when it spans more than the screen,
+     * without screen tables each record is shown on its own
+     */
+    if ( (nb_of_samples_in_screen < no_of_samples) || (nb_of_samples_in_screen > screen_length_m) )
+        nb_of_samples_in_screen = no_of_samples;
+    sample_interval = time_interval * time_multiplier;
     DEBUG ( "timebase: %hd\tnb_of_samples:%d\toversample:%hd\ttime_units:%hd\ttime_interval:%lu\ttime_multiplier:%e\tnb_of_samples_in_screen:%d\n", 
              timebase, no_of_samples, oversample, time_units, time_interval, time_multiplier, nb_of_samples_in_screen );
+    /* ps3000_get_timebase gives the sample interval in ns */
+    block_duration = no_of_samples * oversample * time_interval * 1E-9;
 
 
-    while ( sem_trywait(&thread_stop) )
+    while ( !stop_requested() )
     {
+        /* new timebase or trigger: back to threadAcquisition to set the capture up again */
+        if ( apply_pending_settings() & SETTINGS_REARM )
+            break;
+
         /* Start it collecting,
         *  then wait for completion
         */
+        stage_start = PipelineStats::now_ns();
         ps3000_run_block ( unitOpened_m.handle, no_of_samples, timebase, oversample, &time_indisposed_ms );
-        while ( !ps3000_ready ( unitOpened_m.handle ) )
+        pipeline_stats_m.record(PipelineStats::E_STAGE_ARM, stage_start);
+        stage_start = PipelineStats::now_ns();
+        ready_waiter_m.arm( (time_indisposed_ms * 1E-3 > block_duration) ? time_indisposed_ms * 1E-3 : block_duration );
+        if ( ReadyWaiter::E_WAIT_READY != ready_waiter_m.wait_poll( &Acquisition3000::is_block_ready, this ) )
         {
-            if( !sem_trywait(&thread_stop) )
-            {
-                /* re-post semaphore to exit the main loop */
-                sem_post(&thread_stop);
-                break;
-            }
-            Sleep ( 100 );
+            /* stop requested while waiting */
+            ps3000_stop ( unitOpened_m.handle );
+            break;
         }
+        pipeline_stats_m.record(PipelineStats::E_STAGE_WAIT, stage_start);
 
         ps3000_stop ( unitOpened_m.handle );
 
@@ -368,58 +476,59 @@ void Acquisition3000::collect_block_immediate (void)
         *  get the times (in nanoseconds)
         *   and the values (in ADC counts)
         */
+        stage_start = PipelineStats::now_ns();
         ps3000_get_times_and_values ( unitOpened_m.handle, times,
                                     unitOpened_m.channelSettings[PS3000_CHANNEL_A].values,
                                     unitOpened_m.channelSettings[PS3000_CHANNEL_B].values,
                                     unitOpened_m.channelSettings[PS3000_CHANNEL_C].values,
                                     unitOpened_m.channelSettings[PS3000_CHANNEL_D].values,
                                     &overflow, time_units, no_of_samples );
+        pipeline_stats_m.record(PipelineStats::E_STAGE_GET_VALUES, stage_start);
 
         DEBUG ( "%d values, overflow %d\n", no_of_samples, overflow );
 
+        convert_ns = 0;
+        handoff_ns = 0;
         for (ch = 0; (ch < unitOpened_m.noOfChannels) && (no_of_samples > 0); ch++)
         {
             if (unitOpened_m.channelSettings[ch].enabled)
             {
-                for (  i = 0; (i < no_of_samples) && (index[ch] < nb_of_samples_in_screen) ; i++, index[ch]++ )
+                nb_copied = nb_of_samples_in_screen - index[ch];
+                if (nb_copied > no_of_samples)
+                    nb_copied = no_of_samples;
+                /* samples are evenly spaced, only the first time is needed */
+                if (0 == index[ch])
+                    time_origin[ch] = times[0] * time_multiplier;
+                /* counts are kept as they come from the driver, the screen scales them */
+                table = unitOpened_m.channelSettings[ch].values;
+                if ( nb_of_samples_in_screen > no_of_samples )
                 {
-                    values_V[ch][index[ch]] = 0.001 * adc_to_mv(unitOpened_m.channelSettings[ch].values[i], unitOpened_m.channelSettings[ch].range);
-#if 0
-                    DEBUG("(times[%d] * time_multiplier): %lf;\t(%d * time_multiplier * time_interval): %lf\n", 
-                          i, 
-                          (times[i] * time_multiplier), 
-                          i, 
-                          (i * time_multiplier * time_interval)
-                         );
-#endif
-                    time[ch][index[ch]] = (times[i] * time_multiplier) + time_offset[ch];
-                    //DEBUG("V: %lf (range %d) T: %lf\n", values_V[index[ch]], unitOpened_m.channelSettings[ch].range, time[index[ch]]);
+                    stage_start = PipelineStats::now_ns();
+                    table = unitOpened_m.channelSettings[ch].screen;
+                    memcpy(&table[index[ch]], unitOpened_m.channelSettings[ch].values, nb_copied * sizeof(short));
+                    convert_ns += PipelineStats::now_ns() - stage_start;
                 }
+                index[ch] += nb_copied;
                 // resetting all available data as long as the screen is not filled.
-                draw->setData(ch+1, time[ch], values_V[ch], index[ch]);
+                stage_start = PipelineStats::now_ns();
+                range = adc_convert_m.get_range(unitOpened_m.channelSettings[ch].range);
+                /* the blocks before this one are in the table already */
+                draw->setRawData(ch+1, table, index[ch], range.scale, range.offset, time_origin[ch], sample_interval,
+                                 index[ch] > nb_copied);
+                handoff_ns += PipelineStats::now_ns() - stage_start;
                 DEBUG("set %d data\n", index[ch]);
-                if( (index[ch] >= nb_of_samples_in_screen) || (time[ch][index[ch] - 1] > 5 * time_per_division_m) )
+                if( (index[ch] >= nb_of_samples_in_screen) || ((time_origin[ch] + (index[ch] - 1) * sample_interval) > 5 * time_per_division_m) )
                 {
-                    time_offset[ch] = 0.;
-                    memset(time[ch], 0, nb_of_samples_in_screen * sizeof(double));
-                    memset(values_V[ch], 0, nb_of_samples_in_screen * sizeof(double));
                     index[ch] = 0;
                 }
-                else
-                {
-                    time_offset[ch] = time[ch][index[ch] - 1];
-                }
             }
         }
-        Sleep(100);
-    }
-    for (ch = 0; ch < unitOpened_m.noOfChannels; ch++)
-    {
-        if (unitOpened_m.channelSettings[ch].enabled)
-        {
-            free(values_V[ch]);
-            free(time[ch]);
-        }
+        stage_start = PipelineStats::now_ns();
+        draw->publishData();
+        handoff_ns += PipelineStats::now_ns() - stage_start;
+        pipeline_stats_m.record_duration(PipelineStats::E_STAGE_CONVERT, convert_ns);
+        pipeline_stats_m.record_duration(PipelineStats::E_STAGE_HANDOFF, handoff_ns);
+        pipeline_stats_m.count_block(no_of_samples, block_duration);
     }
 }
 
@@ -431,7 +540,6 @@ void Acquisition3000::collect_block_immediate (void)
 
 void Acquisition3000::collect_block_triggered (trigger_e trigger_slope, double trigger_level)
 {
-    int i = 0;
     long time_interval;
     short time_units;
     short oversample;
@@ -443,16 +551,21 @@ void Acquisition3000::collect_block_triggered (trigger_e trigger_slope, double t
     int     threshold_mv = (int)(trigger_level * 1000);
     long max_samples;
     short ch = 0;
-    double* values_V[CHANNEL_MAX] = {NULL};
-    double* time[CHANNEL_MAX] = {NULL};
+    short *table = NULL;
     double time_multiplier = 0.;
-    double time_offset[CHANNEL_MAX] = {0.};
+    double sample_interval = 0.;
+    double time_origin[CHANNEL_MAX] = {0.};
+    double block_duration = 0.;
+    double trigger_time = 0.;
     int index[CHANNEL_MAX] = {0};
+    int nb_copied = 0;
+    AdcConvert::range_t range;
+    uint64_t stage_start = 0;
+    uint64_t convert_ns = 0;
+    uint64_t handoff_ns = 0;
     DEBUG ( "Collect block triggered...\n" );
     DEBUG ( "Collects when value rises past %dmV\n", threshold_mv );
 
-    set_defaults ();
-
     /* Trigger enabled
      * ChannelA - to trigger unsing this channel it needs to be enabled using ps3000_set_channel
      * Rising edge
@@ -487,96 +600,122 @@ void Acquisition3000::collect_block_triggered (trigger_e trigger_slope, double t
     oversample = 1;
     while (!ps3000_get_timebase ( unitOpened_m.handle,
                                     timebase,
-                                    no_of_samples,
+                                    BUFFER_SIZE,
                                     &time_interval,
                                     &time_units,
                                     oversample,
                                     &max_samples))
     timebase++;
 
+    /* the record length asked for, as long as the unit memory holds it */
+    no_of_samples = ( record_length_m < (uint32_t)max_samples ? (int)record_length_m : (int)max_samples );
     time_multiplier = adc_multipliers(time_units);
     nb_of_samples_in_screen = (int)(5 * time_per_division_m / (time_interval * time_multiplier)) + 1;
-    nb_of_samples_in_screen = ( nb_of_samples_in_screen < BUFFER_SIZE ? BUFFER_SIZE : nb_of_samples_in_screen);
-    for (ch = 0; ch < unitOpened_m.noOfChannels; ch++)
-    {
-        if (unitOpened_m.channelSettings[ch].enabled)
-        {
-            values_V[ch] = (double*)malloc(nb_of_samples_in_screen * sizeof(double));
-            time[ch] = (double*)malloc(nb_of_samples_in_screen * sizeof(double));
-        }
-    }
+    if ( !reserve_capture(no_of_samples, nb_of_samples_in_screen) )
+        no_of_samples = (int)capture_length_m;
+    /* a whole record is kept even when it spans more than the screen,
+     * without screen tables each record is shown on its own
+     */
+    if ( (nb_of_samples_in_screen < no_of_samples) || (nb_of_samples_in_screen > screen_length_m) )
+        nb_of_samples_in_screen = no_of_samples;
+    sample_interval = time_interval * time_multiplier;
     DEBUG ( "timebase: %hd\tnb_of_samples:%d\toversample:%hd\ttime_units:%hd\ttime_interval:%lu\ttime_multiplier:%e\tnb_of_samples_in_screen:%d\n", 
              timebase, no_of_samples, oversample, time_units, time_interval, time_multiplier, nb_of_samples_in_screen );
+    /* ps3000_get_timebase gives the sample interval in ns */
+    block_duration = no_of_samples * oversample * time_interval * 1E-9;
 
-    while ( sem_trywait(&thread_stop) )
+    while ( !stop_requested() )
     {
+        /* new timebase or trigger: back to threadAcquisition to set the capture up again */
+        if ( apply_pending_settings() & SETTINGS_REARM )
+            break;
+
         /* Start it collecting,
          *  then wait for completion
          */
-        ps3000_run_block ( unitOpened_m.handle, BUFFER_SIZE, timebase, oversample, &time_indisposed_ms );
-
-        while ( !ps3000_ready ( unitOpened_m.handle ) )
+        stage_start = PipelineStats::now_ns();
+        ps3000_run_block ( unitOpened_m.handle, no_of_samples, timebase, oversample, &time_indisposed_ms );
+        pipeline_stats_m.record(PipelineStats::E_STAGE_ARM, stage_start);
+        stage_start = PipelineStats::now_ns();
+        ready_waiter_m.arm( (time_indisposed_ms * 1E-3 > block_duration) ? time_indisposed_ms * 1E-3 : block_duration );
+        if ( ReadyWaiter::E_WAIT_READY != ready_waiter_m.wait_poll( &Acquisition3000::is_block_ready, this ) )
         {
-            if( !sem_trywait(&thread_stop) )
-            {
-                /* re-post semaphore to exit the main loop */
-                sem_post(&thread_stop);
-                break;
-            }
-            Sleep ( 100 );
+            /* stop requested while waiting */
+            ps3000_stop ( unitOpened_m.handle );
+            break;
         }
+        pipeline_stats_m.record(PipelineStats::E_STAGE_WAIT, stage_start);
 
         ps3000_stop ( unitOpened_m.handle );
 
         /* Get the times (in units specified by time_units)
          *  and the values (in ADC counts)
          */
+        stage_start = PipelineStats::now_ns();
         ps3000_get_times_and_values ( unitOpened_m.handle, times,
                                   unitOpened_m.channelSettings[PS3000_CHANNEL_A].values,
                                   unitOpened_m.channelSettings[PS3000_CHANNEL_B].values,
                                   unitOpened_m.channelSettings[PS3000_CHANNEL_C].values,
                                   unitOpened_m.channelSettings[PS3000_CHANNEL_D].values,
-                                  &overflow, time_units, BUFFER_SIZE );
+                                  &overflow, time_units, no_of_samples );
+        pipeline_stats_m.record(PipelineStats::E_STAGE_GET_VALUES, stage_start);
 
         DEBUG ( "%d values, overflow %d\n", no_of_samples, overflow );
 
+        /* times[0] puts the trigger at 0 to a sample, the crossing on
+         * channel A puts it there to a fraction of a sample */
+        trigger_time = times[0] * time_multiplier;
+        if ( unitOpened_m.channelSettings[PS3000_CHANNEL_A].enabled && (no_of_samples > 0) && (-trigger_time < no_of_samples * sample_interval) )
+        {
+            trigger_time = trigger_origin(unitOpened_m.channelSettings[PS3000_CHANNEL_A].values, no_of_samples,
+                                          (uint32_t)((trigger_time < 0.) ? -trigger_time / sample_interval + 0.5 : 0.),
+                                          adc_convert_m.get_range(unitOpened_m.channelSettings[PS3000_CHANNEL_A].range),
+                                          sample_interval, trigger_time);
+        }
+
+        convert_ns = 0;
+        handoff_ns = 0;
         for (ch = 0; (ch < unitOpened_m.noOfChannels) && (no_of_samples > 0); ch++)
         {
             if (unitOpened_m.channelSettings[ch].enabled)
             {
-                for (  i = 0; (i < no_of_samples) && (index[ch] < nb_of_samples_in_screen) ; i++, index[ch]++ )
+                nb_copied = nb_of_samples_in_screen - index[ch];
+                if (nb_copied > no_of_samples)
+                    nb_copied = no_of_samples;
+                /* samples are evenly spaced, only the first time is needed */
+                if (0 == index[ch])
+                    time_origin[ch] = trigger_time;
+                /* counts are kept as they come from the driver, the screen scales them */
+                table = unitOpened_m.channelSettings[ch].values;
+                if ( nb_of_samples_in_screen > no_of_samples )
                 {
-                    values_V[ch][index[ch]] = 0.001 * adc_to_mv(unitOpened_m.channelSettings[ch].values[i], unitOpened_m.channelSettings[ch].range);
-                    time[ch][index[ch]] = (times[i] * time_multiplier) + time_offset[ch];
-                    //DEBUG("V: %lf (range %d) T: %lf\n", values_V[index[ch]], unitOpened_m.channelSettings[ch].range, time[index[ch]]);
+                    stage_start = PipelineStats::now_ns();
+                    table = unitOpened_m.channelSettings[ch].screen;
+                    memcpy(&table[index[ch]], unitOpened_m.channelSettings[ch].values, nb_copied * sizeof(short));
+                    convert_ns += PipelineStats::now_ns() - stage_start;
                 }
+                index[ch] += nb_copied;
                 // resetting all available data as long as the screen is not filled.
-                draw->setData(ch+1, time[ch], values_V[ch], index[ch]);
+                stage_start = PipelineStats::now_ns();
+                range = adc_convert_m.get_range(unitOpened_m.channelSettings[ch].range);
+                /* the blocks before this one are in the table already */
+                draw->setRawData(ch+1, table, index[ch], range.scale, range.offset, time_origin[ch], sample_interval,
+                                 index[ch] > nb_copied);
+                handoff_ns += PipelineStats::now_ns() - stage_start;
                 DEBUG("set %d data\n", index[ch]);
-                if( (index[ch] >= nb_of_samples_in_screen) || (time[ch][index[ch] - 1] > 5 * time_per_division_m) )
+                if( (index[ch] >= nb_of_samples_in_screen) || ((time_origin[ch] + (index[ch] - 1) * sample_interval) > 5 * time_per_division_m) )
                 {
-                    time_offset[ch] = 0.;
-                    memset(time[ch], 0, nb_of_samples_in_screen * sizeof(double));
-                    memset(values_V[ch], 0, nb_of_samples_in_screen * sizeof(double));
                     index[ch] = 0;
                 }
-                else
-                {
-                    time_offset[ch] = time[ch][index[ch] - 1];
-                }
             }
 
         }
-        Sleep(100);
-    }
-
-    for (ch = 0; ch < unitOpened_m.noOfChannels; ch++)
-    {
-        if (unitOpened_m.channelSettings[ch].enabled)
-        {
-            free(values_V[ch]);
-            free(time[ch]);
-        }
+        stage_start = PipelineStats::now_ns();
+        draw->publishData();
+        handoff_ns += PipelineStats::now_ns() - stage_start;
+        pipeline_stats_m.record_duration(PipelineStats::E_STAGE_CONVERT, convert_ns);
+        pipeline_stats_m.record_duration(PipelineStats::E_STAGE_HANDOFF, handoff_ns);
+        pipeline_stats_m.count_block(no_of_samples, block_duration);
     }
 }
 
@@ -626,9 +765,12 @@ int        i;
   DEBUG ( "Waiting for trigger..." );
   DEBUG ( "Press a key to abort\n" );
 
-  while (( !ps3000_ready ( unitOpened_m.handle )) /*&& ( !kbhit () )*/)
+  ready_waiter_m.arm ( time_indisposed_ms * 1E-3 );
+  if ( ReadyWaiter::E_WAIT_READY != ready_waiter_m.wait_poll ( &Acquisition3000::is_block_ready, this ) )
   {
-    Sleep ( 100 );
+    DEBUG ( "data collection aborted\n" );
+    ps3000_stop ( unitOpened_m.handle );
+    return;
   }
 
 //  if (kbhit ())
@@ -760,9 +902,12 @@ void Acquisition3000::collect_block_ets (void)
     DEBUG ( "Waiting for trigger..." );
     DEBUG ( "Press a key to abort\n" );
 
-    while ( (!ps3000_ready (unitOpened_m.handle)) /*&& (!kbhit ())*/ )
+    ready_waiter_m.arm ( time_indisposed_ms * 1E-3 );
+    if ( ReadyWaiter::E_WAIT_READY != ready_waiter_m.wait_poll ( &Acquisition3000::is_block_ready, this ) )
     {
-        Sleep (100);
+        DEBUG ( "data collection aborted\n" );
+        ps3000_stop ( unitOpened_m.handle );
+        return;
     }
 
 //    if ( kbhit () )
@@ -859,6 +1004,7 @@ void Acquisition3000::collect_streaming (void)
     int    ok;
     short  ch;
     double values_V[BUFFER_SIZE] = {0};
+    double volts[BUFFER_SIZE];
     double time[BUFFER_SIZE] = {0};
     DEBUG ( "Collect streaming...\n" );
 
@@ -895,13 +1041,13 @@ void Acquisition3000::collect_streaming (void)
             if (unitOpened_m.channelSettings[ch].enabled)
             {
 
+                adc_convert_m.to_volts(unitOpened_m.channelSettings[ch].values, volts, no_of_values, unitOpened_m.channelSettings[ch].range);
                 for (  i = 0; i < no_of_values; i++, count++ )
                 {
-                    values_V[count] = 0.001 * adc_to_mv(unitOpened_m.channelSettings[ch].values[i], unitOpened_m.channelSettings[ch].range);
+                    values_V[count] = volts[i];
                     // TODO time will be probably wrong here, need to guess how to convert time range to time step...
                     //time[i] = ( i ? time[i-1] : 0) + unitOpened_m.channelSettings[ch].range
                     time[count] = count * 0.01 * time_per_division_m;
-                    DEBUG("V: %lf (range %d) T: %lf\n", values_V[count], unitOpened_m.channelSettings[ch].range, time[count]);
                     // 500 points are making a screen:
                     if(count == 500)
                     {
@@ -916,6 +1062,7 @@ void Acquisition3000::collect_streaming (void)
             }
 
         }
+        draw->publishData();
         Sleep(100);
     }
 
@@ -923,141 +1070,106 @@ void Acquisition3000::collect_streaming (void)
 
 }
 
+/****************************************************************************
+ * collect_fast_streaming
+ *  Continuous streaming until a setting changes or stop() is called.
+ *  Every poll, the driver calls ps3000FastStreamingReady() with the samples
+ *  taken since the previous one and they are copied in the stream ring,
+ *  the dispatcher thread feeds the screen and the other sinks from there.
+ *  Polls are spaced so that the driver overview buffer is drained well
+ *  before it fills up.
+ ****************************************************************************/
 void Acquisition3000::collect_fast_streaming (void)
 {
-    unsigned long    i;
-    short  overflow;
-    int     ok;
+    StreamSink::stream_format_t format;
+    AdcConvert::range_t range;
+    unsigned long sample_interval_ns = 0;
+    double poll_period = 0.;
+    short previous_buffer_overrun = 0;
+    short  ok;
     short ch;
-    unsigned long nPreviousValues = 0;
-    short values_a[BUFFER_SIZE_STREAMING];
-    short values_b[BUFFER_SIZE_STREAMING];
-    short *values = NULL;
-    double values_mV[BUFFER_SIZE_STREAMING];
-    double time[BUFFER_SIZE_STREAMING];
-    unsigned long triggerAt;
-    short triggered;
-    unsigned long no_of_samples;
-    double startTime = 0;
-
 
     DEBUG ( "Collect fast streaming...\n" );
 
-    set_defaults ();
+    if ( !unitOpened_m.hasFastStreaming )
+    {
+        WARNING ( "no fast streaming on this unit, back to block captures\n" );
+        streaming_m = false;
+        return;
+    }
 
     /* You cannot use triggering for the start of the data...
+    *  the screen triggers on the stream in software, see StreamTrigger.
     */
     ps3000_set_trigger ( unitOpened_m.handle, PS3000_NONE, 0, 0, 0, 0 );
 
-    unitOpened_m.trigger.advanced.autoStop = 0;
-    unitOpened_m.trigger.advanced.totalSamples = 0;
-    unitOpened_m.trigger.advanced.triggered = 0;
+    /* a record length of samples spans the screen, as block captures do */
+    sample_interval_ns = (unsigned long)(5 * time_per_division_m * 1E9 / record_length_m);
+    if ( sample_interval_ns < STREAMING_MIN_INTERVAL_NS )
+        sample_interval_ns = STREAMING_MIN_INTERVAL_NS;
 
-    /* Collect data at 10us intervals
-    * 100000 points with an agregation of 100 : 1
-    *    Auto stop after the 100000 samples
-    *  Start it collecting,
-    */
-    ok = ps3000_run_streaming_ns ( unitOpened_m.handle, 10, PS3000_US, BUFFER_SIZE_STREAMING, 1, 100, 30000 );
-    DEBUG ( "OK: %d\n", ok );
-
-    /* From here on, we can get data whenever we want...
-    */
-
-    while ( !unitOpened_m.trigger.advanced.autoStop && sem_trywait(&thread_stop))
+    memset ( &format, 0, sizeof(format) );
+    format.nb_channels = ( unitOpened_m.noOfChannels < STREAM_MAX_CHANNELS ? unitOpened_m.noOfChannels : STREAM_MAX_CHANNELS );
+    format.sample_interval = sample_interval_ns * 1E-9;
+    for (ch = 0; ch < format.nb_channels; ch++)
     {
-
-        ps3000_get_streaming_last_values (unitOpened_m.handle, &Acquisition3000::ps3000FastStreamingReady);
-        if (nPreviousValues != unitOpened_m.trigger.advanced.totalSamples)
+        if (unitOpened_m.channelSettings[ch].enabled)
         {
-
-            DEBUG ("Values collected: %ld\n", unitOpened_m.trigger.advanced.totalSamples - nPreviousValues);
-            nPreviousValues =     unitOpened_m.trigger.advanced.totalSamples;
-
+            range = adc_convert_m.get_range(unitOpened_m.channelSettings[ch].range);
+            format.channel_mask |= (uint8_t)(1 << ch);
+            format.scale[ch] = range.scale;
+            format.offset[ch] = range.offset;
         }
-        Sleep (0);
-
     }
-
-    ps3000_stop (unitOpened_m.handle);
-
-    no_of_samples = ps3000_get_streaming_values_no_aggregation (unitOpened_m.handle,
-                                                                &startTime, // get samples from the beginning
-                                                                values_a, // set buffer for channel A
-                                                                values_b, // set buffer for channel B
-                                                                NULL,
-                                                                NULL,
-                                                                &overflow,
-                                                                &triggerAt,
-                                                                &triggered,
-                                                                BUFFER_SIZE_STREAMING);
-
-
-    // print out the first 20 readings
-    for ( i = 0; i < 20; i++ )
+    if ( !start_stream(format) )
     {
-        for (ch = 0; ch < unitOpened_m.noOfChannels; ch++)
-        {
-            if (unitOpened_m.channelSettings[ch].enabled)
-            {
-                printf("%d, ", adc_to_mv ((!ch ? values_a[i] : values_b[i]), unitOpened_m.channelSettings[ch].range) );
-            }
-        }
-            printf("\n");
+        ERROR ( "cannot start the stream, back to block captures\n" );
+        streaming_m = false;
+        return;
     }
 
-    for (ch = 0; ch < unitOpened_m.noOfChannels; ch++)
-    {
-        if (unitOpened_m.channelSettings[ch].enabled)
-        {
-            switch(ch)
-            {
-                case 0:
-                    values = values_a;
-                break;
-                case 1:
-                    values = values_b;
-                break;
-                default:
-                    return;
-                break;
-            }
-
-            for (  i = 0; i < no_of_samples; i++ )
-            {
-                values_mV[i] = adc_to_mv(values[i], unitOpened_m.channelSettings[ch].range);
-                // TODO time will be probably wrong here, need to guess how to convert time range to time step...
-                time[i] = ( i ? time[i-1] : 0) + unitOpened_m.channelSettings[ch].range;
-            }
+    unitOpened_m.trigger.advanced.autoStop = 0;
+    unitOpened_m.trigger.advanced.totalSamples = 0;
+    unitOpened_m.trigger.advanced.triggered = 0;
 
-            draw->setData(ch+1, values_mV, time, no_of_samples);
-        }
-               
-    }
+    /* no auto stop and no aggregation: every sample reaches the callback
+    *  in the max overview buffers.
+    */
+    /* callback has no user parameter, it finds this unit through the thread */
+    streaming_instance_m = this;
+    ok = ps3000_run_streaming_ns ( unitOpened_m.handle, sample_interval_ns, PS3000_NS, BUFFER_SIZE_STREAMING, 0, 1, STREAMING_OVERVIEW_SIZE );
+    DEBUG ( "OK: %d, sample interval %lu ns\n", ok, sample_interval_ns );
 
+    /* a quarter of the overview buffer between two polls */
+    poll_period = STREAMING_OVERVIEW_SIZE * format.sample_interval / 4;
+    if ( poll_period > STREAMING_MAX_POLL_PERIOD )
+        poll_period = STREAMING_MAX_POLL_PERIOD;
 
-/*    DEBUG ( "Data is written to disk file (data.txt)\n" );
-    fp = fopen ( "data.txt", "w+" );
-    if (fp != NULL)
+    while ( ok && !stop_requested() )
     {
-        for ( i = 0; i < no_of_samples; i++ )
+        /* any change of range or timing changes the stream format: start it again */
+        if ( 0 != apply_pending_settings() )
+            break;
+
+        ps3000_get_streaming_last_values ( unitOpened_m.handle, &Acquisition3000::ps3000FastStreamingReady );
+        ps3000_overview_buffer_status ( unitOpened_m.handle, &previous_buffer_overrun );
+        if ( previous_buffer_overrun )
         {
-            for (ch = 0; ch < unitOpened_m.noOfChannels; ch++)
-            {
-                if (unitOpened_m.channelSettings[ch].enabled)
-                {
-                    fprintf ( fp, "%d, ", adc_to_mv ((!ch ? values_a[i] : values_b[i]), unitOpened_m.channelSettings[ch].range) );
-                }
-            }
-            fprintf (fp, "\n");
+            /* the driver lost samples before the callback could copy them */
+            stream_m.count_overflow();
         }
-        fclose ( fp );
+        if ( unitOpened_m.trigger.advanced.autoStop )
+            break;
+
+        ready_waiter_m.arm ( poll_period );
+        if ( ReadyWaiter::E_WAIT_CANCELLED == ready_waiter_m.wait_event( poll_period ) )
+            break;
     }
-    else
-        ERROR("Cannot open the file data.txt for writing. \nPlease ensure that you have permission to access. \n");
-*/
 
-    //getch ();
+    ps3000_stop ( unitOpened_m.handle );
+    streaming_instance_m = NULL;
+    stop_stream ();
+    DEBUG ( "%lu samples streamed\n", unitOpened_m.trigger.advanced.totalSamples );
 }
 
 void Acquisition3000::collect_fast_streaming_triggered (void)
@@ -1095,6 +1207,8 @@ void Acquisition3000::collect_fast_streaming_triggered (void)
     *    Auto stop after the 100000 samples
     *  Start it collecting,
     */
+    /* callback has no user parameter, it finds this unit through the thread */
+    streaming_instance_m = this;
     ok = ps3000_run_streaming_ns ( unitOpened_m.handle, 10, PS3000_US, BUFFER_SIZE_STREAMING, 1, 100, 30000 );
     DEBUG ( "OK: %d\n", ok );
 
@@ -1446,6 +1560,7 @@ void Acquisition3000::set_timebase (double time_per_division)
   short  time_units = 0;
   short  oversample = 1;
   long   max_samples = 0;
+  double screen_points = 0.;
 
   DEBUG ( "Specified timebase : %f\n", time_per_division );
   time_per_division_m = time_per_division;
@@ -1506,14 +1621,16 @@ void Acquisition3000::set_timebase (double time_per_division)
       {
           DEBUG ( "%d -> %ld %s  %hd\n", i, time_interval, adc_units(time_units), time_units );
           /**
-           * we want 100 points per division.
+           * we want a whole record per screen.
            * Screen has 5 time divisions.
-           * So we want 500 points
+           * So we want record_length_m points over 5 divisions,
+           * or what the unit memory holds at this timebase
            */
-          if(((double)time_interval * adc_multipliers(time_units)) <= (time_per_division * 0.010)){
+          screen_points = ( record_length_m < (uint32_t)max_samples ? record_length_m : max_samples );
+          if(((double)time_interval * adc_multipliers(time_units)) <= (5 * time_per_division / screen_points)){
               timebase = i;
           }
-          else if(((double)time_interval * adc_multipliers(time_units)) > (time_per_division * 0.010)){
+          else if(((double)time_interval * adc_multipliers(time_units)) > (5 * time_per_division / screen_points)){
               break;
           }
       }
@@ -78,8 +78,11 @@ public:
         std::string name;
     }volt_item_t;
 
-    /** @brief get singleton instance */
-    static Acquisition3000* get_instance();
+    /**
+     * @brief open the next 3000 series unit not opened yet
+     * @return NULL when no more unit is found
+     */
+    static Acquisition* open_unit();
     /** @brief destructor */
     virtual ~Acquisition3000();
     /**
@@ -182,7 +185,10 @@ private:
         short DCcoupled;
         short range;
         short enabled;
-        short values [BUFFER_SIZE];
+        /** @brief capture_length_m counts, carved from sample_arena_m */
+        short *values;
+        /** @brief screen_length_m counts the records of a screen are put together in, carved from sample_arena_m */
+        short *screen;
     } CHANNEL_SETTINGS;
 
 
@@ -210,7 +216,9 @@ private:
     short mv_to_adc (short mv, short ch);
     void get_info (void);
     void set_defaults (void);
+    void apply_channel (channel_e channel_index);
     void set_trigger_advanced(void);
+    bool reserve_capture (long nb_samples, long nb_screen = 0);
     void collect_block_immediate (void);
     void collect_block_triggered (trigger_e trigger_slope, double trigger_level);
     void collect_block_advanced_triggered ();
@@ -224,15 +232,22 @@ private:
                                                      short triggered,
                                                      short auto_stop,
                                                      unsigned long nValues);
+    /** @brief ReadyWaiter poll function, context is the Acquisition3000 instance */
+    static int is_block_ready(void *context);
     /**
      * @brief private instances declarations
      */
     UNIT_MODEL unitOpened_m;
-    static Acquisition3000 *singleton_m;
+    /** @brief unit running ps3000FastStreamingReady() on the calling thread */
+    static __thread Acquisition3000 *streaming_instance_m;
     int scale_to_mv;
     short timebase;
-    double time_per_division_m;
-    long times[BUFFER_SIZE];
+    /** @brief capture_length_m times, carved from sample_arena_m */
+    long *times;
+    /** @brief samples the capture buffers hold, never below BUFFER_SIZE once the unit is open */
+    long capture_length_m;
+    /** @brief samples the screen tables hold, 0 while a record fills the screen */
+    long screen_length_m;
     static const short input_ranges [PS3000_MAX_RANGES] /*= {10, 20, 50, 100, 200, 500, 1000, 3000, 5000, 10000, 30000, 50000}*/;
 };
 
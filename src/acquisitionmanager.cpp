@@ -0,0 +1,357 @@
+/*****************************************************************************
+*   Copyright 2012 Vincent HERVIEUX
+*
+*   This file is part of QPicoscope.
+*
+*   QPicoscope is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU Lesser General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   any later version.
+*
+*   QPicoscope is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU Lesser General Public License for more details.
+*
+*   You should have received a copy of the GNU Lesser General Public License
+*   along with QPicoscope in files COPYING.LESSER and COPYING.
+*   If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+/**
+ * @file acquisitionmanager.cpp
+ * @brief Definition of AcquisitionManager class.
+ * @version 0.1
+ * @date 2026, october 16
+ * @author Vincent HERVIEUX    -   10.16.2026   -   initial creation
+ */
+
+#include <unistd.h>
+#include <string.h>
+#include <time.h>
+#include <math.h>
+
+#include "acquisitionmanager.h"
+#include "acquisition2000.h"
+#include "acquisition2000a.h"
+#include "acquisition3000.h"
+#include "acquisitionplayback.h"
+#include "acquisitionsim.h"
+
+/* static members initialization */
+AcquisitionManager *AcquisitionManager::singleton_m = NULL;
+
+/****************************************************************************
+ *
+ * constructor
+ *
+ ****************************************************************************/
+AcquisitionManager::AcquisitionManager() :
+    nb_backends_m(0),
+    nb_devices_m(0),
+    nb_probing_m(0)
+{
+    pthread_condattr_t attr;
+
+    pthread_mutex_init(&lock_m, NULL);
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&probe_cond_m, &attr);
+    pthread_condattr_destroy(&attr);
+    memset(backends_m, 0, sizeof(backends_m));
+    memset(devices_m, 0, sizeof(devices_m));
+    memset(probes_m, 0, sizeof(probes_m));
+    memset(probing_m, 0, sizeof(probing_m));
+#ifdef HAVE_LIBPS2000
+    register_backend("2000", &Acquisition2000::open_unit);
+#endif
+#ifdef HAVE_LIBPS2000A
+    register_backend("2000a", &Acquisition2000a::open_unit);
+#endif
+#ifdef HAVE_LIBPS3000
+    register_backend("3000", &Acquisition3000::open_unit);
+#endif
+    /* only opens a unit when a capture file to play is given */
+    register_backend("playback", &AcquisitionPlayback::open_unit);
+    /* only opens a unit when simulated signals are asked for */
+    register_backend("sim", &AcquisitionSim::open_unit);
+}
+
+/****************************************************************************
+ *
+ * get_instance
+ *
+ ****************************************************************************/
+AcquisitionManager* AcquisitionManager::get_instance()
+{
+    if(NULL == AcquisitionManager::singleton_m)
+    {
+        AcquisitionManager::singleton_m = new AcquisitionManager();
+    }
+
+    return AcquisitionManager::singleton_m;
+}
+
+/****************************************************************************
+ *
+ * destructor
+ *
+ ****************************************************************************/
+AcquisitionManager::~AcquisitionManager()
+{
+    close_all();
+    pthread_cond_destroy(&probe_cond_m);
+    pthread_mutex_destroy(&lock_m);
+    AcquisitionManager::singleton_m = NULL;
+}
+
+/****************************************************************************
+ * register_backend
+ ****************************************************************************/
+int8_t AcquisitionManager::register_backend(const char *name, open_unit_fn_t open_unit)
+{
+    int8_t ret = 0;
+
+    if(NULL == open_unit)
+    {
+        ERROR("invalid open_unit function for backend %s\n", name);
+        return -1;
+    }
+    pthread_mutex_lock(&lock_m);
+    if(nb_backends_m >= ACQUISITION_MAX_BACKENDS)
+    {
+        ERROR("cannot register backend %s, table is full\n", name);
+        ret = -1;
+    }
+    else
+    {
+        backends_m[nb_backends_m].name = name;
+        backends_m[nb_backends_m].open_unit = open_unit;
+        nb_backends_m++;
+    }
+    pthread_mutex_unlock(&lock_m);
+    return ret;
+}
+
+/****************************************************************************
+ * cpu_for_device
+ *
+ * Core 0 is left to the GUI thread when there is more than one core.
+ ****************************************************************************/
+int AcquisitionManager::cpu_for_device(uint8_t index)
+{
+    long nb_cpus = sysconf(_SC_NPROCESSORS_ONLN);
+
+    if(nb_cpus <= 1)
+        return -1;
+    return (int)(1 + (index % (nb_cpus - 1)));
+}
+
+/****************************************************************************
+ * thread_probe
+ *
+ * Opens every unit of one backend. Driver calls run without the lock, a
+ * failed open may take seconds.
+ ****************************************************************************/
+void* AcquisitionManager::thread_probe(void *arg)
+{
+    probe_t *probe = (probe_t*)arg;
+    AcquisitionManager *manager = probe->manager;
+    const backend_t *backend = &manager->backends_m[probe->backend];
+    Acquisition *device = NULL;
+    bool full = false;
+
+    while(!full)
+    {
+        device = backend->open_unit();
+        if(NULL == device)
+            break;
+        pthread_mutex_lock(&manager->lock_m);
+        if(manager->nb_devices_m < ACQUISITION_MAX_DEVICES)
+        {
+            DEBUG("unit %d opened on backend %s\n", manager->nb_devices_m, backend->name);
+            device->set_cpu(manager->cpu_for_device(manager->nb_devices_m));
+            manager->devices_m[manager->nb_devices_m++] = device;
+            pthread_cond_broadcast(&manager->probe_cond_m);
+        }
+        else
+        {
+            ERROR("too many units, closing the last one from backend %s\n", backend->name);
+            delete device;
+        }
+        full = (manager->nb_devices_m >= ACQUISITION_MAX_DEVICES);
+        pthread_mutex_unlock(&manager->lock_m);
+    }
+
+    pthread_mutex_lock(&manager->lock_m);
+    manager->probing_m[probe->backend] = false;
+    manager->nb_probing_m--;
+    pthread_cond_broadcast(&manager->probe_cond_m);
+    pthread_mutex_unlock(&manager->lock_m);
+    return NULL;
+}
+
+/****************************************************************************
+ * probe_async_locked
+ ****************************************************************************/
+void AcquisitionManager::probe_async_locked(void)
+{
+    uint8_t backend = 0;
+    pthread_t thread;
+    pthread_attr_t attr;
+    int ret = 0;
+
+    pthread_attr_init(&attr);
+    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+    for(backend = 0; (backend < nb_backends_m) && (nb_devices_m < ACQUISITION_MAX_DEVICES); backend++)
+    {
+        if(probing_m[backend])
+            continue;
+        probes_m[backend].manager = this;
+        probes_m[backend].backend = backend;
+        ret = pthread_create(&thread, &attr, AcquisitionManager::thread_probe, &probes_m[backend]);
+        if(0 != ret)
+        {
+            ERROR("cannot probe backend %s, pthread_create returned %d\n", backends_m[backend].name, ret);
+            continue;
+        }
+        probing_m[backend] = true;
+        nb_probing_m++;
+    }
+    pthread_attr_destroy(&attr);
+}
+
+/****************************************************************************
+ * wait_probes_locked
+ ****************************************************************************/
+void AcquisitionManager::wait_probes_locked(void)
+{
+    while(nb_probing_m > 0)
+        pthread_cond_wait(&probe_cond_m, &lock_m);
+}
+
+/****************************************************************************
+ * open_all
+ ****************************************************************************/
+uint8_t AcquisitionManager::open_all(void)
+{
+    uint8_t count = 0;
+
+    pthread_mutex_lock(&lock_m);
+    probe_async_locked();
+    wait_probes_locked();
+    count = nb_devices_m;
+    pthread_mutex_unlock(&lock_m);
+    return count;
+}
+
+/****************************************************************************
+ * probe
+ ****************************************************************************/
+uint8_t AcquisitionManager::probe(double timeout)
+{
+    struct timespec deadline;
+    double integral = 0.;
+    double fractional = modf(timeout, &integral);
+    uint8_t count = 0;
+
+    clock_gettime(CLOCK_MONOTONIC, &deadline);
+    deadline.tv_sec += (time_t)integral;
+    deadline.tv_nsec += (long)(fractional * 1E9);
+    if(deadline.tv_nsec >= 1000000000L)
+    {
+        deadline.tv_sec++;
+        deadline.tv_nsec -= 1000000000L;
+    }
+
+    pthread_mutex_lock(&lock_m);
+    probe_async_locked();
+    /* first usable unit is enough, the others are added when their probe completes */
+    while((0 == nb_devices_m) && (nb_probing_m > 0))
+    {
+        if(0 != pthread_cond_timedwait(&probe_cond_m, &lock_m, &deadline))
+        {
+            DEBUG("probe timeout, %d backend(s) still probing\n", nb_probing_m);
+            break;
+        }
+    }
+    count = nb_devices_m;
+    pthread_mutex_unlock(&lock_m);
+    return count;
+}
+
+/****************************************************************************
+ * close_all
+ ****************************************************************************/
+void AcquisitionManager::close_all(void)
+{
+    uint8_t i = 0;
+
+    pthread_mutex_lock(&lock_m);
+    /* a driver open cannot be interrupted, let running probes complete */
+    wait_probes_locked();
+    for(i = 0; i < nb_devices_m; i++)
+    {
+        devices_m[i]->stop();
+        delete devices_m[i];
+        devices_m[i] = NULL;
+    }
+    nb_devices_m = 0;
+    pthread_mutex_unlock(&lock_m);
+}
+
+/****************************************************************************
+ * get_device_count
+ ****************************************************************************/
+uint8_t AcquisitionManager::get_device_count(void)
+{
+    uint8_t count = 0;
+
+    pthread_mutex_lock(&lock_m);
+    count = nb_devices_m;
+    pthread_mutex_unlock(&lock_m);
+    return count;
+}
+
+/****************************************************************************
+ * get_device
+ ****************************************************************************/
+Acquisition* AcquisitionManager::get_device(uint8_t index)
+{
+    Acquisition *device = NULL;
+
+    pthread_mutex_lock(&lock_m);
+    if(index < nb_devices_m)
+        device = devices_m[index];
+    pthread_mutex_unlock(&lock_m);
+    return device;
+}
+
+/****************************************************************************
+ * start_all
+ ****************************************************************************/
+void AcquisitionManager::start_all(void)
+{
+    uint8_t i = 0;
+
+    pthread_mutex_lock(&lock_m);
+    for(i = 0; i < nb_devices_m; i++)
+    {
+        devices_m[i]->start();
+    }
+    pthread_mutex_unlock(&lock_m);
+}
+
+/****************************************************************************
+ * stop_all
+ ****************************************************************************/
+void AcquisitionManager::stop_all(void)
+{
+    uint8_t i = 0;
+
+    pthread_mutex_lock(&lock_m);
+    for(i = 0; i < nb_devices_m; i++)
+    {
+        devices_m[i]->stop();
+    }
+    pthread_mutex_unlock(&lock_m);
+}
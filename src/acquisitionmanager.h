@@ -0,0 +1,127 @@
+/*****************************************************************************
+*   Copyright 2012 Vincent HERVIEUX
+*
+*   This file is part of QPicoscope.
+*
+*   QPicoscope is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU Lesser General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   any later version.
+*
+*   QPicoscope is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU Lesser General Public License for more details.
+*
+*   You should have received a copy of the GNU Lesser General Public License
+*   along with QPicoscope in files COPYING.LESSER and COPYING.
+*   If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+/**
+ * @file acquisitionmanager.h
+ * @brief Declaration of AcquisitionManager class.
+ * Owns every opened unit, whatever its series. Each series registers an
+ * open_unit function, called until it finds no more unit, so several
+ * PicoScopes can be driven by the same process. Each unit runs its own
+ * acquisition thread pinned to its own core.
+ * Series are probed concurrently, one thread each, since a failed open can
+ * take seconds in some drivers.
+ * @version 0.1
+ * @date 2026, october 16
+ * @author Vincent HERVIEUX    -   10.16.2026   -   initial creation
+ */
+
+#ifndef ACQUISITIONMANAGER_H
+#define ACQUISITIONMANAGER_H
+
+#include <pthread.h>
+
+#include "oscilloscope.h"
+#include "acquisition.h"
+
+#define ACQUISITION_MAX_DEVICES     8
+#define ACQUISITION_MAX_BACKENDS    8
+/* seconds to wait for a first unit before giving up a probe */
+#define ACQUISITION_PROBE_TIMEOUT   5.
+
+class AcquisitionManager
+{
+public:
+    /**
+     * @brief public typedef declarations
+     */
+    /** @brief opens the next unit not opened yet, NULL when there is none */
+    typedef Acquisition* (*open_unit_fn_t)(void);
+
+    typedef struct
+    {
+        const char     *name;
+        open_unit_fn_t  open_unit;
+    } backend_t;
+
+    /** @brief get singleton instance */
+    static AcquisitionManager* get_instance();
+    /** @brief destructor, closes every unit */
+    ~AcquisitionManager();
+    /**
+     * @brief add a series of devices (built-in ones are registered by the constructor)
+     * @return 0 on success, -1 when the backend table is full
+     */
+    int8_t register_backend(const char *name, open_unit_fn_t open_unit);
+    /**
+     * @brief open every unit not opened yet, on every backend
+     * Waits for every probe to complete.
+     * @return the number of opened units
+     */
+    uint8_t open_all(void);
+    /**
+     * @brief probe every backend concurrently
+     * Returns as soon as a unit is opened, the other probes go on in the
+     * background and add their units when they complete.
+     * @param[in] timeout: in seconds
+     * @return the number of opened units
+     */
+    uint8_t probe(double timeout);
+    /** @brief stop and close every unit */
+    void close_all(void);
+    /** @brief number of opened units */
+    uint8_t get_device_count(void);
+    /** @brief get an opened unit, NULL if index is out of range */
+    Acquisition* get_device(uint8_t index);
+    /** @brief start every unit that has a DrawData */
+    void start_all(void);
+    /** @brief stop every unit */
+    void stop_all(void);
+
+private:
+    AcquisitionManager();
+    AcquisitionManager(const AcquisitionManager&);
+    AcquisitionManager& operator=(const AcquisitionManager&);
+    typedef struct
+    {
+        AcquisitionManager *manager;
+        uint8_t             backend;
+    } probe_t;
+
+    /** @brief core for the acquisition thread of the index-th unit, -1 for none */
+    int cpu_for_device(uint8_t index);
+    /** @brief start a probe thread on every backend not being probed, lock must be held */
+    void probe_async_locked(void);
+    /** @brief wait until no probe runs, lock must be held */
+    void wait_probes_locked(void);
+    static void* thread_probe(void *arg);
+
+    static AcquisitionManager *singleton_m;
+    pthread_mutex_t lock_m;
+    backend_t backends_m[ACQUISITION_MAX_BACKENDS];
+    uint8_t nb_backends_m;
+    Acquisition *devices_m[ACQUISITION_MAX_DEVICES];
+    uint8_t nb_devices_m;
+    /** @brief signaled when a unit is opened or a probe completes */
+    pthread_cond_t probe_cond_m;
+    probe_t probes_m[ACQUISITION_MAX_BACKENDS];
+    bool probing_m[ACQUISITION_MAX_BACKENDS];
+    uint8_t nb_probing_m;
+};
+
+#endif // ACQUISITIONMANAGER_H
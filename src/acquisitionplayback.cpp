@@ -0,0 +1,581 @@
+/*****************************************************************************
+*   Copyright 2012 Vincent HERVIEUX
+*
+*   This file is part of QPicoscope.
+*
+*   QPicoscope is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU Lesser General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   any later version.
+*
+*   QPicoscope is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU Lesser General Public License for more details.
+*
+*   You should have received a copy of the GNU Lesser General Public License
+*   along with QPicoscope in files COPYING.LESSER and COPYING.
+*   If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+/**
+ * @file acquisitionplayback.cpp
+ * @brief Definition of AcquisitionPlayback class.
+ * @version 0.1
+ * @date 2026, october 16
+ * @author Vincent HERVIEUX    -   10.16.2026   -   initial creation
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "acquisitionplayback.h"
+#include "atomic-ops.h"
+
+/* static members initialization */
+bool AcquisitionPlayback::opened_m = false;
+
+/****************************************************************************
+ *
+ * constructor
+ *
+ ****************************************************************************/
+AcquisitionPlayback::AcquisitionPlayback() :
+    chunk_m(0),
+    mapped_m(false),
+    position_m(0),
+    seek_m(PLAYBACK_NO_SEEK),
+    speed_m(1.),
+    loop_m(true),
+    due_m(0.)
+{
+    memset(device_name_m, 0, sizeof(device_name_m));
+    memset(&view_m, 0, sizeof(view_m));
+}
+
+/****************************************************************************
+ *
+ * open_unit
+ *
+ ****************************************************************************/
+Acquisition* AcquisitionPlayback::open_unit()
+{
+    const char *path = getenv(PLAYBACK_ENV_FILE);
+    const char *speed = getenv(PLAYBACK_ENV_SPEED);
+    AcquisitionPlayback *unit = NULL;
+
+    /* a single file to play, the probe loop must end */
+    if((NULL == path) || ('\0' == path[0]) || opened_m)
+        return NULL;
+    opened_m = true;
+
+    unit = new AcquisitionPlayback();
+    if(!unit->open(path))
+    {
+        delete unit;
+        return NULL;
+    }
+    if(NULL != speed)
+        unit->set_speed(atof(speed));
+    return unit;
+}
+
+/****************************************************************************
+ *
+ * destructor
+ *
+ ****************************************************************************/
+AcquisitionPlayback::~AcquisitionPlayback()
+{
+    DEBUG ( "Playback closed\n" );
+    /* the acquisition thread maps chunks, it must be done first */
+    stop();
+}
+
+/****************************************************************************
+ * open
+ ****************************************************************************/
+bool AcquisitionPlayback::open (const char *path)
+{
+    const char *name = strrchr(path, '/');
+
+    if ( !file_m.open(path) )
+        return false;
+    snprintf(device_name_m, DEVICE_NAME_MAX, "Playback %s", (NULL != name) ? name + 1 : path);
+    return true;
+}
+
+/****************************************************************************
+ * get_device_info
+ ****************************************************************************/
+void AcquisitionPlayback::get_device_info(device_info_t* info)
+{
+    if(NULL == info)
+    {
+        ERROR("%s : invalid pointer given!\n", __FUNCTION__);
+        return;
+    }
+    memcpy(info->device_name, device_name_m, DEVICE_NAME_MAX);
+    /* every channel a recording can hold, unrecorded ones stay empty */
+    info->nb_channels = CAPTURE_MAX_CHANNELS;
+}
+
+/****************************************************************************
+ * set_speed
+ ****************************************************************************/
+void AcquisitionPlayback::set_speed (double speed)
+{
+    speed_m = (speed > 0.) ? speed : 0.;
+}
+
+/****************************************************************************
+ * seek_chunk
+ ****************************************************************************/
+void AcquisitionPlayback::seek_chunk (uint64_t chunk)
+{
+    if ( chunk < file_m.get_nb_chunks() )
+        ATOMIC_STORE_RELEASE(&seek_m, chunk << 32);
+}
+
+/****************************************************************************
+ * seek_sample
+ ****************************************************************************/
+bool AcquisitionPlayback::seek_sample (uint32_t stream, uint64_t sample)
+{
+    uint64_t chunk = file_m.find_chunk(stream, sample);
+    const capture_index_t *index = NULL;
+    uint64_t position = 0;
+
+    if ( (chunk >= file_m.get_nb_chunks()) || (file_m.get_index(chunk).stream != stream) )
+        return false;
+    /* a lost sample is replaced by the first one after it */
+    index = &file_m.get_index(chunk);
+    if ( sample > index->start_sample )
+        position = sample - index->start_sample;
+    ATOMIC_STORE_RELEASE(&seek_m, (chunk << 32) | position);
+    return true;
+}
+
+/****************************************************************************
+ * now
+ ****************************************************************************/
+double AcquisitionPlayback::now (void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1E-9;
+}
+
+/****************************************************************************
+ * load_cursor
+ ****************************************************************************/
+bool AcquisitionPlayback::load_cursor (void)
+{
+    uint64_t seek = ATOMIC_EXCHANGE(&seek_m, PLAYBACK_NO_SEEK);
+    uint64_t next = 0;
+    uint64_t tries = 0;
+
+    if ( PLAYBACK_NO_SEEK != seek )
+    {
+        mapped_m = file_m.map_chunk(seek >> 32, &view_m);
+        if ( !mapped_m )
+            return false;
+        chunk_m = seek >> 32;
+        position_m = (uint32_t)seek;
+        due_m = now();
+    }
+
+    /* empty chunks are skipped, at most one round of the file */
+    while ( !mapped_m || (position_m >= view_m.header->nb_samples) )
+    {
+        next = mapped_m ? chunk_m + 1 : chunk_m;
+        if ( next >= file_m.get_nb_chunks() )
+        {
+            if ( !loop_m )
+                return false;
+            next = 0;
+        }
+        if ( tries++ > file_m.get_nb_chunks() )
+            return false;
+        mapped_m = file_m.map_chunk(next, &view_m);
+        if ( !mapped_m )
+            return false;
+        chunk_m = next;
+        position_m = 0;
+    }
+    return true;
+}
+
+/****************************************************************************
+ * pace
+ *
+ * The schedule is absolute, a late block is caught up by the next ones.
+ * Too late, at a seek or after a stall, it starts again from now instead
+ * of publishing a burst.
+ ****************************************************************************/
+bool AcquisitionPlayback::pace (uint32_t nb_samples, double sample_interval)
+{
+    double speed = speed_m;
+    double current = now();
+    double wait = 0.;
+
+    if ( speed <= 0. )
+        return true;
+    if ( current > due_m + PLAYBACK_MAX_LATE )
+        due_m = current;
+    due_m += nb_samples * sample_interval / speed;
+
+    for ( wait = due_m - current; wait > 0.; wait = due_m - now() )
+    {
+        /* timebase or mode changes are applied at once, whatever the speed */
+        if ( settings_m.pending() )
+            break;
+        ready_waiter_m.arm ( wait );
+        if ( ReadyWaiter::E_WAIT_CANCELLED ==
+             ready_waiter_m.wait_event( (wait < STREAMING_MAX_POLL_PERIOD) ? wait : STREAMING_MAX_POLL_PERIOD ) )
+            return false;
+    }
+    return true;
+}
+
+/****************************************************************************
+ * idle
+ ****************************************************************************/
+void AcquisitionPlayback::idle (void)
+{
+    while ( !settings_m.pending() && (PLAYBACK_NO_SEEK == ATOMIC_LOAD_RELAXED(&seek_m)) )
+    {
+        ready_waiter_m.arm ( STREAMING_MAX_POLL_PERIOD );
+        if ( ReadyWaiter::E_WAIT_CANCELLED == ready_waiter_m.wait_event( STREAMING_MAX_POLL_PERIOD ) )
+            break;
+    }
+}
+
+/****************************************************************************
+ * serve_block
+ *
+ * A block inside the mapped chunk is handed to draw straight from the
+ * mapping, one spanning chunks is gathered in the arena. A block never
+ * spans two streams: sample rate and ranges may differ.
+ ****************************************************************************/
+bool AcquisitionPlayback::serve_block (void)
+{
+    const int16_t *tables[CAPTURE_MAX_CHANNELS] = {NULL};
+    int16_t *gathered[CAPTURE_MAX_CHANNELS] = {NULL};
+    capture_chunk_t format;
+    uint64_t block = 0;
+    uint64_t next = 0;
+    uint32_t nb_samples = 0;
+    uint32_t count = 0;
+    uint8_t ch = 0;
+    uint64_t stage_start = PipelineStats::now_ns();
+
+    if ( !load_cursor() )
+        return false;
+    memcpy(&format, view_m.header, sizeof(format));
+
+    /* the screen span, as block captures of a unit do */
+    block = record_length_m;
+    if ( time_per_division_m > 0. )
+        block = (uint64_t)(5 * time_per_division_m / format.sample_interval) + 1;
+    if ( block > PLAYBACK_MAX_BLOCK )
+        block = PLAYBACK_MAX_BLOCK;
+
+    count = view_m.header->nb_samples - position_m;
+    if ( count >= block )
+    {
+        nb_samples = (uint32_t)block;
+        for (ch = 0; ch < CAPTURE_MAX_CHANNELS; ch++)
+            tables[ch] = (NULL != view_m.tables[ch]) ? view_m.tables[ch] + position_m : NULL;
+        position_m += nb_samples;
+    }
+    else
+    {
+        if ( !sample_arena_m.reserve(CAPTURE_MAX_CHANNELS * SampleArena::aligned_size(block * sizeof(int16_t))) )
+        {
+            ERROR ( "cannot allocate a block of %llu samples\n", (unsigned long long)block );
+            return false;
+        }
+        for (ch = 0; ch < CAPTURE_MAX_CHANNELS; ch++)
+        {
+            gathered[ch] = (int16_t*)sample_arena_m.allocate(block * sizeof(int16_t));
+            tables[ch] = (format.channel_mask & (1 << ch)) ? gathered[ch] : NULL;
+        }
+        while ( nb_samples < block )
+        {
+            count = view_m.header->nb_samples - position_m;
+            if ( count > block - nb_samples )
+                count = (uint32_t)(block - nb_samples);
+            for (ch = 0; ch < CAPTURE_MAX_CHANNELS; ch++)
+            {
+                if ( NULL != tables[ch] )
+                    memcpy(gathered[ch] + nb_samples, view_m.tables[ch] + position_m, count * sizeof(int16_t));
+            }
+            nb_samples += count;
+            position_m += count;
+            next = view_m.header->start_sample + position_m;
+            /* lost chunks, a seek or the loop back to the start end the block too */
+            if ( (nb_samples >= block) || !load_cursor() || (view_m.header->stream != format.stream) ||
+                 (view_m.header->start_sample + position_m != next) )
+                break;
+        }
+    }
+
+    /* reading the file stands for the driver */
+    pipeline_stats_m.record(PipelineStats::E_STAGE_GET_VALUES, stage_start);
+
+    stage_start = PipelineStats::now_ns();
+    for (ch = 0; ch < CAPTURE_MAX_CHANNELS; ch++)
+    {
+        if ( NULL != tables[ch] )
+            draw->setRawData(ch + 1, tables[ch], nb_samples, format.scale[ch], format.offset[ch], 0., format.sample_interval, false);
+    }
+    draw->publishData();
+    pipeline_stats_m.record(PipelineStats::E_STAGE_HANDOFF, stage_start);
+    pipeline_stats_m.count_block(nb_samples, nb_samples * format.sample_interval);
+    return pace(nb_samples, format.sample_interval);
+}
+
+/****************************************************************************
+ * collect_block_immediate
+ ****************************************************************************/
+void AcquisitionPlayback::collect_block_immediate (void)
+{
+    DEBUG ( "Playback blocks at speed %g...\n", speed_m );
+
+    due_m = now();
+    while ( !stop_requested() )
+    {
+        /* new timebase or mode: back to threadAcquisition */
+        if ( apply_pending_settings() & SETTINGS_REARM )
+            break;
+        if ( !serve_block() )
+        {
+            /* end of the file: the last block stays on screen */
+            idle();
+            break;
+        }
+    }
+}
+
+/****************************************************************************
+ * collect_block_triggered
+ *  The recording is played as it is, the trigger does not select blocks.
+ ****************************************************************************/
+void AcquisitionPlayback::collect_block_triggered (trigger_e trigger_slope, double trigger_level)
+{
+    (void)trigger_slope;
+    (void)trigger_level;
+    collect_block_immediate();
+}
+
+/****************************************************************************
+ * collect_fast_streaming
+ *
+ * The ring is fed PLAYBACK_STREAM_PERIOD of recording at a time, or as
+ * much as it has room for when playing as fast as possible: the sinks
+ * then set the pace and no sample is dropped.
+ ****************************************************************************/
+void AcquisitionPlayback::collect_fast_streaming (void)
+{
+    StreamSink::stream_format_t format;
+    const int16_t *tables[STREAM_MAX_CHANNELS] = {NULL};
+    uint32_t stream = 0;
+    uint64_t next = 0;
+    uint32_t count = 0;
+    uint32_t step = 0;
+    uint8_t ch = 0;
+
+    DEBUG ( "Playback stream at speed %g...\n", speed_m );
+
+    if ( !load_cursor() )
+    {
+        idle();
+        return;
+    }
+
+    memset ( &format, 0, sizeof(format) );
+    format.nb_channels = ( view_m.header->nb_channels < STREAM_MAX_CHANNELS ? view_m.header->nb_channels : STREAM_MAX_CHANNELS );
+    format.channel_mask = view_m.header->channel_mask;
+    format.sample_interval = view_m.header->sample_interval;
+    for (ch = 0; ch < format.nb_channels; ch++)
+    {
+        format.scale[ch] = view_m.header->scale[ch];
+        format.offset[ch] = view_m.header->offset[ch];
+    }
+    stream = view_m.header->stream;
+    next = view_m.header->start_sample + position_m;
+    if ( !start_stream(format) )
+    {
+        ERROR ( "cannot start the stream, back to block playback\n" );
+        streaming_m = false;
+        return;
+    }
+
+    step = (uint32_t)(PLAYBACK_STREAM_PERIOD * speed_m / format.sample_interval) + 1;
+    due_m = now();
+    while ( !stop_requested() )
+    {
+        /* any change starts the stream again, as for a unit */
+        if ( 0 != apply_pending_settings() )
+            break;
+        if ( !load_cursor() )
+        {
+            idle();
+            break;
+        }
+        /* another stream, or a gap in this one: a new stream for the sinks */
+        if ( (view_m.header->stream != stream) || (view_m.header->start_sample + position_m != next) )
+            break;
+
+        count = view_m.header->nb_samples - position_m;
+        if ( speed_m <= 0. )
+        {
+            step = stream_m.get_room();
+            if ( 0 == step )
+            {
+                ready_waiter_m.arm ( STREAM_DRAIN_PERIOD );
+                if ( ReadyWaiter::E_WAIT_CANCELLED == ready_waiter_m.wait_event( STREAM_DRAIN_PERIOD ) )
+                    break;
+                continue;
+            }
+        }
+        if ( count > step )
+            count = step;
+        for (ch = 0; ch < format.nb_channels; ch++)
+            tables[ch] = (NULL != view_m.tables[ch]) ? view_m.tables[ch] + position_m : NULL;
+        stream_m.write(tables, count);
+        position_m += count;
+        next += count;
+        if ( !pace(count, format.sample_interval) )
+            break;
+    }
+
+    stop_stream ();
+}
+
+/****************************************************************************
+ * collect_fast_streaming_triggered
+ ****************************************************************************/
+void AcquisitionPlayback::collect_fast_streaming_triggered (void)
+{
+    collect_fast_streaming();
+}
+
+/****************************************************************************
+ * collect_block_advanced_triggered
+ ****************************************************************************/
+void AcquisitionPlayback::collect_block_advanced_triggered (void)
+{
+    collect_block_immediate();
+}
+
+/****************************************************************************
+ * collect_block_ets
+ ****************************************************************************/
+void AcquisitionPlayback::collect_block_ets (void)
+{
+    collect_block_immediate();
+}
+
+/****************************************************************************
+ * collect_streaming
+ ****************************************************************************/
+void AcquisitionPlayback::collect_streaming (void)
+{
+    collect_fast_streaming();
+}
+
+/****************************************************************************
+ * set_timebase
+ ****************************************************************************/
+void AcquisitionPlayback::set_timebase (double time_per_division)
+{
+    time_per_division_m = time_per_division;
+}
+
+/****************************************************************************
+ * set_voltages
+ ****************************************************************************/
+void AcquisitionPlayback::set_voltages (channel_e channel_index, double volts_per_division)
+{
+    (void)channel_index;
+    (void)volts_per_division;
+}
+
+/****************************************************************************
+ * set_DC_coupled
+ ****************************************************************************/
+void AcquisitionPlayback::set_DC_coupled(current_e coupling)
+{
+    (void)coupling;
+}
+
+/****************************************************************************
+ * set_sig_gen
+ ****************************************************************************/
+void AcquisitionPlayback::set_sig_gen (e_wave_type waveform, long frequency)
+{
+    (void)waveform;
+    (void)frequency;
+}
+
+/****************************************************************************
+ * set_sig_gen_arb
+ ****************************************************************************/
+void AcquisitionPlayback::set_sig_gen_arb (long int frequency)
+{
+    (void)frequency;
+}
+
+/****************************************************************************
+ * adc_to_mv
+ *  Counts are converted with the ranges of each chunk, not per channel.
+ ****************************************************************************/
+int AcquisitionPlayback::adc_to_mv (long raw, int ch)
+{
+    if ( !mapped_m || (ch < 0) || (ch >= CAPTURE_MAX_CHANNELS) )
+        return 0;
+    return (int)((raw * view_m.header->scale[ch] + view_m.header->offset[ch]) * 1000);
+}
+
+/****************************************************************************
+ * mv_to_adc
+ ****************************************************************************/
+short AcquisitionPlayback::mv_to_adc (short mv, short ch)
+{
+    if ( !mapped_m || (ch < 0) || (ch >= CAPTURE_MAX_CHANNELS) || (0. == view_m.header->scale[ch]) )
+        return 0;
+    return (short)((mv * 1E-3 - view_m.header->offset[ch]) / view_m.header->scale[ch]);
+}
+
+/****************************************************************************
+ * get_info
+ ****************************************************************************/
+void AcquisitionPlayback::get_info (void)
+{
+}
+
+/****************************************************************************
+ * set_defaults
+ ****************************************************************************/
+void AcquisitionPlayback::set_defaults (void)
+{
+}
+
+/****************************************************************************
+ * apply_channel
+ ****************************************************************************/
+void AcquisitionPlayback::apply_channel (channel_e channel_index)
+{
+    (void)channel_index;
+}
+
+/****************************************************************************
+ * set_trigger_advanced
+ ****************************************************************************/
+void AcquisitionPlayback::set_trigger_advanced(void)
+{
+}
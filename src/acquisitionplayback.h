@@ -0,0 +1,147 @@
+/*****************************************************************************
+*   Copyright 2012 Vincent HERVIEUX
+*
+*   This file is part of QPicoscope.
+*
+*   QPicoscope is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU Lesser General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   any later version.
+*
+*   QPicoscope is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU Lesser General Public License for more details.
+*
+*   You should have received a copy of the GNU Lesser General Public License
+*   along with QPicoscope in files COPYING.LESSER and COPYING.
+*   If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+/**
+ * @file acquisitionplayback.h
+ * @brief Declaration of AcquisitionPlayback class.
+ * Plays a capture file back as if it came from a unit, see captureformat.h.
+ * Block mode serves screen wide blocks, streaming mode feeds the stream
+ * sinks, both paced on the recording time at real time or any speed. The
+ * file is read through CaptureFile, one mapped chunk at a time, so hours
+ * of recording are played with the memory of a chunk. Playing as fast as
+ * possible gives the same samples on every run, which makes it the
+ * reference input to profile the pipeline without hardware.
+ * The file is taken from the QPICOSCOPE_PLAYBACK environment variable.
+ * @version 0.1
+ * @date 2026, october 16
+ * @author Vincent HERVIEUX    -   10.16.2026   -   initial creation
+ */
+#ifndef ACQUISITIONPLAYBACK_H
+#define ACQUISITIONPLAYBACK_H
+
+#include "oscilloscope.h"
+#include "acquisition.h"
+#include "capturefile.h"
+
+/* capture file to play, the backend opens no unit without it */
+#define PLAYBACK_ENV_FILE         "QPICOSCOPE_PLAYBACK"
+/* playback speed, 1 for real time, 0 for as fast as possible */
+#define PLAYBACK_ENV_SPEED        "QPICOSCOPE_PLAYBACK_SPEED"
+/* longest block served, in samples per channel */
+#define PLAYBACK_MAX_BLOCK        (16 * 1024 * 1024)
+/* time the stream is fed in at each step, in seconds */
+#define PLAYBACK_STREAM_PERIOD    0.010
+/* lateness after which the schedule restarts from now, in seconds */
+#define PLAYBACK_MAX_LATE         0.100
+#define PLAYBACK_NO_SEEK          UINT64_MAX
+
+class AcquisitionPlayback : public Acquisition{
+public:
+    /**
+     * @brief open the file named by QPICOSCOPE_PLAYBACK, once per process
+     * @return NULL when the variable is not set, the file cannot be played
+     * or it is already opened
+     */
+    static Acquisition* open_unit();
+    /** @brief destructor */
+    virtual ~AcquisitionPlayback();
+    /** @brief ranges are the recorded ones, nothing to set */
+    void set_voltages (channel_e channel_index, double volts_per_division);
+    /** @brief the screen span sets the block length */
+    void set_timebase (double time_per_division);
+    void set_DC_coupled(current_e coupling);
+    void set_sig_gen (e_wave_type waveform, long frequency);
+    void set_sig_gen_arb (long int frequency);
+    void get_device_info(device_info_t* info);
+    /**
+     * @brief playback speed, any thread
+     * @param[in] : 1. plays in real time, 10. ten times faster, 0. as fast as possible
+     */
+    void set_speed (double speed);
+    double get_speed (void) const { return speed_m; }
+    /** @brief start again from the first chunk at the end of the file, the default */
+    void set_loop (bool loop) { loop_m = loop; }
+    /** @brief chunks in the file, see CaptureFile */
+    uint64_t get_nb_chunks (void) const { return file_m.get_nb_chunks(); }
+    /** @brief go to the start of a chunk in O(1), any thread, applied before the next block */
+    void seek_chunk (uint64_t chunk);
+    /**
+     * @brief go to a sample of a stream, any thread
+     * @param[in] stream: capture_chunk_t::stream, recordings restart it on a change of format
+     * @param[in] sample: sample index from the start of the stream
+     * @return false if the stream ended before the sample
+     */
+    bool seek_sample (uint32_t stream, uint64_t sample);
+private:
+    /**
+     * @brief private methods declarations
+     */
+    AcquisitionPlayback();
+    bool open (const char *path);
+    int adc_to_mv (long raw, int ch);
+    short mv_to_adc (short mv, short ch);
+    void get_info (void);
+    void set_defaults (void);
+    void apply_channel (channel_e channel_index);
+    void set_trigger_advanced(void);
+    void collect_block_immediate (void);
+    void collect_block_triggered (trigger_e trigger_slope, double trigger_level);
+    void collect_block_advanced_triggered (void);
+    void collect_block_ets (void);
+    void collect_streaming (void);
+    void collect_fast_streaming (void);
+    void collect_fast_streaming_triggered (void);
+    /**
+     * @brief map the chunk the next sample is in, after any pending seek
+     * @return false at the end of the file when not looping, or on error
+     */
+    bool load_cursor (void);
+    /** @brief publish the next block of the screen span, false at the end or when stopped */
+    bool serve_block (void);
+    /**
+     * @brief move due_m by samples of the recording and wait for it
+     * @return false when stopped, true when due or when a setting is pending
+     */
+    bool pace (uint32_t nb_samples, double sample_interval);
+    /** @brief wait for a setting or for stop(), the end of the file has been reached */
+    void idle (void);
+    /** @brief playback clock, in seconds */
+    static double now (void);
+
+    /**
+     * @brief private instances declarations
+     */
+    static bool opened_m;
+    CaptureFile file_m;
+    char device_name_m[DEVICE_NAME_MAX];
+    /** @brief chunk the cursor is in, mapped in view_m when mapped_m */
+    uint64_t chunk_m;
+    CaptureFile::chunk_view_t view_m;
+    bool mapped_m;
+    /** @brief next sample of the chunk */
+    uint32_t position_m;
+    /** @brief (chunk << 32) | sample of the chunk, PLAYBACK_NO_SEEK when none */
+    uint64_t seek_m;
+    double speed_m;
+    bool loop_m;
+    /** @brief wall time the next samples are due at, reset on seek and when late */
+    double due_m;
+};
+
+#endif // ACQUISITIONPLAYBACK_H
@@ -0,0 +1,629 @@
+/*****************************************************************************
+*   Copyright 2012 Vincent HERVIEUX
+*
+*   This file is part of QPicoscope.
+*
+*   QPicoscope is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU Lesser General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   any later version.
+*
+*   QPicoscope is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU Lesser General Public License for more details.
+*
+*   You should have received a copy of the GNU Lesser General Public License
+*   along with QPicoscope in files COPYING.LESSER and COPYING.
+*   If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+/**
+ * @file acquisitionsim.cpp
+ * @brief Definition of AcquisitionSim class.
+ * @version 0.1
+ * @date 2026, october 16
+ * @author Vincent HERVIEUX    -   10.16.2026   -   initial creation
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "acquisitionsim.h"
+
+/* static members initialization */
+uint8_t AcquisitionSim::nb_units_m = 0;
+const short AcquisitionSim::input_ranges [] = {10, 20, 50, 100, 200, 500, 1000, 2000, 5000, 10000, 20000};
+
+#define SIM_NB_RANGES    (sizeof(input_ranges) / sizeof(input_ranges[0]))
+/* 5 V, the widest range a 1 V signal fits in with room for glitches */
+#define SIM_DEFAULT_RANGE    8
+
+/****************************************************************************
+ *
+ * constructor
+ *
+ ****************************************************************************/
+AcquisitionSim::AcquisitionSim() :
+    nb_channels_m(2),
+    max_rate_m(SIM_DEFAULT_RATE),
+    sample_interval_m(1. / SIM_DEFAULT_RATE),
+    speed_m(1.),
+    due_m(0.),
+    capture_length_m(0)
+{
+    SignalGenerator::signal_t signal;
+    short ch = 0;
+
+    memset(values_m, 0, sizeof(values_m));
+    for (ch = 0; ch < SIM_MAX_CHANNELS; ch++)
+    {
+        channels_m[ch].DCcoupled = 1;
+        channels_m[ch].range = SIM_DEFAULT_RANGE;
+        channels_m[ch].enabled = 1;
+    }
+    adc_convert_m.set_ranges(input_ranges, SIM_NB_RANGES, SIGNAL_MAX_ADC);
+
+    /* a noisy sine on A and a square on B, the others are copies of them */
+    signal = generators_m[CHANNEL_A].get_signal();
+    signal.noise = 0.01;
+    generators_m[CHANNEL_A].set_signal(signal);
+    generators_m[CHANNEL_C].set_signal(signal);
+    signal.wave = SignalGenerator::E_SIGNAL_SQUARE;
+    signal.amplitude = 0.5;
+    signal.noise = 0.;
+    generators_m[CHANNEL_B].set_signal(signal);
+    generators_m[CHANNEL_D].set_signal(signal);
+    nb_units_m++;
+}
+
+/****************************************************************************
+ *
+ * open_unit
+ *
+ ****************************************************************************/
+Acquisition* AcquisitionSim::open_unit()
+{
+    const char *signals = getenv(SIM_ENV_SIGNALS);
+    const char *rate = getenv(SIM_ENV_RATE);
+    const char *speed = getenv(SIM_ENV_SPEED);
+    const char *units = getenv(SIM_ENV_UNITS);
+    int nb_units = (NULL != units) ? atoi(units) : 1;
+    AcquisitionSim *unit = NULL;
+    SignalGenerator::signal_t signal;
+    char description[256];
+    char *channel = NULL;
+    char *next = NULL;
+    uint8_t ch = 0;
+
+    if((NULL == signals) || ('\0' == signals[0]))
+        return NULL;
+    if(nb_units < 1)
+        nb_units = 1;
+    if(nb_units > SIM_MAX_UNITS)
+        nb_units = SIM_MAX_UNITS;
+    /* the probe loop must end */
+    if(nb_units_m >= nb_units)
+        return NULL;
+
+    unit = new AcquisitionSim();
+    if(0 != strcmp(signals, "1"))
+    {
+        snprintf(description, sizeof(description), "%s", signals);
+        for(channel = description; (NULL != channel) && (ch < SIM_MAX_CHANNELS); channel = next, ch++)
+        {
+            next = strchr(channel, ';');
+            if(NULL != next)
+                *next++ = '\0';
+            signal = unit->generators_m[ch].get_signal();
+            if(!SignalGenerator::parse(channel, &signal))
+            {
+                ERROR("cannot parse signal \"%s\" of channel %c\n", channel, 'A' + ch);
+                delete unit;
+                return NULL;
+            }
+            unit->generators_m[ch].set_signal(signal);
+        }
+        unit->nb_channels_m = ch;
+    }
+    if(NULL != rate)
+        unit->set_max_rate(atof(rate));
+    if(NULL != speed)
+        unit->set_speed(atof(speed));
+    DEBUG("simulated unit %d of %d with %d channels up to %g S/s\n", nb_units_m, nb_units,
+          unit->nb_channels_m, unit->max_rate_m);
+    return unit;
+}
+
+/****************************************************************************
+ *
+ * destructor
+ *
+ ****************************************************************************/
+AcquisitionSim::~AcquisitionSim()
+{
+    DEBUG ( "Simulated unit destroyed\n" );
+    stop();
+    /* closed, the next probe opens it again */
+    nb_units_m--;
+}
+
+/****************************************************************************
+ * get_device_info
+ ****************************************************************************/
+void AcquisitionSim::get_device_info(device_info_t* info)
+{
+    if(NULL == info)
+    {
+        ERROR("%s : invalid pointer given!\n", __FUNCTION__);
+        return;
+    }
+    snprintf(info->device_name, DEVICE_NAME_MAX, "Simulated %g MS/s", max_rate_m * 1E-6);
+    info->nb_channels = nb_channels_m;
+}
+
+/****************************************************************************
+ * set_signal
+ ****************************************************************************/
+void AcquisitionSim::set_signal (channel_e channel_index, const SignalGenerator::signal_t &signal)
+{
+    if (channel_index >= nb_channels_m)
+    {
+        ERROR ( "%s : invalid channel index!\n", __FUNCTION__ );
+        return;
+    }
+    generators_m[channel_index].set_signal(signal);
+}
+
+/****************************************************************************
+ * set_nb_channels
+ ****************************************************************************/
+void AcquisitionSim::set_nb_channels (uint8_t nb_channels)
+{
+    if ( (0 == nb_channels) || (nb_channels > SIM_MAX_CHANNELS) )
+    {
+        ERROR ( "%s : invalid number of channels %d!\n", __FUNCTION__, nb_channels );
+        return;
+    }
+    nb_channels_m = nb_channels;
+}
+
+/****************************************************************************
+ * set_max_rate
+ ****************************************************************************/
+void AcquisitionSim::set_max_rate (double max_rate)
+{
+    max_rate_m = (max_rate > 0.) ? max_rate : SIM_DEFAULT_RATE;
+}
+
+/****************************************************************************
+ * now
+ ****************************************************************************/
+double AcquisitionSim::now (void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1E-9;
+}
+
+/****************************************************************************
+ * reserve_capture
+ ****************************************************************************/
+bool AcquisitionSim::reserve_capture (uint32_t nb_samples)
+{
+    size_t table = SampleArena::aligned_size(nb_samples * sizeof(int16_t));
+    short ch = 0;
+
+    if ( (nb_samples <= capture_length_m) && (NULL != values_m[0]) )
+        return true;
+    if ( !sample_arena_m.reserve(SIM_MAX_CHANNELS * table) )
+    {
+        ERROR ( "cannot allocate %u samples per channel\n", nb_samples );
+        return false;
+    }
+    for (ch = 0; ch < SIM_MAX_CHANNELS; ch++)
+        values_m[ch] = (int16_t*)sample_arena_m.allocate(table);
+    capture_length_m = nb_samples;
+    return true;
+}
+
+/****************************************************************************
+ * pace
+ *
+ * Captures take the time a unit would need to sample them, as long as the
+ * CPU keeps up. A late schedule starts again from now.
+ ****************************************************************************/
+bool AcquisitionSim::pace (uint64_t nb_samples)
+{
+    double speed = speed_m;
+    double current = now();
+    double wait = 0.;
+
+    if ( speed <= 0. )
+        return true;
+    if ( current > due_m + STREAMING_MAX_POLL_PERIOD )
+        due_m = current;
+    due_m += nb_samples * sample_interval_m / speed;
+
+    for ( wait = due_m - current; wait > 0.; wait = due_m - now() )
+    {
+        if ( settings_m.pending() )
+            break;
+        ready_waiter_m.arm ( wait );
+        if ( ReadyWaiter::E_WAIT_CANCELLED ==
+             ready_waiter_m.wait_event( (wait < STREAMING_MAX_POLL_PERIOD) ? wait : STREAMING_MAX_POLL_PERIOD ) )
+            return false;
+    }
+    return true;
+}
+
+/****************************************************************************
+ * find_trigger
+ ****************************************************************************/
+int64_t AcquisitionSim::find_trigger (const int16_t *counts, uint32_t count, trigger_e trigger_slope, int16_t level) const
+{
+    uint32_t i = 0;
+
+    if ( E_TRIGGER_FALLING == trigger_slope )
+    {
+        for (i = 1; i < count; i++)
+        {
+            if ( (counts[i - 1] > level) && (counts[i] <= level) )
+                return i;
+        }
+    }
+    else
+    {
+        for (i = 1; i < count; i++)
+        {
+            if ( (counts[i - 1] < level) && (counts[i] >= level) )
+                return i;
+        }
+    }
+    return -1;
+}
+
+/****************************************************************************
+ * collect_blocks
+ *
+ * A record length of samples spans the screen. Triggered captures sample
+ * two records and show the one starting 10% before the first crossing on
+ * channel A in the first record, nothing when there is none, as a unit
+ * waiting for its trigger. The crossing is at time 0 to a fraction of a
+ * sample, see TriggerInterpolator.
+ ****************************************************************************/
+void AcquisitionSim::collect_blocks (trigger_e trigger_slope, double trigger_level)
+{
+    AdcConvert::range_t range;
+    uint32_t nb_samples = record_length_m;
+    uint32_t pre_trigger = 0;
+    uint32_t captured = 0;
+    int64_t trigger_at = 0;
+    double trigger_time = 0.;
+    int16_t level = 0;
+    short ch = 0;
+    uint64_t stage_start = 0;
+
+    if ( nb_samples > SIM_MAX_SAMPLES / 2 )
+        nb_samples = SIM_MAX_SAMPLES / 2;
+    sample_interval_m = 5 * time_per_division_m / nb_samples;
+    if ( sample_interval_m < 1. / max_rate_m )
+        sample_interval_m = 1. / max_rate_m;
+    captured = ( E_TRIGGER_AUTO == trigger_slope ) ? nb_samples : 2 * nb_samples;
+    pre_trigger = ( E_TRIGGER_AUTO == trigger_slope ) ? 0 : nb_samples / 10;
+    if ( !reserve_capture(captured) )
+        return;
+    for (ch = 0; ch < nb_channels_m; ch++)
+        generators_m[ch].configure(sample_interval_m, input_ranges[channels_m[ch].range] * 1E-3);
+    range = adc_convert_m.get_range(channels_m[CHANNEL_A].range);
+    level = (int16_t)((0. != range.scale) ? (trigger_level - range.offset) / range.scale : 0.);
+
+    DEBUG ( "sim blocks: %u samples every %g s, trigger %d at %d counts\n", nb_samples, sample_interval_m, trigger_slope, level );
+
+    due_m = now();
+    while ( !stop_requested() )
+    {
+        /* new timebase or trigger: back to threadAcquisition to set the capture up again */
+        if ( apply_pending_settings() & SETTINGS_REARM )
+            break;
+
+        /* the generators stand for the driver */
+        stage_start = PipelineStats::now_ns();
+        for (ch = 0; ch < nb_channels_m; ch++)
+        {
+            if ( channels_m[ch].enabled )
+                generators_m[ch].generate(values_m[ch], captured);
+        }
+        pipeline_stats_m.record(PipelineStats::E_STAGE_GET_VALUES, stage_start);
+        trigger_at = 0;
+        if ( E_TRIGGER_AUTO != trigger_slope )
+        {
+            trigger_at = -1;
+            if ( channels_m[CHANNEL_A].enabled )
+                trigger_at = find_trigger(values_m[CHANNEL_A] + pre_trigger, nb_samples, trigger_slope, level);
+        }
+        if ( trigger_at >= 0 )
+        {
+            stage_start = PipelineStats::now_ns();
+            trigger_time = -(double)pre_trigger * sample_interval_m;
+            if ( E_TRIGGER_AUTO != trigger_slope )
+                trigger_time = trigger_origin(values_m[CHANNEL_A] + trigger_at, nb_samples, pre_trigger,
+                                              adc_convert_m.get_range(channels_m[CHANNEL_A].range),
+                                              sample_interval_m, trigger_time);
+            for (ch = 0; ch < nb_channels_m; ch++)
+            {
+                if ( channels_m[ch].enabled )
+                {
+                    range = adc_convert_m.get_range(channels_m[ch].range);
+                    draw->setRawData(ch + 1, values_m[ch] + trigger_at, nb_samples, range.scale, range.offset,
+                                     trigger_time, sample_interval_m, false);
+                }
+            }
+            draw->publishData();
+            pipeline_stats_m.record(PipelineStats::E_STAGE_HANDOFF, stage_start);
+            pipeline_stats_m.count_block(nb_samples, captured * sample_interval_m);
+        }
+        if ( !pace(captured) )
+            break;
+    }
+}
+
+/****************************************************************************
+ * collect_block_immediate
+ ****************************************************************************/
+void AcquisitionSim::collect_block_immediate (void)
+{
+    collect_blocks(E_TRIGGER_AUTO, 0.);
+}
+
+/****************************************************************************
+ * collect_block_triggered
+ ****************************************************************************/
+void AcquisitionSim::collect_block_triggered (trigger_e trigger_slope, double trigger_level)
+{
+    collect_blocks(trigger_slope, trigger_level);
+}
+
+/****************************************************************************
+ * collect_block_advanced_triggered
+ ****************************************************************************/
+void AcquisitionSim::collect_block_advanced_triggered (void)
+{
+    collect_blocks(trigger_slope_m, trigger_level_m);
+}
+
+/****************************************************************************
+ * collect_block_ets
+ ****************************************************************************/
+void AcquisitionSim::collect_block_ets (void)
+{
+    collect_blocks(trigger_slope_m, trigger_level_m);
+}
+
+/****************************************************************************
+ * collect_fast_streaming
+ *
+ * Samples are generated SIM_STREAM_PERIOD at a time, or as many as the
+ * ring has room for when running as fast as possible: the sinks then set
+ * the pace and the stream has no gap.
+ ****************************************************************************/
+void AcquisitionSim::collect_fast_streaming (void)
+{
+    StreamSink::stream_format_t format;
+    AdcConvert::range_t range;
+    const int16_t *tables[STREAM_MAX_CHANNELS] = {NULL};
+    uint32_t step = 0;
+    uint32_t count = 0;
+    short ch = 0;
+
+    /* a record length of samples spans the screen, as block captures do */
+    sample_interval_m = 5 * time_per_division_m / record_length_m;
+    if ( sample_interval_m < 1. / max_rate_m )
+        sample_interval_m = 1. / max_rate_m;
+    step = (uint32_t)(SIM_STREAM_PERIOD * speed_m / sample_interval_m) + 1;
+    if ( (step > SIM_MAX_SAMPLES) || (speed_m <= 0.) )
+        step = SIM_MAX_SAMPLES / 8;
+    if ( !reserve_capture(step) )
+        return;
+
+    memset ( &format, 0, sizeof(format) );
+    format.nb_channels = ( nb_channels_m < STREAM_MAX_CHANNELS ? nb_channels_m : STREAM_MAX_CHANNELS );
+    format.sample_interval = sample_interval_m;
+    for (ch = 0; ch < format.nb_channels; ch++)
+    {
+        generators_m[ch].configure(sample_interval_m, input_ranges[channels_m[ch].range] * 1E-3);
+        if ( channels_m[ch].enabled )
+        {
+            range = adc_convert_m.get_range(channels_m[ch].range);
+            format.channel_mask |= (uint8_t)(1 << ch);
+            format.scale[ch] = range.scale;
+            format.offset[ch] = range.offset;
+            tables[ch] = values_m[ch];
+        }
+    }
+    if ( !start_stream(format) )
+    {
+        ERROR ( "cannot start the stream, back to block captures\n" );
+        streaming_m = false;
+        return;
+    }
+    DEBUG ( "sim stream: a sample every %g s, %u per step\n", sample_interval_m, step );
+
+    due_m = now();
+    while ( !stop_requested() )
+    {
+        /* any change of range or timing changes the stream format: start it again */
+        if ( 0 != apply_pending_settings() )
+            break;
+
+        count = step;
+        if ( speed_m <= 0. )
+        {
+            if ( count > stream_m.get_room() )
+                count = stream_m.get_room();
+            if ( 0 == count )
+            {
+                ready_waiter_m.arm ( STREAM_DRAIN_PERIOD );
+                if ( ReadyWaiter::E_WAIT_CANCELLED == ready_waiter_m.wait_event( STREAM_DRAIN_PERIOD ) )
+                    break;
+                continue;
+            }
+        }
+        for (ch = 0; ch < format.nb_channels; ch++)
+        {
+            if ( NULL != tables[ch] )
+                generators_m[ch].generate(values_m[ch], count);
+        }
+        /* a unit overflows like this when the host falls behind */
+        if ( stream_m.write(tables, count) < count )
+            stream_m.count_overflow();
+        if ( !pace(count) )
+            break;
+    }
+
+    stop_stream ();
+}
+
+/****************************************************************************
+ * collect_fast_streaming_triggered
+ ****************************************************************************/
+void AcquisitionSim::collect_fast_streaming_triggered (void)
+{
+    collect_fast_streaming();
+}
+
+/****************************************************************************
+ * collect_streaming
+ ****************************************************************************/
+void AcquisitionSim::collect_streaming (void)
+{
+    collect_fast_streaming();
+}
+
+/****************************************************************************
+ * set_timebase
+ *  The sample interval follows from it at the next capture set up.
+ ****************************************************************************/
+void AcquisitionSim::set_timebase (double time_per_division)
+{
+    time_per_division_m = time_per_division;
+}
+
+/****************************************************************************
+ * set_voltages
+ ****************************************************************************/
+void AcquisitionSim::set_voltages (channel_e channel_index, double volts_per_division)
+{
+    uint8_t i = 0;
+
+    if (channel_index >= nb_channels_m)
+    {
+        ERROR ( "%s : invalid channel index!\n", __FUNCTION__ );
+        return;
+    }
+    if((5. * volts_per_division) > ((double)input_ranges[SIM_NB_RANGES - 1] / 1000.)){
+        ERROR ( "%s : invalid voltage index!\n", __FUNCTION__ );
+        return;
+    }
+
+    /* find the first range that includes the voltage caliber */
+    for ( i = 0; i < SIM_NB_RANGES; i++ )
+    {
+        if(((double)input_ranges[i] / 1000.) >= (5. * volts_per_division))
+        {
+            channels_m[channel_index].range = i;
+            break;
+        }
+    }
+    channels_m[channel_index].enabled = 1;
+    DEBUG ( "Channel %c has now range %d mV\n", 'A' + channel_index, input_ranges[channels_m[channel_index].range]);
+}
+
+/****************************************************************************
+ * apply_channel
+ *  Counts are scaled to the range when generated, nothing to program.
+ ****************************************************************************/
+void AcquisitionSim::apply_channel (channel_e channel_index)
+{
+    if (channel_index < nb_channels_m)
+        generators_m[channel_index].configure(sample_interval_m, input_ranges[channels_m[channel_index].range] * 1E-3);
+}
+
+/****************************************************************************
+ * set_DC_coupled
+ *  Kept for get_info, signals are generated with their offset anyway.
+ ****************************************************************************/
+void AcquisitionSim::set_DC_coupled(current_e coupling)
+{
+    short ch = 0;
+
+    for (ch = 0; ch < SIM_MAX_CHANNELS; ch++)
+        channels_m[ch].DCcoupled = (E_CURRENT_DC == coupling) ? 1 : 0;
+}
+
+/****************************************************************************
+ * set_sig_gen
+ ****************************************************************************/
+void AcquisitionSim::set_sig_gen (e_wave_type waveform, long frequency)
+{
+    (void)waveform;
+    (void)frequency;
+}
+
+/****************************************************************************
+ * set_sig_gen_arb
+ ****************************************************************************/
+void AcquisitionSim::set_sig_gen_arb (long int frequency)
+{
+    (void)frequency;
+}
+
+/****************************************************************************
+ * adc_to_mv
+ ****************************************************************************/
+int AcquisitionSim::adc_to_mv (long raw, int ch)
+{
+    return ( raw * input_ranges[ch] ) / SIGNAL_MAX_ADC;
+}
+
+/****************************************************************************
+ * mv_to_adc
+ ****************************************************************************/
+short AcquisitionSim::mv_to_adc (short mv, short ch)
+{
+    return ( ( mv * SIGNAL_MAX_ADC ) / input_ranges[ch] );
+}
+
+/****************************************************************************
+ * get_info
+ ****************************************************************************/
+void AcquisitionSim::get_info (void)
+{
+    short ch = 0;
+
+    for (ch = 0; ch < nb_channels_m; ch++)
+    {
+        DEBUG ( "Channel %c: range %d mV, %s, %s\n", 'A' + ch, input_ranges[channels_m[ch].range],
+                channels_m[ch].DCcoupled ? "DC" : "AC", channels_m[ch].enabled ? "on" : "off" );
+    }
+}
+
+/****************************************************************************
+ * set_defaults
+ ****************************************************************************/
+void AcquisitionSim::set_defaults (void)
+{
+    short ch = 0;
+
+    for (ch = 0; ch < nb_channels_m; ch++)
+        apply_channel((channel_e)ch);
+}
+
+/****************************************************************************
+ * set_trigger_advanced
+ ****************************************************************************/
+void AcquisitionSim::set_trigger_advanced(void)
+{
+}
@@ -0,0 +1,150 @@
+/*****************************************************************************
+*   Copyright 2012 Vincent HERVIEUX
+*
+*   This file is part of QPicoscope.
+*
+*   QPicoscope is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU Lesser General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   any later version.
+*
+*   QPicoscope is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU Lesser General Public License for more details.
+*
+*   You should have received a copy of the GNU Lesser General Public License
+*   along with QPicoscope in files COPYING.LESSER and COPYING.
+*   If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+/**
+ * @file acquisitionsim.h
+ * @brief Declaration of AcquisitionSim class.
+ * A unit without hardware: every channel is a SignalGenerator, sampled at
+ * the interval the timebase asks for, down to 1 / QPICOSCOPE_SIM_RATE.
+ * Input ranges, trigger, block captures and streaming behave as on a
+ * 2000 series unit, so the whole pipeline runs, and can be benchmarked,
+ * on a machine with no PicoScope.
+ * The unit is opened when QPICOSCOPE_SIM is set, to "1" for the default
+ * signals or to one SignalGenerator description per channel, separated
+ * by ';', e.g. "wave=sine,freq=1e3;wave=square,freq=250,noise=0.05".
+ * QPICOSCOPE_SIM_UNITS units with these signals are opened, one by
+ * default, to drive several acquisition threads at once.
+ * @version 0.1
+ * @date 2026, october 16
+ * @author Vincent HERVIEUX    -   10.16.2026   -   initial creation
+ */
+#ifndef ACQUISITIONSIM_H
+#define ACQUISITIONSIM_H
+
+#include "oscilloscope.h"
+#include "acquisition.h"
+#include "signalgenerator.h"
+
+/* channel signals, the backend opens no unit without it */
+#define SIM_ENV_SIGNALS         "QPICOSCOPE_SIM"
+/* fastest sample rate in samples per second */
+#define SIM_ENV_RATE            "QPICOSCOPE_SIM_RATE"
+/* 1 for real time, 0 for as fast as possible */
+#define SIM_ENV_SPEED           "QPICOSCOPE_SIM_SPEED"
+/* units the backend opens */
+#define SIM_ENV_UNITS           "QPICOSCOPE_SIM_UNITS"
+#define SIM_MAX_UNITS           8
+#define SIM_DEFAULT_RATE        100E6
+#define SIM_MAX_CHANNELS        4
+/* samples per channel the simulated memory holds */
+#define SIM_MAX_SAMPLES         (32 * 1024 * 1024)
+/* records generated while looking for a trigger before giving up a block */
+#define SIM_TRIGGER_RECORDS     4
+/* time the stream is fed in at each step, in seconds */
+#define SIM_STREAM_PERIOD       0.010
+
+class AcquisitionSim : public Acquisition{
+public:
+    /**
+     * @brief open a simulated unit described by QPICOSCOPE_SIM
+     * @return NULL when the variable is not set or cannot be parsed, or
+     * when QPICOSCOPE_SIM_UNITS units are open already
+     */
+    static Acquisition* open_unit();
+    /** @brief destructor */
+    virtual ~AcquisitionSim();
+    void set_voltages (channel_e channel_index, double volts_per_division);
+    void set_timebase (double time_per_division);
+    void set_DC_coupled(current_e coupling);
+    void set_sig_gen (e_wave_type waveform, long frequency);
+    void set_sig_gen_arb (long int frequency);
+    void get_device_info(device_info_t* info);
+    /**
+     * @brief change the signal of a channel, acquisition thread stopped
+     * @param[in] : the channel index, below the number of channels
+     */
+    void set_signal (channel_e channel_index, const SignalGenerator::signal_t &signal);
+    /** @brief channels of the unit, 1 to SIM_MAX_CHANNELS, acquisition thread stopped */
+    void set_nb_channels (uint8_t nb_channels);
+    /** @brief fastest sample rate in samples per second, applied on next capture set up */
+    void set_max_rate (double max_rate);
+    /** @brief 1. paces captures in real time, 0. as fast as possible */
+    void set_speed (double speed) { speed_m = (speed > 0.) ? speed : 0.; }
+    /** @brief current time between two samples, in seconds */
+    double get_sample_interval (void) const { return sample_interval_m; }
+private:
+    /**
+     * @brief private typedef declarations
+     */
+    typedef struct {
+        short DCcoupled;
+        short range;
+        short enabled;
+    } CHANNEL_SETTINGS;
+
+    /**
+     * @brief private methods declarations
+     */
+    AcquisitionSim();
+    int adc_to_mv (long raw, int ch);
+    short mv_to_adc (short mv, short ch);
+    void get_info (void);
+    void set_defaults (void);
+    void apply_channel (channel_e channel_index);
+    void set_trigger_advanced(void);
+    void collect_block_immediate (void);
+    void collect_block_triggered (trigger_e trigger_slope, double trigger_level);
+    void collect_block_advanced_triggered (void);
+    void collect_block_ets (void);
+    void collect_streaming (void);
+    void collect_fast_streaming (void);
+    void collect_fast_streaming_triggered (void);
+    /** @brief block capture loop, E_TRIGGER_AUTO for free running */
+    void collect_blocks (trigger_e trigger_slope, double trigger_level);
+    /** @brief carve nb_samples per channel from sample_arena_m */
+    bool reserve_capture (uint32_t nb_samples);
+    /** @brief first crossing of the level on channel A, -1 if none */
+    int64_t find_trigger (const int16_t *counts, uint32_t count, trigger_e trigger_slope, int16_t level) const;
+    /**
+     * @brief wait for the simulated time of nb_samples to pass
+     * @return false when stopped, true when due or when a setting is pending
+     */
+    bool pace (uint64_t nb_samples);
+    static double now (void);
+
+    /**
+     * @brief private instances declarations
+     */
+    /** @brief units alive, open_unit() opens QPICOSCOPE_SIM_UNITS at most */
+    static uint8_t nb_units_m;
+    static const short input_ranges [] /*= {10, 20, 50, 100, 200, 500, 1000, 2000, 5000, 10000, 20000}*/;
+    SignalGenerator generators_m[SIM_MAX_CHANNELS];
+    CHANNEL_SETTINGS channels_m[SIM_MAX_CHANNELS];
+    uint8_t nb_channels_m;
+    double max_rate_m;
+    double sample_interval_m;
+    double speed_m;
+    /** @brief wall time the next samples are due at */
+    double due_m;
+    /** @brief capture_length_m counts per channel, carved from sample_arena_m */
+    int16_t *values_m[SIM_MAX_CHANNELS];
+    uint32_t capture_length_m;
+};
+
+#endif // ACQUISITIONSIM_H
@@ -0,0 +1,311 @@
+/*****************************************************************************
+*   Copyright 2012 Vincent HERVIEUX
+*
+*   This file is part of QPicoscope.
+*
+*   QPicoscope is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU Lesser General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   any later version.
+*
+*   QPicoscope is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU Lesser General Public License for more details.
+*
+*   You should have received a copy of the GNU Lesser General Public License
+*   along with QPicoscope in files COPYING.LESSER and COPYING.
+*   If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+/**
+ * @file adcconvert.cpp
+ * @brief Definition of AdcConvert class.
+ * @version 0.1
+ * @date 2026, october 16
+ * @author Vincent HERVIEUX    -   10.16.2026   -   initial creation
+ */
+
+#include <string.h>
+
+#include "adcconvert.h"
+
+/* kernels are built with target attributes, the rest of the program
+ * keeps the default instruction set and the best one is picked at runtime.
+ */
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define ADC_CONVERT_X86
+#include <immintrin.h>
+#endif
+#if defined(__aarch64__) && defined(__ARM_NEON)
+#define ADC_CONVERT_NEON
+#include <arm_neon.h>
+#endif
+
+static const char *kernel_names[AdcConvert::E_KERNEL_MAX] = { "scalar", "sse2", "avx2", "neon" };
+
+/****************************************************************************
+ * convert_scalar
+ *
+ * Computes in single precision as the SIMD kernels do, so that every
+ * kernel gives the same volts for the same count.
+ ****************************************************************************/
+static void convert_scalar(const int16_t *raw, double *volts, uint32_t count, float scale, float offset)
+{
+    uint32_t i = 0;
+
+    for (i = 0; i < count; i++)
+    {
+        volts[i] = (double)((float)raw[i] * scale + offset);
+    }
+}
+
+#ifdef ADC_CONVERT_X86
+/****************************************************************************
+ * convert_sse2
+ ****************************************************************************/
+__attribute__((target("sse2")))
+static void convert_sse2(const int16_t *raw, double *volts, uint32_t count, float scale, float offset)
+{
+    const __m128 s = _mm_set1_ps(scale);
+    const __m128 o = _mm_set1_ps(offset);
+    uint32_t i = 0;
+
+    for (i = 0; i + 8 <= count; i += 8)
+    {
+        __m128i r = _mm_loadu_si128((const __m128i*)(raw + i));
+        /* sign extend: each count in the upper half, then shift back down */
+        __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(r, r), 16);
+        __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(r, r), 16);
+        __m128 flo = _mm_add_ps(_mm_mul_ps(_mm_cvtepi32_ps(lo), s), o);
+        __m128 fhi = _mm_add_ps(_mm_mul_ps(_mm_cvtepi32_ps(hi), s), o);
+
+        _mm_storeu_pd(volts + i,     _mm_cvtps_pd(flo));
+        _mm_storeu_pd(volts + i + 2, _mm_cvtps_pd(_mm_movehl_ps(flo, flo)));
+        _mm_storeu_pd(volts + i + 4, _mm_cvtps_pd(fhi));
+        _mm_storeu_pd(volts + i + 6, _mm_cvtps_pd(_mm_movehl_ps(fhi, fhi)));
+    }
+    convert_scalar(raw + i, volts + i, count - i, scale, offset);
+}
+
+/****************************************************************************
+ * convert_avx2
+ ****************************************************************************/
+__attribute__((target("avx2")))
+static void convert_avx2(const int16_t *raw, double *volts, uint32_t count, float scale, float offset)
+{
+    const __m256 s = _mm256_set1_ps(scale);
+    const __m256 o = _mm256_set1_ps(offset);
+    uint32_t i = 0;
+
+    for (i = 0; i + 16 <= count; i += 16)
+    {
+        __m256i r = _mm256_loadu_si256((const __m256i*)(raw + i));
+        __m256i lo = _mm256_cvtepi16_epi32(_mm256_castsi256_si128(r));
+        __m256i hi = _mm256_cvtepi16_epi32(_mm256_extracti128_si256(r, 1));
+        __m256 flo = _mm256_add_ps(_mm256_mul_ps(_mm256_cvtepi32_ps(lo), s), o);
+        __m256 fhi = _mm256_add_ps(_mm256_mul_ps(_mm256_cvtepi32_ps(hi), s), o);
+
+        _mm256_storeu_pd(volts + i,      _mm256_cvtps_pd(_mm256_castps256_ps128(flo)));
+        _mm256_storeu_pd(volts + i + 4,  _mm256_cvtps_pd(_mm256_extractf128_ps(flo, 1)));
+        _mm256_storeu_pd(volts + i + 8,  _mm256_cvtps_pd(_mm256_castps256_ps128(fhi)));
+        _mm256_storeu_pd(volts + i + 12, _mm256_cvtps_pd(_mm256_extractf128_ps(fhi, 1)));
+    }
+    convert_scalar(raw + i, volts + i, count - i, scale, offset);
+}
+#endif
+
+#ifdef ADC_CONVERT_NEON
+/****************************************************************************
+ * convert_neon
+ ****************************************************************************/
+static void convert_neon(const int16_t *raw, double *volts, uint32_t count, float scale, float offset)
+{
+    const float32x4_t s = vdupq_n_f32(scale);
+    const float32x4_t o = vdupq_n_f32(offset);
+    uint32_t i = 0;
+
+    for (i = 0; i + 8 <= count; i += 8)
+    {
+        int16x8_t r = vld1q_s16(raw + i);
+        /* multiply then add, not fused, to match the other kernels */
+        float32x4_t flo = vaddq_f32(vmulq_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(r))), s), o);
+        float32x4_t fhi = vaddq_f32(vmulq_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(r))), s), o);
+
+        vst1q_f64(volts + i,     vcvt_f64_f32(vget_low_f32(flo)));
+        vst1q_f64(volts + i + 2, vcvt_high_f64_f32(flo));
+        vst1q_f64(volts + i + 4, vcvt_f64_f32(vget_low_f32(fhi)));
+        vst1q_f64(volts + i + 6, vcvt_high_f64_f32(fhi));
+    }
+    convert_scalar(raw + i, volts + i, count - i, scale, offset);
+}
+#endif
+
+/****************************************************************************
+ *
+ * constructor
+ *
+ ****************************************************************************/
+AdcConvert::AdcConvert() :
+    nb_ranges_m(0),
+    kernel_m(E_KERNEL_SCALAR),
+    convert_m(convert_scalar)
+{
+    memset(ranges_m, 0, sizeof(ranges_m));
+    set_kernel(best_kernel());
+}
+
+/****************************************************************************
+ * set_ranges
+ ****************************************************************************/
+void AdcConvert::set_ranges(const short *ranges_mv, uint8_t nb_ranges, short max_adc, bool scale_to_mv)
+{
+    uint8_t i = 0;
+
+    if (nb_ranges > ADC_CONVERT_MAX_RANGES)
+    {
+        ERROR("%d ranges, only %d are kept\n", nb_ranges, ADC_CONVERT_MAX_RANGES);
+        nb_ranges = ADC_CONVERT_MAX_RANGES;
+    }
+    if (max_adc <= 0)
+    {
+        ERROR("invalid full scale count %d\n", max_adc);
+        nb_ranges = 0;
+    }
+    for (i = 0; i < nb_ranges; i++)
+    {
+        /* same as 0.001 * adc_to_mv() without the truncation to a whole mV */
+        ranges_m[i].scale = scale_to_mv ? (float)(ranges_mv[i] / (1000. * max_adc)) : 0.001f;
+        ranges_m[i].offset = 0.f;
+    }
+    nb_ranges_m = nb_ranges;
+}
+
+/****************************************************************************
+ * to_volts
+ ****************************************************************************/
+void AdcConvert::to_volts(const int16_t *raw, double *volts, uint32_t count, short range) const
+{
+    if ((range < 0) || (range >= nb_ranges_m))
+    {
+        ERROR("range %d out of table (%d ranges)\n", range, nb_ranges_m);
+        memset(volts, 0, count * sizeof(double));
+        return;
+    }
+    convert_m(raw, volts, count, ranges_m[range].scale, ranges_m[range].offset);
+}
+
+/****************************************************************************
+ * to_volts
+ ****************************************************************************/
+double AdcConvert::to_volts(int16_t raw, short range) const
+{
+    double volts = 0.;
+
+    to_volts(&raw, &volts, 1, range);
+    return volts;
+}
+
+/****************************************************************************
+ * get_range
+ ****************************************************************************/
+AdcConvert::range_t AdcConvert::get_range(short range) const
+{
+    range_t none = { 0.f, 0.f };
+
+    if ((range < 0) || (range >= nb_ranges_m))
+    {
+        ERROR("range %d out of table (%d ranges)\n", range, nb_ranges_m);
+        return none;
+    }
+    return ranges_m[range];
+}
+
+/****************************************************************************
+ * kernel_function
+ ****************************************************************************/
+AdcConvert::kernel_fn_t AdcConvert::kernel_function(kernel_e kernel)
+{
+    switch (kernel)
+    {
+#ifdef ADC_CONVERT_X86
+    case E_KERNEL_SSE2:
+        return convert_sse2;
+    case E_KERNEL_AVX2:
+        return convert_avx2;
+#endif
+#ifdef ADC_CONVERT_NEON
+    case E_KERNEL_NEON:
+        return convert_neon;
+#endif
+    case E_KERNEL_SCALAR:
+        return convert_scalar;
+    default:
+        return NULL;
+    }
+}
+
+/****************************************************************************
+ * is_supported
+ ****************************************************************************/
+bool AdcConvert::is_supported(kernel_e kernel)
+{
+    switch (kernel)
+    {
+    case E_KERNEL_SCALAR:
+        return true;
+#ifdef ADC_CONVERT_X86
+    case E_KERNEL_SSE2:
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("sse2");
+    case E_KERNEL_AVX2:
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx2");
+#endif
+#ifdef ADC_CONVERT_NEON
+    case E_KERNEL_NEON:
+        /* mandatory on aarch64 */
+        return true;
+#endif
+    default:
+        return false;
+    }
+}
+
+/****************************************************************************
+ * best_kernel
+ ****************************************************************************/
+AdcConvert::kernel_e AdcConvert::best_kernel(void)
+{
+    if (is_supported(E_KERNEL_AVX2))
+        return E_KERNEL_AVX2;
+    if (is_supported(E_KERNEL_NEON))
+        return E_KERNEL_NEON;
+    if (is_supported(E_KERNEL_SSE2))
+        return E_KERNEL_SSE2;
+    return E_KERNEL_SCALAR;
+}
+
+/****************************************************************************
+ * set_kernel
+ ****************************************************************************/
+bool AdcConvert::set_kernel(kernel_e kernel)
+{
+    if (!is_supported(kernel))
+    {
+        WARNING("%s kernel not supported, keeping %s\n", kernel_name(kernel), kernel_name(kernel_m));
+        return false;
+    }
+    kernel_m = kernel;
+    convert_m = kernel_function(kernel);
+    return true;
+}
+
+/****************************************************************************
+ * kernel_name
+ ****************************************************************************/
+const char* AdcConvert::kernel_name(kernel_e kernel)
+{
+    if ((kernel < E_KERNEL_SCALAR) || (kernel >= E_KERNEL_MAX))
+        return "unknown";
+    return kernel_names[kernel];
+}
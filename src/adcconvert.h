@@ -0,0 +1,106 @@
+/*****************************************************************************
+*   Copyright 2012 Vincent HERVIEUX
+*
+*   This file is part of QPicoscope.
+*
+*   QPicoscope is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU Lesser General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   any later version.
+*
+*   QPicoscope is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU Lesser General Public License for more details.
+*
+*   You should have received a copy of the GNU Lesser General Public License
+*   along with QPicoscope in files COPYING.LESSER and COPYING.
+*   If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+/**
+ * @file adcconvert.h
+ * @brief Declaration of AdcConvert class.
+ * Converts blocks of ADC counts into volts. The scale of every input range
+ * is computed once, then a block is converted with the widest SIMD kernel
+ * the CPU supports (AVX2 or SSE2 on x86, NEON on aarch64), or a scalar loop.
+ * @version 0.1
+ * @date 2026, october 16
+ * @author Vincent HERVIEUX    -   10.16.2026   -   initial creation
+ */
+
+#ifndef ADCCONVERT_H
+#define ADCCONVERT_H
+
+#include <stdint.h>
+
+#include "oscilloscope.h"
+
+/* more than any series has input ranges */
+#define ADC_CONVERT_MAX_RANGES    16
+
+class AdcConvert
+{
+public:
+    /**
+     * @brief public typedef declarations
+     */
+    typedef enum
+    {
+        E_KERNEL_SCALAR = 0,
+        E_KERNEL_SSE2,
+        E_KERNEL_AVX2,
+        E_KERNEL_NEON,
+        E_KERNEL_MAX
+    } kernel_e;
+
+    /** @brief volts = count * scale + offset */
+    typedef struct
+    {
+        float scale;
+        float offset;
+    } range_t;
+
+    /** @brief constructor, selects the best kernel for this CPU */
+    AdcConvert();
+    /**
+     * @brief build the per range table from a backend input_ranges[]
+     * @param[in] ranges_mv: full scale of each range in mV
+     * @param[in] nb_ranges: number of entries in ranges_mv
+     * @param[in] max_adc: ADC count at full scale
+     * @param[in] scale_to_mv: false to pass counts through, as adc_to_mv() does
+     */
+    void set_ranges(const short *ranges_mv, uint8_t nb_ranges, short max_adc, bool scale_to_mv = true);
+    /**
+     * @brief convert a block of ADC counts
+     * @param[in] raw: ADC counts
+     * @param[out] volts: count values, may not overlap raw
+     * @param[in] count: number of samples
+     * @param[in] range: index in the input ranges table
+     */
+    void to_volts(const int16_t *raw, double *volts, uint32_t count, short range) const;
+    /** @brief volts of a single count, for thresholds and cursors */
+    double to_volts(int16_t raw, short range) const;
+    /**
+     * @brief scale and offset of a range, for consumers converting later
+     * @return a null scale when range is not in the table
+     */
+    range_t get_range(short range) const;
+    /** @brief force a kernel, false if this CPU cannot run it */
+    bool set_kernel(kernel_e kernel);
+    kernel_e get_kernel(void) const { return kernel_m; }
+    /** @brief widest kernel this CPU can run */
+    static kernel_e best_kernel(void);
+    static bool is_supported(kernel_e kernel);
+    static const char* kernel_name(kernel_e kernel);
+
+private:
+    typedef void (*kernel_fn_t)(const int16_t *raw, double *volts, uint32_t count, float scale, float offset);
+    static kernel_fn_t kernel_function(kernel_e kernel);
+
+    range_t ranges_m[ADC_CONVERT_MAX_RANGES];
+    uint8_t nb_ranges_m;
+    kernel_e kernel_m;
+    kernel_fn_t convert_m;
+};
+
+#endif // ADCCONVERT_H
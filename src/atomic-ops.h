@@ -0,0 +1,48 @@
+/*****************************************************************************
+*   Copyright 2012 Vincent HERVIEUX
+*
+*   This file is part of QPicoscope.
+*
+*   QPicoscope is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU Lesser General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   any later version.
+*
+*   QPicoscope is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU Lesser General Public License for more details.
+*
+*   You should have received a copy of the GNU Lesser General Public License
+*   along with QPicoscope in files COPYING.LESSER and COPYING.
+*   If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+/**
+ * @file atomic-ops.h
+ * @brief Small set of atomic helpers shared by the lock-free structures.
+ * They map on the GCC __atomic builtins so we do not depend on C++11.
+ * @version 0.1
+ * @date 2026, october 16
+ * @author Vincent HERVIEUX    -   10.16.2026   -   initial creation
+ */
+
+#ifndef ATOMIC_OPS_H
+#define ATOMIC_OPS_H
+
+/** @brief load a value published by another thread */
+#define ATOMIC_LOAD_ACQUIRE(ptr)          __atomic_load_n((ptr), __ATOMIC_ACQUIRE)
+/** @brief publish a value to another thread */
+#define ATOMIC_STORE_RELEASE(ptr, val)    __atomic_store_n((ptr), (val), __ATOMIC_RELEASE)
+/** @brief load a counter, no ordering needed */
+#define ATOMIC_LOAD_RELAXED(ptr)          __atomic_load_n((ptr), __ATOMIC_RELAXED)
+/** @brief store a counter, no ordering needed */
+#define ATOMIC_STORE_RELAXED(ptr, val)    __atomic_store_n((ptr), (val), __ATOMIC_RELAXED)
+/** @brief increment a counter shared by several writers, returns the previous value */
+#define ATOMIC_FETCH_ADD(ptr, val)        __atomic_fetch_add((ptr), (val), __ATOMIC_RELAXED)
+/** @brief set a flag and return its previous value */
+#define ATOMIC_EXCHANGE(ptr, val)         __atomic_exchange_n((ptr), (val), __ATOMIC_ACQ_REL)
+
+/** @brief avoid false sharing between producer and consumer indexes */
+#define CACHE_LINE_SIZE 64
+
+#endif // ATOMIC_OPS_H
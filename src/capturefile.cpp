@@ -0,0 +1,291 @@
+/*****************************************************************************
+*   Copyright 2012 Vincent HERVIEUX
+*
+*   This file is part of QPicoscope.
+*
+*   QPicoscope is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU Lesser General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   any later version.
+*
+*   QPicoscope is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU Lesser General Public License for more details.
+*
+*   You should have received a copy of the GNU Lesser General Public License
+*   along with QPicoscope in files COPYING.LESSER and COPYING.
+*   If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+/**
+ * @file capturefile.cpp
+ * @brief Definition of CaptureFile class.
+ * @version 0.1
+ * @date 2026, october 16
+ * @author Vincent HERVIEUX    -   10.16.2026   -   initial creation
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "capturefile.h"
+
+#ifndef O_LARGEFILE
+#define O_LARGEFILE 0
+#endif
+
+/****************************************************************************
+ *
+ * constructor
+ *
+ ****************************************************************************/
+CaptureFile::CaptureFile() :
+    fd_m(-1),
+    nb_samples_m(0),
+    map_m(NULL),
+    map_size_m(0)
+{
+}
+
+/****************************************************************************
+ *
+ * destructor
+ *
+ ****************************************************************************/
+CaptureFile::~CaptureFile()
+{
+    close();
+}
+
+/****************************************************************************
+ * open
+ ****************************************************************************/
+bool CaptureFile::open(const char *path)
+{
+    capture_header_t header;
+    struct stat status;
+    uint64_t i = 0;
+
+    close();
+    if (NULL == path)
+        return false;
+    fd_m = ::open(path, O_RDONLY | O_LARGEFILE);
+    if (fd_m < 0)
+    {
+        ERROR("cannot open %s (%s)\n", path, strerror(errno));
+        return false;
+    }
+    if ((0 != fstat(fd_m, &status)) ||
+        ((ssize_t)sizeof(header) != pread(fd_m, &header, sizeof(header), 0)) ||
+        (CAPTURE_HEADER_MAGIC != header.magic) || (CAPTURE_VERSION != header.version))
+    {
+        ERROR("%s is not a capture file\n", path);
+        close();
+        return false;
+    }
+    if (!load_index(status.st_size))
+    {
+        WARNING("%s was not closed, rebuilding its index\n", path);
+        if (!rebuild_index(status.st_size))
+        {
+            close();
+            return false;
+        }
+    }
+    if (index_m.empty())
+    {
+        ERROR("%s holds no chunk\n", path);
+        close();
+        return false;
+    }
+    nb_samples_m = 0;
+    for (i = 0; i < index_m.size(); i++)
+        nb_samples_m += index_m[i].nb_samples;
+    DEBUG("%s: %lu chunks, %llu samples\n", path, (unsigned long)index_m.size(), (unsigned long long)nb_samples_m);
+    return true;
+}
+
+/****************************************************************************
+ * close
+ ****************************************************************************/
+void CaptureFile::close(void)
+{
+    unmap();
+    if (fd_m >= 0)
+        ::close(fd_m);
+    fd_m = -1;
+    index_m.clear();
+    nb_samples_m = 0;
+}
+
+/****************************************************************************
+ * load_index
+ ****************************************************************************/
+bool CaptureFile::load_index(uint64_t file_size)
+{
+    capture_trailer_t trailer;
+    size_t size = 0;
+
+    if ((file_size < CAPTURE_ALIGNMENT + sizeof(trailer)) ||
+        ((ssize_t)sizeof(trailer) != pread(fd_m, &trailer, sizeof(trailer), file_size - sizeof(trailer))) ||
+        (CAPTURE_TRAILER_MAGIC != trailer.magic) ||
+        (trailer.index_offset + trailer.nb_chunks * sizeof(capture_index_t) > file_size - sizeof(trailer)))
+        return false;
+
+    index_m.resize(trailer.nb_chunks);
+    size = index_m.size() * sizeof(capture_index_t);
+    if ((0 != size) && ((ssize_t)size != pread(fd_m, &index_m[0], size, trailer.index_offset)))
+    {
+        index_m.clear();
+        return false;
+    }
+    return true;
+}
+
+/****************************************************************************
+ * rebuild_index
+ *  Chunks follow each other from the header on, the first bytes that are
+ *  not a complete chunk end the recording.
+ ****************************************************************************/
+bool CaptureFile::rebuild_index(uint64_t file_size)
+{
+    capture_chunk_t chunk;
+    capture_index_t entry;
+    uint64_t offset = CAPTURE_ALIGNMENT;
+    uint64_t size = 0;
+
+    index_m.clear();
+    while (offset + sizeof(chunk) <= file_size)
+    {
+        if (((ssize_t)sizeof(chunk) != pread(fd_m, &chunk, sizeof(chunk), offset)) ||
+            (CAPTURE_CHUNK_MAGIC != chunk.magic) || (sizeof(chunk) != chunk.header_size))
+            break;
+        size = capture_chunk_size(&chunk);
+        if (offset + size > file_size)
+            break;
+        entry.offset = offset;
+        entry.start_sample = chunk.start_sample;
+        entry.nb_samples = chunk.nb_samples;
+        entry.stream = chunk.stream;
+        index_m.push_back(entry);
+        offset += size;
+    }
+    return true;
+}
+
+/****************************************************************************
+ * find_chunk
+ *  Chunks of a stream have the same length but the last one, so the chunk
+ *  is guessed at once. The guess is off only after lost chunks, a binary
+ *  search finishes the job then.
+ ****************************************************************************/
+uint64_t CaptureFile::find_chunk(uint32_t stream, uint64_t sample) const
+{
+    uint64_t first = 0;
+    uint64_t last = index_m.size();
+    uint64_t middle = 0;
+    uint64_t guess = 0;
+
+    /* chunks are in stream then sample order */
+    while (first < last)
+    {
+        middle = first + (last - first) / 2;
+        if (index_m[middle].stream < stream)
+            first = middle + 1;
+        else
+            last = middle;
+    }
+    if ((first >= index_m.size()) || (index_m[first].stream != stream))
+        return first;
+
+    if (index_m[first].nb_samples > 0)
+    {
+        guess = first + (sample - index_m[first].start_sample) / index_m[first].nb_samples;
+        if ((sample >= index_m[first].start_sample) && (guess < index_m.size()) &&
+            (index_m[guess].stream == stream) && (index_m[guess].start_sample <= sample) &&
+            (sample < index_m[guess].start_sample + index_m[guess].nb_samples))
+            return guess;
+    }
+
+    /* first chunk of the stream ending after the sample */
+    last = index_m.size();
+    while (first < last)
+    {
+        middle = first + (last - first) / 2;
+        if ((index_m[middle].stream == stream) &&
+            (index_m[middle].start_sample + index_m[middle].nb_samples <= sample))
+            first = middle + 1;
+        else
+            last = middle;
+    }
+    return first;
+}
+
+/****************************************************************************
+ * map_chunk
+ ****************************************************************************/
+bool CaptureFile::map_chunk(uint64_t chunk, chunk_view_t *view)
+{
+    const capture_chunk_t *header = NULL;
+    const uint8_t *table = NULL;
+    uint64_t size = 0;
+    uint8_t ch = 0;
+
+    if ((NULL == view) || (chunk >= index_m.size()))
+        return false;
+    unmap();
+
+    /* the header first, it gives the size of the chunk */
+    size = sizeof(capture_chunk_t) + CAPTURE_MAX_CHANNELS * capture_table_size(index_m[chunk].nb_samples);
+    size = (size + CAPTURE_ALIGNMENT - 1) & ~(uint64_t)(CAPTURE_ALIGNMENT - 1);
+    map_m = mmap(NULL, size, PROT_READ, MAP_SHARED, fd_m, (off_t)index_m[chunk].offset);
+    if (MAP_FAILED == map_m)
+    {
+        ERROR("cannot map chunk %llu (%s)\n", (unsigned long long)chunk, strerror(errno));
+        map_m = NULL;
+        return false;
+    }
+    map_size_m = size;
+    header = (const capture_chunk_t*)map_m;
+    /* the tables are found after header_size bytes, it must be this header */
+    if ((CAPTURE_CHUNK_MAGIC != header->magic) || (sizeof(capture_chunk_t) != header->header_size) ||
+        (header->nb_samples != index_m[chunk].nb_samples) || (capture_chunk_size(header) > size))
+    {
+        ERROR("chunk %llu is corrupted\n", (unsigned long long)chunk);
+        unmap();
+        return false;
+    }
+    /* read once from start to end, the kernel can read ahead */
+    madvise(map_m, capture_chunk_size(header), MADV_SEQUENTIAL);
+    madvise(map_m, capture_chunk_size(header), MADV_WILLNEED);
+    if (chunk + 1 < index_m.size())
+        posix_fadvise(fd_m, (off_t)index_m[chunk + 1].offset, (off_t)capture_chunk_size(header), POSIX_FADV_WILLNEED);
+
+    memset(view, 0, sizeof(chunk_view_t));
+    view->header = header;
+    table = (const uint8_t*)map_m + header->header_size;
+    for (ch = 0; ch < CAPTURE_MAX_CHANNELS; ch++)
+    {
+        if (header->channel_mask & (1 << ch))
+        {
+            view->tables[ch] = (const int16_t*)table;
+            table += capture_table_size(header->nb_samples);
+        }
+    }
+    return true;
+}
+
+/****************************************************************************
+ * unmap
+ ****************************************************************************/
+void CaptureFile::unmap(void)
+{
+    if (NULL != map_m)
+        munmap(map_m, map_size_m);
+    map_m = NULL;
+    map_size_m = 0;
+}
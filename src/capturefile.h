@@ -0,0 +1,100 @@
+/*****************************************************************************
+*   Copyright 2012 Vincent HERVIEUX
+*
+*   This file is part of QPicoscope.
+*
+*   QPicoscope is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU Lesser General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   any later version.
+*
+*   QPicoscope is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU Lesser General Public License for more details.
+*
+*   You should have received a copy of the GNU Lesser General Public License
+*   along with QPicoscope in files COPYING.LESSER and COPYING.
+*   If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+/**
+ * @file capturefile.h
+ * @brief Declaration of CaptureFile class.
+ * Read side of the capture files written by CaptureRecorder. Chunks are
+ * memory mapped one at a time, right from their page aligned offset, so
+ * a recording of any size is read with the memory of a single chunk and
+ * any chunk is reached in O(1) through the index. Files the recorder
+ * could not close have their index rebuilt from the chunk headers.
+ * @version 0.1
+ * @date 2026, october 16
+ * @author Vincent HERVIEUX    -   10.16.2026   -   initial creation
+ */
+
+#ifndef CAPTUREFILE_H
+#define CAPTUREFILE_H
+
+#include <stddef.h>
+#include <vector>
+
+#include "oscilloscope.h"
+#include "captureformat.h"
+
+class CaptureFile
+{
+public:
+    /**
+     * @brief public typedef declarations
+     */
+    typedef struct
+    {
+        const capture_chunk_t *header;
+        /** @brief nb_samples counts per channel, NULL for channels not recorded */
+        const int16_t *tables[CAPTURE_MAX_CHANNELS];
+    } chunk_view_t;
+
+    /** @brief constructor */
+    CaptureFile();
+    /** @brief destructor, closes the file */
+    ~CaptureFile();
+
+    /**
+     * @brief open a recording and load its index
+     * @return false if the file is not a capture file or holds no chunk
+     */
+    bool open(const char *path);
+    void close(void);
+    bool is_open(void) const { return fd_m >= 0; }
+
+    uint64_t get_nb_chunks(void) const { return index_m.size(); }
+    /** @brief samples per channel in every chunk */
+    uint64_t get_nb_samples(void) const { return nb_samples_m; }
+    /** @brief index entry of a chunk, chunk < get_nb_chunks() */
+    const capture_index_t& get_index(uint64_t chunk) const { return index_m[chunk]; }
+    /**
+     * @brief chunk holding a sample of a stream
+     * @return the first chunk after the sample when it was lost,
+     * get_nb_chunks() when the stream ended before it
+     */
+    uint64_t find_chunk(uint32_t stream, uint64_t sample) const;
+    /**
+     * @brief map a chunk, the previous one is unmapped
+     * @param[out] view: valid until the next map_chunk() or close()
+     * @return false on an I/O error or a corrupted chunk
+     */
+    bool map_chunk(uint64_t chunk, chunk_view_t *view);
+
+private:
+    CaptureFile(const CaptureFile&);
+    CaptureFile& operator=(const CaptureFile&);
+    bool load_index(uint64_t file_size);
+    bool rebuild_index(uint64_t file_size);
+    void unmap(void);
+
+    int fd_m;
+    std::vector<capture_index_t> index_m;
+    uint64_t nb_samples_m;
+    void *map_m;
+    size_t map_size_m;
+};
+
+#endif // CAPTUREFILE_H
@@ -0,0 +1,133 @@
+/*****************************************************************************
+*   Copyright 2012 Vincent HERVIEUX
+*
+*   This file is part of QPicoscope.
+*
+*   QPicoscope is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU Lesser General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   any later version.
+*
+*   QPicoscope is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU Lesser General Public License for more details.
+*
+*   You should have received a copy of the GNU Lesser General Public License
+*   along with QPicoscope in files COPYING.LESSER and COPYING.
+*   If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+/**
+ * @file captureformat.h
+ * @brief Layout of the capture files written by CaptureRecorder.
+ * A file is a header block, then chunks, then a footer:
+ *  - capture_header_t, padded to CAPTURE_ALIGNMENT bytes;
+ *  - chunks, each a capture_chunk_t followed by one table of nb_samples
+ *    ADC counts per channel set in channel_mask, in channel order, every
+ *    table padded to CAPTURE_TABLE_ALIGNMENT bytes and the whole chunk to
+ *    CAPTURE_ALIGNMENT bytes;
+ *  - nb_chunks capture_index_t, padded so that capture_trailer_t ends the
+ *    file on a CAPTURE_ALIGNMENT boundary.
+ * A reader finds the index from the trailer, the last bytes of the file.
+ * When the recorder did not close the file, the chunks can still be walked
+ * from the header since their size follows from their own header.
+ * Every field is in the byte order of the host, little endian on every
+ * supported target.
+ * @version 0.1
+ * @date 2026, october 16
+ * @author Vincent HERVIEUX    -   10.16.2026   -   initial creation
+ */
+
+#ifndef CAPTUREFORMAT_H
+#define CAPTUREFORMAT_H
+
+#include "oscilloscope.h"
+
+/* disk writes and memory maps are made of whole pages */
+#define CAPTURE_ALIGNMENT           4096
+/* every channel table starts on a cache line */
+#define CAPTURE_TABLE_ALIGNMENT     64
+#define CAPTURE_MAX_CHANNELS        4
+#define CAPTURE_VERSION             1
+
+#define CAPTURE_HEADER_MAGIC        0x3130305041435051ULL   /* "QPCAP001" */
+#define CAPTURE_CHUNK_MAGIC         0x4b435051U             /* "QPCK" */
+#define CAPTURE_TRAILER_MAGIC       0x444e455041435051ULL   /* "QPCAPEND" */
+
+typedef struct
+{
+    uint64_t magic;
+    uint32_t version;
+    /** @brief bytes before the first chunk */
+    uint32_t header_size;
+    /** @brief seconds since the epoch when the file was opened */
+    uint64_t created;
+    uint64_t reserved[5];
+} capture_header_t;
+
+typedef struct
+{
+    uint32_t magic;
+    uint16_t header_size;
+    /** @brief channels of the stream */
+    uint8_t  nb_channels;
+    /** @brief bit n set when channel n has a table in the chunk */
+    uint8_t  channel_mask;
+    /** @brief samples per channel */
+    uint32_t nb_samples;
+    /** @brief incremented each time the stream starts again, with a new format maybe */
+    uint32_t stream;
+    /** @brief index of the first sample in the stream, lost samples counted */
+    uint64_t start_sample;
+    /** @brief time between two samples in seconds */
+    double   sample_interval;
+    /** @brief volts = count * scale + offset, per channel */
+    float    scale[CAPTURE_MAX_CHANNELS];
+    float    offset[CAPTURE_MAX_CHANNELS];
+} capture_chunk_t;
+
+typedef struct
+{
+    /** @brief chunk position from the start of the file */
+    uint64_t offset;
+    uint64_t start_sample;
+    uint32_t nb_samples;
+    uint32_t stream;
+} capture_index_t;
+
+typedef struct
+{
+    uint64_t magic;
+    /** @brief position of the first capture_index_t */
+    uint64_t index_offset;
+    uint64_t nb_chunks;
+    /** @brief samples per channel stored in the chunks */
+    uint64_t nb_samples;
+    /** @brief samples the stream lost before they reached the recorder */
+    uint64_t samples_dropped;
+    /** @brief samples the recorder lost, no buffer was free for them */
+    uint64_t samples_lost;
+    uint64_t reserved[2];
+} capture_trailer_t;
+
+/** @brief bytes of a channel table of nb_samples counts */
+static inline uint64_t capture_table_size(uint32_t nb_samples)
+{
+    return ((uint64_t)nb_samples * sizeof(int16_t) + CAPTURE_TABLE_ALIGNMENT - 1) & ~(uint64_t)(CAPTURE_TABLE_ALIGNMENT - 1);
+}
+
+/** @brief bytes of a whole chunk, header and padding included */
+static inline uint64_t capture_chunk_size(const capture_chunk_t *chunk)
+{
+    uint64_t size = chunk->header_size;
+    uint8_t ch = 0;
+
+    for (ch = 0; ch < CAPTURE_MAX_CHANNELS; ch++)
+    {
+        if (chunk->channel_mask & (1 << ch))
+            size += capture_table_size(chunk->nb_samples);
+    }
+    return (size + CAPTURE_ALIGNMENT - 1) & ~(uint64_t)(CAPTURE_ALIGNMENT - 1);
+}
+
+#endif // CAPTUREFORMAT_H
@@ -0,0 +1,513 @@
+/*****************************************************************************
+*   Copyright 2012 Vincent HERVIEUX
+*
+*   This file is part of QPicoscope.
+*
+*   QPicoscope is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU Lesser General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   any later version.
+*
+*   QPicoscope is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU Lesser General Public License for more details.
+*
+*   You should have received a copy of the GNU Lesser General Public License
+*   along with QPicoscope in files COPYING.LESSER and COPYING.
+*   If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+/**
+ * @file capturerecorder.cpp
+ * @brief Definition of CaptureRecorder class.
+ * @version 0.1
+ * @date 2026, october 16
+ * @author Vincent HERVIEUX    -   10.16.2026   -   initial creation
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "capturerecorder.h"
+#include "atomic-ops.h"
+
+#ifndef O_LARGEFILE
+#define O_LARGEFILE 0
+#endif
+
+/****************************************************************************
+ * now_ns
+ ****************************************************************************/
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/****************************************************************************
+ *
+ * constructor
+ *
+ ****************************************************************************/
+CaptureRecorder::CaptureRecorder() :
+    fd_m(-1),
+    thread_id_m(0),
+    closing_m(false),
+    nb_streams_m(0),
+    chunk_samples_m(0),
+    chunk_m(NULL),
+    fill_m(0),
+    chunk_start_m(0),
+    skip_m(0),
+    sample_m(0),
+    offset_m(0),
+    samples_written_m(0),
+    chunks_written_m(0),
+    bytes_written_m(0),
+    chunks_dropped_m(0),
+    samples_lost_m(0),
+    samples_dropped_m(0),
+    queue_high_water_m(0),
+    write_errors_m(0),
+    write_time_ns_m(0)
+{
+    memset(&format_m, 0, sizeof(format_m));
+    pthread_mutex_init(&lock_m, NULL);
+    pthread_cond_init(&cond_m, NULL);
+}
+
+/****************************************************************************
+ *
+ * destructor
+ *
+ ****************************************************************************/
+CaptureRecorder::~CaptureRecorder()
+{
+    close();
+    pthread_cond_destroy(&cond_m);
+    pthread_mutex_destroy(&lock_m);
+}
+
+/****************************************************************************
+ * open
+ ****************************************************************************/
+bool CaptureRecorder::open(const char *path, uint32_t chunk_samples, uint32_t nb_buffers)
+{
+    capture_header_t *header = NULL;
+    void *buffer = NULL;
+    size_t buffer_size = 0;
+    uint32_t i = 0;
+    int ret = 0;
+
+    if (is_open())
+        close();
+    if ((NULL == path) || (0 == chunk_samples) || (0 == nb_buffers))
+        return false;
+
+    /* a chunk buffer holds the largest chunk, every channel enabled */
+    buffer_size = sizeof(capture_chunk_t) + CAPTURE_MAX_CHANNELS * capture_table_size(chunk_samples);
+    buffer_size = (buffer_size + CAPTURE_ALIGNMENT - 1) & ~(size_t)(CAPTURE_ALIGNMENT - 1);
+    for (i = 0; i < nb_buffers; i++)
+    {
+        ret = posix_memalign(&buffer, CAPTURE_ALIGNMENT, buffer_size);
+        if (0 != ret)
+        {
+            ERROR("cannot allocate %u chunk buffers of %lu bytes (%d)\n", nb_buffers, (unsigned long)buffer_size, ret);
+            goto error;
+        }
+        memset(buffer, 0, buffer_size);
+        buffers_m.push_back((uint8_t*)buffer);
+        free_m.push_back((uint8_t*)buffer);
+    }
+
+    fd_m = ::open(path, O_WRONLY | O_CREAT | O_TRUNC | O_LARGEFILE, 0644);
+    if (fd_m < 0)
+    {
+        ERROR("cannot create %s (%s)\n", path, strerror(errno));
+        goto error;
+    }
+    /* the header block is written from the first chunk buffer, still unused */
+    header = (capture_header_t*)buffers_m[0];
+    header->magic = CAPTURE_HEADER_MAGIC;
+    header->version = CAPTURE_VERSION;
+    header->header_size = CAPTURE_ALIGNMENT;
+    header->created = (uint64_t)time(NULL);
+    if (!write_all(header, CAPTURE_ALIGNMENT))
+        goto error;
+    memset(header, 0, sizeof(capture_header_t));
+
+    chunk_samples_m = chunk_samples;
+    offset_m = CAPTURE_ALIGNMENT;
+    index_m.clear();
+    nb_streams_m = 0;
+    chunk_m = NULL;
+    fill_m = 0;
+    skip_m = 0;
+    sample_m = 0;
+    closing_m = false;
+    samples_written_m = 0;
+    chunks_written_m = 0;
+    bytes_written_m = CAPTURE_ALIGNMENT;
+    chunks_dropped_m = 0;
+    samples_lost_m = 0;
+    samples_dropped_m = 0;
+    queue_high_water_m = 0;
+    write_errors_m = 0;
+    write_time_ns_m = 0;
+
+    ret = pthread_create(&thread_id_m, NULL, CaptureRecorder::thread_write, this);
+    if (0 != ret)
+    {
+        ERROR("pthread_create failed and returned %d\n", ret);
+        thread_id_m = 0;
+        goto error;
+    }
+    DEBUG("recording in %s, chunks of %u samples\n", path, chunk_samples);
+    return true;
+
+error:
+    if (fd_m >= 0)
+        ::close(fd_m);
+    fd_m = -1;
+    for (i = 0; i < buffers_m.size(); i++)
+        free(buffers_m[i]);
+    buffers_m.clear();
+    free_m.clear();
+    return false;
+}
+
+/****************************************************************************
+ * close
+ *  The footer is the index then the trailer, padded so that the trailer
+ *  ends the file on a page.
+ ****************************************************************************/
+void CaptureRecorder::close(void)
+{
+    std::vector<uint8_t> footer;
+    capture_trailer_t trailer;
+    size_t index_size = 0;
+    size_t footer_size = 0;
+    uint32_t i = 0;
+
+    if (!is_open())
+        return;
+
+    /* what a stream stopped without stream_stop() left behind */
+    if ((NULL != chunk_m) && (0 != fill_m))
+        submit();
+    pthread_mutex_lock(&lock_m);
+    closing_m = true;
+    pthread_cond_broadcast(&cond_m);
+    pthread_mutex_unlock(&lock_m);
+    pthread_join(thread_id_m, NULL);
+    thread_id_m = 0;
+
+    index_size = index_m.size() * sizeof(capture_index_t);
+    footer_size = (index_size + sizeof(capture_trailer_t) + CAPTURE_ALIGNMENT - 1) & ~(size_t)(CAPTURE_ALIGNMENT - 1);
+    footer.resize(footer_size, 0);
+    if (0 != index_size)
+        memcpy(&footer[0], &index_m[0], index_size);
+    memset(&trailer, 0, sizeof(trailer));
+    trailer.magic = CAPTURE_TRAILER_MAGIC;
+    trailer.index_offset = offset_m;
+    trailer.nb_chunks = index_m.size();
+    trailer.nb_samples = ATOMIC_LOAD_RELAXED(&samples_written_m);
+    trailer.samples_dropped = ATOMIC_LOAD_RELAXED(&samples_dropped_m);
+    trailer.samples_lost = ATOMIC_LOAD_RELAXED(&samples_lost_m);
+    memcpy(&footer[footer_size - sizeof(trailer)], &trailer, sizeof(trailer));
+    if (!write_all(&footer[0], footer_size))
+        ERROR("index not written, chunks are still readable from the header\n");
+    ::close(fd_m);
+    fd_m = -1;
+    DEBUG("%lu chunks recorded, %lu dropped\n", (unsigned long)index_m.size(),
+          (unsigned long)ATOMIC_LOAD_RELAXED(&chunks_dropped_m));
+
+    for (i = 0; i < buffers_m.size(); i++)
+        free(buffers_m[i]);
+    buffers_m.clear();
+    free_m.clear();
+    full_m.clear();
+    index_m.clear();
+    chunk_m = NULL;
+}
+
+/****************************************************************************
+ * get_stats
+ ****************************************************************************/
+void CaptureRecorder::get_stats(stats_t *stats) const
+{
+    if (NULL == stats)
+        return;
+    stats->samples_written = ATOMIC_LOAD_RELAXED(&samples_written_m);
+    stats->chunks_written = ATOMIC_LOAD_RELAXED(&chunks_written_m);
+    stats->bytes_written = ATOMIC_LOAD_RELAXED(&bytes_written_m);
+    stats->chunks_dropped = ATOMIC_LOAD_RELAXED(&chunks_dropped_m);
+    stats->samples_lost = ATOMIC_LOAD_RELAXED(&samples_lost_m);
+    stats->samples_dropped = ATOMIC_LOAD_RELAXED(&samples_dropped_m);
+    stats->queue_high_water = ATOMIC_LOAD_RELAXED(&queue_high_water_m);
+    stats->write_errors = ATOMIC_LOAD_RELAXED(&write_errors_m);
+    stats->write_time = ATOMIC_LOAD_RELAXED(&write_time_ns_m) * 1E-9;
+}
+
+/****************************************************************************
+ * stream_start
+ ****************************************************************************/
+void CaptureRecorder::stream_start(const stream_format_t &format)
+{
+    format_m = format;
+    if (format_m.nb_channels > CAPTURE_MAX_CHANNELS)
+        format_m.nb_channels = CAPTURE_MAX_CHANNELS;
+    format_m.channel_mask &= (uint8_t)((1 << format_m.nb_channels) - 1);
+    nb_streams_m++;
+    sample_m = 0;
+    skip_m = 0;
+}
+
+/****************************************************************************
+ * stream_data
+ ****************************************************************************/
+void CaptureRecorder::stream_data(const int16_t *const *channels, uint32_t count, uint64_t dropped)
+{
+    uint64_t table_size = capture_table_size(chunk_samples_m);
+    uint8_t *table = NULL;
+    uint32_t copied = 0;
+    uint32_t done = 0;
+    uint8_t ch = 0;
+
+    if (!is_open())
+        return;
+
+    if (0 != dropped)
+    {
+        ATOMIC_STORE_RELAXED(&samples_dropped_m, samples_dropped_m + dropped);
+        /* a chunk never spans a gap, start_sample stays exact */
+        if ((NULL != chunk_m) && (0 != fill_m))
+            submit();
+        sample_m += dropped;
+        skip_m = 0;
+    }
+
+    while (done < count)
+    {
+        if ((0 == skip_m) && (NULL == chunk_m))
+        {
+            chunk_m = take_free();
+            fill_m = 0;
+            chunk_start_m = sample_m;
+            if (NULL == chunk_m)
+            {
+                /* the I/O thread is late, this chunk is lost */
+                skip_m = chunk_samples_m;
+                ATOMIC_FETCH_ADD(&chunks_dropped_m, 1);
+            }
+        }
+        copied = count - done;
+        if (0 != skip_m)
+        {
+            if (copied > skip_m)
+                copied = skip_m;
+            skip_m -= copied;
+            ATOMIC_FETCH_ADD(&samples_lost_m, copied);
+        }
+        else
+        {
+            if (copied > chunk_samples_m - fill_m)
+                copied = chunk_samples_m - fill_m;
+            table = chunk_m + sizeof(capture_chunk_t);
+            for (ch = 0; ch < format_m.nb_channels; ch++)
+            {
+                if (format_m.channel_mask & (1 << ch))
+                {
+                    memcpy(table + fill_m * sizeof(int16_t), channels[ch] + done, copied * sizeof(int16_t));
+                    table += table_size;
+                }
+            }
+            fill_m += copied;
+            if (fill_m == chunk_samples_m)
+                submit();
+        }
+        done += copied;
+        sample_m += copied;
+    }
+}
+
+/****************************************************************************
+ * stream_stop
+ ****************************************************************************/
+void CaptureRecorder::stream_stop(void)
+{
+    if (!is_open() || (NULL == chunk_m))
+        return;
+    if (0 != fill_m)
+    {
+        submit();
+    }
+    else
+    {
+        pthread_mutex_lock(&lock_m);
+        free_m.push_back(chunk_m);
+        pthread_mutex_unlock(&lock_m);
+        chunk_m = NULL;
+    }
+}
+
+/****************************************************************************
+ * take_free
+ ****************************************************************************/
+uint8_t* CaptureRecorder::take_free(void)
+{
+    uint8_t *buffer = NULL;
+
+    pthread_mutex_lock(&lock_m);
+    if (!free_m.empty())
+    {
+        buffer = free_m.front();
+        free_m.pop_front();
+    }
+    pthread_mutex_unlock(&lock_m);
+    return buffer;
+}
+
+/****************************************************************************
+ * submit
+ *  Tables were filled at their place for a full chunk, a shorter chunk has
+ *  them moved next to each other first.
+ ****************************************************************************/
+void CaptureRecorder::submit(void)
+{
+    capture_chunk_t *chunk = (capture_chunk_t*)chunk_m;
+    uint64_t full_size = capture_table_size(chunk_samples_m);
+    uint64_t table_size = capture_table_size(fill_m);
+    uint8_t *tables = chunk_m + sizeof(capture_chunk_t);
+    uint64_t used = 0;
+    uint8_t k = 0;
+    uint8_t ch = 0;
+
+    memset(chunk, 0, sizeof(capture_chunk_t));
+    chunk->magic = CAPTURE_CHUNK_MAGIC;
+    chunk->header_size = sizeof(capture_chunk_t);
+    chunk->nb_channels = format_m.nb_channels;
+    chunk->channel_mask = format_m.channel_mask;
+    chunk->nb_samples = fill_m;
+    chunk->stream = nb_streams_m - 1;
+    chunk->start_sample = chunk_start_m;
+    chunk->sample_interval = format_m.sample_interval;
+    for (ch = 0; ch < CAPTURE_MAX_CHANNELS; ch++)
+    {
+        chunk->scale[ch] = format_m.scale[ch];
+        chunk->offset[ch] = format_m.offset[ch];
+    }
+
+    for (ch = 0; ch < format_m.nb_channels; ch++)
+    {
+        if (!(format_m.channel_mask & (1 << ch)))
+            continue;
+        if ((0 != k) && (table_size != full_size))
+            memmove(tables + k * table_size, tables + k * full_size, fill_m * sizeof(int16_t));
+        /* padding is zeroed, files do not depend on what the buffer held before */
+        memset(tables + k * table_size + fill_m * sizeof(int16_t), 0, table_size - fill_m * sizeof(int16_t));
+        k++;
+    }
+    used = sizeof(capture_chunk_t) + k * table_size;
+    memset(chunk_m + used, 0, capture_chunk_size(chunk) - used);
+
+    pthread_mutex_lock(&lock_m);
+    full_m.push_back(chunk_m);
+    if (full_m.size() > queue_high_water_m)
+        ATOMIC_STORE_RELAXED(&queue_high_water_m, (uint32_t)full_m.size());
+    pthread_cond_signal(&cond_m);
+    pthread_mutex_unlock(&lock_m);
+    chunk_m = NULL;
+    fill_m = 0;
+}
+
+/****************************************************************************
+ * write_all
+ ****************************************************************************/
+bool CaptureRecorder::write_all(const void *data, size_t size)
+{
+    const uint8_t *bytes = (const uint8_t*)data;
+    ssize_t ret = 0;
+
+    while (size > 0)
+    {
+        ret = ::write(fd_m, bytes, size);
+        if (ret < 0)
+        {
+            if (EINTR == errno)
+                continue;
+            ERROR("write failed (%s)\n", strerror(errno));
+            return false;
+        }
+        bytes += ret;
+        size -= ret;
+    }
+    return true;
+}
+
+/****************************************************************************
+ * thread_write
+ *  After a write error nothing more is written: the chunks would not be
+ *  at the offsets of the index. They are counted as dropped instead.
+ ****************************************************************************/
+void* CaptureRecorder::thread_write(void *arg)
+{
+    CaptureRecorder *recorder = (CaptureRecorder*)arg;
+    capture_chunk_t *chunk = NULL;
+    capture_index_t entry;
+    uint8_t *buffer = NULL;
+    uint64_t size = 0;
+    uint64_t start = 0;
+    bool failed = false;
+
+    for (;;)
+    {
+        pthread_mutex_lock(&recorder->lock_m);
+        while (recorder->full_m.empty() && !recorder->closing_m)
+            pthread_cond_wait(&recorder->cond_m, &recorder->lock_m);
+        if (recorder->full_m.empty())
+        {
+            pthread_mutex_unlock(&recorder->lock_m);
+            break;
+        }
+        buffer = recorder->full_m.front();
+        recorder->full_m.pop_front();
+        pthread_mutex_unlock(&recorder->lock_m);
+
+        chunk = (capture_chunk_t*)buffer;
+        size = capture_chunk_size(chunk);
+        start = now_ns();
+        if (!failed && recorder->write_all(buffer, size))
+        {
+            ATOMIC_STORE_RELAXED(&recorder->write_time_ns_m, recorder->write_time_ns_m + (now_ns() - start));
+            entry.offset = recorder->offset_m;
+            entry.start_sample = chunk->start_sample;
+            entry.nb_samples = chunk->nb_samples;
+            entry.stream = chunk->stream;
+            recorder->index_m.push_back(entry);
+            recorder->offset_m += size;
+            ATOMIC_STORE_RELAXED(&recorder->samples_written_m, recorder->samples_written_m + chunk->nb_samples);
+            ATOMIC_STORE_RELAXED(&recorder->chunks_written_m, recorder->chunks_written_m + 1);
+            ATOMIC_STORE_RELAXED(&recorder->bytes_written_m, recorder->bytes_written_m + size);
+        }
+        else
+        {
+            if (!failed)
+                ATOMIC_STORE_RELAXED(&recorder->write_errors_m, recorder->write_errors_m + 1);
+            failed = true;
+            ATOMIC_FETCH_ADD(&recorder->chunks_dropped_m, 1);
+            ATOMIC_FETCH_ADD(&recorder->samples_lost_m, chunk->nb_samples);
+        }
+
+        pthread_mutex_lock(&recorder->lock_m);
+        recorder->free_m.push_back(buffer);
+        pthread_mutex_unlock(&recorder->lock_m);
+    }
+    pthread_exit(NULL);
+}
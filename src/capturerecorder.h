@@ -0,0 +1,154 @@
+/*****************************************************************************
+*   Copyright 2012 Vincent HERVIEUX
+*
+*   This file is part of QPicoscope.
+*
+*   QPicoscope is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU Lesser General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   any later version.
+*
+*   QPicoscope is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU Lesser General Public License for more details.
+*
+*   You should have received a copy of the GNU Lesser General Public License
+*   along with QPicoscope in files COPYING.LESSER and COPYING.
+*   If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+/**
+ * @file capturerecorder.h
+ * @brief Declaration of CaptureRecorder class.
+ * StreamSink writing the stream in a chunked binary file, see
+ * captureformat.h. Samples are copied in preallocated chunk buffers from
+ * the dispatcher thread, full chunks are written by an I/O thread of the
+ * recorder: the stream never waits for the disk. When the disk is too
+ * slow and no buffer is free, whole chunks are dropped and counted.
+ * @version 0.1
+ * @date 2026, october 16
+ * @author Vincent HERVIEUX    -   10.16.2026   -   initial creation
+ */
+
+#ifndef CAPTURERECORDER_H
+#define CAPTURERECORDER_H
+
+#include <pthread.h>
+#include <deque>
+#include <vector>
+
+#include "oscilloscope.h"
+#include "captureformat.h"
+#include "streamsink.h"
+
+/* samples per channel of a chunk */
+#define RECORDER_CHUNK_SAMPLES    (256 * 1024)
+/* chunks the I/O thread may be late by */
+#define RECORDER_BUFFERS          16
+
+class CaptureRecorder : public StreamSink
+{
+public:
+    /**
+     * @brief public typedef declarations
+     */
+    typedef struct
+    {
+        /** @brief samples per channel written to disk */
+        uint64_t samples_written;
+        uint64_t chunks_written;
+        uint64_t bytes_written;
+        /** @brief chunks whose samples never reached the disk */
+        uint64_t chunks_dropped;
+        /** @brief samples per channel of the dropped chunks */
+        uint64_t samples_lost;
+        /** @brief samples the stream dropped before the recorder */
+        uint64_t samples_dropped;
+        /** @brief most chunks ever waiting for the I/O thread */
+        uint32_t queue_high_water;
+        uint32_t write_errors;
+        /** @brief time the I/O thread spent in write(), in seconds */
+        double   write_time;
+    } stats_t;
+
+    /** @brief constructor, nothing is allocated yet */
+    CaptureRecorder();
+    /** @brief destructor, closes the file */
+    ~CaptureRecorder();
+
+    /**
+     * @brief create the file, allocate the chunk buffers and start the I/O thread
+     * @param[in] path: file to create, truncated if it exists
+     * @param[in] chunk_samples: samples per channel of a chunk
+     * @param[in] nb_buffers: chunk buffers, the I/O thread may be late by all of them
+     * @return false if the file, the buffers or the thread cannot be created
+     */
+    bool open(const char *path, uint32_t chunk_samples = RECORDER_CHUNK_SAMPLES,
+              uint32_t nb_buffers = RECORDER_BUFFERS);
+    /**
+     * @brief write the queued chunks and the index, then close the file
+     * The recorder must not be a sink of a running stream anymore.
+     */
+    void close(void);
+    bool is_open(void) const { return fd_m >= 0; }
+    /** @brief read the counters, can be called from any thread */
+    void get_stats(stats_t *stats) const;
+
+    void stream_start(const stream_format_t &format);
+    void stream_data(const int16_t *const *channels, uint32_t count, uint64_t dropped);
+    void stream_stop(void);
+
+private:
+    CaptureRecorder(const CaptureRecorder&);
+    CaptureRecorder& operator=(const CaptureRecorder&);
+    static void* thread_write(void *arg);
+    /** @brief write size bytes, false on error */
+    bool write_all(const void *data, size_t size);
+    /** @brief fill the chunk header and queue the chunk for the I/O thread */
+    void submit(void);
+    /** @brief a free chunk buffer, NULL if the I/O thread is late */
+    uint8_t* take_free(void);
+
+    int fd_m;
+    pthread_t thread_id_m;
+    pthread_mutex_t lock_m;
+    pthread_cond_t cond_m;
+    /** @brief set by close(), the I/O thread exits once the queue is empty */
+    bool closing_m;
+    std::vector<uint8_t*> buffers_m;
+    /* protected by lock_m */
+    std::deque<uint8_t*> free_m;
+    std::deque<uint8_t*> full_m;
+
+    /* dispatcher thread only */
+    stream_format_t format_m;
+    /** @brief streams started since open() */
+    uint32_t nb_streams_m;
+    uint32_t chunk_samples_m;
+    /** @brief chunk being filled, NULL between two chunks */
+    uint8_t *chunk_m;
+    uint32_t fill_m;
+    /** @brief index in the stream of the first sample of chunk_m */
+    uint64_t chunk_start_m;
+    /** @brief samples left to discard for the chunk being dropped */
+    uint32_t skip_m;
+    /** @brief index of the next sample of the stream */
+    uint64_t sample_m;
+
+    /* I/O thread only */
+    uint64_t offset_m;
+    std::vector<capture_index_t> index_m;
+
+    /* counters, see stats_t, lost and dropped chunks are counted by both threads */
+    uint64_t samples_written_m;
+    uint64_t chunks_written_m;
+    uint64_t bytes_written_m;
+    uint64_t chunks_dropped_m;
+    uint64_t samples_lost_m;
+    uint64_t samples_dropped_m;
+    uint32_t queue_high_water_m;
+    uint32_t write_errors_m;
+    uint64_t write_time_ns_m;
+};
+
+#endif // CAPTURERECORDER_H
@@ -0,0 +1,209 @@
+/*****************************************************************************
+*   Copyright 2012 Vincent HERVIEUX
+*
+*   This file is part of QPicoscope.
+*
+*   QPicoscope is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU Lesser General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   any later version.
+*
+*   QPicoscope is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU Lesser General Public License for more details.
+*
+*   You should have received a copy of the GNU Lesser General Public License
+*   along with QPicoscope in files COPYING.LESSER and COPYING.
+*   If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+/**
+ * @file columnspans.cpp
+ * @brief Definition of ColumnSpans class.
+ * @version 0.1
+ * @date 2026, october 16
+ * @author Vincent HERVIEUX    -   10.16.2026   -   initial creation
+ */
+
+#include <stdlib.h>
+#include <math.h>
+
+#include "columnspans.h"
+
+/* top of an empty column, below every row */
+#define COLUMN_SPANS_EMPTY_TOP       INT32_MAX
+#define COLUMN_SPANS_EMPTY_BOTTOM    INT32_MIN
+
+/****************************************************************************
+ *
+ * constructor
+ *
+ ****************************************************************************/
+ColumnSpans::ColumnSpans() :
+    top_m(NULL),
+    bottom_m(NULL),
+    group_top_m(NULL),
+    group_bottom_m(NULL),
+    width_m(0),
+    height_m(0),
+    stride_m(0)
+{
+}
+
+/****************************************************************************
+ *
+ * destructor
+ *
+ ****************************************************************************/
+ColumnSpans::~ColumnSpans()
+{
+    free(top_m);
+}
+
+/****************************************************************************
+ * resize
+ ****************************************************************************/
+bool ColumnSpans::resize(uint32_t width, uint32_t height)
+{
+    uint32_t stride = (width + COLUMN_SPANS_GROUP - 1) & ~(uint32_t)(COLUMN_SPANS_GROUP - 1);
+    void *tables = NULL;
+
+    if ((width == width_m) && (height == height_m) && (NULL != top_m))
+        return true;
+    if ((0 == width) || (0 == height) || (height > COLUMN_SPANS_MAX_HEIGHT))
+        return false;
+
+    if (0 != posix_memalign(&tables, COLUMN_SPANS_GROUP * sizeof(int32_t),
+                            (2 * stride + 2 * stride / COLUMN_SPANS_GROUP) * sizeof(int32_t)))
+    {
+        ERROR("cannot allocate spans for %u columns\n", width);
+        return false;
+    }
+    free(top_m);
+    top_m = (int32_t*)tables;
+    bottom_m = top_m + stride;
+    group_top_m = bottom_m + stride;
+    group_bottom_m = group_top_m + stride / COLUMN_SPANS_GROUP;
+    width_m = width;
+    height_m = height;
+    stride_m = stride;
+    clear();
+    return true;
+}
+
+/****************************************************************************
+ * clear
+ ****************************************************************************/
+void ColumnSpans::clear(void)
+{
+    uint32_t c = 0;
+
+    for (c = 0; c < stride_m; c++)
+    {
+        top_m[c] = COLUMN_SPANS_EMPTY_TOP;
+        bottom_m[c] = COLUMN_SPANS_EMPTY_BOTTOM;
+    }
+    for (c = 0; c < stride_m / COLUMN_SPANS_GROUP; c++)
+    {
+        group_top_m[c] = COLUMN_SPANS_EMPTY_TOP;
+        group_bottom_m[c] = COLUMN_SPANS_EMPTY_BOTTOM;
+    }
+}
+
+/****************************************************************************
+ * set
+ *
+ * Rows stay unclamped, one off the image at most, until the spans are
+ * joined: a trace leaving the image still draws its edge columns right.
+ * A column left empty between two others gets the row of the line
+ * joining their middles, the joining pass then fills the rows in between.
+ ****************************************************************************/
+void ColumnSpans::set(const double *x, const double *y, uint32_t count,
+                      double x_scale, double x_offset, double y_scale, double y_offset)
+{
+    int32_t last = (int32_t)height_m - 1;
+    int32_t previous_top = COLUMN_SPANS_EMPTY_TOP;
+    int32_t previous_bottom = COLUMN_SPANS_EMPTY_BOTTOM;
+    int32_t top = 0;
+    int32_t bottom = 0;
+    int32_t row = 0;
+    double column = 0.;
+    double pixel = 0.;
+    double from = 0.;
+    double to = 0.;
+    uint32_t previous = 0;
+    uint32_t c = 0;
+    uint32_t k = 0;
+    uint32_t g = 0;
+    uint32_t i = 0;
+    bool found = false;
+
+    if (NULL == top_m)
+        return;
+    clear();
+
+    for (i = 0; i < count; i++)
+    {
+        column = floor(x[i] * x_scale + x_offset);
+        if ((column < 0.) || (column >= width_m))
+            continue;
+        c = (uint32_t)column;
+        /* far outside rows are clamped before the conversion */
+        pixel = floor(y[i] * y_scale + y_offset + 0.5);
+        row = (pixel < -1.) ? -1 : (pixel > height_m) ? (int32_t)height_m : (int32_t)pixel;
+        if (row < top_m[c])
+            top_m[c] = row;
+        if (row > bottom_m[c])
+            bottom_m[c] = row;
+    }
+
+    for (c = 0; c < width_m; c++)
+    {
+        if (top_m[c] > bottom_m[c])
+            continue;
+        if (found && (c > previous + 1))
+        {
+            from = 0.5 * (top_m[previous] + bottom_m[previous]);
+            to = 0.5 * (top_m[c] + bottom_m[c]);
+            for (k = previous + 1; k < c; k++)
+            {
+                row = (int32_t)floor(from + (to - from) * (k - previous) / (c - previous) + 0.5);
+                top_m[k] = bottom_m[k] = row;
+            }
+        }
+        previous = c;
+        found = true;
+    }
+
+    for (c = 0; c < width_m; c++)
+    {
+        if (top_m[c] > bottom_m[c])
+        {
+            previous_top = COLUMN_SPANS_EMPTY_TOP;
+            continue;
+        }
+        top = top_m[c];
+        bottom = bottom_m[c];
+        if (previous_top <= previous_bottom)
+        {
+            if (top_m[c] > previous_bottom + 1)
+                top_m[c] = previous_bottom + 1;
+            if (bottom_m[c] < previous_top - 1)
+                bottom_m[c] = previous_top - 1;
+        }
+        previous_top = top;
+        previous_bottom = bottom;
+        /* rows off the image are never drawn */
+        if (top_m[c] < 0)
+            top_m[c] = 0;
+        if (bottom_m[c] > last)
+            bottom_m[c] = last;
+        if (top_m[c] > bottom_m[c])
+            continue;
+        g = c / COLUMN_SPANS_GROUP;
+        if (top_m[c] < group_top_m[g])
+            group_top_m[g] = top_m[c];
+        if (bottom_m[c] > group_bottom_m[g])
+            group_bottom_m[g] = bottom_m[c];
+    }
+}
@@ -0,0 +1,95 @@
+/*****************************************************************************
+*   Copyright 2012 Vincent HERVIEUX
+*
+*   This file is part of QPicoscope.
+*
+*   QPicoscope is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU Lesser General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   any later version.
+*
+*   QPicoscope is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU Lesser General Public License for more details.
+*
+*   You should have received a copy of the GNU Lesser General Public License
+*   along with QPicoscope in files COPYING.LESSER and COPYING.
+*   If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+/**
+ * @file columnspans.h
+ * @brief Declaration of ColumnSpans class.
+ * A trace reduced to one vertical span of rows per pixel column, the
+ * shape drawn by TraceRaster and accumulated by PersistenceBuffer. Points
+ * are merged into the span of their column, columns left empty between
+ * two points are bridged, then each span is stretched to touch the span
+ * of the previous column so the trace stays continuous, like a polyline.
+ * Columns are also gathered by groups of COLUMN_SPANS_GROUP with the rows
+ * covered by the group, so SIMD kernels can walk a group over those rows
+ * only.
+ * @version 0.1
+ * @date 2026, october 16
+ * @author Vincent HERVIEUX    -   10.16.2026   -   initial creation
+ */
+
+#ifndef COLUMNSPANS_H
+#define COLUMNSPANS_H
+
+#include "oscilloscope.h"
+
+/* columns per group, tables are padded and aligned to it */
+#define COLUMN_SPANS_GROUP        8
+/* rows are kept below this so kernels may compare them on 16 bits */
+#define COLUMN_SPANS_MAX_HEIGHT   32767
+
+class ColumnSpans
+{
+public:
+    /** @brief constructor, empty until resize() */
+    ColumnSpans();
+    /** @brief destructor */
+    ~ColumnSpans();
+
+    /**
+     * @brief set the number of columns and rows, every column is empty then
+     * @return false if memory is exhausted or height is above COLUMN_SPANS_MAX_HEIGHT
+     */
+    bool resize(uint32_t width, uint32_t height);
+    uint32_t width(void) const { return width_m; }
+    uint32_t height(void) const { return height_m; }
+    /** @brief width rounded up to a group, padding columns are always empty */
+    uint32_t stride(void) const { return stride_m; }
+
+    /**
+     * @brief compute the spans of a trace
+     * Coordinates are mapped to pixels by column = x * x_scale + x_offset
+     * and row = y * y_scale + y_offset. Points may be samples in time
+     * order or the minimum / maximum pairs of Decimator.
+     */
+    void set(const double *x, const double *y, uint32_t count,
+             double x_scale, double x_offset, double y_scale, double y_offset);
+
+    /** @brief first and last row of each column, top > bottom when empty, aligned */
+    const int32_t* top(void) const { return top_m; }
+    const int32_t* bottom(void) const { return bottom_m; }
+    /** @brief first and last row of each group, top > bottom when empty */
+    const int32_t* groupTop(void) const { return group_top_m; }
+    const int32_t* groupBottom(void) const { return group_bottom_m; }
+
+private:
+    ColumnSpans(const ColumnSpans&);
+    ColumnSpans& operator=(const ColumnSpans&);
+    void clear(void);
+
+    /* one allocation, top_m first */
+    int32_t *top_m;
+    int32_t *bottom_m;
+    int32_t *group_top_m;
+    int32_t *group_bottom_m;
+    uint32_t width_m;
+    uint32_t height_m;
+    uint32_t stride_m;
+};
+
+#endif // COLUMNSPANS_H
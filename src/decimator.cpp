@@ -0,0 +1,357 @@
+/*****************************************************************************
+*   Copyright 2012 Vincent HERVIEUX
+*
+*   This file is part of QPicoscope.
+*
+*   QPicoscope is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU Lesser General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   any later version.
+*
+*   QPicoscope is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU Lesser General Public License for more details.
+*
+*   You should have received a copy of the GNU Lesser General Public License
+*   along with QPicoscope in files COPYING.LESSER and COPYING.
+*   If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+/**
+ * @file decimator.cpp
+ * @brief Definition of Decimator class.
+ * @version 0.1
+ * @date 2026, october 16
+ * @author Vincent HERVIEUX    -   10.16.2026   -   initial creation
+ */
+
+#include <stdlib.h>
+#include <math.h>
+
+#include "decimator.h"
+#include "minmaxpyramid.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define DECIMATOR_X86
+#include <immintrin.h>
+#endif
+#if defined(__aarch64__) && defined(__ARM_NEON)
+#define DECIMATOR_NEON
+#include <arm_neon.h>
+#endif
+
+/****************************************************************************
+ * min_max_scalar
+ ****************************************************************************/
+static void min_max_scalar(const int16_t *raw, uint32_t count, int16_t *minimum, int16_t *maximum)
+{
+    int16_t lo = raw[0];
+    int16_t hi = raw[0];
+    uint32_t i = 0;
+
+    for (i = 1; i < count; i++)
+    {
+        if (raw[i] < lo)
+            lo = raw[i];
+        if (raw[i] > hi)
+            hi = raw[i];
+    }
+    *minimum = lo;
+    *maximum = hi;
+}
+
+#ifdef DECIMATOR_X86
+/****************************************************************************
+ * reduce_sse2
+ *
+ * Folds the 8 lanes of lo and hi, then the tail is done in scalar.
+ ****************************************************************************/
+__attribute__((target("sse2")))
+static inline void reduce_sse2(__m128i lo, __m128i hi, const int16_t *tail, uint32_t count, int16_t *minimum, int16_t *maximum)
+{
+    int16_t tail_lo = 0;
+    int16_t tail_hi = 0;
+
+    lo = _mm_min_epi16(lo, _mm_shuffle_epi32(lo, _MM_SHUFFLE(1, 0, 3, 2)));
+    lo = _mm_min_epi16(lo, _mm_shuffle_epi32(lo, _MM_SHUFFLE(2, 3, 0, 1)));
+    lo = _mm_min_epi16(lo, _mm_shufflelo_epi16(lo, _MM_SHUFFLE(2, 3, 0, 1)));
+    hi = _mm_max_epi16(hi, _mm_shuffle_epi32(hi, _MM_SHUFFLE(1, 0, 3, 2)));
+    hi = _mm_max_epi16(hi, _mm_shuffle_epi32(hi, _MM_SHUFFLE(2, 3, 0, 1)));
+    hi = _mm_max_epi16(hi, _mm_shufflelo_epi16(hi, _MM_SHUFFLE(2, 3, 0, 1)));
+    *minimum = (int16_t)_mm_cvtsi128_si32(lo);
+    *maximum = (int16_t)_mm_cvtsi128_si32(hi);
+    if (count > 0)
+    {
+        min_max_scalar(tail, count, &tail_lo, &tail_hi);
+        if (tail_lo < *minimum)
+            *minimum = tail_lo;
+        if (tail_hi > *maximum)
+            *maximum = tail_hi;
+    }
+}
+
+/****************************************************************************
+ * min_max_sse2
+ ****************************************************************************/
+__attribute__((target("sse2")))
+static void min_max_sse2(const int16_t *raw, uint32_t count, int16_t *minimum, int16_t *maximum)
+{
+    __m128i lo;
+    __m128i hi;
+    __m128i v;
+    uint32_t i = 0;
+
+    if (count < 8)
+    {
+        min_max_scalar(raw, count, minimum, maximum);
+        return;
+    }
+    lo = hi = _mm_loadu_si128((const __m128i*)raw);
+    for (i = 8; i + 8 <= count; i += 8)
+    {
+        v = _mm_loadu_si128((const __m128i*)(raw + i));
+        lo = _mm_min_epi16(lo, v);
+        hi = _mm_max_epi16(hi, v);
+    }
+    reduce_sse2(lo, hi, raw + i, count - i, minimum, maximum);
+}
+
+/****************************************************************************
+ * min_max_avx2
+ ****************************************************************************/
+__attribute__((target("avx2")))
+static void min_max_avx2(const int16_t *raw, uint32_t count, int16_t *minimum, int16_t *maximum)
+{
+    __m256i lo;
+    __m256i hi;
+    __m256i v;
+    uint32_t i = 0;
+
+    if (count < 16)
+    {
+        min_max_sse2(raw, count, minimum, maximum);
+        return;
+    }
+    lo = hi = _mm256_loadu_si256((const __m256i*)raw);
+    for (i = 16; i + 16 <= count; i += 16)
+    {
+        v = _mm256_loadu_si256((const __m256i*)(raw + i));
+        lo = _mm256_min_epi16(lo, v);
+        hi = _mm256_max_epi16(hi, v);
+    }
+    reduce_sse2(_mm_min_epi16(_mm256_castsi256_si128(lo), _mm256_extracti128_si256(lo, 1)),
+                _mm_max_epi16(_mm256_castsi256_si128(hi), _mm256_extracti128_si256(hi, 1)),
+                raw + i, count - i, minimum, maximum);
+}
+#endif
+
+#ifdef DECIMATOR_NEON
+/****************************************************************************
+ * min_max_neon
+ ****************************************************************************/
+static void min_max_neon(const int16_t *raw, uint32_t count, int16_t *minimum, int16_t *maximum)
+{
+    int16x8_t lo;
+    int16x8_t hi;
+    int16x8_t v;
+    int16_t tail_lo = 0;
+    int16_t tail_hi = 0;
+    uint32_t i = 0;
+
+    if (count < 8)
+    {
+        min_max_scalar(raw, count, minimum, maximum);
+        return;
+    }
+    lo = hi = vld1q_s16(raw);
+    for (i = 8; i + 8 <= count; i += 8)
+    {
+        v = vld1q_s16(raw + i);
+        lo = vminq_s16(lo, v);
+        hi = vmaxq_s16(hi, v);
+    }
+    *minimum = vminvq_s16(lo);
+    *maximum = vmaxvq_s16(hi);
+    if (i < count)
+    {
+        min_max_scalar(raw + i, count - i, &tail_lo, &tail_hi);
+        if (tail_lo < *minimum)
+            *minimum = tail_lo;
+        if (tail_hi > *maximum)
+            *maximum = tail_hi;
+    }
+}
+#endif
+
+/****************************************************************************
+ *
+ * constructor
+ *
+ ****************************************************************************/
+Decimator::Decimator() :
+    kernel_m(AdcConvert::E_KERNEL_SCALAR),
+    min_max_m(min_max_scalar),
+    x_m(NULL),
+    y_m(NULL),
+    capacity_m(0)
+{
+    setKernel(AdcConvert::best_kernel());
+}
+
+/****************************************************************************
+ *
+ * destructor
+ *
+ ****************************************************************************/
+Decimator::~Decimator()
+{
+    free(x_m);
+    free(y_m);
+}
+
+/****************************************************************************
+ * setKernel
+ ****************************************************************************/
+bool Decimator::setKernel(AdcConvert::kernel_e kernel)
+{
+    kernel_fn_t function = NULL;
+
+    if (AdcConvert::is_supported(kernel))
+    {
+        switch (kernel)
+        {
+#ifdef DECIMATOR_X86
+        case AdcConvert::E_KERNEL_SSE2:
+            function = min_max_sse2;
+            break;
+        case AdcConvert::E_KERNEL_AVX2:
+            function = min_max_avx2;
+            break;
+#endif
+#ifdef DECIMATOR_NEON
+        case AdcConvert::E_KERNEL_NEON:
+            function = min_max_neon;
+            break;
+#endif
+        case AdcConvert::E_KERNEL_SCALAR:
+            function = min_max_scalar;
+            break;
+        default:
+            break;
+        }
+    }
+    if (NULL == function)
+    {
+        WARNING("%s kernel not supported, keeping %s\n", AdcConvert::kernel_name(kernel), AdcConvert::kernel_name(kernel_m));
+        return false;
+    }
+    kernel_m = kernel;
+    min_max_m = function;
+    return true;
+}
+
+/****************************************************************************
+ * reserve
+ ****************************************************************************/
+bool Decimator::reserve(uint32_t nb_points)
+{
+    double *x = NULL;
+    double *y = NULL;
+
+    if (capacity_m >= nb_points)
+        return true;
+
+    x = (double*)realloc(x_m, nb_points * sizeof(double));
+    if (NULL == x)
+        return false;
+    x_m = x;
+    y = (double*)realloc(y_m, nb_points * sizeof(double));
+    if (NULL == y)
+        return false;
+    y_m = y;
+    capacity_m = nb_points;
+    return true;
+}
+
+/****************************************************************************
+ * minMax
+ ****************************************************************************/
+void Decimator::minMax(const int16_t *raw, uint32_t count, int16_t *minimum, int16_t *maximum) const
+{
+    min_max_m(raw, count, minimum, maximum);
+}
+
+/****************************************************************************
+ * decimate
+ ****************************************************************************/
+uint32_t Decimator::decimate(const int16_t *raw, uint32_t nb_points, float scale, float offset,
+                             double x_origin, double x_interval, double x_min, double x_max, uint32_t columns)
+{
+    if (NULL == raw)
+        return 0;
+    return decimateColumns(raw, NULL, nb_points, scale, offset, x_origin, x_interval, x_min, x_max, columns);
+}
+
+/****************************************************************************
+ * decimate
+ ****************************************************************************/
+uint32_t Decimator::decimate(const MinMaxPyramid &pyramid, float scale, float offset,
+                             double x_origin, double x_interval, double x_min, double x_max, uint32_t columns)
+{
+    return decimateColumns(pyramid.data(), &pyramid, pyramid.size(), scale, offset, x_origin, x_interval, x_min, x_max, columns);
+}
+
+/****************************************************************************
+ * decimateColumns
+ *
+ * Column bounds are computed in samples once per column, the extrema come
+ * from the pyramid when there is one, else from a scan of the samples by
+ * the min/max kernel.
+ ****************************************************************************/
+uint32_t Decimator::decimateColumns(const int16_t *raw, const MinMaxPyramid *pyramid, uint32_t nb_points, float scale, float offset,
+                                    double x_origin, double x_interval, double x_min, double x_max, uint32_t columns)
+{
+    double column_width = 0.;
+    double x_center = 0.;
+    double first = 0.;
+    double last = 0.;
+    uint32_t column = 0;
+    uint32_t begin = 0;
+    uint32_t end = 0;
+    uint32_t count = 0;
+    int16_t minimum = 0;
+    int16_t maximum = 0;
+
+    if ((0 == nb_points) || (0 == columns) || (x_interval <= 0.) || (x_max <= x_min))
+        return 0;
+    if (!reserve(2 * columns))
+    {
+        ERROR("cannot allocate %u columns\n", columns);
+        return 0;
+    }
+
+    column_width = (x_max - x_min) / columns;
+    for (column = 0; column < columns; column++)
+    {
+        /* samples whose time falls in the column */
+        first = ceil((x_min + column * column_width - x_origin) / x_interval);
+        last = ceil((x_min + (column + 1) * column_width - x_origin) / x_interval);
+        if ((last <= 0.) || (first >= nb_points))
+            continue;
+        begin = (first < 0.) ? 0 : (uint32_t)first;
+        end = (last > nb_points) ? nb_points : (uint32_t)last;
+        if (begin >= end)
+            continue;
+
+        if (NULL != pyramid)
+            pyramid->minMax(begin, end, &minimum, &maximum);
+        else
+            min_max_m(raw + begin, end - begin, &minimum, &maximum);
+        x_center = x_min + (column + 0.5) * column_width;
+        x_m[count] = x_center;
+        y_m[count++] = minimum * scale + offset;
+        x_m[count] = x_center;
+        y_m[count++] = maximum * scale + offset;
+    }
+    return count;
+}
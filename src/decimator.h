@@ -0,0 +1,106 @@
+/*****************************************************************************
+*   Copyright 2012 Vincent HERVIEUX
+*
+*   This file is part of QPicoscope.
+*
+*   QPicoscope is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU Lesser General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   any later version.
+*
+*   QPicoscope is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU Lesser General Public License for more details.
+*
+*   You should have received a copy of the GNU Lesser General Public License
+*   along with QPicoscope in files COPYING.LESSER and COPYING.
+*   If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+/**
+ * @file decimator.h
+ * @brief Declaration of Decimator class.
+ * Reduces evenly spaced ADC counts to a minimum and a maximum per pixel
+ * column, so that drawing cost depends on the canvas width and not on the
+ * record length, and a glitch of a single sample stays visible.
+ * The min/max scan uses the same SIMD kernels selection as AdcConvert.
+ * @version 0.1
+ * @date 2026, october 16
+ * @author Vincent HERVIEUX    -   10.16.2026   -   initial creation
+ */
+
+#ifndef DECIMATOR_H
+#define DECIMATOR_H
+
+#include "oscilloscope.h"
+#include "adcconvert.h"
+
+/* below this many samples per column a curve is drawn as is */
+#define DECIMATOR_MIN_SAMPLES_PER_COLUMN    4
+
+class MinMaxPyramid;
+
+class Decimator
+{
+public:
+    /** @brief constructor, selects the best kernel for this CPU */
+    Decimator();
+    /** @brief destructor */
+    ~Decimator();
+
+    /**
+     * @brief reduce counts to two points per column
+     * Column c covers x in [x_min + c * w, x_min + (c + 1) * w[ with
+     * w = (x_max - x_min) / columns. Points x() and y() alternate the
+     * minimum and the maximum of each column holding at least one sample.
+     * @param[in] raw: ADC counts, point i is at x_origin + i * x_interval
+     * @param[in] nb_points: number of counts
+     * @param[in] scale: volts per count
+     * @param[in] offset: volts at count 0
+     * @param[in] x_min, x_max: visible time range, in seconds
+     * @param[in] columns: canvas width in pixels
+     * @return number of points in x() and y()
+     */
+    uint32_t decimate(const int16_t *raw, uint32_t nb_points, float scale, float offset,
+                      double x_origin, double x_interval, double x_min, double x_max, uint32_t columns);
+    /**
+     * @brief same as above, column extrema are read from the pyramid
+     * Cost no longer depends on the number of samples in the view.
+     */
+    uint32_t decimate(const MinMaxPyramid &pyramid, float scale, float offset,
+                      double x_origin, double x_interval, double x_min, double x_max, uint32_t columns);
+    const double* x(void) const { return x_m; }
+    const double* y(void) const { return y_m; }
+
+    /** @brief true when decimating nb_points over columns is worth it */
+    static bool isNeeded(uint32_t nb_points, uint32_t columns)
+    {
+        return (nb_points >= (uint64_t)columns * DECIMATOR_MIN_SAMPLES_PER_COLUMN);
+    }
+
+    /**
+     * @brief minimum and maximum of count samples, count > 0
+     * Exposed for the benchmark and MinMaxPyramid, decimate() calls it
+     * once per column.
+     */
+    void minMax(const int16_t *raw, uint32_t count, int16_t *minimum, int16_t *maximum) const;
+    /** @brief force a kernel, false if this CPU cannot run it */
+    bool setKernel(AdcConvert::kernel_e kernel);
+    AdcConvert::kernel_e getKernel(void) const { return kernel_m; }
+
+private:
+    Decimator(const Decimator&);
+    Decimator& operator=(const Decimator&);
+    typedef void (*kernel_fn_t)(const int16_t *raw, uint32_t count, int16_t *minimum, int16_t *maximum);
+    bool reserve(uint32_t nb_points);
+    uint32_t decimateColumns(const int16_t *raw, const MinMaxPyramid *pyramid, uint32_t nb_points, float scale, float offset,
+                             double x_origin, double x_interval, double x_min, double x_max, uint32_t columns);
+
+    AdcConvert::kernel_e kernel_m;
+    kernel_fn_t min_max_m;
+    double *x_m;
+    double *y_m;
+    uint32_t capacity_m;
+};
+
+#endif // DECIMATOR_H
@@ -43,6 +43,29 @@ public:
      * return : 0 if successful, -1 in case of error
      */
     virtual int8_t setData(uint8_t channel_id, double *x_data, double *y_data, uint32_t nb_points) = 0;
+    /**
+     * @brief: set evenly spaced ADC counts to draw, converted only when drawn
+     * Point i is at x = x_origin + i * x_interval, y = raw[i] * scale + offset.
+     * @param[in] channel_id: same as setData()
+     * @param[in] raw table of ADC counts. Table has nb_points elements. Table will be copied.
+     * @param[in] nb_points is the table size.
+     * @param[in] scale: volts per ADC count
+     * @param[in] offset: volts at count 0
+     * @param[in] x_origin: time of the first point in seconds
+     * @param[in] x_interval: time between two points in seconds
+     * @param[in] append: true when the table is the previous one of the
+     * channel with new blocks after it, same scale, offset and x: the
+     * screen only indexes the new counts. False starts a new capture.
+     * return : 0 if successful, -1 in case of error
+     */
+    virtual int8_t setRawData(uint8_t channel_id, const int16_t *raw, uint32_t nb_points,
+                              float scale, float offset, double x_origin, double x_interval, bool append) = 0;
+    /**
+     * @brief: hand the channels set since the last call over to the drawing side
+     * Called once per acquired block, from the acquisition thread.
+     * return : 0 if published, -1 if the frame was dropped
+     */
+    virtual int8_t publishData(void) = 0;
 
 };
 
@@ -0,0 +1,265 @@
+/*****************************************************************************
+*   Copyright 2012 Vincent HERVIEUX
+*
+*   This file is part of QPicoscope.
+*
+*   QPicoscope is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU Lesser General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   any later version.
+*
+*   QPicoscope is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU Lesser General Public License for more details.
+*
+*   You should have received a copy of the GNU Lesser General Public License
+*   along with QPicoscope in files COPYING.LESSER and COPYING.
+*   If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+/**
+ * @file fftplan.cpp
+ * @brief Definition of FftPlan class.
+ * @version 0.1
+ * @date 2026, october 16
+ * @author Vincent HERVIEUX    -   10.16.2026   -   initial creation
+ */
+
+#include <stdlib.h>
+#include <math.h>
+
+#include "fftplan.h"
+
+/****************************************************************************
+ *
+ * constructor
+ *
+ ****************************************************************************/
+FftPlan::FftPlan() :
+    size_m(0),
+    half_m(0),
+    reverse_m(NULL),
+    twiddles_m(NULL),
+    split_m(NULL)
+{
+}
+
+/****************************************************************************
+ *
+ * destructor
+ *
+ ****************************************************************************/
+FftPlan::~FftPlan()
+{
+    free(reverse_m);
+    free(twiddles_m);
+    free(split_m);
+}
+
+/****************************************************************************
+ * init
+ *
+ * Tables are computed in double, rounded once to float.
+ ****************************************************************************/
+bool FftPlan::init(uint32_t size)
+{
+    uint32_t half = size / 2;
+    uint32_t *reverse = NULL;
+    float *twiddles = NULL;
+    float *split = NULL;
+    uint32_t bits = 0;
+    uint32_t i = 0;
+    uint32_t h = 0;
+    uint32_t j = 0;
+    double angle = 0.;
+
+    if ((size < FFT_PLAN_MIN_SIZE) || (size > FFT_PLAN_MAX_SIZE) || (0 != (size & (size - 1))))
+    {
+        ERROR("unsupported FFT size %u\n", size);
+        return false;
+    }
+    if (size == size_m)
+        return true;
+
+    reverse = (uint32_t*)malloc(half * sizeof(uint32_t));
+    twiddles = (float*)malloc(2 * half * sizeof(float));
+    split = (float*)malloc(2 * half * sizeof(float));
+    if ((NULL == reverse) || (NULL == twiddles) || (NULL == split))
+    {
+        ERROR("cannot allocate a %u points FFT plan\n", size);
+        free(reverse);
+        free(twiddles);
+        free(split);
+        return false;
+    }
+
+    while ((1U << bits) < half)
+        bits++;
+    for (i = 0; i < half; i++)
+    {
+        reverse[i] = 0;
+        for (j = 0; j < bits; j++)
+            reverse[i] |= ((i >> j) & 1) << (bits - 1 - j);
+    }
+    /* stage of half length h starts at h - 1 */
+    for (h = 1; h < half; h <<= 1)
+    {
+        for (j = 0; j < h; j++)
+        {
+            angle = -M_PI * j / h;
+            twiddles[2 * (h - 1 + j)] = (float)cos(angle);
+            twiddles[2 * (h - 1 + j) + 1] = (float)sin(angle);
+        }
+    }
+    for (i = 0; i < half; i++)
+    {
+        angle = -2. * M_PI * i / size;
+        split[2 * i] = (float)cos(angle);
+        split[2 * i + 1] = (float)sin(angle);
+    }
+
+    free(reverse_m);
+    free(twiddles_m);
+    free(split_m);
+    reverse_m = reverse;
+    twiddles_m = twiddles;
+    split_m = split;
+    size_m = size;
+    half_m = half;
+    return true;
+}
+
+/****************************************************************************
+ * transform
+ *
+ * Radix 2 decimation in time, two stages per pass over the data as long
+ * as there are two left: a pass of stages h and 2h is a radix 4 butterfly
+ * on points j, j + h, j + 2h and j + 3h, whose last twiddle factor is the
+ * one of j times -i. The first two stages only have 1 and -i as factors.
+ ****************************************************************************/
+void FftPlan::transform(float *data) const
+{
+    const float *w1 = NULL;
+    const float *w2 = NULL;
+    float *p = NULL;
+    float t0r, t0i, t1r, t1i, t2r, t2i, t3r, t3i;
+    float br = 0.f;
+    float bi = 0.f;
+    uint32_t base = 0;
+    uint32_t h = 0;
+    uint32_t j = 0;
+
+    for (base = 0; base < 2 * half_m; base += 8)
+    {
+        t0r = data[base] + data[base + 2];
+        t0i = data[base + 1] + data[base + 3];
+        t1r = data[base] - data[base + 2];
+        t1i = data[base + 1] - data[base + 3];
+        t2r = data[base + 4] + data[base + 6];
+        t2i = data[base + 5] + data[base + 7];
+        /* times -i */
+        t3r = data[base + 5] - data[base + 7];
+        t3i = data[base + 6] - data[base + 4];
+        data[base] = t0r + t2r;
+        data[base + 1] = t0i + t2i;
+        data[base + 4] = t0r - t2r;
+        data[base + 5] = t0i - t2i;
+        data[base + 2] = t1r + t3r;
+        data[base + 3] = t1i + t3i;
+        data[base + 6] = t1r - t3r;
+        data[base + 7] = t1i - t3i;
+    }
+
+    for (h = 4; 2 * h < half_m; h <<= 2)
+    {
+        w1 = twiddles_m + 2 * (h - 1);
+        w2 = twiddles_m + 2 * (2 * h - 1);
+        for (base = 0; base < half_m; base += 4 * h)
+        {
+            p = data + 2 * base;
+            for (j = 0; j < h; j++)
+            {
+                /* stage h: (j, j + h) and (j + 2h, j + 3h) */
+                br = p[2 * (j + h)] * w1[2 * j] - p[2 * (j + h) + 1] * w1[2 * j + 1];
+                bi = p[2 * (j + h)] * w1[2 * j + 1] + p[2 * (j + h) + 1] * w1[2 * j];
+                t0r = p[2 * j] + br;
+                t0i = p[2 * j + 1] + bi;
+                t1r = p[2 * j] - br;
+                t1i = p[2 * j + 1] - bi;
+                br = p[2 * (j + 3 * h)] * w1[2 * j] - p[2 * (j + 3 * h) + 1] * w1[2 * j + 1];
+                bi = p[2 * (j + 3 * h)] * w1[2 * j + 1] + p[2 * (j + 3 * h) + 1] * w1[2 * j];
+                t2r = p[2 * (j + 2 * h)] + br;
+                t2i = p[2 * (j + 2 * h) + 1] + bi;
+                t3r = p[2 * (j + 2 * h)] - br;
+                t3i = p[2 * (j + 2 * h) + 1] - bi;
+                /* stage 2h: (j, j + 2h) and (j + h, j + 3h) */
+                br = t2r * w2[2 * j] - t2i * w2[2 * j + 1];
+                bi = t2r * w2[2 * j + 1] + t2i * w2[2 * j];
+                p[2 * j] = t0r + br;
+                p[2 * j + 1] = t0i + bi;
+                p[2 * (j + 2 * h)] = t0r - br;
+                p[2 * (j + 2 * h) + 1] = t0i - bi;
+                /* w2[j + h] = -i w2[j] */
+                br = t3r * w2[2 * j + 1] + t3i * w2[2 * j];
+                bi = t3i * w2[2 * j + 1] - t3r * w2[2 * j];
+                p[2 * (j + h)] = t1r + br;
+                p[2 * (j + h) + 1] = t1i + bi;
+                p[2 * (j + 3 * h)] = t1r - br;
+                p[2 * (j + 3 * h) + 1] = t1i - bi;
+            }
+        }
+    }
+
+    if (h < half_m)
+    {
+        /* odd number of stages, the last one alone */
+        w1 = twiddles_m + 2 * (h - 1);
+        for (j = 0; j < h; j++)
+        {
+            br = data[2 * (j + h)] * w1[2 * j] - data[2 * (j + h) + 1] * w1[2 * j + 1];
+            bi = data[2 * (j + h)] * w1[2 * j + 1] + data[2 * (j + h) + 1] * w1[2 * j];
+            data[2 * (j + h)] = data[2 * j] - br;
+            data[2 * (j + h) + 1] = data[2 * j + 1] - bi;
+            data[2 * j] += br;
+            data[2 * j + 1] += bi;
+        }
+    }
+}
+
+/****************************************************************************
+ * power
+ *
+ * Even samples are the real parts and odd ones the imaginary parts of a
+ * complex sequence z of half_m points. With Z its FFT:
+ * X[k] = (Z[k] + conj(Z[M - k])) / 2 - i W^k (Z[k] - conj(Z[M - k])) / 2
+ * where M = half_m, W = exp(-2 i pi / size) and Z[M] = Z[0].
+ ****************************************************************************/
+void FftPlan::power(const float *input, float *work, float *power) const
+{
+    uint32_t i = 0;
+    uint32_t k = 0;
+    uint32_t m = 0;
+    float er, ei, or_, oi, xr, xi;
+
+    for (i = 0; i < half_m; i++)
+    {
+        work[2 * reverse_m[i]] = input[2 * i];
+        work[2 * reverse_m[i] + 1] = input[2 * i + 1];
+    }
+    transform(work);
+
+    /* DC and Nyquist are real */
+    power[0] = (work[0] + work[1]) * (work[0] + work[1]);
+    power[half_m] = (work[0] - work[1]) * (work[0] - work[1]);
+    for (k = 1; k < half_m; k++)
+    {
+        m = half_m - k;
+        er = 0.5f * (work[2 * k] + work[2 * m]);
+        ei = 0.5f * (work[2 * k + 1] - work[2 * m + 1]);
+        or_ = 0.5f * (work[2 * k + 1] + work[2 * m + 1]);
+        oi = -0.5f * (work[2 * k] - work[2 * m]);
+        xr = er + or_ * split_m[2 * k] - oi * split_m[2 * k + 1];
+        xi = ei + or_ * split_m[2 * k + 1] + oi * split_m[2 * k];
+        power[k] = xr * xr + xi * xi;
+    }
+}
@@ -0,0 +1,84 @@
+/*****************************************************************************
+*   Copyright 2012 Vincent HERVIEUX
+*
+*   This file is part of QPicoscope.
+*
+*   QPicoscope is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU Lesser General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   any later version.
+*
+*   QPicoscope is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU Lesser General Public License for more details.
+*
+*   You should have received a copy of the GNU Lesser General Public License
+*   along with QPicoscope in files COPYING.LESSER and COPYING.
+*   If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+/**
+ * @file fftplan.h
+ * @brief Declaration of FftPlan class.
+ * Power spectrum of real samples, for one power of two size. The real
+ * input is packed in a complex FFT of half its size, bit reversal and
+ * twiddle factors of every stage are computed once by init(), so a plan
+ * is meant to be kept and used again for every record of that size.
+ * power() only reads the plan, several threads can share one.
+ * @version 0.1
+ * @date 2026, october 16
+ * @author Vincent HERVIEUX    -   10.16.2026   -   initial creation
+ */
+
+#ifndef FFTPLAN_H
+#define FFTPLAN_H
+
+#include "oscilloscope.h"
+
+#define FFT_PLAN_MIN_SIZE    16
+#define FFT_PLAN_MAX_SIZE    (1U << 24)
+
+class FftPlan
+{
+public:
+    /** @brief constructor, init() must be called before power() */
+    FftPlan();
+    /** @brief destructor */
+    ~FftPlan();
+
+    /**
+     * @brief compute the tables of a size
+     * @param[in] size: power of two in [FFT_PLAN_MIN_SIZE, FFT_PLAN_MAX_SIZE]
+     * @return false if size is not supported or memory is exhausted
+     */
+    bool init(uint32_t size);
+    /** @brief real samples per transform, 0 before init() */
+    uint32_t size(void) const { return size_m; }
+    /** @brief bins given by power(), size() / 2 + 1 */
+    uint32_t bins(void) const { return size_m / 2 + 1; }
+
+    /**
+     * @brief squared magnitude of the DFT of real samples
+     * @param[in] input: size() samples
+     * @param[in] work: size() floats of scratch, not shared between threads
+     * @param[out] power: bins() values, |X[k]|^2 from DC to Nyquist
+     */
+    void power(const float *input, float *work, float *power) const;
+
+private:
+    FftPlan(const FftPlan&);
+    FftPlan& operator=(const FftPlan&);
+    /** @brief in place complex FFT of half_m points in bit reversed order */
+    void transform(float *data) const;
+
+    uint32_t size_m;
+    /** @brief points of the complex FFT */
+    uint32_t half_m;
+    uint32_t *reverse_m;
+    /** @brief exp(-i pi j / h) for j < h, stage after stage h = 1, 2, 4..., re and im interleaved */
+    float *twiddles_m;
+    /** @brief exp(-2 i pi k / size) for k < half_m, to split the packed spectrum */
+    float *split_m;
+};
+
+#endif // FFTPLAN_H
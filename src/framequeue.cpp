@@ -0,0 +1,315 @@
+/*****************************************************************************
+*   Copyright 2012 Vincent HERVIEUX
+*
+*   This file is part of QPicoscope.
+*
+*   QPicoscope is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU Lesser General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   any later version.
+*
+*   QPicoscope is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU Lesser General Public License for more details.
+*
+*   You should have received a copy of the GNU Lesser General Public License
+*   along with QPicoscope in files COPYING.LESSER and COPYING.
+*   If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+/**
+ * @file framequeue.cpp
+ * @brief Definition of FrameQueue class.
+ * @version 0.1
+ * @date 2026, october 16
+ * @author Vincent HERVIEUX    -   10.16.2026   -   initial creation
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "framequeue.h"
+
+/****************************************************************************
+ *
+ * constructor
+ *
+ ****************************************************************************/
+FrameQueue::FrameQueue(uint32_t depth, uint32_t nb_points) :
+    frames_m(NULL),
+    depth_m(depth < 2 ? 2 : depth),
+    head_m(0),
+    published_m(0),
+    dropped_m(0),
+    tail_m(0),
+    taken_m(0),
+    skipped_m(0),
+    holding_m(false)
+{
+    uint32_t slot = 0;
+    uint8_t ch = 0;
+
+    memset(captures_m, 0, sizeof(captures_m));
+    frames_m = (frame_t*)calloc(depth_m, sizeof(frame_t));
+    if(NULL == frames_m)
+    {
+        ERROR("cannot allocate %u frames\n", depth_m);
+        depth_m = 0;
+        return;
+    }
+    /* preallocate every slot so the producer does not allocate in steady state */
+    for(slot = 0; slot < depth_m; slot++)
+    {
+        for(ch = 0; ch < FRAME_QUEUE_MAX_CHANNELS; ch++)
+        {
+            reserve(&frames_m[slot].channels[ch], nb_points);
+            reserveRaw(&frames_m[slot].channels[ch], nb_points);
+        }
+    }
+}
+
+/****************************************************************************
+ *
+ * destructor
+ *
+ ****************************************************************************/
+FrameQueue::~FrameQueue()
+{
+    uint32_t slot = 0;
+    uint8_t ch = 0;
+
+    if(NULL == frames_m)
+        return;
+    for(slot = 0; slot < depth_m; slot++)
+    {
+        for(ch = 0; ch < FRAME_QUEUE_MAX_CHANNELS; ch++)
+        {
+            free(frames_m[slot].channels[ch].x);
+            free(frames_m[slot].channels[ch].y);
+            free(frames_m[slot].channels[ch].raw);
+        }
+    }
+    free(frames_m);
+}
+
+/****************************************************************************
+ * reserve
+ *
+ * Grow a channel of a slot owned by the caller.
+ ****************************************************************************/
+bool FrameQueue::reserve(channel_frame_t *channel, uint32_t nb_points)
+{
+    double *x = NULL;
+    double *y = NULL;
+
+    if(channel->capacity >= nb_points)
+        return true;
+
+    x = (double*)realloc(channel->x, nb_points * sizeof(double));
+    if(NULL == x)
+        return false;
+    channel->x = x;
+    y = (double*)realloc(channel->y, nb_points * sizeof(double));
+    if(NULL == y)
+        return false;
+    channel->y = y;
+    channel->capacity = nb_points;
+    return true;
+}
+
+/****************************************************************************
+ * reserveRaw
+ ****************************************************************************/
+bool FrameQueue::reserveRaw(channel_frame_t *channel, uint32_t nb_points)
+{
+    int16_t *raw = NULL;
+
+    if(channel->raw_capacity >= nb_points)
+        return true;
+
+    raw = (int16_t*)realloc(channel->raw, nb_points * sizeof(int16_t));
+    if(NULL == raw)
+        return false;
+    channel->raw = raw;
+    channel->raw_capacity = nb_points;
+    return true;
+}
+
+/****************************************************************************
+ * producerChannel
+ *
+ * The slot at head is never visible to the consumer: publish() refuses to
+ * move head onto a slot the consumer may still read.
+ ****************************************************************************/
+FrameQueue::channel_frame_t* FrameQueue::producerChannel(uint8_t channel_id)
+{
+    if((0 == channel_id) || (channel_id > FRAME_QUEUE_MAX_CHANNELS))
+    {
+        ERROR("invalid channel id : %d\n", channel_id);
+        return NULL;
+    }
+    if(NULL == frames_m)
+    {
+        ERROR("invalid frame\n");
+        return NULL;
+    }
+    return &frames_m[head_m % depth_m].channels[channel_id - 1];
+}
+
+/****************************************************************************
+ * setChannel
+ ****************************************************************************/
+int8_t FrameQueue::setChannel(uint8_t channel_id, const double *x_data, const double *y_data, uint32_t nb_points)
+{
+    channel_frame_t *channel = producerChannel(channel_id);
+
+    if(NULL == channel)
+        return -1;
+    if((nb_points > 0) && ((NULL == x_data) || (NULL == y_data)))
+    {
+        ERROR("invalid data\n");
+        return -1;
+    }
+    if(!reserve(channel, nb_points))
+    {
+        ERROR("cannot grow channel %d to %u points\n", channel_id, nb_points);
+        return -1;
+    }
+    memcpy(channel->x, x_data, nb_points * sizeof(double));
+    memcpy(channel->y, y_data, nb_points * sizeof(double));
+    channel->nb_points = nb_points;
+    channel->is_raw = false;
+    channel->capture = ++captures_m[channel_id - 1];
+    frames_m[head_m % depth_m].channel_mask |= (uint8_t)(1 << (channel_id - 1));
+    return 0;
+}
+
+/****************************************************************************
+ * setRawChannel
+ ****************************************************************************/
+int8_t FrameQueue::setRawChannel(uint8_t channel_id, const int16_t *raw, uint32_t nb_points,
+                                 float scale, float offset, double x_origin, double x_interval, bool append)
+{
+    channel_frame_t *channel = producerChannel(channel_id);
+
+    if(NULL == channel)
+        return -1;
+    if((nb_points > 0) && (NULL == raw))
+    {
+        ERROR("invalid data\n");
+        return -1;
+    }
+    if(!reserveRaw(channel, nb_points))
+    {
+        ERROR("cannot grow channel %d to %u points\n", channel_id, nb_points);
+        return -1;
+    }
+    memcpy(channel->raw, raw, nb_points * sizeof(int16_t));
+    channel->nb_points = nb_points;
+    channel->scale = scale;
+    channel->offset = offset;
+    channel->x_origin = x_origin;
+    channel->x_interval = x_interval;
+    channel->is_raw = true;
+    /* a skipped or dropped frame of another capture is never taken for this one */
+    if(!append || (0 == captures_m[channel_id - 1]))
+        captures_m[channel_id - 1]++;
+    channel->capture = captures_m[channel_id - 1];
+    frames_m[head_m % depth_m].channel_mask |= (uint8_t)(1 << (channel_id - 1));
+    return 0;
+}
+
+/****************************************************************************
+ * publish
+ ****************************************************************************/
+bool FrameQueue::publish(void)
+{
+    frame_t *frame = NULL;
+    uint64_t tail = 0;
+
+    if(NULL == frames_m)
+        return false;
+
+    frame = &frames_m[head_m % depth_m];
+    if(0 == frame->channel_mask)
+        return false;
+
+    tail = ATOMIC_LOAD_ACQUIRE(&tail_m);
+    if((head_m - tail) >= (depth_m - 1))
+    {
+        /* Consumer is late: keep the slot and let the next block overwrite it */
+        frame->channel_mask = 0;
+        ATOMIC_STORE_RELAXED(&dropped_m, dropped_m + 1);
+        return false;
+    }
+
+    frame->sequence = head_m;
+    ATOMIC_STORE_RELEASE(&head_m, head_m + 1);
+    ATOMIC_STORE_RELAXED(&published_m, published_m + 1);
+    /* next slot is free (see above), start it empty */
+    frames_m[head_m % depth_m].channel_mask = 0;
+    return true;
+}
+
+/****************************************************************************
+ * takeLatest
+ ****************************************************************************/
+const FrameQueue::frame_t* FrameQueue::takeLatest(void)
+{
+    uint64_t head = 0;
+
+    if(NULL == frames_m)
+        return NULL;
+    if(holding_m)
+        release();
+
+    head = ATOMIC_LOAD_ACQUIRE(&head_m);
+    if(head == tail_m)
+        return NULL;
+
+    ATOMIC_STORE_RELAXED(&skipped_m, skipped_m + (head - 1 - tail_m));
+    taken_m = head - 1;
+    holding_m = true;
+    return &frames_m[taken_m % depth_m];
+}
+
+/****************************************************************************
+ * takeNext
+ ****************************************************************************/
+const FrameQueue::frame_t* FrameQueue::takeNext(void)
+{
+    if(NULL == frames_m)
+        return NULL;
+    if(holding_m)
+        release();
+
+    if(ATOMIC_LOAD_ACQUIRE(&head_m) == tail_m)
+        return NULL;
+
+    taken_m = tail_m;
+    holding_m = true;
+    return &frames_m[taken_m % depth_m];
+}
+
+/****************************************************************************
+ * release
+ ****************************************************************************/
+void FrameQueue::release(void)
+{
+    if(!holding_m)
+        return;
+    holding_m = false;
+    ATOMIC_STORE_RELEASE(&tail_m, taken_m + 1);
+}
+
+/****************************************************************************
+ * getStats
+ ****************************************************************************/
+void FrameQueue::getStats(stats_t *stats) const
+{
+    if(NULL == stats)
+        return;
+    stats->published = ATOMIC_LOAD_RELAXED(&published_m);
+    stats->dropped   = ATOMIC_LOAD_RELAXED(&dropped_m);
+    stats->skipped   = ATOMIC_LOAD_RELAXED(&skipped_m);
+}
@@ -0,0 +1,156 @@
+/*****************************************************************************
+*   Copyright 2012 Vincent HERVIEUX
+*
+*   This file is part of QPicoscope.
+*
+*   QPicoscope is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU Lesser General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   any later version.
+*
+*   QPicoscope is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU Lesser General Public License for more details.
+*
+*   You should have received a copy of the GNU Lesser General Public License
+*   along with QPicoscope in files COPYING.LESSER and COPYING.
+*   If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+/**
+ * @file framequeue.h
+ * @brief Declaration of FrameQueue class.
+ * Bounded single producer / single consumer ring of preallocated frames.
+ * The acquisition thread fills and publishes frames, the GUI thread takes
+ * the newest one whenever it is ready to draw, or every frame in turn when
+ * none may be missed.
+ * @version 0.1
+ * @date 2026, october 16
+ * @author Vincent HERVIEUX    -   10.16.2026   -   initial creation
+ */
+
+#ifndef FRAMEQUEUE_H
+#define FRAMEQUEUE_H
+
+#include "oscilloscope.h"
+#include "atomic-ops.h"
+
+#define FRAME_QUEUE_DEPTH        4
+#define FRAME_QUEUE_MAX_CHANNELS 4
+
+class FrameQueue
+{
+public:
+    /**
+     * @brief public typedef declarations
+     */
+    typedef struct
+    {
+        double   *x;
+        double   *y;
+        uint32_t nb_points;
+        uint32_t capacity;
+        /** @brief set when the points are in raw, x and y are not used then */
+        bool     is_raw;
+        int16_t  *raw;
+        uint32_t raw_capacity;
+        float    scale;
+        float    offset;
+        double   x_origin;
+        double   x_interval;
+        /** @brief same in every table of a capture, see setRawChannel() */
+        uint64_t capture;
+    } channel_frame_t;
+
+    typedef struct
+    {
+        /** @brief bit n is set when channel n+1 was filled in this frame */
+        uint8_t         channel_mask;
+        uint64_t        sequence;
+        channel_frame_t channels[FRAME_QUEUE_MAX_CHANNELS];
+    } frame_t;
+
+    typedef struct
+    {
+        /** @brief frames handed to the consumer */
+        uint64_t published;
+        /** @brief frames discarded by the producer because the ring was full */
+        uint64_t dropped;
+        /** @brief published frames the consumer never looked at */
+        uint64_t skipped;
+    } stats_t;
+
+    /**
+     * @brief constructor
+     * @param[in] depth: number of slots, depth - 1 frames can be pending
+     * @param[in] nb_points: points preallocated per channel and per slot
+     */
+    FrameQueue(uint32_t depth = FRAME_QUEUE_DEPTH, uint32_t nb_points = 1024);
+    /** @brief destructor */
+    ~FrameQueue();
+
+    /**
+     * @brief producer side: copy one channel in the frame being built
+     * @param[in] channel_id: 1 for channel A, 2 for channel B, etc
+     * @return 0 if successful, -1 in case of error
+     */
+    int8_t setChannel(uint8_t channel_id, const double *x_data, const double *y_data, uint32_t nb_points);
+    /**
+     * @brief producer side: copy the ADC counts of one channel in the frame being built
+     * Only 2 bytes per point are copied, see DrawData::setRawData() for the parameters.
+     * The table gets the capture of the previous one of the channel when
+     * append is set, a new capture otherwise.
+     * @return 0 if successful, -1 in case of error
+     */
+    int8_t setRawChannel(uint8_t channel_id, const int16_t *raw, uint32_t nb_points,
+                         float scale, float offset, double x_origin, double x_interval, bool append = false);
+    /**
+     * @brief producer side: hand the frame being built to the consumer
+     * @return true if published, false if dropped because the consumer is late
+     */
+    bool publish(void);
+
+    /**
+     * @brief consumer side: get the newest published frame
+     * Older pending frames are skipped. The frame stays valid until release().
+     * @return NULL when nothing new was published
+     */
+    const frame_t* takeLatest(void);
+    /**
+     * @brief consumer side: get the oldest published frame
+     * Nothing is skipped. The frame stays valid until release().
+     * @return NULL when nothing new was published
+     */
+    const frame_t* takeNext(void);
+    /** @brief consumer side: give back the frame returned by takeLatest() or takeNext() */
+    void release(void);
+
+    /** @brief read the counters, can be called from any thread */
+    void getStats(stats_t *stats) const;
+
+private:
+    FrameQueue(const FrameQueue&);
+    FrameQueue& operator=(const FrameQueue&);
+    bool reserve(channel_frame_t *channel, uint32_t nb_points);
+    bool reserveRaw(channel_frame_t *channel, uint32_t nb_points);
+    /** @brief channel of the frame being built, NULL if channel_id is invalid */
+    channel_frame_t* producerChannel(uint8_t channel_id);
+
+    frame_t *frames_m;
+    uint32_t depth_m;
+    char     pad0_m[CACHE_LINE_SIZE];
+    /* written by the producer only */
+    uint64_t head_m;
+    uint64_t published_m;
+    uint64_t dropped_m;
+    /** @brief last capture of each channel, 0 before the first one */
+    uint64_t captures_m[FRAME_QUEUE_MAX_CHANNELS];
+    char     pad1_m[CACHE_LINE_SIZE];
+    /* written by the consumer only */
+    uint64_t tail_m;
+    uint64_t taken_m;
+    uint64_t skipped_m;
+    bool     holding_m;
+};
+
+#endif // FRAMEQUEUE_H
@@ -38,12 +38,47 @@
 #include <QWidget>
 #include <QComboBox>
 #include <QStatusBar>
+#include <QTimer>
 #include <QtGui>
+#include <math.h>
+#include <signal.h>
+#include <string.h>
+#include <time.h>
 
 #include "screen.h"
 #include "frontpanel.h"
+#include "acquisitionmanager.h"
 #include "comborange.h"
+#include "spectrumview.h"
 
+/* measurement table refresh, in ms */
+#define FRONT_PANEL_MEASUREMENTS_PERIOD     250
+
+/* set by SIGUSR1, the stage latencies are dumped at the next statistics update */
+static volatile sig_atomic_t dump_statistics_requested = 0;
+
+static void request_statistics_dump(int signal_number)
+{
+    (void)signal_number;
+    dump_statistics_requested = 1;
+}
+
+/* value with an engineering prefix, 4 significant digits */
+static QString format_measurement(double value, const char *unit)
+{
+    static const char *prefixes[] = { "p", "n", "u", "m", "", "k", "M", "G" };
+    int exponent = 0;
+
+    if( 0. != value )
+    {
+        exponent = (int)floor(log10(fabs(value)) / 3.);
+        if( exponent < -4 )
+            exponent = -4;
+        if( exponent > 3 )
+            exponent = 3;
+    }
+    return QString("%1 %2%3").arg(value / pow(1000., exponent), 0, 'g', 4).arg(prefixes[exponent + 4]).arg(unit);
+}
 
 FrontPanel::FrontPanel(QWidget *parent)
     : QWidget(parent),
@@ -65,19 +100,36 @@ FrontPanel::FrontPanel(QWidget *parent)
     volt_channel_B_m = NULL;
     current_m = NULL;
     time_m = NULL;
+    record_m = NULL;
+    mode_m = NULL;
+    recording_m = NULL;
+    persistence_m = NULL;
+    spectrum_m = NULL;
+    spectrum_mode_m = NULL;
+    measure_m = NULL;
     trigger_m = NULL;
 
     /* initialize items */
     volt_items_m = NULL;
     current_items_m = NULL;
     time_items_m = NULL;
+    record_items_m = NULL;
+    mode_items_m = NULL;
+    recording_items_m = NULL;
+    persistence_items_m = NULL;
+    spectrum_items_m = NULL;
+    spectrum_mode_items_m = NULL;
+    measure_items_m = NULL;
     trigger_items_m = NULL;
 
     /* initialize spinbox */
     trigger_value_m = NULL;
+    interpolation_m = NULL;
+    interpolation_items_m = NULL;
 
     /* create the oscilloscope screen */
     screen_m = new Screen();
+    spectrum_view_m = new SpectrumView(screen_m->spectrumWorker());
 
     // mod the front panel depending on the picoscope capabilities
     memset(&device_info, 0, sizeof(Acquisition::device_info_t));
@@ -130,6 +182,57 @@ FrontPanel::FrontPanel(QWidget *parent)
     connect(time_m, SIGNAL(valueChanged(int)), this, SLOT(setTimeChanged(int)));
     leftLayout->addWidget(time_m);
 
+    record_m = new ComboRange(tr("RECORD LENGTH"));
+    for(uint32_t i = 0; i < record_items_m->size(); i++)
+    {
+        record_m->setValue(i, (record_items_m->at(i)).name.c_str());
+        if((record_items_m->at(i)).value == RECORD_LENGTH_DEFAULT)
+            record_m->setCurrentIndex(i);
+    }
+    // connect record length combo to the font panel
+    connect(record_m, SIGNAL(valueChanged(int)), this, SLOT(setRecordLengthChanged(int)));
+    leftLayout->addWidget(record_m);
+
+    mode_m = new ComboRange(tr("MODE"));
+    for(uint32_t i = 0; i < mode_items_m->size(); i++)
+        mode_m->setValue(i, (mode_items_m->at(i)).name.c_str());
+    // connect mode combo to the font panel
+    connect(mode_m, SIGNAL(valueChanged(int)), this, SLOT(setModeChanged(int)));
+    leftLayout->addWidget(mode_m);
+
+    recording_m = new ComboRange(tr("RECORDING"));
+    for(uint32_t i = 0; i < recording_items_m->size(); i++)
+        recording_m->setValue(i, (recording_items_m->at(i)).name.c_str());
+    // connect recording combo to the font panel
+    connect(recording_m, SIGNAL(valueChanged(int)), this, SLOT(setRecordingChanged(int)));
+    leftLayout->addWidget(recording_m);
+
+    persistence_m = new ComboRange(tr("PERSISTENCE"));
+    for(uint32_t i = 0; i < persistence_items_m->size(); i++)
+        persistence_m->setValue(i, (persistence_items_m->at(i)).name.c_str());
+    // connect persistence combo to the font panel
+    connect(persistence_m, SIGNAL(valueChanged(int)), this, SLOT(setPersistenceChanged(int)));
+    leftLayout->addWidget(persistence_m);
+
+    spectrum_m = new ComboRange(tr("SPECTRUM"));
+    for(uint32_t i = 0; i < spectrum_items_m->size(); i++)
+        spectrum_m->setValue(i, (spectrum_items_m->at(i)).name.c_str());
+    // connect spectrum combos to the font panel, both apply the two settings
+    connect(spectrum_m, SIGNAL(valueChanged(int)), this, SLOT(setSpectrumChanged(int)));
+    leftLayout->addWidget(spectrum_m);
+    spectrum_mode_m = new ComboRange(tr("SPECTRUM MODE"));
+    for(uint32_t i = 0; i < spectrum_mode_items_m->size(); i++)
+        spectrum_mode_m->setValue(i, (spectrum_mode_items_m->at(i)).name.c_str());
+    connect(spectrum_mode_m, SIGNAL(valueChanged(int)), this, SLOT(setSpectrumChanged(int)));
+    leftLayout->addWidget(spectrum_mode_m);
+
+    measure_m = new ComboRange(tr("MEASURE"));
+    for(uint32_t i = 0; i < measure_items_m->size(); i++)
+        measure_m->setValue(i, (measure_items_m->at(i)).name.c_str());
+    // connect measure combo to the font panel
+    connect(measure_m, SIGNAL(valueChanged(int)), this, SLOT(setMeasureChanged(int)));
+    leftLayout->addWidget(measure_m);
+
     current_m = new ComboRange(tr("CURRENT"));
     for(uint32_t i = 0; i < current_items_m->size(); i++)
         current_m->setValue(i, (current_items_m->at(i)).name.c_str());
@@ -158,6 +261,13 @@ FrontPanel::FrontPanel(QWidget *parent)
     // set screen values
     setTriggerChanged(0);
 
+    interpolation_m = new ComboRange(tr("INTERPOLATION"));
+    for(uint32_t i = 0; i < interpolation_items_m->size(); i++)
+        interpolation_m->setValue(i, (interpolation_items_m->at(i)).name.c_str());
+    // connect interpolation combo to the font panel
+    connect(interpolation_m, SIGNAL(valueChanged(int)), this, SLOT(setInterpolationChanged(int)));
+    leftLayout->addWidget(interpolation_m);
+
     screenBox->setFrameStyle(QFrame::WinPanel | QFrame::Sunken);
 
     (void) new QShortcut(Qt::CTRL + Qt::Key_Q, this, SLOT(close()));
@@ -165,6 +275,11 @@ FrontPanel::FrontPanel(QWidget *parent)
     topLayout->addStretch(1);
 
     screenLayout->addWidget(screen_m);
+    screenLayout->addWidget(spectrum_view_m);
+    measurements_m = new QLabel;
+    measurements_m->setTextFormat(Qt::RichText);
+    measurements_m->hide();
+    screenLayout->addWidget(measurements_m);
     screenBox->setLayout(screenLayout);
 
     gridLayout->addLayout(topLayout, 0, 1);
@@ -175,26 +290,53 @@ FrontPanel::FrontPanel(QWidget *parent)
 
 
     /* initialize acquisition search */
-    QThread* searchForAcquisitionDeviceThread = new QThread(this);
-    SearchForAcquisitionDeviceWorker* searchForAcquisitionDeviceWorker = new SearchForAcquisitionDeviceWorker(this);    
+    searchForAcquisitionDeviceThread = new QThread(this);
+    searchForAcquisitionDeviceWorker = new SearchForAcquisitionDeviceWorker(this);
     connect(searchForAcquisitionDeviceThread, 
             SIGNAL(started()), 
             searchForAcquisitionDeviceWorker, 
             SLOT(searchForAcquisitionDevice()));
-    connect(searchForAcquisitionDeviceThread, 
-            SIGNAL(finished()), 
-            searchForAcquisitionDeviceWorker, 
-            SLOT(stopSearchForAcquisitionDevice()));
     connect(searchForAcquisitionDeviceWorker,
             SIGNAL(newStatusBarMessage(QString)), 
             this,
             SLOT(setStatusBarMessage(QString)));
     searchForAcquisitionDeviceWorker->moveToThread(searchForAcquisitionDeviceThread);
     searchForAcquisitionDeviceThread->start();
+
+    /* pipeline throughput in the status bar, stage latencies on demand */
+    memset(&last_frame_stats_m, 0, sizeof(FrameQueue::stats_t));
+    memset(&last_stream_stats_m, 0, sizeof(StreamRing::stats_t));
+    memset(&last_persistence_stats_m, 0, sizeof(PersistenceWorker::stats_t));
+    memset(&last_spectrum_stats_m, 0, sizeof(SpectrumWorker::stats_t));
+    memset(&last_measurement_stats_m, 0, sizeof(MeasurementWorker::stats_t));
+    last_statistics_ns_m = PipelineStats::now_ns();
+    statistics_m = new QLabel;
+    ((QMainWindow*)(parent_m))->statusBar()->addPermanentWidget(statistics_m);
+    statistics_timer_m = new QTimer(this);
+    connect(statistics_timer_m, SIGNAL(timeout()), this, SLOT(updateStatistics()));
+    statistics_timer_m->start(1000);
+    /* measurements are computed on their own thread, the table only pulls them */
+    last_measurement_count_m = 0;
+    measurements_timer_m = new QTimer(this);
+    connect(measurements_timer_m, SIGNAL(timeout()), this, SLOT(updateMeasurements()));
+    (void) new QShortcut(Qt::CTRL + Qt::Key_D, this, SLOT(dumpStatistics()));
+#ifdef SIGUSR1
+    signal(SIGUSR1, request_statistics_dump);
+#endif
 }
 
 FrontPanel::~FrontPanel()
 {
+    /*
+     * The search blocks its thread, no queued call would reach it: wake it
+     * from here, then let the thread end before the widgets it sets go.
+     */
+    searchForAcquisitionDeviceWorker->stopSearchForAcquisitionDevice();
+    searchForAcquisitionDeviceThread->quit();
+    searchForAcquisitionDeviceThread->wait();
+    delete searchForAcquisitionDeviceWorker;
+    searchForAcquisitionDeviceWorker = NULL;
+
     /* delete ComboRanges */
     if( NULL != volt_channel_A_m )
         delete volt_channel_A_m;
@@ -204,6 +346,20 @@ FrontPanel::~FrontPanel()
         delete current_m;
     if( NULL != time_m )
         delete time_m;
+    if( NULL != record_m )
+        delete record_m;
+    if( NULL != mode_m )
+        delete mode_m;
+    if( NULL != recording_m )
+        delete recording_m;
+    if( NULL != persistence_m )
+        delete persistence_m;
+    if( NULL != spectrum_m )
+        delete spectrum_m;
+    if( NULL != spectrum_mode_m )
+        delete spectrum_mode_m;
+    if( NULL != measure_m )
+        delete measure_m;
     if( NULL != trigger_m )
         delete trigger_m;
 
@@ -214,16 +370,33 @@ FrontPanel::~FrontPanel()
         delete current_items_m;
     if( NULL != time_items_m )
         delete time_items_m;
+    if( NULL != record_items_m )
+        delete record_items_m;
+    if( NULL != mode_items_m )
+        delete mode_items_m;
+    if( NULL != recording_items_m )
+        delete recording_items_m;
+    if( NULL != persistence_items_m )
+        delete persistence_items_m;
+    if( NULL != spectrum_items_m )
+        delete spectrum_items_m;
+    if( NULL != spectrum_mode_items_m )
+        delete spectrum_mode_items_m;
+    if( NULL != measure_items_m )
+        delete measure_items_m;
     if( NULL != trigger_items_m )
         delete trigger_items_m;
     if( NULL != trigger_value_m )
         delete trigger_value_m;
+    if( NULL != interpolation_m )
+        delete interpolation_m;
+    if( NULL != interpolation_items_m )
+        delete interpolation_items_m;
 
-    /* delete acquisition */
+    /* close acquisition units, they belong to the manager */
     if(NULL != acquisition_m)
     {
-        acquisition_m->stop();
-        delete acquisition_m;
+        AcquisitionManager::get_instance()->close_all();
         acquisition_m = NULL;
     }
 }
@@ -232,8 +405,16 @@ void FrontPanel::create_menu_items()
 {
     volt_item_t new_volt_item;
     time_item_t new_time_item;
+    record_item_t new_record_item;
+    mode_item_t new_mode_item;
+    recording_item_t new_recording_item;
+    persistence_item_t new_persistence_item;
+    spectrum_item_t new_spectrum_item;
+    spectrum_mode_item_t new_spectrum_mode_item;
+    measure_item_t new_measure_item;
     current_item_t new_current_item;
     trigger_item_t new_trigger_item;
+    interpolation_item_t new_interpolation_item;
 
     /* create voltage items */
     volt_items_m = new std::vector<volt_item_t>();
@@ -363,6 +544,121 @@ void FrontPanel::create_menu_items()
     new_time_item.value = 1000.;
     time_items_m->push_back(new_time_item);
 
+    /* create record length items, the unit memory may hold less */
+    record_items_m = new std::vector<record_item_t>();
+    new_record_item.name = "1k samples";
+    new_record_item.value = 1024;
+    record_items_m->push_back(new_record_item);
+    new_record_item.name = "16k samples";
+    new_record_item.value = 16 * 1024;
+    record_items_m->push_back(new_record_item);
+    new_record_item.name = "128k samples";
+    new_record_item.value = 128 * 1024;
+    record_items_m->push_back(new_record_item);
+    new_record_item.name = "1M samples";
+    new_record_item.value = 1024 * 1024;
+    record_items_m->push_back(new_record_item);
+    new_record_item.name = "16M samples";
+    new_record_item.value = 16 * 1024 * 1024;
+    record_items_m->push_back(new_record_item);
+    new_record_item.name = "Max";
+    new_record_item.value = UINT32_MAX;
+    record_items_m->push_back(new_record_item);
+
+    /* create acquisition mode items, block captures first */
+    mode_items_m = new std::vector<mode_item_t>();
+    new_mode_item.name = "Block";
+    new_mode_item.streaming = false;
+    mode_items_m->push_back(new_mode_item);
+    new_mode_item.name = "Streaming";
+    new_mode_item.streaming = true;
+    mode_items_m->push_back(new_mode_item);
+
+    /* create recording items, only the stream is recorded */
+    recording_items_m = new std::vector<recording_item_t>();
+    new_recording_item.name = "Off";
+    new_recording_item.recording = false;
+    recording_items_m->push_back(new_recording_item);
+    new_recording_item.name = "On";
+    new_recording_item.recording = true;
+    recording_items_m->push_back(new_recording_item);
+
+    /* create persistence items, decay is the time for the counts to fall to 1/e */
+    persistence_items_m = new std::vector<persistence_item_t>();
+    new_persistence_item.name = "Off";
+    new_persistence_item.enabled = false;
+    new_persistence_item.decay = PERSISTENCE_INFINITE;
+    persistence_items_m->push_back(new_persistence_item);
+    new_persistence_item.name = "100 ms";
+    new_persistence_item.enabled = true;
+    new_persistence_item.decay = 0.1;
+    persistence_items_m->push_back(new_persistence_item);
+    new_persistence_item.name = "1 s";
+    new_persistence_item.decay = 1.;
+    persistence_items_m->push_back(new_persistence_item);
+    new_persistence_item.name = "10 s";
+    new_persistence_item.decay = 10.;
+    persistence_items_m->push_back(new_persistence_item);
+    new_persistence_item.name = "Infinite";
+    new_persistence_item.decay = PERSISTENCE_INFINITE;
+    persistence_items_m->push_back(new_persistence_item);
+
+    /* create spectrum items, the first one is the default */
+    spectrum_items_m = new std::vector<spectrum_item_t>();
+    new_spectrum_item.name = "Off";
+    new_spectrum_item.enabled = false;
+    new_spectrum_item.window = SpectrumWorker::E_WINDOW_HANN;
+    spectrum_items_m->push_back(new_spectrum_item);
+    new_spectrum_item.enabled = true;
+    for(uint8_t window = 0; window < SpectrumWorker::E_WINDOW_MAX; window++)
+    {
+        new_spectrum_item.name = SpectrumWorker::windowName((SpectrumWorker::window_e)window);
+        new_spectrum_item.window = (SpectrumWorker::window_e)window;
+        spectrum_items_m->push_back(new_spectrum_item);
+    }
+    spectrum_mode_items_m = new std::vector<spectrum_mode_item_t>();
+    new_spectrum_mode_item.name = "Normal";
+    new_spectrum_mode_item.mode = SpectrumWorker::E_MODE_NORMAL;
+    new_spectrum_mode_item.averages = 1;
+    spectrum_mode_items_m->push_back(new_spectrum_mode_item);
+    new_spectrum_mode_item.name = "Average 4";
+    new_spectrum_mode_item.mode = SpectrumWorker::E_MODE_AVERAGE;
+    new_spectrum_mode_item.averages = 4;
+    spectrum_mode_items_m->push_back(new_spectrum_mode_item);
+    new_spectrum_mode_item.name = "Average 16";
+    new_spectrum_mode_item.averages = 16;
+    spectrum_mode_items_m->push_back(new_spectrum_mode_item);
+    new_spectrum_mode_item.name = "Average 64";
+    new_spectrum_mode_item.averages = 64;
+    spectrum_mode_items_m->push_back(new_spectrum_mode_item);
+    new_spectrum_mode_item.name = "Max hold";
+    new_spectrum_mode_item.mode = SpectrumWorker::E_MODE_MAX_HOLD;
+    new_spectrum_mode_item.averages = 1;
+    spectrum_mode_items_m->push_back(new_spectrum_mode_item);
+
+    /* create measure items, the first one is the default */
+    measure_items_m = new std::vector<measure_item_t>();
+    new_measure_item.name = "Off";
+    new_measure_item.measures = 0;
+    measure_items_m->push_back(new_measure_item);
+    new_measure_item.name = "Amplitude";
+    new_measure_item.measures = MEASUREMENT_BIT(MeasurementScan::E_MEASURE_VPP) |
+                                MEASUREMENT_BIT(MeasurementScan::E_MEASURE_MEAN) |
+                                MEASUREMENT_BIT(MeasurementScan::E_MEASURE_RMS);
+    measure_items_m->push_back(new_measure_item);
+    new_measure_item.name = "Timing";
+    new_measure_item.measures = MEASUREMENT_BIT(MeasurementScan::E_MEASURE_FREQUENCY) |
+                                MEASUREMENT_BIT(MeasurementScan::E_MEASURE_PERIOD) |
+                                MEASUREMENT_BIT(MeasurementScan::E_MEASURE_DUTY);
+    measure_items_m->push_back(new_measure_item);
+    new_measure_item.name = "Edges";
+    new_measure_item.measures = MEASUREMENT_BIT(MeasurementScan::E_MEASURE_RISE) |
+                                MEASUREMENT_BIT(MeasurementScan::E_MEASURE_FALL);
+    measure_items_m->push_back(new_measure_item);
+    new_measure_item.name = "All";
+    new_measure_item.measures = MEASUREMENT_BIT(MeasurementScan::E_MEASURE_MAX) - 1;
+    measure_items_m->push_back(new_measure_item);
+
     /* create current items */
     current_items_m = new std::vector<current_item_t>();
     new_current_item.name = "AC";
@@ -384,6 +680,18 @@ void FrontPanel::create_menu_items()
     new_trigger_item.value = E_TRIGGER_FALLING;
     trigger_items_m->push_back(new_trigger_item);
 
+    /* create interpolation items, the first one is the default */
+    interpolation_items_m = new std::vector<interpolation_item_t>();
+    new_interpolation_item.name = "Linear";
+    new_interpolation_item.method = TriggerInterpolator::E_METHOD_LINEAR;
+    interpolation_items_m->push_back(new_interpolation_item);
+    new_interpolation_item.name = "Sin(x)/x";
+    new_interpolation_item.method = TriggerInterpolator::E_METHOD_SINC;
+    interpolation_items_m->push_back(new_interpolation_item);
+    new_interpolation_item.name = "Off";
+    new_interpolation_item.method = TriggerInterpolator::E_METHOD_NONE;
+    interpolation_items_m->push_back(new_interpolation_item);
+
 }
 
 void FrontPanel::setVoltChannelAChanged(int comboIndex)
@@ -392,9 +700,7 @@ void FrontPanel::setVoltChannelAChanged(int comboIndex)
     screen_m->setVoltCaliber((volt_items_m->at(comboIndex)).value);
     if( NULL != acquisition_m )
     {
-        acquisition_m->stop();
-        acquisition_m->set_voltages(Acquisition::CHANNEL_A, (volt_items_m->at(comboIndex)).value);
-        acquisition_m->start();
+        acquisition_m->request_voltages(Acquisition::CHANNEL_A, (volt_items_m->at(comboIndex)).value);
     }
 }
 
@@ -405,9 +711,7 @@ void FrontPanel::setVoltChannelBChanged(int comboIndex)
     //screen_m->setVoltCaliber((volt_items_m->at(comboIndex)).value);
     if( NULL != acquisition_m )
     {
-        acquisition_m->stop();
-        acquisition_m->set_voltages(Acquisition::CHANNEL_B, (volt_items_m->at(comboIndex)).value);
-        acquisition_m->start();
+        acquisition_m->request_voltages(Acquisition::CHANNEL_B, (volt_items_m->at(comboIndex)).value);
     }
 }
 
@@ -417,9 +721,88 @@ void FrontPanel::setTimeChanged(int comboIndex)
     screen_m->setTimeCaliber((time_items_m->at(comboIndex)).value);
     if( NULL != acquisition_m )
     {
-        acquisition_m->stop();
-        acquisition_m->set_timebase((time_items_m->at(comboIndex)).value);
-        acquisition_m->start();
+        acquisition_m->request_timebase((time_items_m->at(comboIndex)).value);
+    }
+}
+
+void FrontPanel::setRecordLengthChanged(int comboIndex)
+{
+    DEBUG("Combo index %d\n", comboIndex);
+    if( NULL != acquisition_m )
+    {
+        acquisition_m->request_record_length((record_items_m->at(comboIndex)).value);
+    }
+}
+
+void FrontPanel::setModeChanged(int comboIndex)
+{
+    DEBUG("Combo index %d\n", comboIndex);
+    if( NULL != acquisition_m )
+    {
+        acquisition_m->request_streaming((mode_items_m->at(comboIndex)).streaming);
+    }
+}
+
+void FrontPanel::setRecordingChanged(int comboIndex)
+{
+    char path[64];
+    time_t now = time(NULL);
+
+    DEBUG("Combo index %d\n", comboIndex);
+    if( NULL == acquisition_m )
+    {
+        return;
+    }
+    if( (recording_items_m->at(comboIndex)).recording )
+    {
+        strftime(path, sizeof(path), "qpicoscope-%Y%m%d-%H%M%S.qpcap", localtime(&now));
+        if( acquisition_m->start_recording(path) )
+            setStatusBarMessage(tr("Recording the stream in %1").arg(path));
+        else
+            setStatusBarMessage(tr("Cannot record in %1").arg(path));
+    }
+    else
+    {
+        acquisition_m->stop_recording();
+    }
+}
+
+void FrontPanel::setPersistenceChanged(int comboIndex)
+{
+    DEBUG("Combo index %d\n", comboIndex);
+    screen_m->setPersistence((persistence_items_m->at(comboIndex)).enabled,
+                             (persistence_items_m->at(comboIndex)).decay);
+}
+
+void FrontPanel::setSpectrumChanged(int comboIndex)
+{
+    const spectrum_item_t *spectrum = NULL;
+    const spectrum_mode_item_t *mode = NULL;
+
+    DEBUG("Combo index %d\n", comboIndex);
+    if( (NULL == spectrum_m) || (NULL == spectrum_mode_m) )
+        return;
+    spectrum = &(spectrum_items_m->at(spectrum_m->value()));
+    mode = &(spectrum_mode_items_m->at(spectrum_mode_m->value()));
+    screen_m->setSpectrum(spectrum->enabled, spectrum->window, mode->mode, mode->averages);
+    spectrum_view_m->setActive(screen_m->isSpectrumEnabled());
+}
+
+void FrontPanel::setMeasureChanged(int comboIndex)
+{
+    DEBUG("Combo index %d\n", comboIndex);
+    screen_m->setMeasures((measure_items_m->at(comboIndex)).measures);
+    if( screen_m->isMeasurementEnabled() )
+    {
+        last_measurement_count_m = 0;
+        measurements_m->clear();
+        measurements_m->show();
+        measurements_timer_m->start(FRONT_PANEL_MEASUREMENTS_PERIOD);
+    }
+    else
+    {
+        measurements_timer_m->stop();
+        measurements_m->hide();
     }
 }
 
@@ -430,9 +813,7 @@ void FrontPanel::setCurrentChanged(int comboIndex)
     // TODO set acquisition accordingly
     if ( NULL != acquisition_m )
     {
-        acquisition_m->stop();
-        acquisition_m->set_DC_coupled((current_items_m->at(comboIndex)).value);
-        acquisition_m->start();
+        acquisition_m->request_DC_coupled((current_items_m->at(comboIndex)).value);
     }
 }
 
@@ -447,8 +828,7 @@ void FrontPanel::setTriggerChanged(int comboIndex)
     }
     if( NULL != acquisition_m )
     {
-        acquisition_m->stop();
-        acquisition_m->set_trigger((trigger_items_m->at(comboIndex)).value, trigger_value_m->value());
+        acquisition_m->request_trigger((trigger_items_m->at(comboIndex)).value, trigger_value_m->value());
         /* If Auto trigger is set, hide trigger input 
          * and if not set, show trigger input dialog.
          */
@@ -460,7 +840,6 @@ void FrontPanel::setTriggerChanged(int comboIndex)
         {
             trigger_value_m->show();
         }
-        acquisition_m->start();
     }
 }
 
@@ -470,7 +849,148 @@ void FrontPanel::setTriggerChanged(double trigger_value)
     setTriggerChanged(trigger_m->value());
 }
 
+void FrontPanel::setInterpolationChanged(int comboIndex)
+{
+    DEBUG("Combo index %d\n", comboIndex);
+    if( NULL != acquisition_m )
+    {
+        acquisition_m->request_trigger_interpolation((interpolation_items_m->at(comboIndex)).method);
+    }
+}
+
 void FrontPanel::setStatusBarMessage(QString text)
 {
   ((QMainWindow*)(parent_m))->statusBar()->showMessage(text, 30000);
 }
+
+void FrontPanel::updateStatistics()
+{
+    PipelineStats::snapshot_t snapshot;
+    FrameQueue::stats_t frame_stats;
+    StreamRing::stats_t stream_stats;
+    PersistenceWorker::stats_t persistence_stats;
+    SpectrumWorker::stats_t spectrum_stats;
+    MeasurementWorker::stats_t measurement_stats;
+    QString text;
+    uint64_t waveforms = 0;
+    Acquisition *acquisition = NULL;
+    uint64_t now = PipelineStats::now_ns();
+    double elapsed = (now - last_statistics_ns_m) * 1E-9;
+
+    pthread_mutex_lock(&acquisitionLock_m);
+    acquisition = acquisition_m;
+    pthread_mutex_unlock(&acquisitionLock_m);
+    if( NULL == acquisition )
+        return;
+
+    screen_m->setPipelineStats(acquisition->get_pipeline_stats());
+    if( 0 != dump_statistics_requested )
+    {
+        dump_statistics_requested = 0;
+        dumpStatistics();
+    }
+
+    acquisition->get_pipeline_stats()->snapshot(&snapshot);
+    acquisition->get_stream_stats(&stream_stats);
+    screen_m->frameStats(&frame_stats);
+    screen_m->persistenceStats(&persistence_stats);
+    screen_m->spectrumStats(&spectrum_stats);
+    screen_m->measurementStats(&measurement_stats);
+    if( acquisition->is_streaming() && (elapsed > 0.) )
+    {
+        text = tr("%1 MS/s  %2 samples dropped")
+               .arg((stream_stats.written - last_stream_stats_m.written) / elapsed * 1E-6, 0, 'f', 2)
+               .arg(stream_stats.dropped - last_stream_stats_m.dropped);
+    }
+    else
+    {
+        text = tr("%1 wfm/s  %2 MS/s  dead time %3 %  %4 frames dropped")
+               .arg(snapshot.waveforms_per_s, 0, 'f', 1)
+               .arg(snapshot.samples_per_s * 1E-6, 0, 'f', 2)
+               .arg(snapshot.dead_time, 0, 'f', 1)
+               .arg(frame_stats.dropped - last_frame_stats_m.dropped);
+    }
+    if( screen_m->isPersistenceEnabled() )
+    {
+        // cost of accumulating one waveform, the worker thread keeps up below 1/wfm/s
+        waveforms = persistence_stats.waveforms - last_persistence_stats_m.waveforms;
+        text += tr("  persistence %1 us/wfm  %2 lost")
+                .arg((0 != waveforms) ? (persistence_stats.busy_ns - last_persistence_stats_m.busy_ns) * 1E-3 / waveforms : 0., 0, 'f', 1)
+                .arg(persistence_stats.dropped - last_persistence_stats_m.dropped);
+    }
+    if( screen_m->isSpectrumEnabled() && (elapsed > 0.) )
+    {
+        // one transform per channel and waveform
+        text += tr("  spectrum %1 FFT/s  %2 lost")
+                .arg((spectrum_stats.transforms - last_spectrum_stats_m.transforms) / elapsed, 0, 'f', 1)
+                .arg(spectrum_stats.dropped - last_spectrum_stats_m.dropped);
+    }
+    if( screen_m->isMeasurementEnabled() )
+    {
+        waveforms = measurement_stats.blocks - last_measurement_stats_m.blocks;
+        text += tr("  measure %1 us/wfm  %2 lost")
+                .arg((0 != waveforms) ? (measurement_stats.busy_ns - last_measurement_stats_m.busy_ns) * 1E-3 / waveforms : 0., 0, 'f', 1)
+                .arg(measurement_stats.dropped - last_measurement_stats_m.dropped);
+    }
+    statistics_m->setText(text);
+    last_frame_stats_m = frame_stats;
+    last_stream_stats_m = stream_stats;
+    last_persistence_stats_m = persistence_stats;
+    last_spectrum_stats_m = spectrum_stats;
+    last_measurement_stats_m = measurement_stats;
+    last_statistics_ns_m = now;
+}
+
+void FrontPanel::dumpStatistics()
+{
+    if( NULL == acquisition_m )
+        return;
+    acquisition_m->get_pipeline_stats()->dump(stderr);
+}
+
+void FrontPanel::updateMeasurements()
+{
+    MeasurementWorker::results_t results;
+    const MeasurementWorker::statistics_t *statistics = NULL;
+    const char *unit = NULL;
+    QString text;
+    uint64_t count = screen_m->measurementCount();
+
+    if( !screen_m->isMeasurementEnabled() || (count == last_measurement_count_m) )
+        return;
+    last_measurement_count_m = count;
+    screen_m->measurementResults(&results);
+
+    text = tr("<table cellspacing=\"4\"><tr><th></th><th align=\"left\">measure</th><th>last</th><th>mean</th>"
+              "<th>min</th><th>max</th><th>&sigma;</th><th>count</th></tr>");
+    for(uint8_t ch = 0; ch < MEASUREMENT_MAX_CHANNELS; ch++)
+    {
+        if( 0 == (results.channel_mask & (1 << ch)) )
+            continue;
+        for(uint8_t m = 0; m < MeasurementScan::E_MEASURE_MAX; m++)
+        {
+            if( 0 == (results.measures & MEASUREMENT_BIT(m)) )
+                continue;
+            statistics = &results.values[ch][m];
+            unit = MeasurementScan::measure_unit((MeasurementScan::measure_e)m);
+            text += tr("<tr><td>CH. %1</td><td>%2</td>").arg(QChar('A' + ch))
+                    .arg(MeasurementScan::measure_name((MeasurementScan::measure_e)m));
+            if( 0 == statistics->count )
+            {
+                // no edge or no swing in the blocks seen so far
+                text += tr("<td align=\"right\" colspan=\"6\">---</td></tr>");
+                continue;
+            }
+            text += tr("<td align=\"right\">%1</td><td align=\"right\">%2</td><td align=\"right\">%3</td>"
+                       "<td align=\"right\">%4</td><td align=\"right\">%5</td><td align=\"right\">%6</td></tr>")
+                    .arg(format_measurement(statistics->last, unit))
+                    .arg(format_measurement(statistics->mean, unit))
+                    .arg(format_measurement(statistics->minimum, unit))
+                    .arg(format_measurement(statistics->maximum, unit))
+                    .arg(format_measurement(MeasurementWorker::deviation(statistics), unit))
+                    .arg(statistics->count);
+        }
+    }
+    text += "</table>";
+    measurements_m->setText(text);
+}
@@ -41,10 +41,17 @@
 
 #include "oscilloscope.h"
 #include "acquisition.h"
+#include "framequeue.h"
+#include "measurementworker.h"
+#include "persistenceworker.h"
+#include "spectrumworker.h"
 #include "search-for-acquisition-device-worker.h"
 
 class ComboRange;
+class QLabel;
+class QTimer;
 class Screen;
+class SpectrumView;
 
 class FrontPanel : public QWidget
 {
@@ -65,10 +72,23 @@ protected slots:
     void setVoltChannelAChanged(int);
     void setVoltChannelBChanged(int);
     void setTimeChanged(int);
+    void setRecordLengthChanged(int);
+    void setModeChanged(int);
+    void setRecordingChanged(int);
+    void setPersistenceChanged(int);
+    void setSpectrumChanged(int);
+    void setMeasureChanged(int);
     void setCurrentChanged(int);
     void setTriggerChanged(int);
     void setTriggerChanged(double);
+    void setInterpolationChanged(int);
     void setStatusBarMessage(QString);
+    /** @brief refresh the throughput shown in the status bar, every second */
+    void updateStatistics();
+    /** @brief print the stage latencies on stderr */
+    void dumpStatistics();
+    /** @brief refresh the measurement table when new blocks were measured */
+    void updateMeasurements();
 
 private:
     /** @brief create menu items */
@@ -79,9 +99,21 @@ private:
     SearchForAcquisitionDeviceWorker* searchForAcquisitionDeviceWorker;
     /** @brief screen of the front panel */
     Screen *screen_m;
+    /** @brief spectrum of the channels, beside the screen */
+    SpectrumView *spectrum_view_m;
     /** @brief Acquisition engine of the oscilloscope */
     Acquisition* acquisition_m;
     pthread_mutex_t acquisitionLock_m;
+    /** @brief throughput in the status bar, next to the messages */
+    QLabel *statistics_m;
+    QTimer *statistics_timer_m;
+    /** @brief counters at the previous updateStatistics() */
+    FrameQueue::stats_t last_frame_stats_m;
+    StreamRing::stats_t last_stream_stats_m;
+    PersistenceWorker::stats_t last_persistence_stats_m;
+    SpectrumWorker::stats_t last_spectrum_stats_m;
+    MeasurementWorker::stats_t last_measurement_stats_m;
+    uint64_t last_statistics_ns_m;
     /** @brief voltage selection on the front panel */
     ComboRange *volt_channel_A_m;
     ComboRange *volt_channel_B_m;
@@ -99,6 +131,69 @@ private:
         double value;
     }time_item_t;
     std::vector<time_item_t> *time_items_m;
+    /** @brief record length selection on the front panel */
+    ComboRange *record_m;
+    typedef struct
+    {
+        std::string name;
+        uint32_t value;
+    }record_item_t;
+    std::vector<record_item_t> *record_items_m;
+    /** @brief block captures or continuous streaming on the front panel */
+    ComboRange *mode_m;
+    typedef struct
+    {
+        std::string name;
+        bool streaming;
+    }mode_item_t;
+    std::vector<mode_item_t> *mode_items_m;
+    /** @brief recording of the stream on the front panel */
+    ComboRange *recording_m;
+    typedef struct
+    {
+        std::string name;
+        bool recording;
+    }recording_item_t;
+    std::vector<recording_item_t> *recording_items_m;
+    /** @brief intensity graded display of every waveform on the front panel */
+    ComboRange *persistence_m;
+    typedef struct
+    {
+        std::string name;
+        bool enabled;
+        double decay;
+    }persistence_item_t;
+    std::vector<persistence_item_t> *persistence_items_m;
+    /** @brief spectrum window and how waveforms are combined on the front panel */
+    ComboRange *spectrum_m;
+    typedef struct
+    {
+        std::string name;
+        bool enabled;
+        SpectrumWorker::window_e window;
+    }spectrum_item_t;
+    std::vector<spectrum_item_t> *spectrum_items_m;
+    ComboRange *spectrum_mode_m;
+    typedef struct
+    {
+        std::string name;
+        SpectrumWorker::mode_e mode;
+        uint32_t averages;
+    }spectrum_mode_item_t;
+    std::vector<spectrum_mode_item_t> *spectrum_mode_items_m;
+    /** @brief automatic measurements on the front panel, shown under the screen */
+    ComboRange *measure_m;
+    typedef struct
+    {
+        std::string name;
+        /** @brief MEASUREMENT_BIT() of the measurements, 0 for none */
+        uint32_t measures;
+    }measure_item_t;
+    std::vector<measure_item_t> *measure_items_m;
+    QLabel *measurements_m;
+    QTimer *measurements_timer_m;
+    /** @brief results shown last, see Screen::measurementCount() */
+    uint64_t last_measurement_count_m;
     /** @brief current type selection on the front panel */
     ComboRange *current_m;
     typedef struct
@@ -116,6 +211,14 @@ private:
     }trigger_item_t;
     std::vector<trigger_item_t> *trigger_items_m;
     QDoubleSpinBox *trigger_value_m;
+    /** @brief trigger point between two samples on the front panel */
+    ComboRange *interpolation_m;
+    typedef struct
+    {
+        std::string name;
+        TriggerInterpolator::method_e method;
+    }interpolation_item_t;
+    std::vector<interpolation_item_t> *interpolation_items_m;
     /* Store the parent class */
     QWidget *parent_m;
 
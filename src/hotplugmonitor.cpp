@@ -0,0 +1,216 @@
+/*****************************************************************************
+*   Copyright 2012 Vincent HERVIEUX
+*
+*   This file is part of QPicoscope.
+*
+*   QPicoscope is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU Lesser General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   any later version.
+*
+*   QPicoscope is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU Lesser General Public License for more details.
+*
+*   You should have received a copy of the GNU Lesser General Public License
+*   along with QPicoscope in files COPYING.LESSER and COPYING.
+*   If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+/**
+ * @file hotplugmonitor.cpp
+ * @brief Definition of HotplugMonitor class.
+ * @version 0.1
+ * @date 2026, october 16
+ * @author Vincent HERVIEUX    -   10.16.2026   -   initial creation
+ */
+
+#include <unistd.h>
+#include <string.h>
+#include <stdlib.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <poll.h>
+#include <time.h>
+#include <sys/socket.h>
+#ifdef __linux__
+#include <linux/netlink.h>
+#endif
+
+#include "hotplugmonitor.h"
+
+/* kernel uevents are a header line then NUL separated KEY=value strings */
+#define UEVENT_BUFFER_SIZE   4096
+
+/****************************************************************************
+ *
+ * constructor
+ *
+ ****************************************************************************/
+HotplugMonitor::HotplugMonitor() :
+    uevent_fd_m(-1)
+{
+#ifdef __linux__
+    struct sockaddr_nl address;
+#endif
+
+    cancel_fd_m[0] = -1;
+    cancel_fd_m[1] = -1;
+    if(0 != pipe(cancel_fd_m))
+    {
+        ERROR("cannot create cancel pipe: %s\n", strerror(errno));
+        cancel_fd_m[0] = -1;
+        cancel_fd_m[1] = -1;
+    }
+    else
+    {
+        fcntl(cancel_fd_m[0], F_SETFL, O_NONBLOCK);
+        fcntl(cancel_fd_m[1], F_SETFL, O_NONBLOCK);
+    }
+
+#ifdef __linux__
+    uevent_fd_m = socket(AF_NETLINK, SOCK_DGRAM, NETLINK_KOBJECT_UEVENT);
+    if(uevent_fd_m < 0)
+    {
+        WARNING("no uevent socket (%s), polling every %.1lf s\n", strerror(errno), HOTPLUG_POLL_PERIOD);
+        return;
+    }
+    memset(&address, 0, sizeof(address));
+    address.nl_family = AF_NETLINK;
+    address.nl_pid = 0;
+    /* group 1 is the kernel uevent broadcast */
+    address.nl_groups = 1;
+    if(0 != bind(uevent_fd_m, (struct sockaddr*)&address, sizeof(address)))
+    {
+        WARNING("cannot bind uevent socket (%s), polling every %.1lf s\n", strerror(errno), HOTPLUG_POLL_PERIOD);
+        close(uevent_fd_m);
+        uevent_fd_m = -1;
+    }
+#endif
+}
+
+/****************************************************************************
+ *
+ * destructor
+ *
+ ****************************************************************************/
+HotplugMonitor::~HotplugMonitor()
+{
+    if(uevent_fd_m >= 0)
+        close(uevent_fd_m);
+    if(cancel_fd_m[0] >= 0)
+        close(cancel_fd_m[0]);
+    if(cancel_fd_m[1] >= 0)
+        close(cancel_fd_m[1]);
+}
+
+/****************************************************************************
+ * is_pico_added
+ *
+ * Looks for ACTION=add, SUBSYSTEM=usb and PRODUCT=<vendor>/<product>/<bcd>
+ * with vendor in hexadecimal without leading zeros.
+ ****************************************************************************/
+bool HotplugMonitor::is_pico_added(const char *message, int length)
+{
+    const char *key = message;
+    const char *end = message + length;
+    bool added = false;
+    bool usb = false;
+    bool pico = false;
+
+    while(key < end)
+    {
+        if(0 == strcmp(key, "ACTION=add"))
+            added = true;
+        else if(0 == strcmp(key, "SUBSYSTEM=usb"))
+            usb = true;
+        else if(0 == strncmp(key, "PRODUCT=", 8))
+            pico = (HOTPLUG_PICO_VENDOR_ID == strtoul(key + 8, NULL, 16));
+        key += strlen(key) + 1;
+    }
+    return (added && usb && pico);
+}
+
+/****************************************************************************
+ * wait
+ ****************************************************************************/
+HotplugMonitor::hotplug_e HotplugMonitor::wait(double timeout)
+{
+    struct pollfd fds[2];
+    char message[UEVENT_BUFFER_SIZE];
+    ssize_t length = 0;
+    int nfds = 0;
+    int ret = 0;
+    struct timespec now;
+    double deadline = 0.;
+    double remaining = 0.;
+
+    fds[nfds].fd = cancel_fd_m[0];
+    fds[nfds].events = POLLIN;
+    nfds++;
+    if(uevent_fd_m >= 0)
+    {
+        fds[nfds].fd = uevent_fd_m;
+        fds[nfds].events = POLLIN;
+        nfds++;
+    }
+    else
+    {
+        timeout = HOTPLUG_POLL_PERIOD;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    deadline = now.tv_sec + now.tv_nsec * 1E-9 + timeout;
+    while(true)
+    {
+        /* other uevents keep coming, do not restart the full timeout for each */
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        remaining = deadline - (now.tv_sec + now.tv_nsec * 1E-9);
+        if(remaining < 0.)
+            remaining = 0.;
+        fds[0].revents = 0;
+        fds[1].revents = 0;
+        ret = poll(fds, nfds, (int)(remaining * 1000.));
+        if(ret < 0)
+        {
+            if(EINTR == errno)
+                continue;
+            ERROR("poll failed: %s\n", strerror(errno));
+            return E_HOTPLUG_POLL;
+        }
+        if(0 == ret)
+            return (uevent_fd_m >= 0) ? E_HOTPLUG_TIMEOUT : E_HOTPLUG_POLL;
+        if(fds[0].revents & POLLIN)
+        {
+            /* drain, next wait blocks again */
+            while(read(cancel_fd_m[0], message, sizeof(message)) > 0);
+            return E_HOTPLUG_CANCELLED;
+        }
+        if((nfds > 1) && (fds[1].revents & POLLIN))
+        {
+            length = recv(uevent_fd_m, message, sizeof(message) - 1, 0);
+            if(length <= 0)
+                continue;
+            message[length] = '\0';
+            if(is_pico_added(message, (int)length))
+            {
+                DEBUG("Pico device plugged: %s\n", message);
+                return E_HOTPLUG_ADDED;
+            }
+        }
+    }
+}
+
+/****************************************************************************
+ * cancel
+ ****************************************************************************/
+void HotplugMonitor::cancel(void)
+{
+    char byte = 0;
+
+    if(cancel_fd_m[1] >= 0)
+    {
+        if(write(cancel_fd_m[1], &byte, 1) < 0)
+            ERROR("cannot cancel hotplug wait: %s\n", strerror(errno));
+    }
+}
@@ -0,0 +1,82 @@
+/*****************************************************************************
+*   Copyright 2012 Vincent HERVIEUX
+*
+*   This file is part of QPicoscope.
+*
+*   QPicoscope is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU Lesser General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   any later version.
+*
+*   QPicoscope is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU Lesser General Public License for more details.
+*
+*   You should have received a copy of the GNU Lesser General Public License
+*   along with QPicoscope in files COPYING.LESSER and COPYING.
+*   If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+/**
+ * @file hotplugmonitor.h
+ * @brief Declaration of HotplugMonitor class.
+ * Waits for a Pico Technology USB device to be plugged, listening to kernel
+ * uevents on a netlink socket. Where the socket is not available, wait()
+ * sleeps for the polling period instead and the caller probes again.
+ * @version 0.1
+ * @date 2026, october 16
+ * @author Vincent HERVIEUX    -   10.16.2026   -   initial creation
+ */
+
+#ifndef HOTPLUGMONITOR_H
+#define HOTPLUGMONITOR_H
+
+#include "oscilloscope.h"
+
+/* USB vendor id of Pico Technology */
+#define HOTPLUG_PICO_VENDOR_ID    0x0ce9
+/* seconds between two probes when uevents are not available */
+#define HOTPLUG_POLL_PERIOD       1.
+/* seconds between two probes anyway, catches probes completing late */
+#define HOTPLUG_RESCAN_PERIOD     10.
+
+class HotplugMonitor
+{
+public:
+    /**
+     * @brief public typedef declarations
+     */
+    typedef enum
+    {
+        E_HOTPLUG_ADDED = 0,    /**< a Pico device was plugged */
+        E_HOTPLUG_POLL,         /**< no uevent support, time to probe again */
+        E_HOTPLUG_TIMEOUT,      /**< nothing happened */
+        E_HOTPLUG_CANCELLED     /**< cancel() was called */
+    } hotplug_e;
+
+    /** @brief constructor, opens the uevent socket */
+    HotplugMonitor();
+    /** @brief destructor */
+    ~HotplugMonitor();
+    /** @brief true when kernel uevents are received, false when polling */
+    bool is_listening(void) const { return (uevent_fd_m >= 0); }
+    /**
+     * @brief block until a Pico device is plugged
+     * @param[in] timeout: in seconds, only used when listening to uevents
+     */
+    hotplug_e wait(double timeout = HOTPLUG_RESCAN_PERIOD);
+    /** @brief wake wait(), can be called from any thread */
+    void cancel(void);
+
+private:
+    HotplugMonitor(const HotplugMonitor&);
+    HotplugMonitor& operator=(const HotplugMonitor&);
+    /** @brief true if the uevent message announces a Pico USB device */
+    static bool is_pico_added(const char *message, int length);
+
+    int uevent_fd_m;
+    /** @brief self pipe written by cancel() */
+    int cancel_fd_m[2];
+};
+
+#endif // HOTPLUGMONITOR_H
@@ -0,0 +1,172 @@
+/*****************************************************************************
+*   Copyright 2012 Vincent HERVIEUX
+*
+*   This file is part of QPicoscope.
+*
+*   QPicoscope is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU Lesser General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   any later version.
+*
+*   QPicoscope is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU Lesser General Public License for more details.
+*
+*   You should have received a copy of the GNU Lesser General Public License
+*   along with QPicoscope in files COPYING.LESSER and COPYING.
+*   If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+/**
+ * @file latencyhistogram.cpp
+ * @brief Definition of LatencyHistogram class.
+ * @version 0.1
+ * @date 2026, october 16
+ * @author Vincent HERVIEUX    -   10.16.2026   -   initial creation
+ */
+
+#include <string.h>
+
+#include "latencyhistogram.h"
+#include "atomic-ops.h"
+
+/****************************************************************************
+ *
+ * constructor
+ *
+ ****************************************************************************/
+LatencyHistogram::LatencyHistogram() :
+    count_m(0),
+    sum_m(0)
+{
+    memset(buckets_m, 0, sizeof(buckets_m));
+}
+
+/****************************************************************************
+ * bucket_of
+ *
+ * Below 2^LATENCY_SUB_BITS a bucket holds a single value. Above, the
+ * bucket is given by the highest bit set and the LATENCY_SUB_BITS next
+ * ones.
+ ****************************************************************************/
+uint32_t LatencyHistogram::bucket_of(uint64_t ns)
+{
+    uint32_t exponent = 0;
+
+    if (ns < LATENCY_SUB_BUCKETS)
+        return (uint32_t)ns;
+    exponent = 63 - __builtin_clzll(ns);
+    if (exponent >= LATENCY_MAX_BITS)
+        return LATENCY_BUCKETS - 1;
+    return (exponent - LATENCY_SUB_BITS + 1) * LATENCY_SUB_BUCKETS +
+           (uint32_t)((ns >> (exponent - LATENCY_SUB_BITS)) & (LATENCY_SUB_BUCKETS - 1));
+}
+
+/****************************************************************************
+ * bucket_top
+ ****************************************************************************/
+uint64_t LatencyHistogram::bucket_top(uint32_t bucket)
+{
+    uint32_t exponent = 0;
+    uint64_t sub = 0;
+
+    if (bucket < LATENCY_SUB_BUCKETS)
+        return bucket;
+    exponent = bucket / LATENCY_SUB_BUCKETS + LATENCY_SUB_BITS - 1;
+    sub = bucket % LATENCY_SUB_BUCKETS;
+    return ((LATENCY_SUB_BUCKETS + sub + 1) << (exponent - LATENCY_SUB_BITS)) - 1;
+}
+
+/****************************************************************************
+ * record
+ ****************************************************************************/
+void LatencyHistogram::record(uint64_t ns)
+{
+    ATOMIC_FETCH_ADD(&buckets_m[bucket_of(ns)], 1);
+    ATOMIC_FETCH_ADD(&sum_m, ns);
+    ATOMIC_FETCH_ADD(&count_m, 1);
+}
+
+/****************************************************************************
+ * reset
+ ****************************************************************************/
+void LatencyHistogram::reset(void)
+{
+    uint32_t bucket = 0;
+
+    for (bucket = 0; bucket < LATENCY_BUCKETS; bucket++)
+        ATOMIC_STORE_RELAXED(&buckets_m[bucket], 0);
+    ATOMIC_STORE_RELAXED(&sum_m, 0);
+    ATOMIC_STORE_RELAXED(&count_m, 0);
+}
+
+/****************************************************************************
+ * get_count
+ ****************************************************************************/
+uint64_t LatencyHistogram::get_count(void) const
+{
+    return ATOMIC_LOAD_RELAXED(&count_m);
+}
+
+/****************************************************************************
+ * get_mean
+ ****************************************************************************/
+double LatencyHistogram::get_mean(void) const
+{
+    uint64_t count = ATOMIC_LOAD_RELAXED(&count_m);
+
+    return (0 == count) ? 0. : (double)ATOMIC_LOAD_RELAXED(&sum_m) / count;
+}
+
+/****************************************************************************
+ * get_percentile
+ *
+ * Buckets are read one by one while records go on, the total is taken
+ * from them so that the result stays consistent.
+ ****************************************************************************/
+uint64_t LatencyHistogram::get_percentile(double percentile) const
+{
+    uint64_t counts[LATENCY_BUCKETS];
+    uint64_t total = 0;
+    uint64_t rank = 0;
+    uint64_t seen = 0;
+    uint32_t bucket = 0;
+
+    for (bucket = 0; bucket < LATENCY_BUCKETS; bucket++)
+    {
+        counts[bucket] = ATOMIC_LOAD_RELAXED(&buckets_m[bucket]);
+        total += counts[bucket];
+    }
+    if (0 == total)
+        return 0;
+    if (percentile < 0.)
+        percentile = 0.;
+    if (percentile > 100.)
+        percentile = 100.;
+    rank = (uint64_t)(percentile / 100. * total + 0.5);
+    if (0 == rank)
+        rank = 1;
+    for (bucket = 0; bucket < LATENCY_BUCKETS; bucket++)
+    {
+        seen += counts[bucket];
+        if (seen >= rank)
+            break;
+    }
+    return bucket_top(bucket);
+}
+
+/****************************************************************************
+ * get_max
+ ****************************************************************************/
+uint64_t LatencyHistogram::get_max(void) const
+{
+    uint32_t bucket = LATENCY_BUCKETS;
+
+    while (bucket > 0)
+    {
+        bucket--;
+        if (0 != ATOMIC_LOAD_RELAXED(&buckets_m[bucket]))
+            return bucket_top(bucket);
+    }
+    return 0;
+}
@@ -0,0 +1,78 @@
+/*****************************************************************************
+*   Copyright 2012 Vincent HERVIEUX
+*
+*   This file is part of QPicoscope.
+*
+*   QPicoscope is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU Lesser General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   any later version.
+*
+*   QPicoscope is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU Lesser General Public License for more details.
+*
+*   You should have received a copy of the GNU Lesser General Public License
+*   along with QPicoscope in files COPYING.LESSER and COPYING.
+*   If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+/**
+ * @file latencyhistogram.h
+ * @brief Declaration of LatencyHistogram class.
+ * Durations in nanoseconds counted in log-linear buckets, as HDR
+ * histograms do: each power of two is split in 2^LATENCY_SUB_BITS
+ * buckets, so any percentile is known within about 3% from 1 ns to
+ * 18 minutes with a fixed 10 kB table. Recording is one relaxed atomic
+ * add per counter, it never locks or allocates and can be done from any
+ * thread while another one reads.
+ * @version 0.1
+ * @date 2026, october 16
+ * @author Vincent HERVIEUX    -   10.16.2026   -   initial creation
+ */
+
+#ifndef LATENCYHISTOGRAM_H
+#define LATENCYHISTOGRAM_H
+
+#include "oscilloscope.h"
+
+/* buckets per power of two, as a power of two */
+#define LATENCY_SUB_BITS        5
+#define LATENCY_SUB_BUCKETS     (1 << LATENCY_SUB_BITS)
+/* longest duration counted, longer ones go in the last bucket */
+#define LATENCY_MAX_BITS        40
+#define LATENCY_BUCKETS         ((LATENCY_MAX_BITS - LATENCY_SUB_BITS + 1) * LATENCY_SUB_BUCKETS)
+
+class LatencyHistogram
+{
+public:
+    /** @brief constructor, empty */
+    LatencyHistogram();
+
+    /** @brief count a duration, any thread */
+    void record(uint64_t ns);
+    /** @brief empty the histogram, records made meanwhile may be lost */
+    void reset(void);
+    uint64_t get_count(void) const;
+    /** @brief mean in ns, 0 when empty */
+    double get_mean(void) const;
+    /**
+     * @brief duration below which a share of the records are
+     * @param[in] percentile: from 0 to 100
+     * @return upper bound of the bucket in ns, 0 when empty
+     */
+    uint64_t get_percentile(double percentile) const;
+    /** @brief upper bound of the highest bucket in use, in ns */
+    uint64_t get_max(void) const;
+
+private:
+    static uint32_t bucket_of(uint64_t ns);
+    /** @brief largest duration counted in a bucket */
+    static uint64_t bucket_top(uint32_t bucket);
+
+    uint64_t buckets_m[LATENCY_BUCKETS];
+    uint64_t count_m;
+    uint64_t sum_m;
+};
+
+#endif // LATENCYHISTOGRAM_H
@@ -0,0 +1,333 @@
+/*****************************************************************************
+*   Copyright 2012 Vincent HERVIEUX
+*
+*   This file is part of QPicoscope.
+*
+*   QPicoscope is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU Lesser General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   any later version.
+*
+*   QPicoscope is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU Lesser General Public License for more details.
+*
+*   You should have received a copy of the GNU Lesser General Public License
+*   along with QPicoscope in files COPYING.LESSER and COPYING.
+*   If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+/**
+ * @file logger.cpp
+ * @brief Definition of Logger class.
+ * @version 0.1
+ * @date 2026, october 16
+ * @author Vincent HERVIEUX    -   10.16.2026   -   initial creation
+ */
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+
+#include "logger.h"
+#include "atomic-ops.h"
+
+/* a pass of the background thread writes this much at a time */
+#define LOGGER_WRITE_SIZE    65536
+
+typedef struct
+{
+    const char *file;
+    const char *function;
+    int line;
+    uint8_t level;
+    char message[LOGGER_MESSAGE_SIZE];
+} log_entry_t;
+
+/* single producer: the thread owning it, single consumer: under drain_lock */
+typedef struct logger_ring
+{
+    log_entry_t entries[LOGGER_RING_SLOTS];
+    char pad0[CACHE_LINE_SIZE];
+    /* producer side */
+    uint32_t head;
+    uint64_t dropped;
+    char pad1[CACHE_LINE_SIZE];
+    /* consumer side */
+    uint32_t tail;
+    uint64_t reported;
+    /* cleared when the owning thread exits, the ring is then reused */
+    int in_use;
+    /* rings are never freed, next does not change once published */
+    struct logger_ring *next;
+} logger_ring_t;
+
+static pthread_once_t logger_once = PTHREAD_ONCE_INIT;
+static pthread_key_t ring_key;
+/* ring registration */
+static pthread_mutex_t rings_lock = PTHREAD_MUTEX_INITIALIZER;
+static logger_ring_t *rings = NULL;
+/* consumer side of every ring */
+static pthread_mutex_t drain_lock = PTHREAD_MUTEX_INITIALIZER;
+static char write_buffer[LOGGER_WRITE_SIZE];
+/* background thread */
+static pthread_mutex_t thread_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t thread_cond;
+static pthread_t thread_id;
+static bool stopping = false;
+/* set while the background thread empties the rings */
+static int running = 0;
+
+/****************************************************************************
+ * level_name
+ ****************************************************************************/
+static const char* level_name(uint8_t level)
+{
+    switch (level)
+    {
+    case LOG_LEVEL_ERROR:
+        return "ERROR";
+    case LOG_LEVEL_WARNING:
+        return "WARNING";
+    default:
+        return "DEBUG";
+    }
+}
+
+/****************************************************************************
+ * release_ring
+ *  key destructor, called when the owning thread exits
+ ****************************************************************************/
+static void release_ring(void *ring)
+{
+    ATOMIC_STORE_RELEASE(&((logger_ring_t*)ring)->in_use, 0);
+}
+
+/****************************************************************************
+ * get_ring
+ *  ring of the calling thread, a free one is taken on its first message
+ ****************************************************************************/
+static logger_ring_t* get_ring(void)
+{
+    logger_ring_t *ring = (logger_ring_t*)pthread_getspecific(ring_key);
+
+    if (NULL != ring)
+        return ring;
+
+    /* a ring still holding messages of its previous thread would drop ours */
+    pthread_mutex_lock(&rings_lock);
+    for (ring = rings; NULL != ring; ring = ring->next)
+    {
+        if ((0 == ATOMIC_LOAD_ACQUIRE(&ring->in_use)) && (ATOMIC_LOAD_ACQUIRE(&ring->head) == ATOMIC_LOAD_ACQUIRE(&ring->tail)))
+            break;
+    }
+    if (NULL == ring)
+    {
+        ring = (logger_ring_t*)calloc(1, sizeof(logger_ring_t));
+        if (NULL != ring)
+        {
+            ring->next = rings;
+            ATOMIC_STORE_RELEASE(&rings, ring);
+        }
+    }
+    if (NULL != ring)
+        ring->in_use = 1;
+    pthread_mutex_unlock(&rings_lock);
+
+    if (NULL != ring)
+        pthread_setspecific(ring_key, ring);
+    return ring;
+}
+
+/****************************************************************************
+ * append
+ *  format a message with its origin at the end of the write buffer
+ ****************************************************************************/
+static size_t append(size_t used, uint8_t level, const char *file, const char *function, int line, const char *message)
+{
+    size_t length = strlen(message);
+    int written = 0;
+
+    if (used + LOGGER_MESSAGE_SIZE + 256 > LOGGER_WRITE_SIZE)
+    {
+        fwrite(write_buffer, 1, used, stderr);
+        used = 0;
+    }
+    written = snprintf(write_buffer + used, LOGGER_WRITE_SIZE - used, "%s\t- %s:\t[%d]\t%s: %s%s",
+                       file, function, line, level_name(level), message,
+                       ((length > 0) && ('\n' == message[length - 1])) ? "" : "\n");
+    if (written > 0)
+        used += ((size_t)written < LOGGER_WRITE_SIZE - used) ? (size_t)written : LOGGER_WRITE_SIZE - used - 1;
+    return used;
+}
+
+/****************************************************************************
+ * drain
+ *  write every queued message, in thread order
+ ****************************************************************************/
+static void drain(void)
+{
+    logger_ring_t *ring = NULL;
+    log_entry_t *entry = NULL;
+    uint32_t tail = 0;
+    uint32_t head = 0;
+    uint64_t dropped = 0;
+    size_t used = 0;
+    char message[64];
+
+    pthread_mutex_lock(&drain_lock);
+    for (ring = ATOMIC_LOAD_ACQUIRE(&rings); NULL != ring; ring = ring->next)
+    {
+        tail = ring->tail;
+        head = ATOMIC_LOAD_ACQUIRE(&ring->head);
+        for (; tail != head; tail++)
+        {
+            entry = &ring->entries[tail % LOGGER_RING_SLOTS];
+            used = append(used, entry->level, entry->file, entry->function, entry->line, entry->message);
+            ATOMIC_STORE_RELEASE(&ring->tail, tail + 1);
+        }
+        dropped = ATOMIC_LOAD_RELAXED(&ring->dropped);
+        if (dropped != ring->reported)
+        {
+            snprintf(message, sizeof(message), "%llu log messages dropped\n",
+                     (unsigned long long)(dropped - ring->reported));
+            used = append(used, LOG_LEVEL_WARNING, __FILE__, __FUNCTION__, __LINE__, message);
+            ring->reported = dropped;
+        }
+    }
+    if (used > 0)
+    {
+        fwrite(write_buffer, 1, used, stderr);
+        fflush(stderr);
+    }
+    pthread_mutex_unlock(&drain_lock);
+}
+
+/****************************************************************************
+ * thread_flush
+ ****************************************************************************/
+static void* thread_flush(void *arg)
+{
+    struct timespec deadline;
+
+    (void)arg;
+    pthread_mutex_lock(&thread_lock);
+    while (!stopping)
+    {
+        clock_gettime(CLOCK_MONOTONIC, &deadline);
+        deadline.tv_nsec += LOGGER_FLUSH_PERIOD * 1000000L;
+        if (deadline.tv_nsec >= 1000000000L)
+        {
+            deadline.tv_sec++;
+            deadline.tv_nsec -= 1000000000L;
+        }
+        pthread_cond_timedwait(&thread_cond, &thread_lock, &deadline);
+        pthread_mutex_unlock(&thread_lock);
+        drain();
+        pthread_mutex_lock(&thread_lock);
+    }
+    pthread_mutex_unlock(&thread_lock);
+    return NULL;
+}
+
+/****************************************************************************
+ * stop
+ *  at exit: the last messages are written, the next ones are not queued
+ ****************************************************************************/
+static void stop(void)
+{
+    pthread_mutex_lock(&thread_lock);
+    stopping = true;
+    pthread_cond_signal(&thread_cond);
+    pthread_mutex_unlock(&thread_lock);
+    pthread_join(thread_id, NULL);
+    ATOMIC_STORE_RELEASE(&running, 0);
+    drain();
+}
+
+/****************************************************************************
+ * start
+ ****************************************************************************/
+static void start(void)
+{
+    pthread_condattr_t attributes;
+
+    if (0 != pthread_key_create(&ring_key, release_ring))
+        return;
+    pthread_condattr_init(&attributes);
+    pthread_condattr_setclock(&attributes, CLOCK_MONOTONIC);
+    pthread_cond_init(&thread_cond, &attributes);
+    pthread_condattr_destroy(&attributes);
+    if (0 != pthread_create(&thread_id, NULL, thread_flush, NULL))
+    {
+        fprintf(stderr, "%s\t- %s:\t[%d]\tWARNING: no logging thread, messages are written at once\n",
+                __FILE__, __FUNCTION__, __LINE__);
+        return;
+    }
+    ATOMIC_STORE_RELEASE(&running, 1);
+    atexit(stop);
+}
+
+/****************************************************************************
+ * write
+ ****************************************************************************/
+void Logger::write(uint8_t level, const char *file, const char *function, int line, const char *format, ...)
+{
+    logger_ring_t *ring = NULL;
+    log_entry_t *entry = NULL;
+    uint32_t head = 0;
+    va_list args;
+
+    pthread_once(&logger_once, start);
+    if (0 != ATOMIC_LOAD_ACQUIRE(&running))
+        ring = get_ring();
+    if (NULL == ring)
+    {
+        va_start(args, format);
+        fprintf(stderr, "%s\t- %s:\t[%d]\t%s: ", file, function, line, level_name(level));
+        vfprintf(stderr, format, args);
+        va_end(args);
+        return;
+    }
+
+    head = ring->head;
+    if (head - ATOMIC_LOAD_ACQUIRE(&ring->tail) >= LOGGER_RING_SLOTS)
+    {
+        /* the background thread is late, the caller must not wait for it */
+        ATOMIC_FETCH_ADD(&ring->dropped, 1);
+        return;
+    }
+    entry = &ring->entries[head % LOGGER_RING_SLOTS];
+    entry->file = file;
+    entry->function = function;
+    entry->line = line;
+    entry->level = level;
+    va_start(args, format);
+    vsnprintf(entry->message, LOGGER_MESSAGE_SIZE, format, args);
+    va_end(args);
+    ATOMIC_STORE_RELEASE(&ring->head, head + 1);
+}
+
+/****************************************************************************
+ * flush
+ ****************************************************************************/
+void Logger::flush(void)
+{
+    drain();
+}
+
+/****************************************************************************
+ * get_dropped
+ ****************************************************************************/
+uint64_t Logger::get_dropped(void)
+{
+    logger_ring_t *ring = NULL;
+    uint64_t dropped = 0;
+
+    for (ring = ATOMIC_LOAD_ACQUIRE(&rings); NULL != ring; ring = ring->next)
+        dropped += ATOMIC_LOAD_RELAXED(&ring->dropped);
+    return dropped;
+}
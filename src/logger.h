@@ -0,0 +1,76 @@
+/*****************************************************************************
+*   Copyright 2012 Vincent HERVIEUX
+*
+*   This file is part of QPicoscope.
+*
+*   QPicoscope is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU Lesser General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   any later version.
+*
+*   QPicoscope is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU Lesser General Public License for more details.
+*
+*   You should have received a copy of the GNU Lesser General Public License
+*   along with QPicoscope in files COPYING.LESSER and COPYING.
+*   If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+/**
+ * @file logger.h
+ * @brief Declaration of Logger class.
+ * Messages of the enabled log levels are formatted by the calling thread
+ * into a ring of its own, without lock nor system call. A background
+ * thread adds the file, function and line and writes them to stderr a few
+ * times per second. A full ring drops the message instead of waiting, so
+ * logging never slows a capture down; the drops are reported in the log.
+ * Levels above LOG_LEVEL are compiled out, see oscilloscope.h.
+ * @version 0.1
+ * @date 2026, october 16
+ * @author Vincent HERVIEUX    -   10.16.2026   -   initial creation
+ */
+
+#ifndef LOGGER_H
+#define LOGGER_H
+
+#include <stdint.h>
+
+#define LOG_LEVEL_NONE       0
+#define LOG_LEVEL_ERROR      1
+#define LOG_LEVEL_WARNING    2
+#define LOG_LEVEL_DEBUG      3
+
+/* messages per thread waiting for the background thread */
+#define LOGGER_RING_SLOTS    256
+/* longer messages are truncated */
+#define LOGGER_MESSAGE_SIZE  232
+/* period of the background thread, in ms */
+#define LOGGER_FLUSH_PERIOD  50
+
+class Logger
+{
+public:
+    /**
+     * @brief log a message, any thread
+     * The background thread is started by the first call. Before it is
+     * started and once it has stopped, the message is written at once.
+     * @param[in] level: LOG_LEVEL_ERROR to LOG_LEVEL_DEBUG
+     * @param[in] file, function: string literals, only their address is kept
+     */
+    static void write(uint8_t level, const char *file, const char *function, int line, const char *format, ...)
+        __attribute__((format(printf, 5, 6)));
+    /** @brief compiled out levels: arguments are checked, never evaluated */
+    static inline void discard(const char *format, ...) __attribute__((format(printf, 1, 2)));
+    /** @brief write every queued message now, any thread */
+    static void flush(void);
+    /** @brief messages dropped because a ring was full */
+    static uint64_t get_dropped(void);
+};
+
+inline void Logger::discard(const char *format, ...)
+{
+    (void)format;
+}
+
+#endif // LOGGER_H
@@ -0,0 +1,614 @@
+/*****************************************************************************
+*   Copyright 2012 Vincent HERVIEUX
+*
+*   This file is part of QPicoscope.
+*
+*   QPicoscope is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU Lesser General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   any later version.
+*
+*   QPicoscope is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU Lesser General Public License for more details.
+*
+*   You should have received a copy of the GNU Lesser General Public License
+*   along with QPicoscope in files COPYING.LESSER and COPYING.
+*   If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+/**
+ * @file measurementscan.cpp
+ * @brief Definition of MeasurementScan class.
+ * @version 0.1
+ * @date 2026, october 16
+ * @author Vincent HERVIEUX    -   10.16.2026   -   initial creation
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "measurementscan.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define MEASUREMENT_SCAN_X86
+#include <immintrin.h>
+#endif
+#if defined(__aarch64__) && defined(__ARM_NEON)
+#define MEASUREMENT_SCAN_NEON
+#include <arm_neon.h>
+#endif
+
+/* vectors summed in 32 bits before they are added to the 64 bits sum */
+#define MEASUREMENT_SCAN_BLOCK      4096
+/* comparator hysteresis, part of the swing */
+#define MEASUREMENT_HYSTERESIS      (1. / 16.)
+/*
+ * extremes moving by more than this part of the swing scan the edges
+ * again, the 10 % and 90 % levels stay within the new swing
+ */
+#define MEASUREMENT_LEVEL_DRIFT     (1. / 20.)
+
+#define MEASUREMENT_SUMS     (MEASUREMENT_BIT(E_MEASURE_MEAN) | MEASUREMENT_BIT(E_MEASURE_RMS))
+#define MEASUREMENT_EDGES    (MEASUREMENT_BIT(E_MEASURE_FREQUENCY) | MEASUREMENT_BIT(E_MEASURE_PERIOD) | \
+                              MEASUREMENT_BIT(E_MEASURE_DUTY) | MEASUREMENT_TRANSITIONS)
+#define MEASUREMENT_TRANSITIONS   (MEASUREMENT_BIT(E_MEASURE_RISE) | MEASUREMENT_BIT(E_MEASURE_FALL))
+
+static const char *measure_names[MeasurementScan::E_MEASURE_MAX] =
+    { "Vpp", "Mean", "RMS", "Frequency", "Period", "Duty cycle", "Rise time", "Fall time" };
+static const char *measure_units[MeasurementScan::E_MEASURE_MAX] =
+    { "V", "V", "V", "Hz", "s", "%", "s", "s" };
+
+/****************************************************************************
+ * scan_scalar
+ ****************************************************************************/
+static uint32_t scan_scalar(const int16_t *samples, uint32_t count, int16_t lo, int16_t hi,
+                            bool sums, MeasurementScan::accumulator_t *accumulator)
+{
+    int16_t minimum = accumulator->minimum;
+    int16_t maximum = accumulator->maximum;
+    int64_t sum = 0;
+    uint64_t squares = 0;
+    uint32_t i = 0;
+
+    for (i = 0; i < count; i++)
+    {
+        if ((samples[i] < lo) || (samples[i] > hi))
+            break;
+        if (samples[i] < minimum)
+            minimum = samples[i];
+        if (samples[i] > maximum)
+            maximum = samples[i];
+        if (sums)
+        {
+            sum += samples[i];
+            squares += (uint32_t)((int32_t)samples[i] * samples[i]);
+        }
+    }
+    accumulator->minimum = minimum;
+    accumulator->maximum = maximum;
+    accumulator->sum += sum;
+    accumulator->squares += squares;
+    return i;
+}
+
+#ifdef MEASUREMENT_SCAN_X86
+/****************************************************************************
+ * scan_sse2
+ *
+ * Sums of pairs come from madd: counts times 1 stay in 32 bits for a
+ * block, squares are up to 2^31 and are widened to 64 bits at once. The
+ * 16 samples holding the flip are left to the scalar loop.
+ ****************************************************************************/
+__attribute__((target("sse2")))
+static uint32_t scan_sse2(const int16_t *samples, uint32_t count, int16_t lo, int16_t hi,
+                          bool sums, MeasurementScan::accumulator_t *accumulator)
+{
+    const __m128i low = _mm_set1_epi16(lo);
+    const __m128i high = _mm_set1_epi16(hi);
+    const __m128i ones = _mm_set1_epi16(1);
+    const __m128i zero = _mm_setzero_si128();
+    __m128i minimum = _mm_set1_epi16(accumulator->minimum);
+    __m128i maximum = _mm_set1_epi16(accumulator->maximum);
+    __m128i sum = zero;
+    __m128i squares = zero;
+    __m128i a;
+    __m128i b;
+    __m128i out;
+    int16_t lanes[8];
+    int32_t sums32[4];
+    uint64_t squares64[2];
+    uint32_t i = 0;
+    uint32_t end = 0;
+    uint8_t lane = 0;
+    bool flipped = false;
+
+    while (!flipped && (i + 16 <= count))
+    {
+        end = ((count - i) / 16 > MEASUREMENT_SCAN_BLOCK) ? i + 16 * MEASUREMENT_SCAN_BLOCK : count;
+        for (; i + 16 <= end; i += 16)
+        {
+            a = _mm_loadu_si128((const __m128i*)(samples + i));
+            b = _mm_loadu_si128((const __m128i*)(samples + i + 8));
+            out = _mm_or_si128(_mm_or_si128(_mm_cmplt_epi16(a, low), _mm_cmpgt_epi16(a, high)),
+                               _mm_or_si128(_mm_cmplt_epi16(b, low), _mm_cmpgt_epi16(b, high)));
+            if (0 != _mm_movemask_epi8(out))
+            {
+                flipped = true;
+                break;
+            }
+            minimum = _mm_min_epi16(minimum, _mm_min_epi16(a, b));
+            maximum = _mm_max_epi16(maximum, _mm_max_epi16(a, b));
+            if (sums)
+            {
+                sum = _mm_add_epi32(sum, _mm_add_epi32(_mm_madd_epi16(a, ones), _mm_madd_epi16(b, ones)));
+                a = _mm_madd_epi16(a, a);
+                b = _mm_madd_epi16(b, b);
+                squares = _mm_add_epi64(squares, _mm_unpacklo_epi32(a, zero));
+                squares = _mm_add_epi64(squares, _mm_unpackhi_epi32(a, zero));
+                squares = _mm_add_epi64(squares, _mm_unpacklo_epi32(b, zero));
+                squares = _mm_add_epi64(squares, _mm_unpackhi_epi32(b, zero));
+            }
+        }
+        _mm_storeu_si128((__m128i*)sums32, sum);
+        accumulator->sum += (int64_t)sums32[0] + sums32[1] + sums32[2] + sums32[3];
+        sum = zero;
+    }
+
+    _mm_storeu_si128((__m128i*)squares64, squares);
+    accumulator->squares += squares64[0] + squares64[1];
+    _mm_storeu_si128((__m128i*)lanes, minimum);
+    for (lane = 0; lane < 8; lane++)
+    {
+        if (lanes[lane] < accumulator->minimum)
+            accumulator->minimum = lanes[lane];
+    }
+    _mm_storeu_si128((__m128i*)lanes, maximum);
+    for (lane = 0; lane < 8; lane++)
+    {
+        if (lanes[lane] > accumulator->maximum)
+            accumulator->maximum = lanes[lane];
+    }
+    return i + scan_scalar(samples + i, count - i, lo, hi, sums, accumulator);
+}
+
+/****************************************************************************
+ * scan_avx2
+ ****************************************************************************/
+__attribute__((target("avx2")))
+static uint32_t scan_avx2(const int16_t *samples, uint32_t count, int16_t lo, int16_t hi,
+                          bool sums, MeasurementScan::accumulator_t *accumulator)
+{
+    const __m256i low = _mm256_set1_epi16(lo);
+    const __m256i high = _mm256_set1_epi16(hi);
+    const __m256i ones = _mm256_set1_epi16(1);
+    const __m256i zero = _mm256_setzero_si256();
+    __m256i minimum = _mm256_set1_epi16(accumulator->minimum);
+    __m256i maximum = _mm256_set1_epi16(accumulator->maximum);
+    __m256i sum = zero;
+    __m256i squares = zero;
+    __m256i a;
+    __m256i b;
+    __m256i out;
+    int16_t lanes[16];
+    int32_t sums32[8];
+    uint64_t squares64[4];
+    uint32_t i = 0;
+    uint32_t end = 0;
+    uint8_t lane = 0;
+    bool flipped = false;
+
+    while (!flipped && (i + 32 <= count))
+    {
+        end = ((count - i) / 32 > MEASUREMENT_SCAN_BLOCK) ? i + 32 * MEASUREMENT_SCAN_BLOCK : count;
+        for (; i + 32 <= end; i += 32)
+        {
+            a = _mm256_loadu_si256((const __m256i*)(samples + i));
+            b = _mm256_loadu_si256((const __m256i*)(samples + i + 16));
+            out = _mm256_or_si256(_mm256_or_si256(_mm256_cmpgt_epi16(low, a), _mm256_cmpgt_epi16(a, high)),
+                                  _mm256_or_si256(_mm256_cmpgt_epi16(low, b), _mm256_cmpgt_epi16(b, high)));
+            if (0 != _mm256_movemask_epi8(out))
+            {
+                flipped = true;
+                break;
+            }
+            minimum = _mm256_min_epi16(minimum, _mm256_min_epi16(a, b));
+            maximum = _mm256_max_epi16(maximum, _mm256_max_epi16(a, b));
+            if (sums)
+            {
+                sum = _mm256_add_epi32(sum, _mm256_add_epi32(_mm256_madd_epi16(a, ones), _mm256_madd_epi16(b, ones)));
+                a = _mm256_madd_epi16(a, a);
+                b = _mm256_madd_epi16(b, b);
+                squares = _mm256_add_epi64(squares, _mm256_unpacklo_epi32(a, zero));
+                squares = _mm256_add_epi64(squares, _mm256_unpackhi_epi32(a, zero));
+                squares = _mm256_add_epi64(squares, _mm256_unpacklo_epi32(b, zero));
+                squares = _mm256_add_epi64(squares, _mm256_unpackhi_epi32(b, zero));
+            }
+        }
+        _mm256_storeu_si256((__m256i*)sums32, sum);
+        for (lane = 0; lane < 8; lane++)
+            accumulator->sum += sums32[lane];
+        sum = zero;
+    }
+
+    _mm256_storeu_si256((__m256i*)squares64, squares);
+    accumulator->squares += squares64[0] + squares64[1] + squares64[2] + squares64[3];
+    _mm256_storeu_si256((__m256i*)lanes, minimum);
+    for (lane = 0; lane < 16; lane++)
+    {
+        if (lanes[lane] < accumulator->minimum)
+            accumulator->minimum = lanes[lane];
+    }
+    _mm256_storeu_si256((__m256i*)lanes, maximum);
+    /* the callers are SSE code, gcc leaves the upper halves dirty on its own */
+    _mm256_zeroupper();
+    for (lane = 0; lane < 16; lane++)
+    {
+        if (lanes[lane] > accumulator->maximum)
+            accumulator->maximum = lanes[lane];
+    }
+    return i + scan_sse2(samples + i, count - i, lo, hi, sums, accumulator);
+}
+#endif
+
+#ifdef MEASUREMENT_SCAN_NEON
+/****************************************************************************
+ * scan_neon
+ *
+ * Pairwise widening adds keep the sums in 64 bits without blocks.
+ ****************************************************************************/
+static uint32_t scan_neon(const int16_t *samples, uint32_t count, int16_t lo, int16_t hi,
+                          bool sums, MeasurementScan::accumulator_t *accumulator)
+{
+    const int16x8_t low = vdupq_n_s16(lo);
+    const int16x8_t high = vdupq_n_s16(hi);
+    int16x8_t minimum = vdupq_n_s16(accumulator->minimum);
+    int16x8_t maximum = vdupq_n_s16(accumulator->maximum);
+    int64x2_t sum = vdupq_n_s64(0);
+    int64x2_t squares = vdupq_n_s64(0);
+    int16x8_t a;
+    int16x8_t b;
+    uint16x8_t out;
+    uint32_t i = 0;
+
+    for (i = 0; i + 16 <= count; i += 16)
+    {
+        a = vld1q_s16(samples + i);
+        b = vld1q_s16(samples + i + 8);
+        out = vorrq_u16(vorrq_u16(vcltq_s16(a, low), vcgtq_s16(a, high)),
+                        vorrq_u16(vcltq_s16(b, low), vcgtq_s16(b, high)));
+        if (0 != vmaxvq_u16(out))
+            break;
+        minimum = vminq_s16(minimum, vminq_s16(a, b));
+        maximum = vmaxq_s16(maximum, vmaxq_s16(a, b));
+        if (sums)
+        {
+            sum = vpadalq_s32(sum, vaddq_s32(vpaddlq_s16(a), vpaddlq_s16(b)));
+            squares = vpadalq_s32(squares, vmull_s16(vget_low_s16(a), vget_low_s16(a)));
+            squares = vpadalq_s32(squares, vmull_high_s16(a, a));
+            squares = vpadalq_s32(squares, vmull_s16(vget_low_s16(b), vget_low_s16(b)));
+            squares = vpadalq_s32(squares, vmull_high_s16(b, b));
+        }
+    }
+    accumulator->minimum = vminvq_s16(minimum);
+    accumulator->maximum = vmaxvq_s16(maximum);
+    accumulator->sum += vaddvq_s64(sum);
+    accumulator->squares += (uint64_t)vaddvq_s64(squares);
+    return i + scan_scalar(samples + i, count - i, lo, hi, sums, accumulator);
+}
+#endif
+
+/****************************************************************************
+ *
+ * constructor
+ *
+ ****************************************************************************/
+MeasurementScan::MeasurementScan() :
+    kernel_m(AdcConvert::E_KERNEL_SCALAR),
+    scan_m(scan_scalar),
+    edge_scan_m(scan_scalar),
+    levels_valid_m(false),
+    level_min_m(0),
+    level_max_m(0),
+    low_level_m(0.),
+    mid_level_m(0.),
+    high_level_m(0.),
+    up_m(0),
+    down_m(0)
+{
+    set_kernel(AdcConvert::best_kernel());
+}
+
+/****************************************************************************
+ *
+ * destructor
+ *
+ ****************************************************************************/
+MeasurementScan::~MeasurementScan()
+{
+}
+
+/****************************************************************************
+ * set_kernel
+ ****************************************************************************/
+bool MeasurementScan::set_kernel(AdcConvert::kernel_e kernel)
+{
+    kernel_fn_t function = NULL;
+
+    if (AdcConvert::is_supported(kernel))
+    {
+        switch (kernel)
+        {
+#ifdef MEASUREMENT_SCAN_X86
+        case AdcConvert::E_KERNEL_SSE2:
+            function = scan_sse2;
+            break;
+        case AdcConvert::E_KERNEL_AVX2:
+            function = scan_avx2;
+            break;
+#endif
+#ifdef MEASUREMENT_SCAN_NEON
+        case AdcConvert::E_KERNEL_NEON:
+            function = scan_neon;
+            break;
+#endif
+        case AdcConvert::E_KERNEL_SCALAR:
+            function = scan_scalar;
+            break;
+        default:
+            break;
+        }
+    }
+    if (NULL == function)
+    {
+        WARNING("%s kernel not supported, keeping %s\n", AdcConvert::kernel_name(kernel), AdcConvert::kernel_name(kernel_m));
+        return false;
+    }
+    kernel_m = kernel;
+    scan_m = function;
+    edge_scan_m = function;
+#ifdef MEASUREMENT_SCAN_X86
+    /*
+     * Between two edges a run is a few hundred samples, the AVX2 set up
+     * and reduction cost more than the wider loads save there.
+     */
+    if (AdcConvert::E_KERNEL_AVX2 == kernel)
+        edge_scan_m = scan_sse2;
+#endif
+    return true;
+}
+
+/****************************************************************************
+ * measure_name
+ ****************************************************************************/
+const char* MeasurementScan::measure_name(measure_e measure)
+{
+    return (measure < E_MEASURE_MAX) ? measure_names[measure] : "unknown";
+}
+
+/****************************************************************************
+ * measure_unit
+ ****************************************************************************/
+const char* MeasurementScan::measure_unit(measure_e measure)
+{
+    return (measure < E_MEASURE_MAX) ? measure_units[measure] : "";
+}
+
+/****************************************************************************
+ * set_levels
+ ****************************************************************************/
+void MeasurementScan::set_levels(int16_t minimum, int16_t maximum)
+{
+    double swing = (double)maximum - minimum;
+    double hysteresis = swing * MEASUREMENT_HYSTERESIS;
+
+    if (hysteresis < 1.)
+        hysteresis = 1.;
+    low_level_m = minimum + 0.1 * swing;
+    mid_level_m = minimum + 0.5 * swing;
+    high_level_m = minimum + 0.9 * swing;
+    up_m = (int32_t)ceil(mid_level_m + hysteresis);
+    down_m = (int32_t)floor(mid_level_m - hysteresis);
+}
+
+/****************************************************************************
+ * transition_time
+ *
+ * The 10 % level before a rising flip is searched back down to the
+ * previous flip, the 90 % level after it forward until the comparator
+ * would flip back. Both are placed between two samples.
+ ****************************************************************************/
+bool MeasurementScan::transition_time(const int16_t *raw, uint32_t count, uint32_t start, uint32_t flip,
+                                      bool rising, double *duration) const
+{
+    const double before = rising ? low_level_m : high_level_m;
+    const double after = rising ? high_level_m : low_level_m;
+    int64_t k = (int64_t)flip - 1;
+    uint32_t m = flip;
+    double t_before = 0.;
+    double t_after = 0.;
+
+    if (rising)
+    {
+        while ((k >= (int64_t)start) && (raw[k] > before))
+            k--;
+        while ((m < count) && (raw[m] < after))
+        {
+            if (raw[m] <= down_m)
+                return false;
+            m++;
+        }
+    }
+    else
+    {
+        while ((k >= (int64_t)start) && (raw[k] < before))
+            k--;
+        while ((m < count) && (raw[m] > after))
+        {
+            if (raw[m] >= up_m)
+                return false;
+            m++;
+        }
+    }
+    if ((k < (int64_t)start) || (m >= count))
+        return false;
+    t_before = k + (before - raw[k]) / ((double)raw[k + 1] - raw[k]);
+    t_after = (m - 1) + (after - raw[m - 1]) / ((double)raw[m] - raw[m - 1]);
+    *duration = t_after - t_before;
+    return true;
+}
+
+/****************************************************************************
+ * scan_edges
+ *
+ * The comparator starts on the side of the first sample, so no edge is
+ * seen there. Each flip is placed where the samples cross the mid level,
+ * between the flip and the previous one. The time above the mid level is
+ * kept for the periods a rising edge closes only.
+ ****************************************************************************/
+void MeasurementScan::scan_edges(const int16_t *raw, uint32_t count, bool sums, bool transitions,
+                                 accumulator_t *accumulator, edges_t *edges) const
+{
+    bool high = (raw[0] >= mid_level_m);
+    uint32_t last_flip = 0;
+    uint32_t i = 0;
+    uint32_t j = 0;
+    double t = 0.;
+    double duration = 0.;
+
+    memset(edges, 0, sizeof(edges_t));
+    while (i < count)
+    {
+        if (high)
+            i += edge_scan_m(raw + i, count - i, (int16_t)(down_m + 1), INT16_MAX, sums, accumulator);
+        else
+            i += edge_scan_m(raw + i, count - i, INT16_MIN, (int16_t)(up_m - 1), sums, accumulator);
+        if (i >= count)
+            break;
+
+        for (j = i; (j > last_flip) && ((raw[j - 1] >= mid_level_m) != high); j--)
+            ;
+        if (j > last_flip)
+            t = (j - 1) + (mid_level_m - raw[j - 1]) / ((double)raw[j] - raw[j - 1]);
+        else
+            t = j;
+        if (!high)
+        {
+            if (edges->rising > 0)
+                edges->high_time += edges->pending_high;
+            edges->pending_high = 0.;
+            if (0 == edges->rising)
+                edges->first_rising = t;
+            edges->last_rising = t;
+            edges->rising++;
+            if (transitions && transition_time(raw, count, last_flip, i, true, &duration))
+            {
+                edges->rise_sum += duration;
+                edges->rise_count++;
+            }
+        }
+        else
+        {
+            if (edges->rising > 0)
+                edges->pending_high = t - edges->last_rising;
+            if (transitions && transition_time(raw, count, last_flip, i, false, &duration))
+            {
+                edges->fall_sum += duration;
+                edges->fall_count++;
+            }
+        }
+        last_flip = i;
+        high = !high;
+    }
+}
+
+/****************************************************************************
+ * measure
+ *
+ * Edges are searched on the levels of the previous block while the
+ * extremes are found. If the extremes moved too much, or on the first
+ * block, the edges are searched again on the new levels.
+ ****************************************************************************/
+void MeasurementScan::measure(const int16_t *raw, uint32_t count, float scale, float offset, double sample_interval,
+                              uint32_t wanted, result_t *result)
+{
+    accumulator_t accumulator;
+    accumulator_t again;
+    edges_t edges;
+    bool sums = (0 != (wanted & MEASUREMENT_SUMS));
+    bool transitions = (0 != (wanted & MEASUREMENT_TRANSITIONS));
+    bool scanned = false;
+    int32_t swing = 0;
+    int32_t drift = 0;
+    double period = 0.;
+
+    result->valid_mask = 0;
+    if ((NULL == raw) || (0 == count) || (0 == wanted))
+        return;
+    accumulator.minimum = INT16_MAX;
+    accumulator.maximum = INT16_MIN;
+    accumulator.sum = 0;
+    accumulator.squares = 0;
+
+    if ((0 != (wanted & MEASUREMENT_EDGES)) && levels_valid_m &&
+        ((int32_t)level_max_m - level_min_m >= MEASUREMENT_MIN_SWING))
+    {
+        set_levels(level_min_m, level_max_m);
+        scan_edges(raw, count, sums, transitions, &accumulator, &edges);
+        scanned = true;
+    }
+    else
+    {
+        scan_m(raw, count, INT16_MIN, INT16_MAX, sums, &accumulator);
+    }
+
+    swing = (int32_t)accumulator.maximum - accumulator.minimum;
+    drift = (int32_t)(swing * MEASUREMENT_LEVEL_DRIFT);
+    if ((0 != (wanted & MEASUREMENT_EDGES)) && (swing >= MEASUREMENT_MIN_SWING) &&
+        (!scanned || (abs((int32_t)accumulator.minimum - level_min_m) > drift) ||
+         (abs((int32_t)accumulator.maximum - level_max_m) > drift)))
+    {
+        set_levels(accumulator.minimum, accumulator.maximum);
+        again = accumulator;
+        scan_edges(raw, count, false, transitions, &again, &edges);
+        scanned = true;
+    }
+    else if (swing < MEASUREMENT_MIN_SWING)
+    {
+        /* flat or noise, no edge */
+        scanned = false;
+    }
+    level_min_m = accumulator.minimum;
+    level_max_m = accumulator.maximum;
+    levels_valid_m = true;
+
+    result->values[E_MEASURE_VPP] = swing * fabs(scale);
+    result->values[E_MEASURE_MEAN] = (double)accumulator.sum / count * scale + offset;
+    result->values[E_MEASURE_RMS] = sqrt(fabs((double)accumulator.squares / count * scale * scale +
+                                              2. * (double)accumulator.sum / count * scale * offset +
+                                              (double)offset * offset));
+    result->valid_mask = MEASUREMENT_BIT(E_MEASURE_VPP);
+    if (sums)
+        result->valid_mask |= MEASUREMENT_SUMS;
+    if (scanned && (edges.rising >= 2))
+    {
+        period = (edges.last_rising - edges.first_rising) / (edges.rising - 1);
+        result->values[E_MEASURE_PERIOD] = period * sample_interval;
+        result->values[E_MEASURE_FREQUENCY] = 1. / (period * sample_interval);
+        result->values[E_MEASURE_DUTY] = 100. * edges.high_time / (edges.last_rising - edges.first_rising);
+        result->valid_mask |= MEASUREMENT_BIT(E_MEASURE_PERIOD) | MEASUREMENT_BIT(E_MEASURE_FREQUENCY) |
+                              MEASUREMENT_BIT(E_MEASURE_DUTY);
+    }
+    if (scanned && (edges.rise_count > 0))
+    {
+        result->values[E_MEASURE_RISE] = edges.rise_sum / edges.rise_count * sample_interval;
+        result->valid_mask |= MEASUREMENT_BIT(E_MEASURE_RISE);
+    }
+    if (scanned && (edges.fall_count > 0))
+    {
+        result->values[E_MEASURE_FALL] = edges.fall_sum / edges.fall_count * sample_interval;
+        result->valid_mask |= MEASUREMENT_BIT(E_MEASURE_FALL);
+    }
+    result->valid_mask &= wanted;
+}
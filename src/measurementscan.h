@@ -0,0 +1,164 @@
+/*****************************************************************************
+*   Copyright 2012 Vincent HERVIEUX
+*
+*   This file is part of QPicoscope.
+*
+*   QPicoscope is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU Lesser General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   any later version.
+*
+*   QPicoscope is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU Lesser General Public License for more details.
+*
+*   You should have received a copy of the GNU Lesser General Public License
+*   along with QPicoscope in files COPYING.LESSER and COPYING.
+*   If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+/**
+ * @file measurementscan.h
+ * @brief Declaration of MeasurementScan class.
+ * Automatic measurements of the ADC counts of one channel, block after
+ * block. Extremes, sums and the crossings of the mid level are found in a
+ * single pass, with the widest SIMD kernel the CPU supports: a kernel
+ * accumulates the samples until the mid level comparator flips, only the
+ * samples around an edge are looked at again, to place it and its 10 %
+ * and 90 % levels. Levels come from the extremes of the previous block, the
+ * block is scanned a second time only when they moved. Measurements not
+ * asked for are not computed, nor the sums or edges they would need.
+ * @version 0.1
+ * @date 2026, october 16
+ * @author Vincent HERVIEUX    -   10.16.2026   -   initial creation
+ */
+
+#ifndef MEASUREMENTSCAN_H
+#define MEASUREMENTSCAN_H
+
+#include "oscilloscope.h"
+#include "adcconvert.h"
+
+/* bit of a measurement in a mask */
+#define MEASUREMENT_BIT(measure)    (1U << (measure))
+/* peak to peak counts below which edges are noise */
+#define MEASUREMENT_MIN_SWING       16
+
+class MeasurementScan
+{
+public:
+    /**
+     * @brief public typedef declarations
+     */
+    typedef enum
+    {
+        E_MEASURE_VPP = 0,
+        E_MEASURE_MEAN,
+        E_MEASURE_RMS,
+        E_MEASURE_FREQUENCY,
+        E_MEASURE_PERIOD,
+        /** @brief part of the period above the mid level, in % */
+        E_MEASURE_DUTY,
+        /** @brief 10 % to 90 % of the swing */
+        E_MEASURE_RISE,
+        E_MEASURE_FALL,
+        E_MEASURE_MAX
+    } measure_e;
+
+    typedef struct
+    {
+        /** @brief bit MEASUREMENT_BIT(m) is set when values[m] is valid */
+        uint32_t valid_mask;
+        /** @brief volts, seconds, Hz or % */
+        double values[E_MEASURE_MAX];
+    } result_t;
+
+    /** @brief what a kernel accumulates over the samples it scans */
+    typedef struct
+    {
+        int16_t minimum;
+        int16_t maximum;
+        int64_t sum;
+        uint64_t squares;
+    } accumulator_t;
+
+    /** @brief constructor, selects the best kernel for this CPU */
+    MeasurementScan();
+    /** @brief destructor */
+    ~MeasurementScan();
+
+    /**
+     * @brief measure one block
+     * @param[in] raw: ADC counts
+     * @param[in] scale, offset: volts = count * scale + offset
+     * @param[in] sample_interval: seconds between two samples
+     * @param[in] wanted: MEASUREMENT_BIT() of the measurements to compute
+     * @param[out] result: the wanted measurements the block allows
+     */
+    void measure(const int16_t *raw, uint32_t count, float scale, float offset, double sample_interval,
+                 uint32_t wanted, result_t *result);
+    /** @brief forget the levels, the next block does not follow this one */
+    void reset(void) { levels_valid_m = false; }
+
+    /** @brief force a kernel, false if this CPU cannot run it */
+    bool set_kernel(AdcConvert::kernel_e kernel);
+    AdcConvert::kernel_e get_kernel(void) const { return kernel_m; }
+
+    static const char* measure_name(measure_e measure);
+    static const char* measure_unit(measure_e measure);
+
+private:
+    /* edges of a block, times in samples from its first one */
+    typedef struct
+    {
+        uint32_t rising;
+        double first_rising;
+        double last_rising;
+        /** @brief time above the mid level in the periods between rising edges */
+        double high_time;
+        double pending_high;
+        uint32_t rise_count;
+        double rise_sum;
+        uint32_t fall_count;
+        double fall_sum;
+    } edges_t;
+
+    /*
+     * index of the first sample out of [lo, hi], count if none, the
+     * samples before it are added to accumulator, with their sums if asked
+     */
+    typedef uint32_t (*kernel_fn_t)(const int16_t *samples, uint32_t count, int16_t lo, int16_t hi,
+                                    bool sums, accumulator_t *accumulator);
+
+    MeasurementScan(const MeasurementScan&);
+    MeasurementScan& operator=(const MeasurementScan&);
+    /**
+     * @brief run the mid level comparator over a block and place its edges
+     * @param[in] accumulator: where the samples are added, as they are scanned
+     */
+    void scan_edges(const int16_t *raw, uint32_t count, bool sums, bool transitions,
+                    accumulator_t *accumulator, edges_t *edges) const;
+    /** @brief 10 % to 90 % time of the edge the comparator flipped on, false if it has none */
+    bool transition_time(const int16_t *raw, uint32_t count, uint32_t start, uint32_t flip,
+                         bool rising, double *duration) const;
+    /** @brief levels and comparator thresholds from the extremes */
+    void set_levels(int16_t minimum, int16_t maximum);
+
+    AdcConvert::kernel_e kernel_m;
+    kernel_fn_t scan_m;
+    /** @brief scan_m for the short runs between two edges */
+    kernel_fn_t edge_scan_m;
+    /** @brief extremes of the previous block, levels of the edges */
+    bool levels_valid_m;
+    int16_t level_min_m;
+    int16_t level_max_m;
+    /** @brief counts: 10 %, 50 % and 90 % of the swing */
+    double low_level_m;
+    double mid_level_m;
+    double high_level_m;
+    /** @brief counts: the comparator goes high at up_m and low at down_m */
+    int32_t up_m;
+    int32_t down_m;
+};
+
+#endif // MEASUREMENTSCAN_H
@@ -0,0 +1,386 @@
+/*****************************************************************************
+*   Copyright 2012 Vincent HERVIEUX
+*
+*   This file is part of QPicoscope.
+*
+*   QPicoscope is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU Lesser General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   any later version.
+*
+*   QPicoscope is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU Lesser General Public License for more details.
+*
+*   You should have received a copy of the GNU Lesser General Public License
+*   along with QPicoscope in files COPYING.LESSER and COPYING.
+*   If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+/**
+ * @file measurementworker.cpp
+ * @brief Definition of MeasurementWorker class.
+ * @version 0.1
+ * @date 2026, october 16
+ * @author Vincent HERVIEUX    -   10.16.2026   -   initial creation
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+#include "measurementworker.h"
+
+/* counts a volts range is spread over when the points come converted */
+#define MEASUREMENT_COUNTS_SPAN     65534.
+
+/****************************************************************************
+ *
+ * constructor
+ *
+ ****************************************************************************/
+MeasurementWorker::MeasurementWorker() :
+    frames_m(MEASUREMENT_QUEUE_DEPTH, 1024),
+    running_m(false),
+    quit_m(false),
+    posted_m(false),
+    reset_m(false),
+    result_count_m(0),
+    pipeline_stats_m(NULL),
+    counts_m(NULL),
+    counts_capacity_m(0),
+    blocks_m(0),
+    busy_ns_m(0)
+{
+    pthread_condattr_t attributes;
+
+    memset(&results_m, 0, sizeof(results_m));
+    pthread_mutex_init(&lock_m, NULL);
+    pthread_condattr_init(&attributes);
+    pthread_condattr_setclock(&attributes, CLOCK_MONOTONIC);
+    pthread_cond_init(&cond_m, &attributes);
+    pthread_condattr_destroy(&attributes);
+}
+
+/****************************************************************************
+ *
+ * destructor
+ *
+ ****************************************************************************/
+MeasurementWorker::~MeasurementWorker()
+{
+    stop();
+    pthread_cond_destroy(&cond_m);
+    pthread_mutex_destroy(&lock_m);
+    free(counts_m);
+}
+
+/****************************************************************************
+ * start
+ ****************************************************************************/
+bool MeasurementWorker::start(void)
+{
+    int ret = 0;
+
+    if (running_m)
+        return true;
+    /* no producer yet, leftovers of the previous run are dropped */
+    while (NULL != frames_m.takeNext())
+        frames_m.release();
+    pthread_mutex_lock(&lock_m);
+    reset_m = true;
+    pthread_mutex_unlock(&lock_m);
+
+    ret = pthread_create(&thread_m, NULL, MeasurementWorker::threadRun, this);
+    if (0 != ret)
+    {
+        ERROR("pthread_create failed and returned %d\n", ret);
+        return false;
+    }
+    running_m = true;
+    return true;
+}
+
+/****************************************************************************
+ * stop
+ ****************************************************************************/
+void MeasurementWorker::stop(void)
+{
+    if (!running_m)
+        return;
+    pthread_mutex_lock(&lock_m);
+    quit_m = true;
+    pthread_cond_signal(&cond_m);
+    pthread_mutex_unlock(&lock_m);
+    pthread_join(thread_m, NULL);
+    quit_m = false;
+    running_m = false;
+}
+
+/****************************************************************************
+ * setMeasures
+ ****************************************************************************/
+void MeasurementWorker::setMeasures(uint32_t measures)
+{
+    uint32_t changed = 0;
+    uint8_t ch = 0;
+    uint8_t m = 0;
+
+    pthread_mutex_lock(&lock_m);
+    changed = measures ^ results_m.measures;
+    for (m = 0; m < MeasurementScan::E_MEASURE_MAX; m++)
+    {
+        if (0 == (changed & MEASUREMENT_BIT(m)))
+            continue;
+        for (ch = 0; ch < MEASUREMENT_MAX_CHANNELS; ch++)
+            memset(&results_m.values[ch][m], 0, sizeof(statistics_t));
+    }
+    results_m.measures = measures;
+    ATOMIC_STORE_RELAXED(&result_count_m, result_count_m + 1);
+    pthread_mutex_unlock(&lock_m);
+}
+
+/****************************************************************************
+ * clear
+ ****************************************************************************/
+void MeasurementWorker::clear(void)
+{
+    pthread_mutex_lock(&lock_m);
+    memset(results_m.values, 0, sizeof(results_m.values));
+    results_m.channel_mask = 0;
+    reset_m = true;
+    ATOMIC_STORE_RELAXED(&result_count_m, result_count_m + 1);
+    pthread_cond_signal(&cond_m);
+    pthread_mutex_unlock(&lock_m);
+}
+
+/****************************************************************************
+ * publish
+ ****************************************************************************/
+bool MeasurementWorker::publish(void)
+{
+    if (!frames_m.publish())
+        return false;
+    pthread_mutex_lock(&lock_m);
+    posted_m = true;
+    pthread_cond_signal(&cond_m);
+    pthread_mutex_unlock(&lock_m);
+    return true;
+}
+
+/****************************************************************************
+ * getResults
+ ****************************************************************************/
+void MeasurementWorker::getResults(results_t *results)
+{
+    if (NULL == results)
+        return;
+    pthread_mutex_lock(&lock_m);
+    memcpy(results, &results_m, sizeof(results_t));
+    pthread_mutex_unlock(&lock_m);
+}
+
+/****************************************************************************
+ * deviation
+ ****************************************************************************/
+double MeasurementWorker::deviation(const statistics_t *statistics)
+{
+    if (statistics->count < 2)
+        return 0.;
+    return sqrt(statistics->m2 / (double)(statistics->count - 1));
+}
+
+/****************************************************************************
+ * getStats
+ ****************************************************************************/
+void MeasurementWorker::getStats(stats_t *stats) const
+{
+    FrameQueue::stats_t frame_stats;
+
+    if (NULL == stats)
+        return;
+    frames_m.getStats(&frame_stats);
+    stats->blocks = ATOMIC_LOAD_RELAXED(&blocks_m);
+    stats->dropped = frame_stats.dropped;
+    stats->busy_ns = ATOMIC_LOAD_RELAXED(&busy_ns_m);
+}
+
+/****************************************************************************
+ * threadRun
+ ****************************************************************************/
+void* MeasurementWorker::threadRun(void *arg)
+{
+    ((MeasurementWorker*)arg)->run();
+    return NULL;
+}
+
+/****************************************************************************
+ * toCounts
+ *
+ * Points given in volts are spread over the whole int16 range, so that
+ * they go through the same scan as the ADC counts.
+ ****************************************************************************/
+bool MeasurementWorker::toCounts(const FrameQueue::channel_frame_t *channel, float *scale, float *offset, double *interval)
+{
+    int16_t *grown = NULL;
+    double y_min = channel->y[0];
+    double y_max = channel->y[0];
+    double step = 0.;
+    double middle = 0.;
+    uint32_t i = 0;
+
+    if (channel->nb_points > counts_capacity_m)
+    {
+        grown = (int16_t*)realloc(counts_m, channel->nb_points * sizeof(int16_t));
+        if (NULL == grown)
+        {
+            ERROR("cannot allocate %u samples\n", channel->nb_points);
+            return false;
+        }
+        counts_m = grown;
+        counts_capacity_m = channel->nb_points;
+    }
+    for (i = 1; i < channel->nb_points; i++)
+    {
+        if (channel->y[i] < y_min)
+            y_min = channel->y[i];
+        if (channel->y[i] > y_max)
+            y_max = channel->y[i];
+    }
+    step = (y_max > y_min) ? (y_max - y_min) / MEASUREMENT_COUNTS_SPAN : 1.;
+    middle = (y_max + y_min) / 2.;
+    for (i = 0; i < channel->nb_points; i++)
+        counts_m[i] = (int16_t)floor((channel->y[i] - middle) / step + 0.5);
+    *scale = (float)step;
+    *offset = (float)middle;
+    *interval = (channel->nb_points > 1) ?
+        (channel->x[channel->nb_points - 1] - channel->x[0]) / (channel->nb_points - 1) : 0.;
+    return true;
+}
+
+/****************************************************************************
+ * drain
+ *
+ * Blocks are measured outside of the lock, the statistics are updated
+ * under it with Welford's method, one block at a time.
+ ****************************************************************************/
+void MeasurementWorker::drain(uint32_t measures)
+{
+    const FrameQueue::frame_t *frame = NULL;
+    const FrameQueue::channel_frame_t *channel = NULL;
+    PipelineStats *stats = ATOMIC_LOAD_ACQUIRE(&pipeline_stats_m);
+    MeasurementScan::result_t results[MEASUREMENT_MAX_CHANNELS];
+    statistics_t *statistics = NULL;
+    const int16_t *raw = NULL;
+    uint64_t start = 0;
+    uint64_t duration = 0;
+    float scale = 0.f;
+    float offset = 0.f;
+    double interval = 0.;
+    double delta = 0.;
+    double value = 0.;
+    uint8_t measured = 0;
+    uint8_t ch = 0;
+    uint8_t m = 0;
+
+    while (NULL != (frame = frames_m.takeNext()))
+    {
+        start = PipelineStats::now_ns();
+        measured = 0;
+        for (ch = 0; ch < MEASUREMENT_MAX_CHANNELS; ch++)
+        {
+            if (0 == (frame->channel_mask & (1 << ch)))
+                continue;
+            channel = &frame->channels[ch];
+            if (0 == channel->nb_points)
+                continue;
+            if (channel->is_raw)
+            {
+                raw = channel->raw;
+                scale = channel->scale;
+                offset = channel->offset;
+                interval = channel->x_interval;
+            }
+            else if (toCounts(channel, &scale, &offset, &interval))
+            {
+                raw = counts_m;
+            }
+            else
+            {
+                continue;
+            }
+            scans_m[ch].measure(raw, channel->nb_points, scale, offset, interval, measures, &results[ch]);
+            measured |= (uint8_t)(1 << ch);
+        }
+        frames_m.release();
+
+        pthread_mutex_lock(&lock_m);
+        /* measures changed meanwhile, the block does not go into the new statistics */
+        if (measures == results_m.measures)
+        {
+            for (ch = 0; ch < MEASUREMENT_MAX_CHANNELS; ch++)
+            {
+                if (0 == (measured & (1 << ch)))
+                    continue;
+                for (m = 0; m < MeasurementScan::E_MEASURE_MAX; m++)
+                {
+                    if (0 == (results[ch].valid_mask & MEASUREMENT_BIT(m)))
+                        continue;
+                    value = results[ch].values[m];
+                    statistics = &results_m.values[ch][m];
+                    statistics->count++;
+                    statistics->last = value;
+                    if ((1 == statistics->count) || (value < statistics->minimum))
+                        statistics->minimum = value;
+                    if ((1 == statistics->count) || (value > statistics->maximum))
+                        statistics->maximum = value;
+                    delta = value - statistics->mean;
+                    statistics->mean += delta / statistics->count;
+                    statistics->m2 += delta * (value - statistics->mean);
+                }
+            }
+            results_m.channel_mask |= measured;
+            ATOMIC_STORE_RELAXED(&result_count_m, result_count_m + 1);
+        }
+        pthread_mutex_unlock(&lock_m);
+
+        duration = PipelineStats::now_ns() - start;
+        ATOMIC_STORE_RELAXED(&blocks_m, blocks_m + 1);
+        ATOMIC_STORE_RELAXED(&busy_ns_m, busy_ns_m + duration);
+        if (NULL != stats)
+            stats->record_duration(PipelineStats::E_STAGE_MEASURE, duration);
+    }
+}
+
+/****************************************************************************
+ * run
+ ****************************************************************************/
+void MeasurementWorker::run(void)
+{
+    uint32_t measures = 0;
+    bool reset = false;
+    uint8_t ch = 0;
+
+    pthread_mutex_lock(&lock_m);
+    while (!quit_m)
+    {
+        reset = reset_m;
+        measures = results_m.measures;
+        reset_m = posted_m = false;
+        pthread_mutex_unlock(&lock_m);
+
+        if (reset)
+        {
+            for (ch = 0; ch < MEASUREMENT_MAX_CHANNELS; ch++)
+                scans_m[ch].reset();
+        }
+        drain(measures);
+
+        pthread_mutex_lock(&lock_m);
+        if (quit_m || posted_m || reset_m)
+            continue;
+        pthread_cond_wait(&cond_m, &lock_m);
+    }
+    pthread_mutex_unlock(&lock_m);
+}
@@ -0,0 +1,158 @@
+/*****************************************************************************
+*   Copyright 2012 Vincent HERVIEUX
+*
+*   This file is part of QPicoscope.
+*
+*   QPicoscope is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU Lesser General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   any later version.
+*
+*   QPicoscope is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU Lesser General Public License for more details.
+*
+*   You should have received a copy of the GNU Lesser General Public License
+*   along with QPicoscope in files COPYING.LESSER and COPYING.
+*   If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+/**
+ * @file measurementworker.h
+ * @brief Declaration of MeasurementWorker class.
+ * Blocks published by the acquisition are measured by a thread of their
+ * own, one MeasurementScan per channel, and every measurement keeps its
+ * last value and its minimum, maximum, mean and standard deviation over
+ * the blocks. The acquisition only copies the block, a late worker loses
+ * blocks instead of slowing it down.
+ * @version 0.1
+ * @date 2026, october 16
+ * @author Vincent HERVIEUX    -   10.16.2026   -   initial creation
+ */
+
+#ifndef MEASUREMENTWORKER_H
+#define MEASUREMENTWORKER_H
+
+#include <pthread.h>
+
+#include "oscilloscope.h"
+#include "atomic-ops.h"
+#include "framequeue.h"
+#include "measurementscan.h"
+#include "pipelinestats.h"
+
+/* blocks the acquisition may be ahead of the worker */
+#define MEASUREMENT_QUEUE_DEPTH     8
+#define MEASUREMENT_MAX_CHANNELS    FRAME_QUEUE_MAX_CHANNELS
+
+class MeasurementWorker
+{
+public:
+    /**
+     * @brief public typedef declarations
+     */
+    typedef struct
+    {
+        /** @brief blocks the measurement was valid in */
+        uint64_t count;
+        double last;
+        double minimum;
+        double maximum;
+        double mean;
+        /** @brief sum of the squared differences to the mean, see deviation() */
+        double m2;
+    } statistics_t;
+
+    typedef struct
+    {
+        /** @brief MEASUREMENT_BIT() of the measurements computed */
+        uint32_t measures;
+        /** @brief bit n is set when channel n+1 was measured */
+        uint8_t channel_mask;
+        statistics_t values[MEASUREMENT_MAX_CHANNELS][MeasurementScan::E_MEASURE_MAX];
+    } results_t;
+
+    typedef struct
+    {
+        /** @brief blocks measured */
+        uint64_t blocks;
+        /** @brief blocks lost because the worker was late */
+        uint64_t dropped;
+        /** @brief time spent measuring them, in ns */
+        uint64_t busy_ns;
+    } stats_t;
+
+    /** @brief constructor, the thread is not started */
+    MeasurementWorker();
+    /** @brief destructor, stops the thread */
+    ~MeasurementWorker();
+
+    /** @brief start the thread, blocks published before are discarded */
+    bool start(void);
+    /** @brief stop the thread, the results stay available */
+    void stop(void);
+    bool isRunning(void) const { return running_m; }
+
+    /** @brief MEASUREMENT_BIT() of the measurements to compute, the statistics of the changed ones are cleared */
+    void setMeasures(uint32_t measures);
+    /** @brief forget every statistic */
+    void clear(void);
+    /** @brief where the time spent per block is recorded, may be NULL */
+    void setPipelineStats(PipelineStats *stats) { ATOMIC_STORE_RELEASE(&pipeline_stats_m, stats); }
+
+    /**
+     * @brief producer side, same as FrameQueue::setChannel()
+     * Acquisition thread, like DrawData::setData().
+     */
+    int8_t setChannel(uint8_t channel_id, const double *x_data, const double *y_data, uint32_t nb_points)
+        { return frames_m.setChannel(channel_id, x_data, y_data, nb_points); }
+    /** @brief producer side, same as FrameQueue::setRawChannel() */
+    int8_t setRawChannel(uint8_t channel_id, const int16_t *raw, uint32_t nb_points,
+                         float scale, float offset, double x_origin, double x_interval)
+        { return frames_m.setRawChannel(channel_id, raw, nb_points, scale, offset, x_origin, x_interval); }
+    /** @brief producer side: hand the block over to the worker */
+    bool publish(void);
+
+    /** @brief copy the results, any thread */
+    void getResults(results_t *results);
+    /** @brief blocks measured so far, a change means the results must be shown again */
+    uint64_t resultCount(void) const { return ATOMIC_LOAD_RELAXED(&result_count_m); }
+    /** @brief standard deviation over the blocks, 0 below two */
+    static double deviation(const statistics_t *statistics);
+
+    /** @brief read the counters, any thread */
+    void getStats(stats_t *stats) const;
+
+private:
+    MeasurementWorker(const MeasurementWorker&);
+    MeasurementWorker& operator=(const MeasurementWorker&);
+
+    static void* threadRun(void *arg);
+    void run(void);
+    /** @brief measure every pending frame */
+    void drain(uint32_t measures);
+    /** @brief ADC counts of points given in volts, into counts_m */
+    bool toCounts(const FrameQueue::channel_frame_t *channel, float *scale, float *offset, double *interval);
+
+    MeasurementScan scans_m[MEASUREMENT_MAX_CHANNELS];
+    FrameQueue frames_m;
+    pthread_t thread_m;
+    bool running_m;
+    pthread_mutex_t lock_m;
+    pthread_cond_t cond_m;
+    /* protected by lock_m */
+    bool quit_m;
+    bool posted_m;
+    bool reset_m;
+    results_t results_m;
+    uint64_t result_count_m;
+
+    PipelineStats *pipeline_stats_m;
+    /* written by the worker only */
+    int16_t *counts_m;
+    uint32_t counts_capacity_m;
+    uint64_t blocks_m;
+    uint64_t busy_ns_m;
+};
+
+#endif // MEASUREMENTWORKER_H
@@ -0,0 +1,266 @@
+/*****************************************************************************
+*   Copyright 2012 Vincent HERVIEUX
+*
+*   This file is part of QPicoscope.
+*
+*   QPicoscope is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU Lesser General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   any later version.
+*
+*   QPicoscope is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU Lesser General Public License for more details.
+*
+*   You should have received a copy of the GNU Lesser General Public License
+*   along with QPicoscope in files COPYING.LESSER and COPYING.
+*   If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+/**
+ * @file minmaxpyramid.cpp
+ * @brief Definition of MinMaxPyramid class.
+ * @version 0.1
+ * @date 2026, october 16
+ * @author Vincent HERVIEUX    -   10.16.2026   -   initial creation
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "minmaxpyramid.h"
+
+#define MINMAX_PYRAMID_BUCKET    (1U << MINMAX_PYRAMID_BASE_SHIFT)
+
+/****************************************************************************
+ * merge
+ ****************************************************************************/
+static inline void merge(int16_t lo, int16_t hi, int16_t *minimum, int16_t *maximum)
+{
+    if (lo < *minimum)
+        *minimum = lo;
+    if (hi > *maximum)
+        *maximum = hi;
+}
+
+/****************************************************************************
+ *
+ * constructor
+ *
+ ****************************************************************************/
+MinMaxPyramid::MinMaxPyramid() :
+    raw_m(NULL),
+    nb_points_m(0),
+    capacity_m(0),
+    nb_levels_m(0),
+    capture_m(0)
+{
+    memset(min_m, 0, sizeof(min_m));
+    memset(max_m, 0, sizeof(max_m));
+    memset(count_m, 0, sizeof(count_m));
+    memset(min_capacity_m, 0, sizeof(min_capacity_m));
+    memset(max_capacity_m, 0, sizeof(max_capacity_m));
+}
+
+/****************************************************************************
+ *
+ * destructor
+ *
+ ****************************************************************************/
+MinMaxPyramid::~MinMaxPyramid()
+{
+    uint8_t level = 0;
+
+    free(raw_m);
+    for (level = 0; level < MINMAX_PYRAMID_MAX_LEVELS; level++)
+    {
+        free(min_m[level]);
+        free(max_m[level]);
+    }
+}
+
+/****************************************************************************
+ * clear
+ ****************************************************************************/
+void MinMaxPyramid::clear(void)
+{
+    nb_points_m = 0;
+    nb_levels_m = 0;
+    capture_m = 0;
+    memset(count_m, 0, sizeof(count_m));
+}
+
+/****************************************************************************
+ * assign
+ ****************************************************************************/
+bool MinMaxPyramid::assign(uint64_t capture, const int16_t *raw, uint32_t count)
+{
+    uint32_t known = nb_points_m;
+
+    if ((0 == capture) || (capture != capture_m) || (count < known))
+    {
+        clear();
+        known = 0;
+    }
+    if (!append(raw + known, count - known))
+    {
+        clear();
+        return false;
+    }
+    capture_m = capture;
+    return true;
+}
+
+/****************************************************************************
+ * reserve
+ *
+ * Capacity doubles so that a record growing block after block is copied
+ * a logarithmic number of times only.
+ ****************************************************************************/
+bool MinMaxPyramid::reserve(int16_t **table, uint32_t *capacity, uint32_t nb_points)
+{
+    int16_t *grown = NULL;
+    uint64_t new_capacity = *capacity;
+
+    if (*capacity >= nb_points)
+        return true;
+
+    if (new_capacity < MINMAX_PYRAMID_BUCKET)
+        new_capacity = MINMAX_PYRAMID_BUCKET;
+    while (new_capacity < nb_points)
+        new_capacity *= 2;
+    if (new_capacity > UINT32_MAX)
+        new_capacity = UINT32_MAX;
+
+    grown = (int16_t*)realloc(*table, new_capacity * sizeof(int16_t));
+    if (NULL == grown)
+        return false;
+    *table = grown;
+    *capacity = (uint32_t)new_capacity;
+    return true;
+}
+
+/****************************************************************************
+ * append
+ *
+ * Only the buckets completed by the new samples are computed: level 0 from
+ * the samples, every next level from the two nodes below. Nodes already
+ * built never change, so the pyramid is valid after each block.
+ ****************************************************************************/
+bool MinMaxPyramid::append(const int16_t *raw, uint32_t count)
+{
+    uint32_t nb_points = nb_points_m + count;
+    uint32_t node = 0;
+    uint32_t nodes = 0;
+    uint8_t level = 0;
+
+    if ((NULL == raw) || (0 == count))
+        return true;
+    if (nb_points < nb_points_m)
+    {
+        ERROR("record longer than %u samples\n", UINT32_MAX);
+        return false;
+    }
+
+    /* allocate everything first, the record is left unchanged on failure */
+    if (!reserve(&raw_m, &capacity_m, nb_points))
+        goto no_memory;
+    for (level = 0; level < MINMAX_PYRAMID_MAX_LEVELS; level++)
+    {
+        nodes = nb_points >> (MINMAX_PYRAMID_BASE_SHIFT + level);
+        if (0 == nodes)
+            break;
+        if (!reserve(&min_m[level], &min_capacity_m[level], nodes) ||
+            !reserve(&max_m[level], &max_capacity_m[level], nodes))
+            goto no_memory;
+    }
+
+    memcpy(raw_m + nb_points_m, raw, count * sizeof(int16_t));
+    nb_points_m = nb_points;
+
+    nodes = nb_points_m >> MINMAX_PYRAMID_BASE_SHIFT;
+    for (node = count_m[0]; node < nodes; node++)
+        scanner_m.minMax(raw_m + node * MINMAX_PYRAMID_BUCKET, MINMAX_PYRAMID_BUCKET, &min_m[0][node], &max_m[0][node]);
+    count_m[0] = nodes;
+
+    for (level = 1; level < MINMAX_PYRAMID_MAX_LEVELS; level++)
+    {
+        nodes = count_m[level - 1] >> 1;
+        if (0 == nodes)
+            break;
+        for (node = count_m[level]; node < nodes; node++)
+        {
+            min_m[level][node] = min_m[level - 1][2 * node];
+            max_m[level][node] = max_m[level - 1][2 * node];
+            merge(min_m[level - 1][2 * node + 1], max_m[level - 1][2 * node + 1],
+                  &min_m[level][node], &max_m[level][node]);
+        }
+        count_m[level] = nodes;
+    }
+    nb_levels_m = (count_m[0] > 0) ? level : 0;
+    return true;
+
+no_memory:
+    ERROR("cannot allocate %u samples\n", nb_points);
+    return false;
+}
+
+/****************************************************************************
+ * minMax
+ *
+ * Samples before the first and after the last complete level 0 bucket are
+ * scanned, then the bucket range is narrowed level after level like in a
+ * segment tree: an odd bound takes its own node and the rest goes to the
+ * parent level. At most two nodes per level are read.
+ ****************************************************************************/
+void MinMaxPyramid::minMax(uint32_t begin, uint32_t end, int16_t *minimum, int16_t *maximum) const
+{
+    uint32_t first = (uint32_t)(((uint64_t)begin + MINMAX_PYRAMID_BUCKET - 1) >> MINMAX_PYRAMID_BASE_SHIFT);
+    uint32_t last = end >> MINMAX_PYRAMID_BASE_SHIFT;
+    int16_t lo = 0;
+    int16_t hi = 0;
+    uint8_t level = 0;
+
+    if (first >= last)
+    {
+        scanner_m.minMax(raw_m + begin, end - begin, minimum, maximum);
+        return;
+    }
+
+    *minimum = INT16_MAX;
+    *maximum = INT16_MIN;
+    if (begin < first * MINMAX_PYRAMID_BUCKET)
+    {
+        scanner_m.minMax(raw_m + begin, first * MINMAX_PYRAMID_BUCKET - begin, &lo, &hi);
+        merge(lo, hi, minimum, maximum);
+    }
+    if (last * MINMAX_PYRAMID_BUCKET < end)
+    {
+        scanner_m.minMax(raw_m + last * MINMAX_PYRAMID_BUCKET, end - last * MINMAX_PYRAMID_BUCKET, &lo, &hi);
+        merge(lo, hi, minimum, maximum);
+    }
+
+    while (first < last)
+    {
+        if (level + 1 >= nb_levels_m)
+        {
+            /* top level, only a node or two are left */
+            for (; first < last; first++)
+                merge(min_m[level][first], max_m[level][first], minimum, maximum);
+            break;
+        }
+        if (first & 1)
+        {
+            merge(min_m[level][first], max_m[level][first], minimum, maximum);
+            first++;
+        }
+        if (last & 1)
+        {
+            last--;
+            merge(min_m[level][last], max_m[level][last], minimum, maximum);
+        }
+        first >>= 1;
+        last >>= 1;
+        level++;
+    }
+}
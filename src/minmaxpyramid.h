@@ -0,0 +1,103 @@
+/*****************************************************************************
+*   Copyright 2012 Vincent HERVIEUX
+*
+*   This file is part of QPicoscope.
+*
+*   QPicoscope is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU Lesser General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   any later version.
+*
+*   QPicoscope is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU Lesser General Public License for more details.
+*
+*   You should have received a copy of the GNU Lesser General Public License
+*   along with QPicoscope in files COPYING.LESSER and COPYING.
+*   If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+/**
+ * @file minmaxpyramid.h
+ * @brief Declaration of MinMaxPyramid class.
+ * ADC counts of a record with a min/max level of detail index next to them.
+ * Level 0 holds the minimum and the maximum of every bucket of
+ * 2^MINMAX_PYRAMID_BASE_SHIFT samples, each next level halves the previous
+ * one. The exact minimum and maximum of any sample range is then found from
+ * a few nodes per level, so a view of any width is decimated in about
+ * O(columns * levels) instead of O(samples).
+ * Samples are appended as blocks arrive: complete buckets are indexed at
+ * once, the incomplete tail is scanned from the samples when queried.
+ * @version 0.1
+ * @date 2026, october 16
+ * @author Vincent HERVIEUX    -   10.16.2026   -   initial creation
+ */
+
+#ifndef MINMAXPYRAMID_H
+#define MINMAXPYRAMID_H
+
+#include "oscilloscope.h"
+#include "decimator.h"
+
+/* level 0 buckets hold 16 samples, one AVX2 register */
+#define MINMAX_PYRAMID_BASE_SHIFT    4
+/* enough for 2^32 samples */
+#define MINMAX_PYRAMID_MAX_LEVELS    (32 - MINMAX_PYRAMID_BASE_SHIFT)
+
+class MinMaxPyramid
+{
+public:
+    /** @brief constructor */
+    MinMaxPyramid();
+    /** @brief destructor */
+    ~MinMaxPyramid();
+
+    /** @brief forget every sample, memory is kept for the next record */
+    void clear(void);
+    /**
+     * @brief add samples at the end of the record and index them
+     * @return false if memory is exhausted, the record is unchanged then
+     */
+    bool append(const int16_t *raw, uint32_t count);
+    /**
+     * @brief hold the table of a capture
+     * A table of the capture held, at least as long, has its new samples
+     * appended only. Any other capture rebuilds the record.
+     * @param[in] capture: producer id of the capture, never 0
+     * @return false if memory is exhausted, the record is empty then
+     */
+    bool assign(uint64_t capture, const int16_t *raw, uint32_t count);
+    /** @brief number of samples */
+    uint32_t size(void) const { return nb_points_m; }
+    /** @brief the samples, valid until the next append() */
+    const int16_t* data(void) const { return raw_m; }
+    /** @brief number of levels built */
+    uint8_t levels(void) const { return nb_levels_m; }
+    /**
+     * @brief exact minimum and maximum of samples [begin, end[
+     * @param[in] begin, end: begin < end <= size()
+     */
+    void minMax(uint32_t begin, uint32_t end, int16_t *minimum, int16_t *maximum) const;
+
+private:
+    MinMaxPyramid(const MinMaxPyramid&);
+    MinMaxPyramid& operator=(const MinMaxPyramid&);
+    bool reserve(int16_t **table, uint32_t *capacity, uint32_t nb_points);
+
+    /** @brief only used for its SIMD min/max scan */
+    Decimator scanner_m;
+    int16_t *raw_m;
+    uint32_t nb_points_m;
+    uint32_t capacity_m;
+    int16_t *min_m[MINMAX_PYRAMID_MAX_LEVELS];
+    int16_t *max_m[MINMAX_PYRAMID_MAX_LEVELS];
+    /** @brief complete nodes in each level */
+    uint32_t count_m[MINMAX_PYRAMID_MAX_LEVELS];
+    uint32_t min_capacity_m[MINMAX_PYRAMID_MAX_LEVELS];
+    uint32_t max_capacity_m[MINMAX_PYRAMID_MAX_LEVELS];
+    uint8_t nb_levels_m;
+    /** @brief capture held by assign(), 0 if none */
+    uint64_t capture_m;
+};
+
+#endif // MINMAXPYRAMID_H
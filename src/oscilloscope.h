@@ -32,6 +32,8 @@
 #include <stdio.h>
 #include <limits.h>
 
+#include "logger.h"
+
 /*!!! TODO remove this flag while testing with HW!!!*/
 //#define TEST_WITHOUT_HW
 
@@ -75,8 +77,25 @@ typedef enum
     E_TRIGGER_FALLING
 }trigger_e;
 
-#define DEBUG(...)     do{ fprintf(stderr, "%s\t- %s:\t[%d]\tDEBUG: ",__FILE__, __FUNCTION__,__LINE__); fprintf(stderr, __VA_ARGS__); }while(0)
-#define ERROR(...)     do{ fprintf(stderr, "%s\t- %s:\t[%d]\tERROR: ",__FILE__, __FUNCTION__,__LINE__); fprintf(stderr, __VA_ARGS__); }while(0)
-#define WARNING(...)   do{ fprintf(stderr, "%s\t- %s:\t[%d]\tWARNING: ",__FILE__, __FUNCTION__,__LINE__); fprintf(stderr, __VA_ARGS__); }while(0)
+/* highest level compiled in, build with -DLOG_LEVEL=LOG_LEVEL_DEBUG to get the DEBUG messages */
+#ifndef LOG_LEVEL
+#define LOG_LEVEL      LOG_LEVEL_WARNING
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_DEBUG
+#define DEBUG(...)     do{ Logger::write(LOG_LEVEL_DEBUG, __FILE__, __FUNCTION__, __LINE__, __VA_ARGS__); }while(0)
+#else
+#define DEBUG(...)     do{ if(0) Logger::discard(__VA_ARGS__); }while(0)
+#endif
+#if LOG_LEVEL >= LOG_LEVEL_ERROR
+#define ERROR(...)     do{ Logger::write(LOG_LEVEL_ERROR, __FILE__, __FUNCTION__, __LINE__, __VA_ARGS__); }while(0)
+#else
+#define ERROR(...)     do{ if(0) Logger::discard(__VA_ARGS__); }while(0)
+#endif
+#if LOG_LEVEL >= LOG_LEVEL_WARNING
+#define WARNING(...)   do{ Logger::write(LOG_LEVEL_WARNING, __FILE__, __FUNCTION__, __LINE__, __VA_ARGS__); }while(0)
+#else
+#define WARNING(...)   do{ if(0) Logger::discard(__VA_ARGS__); }while(0)
+#endif
 
 #endif // OSCILLOSCOPE_H
@@ -0,0 +1,577 @@
+/*****************************************************************************
+*   Copyright 2012 Vincent HERVIEUX
+*
+*   This file is part of QPicoscope.
+*
+*   QPicoscope is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU Lesser General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   any later version.
+*
+*   QPicoscope is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU Lesser General Public License for more details.
+*
+*   You should have received a copy of the GNU Lesser General Public License
+*   along with QPicoscope in files COPYING.LESSER and COPYING.
+*   If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+/**
+ * @file persistencebuffer.cpp
+ * @brief Definition of PersistenceBuffer class.
+ * @version 0.1
+ * @date 2026, october 16
+ * @author Vincent HERVIEUX    -   10.16.2026   -   initial creation
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "persistencebuffer.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define PERSISTENCE_X86
+#include <immintrin.h>
+#endif
+#if defined(__aarch64__) && defined(__ARM_NEON)
+#define PERSISTENCE_NEON
+#include <arm_neon.h>
+#endif
+
+/* grades from the trace color to white */
+#define PERSISTENCE_WHITE_LEVEL     192
+/* alpha of the faintest grade, the grid shows through */
+#define PERSISTENCE_MIN_ALPHA       48
+
+/****************************************************************************
+ * add_scalar
+ *
+ * Counter c of row y is incremented when top[c] <= y <= bottom[c], it
+ * stays at its maximum once there.
+ ****************************************************************************/
+static void add_scalar(uint16_t *hits, uint32_t stride, const int32_t *top, const int32_t *bottom,
+                       int32_t first, int32_t last)
+{
+    uint16_t *row = hits + (size_t)first * stride;
+    int32_t y = 0;
+    uint32_t c = 0;
+
+    for (y = first; y <= last; y++, row += stride)
+    {
+        for (c = 0; c < COLUMN_SPANS_GROUP; c++)
+            row[c] += ((top[c] <= y) & (y <= bottom[c]) & (row[c] != UINT16_MAX));
+    }
+}
+
+/****************************************************************************
+ * decay_scalar
+ ****************************************************************************/
+static void decay_scalar(uint16_t *hits, size_t count, uint16_t factor)
+{
+    size_t i = 0;
+
+    for (i = 0; i < count; i++)
+        hits[i] = (uint16_t)(((uint32_t)hits[i] * factor) >> 16);
+}
+
+#ifdef PERSISTENCE_X86
+/****************************************************************************
+ * add_sse2
+ *
+ * Rows fit in 16 bits, a group of 8 columns is one register.
+ ****************************************************************************/
+__attribute__((target("sse2")))
+static void add_sse2(uint16_t *hits, uint32_t stride, const int32_t *top, const int32_t *bottom,
+                     int32_t first, int32_t last)
+{
+    __m128i top_row = _mm_packs_epi32(_mm_load_si128((const __m128i*)top), _mm_load_si128((const __m128i*)(top + 4)));
+    __m128i bottom_row = _mm_packs_epi32(_mm_load_si128((const __m128i*)bottom),
+                                         _mm_load_si128((const __m128i*)(bottom + 4)));
+    __m128i one = _mm_set1_epi16(1);
+    __m128i row_y;
+    __m128i outside;
+    uint16_t *row = hits + (size_t)first * stride;
+    int32_t y = 0;
+
+    for (y = first; y <= last; y++, row += stride)
+    {
+        row_y = _mm_set1_epi16((short)y);
+        outside = _mm_or_si128(_mm_cmpgt_epi16(top_row, row_y), _mm_cmpgt_epi16(row_y, bottom_row));
+        _mm_store_si128((__m128i*)row, _mm_adds_epu16(_mm_load_si128((const __m128i*)row), _mm_andnot_si128(outside, one)));
+    }
+}
+
+/****************************************************************************
+ * decay_sse2
+ ****************************************************************************/
+__attribute__((target("sse2")))
+static void decay_sse2(uint16_t *hits, size_t count, uint16_t factor)
+{
+    __m128i multiplier = _mm_set1_epi16((short)factor);
+    size_t i = 0;
+
+    /* count is a multiple of COLUMN_SPANS_GROUP, hits are aligned */
+    for (i = 0; i < count; i += 8)
+        _mm_store_si128((__m128i*)(hits + i), _mm_mulhi_epu16(_mm_load_si128((const __m128i*)(hits + i)), multiplier));
+}
+
+/****************************************************************************
+ * decay_avx2
+ ****************************************************************************/
+__attribute__((target("avx2")))
+static void decay_avx2(uint16_t *hits, size_t count, uint16_t factor)
+{
+    __m256i multiplier = _mm256_set1_epi16((short)factor);
+    size_t i = 0;
+
+    for (i = 0; i + 16 <= count; i += 16)
+        _mm256_store_si256((__m256i*)(hits + i), _mm256_mulhi_epu16(_mm256_load_si256((const __m256i*)(hits + i)), multiplier));
+    if (i < count)
+        _mm_store_si128((__m128i*)(hits + i), _mm_mulhi_epu16(_mm_load_si128((const __m128i*)(hits + i)),
+                                                                _mm256_castsi256_si128(multiplier)));
+}
+#endif
+
+#ifdef PERSISTENCE_NEON
+/****************************************************************************
+ * add_neon
+ ****************************************************************************/
+static void add_neon(uint16_t *hits, uint32_t stride, const int32_t *top, const int32_t *bottom,
+                     int32_t first, int32_t last)
+{
+    int16x8_t top_row = vcombine_s16(vqmovn_s32(vld1q_s32(top)), vqmovn_s32(vld1q_s32(top + 4)));
+    int16x8_t bottom_row = vcombine_s16(vqmovn_s32(vld1q_s32(bottom)), vqmovn_s32(vld1q_s32(bottom + 4)));
+    uint16x8_t one = vdupq_n_u16(1);
+    int16x8_t row_y;
+    uint16_t *row = hits + (size_t)first * stride;
+    int32_t y = 0;
+
+    for (y = first; y <= last; y++, row += stride)
+    {
+        row_y = vdupq_n_s16((int16_t)y);
+        vst1q_u16(row, vqaddq_u16(vld1q_u16(row),
+                                  vandq_u16(vandq_u16(vcleq_s16(top_row, row_y), vcleq_s16(row_y, bottom_row)), one)));
+    }
+}
+
+/****************************************************************************
+ * decay_neon
+ ****************************************************************************/
+static void decay_neon(uint16_t *hits, size_t count, uint16_t factor)
+{
+    uint16x4_t multiplier = vdup_n_u16(factor);
+    uint16x8_t counts;
+    size_t i = 0;
+
+    for (i = 0; i < count; i += 8)
+    {
+        counts = vld1q_u16(hits + i);
+        vst1q_u16(hits + i, vcombine_u16(vshrn_n_u32(vmull_u16(vget_low_u16(counts), multiplier), 16),
+                                         vshrn_n_u32(vmull_u16(vget_high_u16(counts), multiplier), 16)));
+    }
+}
+#endif
+
+/****************************************************************************
+ * log_grade
+ *
+ * log2(count) in 1/16 steps, from 0 for 1 to 255 for 65535.
+ ****************************************************************************/
+static inline uint32_t log_grade(uint32_t count)
+{
+    uint32_t exponent = 0;
+
+#if defined(__GNUC__)
+    exponent = 31 - __builtin_clz(count);
+#else
+    while (count >> (exponent + 1))
+        exponent++;
+#endif
+    return (exponent << 4) | (((count << (15 - exponent)) >> 11) & 15);
+}
+
+/****************************************************************************
+ *
+ * constructor
+ *
+ ****************************************************************************/
+PersistenceBuffer::PersistenceBuffer() :
+    kernel_m(AdcConvert::E_KERNEL_SCALAR),
+    add_m(add_scalar),
+    decay_m(decay_scalar),
+    x_m(NULL),
+    y_m(NULL),
+    capacity_m(0),
+    width_m(0),
+    height_m(0),
+    stride_m(0),
+    x_min_m(0.),
+    x_max_m(0.),
+    x_scale_m(0.),
+    x_offset_m(0.),
+    y_scale_m(0.),
+    y_offset_m(0.)
+{
+    uint8_t ch = 0;
+
+    for (ch = 0; ch < PERSISTENCE_MAX_CHANNELS; ch++)
+    {
+        hits_m[ch] = NULL;
+        max_hits_m[ch] = 0;
+        setColor(ch, 0xFFFFFFFF);
+    }
+    setKernel(AdcConvert::best_kernel());
+}
+
+/****************************************************************************
+ *
+ * destructor
+ *
+ ****************************************************************************/
+PersistenceBuffer::~PersistenceBuffer()
+{
+    uint8_t ch = 0;
+
+    for (ch = 0; ch < PERSISTENCE_MAX_CHANNELS; ch++)
+        free(hits_m[ch]);
+    free(x_m);
+    free(y_m);
+}
+
+/****************************************************************************
+ * setKernel
+ *
+ * Accumulation works on 8 columns, one 128 bits register: AVX2 only
+ * speeds up the decay.
+ ****************************************************************************/
+bool PersistenceBuffer::setKernel(AdcConvert::kernel_e kernel)
+{
+    add_fn_t add = NULL;
+    decay_fn_t decay = NULL;
+
+    if (AdcConvert::is_supported(kernel))
+    {
+        switch (kernel)
+        {
+#ifdef PERSISTENCE_X86
+        case AdcConvert::E_KERNEL_SSE2:
+            add = add_sse2;
+            decay = decay_sse2;
+            break;
+        case AdcConvert::E_KERNEL_AVX2:
+            add = add_sse2;
+            decay = decay_avx2;
+            break;
+#endif
+#ifdef PERSISTENCE_NEON
+        case AdcConvert::E_KERNEL_NEON:
+            add = add_neon;
+            decay = decay_neon;
+            break;
+#endif
+        case AdcConvert::E_KERNEL_SCALAR:
+            add = add_scalar;
+            decay = decay_scalar;
+            break;
+        default:
+            break;
+        }
+    }
+    if (NULL == add)
+    {
+        WARNING("%s kernel not supported, keeping %s\n", AdcConvert::kernel_name(kernel), AdcConvert::kernel_name(kernel_m));
+        return false;
+    }
+    kernel_m = kernel;
+    add_m = add;
+    decay_m = decay;
+    decimator_m.setKernel(kernel);
+    return true;
+}
+
+/****************************************************************************
+ * resize
+ ****************************************************************************/
+bool PersistenceBuffer::resize(uint32_t width, uint32_t height)
+{
+    void *hits = NULL;
+    uint8_t ch = 0;
+
+    if ((width == width_m) && (height == height_m) && (NULL != hits_m[0]))
+    {
+        clear();
+        return true;
+    }
+    if (!spans_m.resize(width, height))
+        goto no_memory;
+    for (ch = 0; ch < PERSISTENCE_MAX_CHANNELS; ch++)
+    {
+        if (0 != posix_memalign(&hits, 32, (size_t)spans_m.stride() * height * sizeof(uint16_t)))
+            goto no_memory;
+        free(hits_m[ch]);
+        hits_m[ch] = (uint16_t*)hits;
+    }
+    width_m = width;
+    height_m = height;
+    stride_m = spans_m.stride();
+    clear();
+    return true;
+
+no_memory:
+    ERROR("cannot allocate %ux%u counters\n", width, height);
+    for (ch = 0; ch < PERSISTENCE_MAX_CHANNELS; ch++)
+    {
+        free(hits_m[ch]);
+        hits_m[ch] = NULL;
+    }
+    width_m = height_m = stride_m = 0;
+    return false;
+}
+
+/****************************************************************************
+ * setView
+ *
+ * Column c holds x in [x_min + c * w, x_min + (c + 1) * w[, like the
+ * columns of Decimator. Row 0 is y_max.
+ ****************************************************************************/
+void PersistenceBuffer::setView(double x_min, double x_max, double y_min, double y_max)
+{
+    x_min_m = x_min;
+    x_max_m = x_max;
+    if ((x_max > x_min) && (y_max > y_min))
+    {
+        x_scale_m = width_m / (x_max - x_min);
+        x_offset_m = -x_min * x_scale_m;
+        y_scale_m = -(height_m / (y_max - y_min));
+        y_offset_m = -y_max * y_scale_m - 0.5;
+    }
+    else
+    {
+        x_max_m = x_min_m;
+    }
+    clear();
+}
+
+/****************************************************************************
+ * clear
+ ****************************************************************************/
+void PersistenceBuffer::clear(void)
+{
+    uint8_t ch = 0;
+
+    for (ch = 0; ch < PERSISTENCE_MAX_CHANNELS; ch++)
+    {
+        if (NULL != hits_m[ch])
+            memset(hits_m[ch], 0, (size_t)stride_m * height_m * sizeof(uint16_t));
+        max_hits_m[ch] = 0;
+    }
+}
+
+/****************************************************************************
+ * setColor
+ ****************************************************************************/
+void PersistenceBuffer::setColor(uint8_t channel, uint32_t color)
+{
+    if (channel >= PERSISTENCE_MAX_CHANNELS)
+        return;
+    color_m[channel] = color;
+    updatePalette(channel);
+}
+
+/****************************************************************************
+ * updatePalette
+ *
+ * Grades go from the trace color, faint and mostly transparent, to the
+ * opaque trace color then to white for the most hit pixels.
+ ****************************************************************************/
+void PersistenceBuffer::updatePalette(uint8_t channel)
+{
+    uint32_t color = color_m[channel];
+    uint32_t level = 0;
+    uint32_t alpha = 0;
+    uint32_t whiten = 0;
+    uint32_t component = 0;
+    uint32_t shift = 0;
+    uint32_t pixel = 0;
+
+    palette_m[channel][0] = 0;
+    for (level = 1; level < PERSISTENCE_LEVELS; level++)
+    {
+        alpha = PERSISTENCE_MIN_ALPHA + level * (255 - PERSISTENCE_MIN_ALPHA) / (PERSISTENCE_LEVELS - 1);
+        whiten = (level > PERSISTENCE_WHITE_LEVEL) ?
+                 (level - PERSISTENCE_WHITE_LEVEL) * 255 / (PERSISTENCE_LEVELS - 1 - PERSISTENCE_WHITE_LEVEL) : 0;
+        pixel = alpha << 24;
+        for (shift = 0; shift < 24; shift += 8)
+        {
+            component = (color >> shift) & 0xFF;
+            component += (255 - component) * whiten / 255;
+            pixel |= (component * alpha / 255) << shift;
+        }
+        palette_m[channel][level] = pixel;
+    }
+}
+
+/****************************************************************************
+ * reserve
+ ****************************************************************************/
+bool PersistenceBuffer::reserve(uint32_t nb_points)
+{
+    double *x = NULL;
+    double *y = NULL;
+
+    if (nb_points <= capacity_m)
+        return true;
+    x = (double*)realloc(x_m, nb_points * sizeof(double));
+    if (NULL != x)
+        x_m = x;
+    y = (double*)realloc(y_m, nb_points * sizeof(double));
+    if (NULL != y)
+        y_m = y;
+    if ((NULL == x) || (NULL == y))
+    {
+        ERROR("cannot allocate %u points\n", nb_points);
+        return false;
+    }
+    capacity_m = nb_points;
+    return true;
+}
+
+/****************************************************************************
+ * addRaw
+ ****************************************************************************/
+void PersistenceBuffer::addRaw(uint8_t channel, const int16_t *raw, uint32_t nb_points,
+                               float scale, float offset, double x_origin, double x_interval)
+{
+    uint32_t count = 0;
+    uint32_t i = 0;
+
+    if ((channel >= PERSISTENCE_MAX_CHANNELS) || (NULL == hits_m[channel]) || (x_max_m <= x_min_m) || (0 == nb_points))
+        return;
+    if (Decimator::isNeeded(nb_points, width_m))
+    {
+        count = decimator_m.decimate(raw, nb_points, scale, offset, x_origin, x_interval, x_min_m, x_max_m, width_m);
+        spans_m.set(decimator_m.x(), decimator_m.y(), count, x_scale_m, x_offset_m, y_scale_m, y_offset_m);
+    }
+    else
+    {
+        if (!reserve(nb_points))
+            return;
+        for (i = 0; i < nb_points; i++)
+        {
+            x_m[i] = x_origin + i * x_interval;
+            y_m[i] = raw[i] * scale + offset;
+        }
+        spans_m.set(x_m, y_m, nb_points, x_scale_m, x_offset_m, y_scale_m, y_offset_m);
+    }
+    addSpans(channel);
+}
+
+/****************************************************************************
+ * addPoints
+ ****************************************************************************/
+void PersistenceBuffer::addPoints(uint8_t channel, const double *x, const double *y, uint32_t nb_points)
+{
+    if ((channel >= PERSISTENCE_MAX_CHANNELS) || (NULL == hits_m[channel]) || (x_max_m <= x_min_m))
+        return;
+    spans_m.set(x, y, nb_points, x_scale_m, x_offset_m, y_scale_m, y_offset_m);
+    addSpans(channel);
+}
+
+/****************************************************************************
+ * addSpans
+ ****************************************************************************/
+void PersistenceBuffer::addSpans(uint8_t channel)
+{
+    const int32_t *group_top = spans_m.groupTop();
+    const int32_t *group_bottom = spans_m.groupBottom();
+    uint32_t g = 0;
+
+    for (g = 0; g < stride_m / COLUMN_SPANS_GROUP; g++)
+    {
+        if (group_top[g] <= group_bottom[g])
+            add_m(hits_m[channel] + g * COLUMN_SPANS_GROUP, stride_m, spans_m.top() + g * COLUMN_SPANS_GROUP,
+                  spans_m.bottom() + g * COLUMN_SPANS_GROUP, group_top[g], group_bottom[g]);
+    }
+    if (max_hits_m[channel] < UINT16_MAX)
+        max_hits_m[channel]++;
+}
+
+/****************************************************************************
+ * decay
+ ****************************************************************************/
+void PersistenceBuffer::decay(double factor)
+{
+    uint16_t multiplier = 0;
+    uint8_t ch = 0;
+
+    if (factor >= 1.)
+        return;
+    multiplier = (factor > 0.) ? (uint16_t)(factor * 65536.) : 0;
+    for (ch = 0; ch < PERSISTENCE_MAX_CHANNELS; ch++)
+    {
+        if ((NULL == hits_m[ch]) || (0 == max_hits_m[ch]))
+            continue;
+        decay_m(hits_m[ch], (size_t)stride_m * height_m, multiplier);
+        max_hits_m[ch] = (max_hits_m[ch] * multiplier) >> 16;
+    }
+}
+
+/****************************************************************************
+ * render
+ *
+ * Grades are log2(count) / log2(maximum count), so that one hit stays
+ * visible whatever the maximum. Most counters are 0, they are skipped 4
+ * at a time. The maximum is measured on the way for the next call.
+ ****************************************************************************/
+void PersistenceBuffer::render(uint32_t *pixels, uint32_t pixels_stride)
+{
+    uint8_t levels[PERSISTENCE_LEVELS];
+    const uint16_t *hits = NULL;
+    const uint32_t *palette = NULL;
+    uint32_t *pixel = NULL;
+    uint64_t four = 0;
+    uint32_t top_grade = 0;
+    uint32_t maximum = 0;
+    uint32_t grade = 0;
+    uint32_t y = 0;
+    uint32_t c = 0;
+    uint32_t k = 0;
+    uint8_t ch = 0;
+
+    for (y = 0; y < height_m; y++)
+        memset(pixels + (size_t)y * pixels_stride, 0, width_m * sizeof(uint32_t));
+
+    for (ch = 0; ch < PERSISTENCE_MAX_CHANNELS; ch++)
+    {
+        if ((NULL == hits_m[ch]) || (0 == max_hits_m[ch]))
+            continue;
+        top_grade = log_grade(max_hits_m[ch]);
+        for (grade = 0; grade < PERSISTENCE_LEVELS; grade++)
+            levels[grade] = ((0 == top_grade) || (grade >= top_grade)) ?
+                            (PERSISTENCE_LEVELS - 1) : (uint8_t)(1 + grade * (PERSISTENCE_LEVELS - 2) / top_grade);
+        palette = palette_m[ch];
+        maximum = 0;
+        for (y = 0; y < height_m; y++)
+        {
+            hits = hits_m[ch] + (size_t)y * stride_m;
+            pixel = pixels + (size_t)y * pixels_stride;
+            /* stride is a multiple of 4, padding counters are 0 */
+            for (c = 0; c < stride_m; c += 4)
+            {
+                memcpy(&four, hits + c, sizeof(four));
+                if (0 == four)
+                    continue;
+                for (k = c; k < c + 4; k++)
+                {
+                    if (0 == hits[k])
+                        continue;
+                    pixel[k] = palette[levels[log_grade(hits[k])]];
+                    if (hits[k] > maximum)
+                        maximum = hits[k];
+                }
+            }
+        }
+        max_hits_m[ch] = maximum;
+    }
+}
@@ -0,0 +1,133 @@
+/*****************************************************************************
+*   Copyright 2012 Vincent HERVIEUX
+*
+*   This file is part of QPicoscope.
+*
+*   QPicoscope is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU Lesser General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   any later version.
+*
+*   QPicoscope is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU Lesser General Public License for more details.
+*
+*   You should have received a copy of the GNU Lesser General Public License
+*   along with QPicoscope in files COPYING.LESSER and COPYING.
+*   If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+/**
+ * @file persistencebuffer.h
+ * @brief Declaration of PersistenceBuffer class.
+ * Hit counts of every waveform of a channel, one 16 bits counter per
+ * pixel, for the persistence display. Each waveform is reduced to column
+ * spans (see ColumnSpans) and every pixel of its spans is incremented with
+ * saturation, 8 columns at a time by SIMD kernels over the rows of the
+ * spans only. Counts decay by a factor, and are turned into a colour
+ * graded image on a log scale, so a glitch seen once stays visible next
+ * to a trace hit by every waveform.
+ * Not thread safe, PersistenceWorker runs it on its own thread.
+ * @version 0.1
+ * @date 2026, october 16
+ * @author Vincent HERVIEUX    -   10.16.2026   -   initial creation
+ */
+
+#ifndef PERSISTENCEBUFFER_H
+#define PERSISTENCEBUFFER_H
+
+#include "oscilloscope.h"
+#include "adcconvert.h"
+#include "columnspans.h"
+#include "decimator.h"
+
+#define PERSISTENCE_MAX_CHANNELS    4
+/* colour grades of the image, level 0 is transparent */
+#define PERSISTENCE_LEVELS          256
+
+class PersistenceBuffer
+{
+public:
+    /** @brief constructor, selects the best kernel for this CPU */
+    PersistenceBuffer();
+    /** @brief destructor */
+    ~PersistenceBuffer();
+
+    /**
+     * @brief set the number of pixels and clear the counts
+     * @return false if memory is exhausted or height is above COLUMN_SPANS_MAX_HEIGHT
+     */
+    bool resize(uint32_t width, uint32_t height);
+    /** @brief set the visible range of time and voltage and clear the counts */
+    void setView(double x_min, double x_max, double y_min, double y_max);
+    uint32_t width(void) const { return width_m; }
+    uint32_t height(void) const { return height_m; }
+    /** @brief counters between the start of two rows */
+    uint32_t stride(void) const { return stride_m; }
+    /** @brief set every count to 0 */
+    void clear(void);
+    /** @brief color of a channel, premultiplied ARGB, set before render() */
+    void setColor(uint8_t channel, uint32_t color);
+
+    /**
+     * @brief add a waveform of ADC counts, see DrawData::setRawData() for the parameters
+     * Records with many samples per column are decimated first.
+     */
+    void addRaw(uint8_t channel, const int16_t *raw, uint32_t nb_points,
+                float scale, float offset, double x_origin, double x_interval);
+    /** @brief add a waveform of points in time order */
+    void addPoints(uint8_t channel, const double *x, const double *y, uint32_t nb_points);
+    /** @brief multiply every count by factor, in [0, 1] */
+    void decay(double factor);
+    /**
+     * @brief draw the counts of every channel, in channel order
+     * @param[out] pixels: width() x height() premultiplied ARGB
+     * @param[in] pixels_stride: pixels between the start of two rows
+     */
+    void render(uint32_t *pixels, uint32_t pixels_stride);
+
+    /** @brief counts of a channel, height() rows of stride() counters */
+    const uint16_t* hits(uint8_t channel) const { return (channel < PERSISTENCE_MAX_CHANNELS) ? hits_m[channel] : NULL; }
+    /** @brief force a kernel, false if this CPU cannot run it */
+    bool setKernel(AdcConvert::kernel_e kernel);
+    AdcConvert::kernel_e getKernel(void) const { return kernel_m; }
+
+private:
+    PersistenceBuffer(const PersistenceBuffer&);
+    PersistenceBuffer& operator=(const PersistenceBuffer&);
+    /* increments rows [first, last] of COLUMN_SPANS_GROUP columns from column hits of row 0 */
+    typedef void (*add_fn_t)(uint16_t *hits, uint32_t stride, const int32_t *top, const int32_t *bottom,
+                             int32_t first, int32_t last);
+    typedef void (*decay_fn_t)(uint16_t *hits, size_t count, uint16_t factor);
+    /** @brief increment the pixels of spans_m */
+    void addSpans(uint8_t channel);
+    bool reserve(uint32_t nb_points);
+    void updatePalette(uint8_t channel);
+
+    AdcConvert::kernel_e kernel_m;
+    add_fn_t add_m;
+    decay_fn_t decay_m;
+    ColumnSpans spans_m;
+    Decimator decimator_m;
+    /* points of a waveform too short to be decimated */
+    double *x_m;
+    double *y_m;
+    uint32_t capacity_m;
+
+    uint16_t *hits_m[PERSISTENCE_MAX_CHANNELS];
+    /** @brief no count of the channel is above this */
+    uint32_t max_hits_m[PERSISTENCE_MAX_CHANNELS];
+    uint32_t color_m[PERSISTENCE_MAX_CHANNELS];
+    uint32_t palette_m[PERSISTENCE_MAX_CHANNELS][PERSISTENCE_LEVELS];
+    uint32_t width_m;
+    uint32_t height_m;
+    uint32_t stride_m;
+    double x_min_m;
+    double x_max_m;
+    double x_scale_m;
+    double x_offset_m;
+    double y_scale_m;
+    double y_offset_m;
+};
+
+#endif // PERSISTENCEBUFFER_H
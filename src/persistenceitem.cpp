@@ -0,0 +1,81 @@
+/*****************************************************************************
+*   Copyright 2012 Vincent HERVIEUX
+*
+*   This file is part of QPicoscope.
+*
+*   QPicoscope is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU Lesser General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   any later version.
+*
+*   QPicoscope is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU Lesser General Public License for more details.
+*
+*   You should have received a copy of the GNU Lesser General Public License
+*   along with QPicoscope in files COPYING.LESSER and COPYING.
+*   If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+/**
+ * @file persistenceitem.cpp
+ * @brief Definition of PersistenceItem class.
+ * @version 0.1
+ * @date 2026, october 16
+ * @author Vincent HERVIEUX    -   10.16.2026   -   initial creation
+ */
+
+#include <QPainter>
+#include <QImage>
+
+#include "persistenceitem.h"
+#include "persistenceworker.h"
+
+PersistenceItem::PersistenceItem(PersistenceWorker *worker)
+    : worker(worker)
+{
+    setZ(15.);
+}
+
+int PersistenceItem::rtti() const
+{
+    return QwtPlotItem::Rtti_PlotUserItem + 3;
+}
+
+/**
+ * The image was rendered for the canvas size and scales of the last
+ * setView(): it is stretched to the canvas until the worker catches up.
+ */
+#if ( QWT_VERSION >= 0x060000)
+void PersistenceItem::draw(QPainter *painter, const QwtScaleMap &xMap, const QwtScaleMap &yMap,
+                           const QRectF &canvasRect) const
+#else
+void PersistenceItem::draw(QPainter *painter, const QwtScaleMap &xMap, const QwtScaleMap &yMap,
+                           const QRect &canvasRect) const
+#endif
+{
+#if ( QWT_VERSION >= 0x060000)
+    QRect rect = canvasRect.toAlignedRect();
+#else
+    QRect rect = canvasRect;
+#endif
+    const uint32_t *pixels = NULL;
+    uint32_t width = 0;
+    uint32_t height = 0;
+    uint32_t stride = 0;
+
+    (void)xMap;
+    (void)yMap;
+    if(rect.isEmpty())
+        return;
+    pixels = worker->lockImage(&width, &height, &stride);
+    if(NULL == pixels)
+        return;
+    {
+        // wraps the pixels, the worker cannot swap them before unlockImage()
+        QImage image((const uchar*)pixels, (int)width, (int)height,
+                     (int)(stride * sizeof(uint32_t)), QImage::Format_ARGB32_Premultiplied);
+        painter->drawImage(rect, image);
+    }
+    worker->unlockImage();
+}
@@ -0,0 +1,60 @@
+/*****************************************************************************
+*   Copyright 2012 Vincent HERVIEUX
+*
+*   This file is part of QPicoscope.
+*
+*   QPicoscope is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU Lesser General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   any later version.
+*
+*   QPicoscope is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU Lesser General Public License for more details.
+*
+*   You should have received a copy of the GNU Lesser General Public License
+*   along with QPicoscope in files COPYING.LESSER and COPYING.
+*   If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+/**
+ * @file persistenceitem.h
+ * @brief Declaration of PersistenceItem class.
+ * Draws the last image of a PersistenceWorker over the grid and under the
+ * curves, which keep showing the newest waveform.
+ * @version 0.1
+ * @date 2026, october 16
+ * @author Vincent HERVIEUX    -   10.16.2026   -   initial creation
+ */
+
+#ifndef PERSISTENCEITEM_H
+#define PERSISTENCEITEM_H
+
+#include <qwt_global.h>
+#include <qwt_plot_item.h>
+
+class PersistenceWorker;
+
+class PersistenceItem : public QwtPlotItem
+{
+public:
+    /**
+     * @brief constructor, under the curves
+     * @param[in] worker: image source, not owned
+     */
+    PersistenceItem(PersistenceWorker *worker);
+
+    virtual int rtti() const;
+#if ( QWT_VERSION >= 0x060000)
+    virtual void draw(QPainter *painter, const QwtScaleMap &xMap, const QwtScaleMap &yMap,
+                      const QRectF &canvasRect) const;
+#else
+    virtual void draw(QPainter *painter, const QwtScaleMap &xMap, const QwtScaleMap &yMap,
+                      const QRect &canvasRect) const;
+#endif
+
+private:
+    PersistenceWorker *worker;
+};
+
+#endif // PERSISTENCEITEM_H
@@ -0,0 +1,437 @@
+/*****************************************************************************
+*   Copyright 2012 Vincent HERVIEUX
+*
+*   This file is part of QPicoscope.
+*
+*   QPicoscope is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU Lesser General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   any later version.
+*
+*   QPicoscope is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU Lesser General Public License for more details.
+*
+*   You should have received a copy of the GNU Lesser General Public License
+*   along with QPicoscope in files COPYING.LESSER and COPYING.
+*   If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+/**
+ * @file persistenceworker.cpp
+ * @brief Definition of PersistenceWorker class.
+ * @version 0.1
+ * @date 2026, october 16
+ * @author Vincent HERVIEUX    -   10.16.2026   -   initial creation
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+#include "persistenceworker.h"
+
+/*
+ * A decay step is long enough to take 1/8 of the counts at least, shorter
+ * steps would round small counts down faster than asked.
+ */
+#define PERSISTENCE_DECAY_STEP      0.1335
+
+/****************************************************************************
+ *
+ * constructor
+ *
+ ****************************************************************************/
+PersistenceWorker::PersistenceWorker() :
+    frames_m(PERSISTENCE_QUEUE_DEPTH, 1024),
+    running_m(false),
+    quit_m(false),
+    posted_m(false),
+    view_changed_m(false),
+    clear_m(false),
+    color_changed_m(false),
+    width_m(0),
+    height_m(0),
+    x_min_m(0.),
+    x_max_m(0.),
+    y_min_m(0.),
+    y_max_m(0.),
+    persistence_m(PERSISTENCE_INFINITE),
+    front_m(0),
+    front_valid_m(false),
+    image_count_m(0),
+    pipeline_stats_m(NULL),
+    waveforms_m(0),
+    busy_ns_m(0)
+{
+    pthread_condattr_t attributes;
+    uint8_t ch = 0;
+
+    memset(images_m, 0, sizeof(images_m));
+    for (ch = 0; ch < PERSISTENCE_MAX_CHANNELS; ch++)
+        color_m[ch] = 0xFFFFFFFF;
+    pthread_mutex_init(&lock_m, NULL);
+    pthread_condattr_init(&attributes);
+    pthread_condattr_setclock(&attributes, CLOCK_MONOTONIC);
+    pthread_cond_init(&cond_m, &attributes);
+    pthread_condattr_destroy(&attributes);
+}
+
+/****************************************************************************
+ *
+ * destructor
+ *
+ ****************************************************************************/
+PersistenceWorker::~PersistenceWorker()
+{
+    stop();
+    pthread_cond_destroy(&cond_m);
+    pthread_mutex_destroy(&lock_m);
+    free(images_m[0].pixels);
+    free(images_m[1].pixels);
+}
+
+/****************************************************************************
+ * start
+ ****************************************************************************/
+bool PersistenceWorker::start(void)
+{
+    int ret = 0;
+
+    if (running_m)
+        return true;
+    /* no producer yet, leftovers of the previous run are dropped */
+    while (NULL != frames_m.takeNext())
+        frames_m.release();
+    pthread_mutex_lock(&lock_m);
+    clear_m = true;
+    pthread_mutex_unlock(&lock_m);
+
+    ret = pthread_create(&thread_m, NULL, PersistenceWorker::threadRun, this);
+    if (0 != ret)
+    {
+        ERROR("pthread_create failed and returned %d\n", ret);
+        return false;
+    }
+    running_m = true;
+    return true;
+}
+
+/****************************************************************************
+ * stop
+ ****************************************************************************/
+void PersistenceWorker::stop(void)
+{
+    if (!running_m)
+        return;
+    pthread_mutex_lock(&lock_m);
+    quit_m = true;
+    pthread_cond_signal(&cond_m);
+    pthread_mutex_unlock(&lock_m);
+    pthread_join(thread_m, NULL);
+    quit_m = false;
+    running_m = false;
+}
+
+/****************************************************************************
+ * setView
+ ****************************************************************************/
+void PersistenceWorker::setView(uint32_t width, uint32_t height, double x_min, double x_max, double y_min, double y_max)
+{
+    pthread_mutex_lock(&lock_m);
+    if ((width != width_m) || (height != height_m) ||
+        (x_min != x_min_m) || (x_max != x_max_m) || (y_min != y_min_m) || (y_max != y_max_m))
+    {
+        width_m = width;
+        height_m = height;
+        x_min_m = x_min;
+        x_max_m = x_max;
+        y_min_m = y_min;
+        y_max_m = y_max;
+        view_changed_m = true;
+        pthread_cond_signal(&cond_m);
+    }
+    pthread_mutex_unlock(&lock_m);
+}
+
+/****************************************************************************
+ * setDecay
+ ****************************************************************************/
+void PersistenceWorker::setDecay(double persistence)
+{
+    pthread_mutex_lock(&lock_m);
+    persistence_m = (persistence > 0.) ? persistence : PERSISTENCE_INFINITE;
+    pthread_cond_signal(&cond_m);
+    pthread_mutex_unlock(&lock_m);
+}
+
+/****************************************************************************
+ * clear
+ ****************************************************************************/
+void PersistenceWorker::clear(void)
+{
+    pthread_mutex_lock(&lock_m);
+    clear_m = true;
+    pthread_cond_signal(&cond_m);
+    pthread_mutex_unlock(&lock_m);
+}
+
+/****************************************************************************
+ * setColor
+ ****************************************************************************/
+void PersistenceWorker::setColor(uint8_t channel, uint32_t color)
+{
+    if (channel >= PERSISTENCE_MAX_CHANNELS)
+        return;
+    pthread_mutex_lock(&lock_m);
+    color_m[channel] = color;
+    color_changed_m = true;
+    pthread_mutex_unlock(&lock_m);
+}
+
+/****************************************************************************
+ * publish
+ ****************************************************************************/
+bool PersistenceWorker::publish(void)
+{
+    if (!frames_m.publish())
+        return false;
+    pthread_mutex_lock(&lock_m);
+    posted_m = true;
+    pthread_cond_signal(&cond_m);
+    pthread_mutex_unlock(&lock_m);
+    return true;
+}
+
+/****************************************************************************
+ * lockImage
+ ****************************************************************************/
+const uint32_t* PersistenceWorker::lockImage(uint32_t *width, uint32_t *height, uint32_t *stride)
+{
+    const image_t *image = NULL;
+
+    pthread_mutex_lock(&lock_m);
+    if (!front_valid_m)
+    {
+        pthread_mutex_unlock(&lock_m);
+        return NULL;
+    }
+    image = &images_m[front_m];
+    *width = image->width;
+    *height = image->height;
+    *stride = image->width;
+    return image->pixels;
+}
+
+/****************************************************************************
+ * unlockImage
+ ****************************************************************************/
+void PersistenceWorker::unlockImage(void)
+{
+    pthread_mutex_unlock(&lock_m);
+}
+
+/****************************************************************************
+ * getStats
+ ****************************************************************************/
+void PersistenceWorker::getStats(stats_t *stats) const
+{
+    FrameQueue::stats_t frame_stats;
+
+    if (NULL == stats)
+        return;
+    frames_m.getStats(&frame_stats);
+    stats->waveforms = ATOMIC_LOAD_RELAXED(&waveforms_m);
+    stats->dropped = frame_stats.dropped;
+    stats->busy_ns = ATOMIC_LOAD_RELAXED(&busy_ns_m);
+}
+
+/****************************************************************************
+ * threadRun
+ ****************************************************************************/
+void* PersistenceWorker::threadRun(void *arg)
+{
+    ((PersistenceWorker*)arg)->run();
+    return NULL;
+}
+
+/****************************************************************************
+ * drain
+ ****************************************************************************/
+bool PersistenceWorker::drain(void)
+{
+    const FrameQueue::frame_t *frame = NULL;
+    const FrameQueue::channel_frame_t *channel = NULL;
+    PipelineStats *stats = ATOMIC_LOAD_ACQUIRE(&pipeline_stats_m);
+    uint64_t start = 0;
+    uint64_t duration = 0;
+    uint8_t ch = 0;
+    bool added = false;
+
+    while (NULL != (frame = frames_m.takeNext()))
+    {
+        start = PipelineStats::now_ns();
+        for (ch = 0; ch < PERSISTENCE_MAX_CHANNELS; ch++)
+        {
+            if (0 == (frame->channel_mask & (1 << ch)))
+                continue;
+            channel = &frame->channels[ch];
+            if (channel->is_raw)
+                buffer_m.addRaw(ch, channel->raw, channel->nb_points, channel->scale, channel->offset,
+                                channel->x_origin, channel->x_interval);
+            else
+                buffer_m.addPoints(ch, channel->x, channel->y, channel->nb_points);
+        }
+        frames_m.release();
+        duration = PipelineStats::now_ns() - start;
+        ATOMIC_STORE_RELAXED(&waveforms_m, waveforms_m + 1);
+        ATOMIC_STORE_RELAXED(&busy_ns_m, busy_ns_m + duration);
+        if (NULL != stats)
+            stats->record_duration(PipelineStats::E_STAGE_PERSISTENCE, duration);
+        added = true;
+    }
+    return added;
+}
+
+/****************************************************************************
+ * renderImage
+ ****************************************************************************/
+void PersistenceWorker::renderImage(void)
+{
+    image_t *back = &images_m[1 - front_m];
+    size_t size = (size_t)buffer_m.width() * buffer_m.height();
+    uint32_t *pixels = NULL;
+
+    if (0 == size)
+        return;
+    /* only the worker touches the back image */
+    if (size > back->capacity)
+    {
+        pixels = (uint32_t*)realloc(back->pixels, size * sizeof(uint32_t));
+        if (NULL == pixels)
+        {
+            ERROR("cannot allocate a %ux%u image\n", buffer_m.width(), buffer_m.height());
+            return;
+        }
+        back->pixels = pixels;
+        back->capacity = size;
+    }
+    back->width = buffer_m.width();
+    back->height = buffer_m.height();
+    buffer_m.render(back->pixels, back->width);
+
+    pthread_mutex_lock(&lock_m);
+    front_m = 1 - front_m;
+    front_valid_m = true;
+    ATOMIC_STORE_RELAXED(&image_count_m, image_count_m + 1);
+    pthread_mutex_unlock(&lock_m);
+}
+
+/****************************************************************************
+ * run
+ *
+ * Settings are copied under the lock and applied outside of it, the
+ * buffer is only used by this thread. The thread sleeps until a frame or
+ * a setting comes, or until the next image while counts change or decay.
+ ****************************************************************************/
+void PersistenceWorker::run(void)
+{
+    struct timespec deadline;
+    uint32_t colors[PERSISTENCE_MAX_CHANNELS];
+    uint64_t period = (uint64_t)(1E9 / PERSISTENCE_RENDER_RATE);
+    uint64_t last_decay = PipelineStats::now_ns();
+    uint64_t last_render = 0;
+    uint64_t now = 0;
+    uint32_t width = 0;
+    uint32_t height = 0;
+    double x_min = 0.;
+    double x_max = 0.;
+    double y_min = 0.;
+    double y_max = 0.;
+    double persistence = PERSISTENCE_INFINITE;
+    double elapsed = 0.;
+    bool view_changed = false;
+    bool clear = false;
+    bool color_changed = false;
+    bool dirty = false;
+    uint8_t ch = 0;
+
+    pthread_mutex_lock(&lock_m);
+    while (!quit_m)
+    {
+        view_changed = view_changed_m;
+        clear = clear_m;
+        color_changed = color_changed_m;
+        view_changed_m = clear_m = color_changed_m = posted_m = false;
+        width = width_m;
+        height = height_m;
+        x_min = x_min_m;
+        x_max = x_max_m;
+        y_min = y_min_m;
+        y_max = y_max_m;
+        persistence = persistence_m;
+        memcpy(colors, color_m, sizeof(colors));
+        pthread_mutex_unlock(&lock_m);
+
+        if (color_changed)
+        {
+            for (ch = 0; ch < PERSISTENCE_MAX_CHANNELS; ch++)
+                buffer_m.setColor(ch, colors[ch]);
+            dirty = true;
+        }
+        if (view_changed)
+        {
+            /* both clear the counts */
+            if (buffer_m.resize(width, height))
+                buffer_m.setView(x_min, x_max, y_min, y_max);
+            dirty = true;
+        }
+        else if (clear)
+        {
+            buffer_m.clear();
+            dirty = true;
+        }
+        if (drain())
+            dirty = true;
+
+        now = PipelineStats::now_ns();
+        elapsed = (now - last_decay) * 1E-9;
+        if (PERSISTENCE_INFINITE == persistence)
+        {
+            last_decay = now;
+        }
+        else if ((elapsed >= persistence * PERSISTENCE_DECAY_STEP) && (elapsed * PERSISTENCE_RENDER_RATE >= 1.))
+        {
+            buffer_m.decay(exp(-elapsed / persistence));
+            last_decay = now;
+            dirty = true;
+        }
+        if (dirty && (now - last_render >= period))
+        {
+            renderImage();
+            last_render = now;
+            dirty = false;
+        }
+
+        pthread_mutex_lock(&lock_m);
+        if (quit_m || posted_m || view_changed_m || clear_m || color_changed_m)
+            continue;
+        if (dirty || (PERSISTENCE_INFINITE != persistence_m))
+        {
+            clock_gettime(CLOCK_MONOTONIC, &deadline);
+            deadline.tv_nsec += (long)period;
+            if (deadline.tv_nsec >= 1000000000L)
+            {
+                deadline.tv_sec += 1;
+                deadline.tv_nsec -= 1000000000L;
+            }
+            pthread_cond_timedwait(&cond_m, &lock_m, &deadline);
+        }
+        else
+        {
+            pthread_cond_wait(&cond_m, &lock_m);
+        }
+    }
+    pthread_mutex_unlock(&lock_m);
+}
@@ -0,0 +1,164 @@
+/*****************************************************************************
+*   Copyright 2012 Vincent HERVIEUX
+*
+*   This file is part of QPicoscope.
+*
+*   QPicoscope is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU Lesser General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   any later version.
+*
+*   QPicoscope is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU Lesser General Public License for more details.
+*
+*   You should have received a copy of the GNU Lesser General Public License
+*   along with QPicoscope in files COPYING.LESSER and COPYING.
+*   If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+/**
+ * @file persistenceworker.h
+ * @brief Declaration of PersistenceWorker class.
+ * Thread feeding a PersistenceBuffer with every acquired waveform, apart
+ * from the GUI thread. The acquisition thread copies its blocks into a
+ * FrameQueue the worker drains frame after frame, nothing is skipped
+ * unless the worker falls behind by a whole queue. Counts decay with the
+ * time, and are drawn into an image at most PERSISTENCE_RENDER_RATE times
+ * per second, swapped with the one the GUI thread draws.
+ * @version 0.1
+ * @date 2026, october 16
+ * @author Vincent HERVIEUX    -   10.16.2026   -   initial creation
+ */
+
+#ifndef PERSISTENCEWORKER_H
+#define PERSISTENCEWORKER_H
+
+#include <pthread.h>
+
+#include "oscilloscope.h"
+#include "atomic-ops.h"
+#include "framequeue.h"
+#include "persistencebuffer.h"
+#include "pipelinestats.h"
+
+/* blocks the acquisition may be ahead of the worker */
+#define PERSISTENCE_QUEUE_DEPTH     32
+#define PERSISTENCE_RENDER_RATE     30.
+/* counts are kept until cleared */
+#define PERSISTENCE_INFINITE        0.
+
+class PersistenceWorker
+{
+public:
+    /**
+     * @brief public typedef declarations
+     */
+    typedef struct
+    {
+        /** @brief waveforms added to the counts */
+        uint64_t waveforms;
+        /** @brief waveforms lost because the worker was late */
+        uint64_t dropped;
+        /** @brief time spent adding them, in ns */
+        uint64_t busy_ns;
+    } stats_t;
+
+    /** @brief constructor, the thread is not started */
+    PersistenceWorker();
+    /** @brief destructor, stops the thread */
+    ~PersistenceWorker();
+
+    /** @brief start the thread, waveforms published before are discarded */
+    bool start(void);
+    /** @brief stop the thread, the last image stays available */
+    void stop(void);
+    bool isRunning(void) const { return running_m; }
+
+    /** @brief set the image size and the visible range, counts are cleared if they change */
+    void setView(uint32_t width, uint32_t height, double x_min, double x_max, double y_min, double y_max);
+    /** @brief seconds for the counts to fall to 1/e, PERSISTENCE_INFINITE to keep them */
+    void setDecay(double persistence);
+    /** @brief forget every waveform */
+    void clear(void);
+    /** @brief color of a channel, premultiplied ARGB */
+    void setColor(uint8_t channel, uint32_t color);
+    /** @brief where the time spent per waveform is recorded, may be NULL */
+    void setPipelineStats(PipelineStats *stats) { ATOMIC_STORE_RELEASE(&pipeline_stats_m, stats); }
+
+    /**
+     * @brief producer side, same as FrameQueue::setChannel()
+     * Acquisition thread, like DrawData::setData().
+     */
+    int8_t setChannel(uint8_t channel_id, const double *x_data, const double *y_data, uint32_t nb_points)
+        { return frames_m.setChannel(channel_id, x_data, y_data, nb_points); }
+    /** @brief producer side, same as FrameQueue::setRawChannel() */
+    int8_t setRawChannel(uint8_t channel_id, const int16_t *raw, uint32_t nb_points,
+                         float scale, float offset, double x_origin, double x_interval)
+        { return frames_m.setRawChannel(channel_id, raw, nb_points, scale, offset, x_origin, x_interval); }
+    /** @brief producer side: hand the waveform over to the worker */
+    bool publish(void);
+
+    /**
+     * @brief the last rendered image, to be given back by unlockImage() at once
+     * @return NULL if none, unlockImage() must not be called then
+     */
+    const uint32_t* lockImage(uint32_t *width, uint32_t *height, uint32_t *stride);
+    void unlockImage(void);
+    /** @brief images rendered so far, a change means the image must be drawn again */
+    uint64_t imageCount(void) const { return ATOMIC_LOAD_RELAXED(&image_count_m); }
+
+    /** @brief read the counters, any thread */
+    void getStats(stats_t *stats) const;
+
+private:
+    PersistenceWorker(const PersistenceWorker&);
+    PersistenceWorker& operator=(const PersistenceWorker&);
+    typedef struct
+    {
+        uint32_t *pixels;
+        uint32_t width;
+        uint32_t height;
+        size_t capacity;
+    } image_t;
+
+    static void* threadRun(void *arg);
+    void run(void);
+    /** @brief add every pending frame to the counts, true if any */
+    bool drain(void);
+    /** @brief draw the counts into the back image and swap it */
+    void renderImage(void);
+
+    PersistenceBuffer buffer_m;
+    FrameQueue frames_m;
+    pthread_t thread_m;
+    bool running_m;
+    pthread_mutex_t lock_m;
+    pthread_cond_t cond_m;
+    /* protected by lock_m */
+    bool quit_m;
+    bool posted_m;
+    bool view_changed_m;
+    bool clear_m;
+    bool color_changed_m;
+    uint32_t width_m;
+    uint32_t height_m;
+    double x_min_m;
+    double x_max_m;
+    double y_min_m;
+    double y_max_m;
+    double persistence_m;
+    uint32_t color_m[PERSISTENCE_MAX_CHANNELS];
+    /* front is drawn by the GUI thread, back by the worker */
+    image_t images_m[2];
+    uint8_t front_m;
+    bool front_valid_m;
+    uint64_t image_count_m;
+
+    PipelineStats *pipeline_stats_m;
+    /* written by the worker only */
+    uint64_t waveforms_m;
+    uint64_t busy_ns_m;
+};
+
+#endif // PERSISTENCEWORKER_H
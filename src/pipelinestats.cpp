@@ -0,0 +1,143 @@
+/*****************************************************************************
+*   Copyright 2012 Vincent HERVIEUX
+*
+*   This file is part of QPicoscope.
+*
+*   QPicoscope is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU Lesser General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   any later version.
+*
+*   QPicoscope is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU Lesser General Public License for more details.
+*
+*   You should have received a copy of the GNU Lesser General Public License
+*   along with QPicoscope in files COPYING.LESSER and COPYING.
+*   If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+/**
+ * @file pipelinestats.cpp
+ * @brief Definition of PipelineStats class.
+ * @version 0.1
+ * @date 2026, october 16
+ * @author Vincent HERVIEUX    -   10.16.2026   -   initial creation
+ */
+
+#include <string.h>
+#include <time.h>
+
+#include "pipelinestats.h"
+#include "atomic-ops.h"
+
+static const char *stage_names[PipelineStats::E_STAGE_MAX] =
+    { "arm", "wait", "get values", "convert", "handoff", "replot", "persistence", "spectrum", "measure" };
+
+/****************************************************************************
+ *
+ * constructor
+ *
+ ****************************************************************************/
+PipelineStats::PipelineStats() :
+    waveforms_m(0),
+    samples_m(0),
+    capture_ns_m(0),
+    last_ns_m(0),
+    last_waveforms_m(0),
+    last_samples_m(0),
+    last_capture_ns_m(0)
+{
+}
+
+/****************************************************************************
+ * stage_name
+ ****************************************************************************/
+const char* PipelineStats::stage_name(stage_e stage)
+{
+    return (stage < E_STAGE_MAX) ? stage_names[stage] : "unknown";
+}
+
+/****************************************************************************
+ * now_ns
+ ****************************************************************************/
+uint64_t PipelineStats::now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/****************************************************************************
+ * count_block
+ ****************************************************************************/
+void PipelineStats::count_block(uint32_t samples, double capture_duration)
+{
+    ATOMIC_FETCH_ADD(&waveforms_m, 1);
+    ATOMIC_FETCH_ADD(&samples_m, samples);
+    ATOMIC_FETCH_ADD(&capture_ns_m, (uint64_t)(capture_duration * 1E9));
+}
+
+/****************************************************************************
+ * snapshot
+ ****************************************************************************/
+void PipelineStats::snapshot(snapshot_t *snapshot)
+{
+    uint64_t current = now_ns();
+    uint64_t waveforms = ATOMIC_LOAD_RELAXED(&waveforms_m);
+    uint64_t samples = ATOMIC_LOAD_RELAXED(&samples_m);
+    uint64_t capture_ns = ATOMIC_LOAD_RELAXED(&capture_ns_m);
+    double elapsed = 0.;
+
+    if (NULL == snapshot)
+        return;
+    memset(snapshot, 0, sizeof(snapshot_t));
+    snapshot->waveforms = waveforms;
+    snapshot->samples = samples;
+    if ((0 != last_ns_m) && (current > last_ns_m))
+    {
+        elapsed = (current - last_ns_m) * 1E-9;
+        snapshot->waveforms_per_s = (waveforms - last_waveforms_m) / elapsed;
+        snapshot->samples_per_s = (samples - last_samples_m) / elapsed;
+        snapshot->dead_time = 100. * (1. - (capture_ns - last_capture_ns_m) * 1E-9 / elapsed);
+        if (snapshot->dead_time < 0.)
+            snapshot->dead_time = 0.;
+    }
+    last_ns_m = current;
+    last_waveforms_m = waveforms;
+    last_samples_m = samples;
+    last_capture_ns_m = capture_ns;
+}
+
+/****************************************************************************
+ * dump
+ ****************************************************************************/
+void PipelineStats::dump(FILE *file) const
+{
+    uint8_t stage = 0;
+    const LatencyHistogram *histogram = NULL;
+
+    fprintf(file, "%-12s %10s %10s %10s %10s %10s %10s\n", "stage", "count", "mean us", "p50 us", "p90 us", "p99 us", "max us");
+    for (stage = 0; stage < E_STAGE_MAX; stage++)
+    {
+        histogram = &histograms_m[stage];
+        fprintf(file, "%-12s %10llu %10.1f %10.1f %10.1f %10.1f %10.1f\n", stage_names[stage],
+                (unsigned long long)histogram->get_count(), histogram->get_mean() * 1E-3,
+                histogram->get_percentile(50.) * 1E-3, histogram->get_percentile(90.) * 1E-3,
+                histogram->get_percentile(99.) * 1E-3, histogram->get_max() * 1E-3);
+    }
+    fprintf(file, "%llu waveforms, %llu samples\n",
+            (unsigned long long)ATOMIC_LOAD_RELAXED(&waveforms_m), (unsigned long long)ATOMIC_LOAD_RELAXED(&samples_m));
+}
+
+/****************************************************************************
+ * reset
+ ****************************************************************************/
+void PipelineStats::reset(void)
+{
+    uint8_t stage = 0;
+
+    for (stage = 0; stage < E_STAGE_MAX; stage++)
+        histograms_m[stage].reset();
+}
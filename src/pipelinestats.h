@@ -0,0 +1,120 @@
+/*****************************************************************************
+*   Copyright 2012 Vincent HERVIEUX
+*
+*   This file is part of QPicoscope.
+*
+*   QPicoscope is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU Lesser General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   any later version.
+*
+*   QPicoscope is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU Lesser General Public License for more details.
+*
+*   You should have received a copy of the GNU Lesser General Public License
+*   along with QPicoscope in files COPYING.LESSER and COPYING.
+*   If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+/**
+ * @file pipelinestats.h
+ * @brief Declaration of PipelineStats class.
+ * Where the time of a block capture goes, stage by stage, and how much
+ * goes through. Each stage of the block loop feeds a LatencyHistogram,
+ * throughput counters are atomic, so the acquisition thread never waits
+ * for the GUI reading them. Rates are computed between two snapshot()
+ * calls of the same reader.
+ * @version 0.1
+ * @date 2026, october 16
+ * @author Vincent HERVIEUX    -   10.16.2026   -   initial creation
+ */
+
+#ifndef PIPELINESTATS_H
+#define PIPELINESTATS_H
+
+#include <stdio.h>
+
+#include "oscilloscope.h"
+#include "latencyhistogram.h"
+
+class PipelineStats
+{
+public:
+    /**
+     * @brief public typedef declarations
+     */
+    typedef enum
+    {
+        /** @brief trigger set up and run_block */
+        E_STAGE_ARM = 0,
+        /** @brief waiting for the unit to be ready */
+        E_STAGE_WAIT,
+        /** @brief reading the samples from the driver */
+        E_STAGE_GET_VALUES,
+        /** @brief counts to screen tables */
+        E_STAGE_CONVERT,
+        /** @brief setRawData() and publishData() */
+        E_STAGE_HANDOFF,
+        /** @brief drawing a frame, GUI thread */
+        E_STAGE_REPLOT,
+        /** @brief adding a waveform to the persistence buffers, persistence thread */
+        E_STAGE_PERSISTENCE,
+        /** @brief windowed FFT of a waveform, spectrum threads */
+        E_STAGE_SPECTRUM,
+        /** @brief automatic measurements of a block, measurement thread */
+        E_STAGE_MEASURE,
+        E_STAGE_MAX
+    } stage_e;
+
+    typedef struct
+    {
+        double waveforms_per_s;
+        double samples_per_s;
+        /** @brief share of the time not spent sampling, in percent */
+        double dead_time;
+        /** @brief since the first snapshot */
+        uint64_t waveforms;
+        uint64_t samples;
+    } snapshot_t;
+
+    /** @brief constructor */
+    PipelineStats();
+
+    static const char* stage_name(stage_e stage);
+    /** @brief monotonic clock for the stage timings, in ns */
+    static uint64_t now_ns(void);
+    /** @brief count the duration of a stage from its start, any thread */
+    void record(stage_e stage, uint64_t start_ns) { histograms_m[stage].record(now_ns() - start_ns); }
+    /** @brief count a stage timed in several pieces, any thread */
+    void record_duration(stage_e stage, uint64_t duration_ns) { histograms_m[stage].record(duration_ns); }
+    /**
+     * @brief count a captured block, acquisition thread
+     * @param[in] samples: per channel
+     * @param[in] capture_duration: time the unit spent sampling it, in seconds
+     */
+    void count_block(uint32_t samples, double capture_duration);
+    const LatencyHistogram& get_histogram(stage_e stage) const { return histograms_m[stage]; }
+    /** @brief rates since the previous call, a single reader only */
+    void snapshot(snapshot_t *snapshot);
+    /** @brief percentiles of every stage, any thread */
+    void dump(FILE *file) const;
+    /** @brief empty every histogram */
+    void reset(void);
+
+private:
+    PipelineStats(const PipelineStats&);
+    PipelineStats& operator=(const PipelineStats&);
+
+    LatencyHistogram histograms_m[E_STAGE_MAX];
+    uint64_t waveforms_m;
+    uint64_t samples_m;
+    uint64_t capture_ns_m;
+    /* reader side, previous snapshot */
+    uint64_t last_ns_m;
+    uint64_t last_waveforms_m;
+    uint64_t last_samples_m;
+    uint64_t last_capture_ns_m;
+};
+
+#endif // PIPELINESTATS_H
@@ -8,7 +8,45 @@ HEADERS        = screen.h \
                  acquisition2000.h \
                  acquisition2000a.h \
                  acquisition3000.h \
+                 acquisitionmanager.h \
+                 acquisitionplayback.h \
+                 acquisitionsim.h \
+                 adcconvert.h \
+                 capturefile.h \
+                 captureformat.h \
+                 capturerecorder.h \
+                 columnspans.h \
+                 atomic-ops.h \
+                 decimator.h \
+                 fftplan.h \
+                 framequeue.h \
+                 hotplugmonitor.h \
+                 latencyhistogram.h \
+                 logger.h \
+                 measurementscan.h \
+                 measurementworker.h \
                  mainwindow.h \
+                 minmaxpyramid.h \
+                 persistencebuffer.h \
+                 persistenceitem.h \
+                 persistenceworker.h \
+                 pipelinestats.h \
+                 rawcurvedata.h \
+                 readywaiter.h \
+                 samplearena.h \
+                 settingsqueue.h \
+                 signalgenerator.h \
+                 spectrumview.h \
+                 spectrumworker.h \
+                 staticlayeritem.h \
+                 streamdisplay.h \
+                 streampipeline.h \
+                 streamring.h \
+                 streamsink.h \
+                 streamtrigger.h \
+                 traceraster.h \
+                 triggerinterpolator.h \
+                 tracerasteritem.h \
                  search-for-acquisition-device-worker.h
 SOURCES        = screen.cpp \
                  frontpanel.cpp \
@@ -18,11 +56,48 @@ SOURCES        = screen.cpp \
                  acquisition2000.cpp \
                  acquisition2000a.cpp \
                  acquisition3000.cpp \
+                 acquisitionmanager.cpp \
+                 acquisitionplayback.cpp \
+                 acquisitionsim.cpp \
+                 adcconvert.cpp \
+                 capturefile.cpp \
+                 capturerecorder.cpp \
+                 columnspans.cpp \
+                 decimator.cpp \
+                 fftplan.cpp \
+                 framequeue.cpp \
+                 hotplugmonitor.cpp \
+                 latencyhistogram.cpp \
+                 logger.cpp \
+                 measurementscan.cpp \
+                 measurementworker.cpp \
                  mainwindow.cpp \
+                 minmaxpyramid.cpp \
+                 persistencebuffer.cpp \
+                 persistenceitem.cpp \
+                 persistenceworker.cpp \
+                 pipelinestats.cpp \
+                 rawcurvedata.cpp \
+                 readywaiter.cpp \
+                 samplearena.cpp \
+                 settingsqueue.cpp \
+                 signalgenerator.cpp \
+                 spectrumview.cpp \
+                 spectrumworker.cpp \
+                 staticlayeritem.cpp \
+                 streamdisplay.cpp \
+                 streampipeline.cpp \
+                 streamring.cpp \
+                 streamtrigger.cpp \
+                 traceraster.cpp \
+                 triggerinterpolator.cpp \
+                 tracerasteritem.cpp \
                  search-for-acquisition-device-worker.cpp
 TARGET        = QPicoscope
 QTDIR_build:REQUIRES="contains(QT_CONFIG, full-config)"
 unix:LIBS += -lm -lps2000 -lps3000
+# DEBUG messages are compiled out, see oscilloscope.h
+#DEFINES += LOG_LEVEL=LOG_LEVEL_DEBUG
 
 # install
 target.path = ./
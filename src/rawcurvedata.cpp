@@ -0,0 +1,99 @@
+/*****************************************************************************
+*   Copyright 2012 Vincent HERVIEUX
+*
+*   This file is part of QPicoscope.
+*
+*   QPicoscope is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU Lesser General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   any later version.
+*
+*   QPicoscope is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU Lesser General Public License for more details.
+*
+*   You should have received a copy of the GNU Lesser General Public License
+*   along with QPicoscope in files COPYING.LESSER and COPYING.
+*   If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+/**
+ * @file rawcurvedata.cpp
+ * @brief Definition of RawCurveData class.
+ * @version 0.1
+ * @date 2026, october 16
+ * @author Vincent HERVIEUX    -   10.16.2026   -   initial creation
+ */
+
+#include "rawcurvedata.h"
+
+RawCurveData::RawCurveData(const QVector<qint16> &counts, float scale, float offset, double xOrigin, double xInterval)
+    : samples(counts),
+      scale(scale),
+      offset(offset),
+      xOrigin(xOrigin),
+      xInterval(xInterval),
+      yMin(0.),
+      yMax(0.)
+{
+    const qint16 *count = counts.constData();
+    qint16 countMin = 0;
+    qint16 countMax = 0;
+    int i = 0;
+
+    if(counts.isEmpty())
+        return;
+    countMin = countMax = count[0];
+    for(i = 1; i < counts.size(); i++)
+    {
+        if(count[i] < countMin)
+            countMin = count[i];
+        else if(count[i] > countMax)
+            countMax = count[i];
+    }
+    /* scale is positive for every range, keep it right if it were not */
+    yMin = qMin(countMin * scale + offset, countMax * scale + offset);
+    yMax = qMax(countMin * scale + offset, countMax * scale + offset);
+}
+
+size_t RawCurveData::size() const
+{
+    return (size_t)samples.size();
+}
+
+#if ( QWT_VERSION >= 0x060000)
+QPointF RawCurveData::sample(size_t i) const
+{
+    return QPointF(xOrigin + i * xInterval, samples.at((int)i) * scale + offset);
+}
+
+QRectF RawCurveData::boundingRect() const
+{
+    if(samples.isEmpty())
+        return QRectF(1.0, 1.0, -2.0, -2.0); // invalid
+    return QRectF(xOrigin, yMin, (samples.size() - 1) * xInterval, yMax - yMin);
+}
+#else
+QwtData *RawCurveData::copy() const
+{
+    /* samples are implicitly shared, nothing is copied here */
+    return new RawCurveData(*this);
+}
+
+double RawCurveData::x(size_t i) const
+{
+    return xOrigin + i * xInterval;
+}
+
+double RawCurveData::y(size_t i) const
+{
+    return samples.at((int)i) * scale + offset;
+}
+
+QwtDoubleRect RawCurveData::boundingRect() const
+{
+    if(samples.isEmpty())
+        return QwtDoubleRect(1.0, 1.0, -2.0, -2.0); // invalid
+    return QwtDoubleRect(xOrigin, yMin, (samples.size() - 1) * xInterval, yMax - yMin);
+}
+#endif
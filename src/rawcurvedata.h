@@ -0,0 +1,81 @@
+/*****************************************************************************
+*   Copyright 2012 Vincent HERVIEUX
+*
+*   This file is part of QPicoscope.
+*
+*   QPicoscope is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU Lesser General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   any later version.
+*
+*   QPicoscope is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU Lesser General Public License for more details.
+*
+*   You should have received a copy of the GNU Lesser General Public License
+*   along with QPicoscope in files COPYING.LESSER and COPYING.
+*   If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+/**
+ * @file rawcurvedata.h
+ * @brief Declaration of RawCurveData class.
+ * Curve data made of evenly spaced ADC counts. Points are computed when
+ * Qwt asks for them, so a curve costs 2 bytes per sample instead of 16.
+ * @version 0.1
+ * @date 2026, october 16
+ * @author Vincent HERVIEUX    -   10.16.2026   -   initial creation
+ */
+
+#ifndef RAWCURVEDATA_H
+#define RAWCURVEDATA_H
+
+#include <QVector>
+
+#include <qwt_global.h>
+#if ( QWT_VERSION >= 0x060000)
+#include <qwt_series_data.h>
+#else
+#include <qwt_data.h>
+#endif
+
+#if ( QWT_VERSION >= 0x060000)
+class RawCurveData : public QwtSeriesData<QPointF>
+#else
+class RawCurveData : public QwtData
+#endif
+{
+public:
+    /**
+     * @brief constructor
+     * @param[in] counts: ADC counts, shared and not copied
+     * @param[in] scale: volts per ADC count
+     * @param[in] offset: volts at count 0
+     * @param[in] xOrigin: time of the first point in seconds
+     * @param[in] xInterval: time between two points in seconds
+     */
+    RawCurveData(const QVector<qint16> &counts, float scale, float offset, double xOrigin, double xInterval);
+
+    virtual size_t size() const;
+#if ( QWT_VERSION >= 0x060000)
+    virtual QPointF sample(size_t i) const;
+    virtual QRectF boundingRect() const;
+#else
+    virtual QwtData *copy() const;
+    virtual double x(size_t i) const;
+    virtual double y(size_t i) const;
+    virtual QwtDoubleRect boundingRect() const;
+#endif
+
+private:
+    QVector<qint16> samples;
+    float scale;
+    float offset;
+    double xOrigin;
+    double xInterval;
+    /** @brief found once by the constructor, Qwt asks for it on every replot */
+    double yMin;
+    double yMax;
+};
+
+#endif // RAWCURVEDATA_H
@@ -0,0 +1,192 @@
+/*****************************************************************************
+*   Copyright 2012 Vincent HERVIEUX
+*
+*   This file is part of QPicoscope.
+*
+*   QPicoscope is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU Lesser General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   any later version.
+*
+*   QPicoscope is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU Lesser General Public License for more details.
+*
+*   You should have received a copy of the GNU Lesser General Public License
+*   along with QPicoscope in files COPYING.LESSER and COPYING.
+*   If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+/**
+ * @file readywaiter.cpp
+ * @brief Definition of ReadyWaiter class.
+ * @version 0.1
+ * @date 2026, october 16
+ * @author Vincent HERVIEUX    -   10.16.2026   -   initial creation
+ */
+
+#include <time.h>
+#include <math.h>
+
+#include "readywaiter.h"
+
+/* Shortest sleep between two polls, the USB round trip costs about as much */
+#define POLL_MIN_PERIOD   0.00005
+/* Longest sleep between two polls, bounds the latency when waiting for a trigger */
+#define POLL_MAX_PERIOD   0.020
+
+/****************************************************************************
+ *
+ * constructor
+ *
+ ****************************************************************************/
+ReadyWaiter::ReadyWaiter() :
+    notified_m(false),
+    cancelled_m(false),
+    expected_duration_m(0.)
+{
+    pthread_condattr_t attr;
+
+    pthread_mutex_init(&lock_m, NULL);
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&cond_m, &attr);
+    pthread_condattr_destroy(&attr);
+}
+
+/****************************************************************************
+ *
+ * destructor
+ *
+ ****************************************************************************/
+ReadyWaiter::~ReadyWaiter()
+{
+    pthread_cond_destroy(&cond_m);
+    pthread_mutex_destroy(&lock_m);
+}
+
+/****************************************************************************
+ * arm
+ ****************************************************************************/
+void ReadyWaiter::arm(double expected_duration)
+{
+    pthread_mutex_lock(&lock_m);
+    notified_m = false;
+    expected_duration_m = (expected_duration > 0.) ? expected_duration : 0.;
+    pthread_mutex_unlock(&lock_m);
+}
+
+/****************************************************************************
+ * sleep_locked
+ ****************************************************************************/
+void ReadyWaiter::sleep_locked(double seconds)
+{
+    struct timespec deadline;
+    double integral = 0.;
+    double fractional = modf(seconds, &integral);
+
+    clock_gettime(CLOCK_MONOTONIC, &deadline);
+    deadline.tv_sec += (time_t)integral;
+    deadline.tv_nsec += (long)(fractional * 1E9);
+    if(deadline.tv_nsec >= 1000000000L)
+    {
+        deadline.tv_sec++;
+        deadline.tv_nsec -= 1000000000L;
+    }
+    while(!notified_m && !cancelled_m)
+    {
+        if(0 != pthread_cond_timedwait(&cond_m, &lock_m, &deadline))
+            break;
+    }
+}
+
+/****************************************************************************
+ * wait_event
+ ****************************************************************************/
+ReadyWaiter::wait_result_e ReadyWaiter::wait_event(double timeout)
+{
+    wait_result_e result = E_WAIT_TIMEOUT;
+
+    pthread_mutex_lock(&lock_m);
+    if(timeout > 0.)
+    {
+        sleep_locked(timeout);
+    }
+    else
+    {
+        while(!notified_m && !cancelled_m)
+            pthread_cond_wait(&cond_m, &lock_m);
+    }
+    if(cancelled_m)
+        result = E_WAIT_CANCELLED;
+    else if(notified_m)
+        result = E_WAIT_READY;
+    pthread_mutex_unlock(&lock_m);
+    return result;
+}
+
+/****************************************************************************
+ * wait_poll
+ ****************************************************************************/
+ReadyWaiter::wait_result_e ReadyWaiter::wait_poll(poll_fn_t poll, void *context)
+{
+    double period = 0.;
+
+    if(NULL == poll)
+        return E_WAIT_CANCELLED;
+
+    pthread_mutex_lock(&lock_m);
+    /* nothing can be ready before the device has filled its memory */
+    if(expected_duration_m > POLL_MIN_PERIOD)
+        sleep_locked(expected_duration_m);
+    /* then poll finely first, the block is most likely just about to complete */
+    period = expected_duration_m / 16.;
+    if(period < POLL_MIN_PERIOD)
+        period = POLL_MIN_PERIOD;
+    while(!cancelled_m)
+    {
+        pthread_mutex_unlock(&lock_m);
+        if(poll(context))
+            return E_WAIT_READY;
+        pthread_mutex_lock(&lock_m);
+        sleep_locked(period);
+        period *= 2.;
+        if(period > POLL_MAX_PERIOD)
+            period = POLL_MAX_PERIOD;
+    }
+    pthread_mutex_unlock(&lock_m);
+    return E_WAIT_CANCELLED;
+}
+
+/****************************************************************************
+ * notify
+ ****************************************************************************/
+void ReadyWaiter::notify(void)
+{
+    pthread_mutex_lock(&lock_m);
+    notified_m = true;
+    pthread_cond_broadcast(&cond_m);
+    pthread_mutex_unlock(&lock_m);
+}
+
+/****************************************************************************
+ * cancel
+ ****************************************************************************/
+void ReadyWaiter::cancel(void)
+{
+    pthread_mutex_lock(&lock_m);
+    cancelled_m = true;
+    pthread_cond_broadcast(&cond_m);
+    pthread_mutex_unlock(&lock_m);
+}
+
+/****************************************************************************
+ * reset
+ ****************************************************************************/
+void ReadyWaiter::reset(void)
+{
+    pthread_mutex_lock(&lock_m);
+    cancelled_m = false;
+    notified_m = false;
+    pthread_mutex_unlock(&lock_m);
+}
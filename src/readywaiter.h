@@ -0,0 +1,96 @@
+/*****************************************************************************
+*   Copyright 2012 Vincent HERVIEUX
+*
+*   This file is part of QPicoscope.
+*
+*   QPicoscope is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU Lesser General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   any later version.
+*
+*   QPicoscope is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU Lesser General Public License for more details.
+*
+*   You should have received a copy of the GNU Lesser General Public License
+*   along with QPicoscope in files COPYING.LESSER and COPYING.
+*   If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+/**
+ * @file readywaiter.h
+ * @brief Declaration of ReadyWaiter class.
+ * Waits for the end of a block capture, either on a driver callback or by
+ * polling the driver with a backoff tuned to the expected block duration.
+ * Acquisition::stop() cancels a pending wait at once.
+ * @version 0.1
+ * @date 2026, october 16
+ * @author Vincent HERVIEUX    -   10.16.2026   -   initial creation
+ */
+
+#ifndef READYWAITER_H
+#define READYWAITER_H
+
+#include <pthread.h>
+
+#include "oscilloscope.h"
+
+class ReadyWaiter
+{
+public:
+    /**
+     * @brief public typedef declarations
+     */
+    typedef enum
+    {
+        E_WAIT_READY = 0,
+        E_WAIT_CANCELLED,
+        E_WAIT_TIMEOUT
+    } wait_result_e;
+
+    /** @brief driver poll function, returns non zero when the block is ready */
+    typedef int (*poll_fn_t)(void *context);
+
+    /** @brief constructor */
+    ReadyWaiter();
+    /** @brief destructor */
+    ~ReadyWaiter();
+
+    /**
+     * @brief prepare a new wait, to be called before starting the capture
+     * @param[in] expected_duration: time in seconds the device needs to fill the block
+     */
+    void arm(double expected_duration);
+    /**
+     * @brief block on notify() (driver callback)
+     * @param[in] timeout: in seconds, 0. means wait forever
+     */
+    wait_result_e wait_event(double timeout = 0.);
+    /**
+     * @brief poll the driver, sleeping in between
+     * First sleep is about the expected block duration, then the polling
+     * period grows up to POLL_MAX_PERIOD so that waiting for a trigger costs
+     * almost no CPU.
+     */
+    wait_result_e wait_poll(poll_fn_t poll, void *context);
+    /** @brief wake wait_event(), can be called from a driver thread */
+    void notify(void);
+    /** @brief wake any wait and make further ones return E_WAIT_CANCELLED */
+    void cancel(void);
+    /** @brief allow waiting again after cancel() */
+    void reset(void);
+
+private:
+    ReadyWaiter(const ReadyWaiter&);
+    ReadyWaiter& operator=(const ReadyWaiter&);
+    /** @brief sleep for the given duration unless notified or cancelled, lock must be held */
+    void sleep_locked(double seconds);
+
+    pthread_mutex_t lock_m;
+    pthread_cond_t  cond_m;
+    bool notified_m;
+    bool cancelled_m;
+    double expected_duration_m;
+};
+
+#endif // READYWAITER_H
@@ -0,0 +1,96 @@
+/*****************************************************************************
+*   Copyright 2012 Vincent HERVIEUX
+*
+*   This file is part of QPicoscope.
+*
+*   QPicoscope is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU Lesser General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   any later version.
+*
+*   QPicoscope is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU Lesser General Public License for more details.
+*
+*   You should have received a copy of the GNU Lesser General Public License
+*   along with QPicoscope in files COPYING.LESSER and COPYING.
+*   If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+/**
+ * @file samplearena.cpp
+ * @brief Definition of SampleArena class.
+ * @version 0.1
+ * @date 2026, october 16
+ * @author Vincent HERVIEUX    -   10.16.2026   -   initial creation
+ */
+
+#include <stdlib.h>
+
+#include "samplearena.h"
+
+/****************************************************************************
+ *
+ * constructor
+ *
+ ****************************************************************************/
+SampleArena::SampleArena() :
+    base_m(NULL),
+    capacity_m(0),
+    used_m(0)
+{
+}
+
+/****************************************************************************
+ *
+ * destructor
+ *
+ ****************************************************************************/
+SampleArena::~SampleArena()
+{
+    free(base_m);
+}
+
+/****************************************************************************
+ * reserve
+ ****************************************************************************/
+bool SampleArena::reserve(size_t size)
+{
+    void *base = NULL;
+    int ret = 0;
+
+    size = aligned_size(size);
+    if (size <= capacity_m)
+    {
+        used_m = 0;
+        return true;
+    }
+
+    /* contents are not kept, no need for a realloc copy */
+    ret = posix_memalign(&base, SAMPLE_ARENA_ALIGNMENT, size);
+    if (0 != ret)
+    {
+        ERROR("cannot allocate %lu bytes (%d)\n", (unsigned long)size, ret);
+        return false;
+    }
+    free(base_m);
+    base_m = (uint8_t*)base;
+    capacity_m = size;
+    used_m = 0;
+    return true;
+}
+
+/****************************************************************************
+ * allocate
+ ****************************************************************************/
+void* SampleArena::allocate(size_t size)
+{
+    void *buffer = NULL;
+
+    size = aligned_size(size);
+    if (size > capacity_m - used_m)
+        return NULL;
+    buffer = base_m + used_m;
+    used_m += size;
+    return buffer;
+}
@@ -0,0 +1,77 @@
+/*****************************************************************************
+*   Copyright 2012 Vincent HERVIEUX
+*
+*   This file is part of QPicoscope.
+*
+*   QPicoscope is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU Lesser General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   any later version.
+*
+*   QPicoscope is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU Lesser General Public License for more details.
+*
+*   You should have received a copy of the GNU Lesser General Public License
+*   along with QPicoscope in files COPYING.LESSER and COPYING.
+*   If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+/**
+ * @file samplearena.h
+ * @brief Declaration of SampleArena class.
+ * One aligned allocation that the capture buffers of a unit are carved
+ * from. It is sized once per configuration and kept across blocks, so the
+ * collect loops never allocate, and grows only when a longer record is
+ * asked for.
+ * @version 0.1
+ * @date 2026, october 16
+ * @author Vincent HERVIEUX    -   10.16.2026   -   initial creation
+ */
+
+#ifndef SAMPLEARENA_H
+#define SAMPLEARENA_H
+
+#include <stddef.h>
+
+#include "oscilloscope.h"
+
+/* every buffer starts on a cache line, also enough for any SIMD load */
+#define SAMPLE_ARENA_ALIGNMENT    64
+
+class SampleArena
+{
+public:
+    /** @brief constructor, nothing is allocated yet */
+    SampleArena();
+    /** @brief destructor */
+    ~SampleArena();
+
+    /** @brief size rounded up so that the next buffer stays aligned */
+    static size_t aligned_size(size_t size)
+    {
+        return (size + SAMPLE_ARENA_ALIGNMENT - 1) & ~(size_t)(SAMPLE_ARENA_ALIGNMENT - 1);
+    }
+    /**
+     * @brief make room for size bytes and forget every buffer carved so far
+     * Memory is only reallocated when size is larger than the capacity.
+     * @return false if memory is exhausted, buffers carved so far stay valid
+     */
+    bool reserve(size_t size);
+    /**
+     * @brief carve an aligned buffer
+     * @return NULL when reserve() did not make room for it
+     */
+    void* allocate(size_t size);
+    size_t get_capacity(void) const { return capacity_m; }
+
+private:
+    SampleArena(const SampleArena&);
+    SampleArena& operator=(const SampleArena&);
+
+    uint8_t *base_m;
+    size_t capacity_m;
+    size_t used_m;
+};
+
+#endif // SAMPLEARENA_H
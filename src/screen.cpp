@@ -29,23 +29,45 @@
 #include <QDateTime>
 #include <QMouseEvent>
 #include <QPaintEvent>
+#include <QResizeEvent>
 #include <QPainter>
 #include <QTimer>
 
 #include <qwt_plot_grid.h>
 #include <qwt_plot_marker.h>
 #include <qwt_plot_canvas.h>
+#include <qwt_scale_widget.h>
 
 #include <math.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "screen.h"
+#include "rawcurvedata.h"
+
+/* premultiplied ARGB of curveA to curveD, for the raster */
+static const uint32_t traceColors[FRAME_QUEUE_MAX_CHANNELS] = { 0xFF00FF00, 0xFFFF0000, 0xFFFF00FF, 0xFFFFFF00 };
 
 Screen::Screen(QWidget *parent)
-    : QwtPlot(parent)
+    : QwtPlot(parent),
+      frames(FRAME_QUEUE_DEPTH, 1024),
+      renderTimer(NULL),
+      currentRefreshRate(SCREEN_REFRESH_RATE),
+      needToRepait(false),
+      pipelineStats(NULL),
+      persistenceItem(&persistence),
+      persistenceEnabled(0),
+      lastPersistenceImage(0),
+      spectrumEnabled(0),
+      measurementEnabled(0)
 {
+    const char *rate = NULL;
+    const char *threads = NULL;
+
     initGradient();
 
+    for(uint8_t ch = 0; ch < FRAME_QUEUE_MAX_CHANNELS; ch++)
+        rawChannels[ch].valid = false;
     currentVoltCaliber = 0.;
     currentTimeCaliber = 0.;
     currentTrigger = E_TRIGGER_AUTO;
@@ -59,15 +81,15 @@ Screen::Screen(QWidget *parent)
     setAxisScale(QwtPlot::yLeft,-5.0,5.0);
     setAutoReplot(false);
 
-    QwtPlotGrid *grid = new QwtPlotGrid();
-    grid->setPen(QPen(Qt::gray, 0.0, Qt::DotLine));
-    grid->setXAxis(0);
-    grid->setYAxis(0);
-    grid->enableX(true);
-    grid->enableXMin(false);
-    grid->enableY(true);
-    grid->enableYMin(false);
-    grid->attach(this);
+    QwtPlotGrid &grid = staticLayer.grid();
+    grid.setPen(QPen(Qt::gray, 0.0, Qt::DotLine));
+    grid.setXAxis(0);
+    grid.setYAxis(0);
+    grid.enableX(true);
+    grid.enableXMin(false);
+    grid.enableY(true);
+    grid.enableYMin(false);
+    staticLayer.attach(this);
    
     curveA.setStyle(QwtPlotCurve::Lines);
     curveA.setPen(QPen(Qt::green));
@@ -89,10 +111,26 @@ Screen::Screen(QWidget *parent)
     curveD.setRenderHint(QwtPlotItem::RenderAntialiased, true);
     curveD.setPaintAttribute(QwtPlotCurve::ClipPolygons, false);
     curveD.attach(this);
-
-    pthread_mutex_init(&needToRepaitLock, NULL);
-
+    // decimated channels, drawn over the curves
+    threads = getenv(SCREEN_ENV_RASTER_THREADS);
+    if(NULL != threads)
+        traceRaster.setThreads((uint8_t)atoi(threads));
+    traceRaster.attach(this);
+    for(uint8_t ch = 0; ch < FRAME_QUEUE_MAX_CHANNELS; ch++)
+        persistence.setColor(ch, traceColors[ch]);
+    persistenceItem.hide();
+    persistenceItem.attach(this);
+
+    // zoom, pan or new time caliber
+    connect(axisWidget(QwtPlot::xBottom), SIGNAL(scaleDivChanged()), this, SLOT(xScaleChanged()));
     replot();
+
+    // the newest frame is drawn at the refresh rate, never from paintEvent()
+    renderTimer = new QTimer(this);
+    connect(renderTimer, SIGNAL(timeout()), this, SLOT(renderFrame()));
+    rate = getenv(SCREEN_ENV_REFRESH_RATE);
+    setRefreshRate((NULL != rate) ? atof(rate) : SCREEN_REFRESH_RATE);
+    renderTimer->start();
 }
 
 void Screen::initGradient()
@@ -104,7 +142,9 @@ void Screen::initGradient()
     gradient.setColorAt(0.0, QColor( 0, 49, 110 ) );
     gradient.setColorAt(1.0, QColor( 0, 87, 174 ) );
 
-    pal.setBrush(QPalette::Window, QBrush(gradient));
+    // painted once in the static layer, the canvas only fills a plain color under it
+    staticLayer.setBackground(QBrush(gradient));
+    pal.setBrush(QPalette::Window, QBrush(QColor( 0, 49, 110 )));
 
     canvas()->setPalette(pal);
 }
@@ -119,8 +159,8 @@ void Screen::setVoltCaliber(double voltCaliber)
     //update(cannonRect());
     //emit voltCaliberChanged(currentVoltCaliber);
     setAxisScale(QwtPlot::yLeft,-(5*currentVoltCaliber),(5*currentVoltCaliber), currentVoltCaliber);
-    // update all:
-    update();
+    // redrawn at the next render tick
+    needToRepait = true;
 }
 
 void Screen::setTimeCaliber(double timeCaliber)
@@ -132,8 +172,10 @@ void Screen::setTimeCaliber(double timeCaliber)
         return;
     currentTimeCaliber = timeCaliber;
     setAxisScale(QwtPlot::xBottom, 0.0, 5*currentTimeCaliber, currentTimeCaliber);
-    // update all:
-    update();
+    // computes the scale division now, xScaleChanged() decimates again for it
+    updateAxes();
+    // redrawn at the next render tick
+    needToRepait = true;
     //emit timeCaliberChanged(currentTimeCaliber);
 }
 
@@ -195,9 +237,15 @@ void Screen::mouseReleaseEvent(QMouseEvent *event)
 }
 //! [5]
 
+void Screen::resizeEvent(QResizeEvent *event)
+{
+    QwtPlot::resizeEvent(event);
+    // one min/max pair per column, the number of columns changed
+    updateRawCurves();
+}
+
 void Screen::paintEvent(QPaintEvent *event)
 {
-    bool needToRepaint_l = false;
     DEBUG("event %d\n", event->type());
 #if 0
     QFrame::paintEvent(event);  
@@ -232,14 +280,7 @@ void Screen::paintEvent(QPaintEvent *event)
 //        paintShot(painter);
 //    if (!gameEnded)
 //        paintTarget(painter);
-    pthread_mutex_lock(&needToRepaitLock);
-    needToRepaint_l = needToRepait;
-    pthread_mutex_unlock(&needToRepaitLock);
-    // TODO calling replot here is freezing the mainwindow.... But not calling it will never show the curves...
-    if(needToRepaint_l)
-    {
-        replot();
-    }
+    // replot() is called by renderFrame() only, a paint never starts another one
     event->accept();
 }
 
@@ -331,55 +372,289 @@ void Screen::paintEvent(QPaintEvent *event)
 //}
  
 
+/**
+ * Called from the acquisition thread: only touches the producer side of the frame queue.
+ */
 int8_t Screen::setData(uint8_t channel_id, double *x_data, double *y_data, uint32_t nb_points)
 {
+    if(0 != ATOMIC_LOAD_ACQUIRE(&persistenceEnabled))
+        persistence.setChannel(channel_id, x_data, y_data, nb_points);
+    if(0 != ATOMIC_LOAD_ACQUIRE(&spectrumEnabled))
+        spectrum.setChannel(channel_id, x_data, y_data, nb_points);
+    if(0 != ATOMIC_LOAD_ACQUIRE(&measurementEnabled))
+        measurement.setChannel(channel_id, x_data, y_data, nb_points);
+    return frames.setChannel(channel_id, x_data, y_data, nb_points);
+}
+
+/**
+ * Called from the acquisition thread: only the counts are copied, they are
+ * scaled when the curve is drawn.
+ */
+int8_t Screen::setRawData(uint8_t channel_id, const int16_t *raw, uint32_t nb_points,
+                          float scale, float offset, double x_origin, double x_interval, bool append)
+{
+    if(0 != ATOMIC_LOAD_ACQUIRE(&persistenceEnabled))
+        persistence.setRawChannel(channel_id, raw, nb_points, scale, offset, x_origin, x_interval);
+    if(0 != ATOMIC_LOAD_ACQUIRE(&spectrumEnabled))
+        spectrum.setRawChannel(channel_id, raw, nb_points, scale, offset, x_origin, x_interval);
+    if(0 != ATOMIC_LOAD_ACQUIRE(&measurementEnabled))
+        measurement.setRawChannel(channel_id, raw, nb_points, scale, offset, x_origin, x_interval);
+    return frames.setRawChannel(channel_id, raw, nb_points, scale, offset, x_origin, x_interval, append);
+}
+
+/**
+ * Called from the acquisition thread once per block.
+ * Nothing is queued on the GUI thread: the render timer takes the newest frame.
+ * With persistence, the worker gets every frame, and so do the spectrum threads in turn
+ * and the measurement thread.
+ */
+int8_t Screen::publishData(void)
+{
+    if(0 != ATOMIC_LOAD_ACQUIRE(&persistenceEnabled))
+        persistence.publish();
+    if(0 != ATOMIC_LOAD_ACQUIRE(&spectrumEnabled))
+        spectrum.publish();
+    if(0 != ATOMIC_LOAD_ACQUIRE(&measurementEnabled))
+        measurement.publish();
+    return frames.publish() ? 0 : -1;
+}
+
+void Screen::setPersistence(bool enabled, double decay)
+{
+    if(enabled)
+    {
+        persistence.setDecay(decay);
+        updatePersistenceView();
+        if(!persistence.isRunning() && !persistence.start())
+            return;
+        persistence.clear();
+        ATOMIC_STORE_RELEASE(&persistenceEnabled, 1);
+        persistenceItem.show();
+    }
+    else
+    {
+        ATOMIC_STORE_RELEASE(&persistenceEnabled, 0);
+        persistence.stop();
+        persistenceItem.hide();
+    }
+    needToRepait = true;
+}
 
-    QwtPlotCurve *curve = NULL;
-    // select channel_id
-    switch(channel_id)
+void Screen::setSpectrum(bool enabled, SpectrumWorker::window_e window, SpectrumWorker::mode_e mode, uint32_t averages)
+{
+    const char *threads = NULL;
+
+    if(enabled)
+    {
+        spectrum.setWindow(window);
+        spectrum.setMode(mode, averages);
+        if(!spectrum.isRunning())
+        {
+            threads = getenv(SCREEN_ENV_SPECTRUM_THREADS);
+            if(!spectrum.start((NULL != threads) ? (uint8_t)atoi(threads) : 0))
+                return;
+        }
+        ATOMIC_STORE_RELEASE(&spectrumEnabled, 1);
+    }
+    else
+    {
+        ATOMIC_STORE_RELEASE(&spectrumEnabled, 0);
+        spectrum.stop();
+    }
+}
+
+void Screen::setMeasures(uint32_t measures)
+{
+    if(0 != measures)
+    {
+        measurement.setMeasures(measures);
+        if(!measurement.isRunning())
+        {
+            if(!measurement.start())
+                return;
+            measurement.clear();
+        }
+        ATOMIC_STORE_RELEASE(&measurementEnabled, 1);
+    }
+    else
     {
-        case 1:
-            curve = &curveA;
-        break;
-        case 2:
-            curve = &curveB;
-        break;
-        case 3:
-            curve = &curveC;
-        break;
-        case 4:
-            curve = &curveD;
-        break;
-        default:
-            ERROR("invalid channel id : %d\n", channel_id);
-            return -1;
+        ATOMIC_STORE_RELEASE(&measurementEnabled, 0);
+        measurement.stop();
+    }
+}
 
+void Screen::updatePersistenceView()
+{
+    double xMin = 0.;
+    double xMax = 0.;
+    double yMin = 0.;
+    double yMax = 0.;
+
+#if ( QWT_VERSION >= 0x060100)
+    xMin = axisScaleDiv(QwtPlot::xBottom).lowerBound();
+    xMax = axisScaleDiv(QwtPlot::xBottom).upperBound();
+    yMin = axisScaleDiv(QwtPlot::yLeft).lowerBound();
+    yMax = axisScaleDiv(QwtPlot::yLeft).upperBound();
+#else
+    xMin = axisScaleDiv(QwtPlot::xBottom)->lowerBound();
+    xMax = axisScaleDiv(QwtPlot::xBottom)->upperBound();
+    yMin = axisScaleDiv(QwtPlot::yLeft)->lowerBound();
+    yMax = axisScaleDiv(QwtPlot::yLeft)->upperBound();
+#endif
+    persistence.setView((uint32_t)canvas()->width(), (uint32_t)canvas()->height(), xMin, xMax, yMin, yMax);
+}
+
+void Screen::setRefreshRate(double rate)
+{
+    if(rate <= 0.)
+        rate = SCREEN_REFRESH_RATE;
+    currentRefreshRate = rate;
+    renderTimer->setInterval((rate < 1000.) ? (int)(1000. / rate + 0.5) : 1);
+}
+
+/**
+ * Render timer, GUI thread. Any number of frames published since the last
+ * tick cost one takeLatest() and at most one replot.
+ */
+void Screen::renderFrame()
+{
+    uint64_t start = 0;
+
+    if(!isVisible() || window()->isMinimized())
+    {
+        // nothing is drawn, the acquisition still finds free frames
+        if(NULL != frames.takeLatest())
+            frames.release();
+        return;
+    }
+    consumeFrame();
+    if(0 != persistenceEnabled)
+    {
+        // nothing is cleared if neither the size nor the scales changed
+        updatePersistenceView();
+        if(persistence.imageCount() != lastPersistenceImage)
+        {
+            lastPersistenceImage = persistence.imageCount();
+            needToRepait = true;
+        }
     }
-    
-    if( nb_points <= INT_MAX )
+    if(!needToRepait)
+        return;
+    start = PipelineStats::now_ns();
+    replot();
+    // cleared after: xScaleChanged() from replot() updates the curves for this drawing
+    needToRepait = false;
+    if(NULL != pipelineStats)
+        pipelineStats->record(PipelineStats::E_STAGE_REPLOT, start);
+}
+
+bool Screen::consumeFrame()
+{
+    const FrameQueue::frame_t *frame = NULL;
+    const FrameQueue::channel_frame_t *channel = NULL;
+    QwtPlotCurve *curves[FRAME_QUEUE_MAX_CHANNELS] = { &curveA, &curveB, &curveC, &curveD };
+    uint8_t ch = 0;
+
+    frame = frames.takeLatest();
+    if(NULL == frame)
+        return false;
+
+    for(ch = 0; ch < FRAME_QUEUE_MAX_CHANNELS; ch++)
     {
+        if(0 == (frame->channel_mask & (1 << ch)))
+            continue;
+        channel = &frame->channels[ch];
+        if(channel->is_raw)
+        {
+            RawChannel &raw = rawChannels[ch];
+            // blocks appended to the same capture: index the new counts only
+            if(!raw.pyramid.assign(channel->capture, channel->raw, channel->nb_points))
+            {
+                raw.valid = false;
+                continue;
+            }
+            raw.scale = channel->scale;
+            raw.offset = channel->offset;
+            raw.xOrigin = channel->x_origin;
+            raw.xInterval = channel->x_interval;
+            raw.valid = true;
+            updateRawCurve(ch);
+            continue;
+        }
+        rawChannels[ch].valid = false;
+        traceRaster.clearPoints(ch);
 #if ( QWT_VERSION >= 0x060000)
-        curve->setSamples( x_data, y_data, (int)nb_points);
+        curves[ch]->setSamples( channel->x, channel->y, (int)channel->nb_points);
 #else
-        curve->setData( x_data, y_data, (int)nb_points);
+        curves[ch]->setData( channel->x, channel->y, (int)channel->nb_points);
 #endif
-        
     }
-    else
+    frames.release();
+    needToRepait = true;
+    return true;
+}
+
+void Screen::updateRawCurve(uint8_t ch)
+{
+    QwtPlotCurve *curves[FRAME_QUEUE_MAX_CHANNELS] = { &curveA, &curveB, &curveC, &curveD };
+    const RawChannel &raw = rawChannels[ch];
+    uint32_t columns = (uint32_t)canvas()->width();
+    uint32_t nbPoints = 0;
+    double xMin = 0.;
+    double xMax = 0.;
+
+    if(!raw.valid)
+        return;
+    if(!Decimator::isNeeded(raw.pyramid.size(), columns))
     {
-        // crazy to get such an amount of data at once...
+        // few enough points: scaled by RawCurveData while drawn
+        traceRaster.clearPoints(ch);
+        QVector<qint16> counts((int)raw.pyramid.size());
+        memcpy(counts.data(), raw.pyramid.data(), raw.pyramid.size() * sizeof(qint16));
 #if ( QWT_VERSION >= 0x060000)
-        curve->setSamples( x_data, y_data, INT_MAX);
-        curve->setSamples( x_data + INT_MAX, y_data + INT_MAX, (int)(nb_points-INT_MAX));
+        curves[ch]->setData( new RawCurveData(counts, raw.scale, raw.offset, raw.xOrigin, raw.xInterval));
 #else
-        curve->setData( x_data, y_data, INT_MAX);
-        curve->setData( x_data + INT_MAX, y_data + INT_MAX, (int)(nb_points-INT_MAX));
+        curves[ch]->setData( RawCurveData(counts, raw.scale, raw.offset, raw.xOrigin, raw.xInterval));
 #endif
+        return;
+    }
+
+    // whatever the zoom, the pyramid gives each column extrema in a few reads
+#if ( QWT_VERSION >= 0x060100)
+    xMin = axisScaleDiv(QwtPlot::xBottom).lowerBound();
+    xMax = axisScaleDiv(QwtPlot::xBottom).upperBound();
+#else
+    xMin = axisScaleDiv(QwtPlot::xBottom)->lowerBound();
+    xMax = axisScaleDiv(QwtPlot::xBottom)->upperBound();
+#endif
+    nbPoints = decimator.decimate(raw.pyramid, raw.scale, raw.offset,
+                                   raw.xOrigin, raw.xInterval, xMin, xMax, columns);
+    // one span per column, rasterised instead of a polyline
+    traceRaster.setPoints(ch, decimator.x(), decimator.y(), nbPoints, traceColors[ch]);
+#if ( QWT_VERSION >= 0x060000)
+    curves[ch]->setSamples( decimator.x(), decimator.y(), 0);
+#else
+    curves[ch]->setData( decimator.x(), decimator.y(), 0);
+#endif
+}
+
+void Screen::updateRawCurves()
+{
+    uint8_t ch = 0;
+
+    for(ch = 0; ch < FRAME_QUEUE_MAX_CHANNELS; ch++)
+    {
+        if(rawChannels[ch].valid)
+            updateRawCurve(ch);
     }
-    pthread_mutex_lock(&needToRepaitLock);
     needToRepait = true;
-    pthread_mutex_unlock(&needToRepaitLock);
-    update();
-    return 0;
 }
 
+/**
+ * Emitted by the scale widget from updateAxes(), before replot() draws the
+ * canvas: the curves are up to date for the new range in the same replot.
+ */
+void Screen::xScaleChanged()
+{
+    updateRawCurves();
+}
@@ -31,14 +31,32 @@
 //#include <QWidget>
 #include <qwt_plot.h>
 #include <qwt_plot_curve.h> 
+#include <QVector>
 
 #include "oscilloscope.h"
 #include "drawdata.h"
+#include "framequeue.h"
+#include "measurementworker.h"
+#include "minmaxpyramid.h"
+#include "pipelinestats.h"
+#include "persistenceitem.h"
+#include "persistenceworker.h"
+#include "spectrumworker.h"
+#include "staticlayeritem.h"
+#include "tracerasteritem.h"
 
 QT_BEGIN_NAMESPACE
 class QTimer;
 QT_END_NAMESPACE
 
+/* replots per second at most, overridden by QPICOSCOPE_REFRESH_RATE */
+#define SCREEN_REFRESH_RATE        60.
+#define SCREEN_ENV_REFRESH_RATE    "QPICOSCOPE_REFRESH_RATE"
+/* threads drawing decimated traces, 1 if not set */
+#define SCREEN_ENV_RASTER_THREADS  "QPICOSCOPE_RASTER_THREADS"
+/* threads computing the spectrum, one less than the processors if not set */
+#define SCREEN_ENV_SPECTRUM_THREADS "QPICOSCOPE_SPECTRUM_THREADS"
+
 class Screen : public QwtPlot, public DrawData
 {
     Q_OBJECT
@@ -81,6 +99,74 @@ public:
      * return : 0 if successful, -1 in case of error
      */
     int8_t setData(uint8_t channel_id, double *x_data, double *y_data, uint32_t nb_points);
+    /**
+     * @brief: set evenly spaced ADC counts to draw, see DrawData::setRawData()
+     * return : 0 if successful, -1 in case of error
+     */
+    int8_t setRawData(uint8_t channel_id, const int16_t *raw, uint32_t nb_points,
+                      float scale, float offset, double x_origin, double x_interval, bool append);
+    /**
+     * @brief: publish the channels set since the last call as one frame
+     * Can be called from the acquisition thread, curves are updated later on the GUI thread.
+     * return : 0 if published, -1 if the frame was dropped
+     */
+    int8_t publishData(void);
+    /**
+     * @brief get frame queue counters
+     * @param[out] stats published, dropped and skipped frames
+     */
+    void frameStats(FrameQueue::stats_t *stats) const { frames.getStats(stats); }
+    /**
+     * @brief time every replot in the replot stage of stats, GUI thread only
+     * @param[in] stats: NULL to stop timing
+     */
+    void setPipelineStats(PipelineStats *stats)
+        { pipelineStats = stats; persistence.setPipelineStats(stats);
+          spectrum.setPipelineStats(stats); measurement.setPipelineStats(stats); }
+    /**
+     * @brief show every waveform accumulated with the newest one, GUI thread only
+     * Counts are cleared each time the persistence is enabled, and when the
+     * canvas size or the scales change.
+     * @param[in] enabled: false goes back to the newest waveform only
+     * @param[in] decay: seconds for the counts to fall to 1/e, PERSISTENCE_INFINITE to keep them
+     */
+    void setPersistence(bool enabled, double decay);
+    bool isPersistenceEnabled() const { return 0 != persistenceEnabled; }
+    /** @brief get waveforms accumulated and time spent on them */
+    void persistenceStats(PersistenceWorker::stats_t *stats) const { persistence.getStats(stats); }
+    /**
+     * @brief compute the power spectrum of every waveform, GUI thread only
+     * The spectrum is cleared each time it is enabled or a setting changes.
+     * @param[in] enabled: false stops the spectrum threads
+     * @param[in] averages: waveforms in the average for SpectrumWorker::E_MODE_AVERAGE
+     */
+    void setSpectrum(bool enabled, SpectrumWorker::window_e window, SpectrumWorker::mode_e mode, uint32_t averages);
+    bool isSpectrumEnabled() const { return 0 != spectrumEnabled; }
+    /** @brief spectra to draw beside the screen, see SpectrumView */
+    SpectrumWorker* spectrumWorker() { return &spectrum; }
+    /** @brief get spectra computed and time spent on them */
+    void spectrumStats(SpectrumWorker::stats_t *stats) const { spectrum.getStats(stats); }
+    /**
+     * @brief measure every waveform, GUI thread only
+     * The statistics are cleared each time the measurements are enabled,
+     * and for the measurements added or removed.
+     * @param[in] measures: MEASUREMENT_BIT() of MeasurementScan::measure_e, 0 stops the measurement thread
+     */
+    void setMeasures(uint32_t measures);
+    bool isMeasurementEnabled() const { return 0 != measurementEnabled; }
+    /** @brief last value and statistics of every measurement, any thread */
+    void measurementResults(MeasurementWorker::results_t *results) { measurement.getResults(results); }
+    /** @brief a change means the results must be shown again */
+    uint64_t measurementCount() const { return measurement.resultCount(); }
+    /** @brief get blocks measured and time spent on them */
+    void measurementStats(MeasurementWorker::stats_t *stats) const { measurement.getStats(stats); }
+    /**
+     * @brief set how often the newest frame is drawn, GUI thread only
+     * Frames published in between are never drawn, whatever their rate.
+     * @param[in] rate: replots per second
+     */
+    void setRefreshRate(double rate);
+    double refreshRate() const { return currentRefreshRate; }
 
 public slots:
     /**
@@ -105,6 +191,10 @@ public slots:
     void setTrigger(trigger_e trigger);
 
 private slots:
+    /** @brief render timer: draw the newest frame, if any, GUI thread only */
+    void renderFrame();
+    /** @brief the visible time range changed, decimate the counts for it */
+    void xScaleChanged();
 
 signals:
 
@@ -113,6 +203,7 @@ protected:
     void mousePressEvent(QMouseEvent *event);
     void mouseMoveEvent(QMouseEvent *event);
     void mouseReleaseEvent(QMouseEvent *event);
+    void resizeEvent(QResizeEvent *event);
 
 private:
 
@@ -121,15 +212,61 @@ private:
     current_e currentCurrent;
     trigger_e currentTrigger;
     void initGradient();
+    /** @brief take the newest acquired frame and update the curves, false if none */
+    bool consumeFrame();
+    /** @brief draw the last counts of a channel, decimated when they outnumber the pixels */
+    void updateRawCurve(uint8_t ch);
+    /** @brief redo updateRawCurve() for every channel drawn from counts */
+    void updateRawCurves();
+    /** @brief give the canvas size and scales to the persistence worker */
+    void updatePersistenceView();
+    /** @brief gradient and grid, redrawn only on scale or size change */
+    StaticLayerItem staticLayer;
     /* TODO Could be improved (table, list...)*/
     QwtPlotCurve curveA;
     QwtPlotCurve curveB;
     QwtPlotCurve curveC;
     QwtPlotCurve curveD;
+    /** @brief decimated channels, their curves are left empty */
+    TraceRasterItem traceRaster;
 
+    /** @brief last counts of each channel, kept to decimate again on resize, zoom or pan */
+    struct RawChannel
+    {
+        bool valid;
+        MinMaxPyramid pyramid;
+        float scale;
+        float offset;
+        double xOrigin;
+        double xInterval;
+    };
+    RawChannel rawChannels[FRAME_QUEUE_MAX_CHANNELS];
+    Decimator decimator;
+
+    /** @brief frames from the acquisition thread */
+    FrameQueue frames;
+    /** @brief ticks renderFrame() while the screen is shown */
+    QTimer *renderTimer;
+    double currentRefreshRate;
+    /** @brief curves or axes changed since the last replot, only used from the GUI thread */
     bool needToRepait;
-    pthread_mutex_t needToRepaitLock;
-    
+    /** @brief replot timings, only used from the GUI thread */
+    PipelineStats *pipelineStats;
+    /** @brief every waveform since enabled, under the curves */
+    PersistenceWorker persistence;
+    PersistenceItem persistenceItem;
+    /** @brief read by the acquisition thread, 0 when waveforms are not accumulated */
+    int persistenceEnabled;
+    uint64_t lastPersistenceImage;
+    /** @brief power spectrum of every waveform, drawn by a SpectrumView */
+    SpectrumWorker spectrum;
+    /** @brief read by the acquisition thread, 0 when no spectrum is computed */
+    int spectrumEnabled;
+    /** @brief automatic measurements of every waveform */
+    MeasurementWorker measurement;
+    /** @brief read by the acquisition thread, 0 when nothing is measured */
+    int measurementEnabled;
+
 };
 
 #endif
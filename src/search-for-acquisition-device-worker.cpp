@@ -50,6 +50,7 @@ void SearchForAcquisitionDeviceWorker::searchForAcquisitionDevice(void)
     memset(&device_info, 0, sizeof(Acquisition::device_info_t));
     do
     {
+        /* every series probed at once, returns on the first opened unit */
         device = Acquisition::get_instance();
         if(NULL == device)
         {
@@ -57,10 +58,14 @@ void SearchForAcquisitionDeviceWorker::searchForAcquisitionDevice(void)
             snprintf(device_info.device_name, DEVICE_NAME_MAX ,"No detected device...!");
             //((QMainWindow*)(parent_m->parent_m))->statusBar()->showMessage(tr(device_info.device_name), 1000);
             emit newStatusBarMessage(tr(device_info.device_name));
-            sleep(1);
+            /* sleep until a Pico device is plugged (or the poll period without uevents) */
+            running = (HotplugMonitor::E_HOTPLUG_CANCELLED != hotplug_m.wait());
         }
     }while((NULL == device) && running);
 
+    if(NULL == device)
+        return;
+
     pthread_mutex_lock(&parent_m->acquisitionLock_m);
     parent_m->acquisition_m = device;
     parent_m->acquisition_m->setDrawData(parent_m->screen_m);
@@ -93,6 +98,9 @@ void SearchForAcquisitionDeviceWorker::searchForAcquisitionDevice(void)
     {
         parent_m->volt_channel_B_m->setVisible(false);
     }
+    parent_m->acquisition_m->set_record_length((parent_m->record_items_m->at(parent_m->record_m->value())).value);
+    parent_m->acquisition_m->set_streaming((parent_m->mode_items_m->at(parent_m->mode_m->value())).streaming);
+    parent_m->acquisition_m->set_trigger_interpolation((parent_m->interpolation_items_m->at(parent_m->interpolation_m->value())).method);
     parent_m->acquisition_m->set_timebase((parent_m->time_items_m->at(0)).value);
     parent_m->acquisition_m->start();
     pthread_mutex_unlock(&parent_m->acquisitionLock_m);
@@ -100,4 +108,5 @@ void SearchForAcquisitionDeviceWorker::searchForAcquisitionDevice(void)
 
 void SearchForAcquisitionDeviceWorker::stopSearchForAcquisitionDevice(void)
 {
+    hotplug_m.cancel();
 }
@@ -32,6 +32,7 @@
 
 #include <QObject>
 #include "oscilloscope.h"
+#include "hotplugmonitor.h"
 
 class FrontPanel;
 
@@ -42,14 +43,17 @@ class SearchForAcquisitionDeviceWorker : public QObject
 
  public:
     SearchForAcquisitionDeviceWorker(FrontPanel *parent);
+    /** @brief end the search, called directly from any thread since it blocks its own */
+    void stopSearchForAcquisitionDevice(void);
 
  public slots:
     /** @brief thread searching for acquisition device */
     void searchForAcquisitionDevice(void);
-    void stopSearchForAcquisitionDevice(void);
 
  private:
     FrontPanel* parent_m;
+    /** @brief wakes the search when a device is plugged */
+    HotplugMonitor hotplug_m;
  signals:
     void newStatusBarMessage(QString text);
 };
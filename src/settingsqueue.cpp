@@ -0,0 +1,169 @@
+/*****************************************************************************
+*   Copyright 2012 Vincent HERVIEUX
+*
+*   This file is part of QPicoscope.
+*
+*   QPicoscope is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU Lesser General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   any later version.
+*
+*   QPicoscope is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU Lesser General Public License for more details.
+*
+*   You should have received a copy of the GNU Lesser General Public License
+*   along with QPicoscope in files COPYING.LESSER and COPYING.
+*   If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+/**
+ * @file settingsqueue.cpp
+ * @brief Definition of SettingsQueue class.
+ * @version 0.1
+ * @date 2026, october 16
+ * @author Vincent HERVIEUX    -   10.16.2026   -   initial creation
+ */
+
+#include <string.h>
+
+#include "settingsqueue.h"
+#include "atomic-ops.h"
+
+/****************************************************************************
+ *
+ * constructor
+ *
+ ****************************************************************************/
+SettingsQueue::SettingsQueue() :
+    dirty_m(0)
+{
+    memset(&pending_m, 0, sizeof(settings_batch_t));
+    pthread_mutex_init(&lock_m, NULL);
+}
+
+/****************************************************************************
+ *
+ * destructor
+ *
+ ****************************************************************************/
+SettingsQueue::~SettingsQueue()
+{
+    pthread_mutex_destroy(&lock_m);
+}
+
+/****************************************************************************
+ * post_voltages
+ ****************************************************************************/
+void SettingsQueue::post_voltages(uint8_t channel_index, double volts_per_division)
+{
+    if(channel_index >= SETTINGS_MAX_CHANNELS)
+    {
+        ERROR("invalid channel index %d\n", channel_index);
+        return;
+    }
+    pthread_mutex_lock(&lock_m);
+    pending_m.volts_per_division[channel_index] = volts_per_division;
+    pending_m.channels |= (uint8_t)(1 << channel_index);
+    pending_m.dirty |= SETTINGS_VOLTAGES;
+    ATOMIC_STORE_RELEASE(&dirty_m, pending_m.dirty);
+    pthread_mutex_unlock(&lock_m);
+}
+
+/****************************************************************************
+ * post_coupling
+ ****************************************************************************/
+void SettingsQueue::post_coupling(current_e coupling)
+{
+    pthread_mutex_lock(&lock_m);
+    pending_m.coupling = coupling;
+    pending_m.dirty |= SETTINGS_COUPLING;
+    ATOMIC_STORE_RELEASE(&dirty_m, pending_m.dirty);
+    pthread_mutex_unlock(&lock_m);
+}
+
+/****************************************************************************
+ * post_timebase
+ ****************************************************************************/
+void SettingsQueue::post_timebase(double time_per_division)
+{
+    pthread_mutex_lock(&lock_m);
+    pending_m.time_per_division = time_per_division;
+    pending_m.dirty |= SETTINGS_TIMEBASE;
+    ATOMIC_STORE_RELEASE(&dirty_m, pending_m.dirty);
+    pthread_mutex_unlock(&lock_m);
+}
+
+/****************************************************************************
+ * post_trigger
+ ****************************************************************************/
+void SettingsQueue::post_trigger(trigger_e trigger_slope, double trigger_level)
+{
+    pthread_mutex_lock(&lock_m);
+    pending_m.trigger_slope = trigger_slope;
+    pending_m.trigger_level = trigger_level;
+    pending_m.dirty |= SETTINGS_TRIGGER;
+    ATOMIC_STORE_RELEASE(&dirty_m, pending_m.dirty);
+    pthread_mutex_unlock(&lock_m);
+}
+
+/****************************************************************************
+ * post_record_length
+ ****************************************************************************/
+void SettingsQueue::post_record_length(uint32_t record_length)
+{
+    pthread_mutex_lock(&lock_m);
+    pending_m.record_length = record_length;
+    pending_m.dirty |= SETTINGS_RECORD_LENGTH;
+    ATOMIC_STORE_RELEASE(&dirty_m, pending_m.dirty);
+    pthread_mutex_unlock(&lock_m);
+}
+
+/****************************************************************************
+ * post_streaming
+ ****************************************************************************/
+void SettingsQueue::post_streaming(bool streaming)
+{
+    pthread_mutex_lock(&lock_m);
+    pending_m.streaming = streaming;
+    pending_m.dirty |= SETTINGS_STREAMING;
+    ATOMIC_STORE_RELEASE(&dirty_m, pending_m.dirty);
+    pthread_mutex_unlock(&lock_m);
+}
+
+/****************************************************************************
+ * post_interpolation
+ ****************************************************************************/
+void SettingsQueue::post_interpolation(TriggerInterpolator::method_e interpolation)
+{
+    pthread_mutex_lock(&lock_m);
+    pending_m.interpolation = interpolation;
+    pending_m.dirty |= SETTINGS_INTERPOLATION;
+    ATOMIC_STORE_RELEASE(&dirty_m, pending_m.dirty);
+    pthread_mutex_unlock(&lock_m);
+}
+
+/****************************************************************************
+ * pending
+ ****************************************************************************/
+bool SettingsQueue::pending(void) const
+{
+    return (0 != ATOMIC_LOAD_ACQUIRE(&dirty_m));
+}
+
+/****************************************************************************
+ * take
+ ****************************************************************************/
+bool SettingsQueue::take(settings_batch_t *batch)
+{
+    if((NULL == batch) || !pending())
+        return false;
+
+    pthread_mutex_lock(&lock_m);
+    memcpy(batch, &pending_m, sizeof(settings_batch_t));
+    pending_m.dirty = 0;
+    pending_m.channels = 0;
+    ATOMIC_STORE_RELEASE(&dirty_m, 0);
+    pthread_mutex_unlock(&lock_m);
+    return (0 != batch->dirty);
+}
@@ -0,0 +1,114 @@
+/*****************************************************************************
+*   Copyright 2012 Vincent HERVIEUX
+*
+*   This file is part of QPicoscope.
+*
+*   QPicoscope is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU Lesser General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   any later version.
+*
+*   QPicoscope is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU Lesser General Public License for more details.
+*
+*   You should have received a copy of the GNU Lesser General Public License
+*   along with QPicoscope in files COPYING.LESSER and COPYING.
+*   If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+/**
+ * @file settingsqueue.h
+ * @brief Declaration of SettingsQueue class.
+ * Settings posted by the front panel while the acquisition thread runs.
+ * Posting the same setting twice before the acquisition thread drains the
+ * queue keeps only the last value, so a burst of GUI events ends up in a
+ * single reconfiguration.
+ * @version 0.1
+ * @date 2026, october 16
+ * @author Vincent HERVIEUX    -   10.16.2026   -   initial creation
+ */
+
+#ifndef SETTINGSQUEUE_H
+#define SETTINGSQUEUE_H
+
+#include <pthread.h>
+
+#include "oscilloscope.h"
+#include "triggerinterpolator.h"
+
+#define SETTINGS_MAX_CHANNELS    4
+
+/* settings_batch_t::dirty bits */
+#define SETTINGS_VOLTAGES        0x01
+#define SETTINGS_COUPLING        0x02
+#define SETTINGS_TIMEBASE        0x04
+#define SETTINGS_TRIGGER         0x08
+#define SETTINGS_RECORD_LENGTH   0x10
+#define SETTINGS_STREAMING       0x20
+#define SETTINGS_INTERPOLATION   0x40
+/** @brief changes that need the capture to be set up again */
+#define SETTINGS_REARM           (SETTINGS_TIMEBASE | SETTINGS_TRIGGER | SETTINGS_RECORD_LENGTH | SETTINGS_STREAMING | \
+                                  SETTINGS_INTERPOLATION)
+
+class SettingsQueue
+{
+public:
+    /**
+     * @brief public typedef declarations
+     */
+    typedef struct
+    {
+        uint32_t  dirty;
+        /** @brief bit n set when volts_per_division[n] is to be applied */
+        uint8_t   channels;
+        double    volts_per_division[SETTINGS_MAX_CHANNELS];
+        current_e coupling;
+        double    time_per_division;
+        trigger_e trigger_slope;
+        double    trigger_level;
+        uint32_t  record_length;
+        bool      streaming;
+        TriggerInterpolator::method_e interpolation;
+    } settings_batch_t;
+
+    /** @brief constructor */
+    SettingsQueue();
+    /** @brief destructor */
+    ~SettingsQueue();
+
+    /** @brief GUI side: post a volts per division change for a channel */
+    void post_voltages(uint8_t channel_index, double volts_per_division);
+    /** @brief GUI side: post a coupling change, applies to all channels */
+    void post_coupling(current_e coupling);
+    /** @brief GUI side: post a time per division change */
+    void post_timebase(double time_per_division);
+    /** @brief GUI side: post a trigger change */
+    void post_trigger(trigger_e trigger_slope, double trigger_level);
+    /** @brief GUI side: post a record length change, in samples per channel */
+    void post_record_length(uint32_t record_length);
+    /** @brief GUI side: post a switch between block captures and continuous streaming */
+    void post_streaming(bool streaming);
+    /** @brief GUI side: post a change of the trigger point interpolation */
+    void post_interpolation(TriggerInterpolator::method_e interpolation);
+
+    /** @brief acquisition side: cheap check, no lock taken */
+    bool pending(void) const;
+    /**
+     * @brief acquisition side: take everything posted so far in one batch
+     * @param[out] batch: the coalesced settings
+     * @return false when nothing was posted
+     */
+    bool take(settings_batch_t *batch);
+
+private:
+    SettingsQueue(const SettingsQueue&);
+    SettingsQueue& operator=(const SettingsQueue&);
+
+    pthread_mutex_t lock_m;
+    settings_batch_t pending_m;
+    /** @brief copy of pending_m.dirty readable without the lock */
+    uint32_t dirty_m;
+};
+
+#endif // SETTINGSQUEUE_H
@@ -0,0 +1,312 @@
+/*****************************************************************************
+*   Copyright 2012 Vincent HERVIEUX
+*
+*   This file is part of QPicoscope.
+*
+*   QPicoscope is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU Lesser General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   any later version.
+*
+*   QPicoscope is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU Lesser General Public License for more details.
+*
+*   You should have received a copy of the GNU Lesser General Public License
+*   along with QPicoscope in files COPYING.LESSER and COPYING.
+*   If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+/**
+ * @file signalgenerator.cpp
+ * @brief Definition of SignalGenerator class.
+ * @version 0.1
+ * @date 2026, october 16
+ * @author Vincent HERVIEUX    -   10.16.2026   -   initial creation
+ */
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "signalgenerator.h"
+
+/* longest key=value pair of a description */
+#define SIGNAL_MAX_TOKEN    64
+
+/****************************************************************************
+ * clamp
+ ****************************************************************************/
+static inline int16_t clamp(int32_t value)
+{
+    if (value > SIGNAL_MAX_ADC)
+        return SIGNAL_MAX_ADC;
+    if (value < -SIGNAL_MAX_ADC)
+        return -SIGNAL_MAX_ADC;
+    return (int16_t)value;
+}
+
+/****************************************************************************
+ * xorshift
+ ****************************************************************************/
+static inline uint32_t xorshift(uint32_t *state)
+{
+    uint32_t x = *state;
+
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+    return x;
+}
+
+/****************************************************************************
+ *
+ * constructor
+ *
+ ****************************************************************************/
+SignalGenerator::SignalGenerator() :
+    sample_interval_m(1E-8),
+    full_scale_m(1.),
+    offset_m(0),
+    phase_m(0),
+    step_m(0),
+    noise_m(0),
+    random_m(0x2545f491),
+    glitch_m(0),
+    glitch_in_m(0),
+    glitch_mean_m(0),
+    burst_period_m(0),
+    burst_on_m(0),
+    burst_position_m(0)
+{
+    memset(&signal_m, 0, sizeof(signal_m));
+    signal_m.wave = E_SIGNAL_SINE;
+    signal_m.frequency = 1000.;
+    signal_m.amplitude = 1.;
+    configure(sample_interval_m, full_scale_m);
+}
+
+/****************************************************************************
+ * parse
+ ****************************************************************************/
+bool SignalGenerator::parse(const char *description, signal_t *signal)
+{
+    static const char *waves[] = { "sine", "square", "triangle", "noise", "dc" };
+    signal_t parsed = *signal;
+    char token[SIGNAL_MAX_TOKEN];
+    const char *end = NULL;
+    char *value = NULL;
+    char *stop = NULL;
+    double number = 0.;
+    size_t length = 0;
+    uint8_t i = 0;
+
+    if (NULL == description)
+        return false;
+    while ('\0' != *description)
+    {
+        end = strchr(description, ',');
+        length = (NULL != end) ? (size_t)(end - description) : strlen(description);
+        if (length >= SIGNAL_MAX_TOKEN)
+            return false;
+        memcpy(token, description, length);
+        token[length] = '\0';
+        description += length + ((NULL != end) ? 1 : 0);
+
+        value = strchr(token, '=');
+        if (NULL == value)
+            return false;
+        *value++ = '\0';
+        if (0 == strcmp(token, "wave"))
+        {
+            for (i = 0; i < sizeof(waves) / sizeof(waves[0]); i++)
+            {
+                if (0 == strcmp(value, waves[i]))
+                    break;
+            }
+            if (i >= sizeof(waves) / sizeof(waves[0]))
+                return false;
+            parsed.wave = (wave_e)i;
+            continue;
+        }
+        number = strtod(value, &stop);
+        if ((stop == value) || ('\0' != *stop))
+            return false;
+        if (0 == strcmp(token, "freq"))
+            parsed.frequency = number;
+        else if (0 == strcmp(token, "amp"))
+            parsed.amplitude = number;
+        else if (0 == strcmp(token, "offset"))
+            parsed.offset = number;
+        else if (0 == strcmp(token, "noise"))
+            parsed.noise = number;
+        else if (0 == strcmp(token, "glitch"))
+            parsed.glitch_rate = number;
+        else if (0 == strcmp(token, "glitch_amp"))
+            parsed.glitch_amplitude = number;
+        else if (0 == strcmp(token, "burst"))
+            parsed.burst_period = number;
+        else if (0 == strcmp(token, "duty"))
+            parsed.burst_duty = number;
+        else
+            return false;
+    }
+    *signal = parsed;
+    return true;
+}
+
+/****************************************************************************
+ * set_signal
+ ****************************************************************************/
+void SignalGenerator::set_signal(const signal_t &signal)
+{
+    signal_m = signal;
+    configure(sample_interval_m, full_scale_m);
+}
+
+/****************************************************************************
+ * to_counts
+ ****************************************************************************/
+int32_t SignalGenerator::to_counts(double volts) const
+{
+    double counts = volts * SIGNAL_MAX_ADC / full_scale_m;
+
+    if (counts > SIGNAL_MAX_ADC)
+        return SIGNAL_MAX_ADC;
+    if (counts < -SIGNAL_MAX_ADC)
+        return -SIGNAL_MAX_ADC;
+    return (int32_t)lrint(counts);
+}
+
+/****************************************************************************
+ * random_uniform
+ ****************************************************************************/
+double SignalGenerator::random_uniform(void)
+{
+    return (double)xorshift(&random_m) / 2147483648. - 1.;
+}
+
+/****************************************************************************
+ * configure
+ *
+ * Everything is turned into counts and samples here, generate() only
+ * does integer work.
+ ****************************************************************************/
+void SignalGenerator::configure(double sample_interval, double full_scale)
+{
+    double cycles = 0.;
+    double x = 0.;
+    double w = 0.;
+    uint32_t i = 0;
+
+    sample_interval_m = (sample_interval > 0.) ? sample_interval : 1E-8;
+    full_scale_m = (full_scale > 0.) ? full_scale : 1.;
+
+    for (i = 0; i < SIGNAL_TABLE_SIZE; i++)
+    {
+        x = (double)i / SIGNAL_TABLE_SIZE;
+        switch (signal_m.wave)
+        {
+        case E_SIGNAL_SINE:
+            w = sin(2 * M_PI * x);
+            break;
+        case E_SIGNAL_SQUARE:
+            w = (x < 0.5) ? 1. : -1.;
+            break;
+        case E_SIGNAL_TRIANGLE:
+            w = (x < 0.5) ? 4 * x - 1 : 3 - 4 * x;
+            break;
+        default:
+            w = 0.;
+            break;
+        }
+        table_m[i] = (int16_t)to_counts(signal_m.amplitude * w + signal_m.offset);
+    }
+    offset_m = (int16_t)to_counts(signal_m.offset);
+
+    /* frequency in 2^32 steps per period, aliased like a real ADC above Nyquist */
+    cycles = fmod(signal_m.frequency * sample_interval_m, 1.);
+    step_m = (uint32_t)(cycles * 4294967296.);
+
+    noise_m = to_counts(signal_m.noise + ((E_SIGNAL_NOISE == signal_m.wave) ? signal_m.amplitude : 0.));
+    glitch_m = to_counts(signal_m.glitch_amplitude);
+    glitch_mean_m = (signal_m.glitch_rate > 0.) ? (uint64_t)(1. / (signal_m.glitch_rate * sample_interval_m)) + 1 : 0;
+    glitch_in_m = glitch_mean_m;
+    burst_period_m = (signal_m.burst_period > 0.) ? (uint64_t)(signal_m.burst_period / sample_interval_m) + 1 : 0;
+    burst_on_m = (uint64_t)(signal_m.burst_duty * burst_period_m);
+    burst_position_m = 0;
+}
+
+/****************************************************************************
+ * generate
+ *
+ * Samples are made in runs with neither glitch nor burst edge inside, so
+ * the inner loops stay branch free.
+ ****************************************************************************/
+void SignalGenerator::generate(int16_t *counts, uint32_t count)
+{
+    uint32_t phase = phase_m;
+    uint32_t random = random_m;
+    uint64_t run = 0;
+    uint32_t i = 0;
+    bool on = true;
+
+    while (count > 0)
+    {
+        run = count;
+        if (0 != burst_period_m)
+        {
+            on = (burst_position_m < burst_on_m);
+            if (on && (run > burst_on_m - burst_position_m))
+                run = burst_on_m - burst_position_m;
+            if (!on && (run > burst_period_m - burst_position_m))
+                run = burst_period_m - burst_position_m;
+        }
+        if ((0 != glitch_in_m) && (run > glitch_in_m))
+            run = glitch_in_m;
+
+        if (!on)
+        {
+            for (i = 0; i < run; i++)
+                counts[i] = offset_m;
+            phase += (uint32_t)(step_m * run);
+        }
+        else
+        {
+            for (i = 0; i < run; i++)
+            {
+                counts[i] = table_m[phase >> (32 - SIGNAL_TABLE_SHIFT)];
+                phase += step_m;
+            }
+        }
+        if (0 != noise_m)
+        {
+            for (i = 0; i < run; i++)
+                counts[i] = clamp(counts[i] + ((noise_m * ((int32_t)(xorshift(&random) >> 16) - 32768)) >> 15));
+        }
+
+        if (0 != glitch_in_m)
+        {
+            glitch_in_m -= run;
+            if (0 == glitch_in_m)
+            {
+                counts[run - 1] = clamp(counts[run - 1] + glitch_m);
+                random_m = random;
+                /* exponential intervals, glitches come at random times */
+                glitch_in_m = (uint64_t)(-log(0.5 * (random_uniform() + 1.) + 1E-12) * glitch_mean_m) + 1;
+                random = random_m;
+            }
+        }
+        if (0 != burst_period_m)
+        {
+            burst_position_m += run;
+            if (burst_position_m >= burst_period_m)
+                burst_position_m = 0;
+        }
+        counts += run;
+        count -= (uint32_t)run;
+    }
+    phase_m = phase;
+    random_m = random;
+}
@@ -0,0 +1,125 @@
+/*****************************************************************************
+*   Copyright 2012 Vincent HERVIEUX
+*
+*   This file is part of QPicoscope.
+*
+*   QPicoscope is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU Lesser General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   any later version.
+*
+*   QPicoscope is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU Lesser General Public License for more details.
+*
+*   You should have received a copy of the GNU Lesser General Public License
+*   along with QPicoscope in files COPYING.LESSER and COPYING.
+*   If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+/**
+ * @file signalgenerator.h
+ * @brief Declaration of SignalGenerator class.
+ * Synthetic ADC counts for one channel: a sine, square, triangle, noise or
+ * DC waveform, with optional noise, glitches and bursts on top. The
+ * waveform is read from a one period table with a phase accumulator, so
+ * a sample costs a table load, an add and a clamp, and several hundred
+ * MS/s are generated on a single core.
+ * @version 0.1
+ * @date 2026, october 16
+ * @author Vincent HERVIEUX    -   10.16.2026   -   initial creation
+ */
+
+#ifndef SIGNALGENERATOR_H
+#define SIGNALGENERATOR_H
+
+#include "oscilloscope.h"
+
+/* samples in the one period table, a power of two */
+#define SIGNAL_TABLE_SHIFT    12
+#define SIGNAL_TABLE_SIZE     (1 << SIGNAL_TABLE_SHIFT)
+/* ADC count at full scale of a range */
+#define SIGNAL_MAX_ADC        32767
+
+class SignalGenerator
+{
+public:
+    /**
+     * @brief public typedef declarations
+     */
+    typedef enum
+    {
+        E_SIGNAL_SINE = 0,
+        E_SIGNAL_SQUARE,
+        E_SIGNAL_TRIANGLE,
+        E_SIGNAL_NOISE,
+        E_SIGNAL_DC
+    } wave_e;
+
+    /** @brief volts and seconds, 0 disables an option */
+    typedef struct
+    {
+        wave_e wave;
+        double frequency;
+        /** @brief peak amplitude, the noise peak for E_SIGNAL_NOISE */
+        double amplitude;
+        double offset;
+        /** @brief peak of the uniform noise added to the waveform */
+        double noise;
+        /** @brief one sample spikes per second, at random times */
+        double glitch_rate;
+        double glitch_amplitude;
+        /** @brief the waveform is on for burst_duty of every burst_period, at offset otherwise */
+        double burst_period;
+        double burst_duty;
+    } signal_t;
+
+    /** @brief constructor, a 1 kHz 1 V sine */
+    SignalGenerator();
+
+    /**
+     * @brief parse a "key=value,..." description, unknown keys are errors
+     * Keys: wave (sine, square, triangle, noise, dc), freq, amp, offset,
+     * noise, glitch, glitch_amp, burst, duty.
+     * @return false if the description cannot be parsed, signal is then unchanged
+     */
+    static bool parse(const char *description, signal_t *signal);
+    void set_signal(const signal_t &signal);
+    const signal_t& get_signal(void) const { return signal_m; }
+    /**
+     * @brief sample timing and input range, the phase goes on
+     * @param[in] sample_interval: seconds between two samples
+     * @param[in] full_scale: volts at SIGNAL_MAX_ADC
+     */
+    void configure(double sample_interval, double full_scale);
+    /** @brief next samples of the signal, the phase goes on from the previous call */
+    void generate(int16_t *counts, uint32_t count);
+
+private:
+    /** @brief volts to counts of the current range, clamped */
+    int32_t to_counts(double volts) const;
+    /** @brief uniform in [-1, 1[ */
+    double random_uniform(void);
+
+    signal_t signal_m;
+    double sample_interval_m;
+    double full_scale_m;
+    /** @brief one period, waveform and offset in counts */
+    int16_t table_m[SIGNAL_TABLE_SIZE];
+    int16_t offset_m;
+    uint32_t phase_m;
+    uint32_t step_m;
+    /** @brief noise peak in counts, 0 for none */
+    int32_t noise_m;
+    uint32_t random_m;
+    int32_t glitch_m;
+    /** @brief samples until the next glitch, 0 for none */
+    uint64_t glitch_in_m;
+    uint64_t glitch_mean_m;
+    /** @brief samples per burst period and on per period, 0 for always on */
+    uint64_t burst_period_m;
+    uint64_t burst_on_m;
+    uint64_t burst_position_m;
+};
+
+#endif // SIGNALGENERATOR_H
@@ -0,0 +1,122 @@
+/*****************************************************************************
+*   Copyright 2012 Vincent HERVIEUX
+*
+*   This file is part of QPicoscope.
+*
+*   QPicoscope is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU Lesser General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   any later version.
+*
+*   QPicoscope is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU Lesser General Public License for more details.
+*
+*   You should have received a copy of the GNU Lesser General Public License
+*   along with QPicoscope in files COPYING.LESSER and COPYING.
+*   If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+/**
+ * @file spectrumview.cpp
+ * @brief Definition of SpectrumView class.
+ * @version 0.1
+ * @date 2026, october 16
+ * @author Vincent HERVIEUX    -   10.16.2026   -   initial creation
+ */
+
+#include <QPen>
+#include <QTimer>
+
+#include "spectrumview.h"
+
+static const Qt::GlobalColor traceColors[SPECTRUM_MAX_CHANNELS] = { Qt::green, Qt::red, Qt::magenta, Qt::yellow };
+
+SpectrumView::SpectrumView(SpectrumWorker *worker, QWidget *parent)
+    : QwtPlot(parent),
+      worker(worker),
+      renderTimer(NULL),
+      lastView(0),
+      currentNyquist(0.)
+{
+    setCanvasBackground(QColor(0, 49, 110));
+    setAxisTitle(QwtPlot::xBottom, "Frequency [Hz]");
+    setAxisScale(QwtPlot::xBottom, 0.0, 1.0);
+    setAxisTitle(QwtPlot::yLeft, "Power [dBV]");
+    setAxisScale(QwtPlot::yLeft, SPECTRUM_VIEW_DB_MIN, SPECTRUM_VIEW_DB_MAX, 20.);
+    setAutoReplot(false);
+
+    for(uint8_t ch = 0; ch < SPECTRUM_MAX_CHANNELS; ch++)
+    {
+        curves[ch].setStyle(QwtPlotCurve::Lines);
+        curves[ch].setPen(QPen(traceColors[ch]));
+        curves[ch].setPaintAttribute(QwtPlotCurve::ClipPolygons, false);
+        curves[ch].attach(this);
+    }
+
+    renderTimer = new QTimer(this);
+    renderTimer->setInterval((int)(1000. / SPECTRUM_RENDER_RATE + 0.5));
+    connect(renderTimer, SIGNAL(timeout()), this, SLOT(renderView()));
+    hide();
+}
+
+void SpectrumView::setActive(bool active)
+{
+    if(active)
+    {
+        lastView = worker->viewCount();
+        renderTimer->start();
+        show();
+    }
+    else
+    {
+        renderTimer->stop();
+        hide();
+    }
+}
+
+/**
+ * Render timer, GUI thread. The view is copied under its lock, the
+ * spectrum threads only wait for it when a new view is ready.
+ */
+void SpectrumView::renderView()
+{
+    SpectrumWorker::view_t view;
+    double nyquist = 0.;
+    uint32_t nb_points[SPECTRUM_MAX_CHANNELS];
+    uint32_t i = 0;
+    uint8_t ch = 0;
+
+    if(!isVisible() || window()->isMinimized() || (worker->viewCount() == lastView))
+        return;
+    if(!worker->lockView(&view))
+        return;
+    lastView = worker->viewCount();
+    for(ch = 0; ch < SPECTRUM_MAX_CHANNELS; ch++)
+    {
+        nb_points[ch] = (0 != (view.channel_mask & (1 << ch))) ? view.nb_points[ch] : 0;
+        for(i = 0; i < nb_points[ch]; i++)
+        {
+            x[ch][i] = i * view.frequency_step[ch];
+            y[ch][i] = view.db[ch][i];
+        }
+        if((nb_points[ch] > 0) && (x[ch][nb_points[ch] - 1] > nyquist))
+            nyquist = x[ch][nb_points[ch] - 1];
+    }
+    worker->unlockView();
+
+    for(ch = 0; ch < SPECTRUM_MAX_CHANNELS; ch++)
+    {
+#if ( QWT_VERSION >= 0x060000)
+        curves[ch].setRawSamples(x[ch], y[ch], (int)nb_points[ch]);
+#else
+        curves[ch].setRawData(x[ch], y[ch], (int)nb_points[ch]);
+#endif
+    }
+    if((nyquist > 0.) && (nyquist != currentNyquist))
+    {
+        currentNyquist = nyquist;
+        setAxisScale(QwtPlot::xBottom, 0.0, nyquist);
+    }
+    replot();
+}
@@ -0,0 +1,77 @@
+/*****************************************************************************
+*   Copyright 2012 Vincent HERVIEUX
+*
+*   This file is part of QPicoscope.
+*
+*   QPicoscope is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU Lesser General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   any later version.
+*
+*   QPicoscope is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU Lesser General Public License for more details.
+*
+*   You should have received a copy of the GNU Lesser General Public License
+*   along with QPicoscope in files COPYING.LESSER and COPYING.
+*   If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+/**
+ * @file spectrumview.h
+ * @brief Declaration of SpectrumView class.
+ * Plot beside the screen showing the power spectrum of each channel in
+ * dBV rms, from the last view of a SpectrumWorker. Views are pulled by a
+ * timer on the GUI thread, nothing is queued by the spectrum threads.
+ * @version 0.1
+ * @date 2026, october 16
+ * @author Vincent HERVIEUX    -   10.16.2026   -   initial creation
+ */
+
+#ifndef SPECTRUMVIEW_H
+#define SPECTRUMVIEW_H
+
+#include <qwt_plot.h>
+#include <qwt_plot_curve.h>
+
+#include "oscilloscope.h"
+#include "spectrumworker.h"
+
+QT_BEGIN_NAMESPACE
+class QTimer;
+QT_END_NAMESPACE
+
+/* vertical range, 1 V rms is 0 dBV */
+#define SPECTRUM_VIEW_DB_MIN    -140.
+#define SPECTRUM_VIEW_DB_MAX    20.
+
+class SpectrumView : public QwtPlot
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @brief constructor, hidden until setActive(true)
+     * @param[in] worker: spectrum source, not owned
+     * @param[in] parent widget pointer
+     */
+    SpectrumView(SpectrumWorker *worker, QWidget *parent = 0);
+    /** @brief show the plot and pull the views while enabled, GUI thread only */
+    void setActive(bool active);
+
+private slots:
+    /** @brief render timer: draw the last view if it changed */
+    void renderView();
+
+private:
+    SpectrumWorker *worker;
+    QwtPlotCurve curves[SPECTRUM_MAX_CHANNELS];
+    /** @brief points of the curves, the view is in single precision */
+    double x[SPECTRUM_MAX_CHANNELS][SPECTRUM_VIEW_POINTS];
+    double y[SPECTRUM_MAX_CHANNELS][SPECTRUM_VIEW_POINTS];
+    QTimer *renderTimer;
+    uint64_t lastView;
+    double currentNyquist;
+};
+
+#endif // SPECTRUMVIEW_H
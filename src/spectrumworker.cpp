@@ -0,0 +1,728 @@
+/*****************************************************************************
+*   Copyright 2012 Vincent HERVIEUX
+*
+*   This file is part of QPicoscope.
+*
+*   QPicoscope is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU Lesser General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   any later version.
+*
+*   QPicoscope is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU Lesser General Public License for more details.
+*
+*   You should have received a copy of the GNU Lesser General Public License
+*   along with QPicoscope in files COPYING.LESSER and COPYING.
+*   If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+/**
+ * @file spectrumworker.cpp
+ * @brief Definition of SpectrumWorker class.
+ * @version 0.1
+ * @date 2026, october 16
+ * @author Vincent HERVIEUX    -   10.16.2026   -   initial creation
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "spectrumworker.h"
+
+/* power of an empty bin, -200 dBV */
+#define SPECTRUM_FLOOR      1E-20
+
+static const char *window_names[SpectrumWorker::E_WINDOW_MAX] = { "Hann", "Blackman-Harris", "Flat-top" };
+
+/* cosine terms of the windows, a0 - a1 cos(x) + a2 cos(2x) - a3 cos(3x) + a4 cos(4x) */
+static const double window_terms[SpectrumWorker::E_WINDOW_MAX][5] =
+{
+    { 0.5, 0.5, 0., 0., 0. },
+    { 0.35875, 0.48829, 0.14128, 0.01168, 0. },
+    { 0.21557895, 0.41663158, 0.277263158, 0.083578947, 0.006947368 }
+};
+
+/****************************************************************************
+ *
+ * constructor
+ *
+ ****************************************************************************/
+SpectrumWorker::SpectrumWorker() :
+    nb_threads_m(0),
+    producer_m(0),
+    quit_m(false),
+    window_m(E_WINDOW_HANN),
+    mode_m(E_MODE_NORMAL),
+    averages_m(1),
+    generation_m(0),
+    front_m(0),
+    front_valid_m(false),
+    view_count_m(0),
+    accumulated_generation_m(0),
+    dirty_m(false),
+    last_render_m(0),
+    pipeline_stats_m(NULL)
+{
+    pthread_condattr_t attributes;
+    uint8_t i = 0;
+
+    memset(workers_m, 0, sizeof(workers_m));
+    memset(plans_m, 0, sizeof(plans_m));
+    memset(windows_m, 0, sizeof(windows_m));
+    memset(window_sums_m, 0, sizeof(window_sums_m));
+    memset(accumulators_m, 0, sizeof(accumulators_m));
+    views_m[0] = (view_buffer_t*)calloc(1, sizeof(view_buffer_t));
+    views_m[1] = (view_buffer_t*)calloc(1, sizeof(view_buffer_t));
+    pthread_mutex_init(&lock_m, NULL);
+    pthread_mutex_init(&tables_lock_m, NULL);
+    pthread_mutex_init(&accumulate_lock_m, NULL);
+    pthread_condattr_init(&attributes);
+    pthread_condattr_setclock(&attributes, CLOCK_MONOTONIC);
+    for (i = 0; i < SPECTRUM_MAX_THREADS; i++)
+    {
+        workers_m[i].owner = this;
+        pthread_cond_init(&workers_m[i].cond, &attributes);
+    }
+    pthread_condattr_destroy(&attributes);
+}
+
+/****************************************************************************
+ *
+ * destructor
+ *
+ ****************************************************************************/
+SpectrumWorker::~SpectrumWorker()
+{
+    uint8_t i = 0;
+    uint8_t window = 0;
+
+    stop();
+    for (i = 0; i < SPECTRUM_MAX_THREADS; i++)
+    {
+        pthread_cond_destroy(&workers_m[i].cond);
+        delete workers_m[i].frames;
+        free(workers_m[i].samples);
+        free(workers_m[i].work);
+        free(workers_m[i].power);
+    }
+    for (i = 0; i <= SPECTRUM_MAX_SHIFT; i++)
+    {
+        delete plans_m[i];
+        for (window = 0; window < E_WINDOW_MAX; window++)
+            free(windows_m[window][i]);
+    }
+    for (i = 0; i < SPECTRUM_MAX_CHANNELS; i++)
+        free(accumulators_m[i].power);
+    free(views_m[0]);
+    free(views_m[1]);
+    pthread_mutex_destroy(&accumulate_lock_m);
+    pthread_mutex_destroy(&tables_lock_m);
+    pthread_mutex_destroy(&lock_m);
+}
+
+/****************************************************************************
+ * start
+ *
+ * Queues are kept once created: the acquisition thread may still be
+ * filling one when the threads are stopped.
+ ****************************************************************************/
+bool SpectrumWorker::start(uint8_t nb_threads)
+{
+    long nb_cpus = 0;
+    uint8_t i = 0;
+    int ret = 0;
+
+    if (0 != nb_threads_m)
+        return true;
+    if (0 == nb_threads)
+    {
+        /* one processor is left to the acquisition */
+        nb_cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        nb_threads = (nb_cpus > 1) ? (uint8_t)((nb_cpus - 1 < SPECTRUM_MAX_THREADS) ? nb_cpus - 1 : SPECTRUM_MAX_THREADS) : 1;
+    }
+    if (nb_threads > SPECTRUM_MAX_THREADS)
+        nb_threads = SPECTRUM_MAX_THREADS;
+
+    pthread_mutex_lock(&lock_m);
+    generation_m++;
+    pthread_mutex_unlock(&lock_m);
+
+    for (i = 0; i < nb_threads; i++)
+    {
+        if (NULL == workers_m[i].frames)
+            workers_m[i].frames = new FrameQueue(SPECTRUM_QUEUE_DEPTH, 1024);
+        /* no producer yet, leftovers of the previous run are dropped */
+        while (NULL != workers_m[i].frames->takeNext())
+            workers_m[i].frames->release();
+        workers_m[i].posted = false;
+        ret = pthread_create(&workers_m[i].thread, NULL, SpectrumWorker::threadRun, &workers_m[i]);
+        if (0 != ret)
+        {
+            ERROR("pthread_create failed and returned %d\n", ret);
+            break;
+        }
+    }
+    if (0 == i)
+        return false;
+    if (i < nb_threads)
+        WARNING("spectrum computed by %u threads only\n", i);
+    producer_m = 0;
+    ATOMIC_STORE_RELEASE(&nb_threads_m, i);
+    return true;
+}
+
+/****************************************************************************
+ * stop
+ ****************************************************************************/
+void SpectrumWorker::stop(void)
+{
+    uint8_t nb_threads = nb_threads_m;
+    uint8_t i = 0;
+
+    if (0 == nb_threads)
+        return;
+    ATOMIC_STORE_RELEASE(&nb_threads_m, 0);
+    pthread_mutex_lock(&lock_m);
+    quit_m = true;
+    for (i = 0; i < nb_threads; i++)
+        pthread_cond_signal(&workers_m[i].cond);
+    pthread_mutex_unlock(&lock_m);
+    for (i = 0; i < nb_threads; i++)
+        pthread_join(workers_m[i].thread, NULL);
+    quit_m = false;
+}
+
+/****************************************************************************
+ * setWindow
+ ****************************************************************************/
+void SpectrumWorker::setWindow(window_e window)
+{
+    if (window >= E_WINDOW_MAX)
+        return;
+    pthread_mutex_lock(&lock_m);
+    window_m = window;
+    generation_m++;
+    pthread_mutex_unlock(&lock_m);
+}
+
+/****************************************************************************
+ * setMode
+ ****************************************************************************/
+void SpectrumWorker::setMode(mode_e mode, uint32_t averages)
+{
+    pthread_mutex_lock(&lock_m);
+    mode_m = mode;
+    averages_m = (averages > 0) ? averages : 1;
+    generation_m++;
+    pthread_mutex_unlock(&lock_m);
+}
+
+/****************************************************************************
+ * clear
+ ****************************************************************************/
+void SpectrumWorker::clear(void)
+{
+    pthread_mutex_lock(&lock_m);
+    generation_m++;
+    pthread_mutex_unlock(&lock_m);
+}
+
+/****************************************************************************
+ * setChannel
+ ****************************************************************************/
+int8_t SpectrumWorker::setChannel(uint8_t channel_id, const double *x_data, const double *y_data, uint32_t nb_points)
+{
+    uint8_t nb_threads = ATOMIC_LOAD_ACQUIRE(&nb_threads_m);
+
+    if (0 == nb_threads)
+        return -1;
+    return workers_m[producer_m % nb_threads].frames->setChannel(channel_id, x_data, y_data, nb_points);
+}
+
+/****************************************************************************
+ * setRawChannel
+ ****************************************************************************/
+int8_t SpectrumWorker::setRawChannel(uint8_t channel_id, const int16_t *raw, uint32_t nb_points,
+                                     float scale, float offset, double x_origin, double x_interval)
+{
+    uint8_t nb_threads = ATOMIC_LOAD_ACQUIRE(&nb_threads_m);
+
+    if (0 == nb_threads)
+        return -1;
+    return workers_m[producer_m % nb_threads].frames->setRawChannel(channel_id, raw, nb_points,
+                                                                     scale, offset, x_origin, x_interval);
+}
+
+/****************************************************************************
+ * publish
+ *
+ * Threads take the waveforms in turn. A thread late by a whole queue
+ * loses the waveform even if another one is idle, its frame is already
+ * filled.
+ ****************************************************************************/
+bool SpectrumWorker::publish(void)
+{
+    uint8_t nb_threads = ATOMIC_LOAD_ACQUIRE(&nb_threads_m);
+    worker_t *worker = NULL;
+
+    if (0 == nb_threads)
+        return false;
+    worker = &workers_m[producer_m % nb_threads];
+    producer_m = (uint8_t)((producer_m + 1) % nb_threads);
+    if (!worker->frames->publish())
+        return false;
+    pthread_mutex_lock(&lock_m);
+    worker->posted = true;
+    pthread_cond_signal(&worker->cond);
+    pthread_mutex_unlock(&lock_m);
+    return true;
+}
+
+/****************************************************************************
+ * lockView
+ ****************************************************************************/
+bool SpectrumWorker::lockView(view_t *view)
+{
+    const view_buffer_t *front = NULL;
+    uint8_t ch = 0;
+
+    pthread_mutex_lock(&lock_m);
+    if (!front_valid_m)
+    {
+        pthread_mutex_unlock(&lock_m);
+        return false;
+    }
+    front = views_m[front_m];
+    view->channel_mask = front->channel_mask;
+    for (ch = 0; ch < SPECTRUM_MAX_CHANNELS; ch++)
+    {
+        view->nb_points[ch] = front->nb_points[ch];
+        view->frequency_step[ch] = front->frequency_step[ch];
+        view->db[ch] = front->db[ch];
+    }
+    return true;
+}
+
+/****************************************************************************
+ * unlockView
+ ****************************************************************************/
+void SpectrumWorker::unlockView(void)
+{
+    pthread_mutex_unlock(&lock_m);
+}
+
+/****************************************************************************
+ * getStats
+ ****************************************************************************/
+void SpectrumWorker::getStats(stats_t *stats) const
+{
+    FrameQueue::stats_t frame_stats;
+    uint8_t i = 0;
+
+    if (NULL == stats)
+        return;
+    memset(stats, 0, sizeof(stats_t));
+    for (i = 0; i < SPECTRUM_MAX_THREADS; i++)
+    {
+        stats->transforms += ATOMIC_LOAD_RELAXED(&workers_m[i].transforms);
+        stats->busy_ns += ATOMIC_LOAD_RELAXED(&workers_m[i].busy_ns);
+        if (NULL == workers_m[i].frames)
+            continue;
+        workers_m[i].frames->getStats(&frame_stats);
+        stats->dropped += frame_stats.dropped;
+    }
+}
+
+/****************************************************************************
+ * windowName
+ ****************************************************************************/
+const char* SpectrumWorker::windowName(window_e window)
+{
+    return (window < E_WINDOW_MAX) ? window_names[window] : "unknown";
+}
+
+/****************************************************************************
+ * threadRun
+ ****************************************************************************/
+void* SpectrumWorker::threadRun(void *arg)
+{
+    worker_t *worker = (worker_t*)arg;
+
+    worker->owner->run(worker);
+    return NULL;
+}
+
+/****************************************************************************
+ * getTables
+ *
+ * Windows are periodic, their sum gives the gain applied to a sine.
+ * Nothing is freed before the destructor, so the tables stay valid
+ * without the lock.
+ ****************************************************************************/
+bool SpectrumWorker::getTables(uint8_t shift, window_e window, const FftPlan **plan, const float **table, double *sum)
+{
+    const double *terms = window_terms[window];
+    uint32_t size = 1U << shift;
+    FftPlan *new_plan = NULL;
+    float *new_table = NULL;
+    double x = 0.;
+    double w = 0.;
+    double total = 0.;
+    uint32_t i = 0;
+
+    pthread_mutex_lock(&tables_lock_m);
+    if (NULL == plans_m[shift])
+    {
+        new_plan = new FftPlan();
+        if (!new_plan->init(size))
+        {
+            delete new_plan;
+            pthread_mutex_unlock(&tables_lock_m);
+            return false;
+        }
+        plans_m[shift] = new_plan;
+    }
+    if (NULL == windows_m[window][shift])
+    {
+        new_table = (float*)malloc(size * sizeof(float));
+        if (NULL == new_table)
+        {
+            ERROR("cannot allocate a %u points window\n", size);
+            pthread_mutex_unlock(&tables_lock_m);
+            return false;
+        }
+        for (i = 0; i < size; i++)
+        {
+            x = 2. * M_PI * i / size;
+            w = terms[0] - terms[1] * cos(x) + terms[2] * cos(2. * x) - terms[3] * cos(3. * x) + terms[4] * cos(4. * x);
+            new_table[i] = (float)w;
+            total += w;
+        }
+        windows_m[window][shift] = new_table;
+        window_sums_m[window][shift] = total;
+    }
+    *plan = plans_m[shift];
+    *table = windows_m[window][shift];
+    *sum = window_sums_m[window][shift];
+    pthread_mutex_unlock(&tables_lock_m);
+    return true;
+}
+
+/****************************************************************************
+ * transform
+ *
+ * The newest power of two samples are windowed, up to SPECTRUM_MAX_POINTS.
+ * A sine of amplitude A then gives A^2 / 2 in its bin, the rms power, for
+ * a window as flat as the flat-top one: the window sum is divided out and
+ * bins but DC and Nyquist get the power of the negative frequencies.
+ ****************************************************************************/
+bool SpectrumWorker::transform(worker_t *worker, window_e window, const FrameQueue::channel_frame_t *channel,
+                               uint32_t *bins, double *frequency_step)
+{
+    const FftPlan *plan = NULL;
+    const float *table = NULL;
+    uint32_t nb_points = channel->nb_points;
+    uint32_t first = 0;
+    uint32_t size = 0;
+    uint32_t half = 0;
+    uint32_t i = 0;
+    uint8_t shift = 0;
+    double interval = 0.;
+    double sum = 0.;
+    float norm = 0.f;
+
+    if (nb_points < FFT_PLAN_MIN_SIZE)
+        return false;
+    interval = channel->is_raw ? channel->x_interval
+                               : (channel->x[nb_points - 1] - channel->x[0]) / (nb_points - 1);
+    if (!(interval > 0.))
+        return false;
+    while ((shift < SPECTRUM_MAX_SHIFT) && ((2U << shift) <= nb_points))
+        shift++;
+    size = 1U << shift;
+    half = size / 2;
+    first = nb_points - size;
+    if (!getTables(shift, window, &plan, &table, &sum))
+        return false;
+
+    if (size > worker->capacity)
+    {
+        free(worker->samples);
+        free(worker->work);
+        free(worker->power);
+        worker->samples = (float*)malloc(size * sizeof(float));
+        worker->work = (float*)malloc(size * sizeof(float));
+        worker->power = (float*)malloc((half + 1) * sizeof(float));
+        worker->capacity = size;
+        if ((NULL == worker->samples) || (NULL == worker->work) || (NULL == worker->power))
+        {
+            ERROR("cannot allocate a %u points spectrum\n", size);
+            worker->capacity = 0;
+            return false;
+        }
+    }
+
+    if (channel->is_raw)
+    {
+        for (i = 0; i < size; i++)
+            worker->samples[i] = (channel->raw[first + i] * channel->scale + channel->offset) * table[i];
+    }
+    else
+    {
+        for (i = 0; i < size; i++)
+            worker->samples[i] = (float)channel->y[first + i] * table[i];
+    }
+    plan->power(worker->samples, worker->work, worker->power);
+
+    norm = (float)(1. / (sum * sum));
+    worker->power[0] *= norm;
+    worker->power[half] *= norm;
+    norm *= 2.f;
+    for (i = 1; i < half; i++)
+        worker->power[i] *= norm;
+    *bins = half + 1;
+    *frequency_step = 1. / (size * interval);
+    return true;
+}
+
+/****************************************************************************
+ * accumulate
+ *
+ * Threads finish out of order: the spectrum of E_MODE_NORMAL may be one
+ * of the last waveforms of each thread rather than the very last one.
+ * Past averages waveforms, the average becomes an exponential one with
+ * the same weight for the newest.
+ ****************************************************************************/
+void SpectrumWorker::accumulate(uint8_t ch, const float *power, uint32_t bins, double frequency_step,
+                                mode_e mode, uint32_t averages, uint32_t generation)
+{
+    accumulator_t *accumulator = &accumulators_m[ch];
+    double *grown = NULL;
+    double weight = 0.;
+    uint32_t i = 0;
+    uint8_t channel = 0;
+
+    pthread_mutex_lock(&accumulate_lock_m);
+    if ((int32_t)(generation - accumulated_generation_m) < 0)
+    {
+        /* computed with settings changed since */
+        pthread_mutex_unlock(&accumulate_lock_m);
+        return;
+    }
+    if (generation != accumulated_generation_m)
+    {
+        for (channel = 0; channel < SPECTRUM_MAX_CHANNELS; channel++)
+            accumulators_m[channel].count = 0;
+        accumulated_generation_m = generation;
+    }
+    if ((bins != accumulator->bins) || (frequency_step != accumulator->frequency_step))
+    {
+        if (bins > accumulator->capacity)
+        {
+            grown = (double*)realloc(accumulator->power, bins * sizeof(double));
+            if (NULL == grown)
+            {
+                ERROR("cannot allocate a %u bins spectrum\n", bins);
+                pthread_mutex_unlock(&accumulate_lock_m);
+                return;
+            }
+            accumulator->power = grown;
+            accumulator->capacity = bins;
+        }
+        accumulator->bins = bins;
+        accumulator->frequency_step = frequency_step;
+        accumulator->count = 0;
+    }
+
+    accumulator->count++;
+    if ((E_MODE_NORMAL == mode) || (1 == accumulator->count))
+    {
+        for (i = 0; i < bins; i++)
+            accumulator->power[i] = power[i];
+    }
+    else if (E_MODE_AVERAGE == mode)
+    {
+        weight = 1. / ((accumulator->count < averages) ? accumulator->count : averages);
+        for (i = 0; i < bins; i++)
+            accumulator->power[i] += (power[i] - accumulator->power[i]) * weight;
+    }
+    else
+    {
+        for (i = 0; i < bins; i++)
+        {
+            if (power[i] > accumulator->power[i])
+                accumulator->power[i] = power[i];
+        }
+    }
+    dirty_m = true;
+    pthread_mutex_unlock(&accumulate_lock_m);
+}
+
+/****************************************************************************
+ * renderView
+ *
+ * When there are more bins than points, a point is the highest of its
+ * bins so that no line is hidden.
+ ****************************************************************************/
+void SpectrumWorker::renderView(void)
+{
+    view_buffer_t *back = views_m[1 - front_m];
+    const accumulator_t *accumulator = NULL;
+    uint32_t group = 0;
+    uint32_t points = 0;
+    uint32_t point = 0;
+    uint32_t first = 0;
+    uint32_t last = 0;
+    uint32_t i = 0;
+    double highest = 0.;
+    uint8_t ch = 0;
+
+    if (NULL == back)
+        return;
+    /* only the thread holding accumulate_lock_m touches the back view */
+    back->channel_mask = 0;
+    for (ch = 0; ch < SPECTRUM_MAX_CHANNELS; ch++)
+    {
+        accumulator = &accumulators_m[ch];
+        back->nb_points[ch] = 0;
+        if (0 == accumulator->count)
+            continue;
+        group = (accumulator->bins + SPECTRUM_VIEW_POINTS - 1) / SPECTRUM_VIEW_POINTS;
+        points = (accumulator->bins + group - 1) / group;
+        for (point = 0; point < points; point++)
+        {
+            first = point * group;
+            last = (first + group < accumulator->bins) ? first + group : accumulator->bins;
+            highest = SPECTRUM_FLOOR;
+            for (i = first; i < last; i++)
+            {
+                if (accumulator->power[i] > highest)
+                    highest = accumulator->power[i];
+            }
+            back->db[ch][point] = (float)(10. * log10(highest));
+        }
+        back->nb_points[ch] = points;
+        back->frequency_step[ch] = accumulator->frequency_step * group;
+        back->channel_mask |= (uint8_t)(1 << ch);
+    }
+
+    pthread_mutex_lock(&lock_m);
+    front_m = 1 - front_m;
+    front_valid_m = true;
+    ATOMIC_STORE_RELAXED(&view_count_m, view_count_m + 1);
+    pthread_mutex_unlock(&lock_m);
+}
+
+/****************************************************************************
+ * flush
+ ****************************************************************************/
+bool SpectrumWorker::flush(void)
+{
+    uint64_t period = (uint64_t)(1E9 / SPECTRUM_RENDER_RATE);
+    uint64_t now = PipelineStats::now_ns();
+    bool pending = false;
+
+    pthread_mutex_lock(&accumulate_lock_m);
+    if (dirty_m && (now - last_render_m >= period))
+    {
+        renderView();
+        last_render_m = now;
+        dirty_m = false;
+    }
+    pending = dirty_m;
+    pthread_mutex_unlock(&accumulate_lock_m);
+    return pending;
+}
+
+/****************************************************************************
+ * drain
+ ****************************************************************************/
+void SpectrumWorker::drain(worker_t *worker)
+{
+    const FrameQueue::frame_t *frame = NULL;
+    PipelineStats *stats = NULL;
+    window_e window = E_WINDOW_HANN;
+    mode_e mode = E_MODE_NORMAL;
+    uint32_t averages = 1;
+    uint32_t generation = 0;
+    uint32_t bins = 0;
+    double frequency_step = 0.;
+    uint64_t start = 0;
+    uint64_t duration = 0;
+    uint8_t ch = 0;
+
+    while (NULL != (frame = worker->frames->takeNext()))
+    {
+        start = PipelineStats::now_ns();
+        pthread_mutex_lock(&lock_m);
+        window = window_m;
+        mode = mode_m;
+        averages = averages_m;
+        generation = generation_m;
+        pthread_mutex_unlock(&lock_m);
+
+        for (ch = 0; ch < SPECTRUM_MAX_CHANNELS; ch++)
+        {
+            if (0 == (frame->channel_mask & (1 << ch)))
+                continue;
+            if (!transform(worker, window, &frame->channels[ch], &bins, &frequency_step))
+                continue;
+            accumulate(ch, worker->power, bins, frequency_step, mode, averages, generation);
+            ATOMIC_STORE_RELAXED(&worker->transforms, worker->transforms + 1);
+        }
+        worker->frames->release();
+        duration = PipelineStats::now_ns() - start;
+        ATOMIC_STORE_RELAXED(&worker->busy_ns, worker->busy_ns + duration);
+        stats = ATOMIC_LOAD_ACQUIRE(&pipeline_stats_m);
+        if (NULL != stats)
+            stats->record_duration(PipelineStats::E_STAGE_SPECTRUM, duration);
+        flush();
+    }
+}
+
+/****************************************************************************
+ * run
+ *
+ * A thread sleeps until its queue gets a frame, or until the next view
+ * while the spectrum changed since the last one.
+ ****************************************************************************/
+void SpectrumWorker::run(worker_t *worker)
+{
+    struct timespec deadline;
+    uint64_t period = (uint64_t)(1E9 / SPECTRUM_RENDER_RATE);
+    bool pending = false;
+
+    pthread_mutex_lock(&lock_m);
+    while (!quit_m)
+    {
+        worker->posted = false;
+        pthread_mutex_unlock(&lock_m);
+
+        drain(worker);
+        pending = flush();
+
+        pthread_mutex_lock(&lock_m);
+        if (quit_m || worker->posted)
+            continue;
+        if (pending)
+        {
+            clock_gettime(CLOCK_MONOTONIC, &deadline);
+            deadline.tv_nsec += (long)period;
+            if (deadline.tv_nsec >= 1000000000L)
+            {
+                deadline.tv_sec += 1;
+                deadline.tv_nsec -= 1000000000L;
+            }
+            pthread_cond_timedwait(&worker->cond, &lock_m, &deadline);
+        }
+        else
+        {
+            pthread_cond_wait(&worker->cond, &lock_m);
+        }
+    }
+    pthread_mutex_unlock(&lock_m);
+}
@@ -0,0 +1,250 @@
+/*****************************************************************************
+*   Copyright 2012 Vincent HERVIEUX
+*
+*   This file is part of QPicoscope.
+*
+*   QPicoscope is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU Lesser General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   any later version.
+*
+*   QPicoscope is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU Lesser General Public License for more details.
+*
+*   You should have received a copy of the GNU Lesser General Public License
+*   along with QPicoscope in files COPYING.LESSER and COPYING.
+*   If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+/**
+ * @file spectrumworker.h
+ * @brief Declaration of SpectrumWorker class.
+ * Power spectrum of every acquired waveform, computed on a pool of
+ * threads apart from the acquisition and GUI threads. The acquisition
+ * thread copies its blocks in the FrameQueue of each thread in turn, each
+ * thread windows the newest power of two samples of every channel, takes
+ * their FFT and adds it to the spectrum shared by the pool: the last one,
+ * a power average or the max hold. FFT plans and window tables are kept
+ * per size, the spectrum is drawn into a view of at most
+ * SPECTRUM_VIEW_POINTS per channel SPECTRUM_RENDER_RATE times per second,
+ * swapped with the one the GUI thread draws.
+ * @version 0.1
+ * @date 2026, october 16
+ * @author Vincent HERVIEUX    -   10.16.2026   -   initial creation
+ */
+
+#ifndef SPECTRUMWORKER_H
+#define SPECTRUMWORKER_H
+
+#include <pthread.h>
+
+#include "oscilloscope.h"
+#include "atomic-ops.h"
+#include "fftplan.h"
+#include "framequeue.h"
+#include "pipelinestats.h"
+
+#define SPECTRUM_MAX_THREADS        8
+/* blocks the acquisition may be ahead of each thread */
+#define SPECTRUM_QUEUE_DEPTH        4
+/* longer records are transformed on their newest samples only */
+#define SPECTRUM_MAX_SHIFT          20
+#define SPECTRUM_MAX_POINTS         (1U << SPECTRUM_MAX_SHIFT)
+#define SPECTRUM_VIEW_POINTS        2048
+#define SPECTRUM_RENDER_RATE        30.
+#define SPECTRUM_MAX_CHANNELS       FRAME_QUEUE_MAX_CHANNELS
+
+class SpectrumWorker
+{
+public:
+    /**
+     * @brief public typedef declarations
+     */
+    typedef enum
+    {
+        E_WINDOW_HANN = 0,
+        E_WINDOW_BLACKMAN_HARRIS,
+        /** @brief flat top, for amplitudes between two bins */
+        E_WINDOW_FLAT_TOP,
+        E_WINDOW_MAX
+    } window_e;
+
+    typedef enum
+    {
+        /** @brief spectrum of the last waveform */
+        E_MODE_NORMAL = 0,
+        /** @brief mean power of the last waveforms */
+        E_MODE_AVERAGE,
+        /** @brief highest power since cleared */
+        E_MODE_MAX_HOLD
+    } mode_e;
+
+    typedef struct
+    {
+        /** @brief bit n is set when channel n+1 has a spectrum */
+        uint8_t channel_mask;
+        uint32_t nb_points[SPECTRUM_MAX_CHANNELS];
+        /** @brief Hz between two points, point i is at i * frequency_step */
+        double frequency_step[SPECTRUM_MAX_CHANNELS];
+        /** @brief power in dBV rms, the highest of the bins a point covers */
+        const float *db[SPECTRUM_MAX_CHANNELS];
+    } view_t;
+
+    typedef struct
+    {
+        /** @brief channel spectra computed */
+        uint64_t transforms;
+        /** @brief waveforms lost because every thread was late */
+        uint64_t dropped;
+        /** @brief time spent computing them, all threads, in ns */
+        uint64_t busy_ns;
+    } stats_t;
+
+    /** @brief constructor, no thread is started */
+    SpectrumWorker();
+    /** @brief destructor, stops the threads */
+    ~SpectrumWorker();
+
+    /**
+     * @brief start the threads, waveforms published before are discarded
+     * @param[in] nb_threads: up to SPECTRUM_MAX_THREADS, 0 for one less than the processors
+     */
+    bool start(uint8_t nb_threads = 0);
+    /** @brief stop the threads, the last view stays available */
+    void stop(void);
+    bool isRunning(void) const { return 0 != nb_threads_m; }
+    uint8_t getThreads(void) const { return nb_threads_m; }
+
+    /** @brief window applied before the FFT, the spectrum is cleared */
+    void setWindow(window_e window);
+    /**
+     * @brief how waveforms are combined, the spectrum is cleared
+     * @param[in] averages: waveforms in the average for E_MODE_AVERAGE, unused otherwise
+     */
+    void setMode(mode_e mode, uint32_t averages);
+    /** @brief forget every waveform */
+    void clear(void);
+    /** @brief where the time spent per transform is recorded, may be NULL */
+    void setPipelineStats(PipelineStats *stats) { ATOMIC_STORE_RELEASE(&pipeline_stats_m, stats); }
+
+    /**
+     * @brief producer side, same as FrameQueue::setChannel()
+     * Acquisition thread, like DrawData::setData().
+     */
+    int8_t setChannel(uint8_t channel_id, const double *x_data, const double *y_data, uint32_t nb_points);
+    /** @brief producer side, same as FrameQueue::setRawChannel() */
+    int8_t setRawChannel(uint8_t channel_id, const int16_t *raw, uint32_t nb_points,
+                         float scale, float offset, double x_origin, double x_interval);
+    /** @brief producer side: hand the waveform over to the next thread */
+    bool publish(void);
+
+    /**
+     * @brief the last rendered view, to be given back by unlockView() at once
+     * @return false if none, unlockView() must not be called then
+     */
+    bool lockView(view_t *view);
+    void unlockView(void);
+    /** @brief views rendered so far, a change means the spectrum must be drawn again */
+    uint64_t viewCount(void) const { return ATOMIC_LOAD_RELAXED(&view_count_m); }
+
+    /** @brief read the counters, any thread */
+    void getStats(stats_t *stats) const;
+
+    /** @brief name of a window, for the front panel */
+    static const char* windowName(window_e window);
+
+private:
+    SpectrumWorker(const SpectrumWorker&);
+    SpectrumWorker& operator=(const SpectrumWorker&);
+    /** @brief one thread of the pool and what only it touches */
+    typedef struct
+    {
+        SpectrumWorker *owner;
+        pthread_t thread;
+        FrameQueue *frames;
+        pthread_cond_t cond;
+        /* protected by lock_m */
+        bool posted;
+        /* scratch of the transforms */
+        float *samples;
+        float *work;
+        float *power;
+        uint32_t capacity;
+        /* written by the thread only */
+        uint64_t transforms;
+        uint64_t busy_ns;
+    } worker_t;
+    /** @brief spectrum of one channel, protected by accumulate_lock_m */
+    typedef struct
+    {
+        double *power;
+        uint32_t bins;
+        uint32_t capacity;
+        double frequency_step;
+        uint64_t count;
+    } accumulator_t;
+    typedef struct
+    {
+        uint8_t channel_mask;
+        uint32_t nb_points[SPECTRUM_MAX_CHANNELS];
+        double frequency_step[SPECTRUM_MAX_CHANNELS];
+        float db[SPECTRUM_MAX_CHANNELS][SPECTRUM_VIEW_POINTS];
+    } view_buffer_t;
+
+    static void* threadRun(void *arg);
+    void run(worker_t *worker);
+    /** @brief transform every pending frame of a thread */
+    void drain(worker_t *worker);
+    /**
+     * @brief power spectrum of one channel in the scratch of a thread, in V^2 rms per bin
+     * @return false if the channel is too short or memory is exhausted
+     */
+    bool transform(worker_t *worker, window_e window, const FrameQueue::channel_frame_t *channel,
+                   uint32_t *bins, double *frequency_step);
+    /** @brief add a channel spectrum to its accumulator, unless settings changed since */
+    void accumulate(uint8_t ch, const float *power, uint32_t bins, double frequency_step,
+                    mode_e mode, uint32_t averages, uint32_t generation);
+    /** @brief render if the accumulators changed and the last view is old enough, true if still pending */
+    bool flush(void);
+    /** @brief plan and window of a size, computed the first time, false if out of memory */
+    bool getTables(uint8_t shift, window_e window, const FftPlan **plan, const float **table, double *sum);
+    /** @brief draw the accumulators into the back view and swap it, accumulate_lock_m held */
+    void renderView(void);
+
+    worker_t workers_m[SPECTRUM_MAX_THREADS];
+    uint8_t nb_threads_m;
+    /** @brief thread the acquisition fills the frame of, producer side */
+    uint8_t producer_m;
+
+    pthread_mutex_t lock_m;
+    /* protected by lock_m */
+    bool quit_m;
+    window_e window_m;
+    mode_e mode_m;
+    uint32_t averages_m;
+    /** @brief changed by every setting, older transforms are discarded */
+    uint32_t generation_m;
+    /* front is drawn by the GUI thread, back by the pool */
+    view_buffer_t *views_m[2];
+    uint8_t front_m;
+    bool front_valid_m;
+    uint64_t view_count_m;
+
+    /** @brief plans and windows, built once per size and kept */
+    pthread_mutex_t tables_lock_m;
+    FftPlan *plans_m[SPECTRUM_MAX_SHIFT + 1];
+    float *windows_m[E_WINDOW_MAX][SPECTRUM_MAX_SHIFT + 1];
+    double window_sums_m[E_WINDOW_MAX][SPECTRUM_MAX_SHIFT + 1];
+
+    pthread_mutex_t accumulate_lock_m;
+    /* protected by accumulate_lock_m */
+    accumulator_t accumulators_m[SPECTRUM_MAX_CHANNELS];
+    uint32_t accumulated_generation_m;
+    bool dirty_m;
+    uint64_t last_render_m;
+
+    PipelineStats *pipeline_stats_m;
+};
+
+#endif // SPECTRUMWORKER_H
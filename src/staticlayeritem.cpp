@@ -0,0 +1,115 @@
+/*****************************************************************************
+*   Copyright 2012 Vincent HERVIEUX
+*
+*   This file is part of QPicoscope.
+*
+*   QPicoscope is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU Lesser General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   any later version.
+*
+*   QPicoscope is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU Lesser General Public License for more details.
+*
+*   You should have received a copy of the GNU Lesser General Public License
+*   along with QPicoscope in files COPYING.LESSER and COPYING.
+*   If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+/**
+ * @file staticlayeritem.cpp
+ * @brief Definition of StaticLayerItem class.
+ * @version 0.1
+ * @date 2026, october 16
+ * @author Vincent HERVIEUX    -   10.16.2026   -   initial creation
+ */
+
+#include <QPainter>
+
+#include <qwt_scale_map.h>
+
+#include "staticlayeritem.h"
+
+StaticLayerItem::StaticLayerItem()
+    : background(Qt::black),
+      cacheValid(false)
+{
+    for(int i = 0; i < 4; i++)
+        xBounds[i] = yBounds[i] = 0.;
+    setZ(gridItem.z() - 1);
+}
+
+void StaticLayerItem::setBackground(const QBrush &brush)
+{
+    background = brush;
+    invalidate();
+}
+
+int StaticLayerItem::rtti() const
+{
+    return QwtPlotItem::Rtti_PlotUserItem + 1;
+}
+
+/**
+ * Called on every replot by updateAxes(): only a change of the ticks
+ * invalidates the pixmap.
+ */
+void StaticLayerItem::updateScaleDiv(const QwtScaleDiv &xScaleDiv, const QwtScaleDiv &yScaleDiv)
+{
+    if((xScaleDiv == xDiv) && (yScaleDiv == yDiv))
+        return;
+    xDiv = xScaleDiv;
+    yDiv = yScaleDiv;
+    gridItem.updateScaleDiv(xScaleDiv, yScaleDiv);
+    invalidate();
+}
+
+bool StaticLayerItem::isCached(const QwtScaleMap &xMap, const QwtScaleMap &yMap, const QRect &rect) const
+{
+    return cacheValid && (rect == cacheRect) &&
+           (xMap.s1() == xBounds[0]) && (xMap.s2() == xBounds[1]) &&
+           (xMap.p1() == xBounds[2]) && (xMap.p2() == xBounds[3]) &&
+           (yMap.s1() == yBounds[0]) && (yMap.s2() == yBounds[1]) &&
+           (yMap.p1() == yBounds[2]) && (yMap.p2() == yBounds[3]);
+}
+
+#if ( QWT_VERSION >= 0x060000)
+void StaticLayerItem::draw(QPainter *painter, const QwtScaleMap &xMap, const QwtScaleMap &yMap,
+                           const QRectF &canvasRect) const
+#else
+void StaticLayerItem::draw(QPainter *painter, const QwtScaleMap &xMap, const QwtScaleMap &yMap,
+                           const QRect &canvasRect) const
+#endif
+{
+#if ( QWT_VERSION >= 0x060000)
+    QRect rect = canvasRect.toAlignedRect();
+#else
+    QRect rect = canvasRect;
+#endif
+
+    if(rect.isEmpty())
+        return;
+    if(!isCached(xMap, yMap, rect))
+    {
+        cache = QPixmap(rect.size());
+        QPainter cachePainter(&cache);
+        // the gradient is stretched to the pixmap, as it was to the canvas
+        cachePainter.fillRect(cache.rect(), background);
+        cachePainter.translate(-rect.topLeft());
+        gridItem.draw(&cachePainter, xMap, yMap, canvasRect);
+        cachePainter.end();
+
+        cacheRect = rect;
+        xBounds[0] = xMap.s1();
+        xBounds[1] = xMap.s2();
+        xBounds[2] = xMap.p1();
+        xBounds[3] = xMap.p2();
+        yBounds[0] = yMap.s1();
+        yBounds[1] = yMap.s2();
+        yBounds[2] = yMap.p1();
+        yBounds[3] = yMap.p2();
+        cacheValid = true;
+    }
+    painter->drawPixmap(rect.topLeft(), cache);
+}
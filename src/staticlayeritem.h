@@ -0,0 +1,81 @@
+/*****************************************************************************
+*   Copyright 2012 Vincent HERVIEUX
+*
+*   This file is part of QPicoscope.
+*
+*   QPicoscope is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU Lesser General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   any later version.
+*
+*   QPicoscope is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU Lesser General Public License for more details.
+*
+*   You should have received a copy of the GNU Lesser General Public License
+*   along with QPicoscope in files COPYING.LESSER and COPYING.
+*   If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+/**
+ * @file staticlayeritem.h
+ * @brief Declaration of StaticLayerItem class.
+ * Canvas background and grid, drawn once into a pixmap and copied by every
+ * replot. The pixmap is drawn again only when the canvas size or a scale
+ * changes, each frame then costs a blit under the curves.
+ * @version 0.1
+ * @date 2026, october 16
+ * @author Vincent HERVIEUX    -   10.16.2026   -   initial creation
+ */
+
+#ifndef STATICLAYERITEM_H
+#define STATICLAYERITEM_H
+
+#include <QBrush>
+#include <QPixmap>
+
+#include <qwt_global.h>
+#include <qwt_plot_item.h>
+#include <qwt_plot_grid.h>
+#include <qwt_scale_div.h>
+
+class StaticLayerItem : public QwtPlotItem
+{
+public:
+    /** @brief constructor, below every other item */
+    StaticLayerItem();
+
+    /** @brief grid drawn over the background, configure it as a QwtPlotGrid */
+    QwtPlotGrid& grid() { return gridItem; }
+    /** @brief background of the canvas, gradients are stretched to the canvas */
+    void setBackground(const QBrush &brush);
+    /** @brief draw the pixmap again at the next replot */
+    void invalidate() { cacheValid = false; }
+
+    virtual int rtti() const;
+    virtual void updateScaleDiv(const QwtScaleDiv &xScaleDiv, const QwtScaleDiv &yScaleDiv);
+#if ( QWT_VERSION >= 0x060000)
+    virtual void draw(QPainter *painter, const QwtScaleMap &xMap, const QwtScaleMap &yMap,
+                      const QRectF &canvasRect) const;
+#else
+    virtual void draw(QPainter *painter, const QwtScaleMap &xMap, const QwtScaleMap &yMap,
+                      const QRect &canvasRect) const;
+#endif
+
+private:
+    /** @brief true if the pixmap was drawn for these maps and this rectangle */
+    bool isCached(const QwtScaleMap &xMap, const QwtScaleMap &yMap, const QRect &rect) const;
+
+    QwtPlotGrid gridItem;
+    QBrush background;
+    QwtScaleDiv xDiv;
+    QwtScaleDiv yDiv;
+    /* drawn on the first replot after a change */
+    mutable QPixmap cache;
+    mutable bool cacheValid;
+    mutable QRect cacheRect;
+    mutable double xBounds[4];
+    mutable double yBounds[4];
+};
+
+#endif // STATICLAYERITEM_H
@@ -0,0 +1,312 @@
+/*****************************************************************************
+*   Copyright 2012 Vincent HERVIEUX
+*
+*   This file is part of QPicoscope.
+*
+*   QPicoscope is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU Lesser General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   any later version.
+*
+*   QPicoscope is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU Lesser General Public License for more details.
+*
+*   You should have received a copy of the GNU Lesser General Public License
+*   along with QPicoscope in files COPYING.LESSER and COPYING.
+*   If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+/**
+ * @file streamdisplay.cpp
+ * @brief Definition of StreamDisplay class.
+ * @version 0.1
+ * @date 2026, october 16
+ * @author Vincent HERVIEUX    -   10.16.2026   -   initial creation
+ */
+
+#include <string.h>
+
+#include "streamdisplay.h"
+
+/****************************************************************************
+ *
+ * constructor
+ *
+ ****************************************************************************/
+StreamDisplay::StreamDisplay() :
+    draw_m(NULL),
+    window_m(0.),
+    nb_points_m(0),
+    index_m(0),
+    period_m(1),
+    pending_m(0),
+    stream_m(NULL),
+    trigger_source_m(0),
+    pre_trigger_m(STREAM_DISPLAY_PRE_TRIGGER),
+    triggered_m(false),
+    pre_points_m(0),
+    post_points_m(0),
+    capturing_m(false),
+    trigger_position_m(0),
+    gap_position_m(0)
+{
+    memset(&format_m, 0, sizeof(format_m));
+    memset(sweep_m, 0, sizeof(sweep_m));
+}
+
+/****************************************************************************
+ *
+ * destructor
+ *
+ ****************************************************************************/
+StreamDisplay::~StreamDisplay()
+{
+}
+
+/****************************************************************************
+ * set_trigger
+ ****************************************************************************/
+void StreamDisplay::set_trigger(const StreamTrigger::config_t &config, uint8_t source, double pre_trigger)
+{
+    trigger_m.set_config(config);
+    trigger_source_m = source;
+    pre_trigger_m = (pre_trigger < 0.) ? 0. : (pre_trigger > 1.) ? 1. : pre_trigger;
+}
+
+/****************************************************************************
+ * sweep_points
+ ****************************************************************************/
+uint32_t StreamDisplay::sweep_points(const stream_format_t &format) const
+{
+    double nb_points = STREAM_DISPLAY_MAX_POINTS;
+
+    if (format.sample_interval > 0.)
+        nb_points = window_m / format.sample_interval;
+    if (nb_points > STREAM_DISPLAY_MAX_POINTS)
+        nb_points = STREAM_DISPLAY_MAX_POINTS;
+    if (nb_points < 1.)
+        nb_points = 1.;
+    return (uint32_t)nb_points;
+}
+
+/****************************************************************************
+ * stream_history
+ *
+ * A triggered sweep is published once its last sample arrives, the ring
+ * keeps the whole sweep before it.
+ ****************************************************************************/
+uint32_t StreamDisplay::stream_history(const stream_format_t &format)
+{
+    if ((NULL == stream_m) || (StreamTrigger::E_TYPE_NONE == trigger_m.get_config().type))
+        return 0;
+    return sweep_points(format);
+}
+
+/****************************************************************************
+ * stream_start
+ ****************************************************************************/
+void StreamDisplay::stream_start(const stream_format_t &format)
+{
+    uint32_t nb_points = sweep_points(format);
+    double period = 1.;
+    uint8_t ch = 0;
+
+    format_m = format;
+    index_m = 0;
+    pending_m = 0;
+    nb_points_m = 0;
+    triggered_m = false;
+    capturing_m = false;
+    gap_position_m = 0;
+    memset(sweep_m, 0, sizeof(sweep_m));
+
+    if (format.sample_interval > 0.)
+        period = STREAM_DISPLAY_PERIOD / format.sample_interval;
+    period_m = (period < 1.) ? 1 : (uint32_t)period;
+
+    /* triggered sweeps only copy there when they wrap in the ring */
+    if (!arena_m.reserve(format.nb_channels * SampleArena::aligned_size((size_t)nb_points * sizeof(int16_t))))
+        return;
+    for (ch = 0; ch < format.nb_channels; ch++)
+        sweep_m[ch] = (int16_t*)arena_m.allocate((size_t)nb_points * sizeof(int16_t));
+    nb_points_m = nb_points;
+
+    if ((NULL != stream_m) && (trigger_source_m < format.nb_channels) && (format.channel_mask & (1 << trigger_source_m)))
+    {
+        triggered_m = trigger_m.start(format.scale[trigger_source_m], format.offset[trigger_source_m], format.sample_interval);
+        pre_points_m = (uint32_t)(nb_points_m * pre_trigger_m);
+        post_points_m = nb_points_m - pre_points_m;
+    }
+    DEBUG("sweep of %u samples, %s\n", nb_points_m, triggered_m ? "triggered" : "free running");
+}
+
+/****************************************************************************
+ * stream_data
+ ****************************************************************************/
+void StreamDisplay::stream_data(const int16_t *const *channels, uint32_t count, uint64_t dropped)
+{
+    uint32_t copied = 0;
+    uint32_t done = 0;
+    uint8_t ch = 0;
+
+    if ((NULL == draw_m) || (0 == nb_points_m))
+        return;
+    if (triggered_m)
+    {
+        trigger_data(channels, count, dropped);
+        return;
+    }
+
+    /* never stitch samples across a gap, the sweep starts over */
+    if ((0 != dropped) && (0 != index_m))
+    {
+        if (0 != pending_m)
+            publish();
+        index_m = 0;
+    }
+    while (done < count)
+    {
+        copied = nb_points_m - index_m;
+        if (copied > count - done)
+            copied = count - done;
+        for (ch = 0; ch < format_m.nb_channels; ch++)
+            memcpy(sweep_m[ch] + index_m, channels[ch] + done, copied * sizeof(int16_t));
+        done += copied;
+        index_m += copied;
+        pending_m += copied;
+        if ((index_m >= nb_points_m) || (pending_m >= period_m))
+            publish();
+        if (index_m >= nb_points_m)
+            index_m = 0;
+    }
+}
+
+/****************************************************************************
+ * stream_stop
+ ****************************************************************************/
+void StreamDisplay::stream_stop(void)
+{
+    if ((NULL != draw_m) && (0 != pending_m))
+        publish();
+}
+
+/****************************************************************************
+ * trigger_data
+ *
+ * The search is not run over a sweep being captured, it starts again
+ * after it as after a gap.
+ ****************************************************************************/
+void StreamDisplay::trigger_data(const int16_t *const *channels, uint32_t count, uint64_t dropped)
+{
+    uint64_t position = stream_m->get_read_position();
+    uint64_t end = 0;
+    uint32_t done = 0;
+    uint32_t found = 0;
+
+    /* never stitch samples across a gap, a sweep waiting for samples is lost */
+    if (0 != dropped)
+    {
+        capturing_m = false;
+        gap_position_m = position;
+        trigger_m.rearm();
+    }
+    for (;;)
+    {
+        if (capturing_m)
+        {
+            end = trigger_position_m + post_points_m;
+            if (end > position + count)
+                return;
+            publish_triggered();
+            capturing_m = false;
+            trigger_m.rearm();
+            done = (end > position) ? (uint32_t)(end - position) : 0;
+        }
+        if ((done >= count) || !trigger_m.search(channels[trigger_source_m] + done, count - done, &found))
+            return;
+        trigger_position_m = position + done + found;
+        capturing_m = true;
+        done += found + 1;
+    }
+}
+
+/****************************************************************************
+ * publish_triggered
+ *
+ * The sweep is given from the ring when it is contiguous there, copied
+ * when it wraps at the end of the tables. Its origin puts the trigger
+ * point pre_points_m samples from the left, to a fraction of a sample
+ * when the trigger fired on a crossing.
+ ****************************************************************************/
+void StreamDisplay::publish_triggered(void)
+{
+    const int16_t *first[STREAM_MAX_CHANNELS] = {NULL};
+    const int16_t *second[STREAM_MAX_CHANNELS] = {NULL};
+    const int16_t *tables[STREAM_MAX_CHANNELS] = {NULL};
+    uint64_t start = (trigger_position_m > pre_points_m) ? trigger_position_m - pre_points_m : 0;
+    uint32_t nb_points = 0;
+    uint32_t contiguous = 0;
+    double position = 0.;
+    int32_t level = 0;
+    bool rising = false;
+    uint8_t ch = 0;
+
+    if (start < gap_position_m)
+        start = gap_position_m;
+    nb_points = (uint32_t)(trigger_position_m + post_points_m - start);
+    contiguous = stream_m->peek(start, first);
+    if (0 == contiguous)
+        return;
+    for (ch = 0; ch < format_m.nb_channels; ch++)
+        tables[ch] = first[ch];
+    if (contiguous < nb_points)
+    {
+        if (stream_m->peek(start + contiguous, second) < nb_points - contiguous)
+            return;
+        for (ch = 0; ch < format_m.nb_channels; ch++)
+        {
+            if (!(format_m.channel_mask & (1 << ch)))
+                continue;
+            memcpy(sweep_m[ch], first[ch], contiguous * sizeof(int16_t));
+            memcpy(sweep_m[ch] + contiguous, second[ch], (nb_points - contiguous) * sizeof(int16_t));
+            tables[ch] = sweep_m[ch];
+        }
+    }
+
+    position = (double)(trigger_position_m - start);
+    if (trigger_m.get_crossing(&level, &rising))
+        interpolator_m.crossing(tables[trigger_source_m], nb_points, (uint32_t)(trigger_position_m - start),
+                                level, rising, &position);
+    for (ch = 0; ch < format_m.nb_channels; ch++)
+    {
+        if (format_m.channel_mask & (1 << ch))
+        {
+            draw_m->setRawData(ch + 1, tables[ch], nb_points, format_m.scale[ch], format_m.offset[ch],
+                               ((double)pre_points_m - position) * format_m.sample_interval,
+                               format_m.sample_interval, false);
+        }
+    }
+    draw_m->publishData();
+}
+
+/****************************************************************************
+ * publish
+ ****************************************************************************/
+void StreamDisplay::publish(void)
+{
+    /* the sweep goes on from the samples published before */
+    bool append = (index_m > pending_m);
+    uint8_t ch = 0;
+
+    for (ch = 0; ch < format_m.nb_channels; ch++)
+    {
+        if (format_m.channel_mask & (1 << ch))
+        {
+            draw_m->setRawData(ch + 1, sweep_m[ch], index_m, format_m.scale[ch], format_m.offset[ch],
+                               0., format_m.sample_interval, append);
+        }
+    }
+    draw_m->publishData();
+    pending_m = 0;
+}
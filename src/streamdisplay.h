@@ -0,0 +1,132 @@
+/*****************************************************************************
+*   Copyright 2012 Vincent HERVIEUX
+*
+*   This file is part of QPicoscope.
+*
+*   QPicoscope is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU Lesser General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   any later version.
+*
+*   QPicoscope is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU Lesser General Public License for more details.
+*
+*   You should have received a copy of the GNU Lesser General Public License
+*   along with QPicoscope in files COPYING.LESSER and COPYING.
+*   If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+/**
+ * @file streamdisplay.h
+ * @brief Declaration of StreamDisplay class.
+ * StreamSink feeding the screen in sweep mode: the stream is written from
+ * the left of the screen to the right, then starts over from the left.
+ * The sweep grows between two publications, so the screen only indexes
+ * the new samples, see DrawData::setRawData().
+ * With a trigger, each sweep is a whole screen around a trigger point
+ * instead, the samples before it are read back from the stream ring.
+ * @version 0.1
+ * @date 2026, october 16
+ * @author Vincent HERVIEUX    -   10.16.2026   -   initial creation
+ */
+
+#ifndef STREAMDISPLAY_H
+#define STREAMDISPLAY_H
+
+#include "oscilloscope.h"
+#include "drawdata.h"
+#include "samplearena.h"
+#include "streampipeline.h"
+#include "streamsink.h"
+#include "streamtrigger.h"
+#include "triggerinterpolator.h"
+
+/* the screen is refreshed at most this often, in seconds */
+#define STREAM_DISPLAY_PERIOD        0.040
+/* longest sweep, in samples per channel */
+#define STREAM_DISPLAY_MAX_POINTS    (4 * 1024 * 1024)
+/* part of a triggered sweep before the trigger point, as block captures */
+#define STREAM_DISPLAY_PRE_TRIGGER   0.1
+
+class StreamDisplay : public StreamSink
+{
+public:
+    /** @brief constructor */
+    StreamDisplay();
+    /** @brief destructor */
+    ~StreamDisplay();
+
+    /** @brief set where to draw, only while the stream is stopped */
+    void set_draw_data(DrawData *draw) { draw_m = draw; }
+    /**
+     * @brief time shown by a sweep, applied on next stream_start()
+     * @param[in] duration: in seconds, the width of the screen
+     */
+    void set_window(double duration) { window_m = duration; }
+    /** @brief where the samples before a trigger are read, only while the stream is stopped */
+    void set_stream(const StreamPipeline *stream) { stream_m = stream; }
+    /**
+     * @brief trigger the sweeps, applied on next stream_start()
+     * The search starts again once a sweep is complete. A source channel
+     * that is not enabled, or StreamTrigger::E_TYPE_NONE, gives free
+     * running sweeps.
+     * @param[in] config: see StreamTrigger
+     * @param[in] source: channel searched, 0 for channel A
+     * @param[in] pre_trigger: part of the sweep before the trigger point, in [0, 1]
+     */
+    void set_trigger(const StreamTrigger::config_t &config, uint8_t source, double pre_trigger);
+    /**
+     * @brief how the trigger point is found between two samples, applied on next stream_start()
+     * Only edge and pulse width triggers fire on a crossing, the others
+     * keep the trigger point on the sample they fired on.
+     */
+    void set_interpolation(TriggerInterpolator::method_e method) { interpolator_m.set_method(method); }
+
+    uint32_t stream_history(const stream_format_t &format);
+    void stream_start(const stream_format_t &format);
+    void stream_data(const int16_t *const *channels, uint32_t count, uint64_t dropped);
+    void stream_stop(void);
+
+private:
+    StreamDisplay(const StreamDisplay&);
+    StreamDisplay& operator=(const StreamDisplay&);
+    /** @brief samples per channel of a full sweep */
+    uint32_t sweep_points(const stream_format_t &format) const;
+    /** @brief hand the sweep so far to the screen */
+    void publish(void);
+    /** @brief search the trigger, hand every complete sweep around it to the screen */
+    void trigger_data(const int16_t *const *channels, uint32_t count, uint64_t dropped);
+    void publish_triggered(void);
+
+    DrawData *draw_m;
+    double window_m;
+    stream_format_t format_m;
+    SampleArena arena_m;
+    int16_t *sweep_m[STREAM_MAX_CHANNELS];
+    /** @brief samples per channel of a full sweep */
+    uint32_t nb_points_m;
+    /** @brief samples per channel in the current sweep */
+    uint32_t index_m;
+    /** @brief samples between two publications */
+    uint32_t period_m;
+    /** @brief samples added since the last publication */
+    uint32_t pending_m;
+    const StreamPipeline *stream_m;
+    StreamTrigger trigger_m;
+    TriggerInterpolator interpolator_m;
+    uint8_t trigger_source_m;
+    double pre_trigger_m;
+    /** @brief the stream is searched for the trigger since the last stream_start() */
+    bool triggered_m;
+    /** @brief samples per channel of a sweep before and after the trigger point */
+    uint32_t pre_points_m;
+    uint32_t post_points_m;
+    /** @brief a trigger at trigger_position_m waits for the samples after it */
+    bool capturing_m;
+    uint64_t trigger_position_m;
+    /** @brief first sample after the last gap of the stream */
+    uint64_t gap_position_m;
+};
+
+#endif // STREAMDISPLAY_H
@@ -0,0 +1,224 @@
+/*****************************************************************************
+*   Copyright 2012 Vincent HERVIEUX
+*
+*   This file is part of QPicoscope.
+*
+*   QPicoscope is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU Lesser General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   any later version.
+*
+*   QPicoscope is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU Lesser General Public License for more details.
+*
+*   You should have received a copy of the GNU Lesser General Public License
+*   along with QPicoscope in files COPYING.LESSER and COPYING.
+*   If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+/**
+ * @file streampipeline.cpp
+ * @brief Definition of StreamPipeline class.
+ * @version 0.1
+ * @date 2026, october 16
+ * @author Vincent HERVIEUX    -   10.16.2026   -   initial creation
+ */
+
+#include <string.h>
+#include <algorithm>
+
+#include "streampipeline.h"
+
+/****************************************************************************
+ *
+ * constructor
+ *
+ ****************************************************************************/
+StreamPipeline::StreamPipeline() :
+    thread_id_m(0),
+    wake_level_m(0)
+{
+    memset(&format_m, 0, sizeof(format_m));
+    pthread_mutex_init(&sinks_lock_m, NULL);
+}
+
+/****************************************************************************
+ *
+ * destructor
+ *
+ ****************************************************************************/
+StreamPipeline::~StreamPipeline()
+{
+    stop();
+    pthread_mutex_destroy(&sinks_lock_m);
+}
+
+/****************************************************************************
+ * add_sink
+ ****************************************************************************/
+void StreamPipeline::add_sink(StreamSink *sink)
+{
+    if (NULL == sink)
+        return;
+    pthread_mutex_lock(&sinks_lock_m);
+    if (std::find(sinks_m.begin(), sinks_m.end(), sink) == sinks_m.end())
+    {
+        if (is_running())
+            sink->stream_start(format_m);
+        sinks_m.push_back(sink);
+    }
+    pthread_mutex_unlock(&sinks_lock_m);
+}
+
+/****************************************************************************
+ * remove_sink
+ ****************************************************************************/
+void StreamPipeline::remove_sink(StreamSink *sink)
+{
+    std::vector<StreamSink*>::iterator it;
+
+    pthread_mutex_lock(&sinks_lock_m);
+    it = std::find(sinks_m.begin(), sinks_m.end(), sink);
+    if (it != sinks_m.end())
+    {
+        if (is_running())
+            sink->stream_stop();
+        sinks_m.erase(it);
+    }
+    pthread_mutex_unlock(&sinks_lock_m);
+}
+
+/****************************************************************************
+ * start
+ ****************************************************************************/
+bool StreamPipeline::start(const StreamSink::stream_format_t &format)
+{
+    double capacity = STREAM_RING_MIN;
+    uint32_t history = 0;
+    uint32_t i = 0;
+    int ret = 0;
+
+    if (is_running())
+        stop();
+
+    /* room for the driver buffers of a whole drain period, and much more */
+    if (format.sample_interval > 0.)
+        capacity = STREAM_RING_DURATION / format.sample_interval;
+    if (capacity < STREAM_RING_MIN)
+        capacity = STREAM_RING_MIN;
+    if (capacity > STREAM_RING_MAX)
+        capacity = STREAM_RING_MAX;
+    /* the history comes on top, the room left to the producer is the same */
+    pthread_mutex_lock(&sinks_lock_m);
+    for (i = 0; i < sinks_m.size(); i++)
+        history = std::max(history, sinks_m[i]->stream_history(format));
+    pthread_mutex_unlock(&sinks_lock_m);
+    if (capacity < history)
+        capacity = history;
+    if (!ring_m.init(format.nb_channels, (uint32_t)capacity + history, history))
+        return false;
+    wake_level_m = ring_m.get_capacity() / 4;
+    format_m = format;
+    DEBUG("streaming %u channels every %e s, ring of %u samples, %u kept\n",
+          format.nb_channels, format.sample_interval, ring_m.get_capacity(), history);
+
+    pthread_mutex_lock(&sinks_lock_m);
+    for (i = 0; i < sinks_m.size(); i++)
+        sinks_m[i]->stream_start(format_m);
+    waiter_m.reset();
+    ret = pthread_create(&thread_id_m, NULL, StreamPipeline::thread_dispatch, this);
+    if (0 != ret)
+    {
+        ERROR("pthread_create failed and returned %d\n", ret);
+        thread_id_m = 0;
+        for (i = 0; i < sinks_m.size(); i++)
+            sinks_m[i]->stream_stop();
+    }
+    pthread_mutex_unlock(&sinks_lock_m);
+    return (0 == ret);
+}
+
+/****************************************************************************
+ * stop
+ *  The producer must be stopped first: the dispatcher drains what is left
+ *  in the ring before the sinks are told the stream ended.
+ ****************************************************************************/
+void StreamPipeline::stop(void)
+{
+    uint32_t i = 0;
+
+    if (!is_running())
+        return;
+    waiter_m.cancel();
+    pthread_join(thread_id_m, NULL);
+    pthread_mutex_lock(&sinks_lock_m);
+    thread_id_m = 0;
+    for (i = 0; i < sinks_m.size(); i++)
+        sinks_m[i]->stream_stop();
+    pthread_mutex_unlock(&sinks_lock_m);
+}
+
+/****************************************************************************
+ * write
+ ****************************************************************************/
+uint32_t StreamPipeline::write(const int16_t *const *channels, uint32_t count)
+{
+    uint32_t before = ring_m.get_readable();
+    uint32_t stored = ring_m.write(channels, count);
+
+    /* the periodic drain is enough until the ring fills up */
+    if ((before < wake_level_m) && (before + stored >= wake_level_m))
+        waiter_m.notify();
+    return stored;
+}
+
+/****************************************************************************
+ * thread_dispatch
+ ****************************************************************************/
+void* StreamPipeline::thread_dispatch(void *arg)
+{
+    StreamPipeline *pipeline = (StreamPipeline*)arg;
+
+    for (;;)
+    {
+        /* armed before draining so that a wake up during drain() is kept */
+        pipeline->waiter_m.arm(STREAM_DRAIN_PERIOD);
+        pipeline->drain();
+        if (ReadyWaiter::E_WAIT_CANCELLED == pipeline->waiter_m.wait_event(STREAM_DRAIN_PERIOD))
+            break;
+    }
+    /* what the producer wrote before it stopped */
+    pipeline->drain();
+    pthread_exit(NULL);
+}
+
+/****************************************************************************
+ * drain
+ ****************************************************************************/
+void StreamPipeline::drain(void)
+{
+    const int16_t *channels[STREAM_MAX_CHANNELS] = {NULL};
+    uint64_t dropped = 0;
+    uint32_t count = 0;
+    uint32_t i = 0;
+
+    pthread_mutex_lock(&sinks_lock_m);
+    /*
+     * A pass stops at the next gap or at the end of the tables, the gap
+     * goes with the samples right after it.
+     */
+    for (;;)
+    {
+        dropped = ring_m.take_dropped();
+        count = ring_m.read_begin(channels);
+        if ((0 == count) && (0 == dropped))
+            break;
+        for (i = 0; i < sinks_m.size(); i++)
+            sinks_m[i]->stream_data(channels, count, dropped);
+        if (0 == count)
+            break;
+        ring_m.read_end(count);
+    }
+    pthread_mutex_unlock(&sinks_lock_m);
+}
@@ -0,0 +1,115 @@
+/*****************************************************************************
+*   Copyright 2012 Vincent HERVIEUX
+*
+*   This file is part of QPicoscope.
+*
+*   QPicoscope is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU Lesser General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   any later version.
+*
+*   QPicoscope is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU Lesser General Public License for more details.
+*
+*   You should have received a copy of the GNU Lesser General Public License
+*   along with QPicoscope in files COPYING.LESSER and COPYING.
+*   If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+/**
+ * @file streampipeline.h
+ * @brief Declaration of StreamPipeline class.
+ * Continuous streaming from the driver callback to the sinks: the callback
+ * only copies the driver buffers in a StreamRing, a dispatcher thread
+ * drains the ring into every registered StreamSink. The callback never
+ * waits for a sink, a slow sink only shows up in the dropped counter.
+ * @version 0.1
+ * @date 2026, october 16
+ * @author Vincent HERVIEUX    -   10.16.2026   -   initial creation
+ */
+
+#ifndef STREAMPIPELINE_H
+#define STREAMPIPELINE_H
+
+#include <pthread.h>
+#include <vector>
+
+#include "oscilloscope.h"
+#include "readywaiter.h"
+#include "streamring.h"
+#include "streamsink.h"
+
+/* the ring holds this much of the stream, in seconds */
+#define STREAM_RING_DURATION    0.5
+/* ring capacity bounds, in samples per channel */
+#define STREAM_RING_MIN         (64 * 1024)
+#define STREAM_RING_MAX         (64 * 1024 * 1024)
+/* the dispatcher drains at least this often, in seconds */
+#define STREAM_DRAIN_PERIOD     0.010
+
+class StreamPipeline
+{
+public:
+    /** @brief constructor */
+    StreamPipeline();
+    /** @brief destructor, stops the stream */
+    ~StreamPipeline();
+
+    /**
+     * @brief register a sink, any time
+     * While streaming, the sink is started at once and gets the samples
+     * from the next drain on, its history is only kept from the next start().
+     */
+    void add_sink(StreamSink *sink);
+    /** @brief unregister a sink, stopped first while streaming */
+    void remove_sink(StreamSink *sink);
+    /**
+     * @brief size the ring for the sample rate, start the sinks and the dispatcher
+     * @return false if the ring or the thread cannot be created
+     */
+    bool start(const StreamSink::stream_format_t &format);
+    /** @brief stop the dispatcher once every stored sample is given to the sinks */
+    void stop(void);
+    bool is_running(void) const { return 0 != thread_id_m; }
+
+    /**
+     * @brief producer side, the driver callback: store the next samples
+     * @return samples stored, the others are counted as dropped
+     */
+    uint32_t write(const int16_t *const *channels, uint32_t count);
+    /** @brief producer side: samples write() can store right now */
+    uint32_t get_room(void) const { return ring_m.get_room(); }
+    /** @brief producer side: count a driver reported overflow */
+    void count_overflow(void) { ring_m.count_overflow(); }
+    /** @brief read the counters, can be called from any thread */
+    void get_stats(StreamRing::stats_t *stats) const { ring_m.get_stats(stats); }
+    /** @brief sinks side, in stream_data(): position in the stream of the samples given */
+    uint64_t get_read_position(void) const { return ring_m.get_read_position(); }
+    /**
+     * @brief sinks side, in stream_data(): samples from a position of the stream
+     * Samples up to the largest StreamSink::stream_history() before the
+     * ones given are kept, see StreamRing::peek().
+     */
+    uint32_t peek(uint64_t position, const int16_t **channels) const { return ring_m.peek(position, channels); }
+
+private:
+    StreamPipeline(const StreamPipeline&);
+    StreamPipeline& operator=(const StreamPipeline&);
+    static void* thread_dispatch(void *arg);
+    /** @brief give every stored sample to the sinks, dispatcher thread only */
+    void drain(void);
+
+    StreamRing ring_m;
+    /** @brief wakes the dispatcher when the ring fills up, cancelled by stop() */
+    ReadyWaiter waiter_m;
+    /** @brief held by the dispatcher while it feeds the sinks */
+    pthread_mutex_t sinks_lock_m;
+    std::vector<StreamSink*> sinks_m;
+    StreamSink::stream_format_t format_m;
+    pthread_t thread_id_m;
+    /** @brief fill level above which write() wakes the dispatcher */
+    uint32_t wake_level_m;
+};
+
+#endif // STREAMPIPELINE_H
@@ -0,0 +1,299 @@
+/*****************************************************************************
+*   Copyright 2012 Vincent HERVIEUX
+*
+*   This file is part of QPicoscope.
+*
+*   QPicoscope is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU Lesser General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   any later version.
+*
+*   QPicoscope is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU Lesser General Public License for more details.
+*
+*   You should have received a copy of the GNU Lesser General Public License
+*   along with QPicoscope in files COPYING.LESSER and COPYING.
+*   If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+/**
+ * @file streamring.cpp
+ * @brief Definition of StreamRing class.
+ * @version 0.1
+ * @date 2026, october 16
+ * @author Vincent HERVIEUX    -   10.16.2026   -   initial creation
+ */
+
+#include <string.h>
+
+#include "streamring.h"
+
+/* a power of two above 2^31 would not fit the capacity */
+#define STREAM_RING_MAX_CAPACITY    (1U << 31)
+
+/****************************************************************************
+ *
+ * constructor
+ *
+ ****************************************************************************/
+StreamRing::StreamRing() :
+    nb_channels_m(0),
+    capacity_m(0),
+    history_m(0),
+    head_m(0),
+    dropped_m(0),
+    overruns_m(0),
+    overflows_m(0),
+    gap_head_m(0),
+    gap_open_m(false),
+    tail_m(0),
+    gap_tail_m(0),
+    reported_m(0)
+{
+    memset(tables_m, 0, sizeof(tables_m));
+    memset(gaps_m, 0, sizeof(gaps_m));
+    memset(&open_gap_m, 0, sizeof(open_gap_m));
+}
+
+/****************************************************************************
+ *
+ * destructor
+ *
+ ****************************************************************************/
+StreamRing::~StreamRing()
+{
+}
+
+/****************************************************************************
+ * init
+ ****************************************************************************/
+bool StreamRing::init(uint8_t nb_channels, uint32_t capacity, uint32_t history)
+{
+    uint32_t rounded = 1;
+    uint8_t ch = 0;
+
+    if ((0 == nb_channels) || (nb_channels > STREAM_MAX_CHANNELS))
+    {
+        ERROR("cannot stream %u channels\n", nb_channels);
+        return false;
+    }
+    if (capacity > STREAM_RING_MAX_CAPACITY)
+        capacity = STREAM_RING_MAX_CAPACITY;
+    /* indexes are masked instead of divided */
+    while (rounded < capacity)
+        rounded <<= 1;
+
+    if (!arena_m.reserve(nb_channels * SampleArena::aligned_size(rounded * sizeof(int16_t))))
+        return false;
+    memset(tables_m, 0, sizeof(tables_m));
+    for (ch = 0; ch < nb_channels; ch++)
+        tables_m[ch] = (int16_t*)arena_m.allocate(rounded * sizeof(int16_t));
+    nb_channels_m = nb_channels;
+    capacity_m = rounded;
+    /* the producer needs room left */
+    history_m = (history < rounded / 2) ? history : rounded / 2;
+    head_m = 0;
+    tail_m = 0;
+    dropped_m = 0;
+    overruns_m = 0;
+    overflows_m = 0;
+    gap_head_m = 0;
+    gap_open_m = false;
+    gap_tail_m = 0;
+    reported_m = 0;
+    return true;
+}
+
+/****************************************************************************
+ * write
+ ****************************************************************************/
+uint32_t StreamRing::write(const int16_t *const *channels, uint32_t count)
+{
+    uint64_t head = head_m;
+    uint64_t tail = ATOMIC_LOAD_ACQUIRE(&tail_m);
+    uint64_t kept = (tail > history_m) ? tail - history_m : 0;
+    uint32_t room = capacity_m - (uint32_t)(head - kept);
+    uint32_t stored = (count < room) ? count : room;
+    uint32_t start = (uint32_t)head & (capacity_m - 1);
+    uint32_t first = capacity_m - start;
+    uint8_t ch = 0;
+
+    /*
+     * The gap is queued before the samples after it are visible. With the
+     * queue full it stays open and these samples are dropped as well,
+     * a gap is never reported anywhere else than where it is.
+     */
+    if (gap_open_m && (stored > 0))
+    {
+        if (gap_head_m - ATOMIC_LOAD_ACQUIRE(&gap_tail_m) < STREAM_RING_MAX_GAPS)
+        {
+            gaps_m[gap_head_m % STREAM_RING_MAX_GAPS] = open_gap_m;
+            ATOMIC_STORE_RELEASE(&gap_head_m, gap_head_m + 1);
+            gap_open_m = false;
+        }
+        else
+            stored = 0;
+    }
+    if (first > stored)
+        first = stored;
+    for (ch = 0; (ch < nb_channels_m) && (stored > 0); ch++)
+    {
+        if (NULL == channels[ch])
+        {
+            memset(tables_m[ch] + start, 0, first * sizeof(int16_t));
+            memset(tables_m[ch], 0, (stored - first) * sizeof(int16_t));
+        }
+        else
+        {
+            memcpy(tables_m[ch] + start, channels[ch], first * sizeof(int16_t));
+            memcpy(tables_m[ch], channels[ch] + first, (stored - first) * sizeof(int16_t));
+        }
+    }
+    /* samples are visible to the consumer once head is */
+    ATOMIC_STORE_RELEASE(&head_m, head + stored);
+    if (stored < count)
+    {
+        /* drops at the same position make one gap */
+        if (!gap_open_m)
+        {
+            open_gap_m.position = head + stored;
+            gap_open_m = true;
+        }
+        open_gap_m.dropped = dropped_m + (count - stored);
+        /* after head, a reader of dropped_m sees where the drops are */
+        ATOMIC_STORE_RELEASE(&dropped_m, open_gap_m.dropped);
+        ATOMIC_STORE_RELAXED(&overruns_m, overruns_m + 1);
+    }
+    return stored;
+}
+
+/****************************************************************************
+ * count_overflow
+ ****************************************************************************/
+void StreamRing::count_overflow(void)
+{
+    ATOMIC_STORE_RELAXED(&overflows_m, overflows_m + 1);
+}
+
+/****************************************************************************
+ * read_begin
+ ****************************************************************************/
+uint32_t StreamRing::read_begin(const int16_t **channels)
+{
+    uint64_t tail = tail_m;
+    uint64_t head = ATOMIC_LOAD_ACQUIRE(&head_m);
+    uint32_t start = (uint32_t)tail & (capacity_m - 1);
+    uint32_t available = (uint32_t)(head - tail);
+    uint64_t gap = 0;
+    uint8_t ch = 0;
+
+    if (available > capacity_m - start)
+        available = capacity_m - start;
+    /* the samples after the next gap come with it */
+    if (gap_tail_m != ATOMIC_LOAD_ACQUIRE(&gap_head_m))
+    {
+        gap = gaps_m[gap_tail_m % STREAM_RING_MAX_GAPS].position;
+        if ((gap > tail) && (gap - tail < available))
+            available = (uint32_t)(gap - tail);
+    }
+    for (ch = 0; ch < nb_channels_m; ch++)
+        channels[ch] = tables_m[ch] + start;
+    return available;
+}
+
+/****************************************************************************
+ * take_dropped
+ ****************************************************************************/
+uint64_t StreamRing::take_dropped(void)
+{
+    uint64_t gap_head = ATOMIC_LOAD_ACQUIRE(&gap_head_m);
+    uint64_t gap_tail = gap_tail_m;
+    uint64_t reported = reported_m;
+    uint64_t dropped = 0;
+    gap_t *gap = NULL;
+
+    for (; gap_tail != gap_head; gap_tail++)
+    {
+        gap = &gaps_m[gap_tail % STREAM_RING_MAX_GAPS];
+        if (gap->position > tail_m)
+            break;
+        if (gap->dropped > reported_m)
+            reported_m = gap->dropped;
+    }
+    /* the producer may reuse the entries once gap_tail is published */
+    ATOMIC_STORE_RELEASE(&gap_tail_m, gap_tail);
+    /*
+     * Every sample read, the gap still open is at the read position.
+     * dropped_m is read first, the gaps it counts are before the head
+     * read after it.
+     */
+    dropped = ATOMIC_LOAD_ACQUIRE(&dropped_m);
+    if ((tail_m == ATOMIC_LOAD_ACQUIRE(&head_m)) && (dropped > reported_m))
+        reported_m = dropped;
+    return reported_m - reported;
+}
+
+/****************************************************************************
+ * read_end
+ ****************************************************************************/
+void StreamRing::read_end(uint32_t count)
+{
+    /* the producer may reuse the room once tail is published */
+    ATOMIC_STORE_RELEASE(&tail_m, tail_m + count);
+}
+
+/****************************************************************************
+ * peek
+ ****************************************************************************/
+uint32_t StreamRing::peek(uint64_t position, const int16_t **channels) const
+{
+    uint64_t tail = tail_m;
+    uint64_t head = ATOMIC_LOAD_ACQUIRE(&head_m);
+    uint64_t kept = (tail > history_m) ? tail - history_m : 0;
+    uint32_t start = (uint32_t)position & (capacity_m - 1);
+    uint32_t available = 0;
+    uint8_t ch = 0;
+
+    if ((position < kept) || (position >= head))
+        return 0;
+    available = (uint32_t)(head - position);
+    if (available > capacity_m - start)
+        available = capacity_m - start;
+    for (ch = 0; ch < nb_channels_m; ch++)
+        channels[ch] = tables_m[ch] + start;
+    return available;
+}
+
+/****************************************************************************
+ * get_readable
+ ****************************************************************************/
+uint32_t StreamRing::get_readable(void) const
+{
+    return (uint32_t)(ATOMIC_LOAD_ACQUIRE(&head_m) - ATOMIC_LOAD_ACQUIRE(&tail_m));
+}
+
+/****************************************************************************
+ * get_room
+ ****************************************************************************/
+uint32_t StreamRing::get_room(void) const
+{
+    uint64_t tail = ATOMIC_LOAD_ACQUIRE(&tail_m);
+    uint64_t kept = (tail > history_m) ? tail - history_m : 0;
+
+    return capacity_m - (uint32_t)(ATOMIC_LOAD_ACQUIRE(&head_m) - kept);
+}
+
+/****************************************************************************
+ * get_stats
+ ****************************************************************************/
+void StreamRing::get_stats(stats_t *stats) const
+{
+    if (NULL == stats)
+        return;
+    stats->written = ATOMIC_LOAD_ACQUIRE(&head_m);
+    stats->read = ATOMIC_LOAD_ACQUIRE(&tail_m);
+    stats->dropped = ATOMIC_LOAD_RELAXED(&dropped_m);
+    stats->overruns = ATOMIC_LOAD_RELAXED(&overruns_m);
+    stats->overflows = ATOMIC_LOAD_RELAXED(&overflows_m);
+}
@@ -0,0 +1,160 @@
+/*****************************************************************************
+*   Copyright 2012 Vincent HERVIEUX
+*
+*   This file is part of QPicoscope.
+*
+*   QPicoscope is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU Lesser General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   any later version.
+*
+*   QPicoscope is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU Lesser General Public License for more details.
+*
+*   You should have received a copy of the GNU Lesser General Public License
+*   along with QPicoscope in files COPYING.LESSER and COPYING.
+*   If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+/**
+ * @file streamring.h
+ * @brief Declaration of StreamRing class.
+ * Single producer / single consumer ring of ADC counts for continuous
+ * streaming. Every channel has its own table and all of them share the
+ * same indexes, so a write or a read always covers the same samples on
+ * every channel. The driver callback writes, the stream dispatcher reads
+ * in place. Samples that do not fit are dropped and counted, never
+ * overwritten, so what the consumer gets is always in order. Where the
+ * drops happened is queued along, for the consumer to report each gap
+ * when it reaches it.
+ * A history of samples already read can be kept behind the consumer, for
+ * it to look back at them, a pre-trigger for instance.
+ * @version 0.1
+ * @date 2026, october 16
+ * @author Vincent HERVIEUX    -   10.16.2026   -   initial creation
+ */
+
+#ifndef STREAMRING_H
+#define STREAMRING_H
+
+#include "oscilloscope.h"
+#include "atomic-ops.h"
+#include "samplearena.h"
+
+#define STREAM_MAX_CHANNELS    4
+/* gaps queued for the consumer, samples after one more are dropped too */
+#define STREAM_RING_MAX_GAPS   64
+
+class StreamRing
+{
+public:
+    /**
+     * @brief public typedef declarations
+     */
+    typedef struct
+    {
+        /** @brief samples per channel stored in the ring */
+        uint64_t written;
+        /** @brief samples per channel handed to the consumer */
+        uint64_t read;
+        /** @brief samples per channel lost because the ring was full */
+        uint64_t dropped;
+        /** @brief writes that lost samples */
+        uint64_t overruns;
+        /** @brief driver reported events: ADC over range, driver buffer overrun */
+        uint64_t overflows;
+    } stats_t;
+
+    /** @brief constructor, nothing is allocated yet */
+    StreamRing();
+    /** @brief destructor */
+    ~StreamRing();
+
+    /**
+     * @brief size the ring and empty it, neither side may be running
+     * @param[in] nb_channels: up to STREAM_MAX_CHANNELS
+     * @param[in] capacity: samples per channel, rounded up to a power of two
+     * @param[in] history: samples per channel read but kept, out of capacity
+     * @return false if memory is exhausted
+     */
+    bool init(uint8_t nb_channels, uint32_t capacity, uint32_t history = 0);
+    /**
+     * @brief producer side: append count samples of every channel
+     * @param[in] channels: nb_channels tables, a NULL table stores zeros
+     * @return samples stored, the others are counted as dropped
+     */
+    uint32_t write(const int16_t *const *channels, uint32_t count);
+    /** @brief producer side: count a driver reported overflow */
+    void count_overflow(void);
+    /**
+     * @brief consumer side: oldest unread samples, left in place
+     * @param[out] channels: nb_channels pointers, valid until read_end()
+     * @return contiguous samples available, call again after read_end()
+     * to get the ones wrapped at the start of the tables
+     */
+    uint32_t read_begin(const int16_t **channels);
+    /**
+     * @brief consumer side: samples dropped at the read position
+     * read_begin() stops at the next gap, call this one before it.
+     * @return samples lost right before the ones read_begin() returns
+     */
+    uint64_t take_dropped(void);
+    /** @brief consumer side: release count samples returned by read_begin() */
+    void read_end(uint32_t count);
+    /** @brief consumer side: position in the stream of the samples read_begin() returns */
+    uint64_t get_read_position(void) const { return tail_m; }
+    /**
+     * @brief consumer side: samples from a position of the stream, left in place
+     * @param[in] position: from the history up to the last written sample
+     * @param[out] channels: nb_channels pointers, valid until read_end()
+     * @return contiguous samples available, 0 if position is not kept
+     */
+    uint32_t peek(uint64_t position, const int16_t **channels) const;
+    /** @brief samples waiting for the consumer */
+    uint32_t get_readable(void) const;
+    /** @brief samples write() can store right now */
+    uint32_t get_room(void) const;
+    uint32_t get_capacity(void) const { return capacity_m; }
+    uint8_t get_nb_channels(void) const { return nb_channels_m; }
+    /** @brief read the counters, can be called from any thread */
+    void get_stats(stats_t *stats) const;
+
+private:
+    StreamRing(const StreamRing&);
+    StreamRing& operator=(const StreamRing&);
+
+    /** @brief where samples were lost */
+    typedef struct
+    {
+        /** @brief position in the stream of the first sample after the gap */
+        uint64_t position;
+        /** @brief dropped counter once the gap was counted */
+        uint64_t dropped;
+    } gap_t;
+
+    SampleArena arena_m;
+    int16_t *tables_m[STREAM_MAX_CHANNELS];
+    uint8_t nb_channels_m;
+    uint32_t capacity_m;
+    uint32_t history_m;
+    char     pad0_m[CACHE_LINE_SIZE];
+    /* written by the producer only */
+    uint64_t head_m;
+    uint64_t dropped_m;
+    uint64_t overruns_m;
+    uint64_t overflows_m;
+    uint64_t gap_head_m;
+    gap_t    gaps_m[STREAM_RING_MAX_GAPS];
+    /** @brief the last gap, queued once samples follow it */
+    gap_t    open_gap_m;
+    bool     gap_open_m;
+    char     pad1_m[CACHE_LINE_SIZE];
+    /* written by the consumer only */
+    uint64_t tail_m;
+    uint64_t gap_tail_m;
+    /** @brief dropped counter already returned by take_dropped() */
+    uint64_t reported_m;
+};
+
+#endif // STREAMRING_H
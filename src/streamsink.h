@@ -0,0 +1,78 @@
+/*****************************************************************************
+*   Copyright 2012 Vincent HERVIEUX
+*
+*   This file is part of QPicoscope.
+*
+*   QPicoscope is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU Lesser General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   any later version.
+*
+*   QPicoscope is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU Lesser General Public License for more details.
+*
+*   You should have received a copy of the GNU Lesser General Public License
+*   along with QPicoscope in files COPYING.LESSER and COPYING.
+*   If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+/**
+ * @file streamsink.h
+ * @brief Declaration of StreamSink interface.
+ * Consumer of a continuous stream: the display, a recorder or an analysis
+ * stage. Every sink registered on a StreamPipeline sees every sample that
+ * made it through the ring, in order, from the dispatcher thread.
+ * A sink that looks back at samples already given asks the ring to keep
+ * them, see StreamPipeline::peek().
+ * @version 0.1
+ * @date 2026, october 16
+ * @author Vincent HERVIEUX    -   10.16.2026   -   initial creation
+ */
+
+#ifndef STREAMSINK_H
+#define STREAMSINK_H
+
+#include "oscilloscope.h"
+#include "streamring.h"
+
+class StreamSink
+{
+public:
+    /**
+     * @brief public typedef declarations
+     */
+    typedef struct
+    {
+        /** @brief tables given to stream_data() */
+        uint8_t nb_channels;
+        /** @brief bit n is set when channel n is enabled, others carry zeros */
+        uint8_t channel_mask;
+        /** @brief time between two samples in seconds */
+        double  sample_interval;
+        /** @brief volts = count * scale + offset, per channel */
+        float   scale[STREAM_MAX_CHANNELS];
+        float   offset[STREAM_MAX_CHANNELS];
+    } stream_format_t;
+
+    virtual ~StreamSink() {}
+    /**
+     * @brief samples per channel kept in the ring after stream_data() gave them
+     * Asked when the stream starts, before stream_start().
+     */
+    virtual uint32_t stream_history(const stream_format_t &format) { (void)format; return 0; }
+    /** @brief a stream begins, stream_data() follows with this format */
+    virtual void stream_start(const stream_format_t &format) = 0;
+    /**
+     * @brief next samples of the stream
+     * @param[in] channels: nb_channels tables of count ADC counts, only
+     * valid during the call
+     * @param[in] dropped: samples lost right before these ones because the
+     * ring was full, 0 as long as the stream is gap free
+     */
+    virtual void stream_data(const int16_t *const *channels, uint32_t count, uint64_t dropped) = 0;
+    /** @brief the stream ended, every sample was given */
+    virtual void stream_stop(void) = 0;
+};
+
+#endif // STREAMSINK_H
@@ -0,0 +1,646 @@
+/*****************************************************************************
+*   Copyright 2012 Vincent HERVIEUX
+*
+*   This file is part of QPicoscope.
+*
+*   QPicoscope is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU Lesser General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   any later version.
+*
+*   QPicoscope is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU Lesser General Public License for more details.
+*
+*   You should have received a copy of the GNU Lesser General Public License
+*   along with QPicoscope in files COPYING.LESSER and COPYING.
+*   If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+/**
+ * @file streamtrigger.cpp
+ * @brief Definition of StreamTrigger class.
+ * @version 0.1
+ * @date 2026, october 16
+ * @author Vincent HERVIEUX    -   10.16.2026   -   initial creation
+ */
+
+#include <string.h>
+#include <math.h>
+
+#include "streamtrigger.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define STREAM_TRIGGER_X86
+#include <immintrin.h>
+#endif
+#if defined(__aarch64__) && defined(__ARM_NEON)
+#define STREAM_TRIGGER_NEON
+#include <arm_neon.h>
+#endif
+
+/* thresholds out of the ADC range stay out of it, without overflow */
+#define STREAM_TRIGGER_COUNTS_MAX    (2 * 32768)
+
+/****************************************************************************
+ * find_scalar
+ ****************************************************************************/
+static uint32_t find_scalar(const int16_t *samples, uint32_t count, int16_t lo, int16_t hi, bool inside)
+{
+    uint32_t i = 0;
+
+    for (i = 0; i < count; i++)
+    {
+        if (((samples[i] >= lo) && (samples[i] <= hi)) == inside)
+            break;
+    }
+    return i;
+}
+
+#ifdef STREAM_TRIGGER_X86
+/****************************************************************************
+ * find_sse2
+ *
+ * Lanes outside [lo, hi] are all ones, the byte mask of 16 samples is
+ * inverted to search inside. Each sample gives two bits of the mask.
+ ****************************************************************************/
+__attribute__((target("sse2")))
+static uint32_t find_sse2(const int16_t *samples, uint32_t count, int16_t lo, int16_t hi, bool inside)
+{
+    const __m128i low = _mm_set1_epi16(lo);
+    const __m128i high = _mm_set1_epi16(hi);
+    const uint32_t invert = inside ? 0xFFFFFFFFU : 0;
+    __m128i a;
+    __m128i b;
+    uint32_t mask = 0;
+    uint32_t i = 0;
+
+    for (i = 0; i + 16 <= count; i += 16)
+    {
+        a = _mm_loadu_si128((const __m128i*)(samples + i));
+        b = _mm_loadu_si128((const __m128i*)(samples + i + 8));
+        a = _mm_or_si128(_mm_cmplt_epi16(a, low), _mm_cmpgt_epi16(a, high));
+        b = _mm_or_si128(_mm_cmplt_epi16(b, low), _mm_cmpgt_epi16(b, high));
+        mask = ((uint32_t)_mm_movemask_epi8(a) | ((uint32_t)_mm_movemask_epi8(b) << 16)) ^ invert;
+        if (0 != mask)
+            return i + (__builtin_ctz(mask) >> 1);
+    }
+    return i + find_scalar(samples + i, count - i, lo, hi, inside);
+}
+
+/****************************************************************************
+ * find_avx2
+ ****************************************************************************/
+__attribute__((target("avx2")))
+static uint32_t find_avx2(const int16_t *samples, uint32_t count, int16_t lo, int16_t hi, bool inside)
+{
+    const __m256i low = _mm256_set1_epi16(lo);
+    const __m256i high = _mm256_set1_epi16(hi);
+    const uint64_t invert = inside ? ~0ULL : 0;
+    __m256i a;
+    __m256i b;
+    uint64_t mask = 0;
+    uint32_t i = 0;
+
+    for (i = 0; i + 32 <= count; i += 32)
+    {
+        a = _mm256_loadu_si256((const __m256i*)(samples + i));
+        b = _mm256_loadu_si256((const __m256i*)(samples + i + 16));
+        a = _mm256_or_si256(_mm256_cmpgt_epi16(low, a), _mm256_cmpgt_epi16(a, high));
+        b = _mm256_or_si256(_mm256_cmpgt_epi16(low, b), _mm256_cmpgt_epi16(b, high));
+        mask = ((uint64_t)(uint32_t)_mm256_movemask_epi8(a) | ((uint64_t)(uint32_t)_mm256_movemask_epi8(b) << 32)) ^ invert;
+        if (0 != mask)
+            return i + (__builtin_ctzll(mask) >> 1);
+    }
+    return i + find_sse2(samples + i, count - i, lo, hi, inside);
+}
+#endif
+
+#ifdef STREAM_TRIGGER_NEON
+/****************************************************************************
+ * find_neon
+ *
+ * Only tells which 16 samples hold the match, the scalar loop finds it.
+ ****************************************************************************/
+static uint32_t find_neon(const int16_t *samples, uint32_t count, int16_t lo, int16_t hi, bool inside)
+{
+    const int16x8_t low = vdupq_n_s16(lo);
+    const int16x8_t high = vdupq_n_s16(hi);
+    int16x8_t a;
+    int16x8_t b;
+    uint16x8_t out_a;
+    uint16x8_t out_b;
+    uint32_t i = 0;
+
+    for (i = 0; i + 16 <= count; i += 16)
+    {
+        a = vld1q_s16(samples + i);
+        b = vld1q_s16(samples + i + 8);
+        out_a = vorrq_u16(vcltq_s16(a, low), vcgtq_s16(a, high));
+        out_b = vorrq_u16(vcltq_s16(b, low), vcgtq_s16(b, high));
+        if (inside)
+        {
+            out_a = vmvnq_u16(out_a);
+            out_b = vmvnq_u16(out_b);
+        }
+        if (0 != vmaxvq_u16(vorrq_u16(out_a, out_b)))
+            break;
+    }
+    return i + find_scalar(samples + i, count - i, lo, hi, inside);
+}
+#endif
+
+/****************************************************************************
+ * to_counts
+ ****************************************************************************/
+static int32_t to_counts(double volts, float scale, float offset)
+{
+    double counts = floor((volts - offset) / scale + 0.5);
+
+    if (counts > STREAM_TRIGGER_COUNTS_MAX)
+        return STREAM_TRIGGER_COUNTS_MAX;
+    if (counts < -STREAM_TRIGGER_COUNTS_MAX)
+        return -STREAM_TRIGGER_COUNTS_MAX;
+    return (int32_t)counts;
+}
+
+/****************************************************************************
+ * to_samples
+ ****************************************************************************/
+static uint64_t to_samples(double seconds, double sample_interval)
+{
+    return (seconds > 0.) ? (uint64_t)(seconds / sample_interval + 0.5) : 0;
+}
+
+/****************************************************************************
+ *
+ * constructor
+ *
+ ****************************************************************************/
+StreamTrigger::StreamTrigger() :
+    kernel_m(AdcConvert::E_KERNEL_SCALAR),
+    find_m(find_scalar),
+    type_m(E_TYPE_NONE),
+    high_m(0),
+    low_m(0),
+    lower_m(0),
+    upper_m(0),
+    hysteresis_m(1),
+    min_width_m(0),
+    max_width_m(0),
+    timeout_m(1),
+    state_m(E_STATE_UNKNOWN),
+    position_m(0),
+    pulse_open_m(false),
+    pulse_start_m(0),
+    edge_seen_m(false),
+    last_edge_m(0)
+{
+    memset(&config_m, 0, sizeof(config_m));
+    config_m.type = E_TYPE_NONE;
+    set_kernel(AdcConvert::best_kernel());
+}
+
+/****************************************************************************
+ *
+ * destructor
+ *
+ ****************************************************************************/
+StreamTrigger::~StreamTrigger()
+{
+}
+
+/****************************************************************************
+ * set_kernel
+ ****************************************************************************/
+bool StreamTrigger::set_kernel(AdcConvert::kernel_e kernel)
+{
+    kernel_fn_t function = NULL;
+
+    if (AdcConvert::is_supported(kernel))
+    {
+        switch (kernel)
+        {
+#ifdef STREAM_TRIGGER_X86
+        case AdcConvert::E_KERNEL_SSE2:
+            function = find_sse2;
+            break;
+        case AdcConvert::E_KERNEL_AVX2:
+            function = find_avx2;
+            break;
+#endif
+#ifdef STREAM_TRIGGER_NEON
+        case AdcConvert::E_KERNEL_NEON:
+            function = find_neon;
+            break;
+#endif
+        case AdcConvert::E_KERNEL_SCALAR:
+            function = find_scalar;
+            break;
+        default:
+            break;
+        }
+    }
+    if (NULL == function)
+    {
+        WARNING("%s kernel not supported, keeping %s\n", AdcConvert::kernel_name(kernel), AdcConvert::kernel_name(kernel_m));
+        return false;
+    }
+    kernel_m = kernel;
+    find_m = function;
+    return true;
+}
+
+/****************************************************************************
+ * start
+ *
+ * The comparator of edge, pulse width and timeout goes high at high_m and
+ * low at low_m, hysteresis apart: the edge of the wanted direction is
+ * found on the level, either direction puts the level between the two.
+ ****************************************************************************/
+bool StreamTrigger::start(float scale, float offset, double sample_interval)
+{
+    int32_t swap = 0;
+    double hysteresis = 0.;
+
+    type_m = config_m.type;
+    rearm();
+    if (E_TYPE_NONE == type_m)
+        return false;
+    if ((scale <= 0.f) || (sample_interval <= 0.))
+    {
+        WARNING("cannot trigger with %e V per count and %e s per sample\n", scale, sample_interval);
+        type_m = E_TYPE_NONE;
+        return false;
+    }
+
+    hysteresis = config_m.hysteresis / scale;
+    if (config_m.hysteresis <= 0.)
+        hysteresis = STREAM_TRIGGER_HYSTERESIS * INT16_MAX;
+    hysteresis_m = (hysteresis < 1.) ? 1 : (hysteresis > INT16_MAX) ? INT16_MAX : (int32_t)(hysteresis + 0.5);
+    lower_m = to_counts(config_m.level, scale, offset);
+    upper_m = to_counts(config_m.upper, scale, offset);
+
+    switch (type_m)
+    {
+    case E_TYPE_WINDOW:
+    case E_TYPE_RUNT:
+        if (lower_m > upper_m)
+        {
+            swap = lower_m;
+            lower_m = upper_m;
+            upper_m = swap;
+        }
+        /* a runt needs room for the middle state between the bounds */
+        if ((E_TYPE_RUNT == type_m) && (upper_m - lower_m < 2))
+            upper_m = lower_m + 2;
+        /* entering the middle needs the signal hysteresis inside of the bounds */
+        if (hysteresis_m > (upper_m - lower_m) / 2)
+            hysteresis_m = (upper_m - lower_m) / 2;
+        break;
+    default:
+        switch (config_m.direction)
+        {
+        case E_DIRECTION_RISING:
+            high_m = lower_m;
+            low_m = lower_m - hysteresis_m;
+            break;
+        case E_DIRECTION_FALLING:
+            high_m = lower_m + hysteresis_m;
+            low_m = lower_m;
+            break;
+        default:
+            low_m = lower_m - hysteresis_m / 2;
+            high_m = low_m + hysteresis_m;
+            break;
+        }
+        break;
+    }
+    min_width_m = to_samples(config_m.min_width, sample_interval);
+    max_width_m = to_samples(config_m.max_width, sample_interval);
+    if ((0 != max_width_m) && (max_width_m < min_width_m))
+        max_width_m = min_width_m;
+    timeout_m = to_samples(config_m.timeout, sample_interval);
+    if (0 == timeout_m)
+        timeout_m = 1;
+    DEBUG("type %d, direction %d, counts [%d, %d] hysteresis %d, widths [%llu, %llu] timeout %llu samples\n",
+          type_m, config_m.direction, lower_m, upper_m, hysteresis_m,
+          (unsigned long long)min_width_m, (unsigned long long)max_width_m, (unsigned long long)timeout_m);
+    return true;
+}
+
+/****************************************************************************
+ * rearm
+ ****************************************************************************/
+void StreamTrigger::rearm(void)
+{
+    state_m = E_STATE_UNKNOWN;
+    pulse_open_m = false;
+    edge_seen_m = false;
+}
+
+/****************************************************************************
+ * search
+ ****************************************************************************/
+bool StreamTrigger::search(const int16_t *samples, uint32_t count, uint32_t *position)
+{
+    uint32_t index = 0;
+    bool fired = false;
+
+    if ((NULL == samples) || (0 == count))
+        return false;
+    switch (type_m)
+    {
+    case E_TYPE_EDGE:
+        fired = search_edge(samples, count, &index);
+        break;
+    case E_TYPE_WINDOW:
+        fired = search_window(samples, count, &index);
+        break;
+    case E_TYPE_PULSE_WIDTH:
+        fired = search_pulse_width(samples, count, &index);
+        break;
+    case E_TYPE_RUNT:
+        fired = search_runt(samples, count, &index);
+        break;
+    case E_TYPE_TIMEOUT:
+        fired = search_timeout(samples, count, &index);
+        break;
+    default:
+        break;
+    }
+    if (!fired)
+    {
+        position_m += count;
+        return false;
+    }
+    if (NULL != position)
+        *position = index;
+    position_m += index + 1;
+    return true;
+}
+
+/****************************************************************************
+ * find
+ ****************************************************************************/
+uint32_t StreamTrigger::find(const int16_t *samples, uint32_t count, int32_t lo, int32_t hi, bool inside) const
+{
+    if (lo < INT16_MIN)
+        lo = INT16_MIN;
+    if (hi > INT16_MAX)
+        hi = INT16_MAX;
+    /* no sample is in an empty range, every one is out of it */
+    if (lo > hi)
+        return inside ? count : 0;
+    return find_m(samples, count, (int16_t)lo, (int16_t)hi, inside);
+}
+
+/****************************************************************************
+ * get_crossing
+ ****************************************************************************/
+bool StreamTrigger::get_crossing(int32_t *level, bool *rising) const
+{
+    if ((E_TYPE_EDGE != type_m) && (E_TYPE_PULSE_WIDTH != type_m))
+        return false;
+    *rising = (E_STATE_HIGH == state_m);
+    *level = *rising ? high_m : low_m;
+    return true;
+}
+
+/****************************************************************************
+ * next_edge
+ *
+ * The search goes on from the edge sample: it is past the threshold of
+ * the new state, so it cannot match again.
+ ****************************************************************************/
+bool StreamTrigger::next_edge(const int16_t *samples, uint32_t count, uint32_t *index)
+{
+    uint32_t i = *index;
+
+    while (i < count)
+    {
+        switch (state_m)
+        {
+        case E_STATE_LOW:
+            i += find(samples + i, count - i, high_m, INT16_MAX, true);
+            if (i < count)
+            {
+                state_m = E_STATE_HIGH;
+                *index = i;
+                return true;
+            }
+            break;
+        case E_STATE_HIGH:
+            i += find(samples + i, count - i, INT16_MIN, low_m, true);
+            if (i < count)
+            {
+                state_m = E_STATE_LOW;
+                *index = i;
+                return true;
+            }
+            break;
+        default:
+            /* the first sample past a threshold tells the side, it is no edge */
+            i += find(samples + i, count - i, low_m + 1, high_m - 1, false);
+            if (i < count)
+                state_m = (samples[i] >= high_m) ? E_STATE_HIGH : E_STATE_LOW;
+            break;
+        }
+    }
+    *index = count;
+    return false;
+}
+
+/****************************************************************************
+ * is_wanted
+ ****************************************************************************/
+bool StreamTrigger::is_wanted(bool rising) const
+{
+    switch (config_m.direction)
+    {
+    case E_DIRECTION_RISING:
+        return rising;
+    case E_DIRECTION_FALLING:
+        return !rising;
+    default:
+        return true;
+    }
+}
+
+/****************************************************************************
+ * search_edge
+ ****************************************************************************/
+bool StreamTrigger::search_edge(const int16_t *samples, uint32_t count, uint32_t *index)
+{
+    while (next_edge(samples, count, index))
+    {
+        if (is_wanted(E_STATE_HIGH == state_m))
+            return true;
+    }
+    return false;
+}
+
+/****************************************************************************
+ * search_window
+ ****************************************************************************/
+bool StreamTrigger::search_window(const int16_t *samples, uint32_t count, uint32_t *index)
+{
+    uint32_t i = *index;
+
+    while (i < count)
+    {
+        switch (state_m)
+        {
+        case E_STATE_INSIDE:
+            i += find(samples + i, count - i, lower_m, upper_m, false);
+            if (i < count)
+            {
+                state_m = E_STATE_OUTSIDE;
+                if (E_DIRECTION_FALLING != config_m.direction)
+                {
+                    *index = i;
+                    return true;
+                }
+            }
+            break;
+        case E_STATE_OUTSIDE:
+            i += find(samples + i, count - i, lower_m + hysteresis_m, upper_m - hysteresis_m, true);
+            if (i < count)
+            {
+                state_m = E_STATE_INSIDE;
+                if (E_DIRECTION_RISING != config_m.direction)
+                {
+                    *index = i;
+                    return true;
+                }
+            }
+            break;
+        default:
+            state_m = ((samples[i] >= lower_m) && (samples[i] <= upper_m)) ? E_STATE_INSIDE : E_STATE_OUTSIDE;
+            break;
+        }
+    }
+    *index = count;
+    return false;
+}
+
+/****************************************************************************
+ * search_pulse_width
+ *
+ * A positive pulse opens on a rising edge and closes on the next falling
+ * one, a negative pulse the other way round, with either direction every
+ * edge closes a pulse and opens the next.
+ ****************************************************************************/
+bool StreamTrigger::search_pulse_width(const int16_t *samples, uint32_t count, uint32_t *index)
+{
+    uint64_t width = 0;
+    bool rising = false;
+    bool fired = false;
+
+    while (next_edge(samples, count, index))
+    {
+        rising = (E_STATE_HIGH == state_m);
+        fired = false;
+        if (pulse_open_m && ((E_DIRECTION_EITHER == config_m.direction) || !is_wanted(rising)))
+        {
+            width = position_m + *index - pulse_start_m;
+            fired = (width >= min_width_m) && ((0 == max_width_m) || (width <= max_width_m));
+            pulse_open_m = false;
+        }
+        if (is_wanted(rising))
+        {
+            pulse_open_m = true;
+            pulse_start_m = position_m + *index;
+        }
+        if (fired)
+            return true;
+    }
+    return false;
+}
+
+/****************************************************************************
+ * search_runt
+ *
+ * A pulse enters the middle once hysteresis past a bound, then a runt is
+ * one that goes back past that bound before it reaches the other one.
+ ****************************************************************************/
+bool StreamTrigger::search_runt(const int16_t *samples, uint32_t count, uint32_t *index)
+{
+    uint32_t i = *index;
+    bool fired = false;
+
+    while (i < count)
+    {
+        switch (state_m)
+        {
+        case E_STATE_LOW:
+            i += find(samples + i, count - i, lower_m + hysteresis_m, INT16_MAX, true);
+            if (i < count)
+                state_m = (samples[i] >= upper_m) ? E_STATE_HIGH : E_STATE_MIDDLE_UP;
+            break;
+        case E_STATE_HIGH:
+            i += find(samples + i, count - i, INT16_MIN, upper_m - hysteresis_m, true);
+            if (i < count)
+                state_m = (samples[i] <= lower_m) ? E_STATE_LOW : E_STATE_MIDDLE_DOWN;
+            break;
+        case E_STATE_MIDDLE_UP:
+        case E_STATE_MIDDLE_DOWN:
+            i += find(samples + i, count - i, lower_m + 1, upper_m - 1, false);
+            if (i < count)
+            {
+                if (E_STATE_MIDDLE_UP == state_m)
+                    fired = (samples[i] <= lower_m) && is_wanted(true);
+                else
+                    fired = (samples[i] >= upper_m) && is_wanted(false);
+                state_m = (samples[i] <= lower_m) ? E_STATE_LOW : E_STATE_HIGH;
+                if (fired)
+                {
+                    *index = i;
+                    return true;
+                }
+            }
+            break;
+        default:
+            i += find(samples + i, count - i, lower_m + 1, upper_m - 1, false);
+            if (i < count)
+                state_m = (samples[i] <= lower_m) ? E_STATE_LOW : E_STATE_HIGH;
+            break;
+        }
+    }
+    *index = count;
+    return false;
+}
+
+/****************************************************************************
+ * search_timeout
+ *
+ * Edges are searched up to the deadline only, it fires on the deadline
+ * sample if none came. The next timeout waits for another edge.
+ ****************************************************************************/
+bool StreamTrigger::search_timeout(const int16_t *samples, uint32_t count, uint32_t *index)
+{
+    uint32_t end = 0;
+
+    for (;;)
+    {
+        end = count;
+        if (edge_seen_m && (last_edge_m + timeout_m < position_m + count))
+            end = (uint32_t)(last_edge_m + timeout_m - position_m);
+        if (next_edge(samples, end, index))
+        {
+            if (is_wanted(E_STATE_HIGH == state_m))
+            {
+                edge_seen_m = true;
+                last_edge_m = position_m + *index;
+            }
+            continue;
+        }
+        if (end < count)
+        {
+            edge_seen_m = false;
+            *index = end;
+            return true;
+        }
+        return false;
+    }
+}
@@ -0,0 +1,189 @@
+/*****************************************************************************
+*   Copyright 2012 Vincent HERVIEUX
+*
+*   This file is part of QPicoscope.
+*
+*   QPicoscope is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU Lesser General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   any later version.
+*
+*   QPicoscope is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU Lesser General Public License for more details.
+*
+*   You should have received a copy of the GNU Lesser General Public License
+*   along with QPicoscope in files COPYING.LESSER and COPYING.
+*   If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+/**
+ * @file streamtrigger.h
+ * @brief Declaration of StreamTrigger class.
+ * Software trigger on the ADC counts of one channel of a continuous stream,
+ * for units that cannot trigger while streaming. Blocks are searched one
+ * after the other, the state carries over from a block to the next.
+ * Every trigger type is a sequence of threshold crossings, each found with
+ * the widest SIMD kernel the CPU supports, so samples far from a crossing
+ * cost a compare and a mask test per vector.
+ * @version 0.1
+ * @date 2026, october 16
+ * @author Vincent HERVIEUX    -   10.16.2026   -   initial creation
+ */
+
+#ifndef STREAMTRIGGER_H
+#define STREAMTRIGGER_H
+
+#include "oscilloscope.h"
+#include "adcconvert.h"
+
+/* hysteresis when none is given, part of the full scale */
+#define STREAM_TRIGGER_HYSTERESIS    0.01
+
+class StreamTrigger
+{
+public:
+    /**
+     * @brief public typedef declarations
+     */
+    typedef enum
+    {
+        /** @brief never triggers */
+        E_TYPE_NONE = 0,
+        /** @brief signal crosses level */
+        E_TYPE_EDGE,
+        /** @brief signal leaves or enters [level, upper] */
+        E_TYPE_WINDOW,
+        /** @brief pulse between two crossings of level lasts [min_width, max_width] */
+        E_TYPE_PULSE_WIDTH,
+        /** @brief pulse crosses one bound of [level, upper] and comes back without crossing the other */
+        E_TYPE_RUNT,
+        /** @brief no edge for timeout after an edge */
+        E_TYPE_TIMEOUT
+    } type_e;
+
+    typedef enum
+    {
+        /** @brief rising edge, positive pulse or runt; window: the signal leaves it */
+        E_DIRECTION_RISING = 0,
+        /** @brief falling edge, negative pulse or runt; window: the signal enters it */
+        E_DIRECTION_FALLING,
+        /** @brief both */
+        E_DIRECTION_EITHER
+    } direction_e;
+
+    typedef struct
+    {
+        type_e type;
+        direction_e direction;
+        /** @brief volts, the threshold, or the lower bound of window and runt */
+        double level;
+        /** @brief volts, upper bound of window and runt */
+        double upper;
+        /** @brief volts the signal has to go back past a threshold to cross it again, 0 for the default */
+        double hysteresis;
+        /** @brief seconds, pulse width accepted, max_width 0 for no maximum */
+        double min_width;
+        double max_width;
+        /** @brief seconds without an edge */
+        double timeout;
+    } config_t;
+
+    /** @brief constructor, selects the best kernel for this CPU, does not trigger */
+    StreamTrigger();
+    /** @brief destructor */
+    ~StreamTrigger();
+
+    /** @brief set the trigger, applied on next start() */
+    void set_config(const config_t &config) { config_m = config; }
+    const config_t& get_config(void) const { return config_m; }
+    /**
+     * @brief convert the config to counts and samples of the source channel and arm
+     * @param[in] scale, offset: volts = count * scale + offset
+     * @param[in] sample_interval: seconds between two samples
+     * @return false if it never triggers
+     */
+    bool start(float scale, float offset, double sample_interval);
+    /** @brief forget the signal seen so far, the next sample follows a gap */
+    void rearm(void);
+    /**
+     * @brief search the next samples of the stream
+     * @param[out] position: index of the sample the trigger fires on
+     * @return true if triggered, the samples after position are not
+     * searched yet and have to be given again
+     */
+    bool search(const int16_t *samples, uint32_t count, uint32_t *position);
+    /**
+     * @brief threshold the signal crossed when the trigger last fired
+     * Edge and pulse width triggers fire on the first sample past a
+     * threshold, the crossing is between it and the sample before.
+     * @param[out] level: in counts
+     * @param[out] rising: direction of the crossing
+     * @return false for the other types, they fire on no crossing
+     */
+    bool get_crossing(int32_t *level, bool *rising) const;
+
+    /** @brief force a kernel, false if this CPU cannot run it */
+    bool set_kernel(AdcConvert::kernel_e kernel);
+    AdcConvert::kernel_e get_kernel(void) const { return kernel_m; }
+
+private:
+    typedef enum
+    {
+        E_STATE_UNKNOWN = 0,
+        /** @brief below the threshold, or the lower bound */
+        E_STATE_LOW,
+        /** @brief above the threshold, or the upper bound */
+        E_STATE_HIGH,
+        /** @brief runt: between the bounds, coming from below or from above */
+        E_STATE_MIDDLE_UP,
+        E_STATE_MIDDLE_DOWN,
+        /** @brief window */
+        E_STATE_INSIDE,
+        E_STATE_OUTSIDE
+    } state_e;
+
+    /* index of the first sample whose (lo <= sample <= hi) equals inside, count if none */
+    typedef uint32_t (*kernel_fn_t)(const int16_t *samples, uint32_t count, int16_t lo, int16_t hi, bool inside);
+
+    StreamTrigger(const StreamTrigger&);
+    StreamTrigger& operator=(const StreamTrigger&);
+    /** @brief kernel call on [lo, hi] in counts, clamped to the ADC range */
+    uint32_t find(const int16_t *samples, uint32_t count, int32_t lo, int32_t hi, bool inside) const;
+    /** @brief run the comparator of edge, pulse width and timeout up to its next edge */
+    bool next_edge(const int16_t *samples, uint32_t count, uint32_t *index);
+    bool is_wanted(bool rising) const;
+    bool search_edge(const int16_t *samples, uint32_t count, uint32_t *index);
+    bool search_window(const int16_t *samples, uint32_t count, uint32_t *index);
+    bool search_pulse_width(const int16_t *samples, uint32_t count, uint32_t *index);
+    bool search_runt(const int16_t *samples, uint32_t count, uint32_t *index);
+    bool search_timeout(const int16_t *samples, uint32_t count, uint32_t *index);
+
+    config_t config_m;
+    AdcConvert::kernel_e kernel_m;
+    kernel_fn_t find_m;
+    /** @brief type of the last start(), E_TYPE_NONE if it cannot trigger */
+    type_e type_m;
+    /** @brief counts: the comparator goes high at high_m and low at low_m */
+    int32_t high_m;
+    int32_t low_m;
+    /** @brief counts: bounds of window and runt */
+    int32_t lower_m;
+    int32_t upper_m;
+    int32_t hysteresis_m;
+    /** @brief samples */
+    uint64_t min_width_m;
+    uint64_t max_width_m;
+    uint64_t timeout_m;
+    state_e state_m;
+    /** @brief samples searched before the current block */
+    uint64_t position_m;
+    /** @brief pulse width: a pulse began at pulse_start_m */
+    bool pulse_open_m;
+    uint64_t pulse_start_m;
+    /** @brief timeout: an edge was seen at last_edge_m */
+    bool edge_seen_m;
+    uint64_t last_edge_m;
+};
+
+#endif // STREAMTRIGGER_H
@@ -0,0 +1,444 @@
+/*****************************************************************************
+*   Copyright 2012 Vincent HERVIEUX
+*
+*   This file is part of QPicoscope.
+*
+*   QPicoscope is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU Lesser General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   any later version.
+*
+*   QPicoscope is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU Lesser General Public License for more details.
+*
+*   You should have received a copy of the GNU Lesser General Public License
+*   along with QPicoscope in files COPYING.LESSER and COPYING.
+*   If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+/**
+ * @file traceraster.cpp
+ * @brief Definition of TraceRaster class.
+ * @version 0.1
+ * @date 2026, october 16
+ * @author Vincent HERVIEUX    -   10.16.2026   -   initial creation
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "traceraster.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define TRACE_RASTER_X86
+#include <immintrin.h>
+#endif
+#if defined(__aarch64__) && defined(__ARM_NEON)
+#define TRACE_RASTER_NEON
+#include <arm_neon.h>
+#endif
+
+/****************************************************************************
+ * span_scalar
+ *
+ * Pixel c of row y takes the color when top[c] <= y <= bottom[c]. The
+ * pixel is always written so the loop has no branch.
+ ****************************************************************************/
+static void span_scalar(uint32_t *pixels, uint32_t stride, const int32_t *top, const int32_t *bottom,
+                        int32_t first, int32_t last, uint32_t color)
+{
+    uint32_t *row = pixels + (size_t)first * stride;
+    int32_t y = 0;
+    uint32_t c = 0;
+
+    for (y = first; y <= last; y++, row += stride)
+    {
+        for (c = 0; c < TRACE_RASTER_ALIGN; c++)
+            row[c] = ((top[c] <= y) & (y <= bottom[c])) ? color : row[c];
+    }
+}
+
+#ifdef TRACE_RASTER_X86
+/****************************************************************************
+ * span_sse2
+ ****************************************************************************/
+__attribute__((target("sse2")))
+static void span_sse2(uint32_t *pixels, uint32_t stride, const int32_t *top, const int32_t *bottom,
+                      int32_t first, int32_t last, uint32_t color)
+{
+    /* columns and rows are aligned, spans are kept in registers */
+    __m128i top_low = _mm_load_si128((const __m128i*)top);
+    __m128i top_high = _mm_load_si128((const __m128i*)(top + 4));
+    __m128i bottom_low = _mm_load_si128((const __m128i*)bottom);
+    __m128i bottom_high = _mm_load_si128((const __m128i*)(bottom + 4));
+    __m128i fill = _mm_set1_epi32((int)color);
+    __m128i row_y;
+    __m128i outside;
+    uint32_t *row = pixels + (size_t)first * stride;
+    int32_t y = 0;
+
+    for (y = first; y <= last; y++, row += stride)
+    {
+        row_y = _mm_set1_epi32(y);
+        outside = _mm_or_si128(_mm_cmpgt_epi32(top_low, row_y), _mm_cmpgt_epi32(row_y, bottom_low));
+        _mm_store_si128((__m128i*)row,
+                        _mm_or_si128(_mm_and_si128(outside, _mm_load_si128((const __m128i*)row)),
+                                     _mm_andnot_si128(outside, fill)));
+        outside = _mm_or_si128(_mm_cmpgt_epi32(top_high, row_y), _mm_cmpgt_epi32(row_y, bottom_high));
+        _mm_store_si128((__m128i*)(row + 4),
+                        _mm_or_si128(_mm_and_si128(outside, _mm_load_si128((const __m128i*)(row + 4))),
+                                     _mm_andnot_si128(outside, fill)));
+    }
+}
+
+/****************************************************************************
+ * span_avx2
+ ****************************************************************************/
+__attribute__((target("avx2")))
+static void span_avx2(uint32_t *pixels, uint32_t stride, const int32_t *top, const int32_t *bottom,
+                      int32_t first, int32_t last, uint32_t color)
+{
+    __m256i top_row = _mm256_load_si256((const __m256i*)top);
+    __m256i bottom_row = _mm256_load_si256((const __m256i*)bottom);
+    __m256i fill = _mm256_set1_epi32((int)color);
+    __m256i row_y;
+    __m256i outside;
+    uint32_t *row = pixels + (size_t)first * stride;
+    int32_t y = 0;
+
+    for (y = first; y <= last; y++, row += stride)
+    {
+        row_y = _mm256_set1_epi32(y);
+        outside = _mm256_or_si256(_mm256_cmpgt_epi32(top_row, row_y), _mm256_cmpgt_epi32(row_y, bottom_row));
+        _mm256_store_si256((__m256i*)row,
+                           _mm256_blendv_epi8(fill, _mm256_load_si256((const __m256i*)row), outside));
+    }
+}
+#endif
+
+#ifdef TRACE_RASTER_NEON
+/****************************************************************************
+ * span_neon
+ ****************************************************************************/
+static void span_neon(uint32_t *pixels, uint32_t stride, const int32_t *top, const int32_t *bottom,
+                      int32_t first, int32_t last, uint32_t color)
+{
+    int32x4_t top_low = vld1q_s32(top);
+    int32x4_t top_high = vld1q_s32(top + 4);
+    int32x4_t bottom_low = vld1q_s32(bottom);
+    int32x4_t bottom_high = vld1q_s32(bottom + 4);
+    uint32x4_t fill = vdupq_n_u32(color);
+    int32x4_t row_y;
+    uint32_t *row = pixels + (size_t)first * stride;
+    int32_t y = 0;
+
+    for (y = first; y <= last; y++, row += stride)
+    {
+        row_y = vdupq_n_s32(y);
+        vst1q_u32(row, vbslq_u32(vandq_u32(vcleq_s32(top_low, row_y), vcleq_s32(row_y, bottom_low)),
+                                 fill, vld1q_u32(row)));
+        vst1q_u32(row + 4, vbslq_u32(vandq_u32(vcleq_s32(top_high, row_y), vcleq_s32(row_y, bottom_high)),
+                                     fill, vld1q_u32(row + 4)));
+    }
+}
+#endif
+
+/****************************************************************************
+ *
+ * constructor
+ *
+ ****************************************************************************/
+TraceRaster::TraceRaster() :
+    kernel_m(AdcConvert::E_KERNEL_SCALAR),
+    span_m(span_scalar),
+    pixels_m(NULL),
+    width_m(0),
+    height_m(0),
+    stride_m(0),
+    nb_threads_m(1),
+    generation_m(0),
+    pending_m(0),
+    quit_m(false)
+{
+    uint8_t ch = 0;
+
+    for (ch = 0; ch < TRACE_RASTER_MAX_CHANNELS; ch++)
+    {
+        channels_m[ch].enabled = false;
+        channels_m[ch].color = 0;
+    }
+    pthread_mutex_init(&lock_m, NULL);
+    pthread_cond_init(&start_m, NULL);
+    pthread_cond_init(&done_m, NULL);
+    setKernel(AdcConvert::best_kernel());
+}
+
+/****************************************************************************
+ *
+ * destructor
+ *
+ ****************************************************************************/
+TraceRaster::~TraceRaster()
+{
+    stopThreads();
+    pthread_cond_destroy(&done_m);
+    pthread_cond_destroy(&start_m);
+    pthread_mutex_destroy(&lock_m);
+    free(pixels_m);
+}
+
+/****************************************************************************
+ * setKernel
+ ****************************************************************************/
+bool TraceRaster::setKernel(AdcConvert::kernel_e kernel)
+{
+    kernel_fn_t function = NULL;
+
+    if (AdcConvert::is_supported(kernel))
+    {
+        switch (kernel)
+        {
+#ifdef TRACE_RASTER_X86
+        case AdcConvert::E_KERNEL_SSE2:
+            function = span_sse2;
+            break;
+        case AdcConvert::E_KERNEL_AVX2:
+            function = span_avx2;
+            break;
+#endif
+#ifdef TRACE_RASTER_NEON
+        case AdcConvert::E_KERNEL_NEON:
+            function = span_neon;
+            break;
+#endif
+        case AdcConvert::E_KERNEL_SCALAR:
+            function = span_scalar;
+            break;
+        default:
+            break;
+        }
+    }
+    if (NULL == function)
+    {
+        WARNING("%s kernel not supported, keeping %s\n", AdcConvert::kernel_name(kernel), AdcConvert::kernel_name(kernel_m));
+        return false;
+    }
+    kernel_m = kernel;
+    span_m = function;
+    return true;
+}
+
+/****************************************************************************
+ * resize
+ *
+ * Rows are padded to TRACE_RASTER_ALIGN columns and aligned for the
+ * kernels, which never need a scalar tail.
+ ****************************************************************************/
+bool TraceRaster::resize(uint32_t width, uint32_t height)
+{
+    uint32_t stride = (width + TRACE_RASTER_ALIGN - 1) & ~(uint32_t)(TRACE_RASTER_ALIGN - 1);
+    void *pixels = NULL;
+    uint8_t ch = 0;
+
+    if ((width == width_m) && (height == height_m) && (NULL != pixels_m))
+        return true;
+    if ((0 == width) || (0 == height) || (height > COLUMN_SPANS_MAX_HEIGHT))
+        return false;
+
+    if (0 != posix_memalign(&pixels, TRACE_RASTER_ALIGN * sizeof(uint32_t), (size_t)stride * height * sizeof(uint32_t)))
+        goto no_memory;
+    free(pixels_m);
+    pixels_m = (uint32_t*)pixels;
+    for (ch = 0; ch < TRACE_RASTER_MAX_CHANNELS; ch++)
+    {
+        if (!channels_m[ch].spans.resize(width, height))
+            goto no_memory;
+        /* spans were set for the previous size */
+        channels_m[ch].enabled = false;
+    }
+    width_m = width;
+    height_m = height;
+    stride_m = stride;
+    return true;
+
+no_memory:
+    ERROR("cannot allocate a %ux%u image\n", width, height);
+    width_m = height_m = stride_m = 0;
+    return false;
+}
+
+/****************************************************************************
+ * clearChannel
+ ****************************************************************************/
+void TraceRaster::clearChannel(uint8_t channel)
+{
+    if (channel < TRACE_RASTER_MAX_CHANNELS)
+        channels_m[channel].enabled = false;
+}
+
+/****************************************************************************
+ * setColumns
+ ****************************************************************************/
+void TraceRaster::setColumns(uint8_t channel, const double *x, const double *y, uint32_t count,
+                             double x_scale, double x_offset, double y_scale, double y_offset, uint32_t color)
+{
+    if ((channel >= TRACE_RASTER_MAX_CHANNELS) || (NULL == pixels_m))
+        return;
+    channels_m[channel].spans.set(x, y, count, x_scale, x_offset, y_scale, y_offset);
+    channels_m[channel].color = color;
+    channels_m[channel].enabled = true;
+}
+
+/****************************************************************************
+ * renderBand
+ ****************************************************************************/
+void TraceRaster::renderBand(uint32_t first, uint32_t last)
+{
+    const ColumnSpans *spans = NULL;
+    int32_t top = 0;
+    int32_t bottom = 0;
+    uint32_t g = 0;
+    uint8_t ch = 0;
+
+    if (first >= last)
+        return;
+    memset(pixels_m + (size_t)first * stride_m, 0, (size_t)(last - first) * stride_m * sizeof(uint32_t));
+    for (ch = 0; ch < TRACE_RASTER_MAX_CHANNELS; ch++)
+    {
+        if (!channels_m[ch].enabled)
+            continue;
+        spans = &channels_m[ch].spans;
+        for (g = 0; g < stride_m / TRACE_RASTER_ALIGN; g++)
+        {
+            top = (spans->groupTop()[g] > (int32_t)first) ? spans->groupTop()[g] : (int32_t)first;
+            bottom = (spans->groupBottom()[g] < (int32_t)last - 1) ? spans->groupBottom()[g] : (int32_t)last - 1;
+            if (top <= bottom)
+                span_m(pixels_m + g * TRACE_RASTER_ALIGN, stride_m, spans->top() + g * TRACE_RASTER_ALIGN,
+                       spans->bottom() + g * TRACE_RASTER_ALIGN, top, bottom, channels_m[ch].color);
+        }
+    }
+}
+
+/****************************************************************************
+ * render
+ ****************************************************************************/
+void TraceRaster::render(void)
+{
+    uint32_t band = 0;
+
+    if (NULL == pixels_m)
+        return;
+    if (1 == nb_threads_m)
+    {
+        renderBand(0, height_m);
+        return;
+    }
+
+    pthread_mutex_lock(&lock_m);
+    generation_m++;
+    pending_m = nb_threads_m - 1;
+    pthread_cond_broadcast(&start_m);
+    pthread_mutex_unlock(&lock_m);
+
+    band = (height_m + nb_threads_m - 1) / nb_threads_m;
+    renderBand(0, (band < height_m) ? band : height_m);
+
+    pthread_mutex_lock(&lock_m);
+    while (pending_m > 0)
+        pthread_cond_wait(&done_m, &lock_m);
+    pthread_mutex_unlock(&lock_m);
+}
+
+/****************************************************************************
+ * threadRender
+ ****************************************************************************/
+void* TraceRaster::threadRender(void *arg)
+{
+    worker_t *worker = (worker_t*)arg;
+    TraceRaster *raster = worker->raster;
+    uint32_t generation = worker->generation;
+    uint32_t band = 0;
+    uint32_t first = 0;
+    uint32_t last = 0;
+
+    pthread_mutex_lock(&raster->lock_m);
+    for (;;)
+    {
+        while (!raster->quit_m && (generation == raster->generation_m))
+            pthread_cond_wait(&raster->start_m, &raster->lock_m);
+        if (raster->quit_m)
+            break;
+        generation = raster->generation_m;
+        pthread_mutex_unlock(&raster->lock_m);
+
+        band = (raster->height_m + raster->nb_threads_m - 1) / raster->nb_threads_m;
+        first = worker->band * band;
+        last = first + band;
+        if (first > raster->height_m)
+            first = raster->height_m;
+        if (last > raster->height_m)
+            last = raster->height_m;
+        raster->renderBand(first, last);
+
+        pthread_mutex_lock(&raster->lock_m);
+        if (0 == --raster->pending_m)
+            pthread_cond_signal(&raster->done_m);
+    }
+    pthread_mutex_unlock(&raster->lock_m);
+    return NULL;
+}
+
+/****************************************************************************
+ * stopThreads
+ ****************************************************************************/
+void TraceRaster::stopThreads(void)
+{
+    uint8_t i = 0;
+
+    if (nb_threads_m <= 1)
+        return;
+    pthread_mutex_lock(&lock_m);
+    quit_m = true;
+    pthread_cond_broadcast(&start_m);
+    pthread_mutex_unlock(&lock_m);
+    for (i = 1; i < nb_threads_m; i++)
+        pthread_join(threads_m[i], NULL);
+    quit_m = false;
+    nb_threads_m = 1;
+}
+
+/****************************************************************************
+ * setThreads
+ ****************************************************************************/
+bool TraceRaster::setThreads(uint8_t nb_threads)
+{
+    uint8_t i = 0;
+    int ret = 0;
+
+    if (nb_threads < 1)
+        nb_threads = 1;
+    if (nb_threads > TRACE_RASTER_MAX_THREADS)
+        nb_threads = TRACE_RASTER_MAX_THREADS;
+    if (nb_threads == nb_threads_m)
+        return true;
+
+    stopThreads();
+    for (i = 1; i < nb_threads; i++)
+    {
+        workers_m[i].raster = this;
+        workers_m[i].band = i;
+        workers_m[i].generation = generation_m;
+        ret = pthread_create(&threads_m[i], NULL, TraceRaster::threadRender, &workers_m[i]);
+        if (0 != ret)
+        {
+            ERROR("pthread_create failed and returned %d\n", ret);
+            /* the threads created so far are joined */
+            nb_threads_m = i;
+            stopThreads();
+            return false;
+        }
+    }
+    nb_threads_m = nb_threads;
+    return true;
+}
@@ -0,0 +1,140 @@
+/*****************************************************************************
+*   Copyright 2012 Vincent HERVIEUX
+*
+*   This file is part of QPicoscope.
+*
+*   QPicoscope is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU Lesser General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   any later version.
+*
+*   QPicoscope is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU Lesser General Public License for more details.
+*
+*   You should have received a copy of the GNU Lesser General Public License
+*   along with QPicoscope in files COPYING.LESSER and COPYING.
+*   If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+/**
+ * @file traceraster.h
+ * @brief Declaration of TraceRaster class.
+ * Draws traces as one vertical span per pixel column straight into a
+ * 32 bits ARGB premultiplied image, the layout of QImage::Format_ARGB32_Premultiplied.
+ * Spans come from decimated min/max pairs, see ColumnSpans. Columns
+ * are drawn by groups of TRACE_RASTER_ALIGN with compare and select
+ * kernels, over the rows of the spans of the group only: the work follows
+ * the height of the trace, width * height per channel at most whatever
+ * the record length. It may be shared by a few threads, each one drawing
+ * a band of rows.
+ * Qt free, so it is timed offscreen by raster-bench.
+ * @version 0.1
+ * @date 2026, october 16
+ * @author Vincent HERVIEUX    -   10.16.2026   -   initial creation
+ */
+
+#ifndef TRACERASTER_H
+#define TRACERASTER_H
+
+#include <pthread.h>
+
+#include "oscilloscope.h"
+#include "adcconvert.h"
+#include "columnspans.h"
+
+#define TRACE_RASTER_MAX_CHANNELS    4
+#define TRACE_RASTER_MAX_THREADS     8
+/* rows are padded to this many pixels, one AVX2 register, kernels draw that many columns */
+#define TRACE_RASTER_ALIGN           COLUMN_SPANS_GROUP
+
+class TraceRaster
+{
+public:
+    /** @brief constructor, selects the best kernel for this CPU, one thread */
+    TraceRaster();
+    /** @brief destructor, stops the threads */
+    ~TraceRaster();
+
+    /**
+     * @brief set the image size, the content is undefined until render()
+     * @return false if memory is exhausted or height is above COLUMN_SPANS_MAX_HEIGHT
+     */
+    bool resize(uint32_t width, uint32_t height);
+    uint32_t width(void) const { return width_m; }
+    uint32_t height(void) const { return height_m; }
+    /** @brief pixels between the start of two rows */
+    uint32_t stride(void) const { return stride_m; }
+    const uint32_t* pixels(void) const { return pixels_m; }
+
+    /**
+     * @brief set the spans of a channel from decimated points
+     * See ColumnSpans::set() for the parameters.
+     * @param[in] color: premultiplied ARGB
+     */
+    void setColumns(uint8_t channel, const double *x, const double *y, uint32_t count,
+                    double x_scale, double x_offset, double y_scale, double y_offset, uint32_t color);
+    /** @brief the channel is not drawn until setColumns() */
+    void clearChannel(uint8_t channel);
+    bool isEnabled(uint8_t channel) const { return (channel < TRACE_RASTER_MAX_CHANNELS) && channels_m[channel].enabled; }
+
+    /** @brief clear the image and draw every enabled channel, in channel order */
+    void render(void);
+
+    /**
+     * @brief share render() between threads, 1 renders in the calling thread only
+     * @return false if the threads cannot be created, rendering then stays in one thread
+     */
+    bool setThreads(uint8_t nb_threads);
+    uint8_t getThreads(void) const { return nb_threads_m; }
+    /** @brief force a kernel, false if this CPU cannot run it */
+    bool setKernel(AdcConvert::kernel_e kernel);
+    AdcConvert::kernel_e getKernel(void) const { return kernel_m; }
+
+private:
+    TraceRaster(const TraceRaster&);
+    TraceRaster& operator=(const TraceRaster&);
+    /* draws rows [first, last] of TRACE_RASTER_ALIGN columns from column pixels of row 0 */
+    typedef void (*kernel_fn_t)(uint32_t *pixels, uint32_t stride, const int32_t *top, const int32_t *bottom,
+                                int32_t first, int32_t last, uint32_t color);
+    typedef struct
+    {
+        bool enabled;
+        uint32_t color;
+        ColumnSpans spans;
+    } channel_t;
+    typedef struct
+    {
+        TraceRaster *raster;
+        uint8_t band;
+        /* last render() seen, set before the thread starts */
+        uint32_t generation;
+    } worker_t;
+
+    static void* threadRender(void *arg);
+    /** @brief draw rows [first, last[ of every channel */
+    void renderBand(uint32_t first, uint32_t last);
+    void stopThreads(void);
+
+    AdcConvert::kernel_e kernel_m;
+    kernel_fn_t span_m;
+    uint32_t *pixels_m;
+    uint32_t width_m;
+    uint32_t height_m;
+    uint32_t stride_m;
+    channel_t channels_m[TRACE_RASTER_MAX_CHANNELS];
+
+    /* band workers, band 0 is drawn by the thread calling render() */
+    uint8_t nb_threads_m;
+    pthread_t threads_m[TRACE_RASTER_MAX_THREADS];
+    worker_t workers_m[TRACE_RASTER_MAX_THREADS];
+    pthread_mutex_t lock_m;
+    pthread_cond_t start_m;
+    pthread_cond_t done_m;
+    /* protected by lock_m */
+    uint32_t generation_m;
+    uint8_t pending_m;
+    bool quit_m;
+};
+
+#endif // TRACERASTER_H
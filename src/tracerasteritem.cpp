@@ -0,0 +1,119 @@
+/*****************************************************************************
+*   Copyright 2012 Vincent HERVIEUX
+*
+*   This file is part of QPicoscope.
+*
+*   QPicoscope is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU Lesser General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   any later version.
+*
+*   QPicoscope is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU Lesser General Public License for more details.
+*
+*   You should have received a copy of the GNU Lesser General Public License
+*   along with QPicoscope in files COPYING.LESSER and COPYING.
+*   If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+/**
+ * @file tracerasteritem.cpp
+ * @brief Definition of TraceRasterItem class.
+ * @version 0.1
+ * @date 2026, october 16
+ * @author Vincent HERVIEUX    -   10.16.2026   -   initial creation
+ */
+
+#include <string.h>
+
+#include <QPainter>
+#include <QImage>
+
+#include <qwt_scale_map.h>
+
+#include "tracerasteritem.h"
+
+TraceRasterItem::TraceRasterItem()
+{
+    for(int ch = 0; ch < TRACE_RASTER_MAX_CHANNELS; ch++)
+        channels[ch].color = 0;
+    setZ(30.);
+}
+
+void TraceRasterItem::setPoints(uint8_t channel, const double *x, const double *y, uint32_t nbPoints, uint32_t color)
+{
+    if(channel >= TRACE_RASTER_MAX_CHANNELS)
+        return;
+    channels[channel].x.resize((int)nbPoints);
+    channels[channel].y.resize((int)nbPoints);
+    memcpy(channels[channel].x.data(), x, nbPoints * sizeof(double));
+    memcpy(channels[channel].y.data(), y, nbPoints * sizeof(double));
+    channels[channel].color = color;
+}
+
+void TraceRasterItem::clearPoints(uint8_t channel)
+{
+    if(channel >= TRACE_RASTER_MAX_CHANNELS)
+        return;
+    channels[channel].x.clear();
+    channels[channel].y.clear();
+}
+
+int TraceRasterItem::rtti() const
+{
+    return QwtPlotItem::Rtti_PlotUserItem + 2;
+}
+
+/**
+ * Scale maps are linear: pixel = p1 + (value - s1) * (p2 - p1) / (s2 - s1),
+ * made relative to the image, which is drawn at the canvas top left corner.
+ */
+#if ( QWT_VERSION >= 0x060000)
+void TraceRasterItem::draw(QPainter *painter, const QwtScaleMap &xMap, const QwtScaleMap &yMap,
+                           const QRectF &canvasRect) const
+#else
+void TraceRasterItem::draw(QPainter *painter, const QwtScaleMap &xMap, const QwtScaleMap &yMap,
+                           const QRect &canvasRect) const
+#endif
+{
+#if ( QWT_VERSION >= 0x060000)
+    QRect rect = canvasRect.toAlignedRect();
+#else
+    QRect rect = canvasRect;
+#endif
+    bool empty = true;
+    double xScale = 0.;
+    double yScale = 0.;
+    uint8_t ch = 0;
+
+    if(rect.isEmpty() || (xMap.s1() == xMap.s2()) || (yMap.s1() == yMap.s2()))
+        return;
+    for(ch = 0; ch < TRACE_RASTER_MAX_CHANNELS; ch++)
+        empty = empty && channels[ch].x.isEmpty();
+    if(empty)
+        return;
+    if(!raster.resize((uint32_t)rect.width(), (uint32_t)rect.height()))
+        return;
+
+    xScale = (xMap.p2() - xMap.p1()) / (xMap.s2() - xMap.s1());
+    yScale = (yMap.p2() - yMap.p1()) / (yMap.s2() - yMap.s1());
+    for(ch = 0; ch < TRACE_RASTER_MAX_CHANNELS; ch++)
+    {
+        const Channel &channel = channels[ch];
+        if(channel.x.isEmpty())
+        {
+            raster.clearChannel(ch);
+            continue;
+        }
+        raster.setColumns(ch, channel.x.constData(), channel.y.constData(), (uint32_t)channel.x.size(),
+                          xScale, xMap.p1() - xMap.s1() * xScale - rect.left(),
+                          yScale, yMap.p1() - yMap.s1() * yScale - rect.top(), channel.color);
+    }
+    raster.render();
+
+    // wraps the pixels, nothing is copied
+    QImage image((const uchar*)raster.pixels(), (int)raster.width(), (int)raster.height(),
+                 (int)(raster.stride() * sizeof(uint32_t)), QImage::Format_ARGB32_Premultiplied);
+    painter->drawImage(rect.topLeft(), image);
+}
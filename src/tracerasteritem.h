@@ -0,0 +1,79 @@
+/*****************************************************************************
+*   Copyright 2012 Vincent HERVIEUX
+*
+*   This file is part of QPicoscope.
+*
+*   QPicoscope is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU Lesser General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   any later version.
+*
+*   QPicoscope is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU Lesser General Public License for more details.
+*
+*   You should have received a copy of the GNU Lesser General Public License
+*   along with QPicoscope in files COPYING.LESSER and COPYING.
+*   If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+/**
+ * @file tracerasteritem.h
+ * @brief Declaration of TraceRasterItem class.
+ * Curves of decimated channels, drawn by TraceRaster into one image and
+ * blitted over the static layer. Replaces QPainter polylines of two points
+ * per column, the cost only depends on the canvas size.
+ * @version 0.1
+ * @date 2026, october 16
+ * @author Vincent HERVIEUX    -   10.16.2026   -   initial creation
+ */
+
+#ifndef TRACERASTERITEM_H
+#define TRACERASTERITEM_H
+
+#include <QVector>
+
+#include <qwt_global.h>
+#include <qwt_plot_item.h>
+
+#include "traceraster.h"
+
+class TraceRasterItem : public QwtPlotItem
+{
+public:
+    /** @brief constructor, over the curves */
+    TraceRasterItem();
+
+    /**
+     * @brief set the decimated points of a channel, copied
+     * @param[in] x, y: minimum and maximum of each column, as given by Decimator
+     * @param[in] color: premultiplied ARGB
+     */
+    void setPoints(uint8_t channel, const double *x, const double *y, uint32_t nbPoints, uint32_t color);
+    /** @brief do not draw the channel anymore */
+    void clearPoints(uint8_t channel);
+    /** @brief share rendering between threads, see TraceRaster::setThreads() */
+    bool setThreads(uint8_t nbThreads) { return raster.setThreads(nbThreads); }
+
+    virtual int rtti() const;
+#if ( QWT_VERSION >= 0x060000)
+    virtual void draw(QPainter *painter, const QwtScaleMap &xMap, const QwtScaleMap &yMap,
+                      const QRectF &canvasRect) const;
+#else
+    virtual void draw(QPainter *painter, const QwtScaleMap &xMap, const QwtScaleMap &yMap,
+                      const QRect &canvasRect) const;
+#endif
+
+private:
+    struct Channel
+    {
+        QVector<double> x;
+        QVector<double> y;
+        uint32_t color;
+    };
+    Channel channels[TRACE_RASTER_MAX_CHANNELS];
+    /* spans and image are scratch memory of draw() */
+    mutable TraceRaster raster;
+};
+
+#endif // TRACERASTERITEM_H
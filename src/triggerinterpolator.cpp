@@ -0,0 +1,164 @@
+/*****************************************************************************
+*   Copyright 2012 Vincent HERVIEUX
+*
+*   This file is part of QPicoscope.
+*
+*   QPicoscope is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU Lesser General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   any later version.
+*
+*   QPicoscope is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU Lesser General Public License for more details.
+*
+*   You should have received a copy of the GNU Lesser General Public License
+*   along with QPicoscope in files COPYING.LESSER and COPYING.
+*   If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+/**
+ * @file triggerinterpolator.cpp
+ * @brief Definition of TriggerInterpolator class.
+ * @version 0.1
+ * @date 2026, october 16
+ * @author Vincent HERVIEUX    -   10.16.2026   -   initial creation
+ */
+
+#include <math.h>
+
+#include "triggerinterpolator.h"
+
+/****************************************************************************
+ * crosses
+ ****************************************************************************/
+static inline bool crosses(double before, double after, double level, bool rising)
+{
+    return rising ? ((before < level) && (after >= level)) : ((before > level) && (after <= level));
+}
+
+/****************************************************************************
+ *
+ * constructor
+ *
+ * Every phase is normalised to a gain of 1, phase 0 and the last one give
+ * the samples themselves.
+ *
+ ****************************************************************************/
+TriggerInterpolator::TriggerInterpolator() :
+    method_m(E_METHOD_LINEAR)
+{
+    uint32_t phase = 0;
+    uint32_t tap = 0;
+    double x = 0.;
+    double weight = 0.;
+    double sum = 0.;
+
+    for (phase = 0; phase <= TRIGGER_INTERPOLATOR_PHASES; phase++)
+    {
+        sum = 0.;
+        for (tap = 0; tap < 2 * TRIGGER_INTERPOLATOR_TAPS; tap++)
+        {
+            /* distance from the point to the sample of this tap */
+            x = (double)phase / TRIGGER_INTERPOLATOR_PHASES - ((double)tap - (TRIGGER_INTERPOLATOR_TAPS - 1));
+            weight = (fabs(x) < 1E-9) ? 1. : sin(M_PI * x) / (M_PI * x);
+            weight *= 0.5 * (1. + cos(M_PI * x / TRIGGER_INTERPOLATOR_TAPS));
+            table_m[phase][tap] = (float)weight;
+            sum += weight;
+        }
+        for (tap = 0; tap < 2 * TRIGGER_INTERPOLATOR_TAPS; tap++)
+            table_m[phase][tap] = (float)(table_m[phase][tap] / sum);
+    }
+}
+
+/****************************************************************************
+ *
+ * destructor
+ *
+ ****************************************************************************/
+TriggerInterpolator::~TriggerInterpolator()
+{
+}
+
+/****************************************************************************
+ * sinc
+ *
+ * Samples out of the waveform are taken as the first or the last one.
+ ****************************************************************************/
+double TriggerInterpolator::sinc(const int16_t *samples, uint32_t count, uint32_t i, uint32_t phase) const
+{
+    const float *taps = table_m[phase];
+    int64_t first = (int64_t)i - (TRIGGER_INTERPOLATOR_TAPS - 1);
+    int64_t j = 0;
+    uint32_t tap = 0;
+    float value = 0.f;
+
+    if ((first >= 0) && (first + 2 * TRIGGER_INTERPOLATOR_TAPS <= count))
+    {
+        for (tap = 0; tap < 2 * TRIGGER_INTERPOLATOR_TAPS; tap++)
+            value += taps[tap] * samples[first + tap];
+        return value;
+    }
+    for (tap = 0; tap < 2 * TRIGGER_INTERPOLATOR_TAPS; tap++)
+    {
+        j = first + tap;
+        j = (j < 0) ? 0 : ((j >= (int64_t)count) ? (int64_t)count - 1 : j);
+        value += taps[tap] * samples[j];
+    }
+    return value;
+}
+
+/****************************************************************************
+ * crossing
+ ****************************************************************************/
+bool TriggerInterpolator::crossing(const int16_t *samples, uint32_t count, uint32_t index, double level, bool rising,
+                                   double *position) const
+{
+    uint32_t distance = 0;
+    uint32_t phase = 0;
+    int64_t i = -1;
+    double before = 0.;
+    double after = 0.;
+
+    *position = index;
+    if ((NULL == samples) || (index >= count))
+        return false;
+
+    /* nearest pair samples[i], samples[i + 1] the signal crosses level between */
+    for (distance = 0; (distance <= TRIGGER_INTERPOLATOR_SEARCH) && (i < 0); distance++)
+    {
+        if ((index >= distance + 1) && crosses(samples[index - distance - 1], samples[index - distance], level, rising))
+            i = index - distance - 1;
+        else if ((distance > 0) && (index + distance < count) &&
+                 crosses(samples[index + distance - 1], samples[index + distance], level, rising))
+            i = index + distance - 1;
+    }
+    if (i < 0)
+        return false;
+    if (E_METHOD_NONE == method_m)
+    {
+        *position = (double)i + 1.;
+        return true;
+    }
+
+    before = samples[i];
+    after = samples[i + 1];
+    if (E_METHOD_SINC == method_m)
+    {
+        /* the rebuilt signal starts and ends on the samples, it crosses in
+         * between at least once: the first crossing is taken */
+        for (phase = 1; phase < TRIGGER_INTERPOLATOR_PHASES; phase++)
+        {
+            after = sinc(samples, count, (uint32_t)i, phase);
+            if (crosses(before, after, level, rising))
+                break;
+            before = after;
+        }
+        if (TRIGGER_INTERPOLATOR_PHASES == phase)
+            after = samples[i + 1];
+        *position = (double)i + (phase - 1 + (level - before) / (after - before)) / TRIGGER_INTERPOLATOR_PHASES;
+        return true;
+    }
+    *position = (double)i + (level - before) / (after - before);
+    return true;
+}
@@ -0,0 +1,94 @@
+/*****************************************************************************
+*   Copyright 2012 Vincent HERVIEUX
+*
+*   This file is part of QPicoscope.
+*
+*   QPicoscope is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU Lesser General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   any later version.
+*
+*   QPicoscope is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU Lesser General Public License for more details.
+*
+*   You should have received a copy of the GNU Lesser General Public License
+*   along with QPicoscope in files COPYING.LESSER and COPYING.
+*   If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+/**
+ * @file triggerinterpolator.h
+ * @brief Declaration of TriggerInterpolator class.
+ * Time of a trigger crossing between two samples, so that the trigger point
+ * of consecutive waveforms is at the same time and not only at the same
+ * sample: without it a waveform jitters by up to one sample interval.
+ * Linear interpolation uses the two samples around the crossing, sin(x)/x
+ * rebuilds the band limited signal from TRIGGER_INTERPOLATOR_TAPS samples
+ * on each side with a table of TRIGGER_INTERPOLATOR_PHASES phases computed
+ * once, the crossing is then linear between the two phases around it.
+ * @version 0.1
+ * @date 2026, october 16
+ * @author Vincent HERVIEUX    -   10.16.2026   -   initial creation
+ */
+
+#ifndef TRIGGERINTERPOLATOR_H
+#define TRIGGERINTERPOLATOR_H
+
+#include "oscilloscope.h"
+
+/* samples on each side of the crossing sin(x)/x is computed from */
+#define TRIGGER_INTERPOLATOR_TAPS      8
+/* points sin(x)/x is computed at between two samples */
+#define TRIGGER_INTERPOLATOR_PHASES    32
+/* samples on each side of the trigger sample searched for the crossing */
+#define TRIGGER_INTERPOLATOR_SEARCH    4
+
+class TriggerInterpolator
+{
+public:
+    /**
+     * @brief public typedef declarations
+     */
+    typedef enum
+    {
+        /** @brief the trigger point is the sample the trigger fired on */
+        E_METHOD_NONE = 0,
+        /** @brief straight line between the two samples around the crossing */
+        E_METHOD_LINEAR,
+        /** @brief band limited signal between the two samples around the crossing */
+        E_METHOD_SINC
+    } method_e;
+
+    /** @brief constructor, linear interpolation */
+    TriggerInterpolator();
+    /** @brief destructor */
+    ~TriggerInterpolator();
+
+    void set_method(method_e method) { method_m = method; }
+    method_e get_method(void) const { return method_m; }
+    /**
+     * @brief where samples cross level, near the sample a trigger fired on
+     * A rising crossing is samples[i - 1] < level <= samples[i], a falling
+     * one samples[i - 1] > level >= samples[i]. The crossing nearest to
+     * index is taken, TRIGGER_INTERPOLATOR_SEARCH samples at most away.
+     * @param[in] samples, count: the waveform
+     * @param[in] index: sample the trigger fired on
+     * @param[in] level: in counts
+     * @param[in] rising: direction of the crossing
+     * @param[out] position: in samples from samples[0], index when no crossing is found
+     * @return false if no crossing is found near index
+     */
+    bool crossing(const int16_t *samples, uint32_t count, uint32_t index, double level, bool rising,
+                  double *position) const;
+
+private:
+    /** @brief value of the signal rebuilt phase / TRIGGER_INTERPOLATOR_PHASES after samples[i] */
+    double sinc(const int16_t *samples, uint32_t count, uint32_t i, uint32_t phase) const;
+
+    method_e method_m;
+    /** @brief sin(x)/x times a Hann window, taps from i - TAPS + 1 to i + TAPS for each phase */
+    float table_m[TRIGGER_INTERPOLATOR_PHASES + 1][2 * TRIGGER_INTERPOLATOR_TAPS];
+};
+
+#endif // TRIGGERINTERPOLATOR_H